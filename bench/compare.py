@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""
+Compare two crous_bench JSON reports and flag regressions.
+
+Usage:
+    python bench/compare.py BASELINE.json CURRENT.json [--time 0.10] [--allocs 0] [--size 0]
+
+A case regresses when its median ns/op grows by more than --time (a
+fraction), its allocations per op by more than --allocs, its wire size by
+more than --size, or when it ran in the baseline and fails now. Cases only
+in one report are listed but never fail the comparison.
+
+Exits 1 if anything regressed, so a release check can run:
+    build/bench/crous_bench --json current.json
+    python bench/compare.py baseline.json current.json
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, 'r', encoding='utf-8') as f:
+        report = json.load(f)
+    return {(r['dataset'], r['codec'], r['op']): r for r in report['results']}
+
+
+def growth(old, new):
+    if old is None or new is None:
+        return None
+    if old == 0:
+        return 0.0 if new == 0 else float('inf')
+    return new / old - 1.0
+
+
+def compare(base, cur, args):
+    """Rows of (name, ns change, allocs change, size change, verdict)."""
+    rows = []
+    regressed = False
+    for key in sorted(set(base) | set(cur)):
+        name = '/'.join(key)
+        old, new = base.get(key), cur.get(key)
+        if old is None or new is None:
+            rows.append((name, None, None, None, 'new' if old is None else 'removed'))
+            continue
+        if 'error' in new:
+            verdict = 'still failing' if 'error' in old else 'REGRESSED: ' + new['error']
+            regressed |= 'error' not in old
+            rows.append((name, None, None, None, verdict))
+            continue
+        if 'error' in old:
+            rows.append((name, None, None, None, 'fixed'))
+            continue
+
+        dt = growth(old['ns_per_op'], new['ns_per_op'])
+        da = growth(old.get('allocs_per_op'), new.get('allocs_per_op'))
+        ds = growth(old['bytes'], new['bytes'])
+        bad = [what for what, change, limit in (('time', dt, args.time), ('allocs', da, args.allocs),
+                                                ('size', ds, args.size))
+               if change is not None and change > limit]
+        regressed |= bool(bad)
+        rows.append((name, dt, da, ds, 'REGRESSED: ' + ', '.join(bad) if bad else 'ok'))
+    return rows, regressed
+
+
+def pct(change):
+    return '-' if change is None else '%+.1f%%' % (change * 100)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    parser.add_argument('--time', type=float, default=0.10,
+                        help='allowed ns/op growth as a fraction (default 0.10)')
+    parser.add_argument('--allocs', type=float, default=0.0,
+                        help='allowed allocations/op growth as a fraction (default 0)')
+    parser.add_argument('--size', type=float, default=0.0,
+                        help='allowed wire size growth as a fraction (default 0)')
+    args = parser.parse_args(argv)
+
+    rows, regressed = compare(load(args.baseline), load(args.current), args)
+    width = max([len(r[0]) for r in rows] + [4])
+    print('%-*s %9s %9s %9s  %s' % (width, 'case', 'ns/op', 'allocs', 'bytes', 'verdict'))
+    for name, dt, da, ds, verdict in rows:
+        print('%-*s %9s %9s %9s  %s' % (width, name, pct(dt), pct(da), pct(ds), verdict))
+    return 1 if regressed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
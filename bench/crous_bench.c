@@ -0,0 +1,760 @@
+/*
+ * crous_bench.c — native benchmark harness for every codec
+ *
+ * Times each encode/decode path straight against the C library, so the
+ * numbers carry no interpreter overhead:
+ *
+ *   flux_binary    flux_encode_binary() / flux_decode_binary()
+ *   legacy_binary  the CROUS v2 encoder / crous_decode()
+ *   flux_text      flux_encode_text() / flux_decode_text()
+ *   crout          crout_encode() / crout_decode()
+ *   transcode      crout_flux_to_text() / crout_text_to_flux()
+ *
+ * Every codec runs on the same datasets. Each case reports the median
+ * and fastest ns/op over several samples, MB/s of wire bytes, allocations
+ * per op and the peak RSS reached while it ran.
+ *
+ * Build and run:
+ *   python setup.py build_bench
+ *   build/bench/crous_bench [--json FILE] [--filter TEXT] [--samples N] [--min-time MS]
+ *
+ * --json writes the results as one JSON document; bench/compare.py diffs
+ * two of them and exits non-zero on regressions.
+ *
+ * Allocation counts need the build to wrap malloc (-Wl,--wrap=malloc and
+ * friends, CROUS_BENCH_WRAP_MALLOC); without it they are reported as null.
+ * Peak RSS is per case on Linux and the process high-water mark elsewhere.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "../crous/include/crous.h"
+#include "../crous/include/crous_flux.h"
+#include "../crous/include/crous_crout.h"
+#include "../crous/include/crous_binary.h"
+#include "../crous/include/crous_version.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+/* ============================================================================
+   ALLOCATION COUNTING
+   ============================================================================ */
+
+static size_t alloc_count;
+
+#ifdef CROUS_BENCH_WRAP_MALLOC
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    alloc_count++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    alloc_count++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    alloc_count++;
+    return __real_realloc(ptr, size);
+}
+#endif
+
+/* ============================================================================
+   PEAK RSS
+   ============================================================================ */
+
+/* Start a fresh high-water mark where the kernel allows it */
+static void rss_reset(void) {
+#ifdef __linux__
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if (f) {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+}
+
+/* Peak resident set in KiB since rss_reset(), or for the process */
+static long rss_peak_kb(void) {
+#ifdef __linux__
+    FILE *f = fopen("/proc/self/status", "r");
+    if (f) {
+        char line[256];
+        long kb = -1;
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                kb = strtol(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(f);
+        if (kb >= 0) return kb;
+    }
+#endif
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024;
+#else
+    return ru.ru_maxrss;
+#endif
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ============================================================================
+   DATASETS
+   ============================================================================ */
+
+static crous_value *S(const char *s) { return crous_value_new_string(s, strlen(s)); }
+static crous_value *I(int64_t v) { return crous_value_new_int(v); }
+static crous_value *F(double v) { return crous_value_new_float(v); }
+static crous_value *B(int v) { return crous_value_new_bool(v); }
+
+static crous_value *set(crous_value *dict, const char *key, crous_value *v) {
+    crous_value_dict_set(dict, key, v);
+    return dict;
+}
+
+static crous_value *push(crous_value *list, crous_value *v) {
+    crous_value_list_append(list, v);
+    return list;
+}
+
+static crous_value *strings(const char *const *items, size_t n) {
+    crous_value *list = crous_value_new_list(n);
+    for (size_t i = 0; i < n; i++) push(list, S(items[i]));
+    return list;
+}
+
+/* The user profile of benchmark_suite.py */
+static crous_value *make_small_api(void) {
+    static const char *const tags[] = {"developer", "python", "systems"};
+    crous_value *d = crous_value_new_dict(8);
+    set(d, "id", I(12345));
+    set(d, "name", S("Alice Johnson"));
+    set(d, "email", S("alice@example.com"));
+    set(d, "age", I(29));
+    set(d, "verified", B(1));
+    crous_value *scores = crous_value_new_list(4);
+    push(push(push(push(scores, F(98.5)), F(95.0)), F(100.0)), F(87.5));
+    set(d, "scores", scores);
+    crous_value *addr = crous_value_new_dict(4);
+    set(addr, "street", S("123 Main St"));
+    set(addr, "city", S("San Francisco"));
+    set(addr, "state", S("CA"));
+    set(addr, "zip", S("94102"));
+    set(d, "address", addr);
+    set(d, "tags", strings(tags, 3));
+    return d;
+}
+
+/* The nested service config of benchmark_suite.py */
+static crous_value *make_config(void) {
+    static const char *const protocols[] = {"TLSv1.2", "TLSv1.3"};
+    static const char *const handlers[] = {"console", "file", "syslog"};
+    static const char *const origins[] = {"https://app.example.com", "https://admin.example.com"};
+    crous_value *d = crous_value_new_dict(5);
+
+    crous_value *ssl = crous_value_new_dict(4);
+    set(ssl, "enabled", B(1));
+    set(ssl, "cert_path", S("/etc/ssl/certs/server.pem"));
+    set(ssl, "key_path", S("/etc/ssl/private/server.key"));
+    set(ssl, "protocols", strings(protocols, 2));
+    crous_value *server = crous_value_new_dict(5);
+    set(server, "host", S("0.0.0.0"));
+    set(server, "port", I(8080));
+    set(server, "workers", I(4));
+    set(server, "timeout", I(30));
+    set(server, "ssl", ssl);
+    set(d, "server", server);
+
+    crous_value *primary = crous_value_new_dict(5);
+    set(primary, "host", S("db-primary.internal"));
+    set(primary, "port", I(5432));
+    set(primary, "name", S("myapp_production"));
+    set(primary, "pool_size", I(20));
+    set(primary, "pool_timeout", I(5));
+    crous_value *replica = crous_value_new_dict(5);
+    set(replica, "host", S("db-replica.internal"));
+    set(replica, "port", I(5432));
+    set(replica, "name", S("myapp_production"));
+    set(replica, "pool_size", I(10));
+    set(replica, "read_only", B(1));
+    crous_value *db = crous_value_new_dict(2);
+    set(db, "primary", primary);
+    set(db, "replica", replica);
+    set(d, "database", db);
+
+    crous_value *cache = crous_value_new_dict(5);
+    set(cache, "backend", S("redis"));
+    set(cache, "host", S("cache.internal"));
+    set(cache, "port", I(6379));
+    set(cache, "ttl", I(3600));
+    set(cache, "prefix", S("myapp:"));
+    set(d, "cache", cache);
+
+    crous_value *logging = crous_value_new_dict(6);
+    set(logging, "level", S("INFO"));
+    set(logging, "format", S("%(asctime)s [%(levelname)s] %(name)s: %(message)s"));
+    set(logging, "handlers", strings(handlers, 3));
+    set(logging, "file_path", S("/var/log/myapp/app.log"));
+    set(logging, "max_bytes", I(10485760));
+    set(logging, "backup_count", I(5));
+    set(d, "logging", logging);
+
+    crous_value *features = crous_value_new_dict(4);
+    set(features, "rate_limiting", B(1));
+    set(features, "auth_enabled", B(1));
+    set(features, "cors_origins", strings(origins, 2));
+    set(features, "max_upload_mb", I(50));
+    set(d, "features", features);
+    return d;
+}
+
+/* The 1000-record page of benchmark_suite.py */
+static crous_value *make_records(void) {
+    static const char *const depts[] = {"engineering", "marketing", "sales", "support", "hr"};
+    char buf[64];
+    crous_value *d = crous_value_new_dict(2);
+    crous_value *meta = crous_value_new_dict(4);
+    set(meta, "total", I(1000));
+    set(meta, "page", I(1));
+    set(meta, "per_page", I(1000));
+    set(meta, "generated_at", S("2026-02-16T00:00:00Z"));
+    set(d, "metadata", meta);
+
+    crous_value *records = crous_value_new_list(1000);
+    for (int i = 0; i < 1000; i++) {
+        crous_value *r = crous_value_new_dict(10);
+        set(r, "id", I(i));
+        snprintf(buf, sizeof(buf), "550e8400-e29b-41d4-a716-%012d", i);
+        set(r, "uuid", S(buf));
+        snprintf(buf, sizeof(buf), "User %d", i);
+        set(r, "name", S(buf));
+        snprintf(buf, sizeof(buf), "user%d@example.com", i);
+        set(r, "email", S(buf));
+        set(r, "age", I(20 + i % 50));
+        set(r, "score", F(50.0 + i % 50 + (i % 7) * 0.1));
+        set(r, "active", B(i % 3 != 0));
+        set(r, "department", S(depts[i % 5]));
+        crous_value *perms = crous_value_new_list(2);
+        push(perms, S("read"));
+        if (i % 2 == 0) push(perms, S("write"));
+        set(r, "permissions", perms);
+        crous_value *m = crous_value_new_dict(3);
+        snprintf(buf, sizeof(buf), "2025-%02d-%02d", i % 12 + 1, i % 28 + 1);
+        set(m, "created", S(buf));
+        set(m, "logins", I(i * 3 + 7));
+        snprintf(buf, sizeof(buf), "192.168.%d.%d", i % 256, i * 7 % 256);
+        set(m, "last_ip", S(buf));
+        set(r, "metadata", m);
+        push(records, r);
+    }
+    set(d, "records", records);
+    return d;
+}
+
+/* 64 blobs from 16 bytes to 64 KiB with a few fields each */
+static crous_value *make_binary_heavy(void) {
+    crous_value *list = crous_value_new_list(64);
+    uint32_t x = 2463534242u;
+    for (int i = 0; i < 64; i++) {
+        size_t len = (size_t)16 << (i % 13);
+        uint8_t *blob = malloc(len);
+        for (size_t j = 0; j < len; j++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            blob[j] = (uint8_t)x;
+        }
+        crous_value *d = crous_value_new_dict(3);
+        set(d, "id", I(i));
+        set(d, "mime", S(i % 2 ? "image/png" : "application/octet-stream"));
+        set(d, "data", crous_value_new_bytes_take(blob, len));
+        push(list, d);
+    }
+    return list;
+}
+
+/* Dicts and lists alternating 200 levels down, each with a scalar beside */
+static crous_value *make_deep_nesting(void) {
+    crous_value *v = S("bottom");
+    for (int depth = 200; depth > 0; depth--) {
+        if (depth % 2) {
+            crous_value *d = crous_value_new_dict(2);
+            set(d, "level", I(depth));
+            set(d, "child", v);
+            v = d;
+        } else {
+            crous_value *l = crous_value_new_list(2);
+            push(push(l, I(depth)), v);
+            v = l;
+        }
+    }
+    return v;
+}
+
+/* One dict of 10000 distinct keys */
+static crous_value *make_wide_dict(void) {
+    char key[32];
+    crous_value *d = crous_value_new_dict(10000);
+    for (int i = 0; i < 10000; i++) {
+        snprintf(key, sizeof(key), "field_%05d", i);
+        set(d, key, i % 2 ? I(i * 31) : F(i * 0.5));
+    }
+    return d;
+}
+
+/* 100000 ints and 100000 floats as plain lists */
+static crous_value *make_numeric_lists(void) {
+    crous_value *d = crous_value_new_dict(2);
+    crous_value *ints = crous_value_new_list(100000);
+    crous_value *floats = crous_value_new_list(100000);
+    for (int i = 0; i < 100000; i++) {
+        push(ints, I((int64_t)i * 7919 - 400000));
+        push(floats, F(i * 0.001));
+    }
+    set(d, "integers", ints);
+    set(d, "floats", floats);
+    return d;
+}
+
+typedef struct {
+    const char *name;
+    crous_value *(*make)(void);
+} dataset_t;
+
+static const dataset_t datasets[] = {
+    {"small_api", make_small_api},
+    {"config", make_config},
+    {"records_1000", make_records},
+    {"binary_heavy", make_binary_heavy},
+    {"deep_nesting", make_deep_nesting},
+    {"wide_dict", make_wide_dict},
+    {"numeric_lists", make_numeric_lists},
+};
+
+/* ============================================================================
+   CODECS
+   ============================================================================ */
+
+/*
+ * A case prepares its input once, then op() runs repeatedly on it. Encode
+ * ops read the tree, decode ops the encoded bytes; every op frees what it
+ * produced so repeated runs measure steady state.
+ */
+typedef struct {
+    const crous_value *tree;
+    const uint8_t *flux;       /* flux_encode_binary() of tree */
+    size_t flux_len;
+    const uint8_t *wire;       /* This codec's encoding of tree */
+    size_t wire_len;
+} bench_input;
+
+/* Legacy CROUS v2 writer: header, then the tagged value stream */
+typedef struct {
+    uint8_t *data;
+    size_t len, cap;
+} grow_buf;
+
+static size_t grow_write(void *user_data, const uint8_t *buf, size_t len) {
+    grow_buf *g = user_data;
+    if (g->len + len > g->cap) {
+        size_t cap = g->cap ? g->cap : 256;
+        while (cap < g->len + len) cap *= 2;
+        uint8_t *data = realloc(g->data, cap);
+        if (!data) return 0;
+        g->data = data;
+        g->cap = cap;
+    }
+    memcpy(g->data + g->len, buf, len);
+    g->len += len;
+    return len;
+}
+
+typedef struct {
+    const uint8_t *data;
+    size_t pos, len;
+} read_buf;
+
+static size_t buf_read(void *user_data, uint8_t *buf, size_t max_len) {
+    read_buf *r = user_data;
+    size_t n = r->len - r->pos < max_len ? r->len - r->pos : max_len;
+    memcpy(buf, r->data + r->pos, n);
+    r->pos += n;
+    return n;
+}
+
+/* Encoders: this codec's bytes for v, freed by the caller */
+static crous_err_t enc_flux(const crous_value *v, uint8_t **out, size_t *len) {
+    return flux_encode_binary(v, out, len);
+}
+
+static crous_err_t enc_legacy(const crous_value *v, uint8_t **out, size_t *len) {
+    static const uint8_t header[6] = {CROUS_MAGIC_0, CROUS_MAGIC_1, CROUS_MAGIC_2, CROUS_MAGIC_3,
+                                      CROUS_VERSION, 0};
+    grow_buf g = {NULL, 0, 0};
+    crous_output_stream s = {&g, grow_write};
+    crous_err_t err = grow_write(&g, header, sizeof(header)) == sizeof(header)
+                          ? crous_encode_value_to_stream(v, &s)
+                          : CROUS_ERR_OOM;
+    if (err != CROUS_OK) {
+        free(g.data);
+        return err;
+    }
+    *out = g.data;
+    *len = g.len;
+    return CROUS_OK;
+}
+
+static crous_err_t enc_text(const crous_value *v, uint8_t **out, size_t *len) {
+    return flux_encode_text(v, (char **)out, len);
+}
+
+static crous_err_t enc_crout(const crous_value *v, uint8_t **out, size_t *len) {
+    crout_options_t opts = crout_options_default();
+    return crout_encode(v, &opts, (char **)out, len);
+}
+
+/* Decoders: a tree from this codec's bytes */
+static crous_err_t dec_flux(const uint8_t *buf, size_t len, crous_value **out) {
+    return flux_decode_binary(buf, len, out);
+}
+
+/* crous_decode() hands legacy input to the value reader without skipping
+   its header; the stream decoder checks and skips it */
+static crous_err_t dec_legacy(const uint8_t *buf, size_t len, crous_value **out) {
+    read_buf r = {buf, 0, len};
+    crous_input_stream s = {&r, buf_read};
+    return crous_decode_stream(&s, out);
+}
+
+static crous_err_t dec_text(const uint8_t *buf, size_t len, crous_value **out) {
+    return flux_decode_text((const char *)buf, len, out);
+}
+
+static crous_err_t dec_crout(const uint8_t *buf, size_t len, crous_value **out) {
+    return crout_decode((const char *)buf, len, out);
+}
+
+/* Transcoders, FLUX <-> CROUT without a tree */
+static crous_err_t flux_to_crout(const uint8_t *buf, size_t len, uint8_t **out, size_t *out_len) {
+    crout_options_t opts = crout_options_default();
+    return crout_flux_to_text(buf, len, &opts, (char **)out, out_len);
+}
+
+static crous_err_t crout_to_flux(const uint8_t *buf, size_t len, uint8_t **out, size_t *out_len) {
+    return crout_text_to_flux((const char *)buf, len, out, out_len);
+}
+
+typedef enum { OP_ENCODE, OP_DECODE, OP_TRANSCODE } bench_kind;
+
+typedef struct {
+    const char *codec;
+    const char *op;
+    bench_kind kind;
+    crous_err_t (*encode)(const crous_value *v, uint8_t **out, size_t *len);
+    crous_err_t (*decode)(const uint8_t *buf, size_t len, crous_value **out);
+    crous_err_t (*transcode)(const uint8_t *buf, size_t len, uint8_t **out, size_t *out_len);
+    int from_flux;      /* Transcoder input is the FLUX bytes, not this codec's */
+} bench_case;
+
+static const bench_case cases[] = {
+    {"flux_binary", "encode", OP_ENCODE, enc_flux, NULL, NULL, 0},
+    {"flux_binary", "decode", OP_DECODE, enc_flux, dec_flux, NULL, 0},
+    {"legacy_binary", "encode", OP_ENCODE, enc_legacy, NULL, NULL, 0},
+    {"legacy_binary", "decode", OP_DECODE, enc_legacy, dec_legacy, NULL, 0},
+    {"flux_text", "encode", OP_ENCODE, enc_text, NULL, NULL, 0},
+    {"flux_text", "decode", OP_DECODE, enc_text, dec_text, NULL, 0},
+    {"crout", "encode", OP_ENCODE, enc_crout, NULL, NULL, 0},
+    {"crout", "decode", OP_DECODE, enc_crout, dec_crout, NULL, 0},
+    {"transcode", "flux_to_crout", OP_TRANSCODE, enc_crout, NULL, flux_to_crout, 1},
+    {"transcode", "crout_to_flux", OP_TRANSCODE, enc_crout, NULL, crout_to_flux, 0},
+};
+
+/* Input bytes of a decode or transcode op */
+static const uint8_t *case_input(const bench_case *c, const bench_input *in, size_t *len) {
+    *len = c->from_flux ? in->flux_len : in->wire_len;
+    return c->from_flux ? in->flux : in->wire;
+}
+
+static crous_err_t run_op(const bench_case *c, const bench_input *in) {
+    uint8_t *buf;
+    size_t len;
+    crous_value *v;
+    crous_err_t err;
+    switch (c->kind) {
+        case OP_ENCODE:
+            err = c->encode(in->tree, &buf, &len);
+            if (err == CROUS_OK) free(buf);
+            return err;
+        case OP_DECODE:
+            err = c->decode(in->wire, in->wire_len, &v);
+            if (err == CROUS_OK) crous_value_free_tree(v);
+            return err;
+        default: {
+            size_t in_len;
+            const uint8_t *src = case_input(c, in, &in_len);
+            err = c->transcode(src, in_len, &buf, &len);
+            if (err == CROUS_OK) free(buf);
+            return err;
+        }
+    }
+}
+
+/*
+ * Make sure a case computes the right thing before timing it: decoded
+ * trees must re-encode to the dataset's FLUX bytes, and transcoder output
+ * must match encoding the tree directly. CROUS_ERR_DECODE on a mismatch.
+ */
+static crous_err_t check_case(const bench_case *c, const bench_input *in) {
+    if (c->kind == OP_ENCODE) return CROUS_OK;
+
+    uint8_t *out;
+    size_t out_len;
+    crous_err_t err;
+    const uint8_t *expect;
+    size_t expect_len;
+    if (c->kind == OP_DECODE) {
+        crous_value *v;
+        err = c->decode(in->wire, in->wire_len, &v);
+        if (err != CROUS_OK) return err;
+        err = flux_encode_binary(v, &out, &out_len);
+        crous_value_free_tree(v);
+        expect = in->flux;
+        expect_len = in->flux_len;
+    } else {
+        size_t in_len;
+        const uint8_t *src = case_input(c, in, &in_len);
+        err = c->transcode(src, in_len, &out, &out_len);
+        expect = c->from_flux ? in->wire : in->flux;
+        expect_len = c->from_flux ? in->wire_len : in->flux_len;
+    }
+    if (err != CROUS_OK) return err;
+    int same = out_len == expect_len && memcmp(out, expect, out_len) == 0;
+    free(out);
+    return same ? CROUS_OK : CROUS_ERR_DECODE;
+}
+
+/* ============================================================================
+   RUNNER
+   ============================================================================ */
+
+typedef struct {
+    int samples;
+    double min_time_ns;   /* Per sample */
+    const char *filter;
+    FILE *json;
+    FILE *table;          /* Human-readable rows */
+} bench_config;
+
+typedef struct {
+    double ns_median;
+    double ns_min;
+    double allocs;        /* Per op; < 0 when not counted */
+    long peak_rss_kb;
+    unsigned long iterations;
+} bench_result;
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static crous_err_t run_case(const bench_config *cfg, const bench_case *c, const bench_input *in,
+                            bench_result *res) {
+    crous_err_t err = check_case(c, in);
+    if (err != CROUS_OK) return err;
+
+    /* Warm up and size a sample to take about min_time */
+    unsigned long iters = 1;
+    for (;;) {
+        double t0 = now_ns();
+        for (unsigned long i = 0; i < iters; i++) {
+            err = run_op(c, in);
+            if (err != CROUS_OK) return err;
+        }
+        double dt = now_ns() - t0;
+        if (dt >= cfg->min_time_ns || iters >= (1UL << 30)) break;
+        iters = dt > 0 ? (unsigned long)(iters * (cfg->min_time_ns / dt) * 1.1) + 1 : iters * 10;
+    }
+
+    double *per_op = malloc(sizeof(double) * (size_t)cfg->samples);
+    if (!per_op) return CROUS_ERR_OOM;
+    rss_reset();
+    for (int s = 0; s < cfg->samples; s++) {
+        double t0 = now_ns();
+        for (unsigned long i = 0; i < iters; i++) run_op(c, in);
+        per_op[s] = (now_ns() - t0) / (double)iters;
+    }
+    res->peak_rss_kb = rss_peak_kb();
+    qsort(per_op, (size_t)cfg->samples, sizeof(double), cmp_double);
+    res->ns_min = per_op[0];
+    res->ns_median = per_op[cfg->samples / 2];
+    res->iterations = iters;
+    free(per_op);
+
+#ifdef CROUS_BENCH_WRAP_MALLOC
+    size_t before = alloc_count;
+    run_op(c, in);
+    res->allocs = (double)(alloc_count - before);
+#else
+    res->allocs = -1;
+#endif
+    return CROUS_OK;
+}
+
+static void json_result(FILE *f, int first, const char *dataset, const bench_case *c,
+                        size_t bytes, const bench_result *r, crous_err_t err) {
+    fprintf(f, "%s\n    {\"dataset\": \"%s\", \"codec\": \"%s\", \"op\": \"%s\", \"bytes\": %zu, ",
+            first ? "" : ",", dataset, c->codec, c->op, bytes);
+    if (err != CROUS_OK) {
+        fprintf(f, "\"error\": \"%s\"}", crous_err_str(err));
+        return;
+    }
+    fprintf(f, "\"ns_per_op\": %.1f, \"ns_min\": %.1f, \"mb_per_s\": %.2f, ", r->ns_median,
+            r->ns_min, bytes / (r->ns_median / 1e9) / 1e6);
+    if (r->allocs >= 0) fprintf(f, "\"allocs_per_op\": %.0f, ", r->allocs);
+    else fprintf(f, "\"allocs_per_op\": null, ");
+    fprintf(f, "\"peak_rss_kb\": %ld, \"iterations\": %lu}", r->peak_rss_kb, r->iterations);
+}
+
+static void table_result(FILE *f, const char *dataset, const bench_case *c, size_t bytes,
+                         const bench_result *r, crous_err_t err) {
+    fprintf(f, "%-14s %-14s %-14s %10zu ", dataset, c->codec, c->op, bytes);
+    if (err != CROUS_OK) {
+        fprintf(f, "%12s  %s\n", "error", crous_err_str(err));
+        return;
+    }
+    fprintf(f, "%12.0f %10.1f ", r->ns_median, bytes / (r->ns_median / 1e9) / 1e6);
+    if (r->allocs >= 0) fprintf(f, "%10.0f", r->allocs);
+    else fprintf(f, "%10s", "-");
+    fprintf(f, " %10ld\n", r->peak_rss_kb);
+}
+
+static int matches(const bench_config *cfg, const char *dataset, const bench_case *c) {
+    if (!cfg->filter) return 1;
+    char name[128];
+    snprintf(name, sizeof(name), "%s/%s/%s", dataset, c->codec, c->op);
+    return strstr(name, cfg->filter) != NULL;
+}
+
+/* Every matching case of every dataset; returns how many could not run */
+static int run_all(const bench_config *cfg) {
+    int failures = 0, first = 1;
+    if (cfg->json) {
+        fprintf(cfg->json, "{\n  \"crous_version\": \"%s\",\n", CROUS_VERSION_STRING);
+#ifdef __VERSION__
+        fprintf(cfg->json, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+        fprintf(cfg->json, "  \"samples\": %d,\n  \"min_time_ms\": %.0f,\n  \"results\": [",
+                cfg->samples, cfg->min_time_ns / 1e6);
+    }
+    fprintf(cfg->table, "%-14s %-14s %-14s %10s %12s %10s %10s %10s\n", "dataset", "codec", "op",
+            "bytes", "ns/op", "MB/s", "allocs/op", "rss KiB");
+
+    for (size_t d = 0; d < sizeof(datasets) / sizeof(datasets[0]); d++) {
+        const char *name = datasets[d].name;
+        crous_value *tree = datasets[d].make();
+        uint8_t *flux = NULL;
+        bench_input in = {tree, NULL, 0, NULL, 0};
+        if (!tree || flux_encode_binary(tree, &flux, &in.flux_len) != CROUS_OK) {
+            fprintf(stderr, "%s: dataset could not be built\n", name);
+            crous_value_free_tree(tree);
+            failures++;
+            continue;
+        }
+        in.flux = flux;
+
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            const bench_case *c = &cases[i];
+            if (!matches(cfg, name, c)) continue;
+
+            uint8_t *wire = NULL;
+            bench_result r = {0};
+            crous_err_t err = c->encode(tree, &wire, &in.wire_len);
+            in.wire = wire;
+            if (err == CROUS_OK) err = run_case(cfg, c, &in, &r);
+            if (err != CROUS_OK) failures++;
+
+            /* Wire bytes one op reads or writes */
+            size_t bytes = c->from_flux ? in.flux_len : in.wire_len;
+            if (err != CROUS_OK && !wire) bytes = 0;
+            table_result(cfg->table, name, c, bytes, &r, err);
+            fflush(cfg->table);
+            if (cfg->json) {
+                json_result(cfg->json, first, name, c, bytes, &r, err);
+                first = 0;
+            }
+            free(wire);
+        }
+        free(flux);
+        crous_value_free_tree(tree);
+    }
+
+    if (cfg->json) fprintf(cfg->json, "\n  ]\n}\n");
+    return failures;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [--json FILE] [--filter TEXT] [--samples N] [--min-time MS] [--strict]\n"
+            "  --json FILE    also write results as JSON (\"-\" for stdout)\n"
+            "  --filter TEXT  only cases whose dataset/codec/op name contains TEXT\n"
+            "  --samples N    timed samples per case, median reported (default 7)\n"
+            "  --min-time MS  minimum duration of one sample (default 50)\n"
+            "  --strict       exit 1 if any case fails instead of recording it\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    bench_config cfg = {7, 50e6, NULL, NULL, stdout};
+    const char *json_path = NULL;
+    int strict = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--json") == 0 && val) json_path = argv[++i];
+        else if (strcmp(arg, "--filter") == 0 && val) cfg.filter = argv[++i];
+        else if (strcmp(arg, "--samples") == 0 && val) cfg.samples = atoi(argv[++i]);
+        else if (strcmp(arg, "--min-time") == 0 && val) cfg.min_time_ns = atof(argv[++i]) * 1e6;
+        else if (strcmp(arg, "--strict") == 0) strict = 1;
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (cfg.samples < 1 || cfg.min_time_ns <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (json_path) {
+        cfg.json = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (!cfg.json) {
+            perror(json_path);
+            return 2;
+        }
+    }
+    /* Keep the table off stdout when the JSON goes there */
+    if (cfg.json == stdout) cfg.table = stderr;
+
+    int failures = run_all(&cfg);
+    if (cfg.json && cfg.json != stdout) fclose(cfg.json);
+    return strict && failures ? 1 : 0;
+}
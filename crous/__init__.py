@@ -8,13 +8,23 @@ Version: 2.0.0
 Public API:
     Serialization:
         - dumps(obj, *, default=None, encoder=None, allow_custom=True) -> bytes
+        - dumps_into(obj, buffer, offset=0, **dumps_options) -> int
         - dump(obj, fp, *, default=None) -> None
         - loads(data, *, decoder=None, object_hook=None) -> object
         - load(fp, *, object_hook=None) -> object
+        - loads_lazy(data) -> LazyDict | LazyList | object
+        - visit(data, visitor) -> None
+        - iter_load(fp, *, object_hook=None) -> Iterator[object]
+        - iter_loads(fp, *, items=False, object_hook=None) -> Iterator[object]
+        - load_parallel(path, *, workers=0, object_hook=None) -> list
     
     Classes:
-        - CrousEncoder: Encoder class for custom serialization
-        - CrousDecoder: Decoder class for custom deserialization
+        - CrousEncoder: Encoder session that keeps its buffers across encode() calls
+        - CrousDecoder: Decoder session that keeps its key cache and buffers across decode() calls
+        - LazyDict / LazyList: Read-only proxies returned by loads_lazy()
+        - FrameWriter: Appends records to a framed log read by iter_load()
+        - FrameFile: Indexed random access to a framed log through a memory mapping
+        - Unpacker: Incremental decoder for a stream of concatenated documents
     
     Custom Serializers:
         - register_serializer(typ, func) -> None
@@ -22,6 +32,25 @@ Public API:
         - register_decoder(tag, func) -> None
         - unregister_decoder(tag) -> None
     
+    Shared Dictionaries:
+        - register_dictionary(id, samples) -> None
+    
+    Schemas:
+        - Schema(fields, id): Positional encoder/decoder for one message shape
+        - register_schema(schema) -> None
+    
+    Checksums:
+        - crc32c(data, value=0) -> int
+    
+    Threads:
+        - set_threads(n) -> None
+        - get_threads() -> int
+    
+    Instrumentation:
+        - enable_stats(enabled=True) -> None
+        - get_stats(*, thread=False) -> dict
+        - reset_stats() -> None
+    
     Version Control:
         - version_info() -> VersionInfo
         - check_compatibility(data) -> CompatibilityResult
@@ -74,7 +103,14 @@ Examples:
 """
 
 import os
-from typing import Any, Union, BinaryIO
+import typing
+from collections.abc import Mapping, Sequence
+from typing import Any, Iterator, Optional, Union, BinaryIO
+
+try:
+    from types import UnionType as _UnionType
+except ImportError:  # Python < 3.10
+    _UnionType = None
 
 # Import from C extension
 try:
@@ -113,6 +149,7 @@ from .version import (
 
 # Re-export C extension functions directly
 dumps = _crous_ext.dumps
+dumps_into = _crous_ext.dumps_into
 loads = _crous_ext.loads
 CrousEncoder = _crous_ext.CrousEncoder
 CrousDecoder = _crous_ext.CrousDecoder
@@ -120,10 +157,36 @@ register_serializer = _crous_ext.register_serializer
 unregister_serializer = _crous_ext.unregister_serializer
 register_decoder = _crous_ext.register_decoder
 unregister_decoder = _crous_ext.unregister_decoder
+register_dictionary = _crous_ext.register_dictionary
+register_schema = _crous_ext.register_schema
+crc32c = _crous_ext.crc32c
+set_threads = _crous_ext.set_threads
+get_threads = _crous_ext.get_threads
+enable_stats = _crous_ext.enable_stats
+get_stats = _crous_ext.get_stats
+reset_stats = _crous_ext.reset_stats
 CrousError = _crous_ext.CrousError
 CrousEncodeError = _crous_ext.CrousEncodeError
 CrousDecodeError = _crous_ext.CrousDecodeError
 
+# On-demand access to FLUX binary
+loads_lazy = _crous_ext.loads_lazy
+LazyDict = _crous_ext.LazyDict
+LazyList = _crous_ext.LazyList
+
+# Event-callback walks
+visit = _crous_ext.visit
+Mapping.register(LazyDict)
+Sequence.register(LazyList)
+
+# Record-framed logs
+FrameWriter = _crous_ext.FrameWriter
+FrameFile = _crous_ext.FrameFile
+load_parallel = _crous_ext.load_parallel
+
+# Incremental decoding
+Unpacker = _crous_ext.Unpacker
+
 # CROUT text format
 dumps_text = _crous_ext.dumps_text
 loads_text = _crous_ext.loads_text
@@ -133,19 +196,44 @@ flux_to_text = _crous_ext.flux_to_text
 __all__ = [
     # Serialization
     "dumps",
+    "dumps_into",
     "dump",
     "loads",
     "load",
     "dumps_stream",
     "loads_stream",
+    "loads_lazy",
+    "visit",
+    "iter_load",
+    "iter_loads",
+    "load_parallel",
     # Classes
     "CrousEncoder",
     "CrousDecoder",
+    "LazyDict",
+    "LazyList",
+    "FrameWriter",
+    "FrameFile",
+    "Unpacker",
     # Custom serializers
     "register_serializer",
     "unregister_serializer",
     "register_decoder",
     "unregister_decoder",
+    # Shared dictionaries
+    "register_dictionary",
+    # Schemas
+    "Schema",
+    "register_schema",
+    # Checksums
+    "crc32c",
+    # Threads
+    "set_threads",
+    "get_threads",
+    # Instrumentation
+    "enable_stats",
+    "get_stats",
+    "reset_stats",
     # Exceptions
     "CrousError",
     "CrousEncodeError",
@@ -196,6 +284,12 @@ def dump(
     fp: Union[str, BinaryIO],
     *,
     default=None,
+    key_refs: bool = False,
+    columnar: bool = False,
+    compression: Optional[str] = None,
+    dictionary: Optional[int] = None,
+    checksum: bool = False,
+    max_depth: Optional[int] = None,
 ) -> None:
     """
     Serialize obj to a file-like object or file path.
@@ -209,6 +303,16 @@ def dump(
             - A file path (str): Automatically opened/closed
             - A file object: Must have write() method (open in 'wb' mode)
         default: Optional callable for custom types (not yet implemented).
+        key_refs: Write repeated dict keys as back-references (wire v3).
+        columnar: Write lists of same-shaped dicts as column tables (wire v4).
+        compression: None, or 'lz4' to write a compressed envelope, 64 KiB
+            blocks compressed one at a time. Every loader reads it back.
+        dictionary: None, or the id of a dictionary registered with
+            register_dictionary(); loaders need it registered too.
+        checksum: Give every block of the envelope a CRC-32C, checked by
+            loaders as they decode; damage raises CrousDecodeError.
+        max_depth: Fail on values nested this deep; None allows 65536
+            levels, which a container that contains itself always reaches.
     
     Returns:
         None
@@ -233,20 +337,25 @@ def dump(
     if isinstance(fp, str):
         try:
             with open(fp, 'wb') as f:
-                _crous_ext.dump(obj, f, default=default)
+                _crous_ext.dump(obj, f, default=default, key_refs=key_refs, columnar=columnar,
+                                compression=compression, dictionary=dictionary, checksum=checksum,
+                                max_depth=max_depth)
         except IOError as e:
             raise IOError(f"Failed to write to {fp}: {e}") from e
     else:
         # Assume file-like object
         if not hasattr(fp, 'write'):
             raise TypeError(f"fp must be str or have write() method, got {type(fp)}")
-        _crous_ext.dump(obj, fp, default=default)
+        _crous_ext.dump(obj, fp, default=default, key_refs=key_refs, columnar=columnar,
+                        compression=compression, dictionary=dictionary, checksum=checksum,
+                        max_depth=max_depth)
 
 
 def load(
     fp: Union[str, BinaryIO],
     *,
     object_hook=None,
+    max_depth: Optional[int] = None,
 ) -> Any:
     """
     Deserialize from a file-like object or file path.
@@ -259,6 +368,14 @@ def load(
             - A file path (str): Automatically opened/closed
             - A file object: Must have read() method (open in 'rb' mode)
         object_hook: Optional callable for dict post-processing (not yet implemented).
+        max_depth: Reject documents nested this deep; None means 256, the
+            limit of every other decoder.
+    
+    Regular files are decoded from a read-only memory mapping of their bytes
+    from the current position on, and io.BytesIO objects from their
+    getbuffer() view, instead of a read() copy; the file is left at EOF
+    either way. The file must not be truncated while load() runs. Other
+    objects are read with read(), which may return any bytes-like object.
     
     Returns:
         Deserialized Python object.
@@ -285,14 +402,14 @@ def load(
         
         try:
             with open(fp, 'rb') as f:
-                return _crous_ext.load(f, object_hook=object_hook)
+                return _crous_ext.load(f, object_hook=object_hook, max_depth=max_depth)
         except IOError as e:
             raise IOError(f"Failed to read from {fp}: {e}") from e
     else:
         # Assume file-like object
         if not hasattr(fp, 'read'):
             raise TypeError(f"fp must be str or have read() method, got {type(fp)}")
-        return _crous_ext.load(fp, object_hook=object_hook)
+        return _crous_ext.load(fp, object_hook=object_hook, max_depth=max_depth)
 
 
 def dumps_stream(
@@ -300,17 +417,33 @@ def dumps_stream(
     fp: BinaryIO,
     *,
     default=None,
+    key_refs: bool = False,
+    columnar: bool = False,
+    compression: Optional[str] = None,
+    dictionary: Optional[int] = None,
+    checksum: bool = False,
+    max_depth: Optional[int] = None,
 ) -> None:
     """
-    Stream-based serialization (currently identical to dump for file objects).
+    Stream-based serialization.
     
     This function serializes an object to a file-like object with stream semantics.
-    It's designed for use with file objects and custom stream implementations.
+    Output is passed to ``fp.write()`` in blocks of up to 64 KiB as it is produced,
+    so the encoded payload is never staged in memory as a whole.
     
     Args:
         obj: Python object to serialize.
         fp: File-like object with write() method (must be opened in 'wb' mode).
         default: Optional callable for custom types (not yet implemented).
+        key_refs: Write repeated dict keys as back-references (wire v3).
+        columnar: Write lists of same-shaped dicts as column tables (wire v4).
+        compression: None, or 'lz4' to write a compressed envelope, 64 KiB
+            blocks compressed one at a time. Every loader reads it back.
+        dictionary: None, or the id of a dictionary registered with
+            register_dictionary(); loaders need it registered too.
+        checksum: Give every block of the envelope a CRC-32C, checked by
+            loaders as they decode; damage raises CrousDecodeError.
+        max_depth: As for dump().
     
     Returns:
         None
@@ -330,7 +463,9 @@ def dumps_stream(
     # Assume file-like object
     if not hasattr(fp, 'write'):
         raise TypeError(f"fp must have write() method, got {type(fp)}")
-    _crous_ext.dumps_stream(obj, fp, default=default)
+    _crous_ext.dumps_stream(obj, fp, default=default, key_refs=key_refs, columnar=columnar,
+                            compression=compression, dictionary=dictionary, checksum=checksum,
+                            max_depth=max_depth)
 
 
 def loads_stream(
@@ -339,10 +474,14 @@ def loads_stream(
     object_hook=None,
 ) -> Any:
     """
-    Stream-based deserialization (currently identical to load for file objects).
+    Stream-based deserialization.
     
     This function deserializes an object from a file-like object with stream semantics.
-    It's designed for use with file objects and custom stream implementations.
+    FLUX input is pulled in chunks of up to 64 KiB and decoded incrementally,
+    so the whole encoded payload is never held in memory at once. Binary files
+    fill the decoder's chunk buffer in place through ``fp.readinto()``; other
+    objects are read with ``fp.read(n)``, which may return any bytes-like
+    object. Short reads (pipes, sockets) are fine.
     
     Args:
         fp: File-like object with read() method (must be opened in 'rb' mode).
@@ -369,6 +508,181 @@ def loads_stream(
     return _crous_ext.loads_stream(fp, object_hook=object_hook)
 
 
+def iter_load(
+    fp: Union[str, BinaryIO],
+    *,
+    object_hook=None,
+) -> Iterator[Any]:
+    """
+    Iterate the records of a framed log.
+    
+    Reads a log written by ``FrameWriter`` one record at a time. The file is
+    pulled with ``fp.read(n)`` in chunks of up to 64 KiB, so memory use is
+    bounded by the largest record rather than the file.
+    
+    Args:
+        fp: Either:
+            - A file path (str): Opened for the iteration and closed after it
+            - A file object: Must have read() method (open in 'rb' mode)
+        object_hook: Optional callable for dict post-processing.
+    
+    Returns:
+        Iterator over the decoded records.
+    
+    Raises:
+        CrousDecodeError: If fp is not a framed log, a record fails its
+            checksum, or the log ends part-way through a record (an
+            interrupted append). Records before it have been yielded.
+        TypeError: If fp is not str or file-like.
+    
+    Examples:
+        >>> import crous
+        >>> with open('events.log', 'ab') as f, crous.FrameWriter(f) as w:
+        ...     w.write({'event': 'login'})
+        >>> for record in crous.iter_load('events.log'):
+        ...     print(record)
+    """
+    if isinstance(fp, str):
+        return _iter_load_path(fp, object_hook)
+    if not hasattr(fp, 'read'):
+        raise TypeError(f"fp must be str or have read() method, got {type(fp)}")
+    return _crous_ext.iter_load(fp, object_hook=object_hook)
+
+
+def _iter_load_path(path: str, object_hook) -> Iterator[Any]:
+    with open(path, 'rb') as f:
+        yield from _crous_ext.iter_load(f, object_hook=object_hook)
+
+
+def iter_loads(
+    fp: Union[str, BinaryIO],
+    *,
+    items: bool = False,
+    object_hook=None,
+) -> Iterator[Any]:
+    """
+    Iterate the documents of a stream of concatenated FLUX documents.
+    
+    Each document is yielded as soon as its last byte has been read, so a
+    consumer can start before the stream ends. With ``items=True`` the
+    elements of a top-level list are yielded one by one as they arrive
+    instead of the whole list; other top-level values are yielded as they
+    are. Memory use is then bounded by the largest element.
+    
+    For input that arrives in pieces (a socket, a queue), use ``Unpacker``
+    and push the bytes with ``feed()``.
+    
+    Args:
+        fp: Either:
+            - A file path (str): Opened for the iteration and closed after it
+            - A file object: Must have read() method (open in 'rb' mode);
+              readinto() is used when available
+        items: Yield the elements of top-level lists individually.
+        object_hook: Optional callable for dict post-processing.
+    
+    Returns:
+        Iterator over the decoded documents (or list elements).
+    
+    Raises:
+        CrousDecodeError: If a document is malformed or the stream ends
+            part-way through one. Values before it have been yielded.
+        TypeError: If fp is not str or file-like.
+    
+    Examples:
+        >>> import crous
+        >>> with open('rows.flux', 'wb') as f:
+        ...     f.write(crous.dumps([{'id': i} for i in range(3)]))
+        >>> for row in crous.iter_loads('rows.flux', items=True):
+        ...     print(row)
+        {'id': 0}
+        {'id': 1}
+        {'id': 2}
+    """
+    if isinstance(fp, str):
+        return _iter_loads_path(fp, items, object_hook)
+    if not hasattr(fp, 'read'):
+        raise TypeError(f"fp must be str or have read() method, got {type(fp)}")
+    return Unpacker(fp, items=items, object_hook=object_hook)
+
+
+def _iter_loads_path(path: str, items: bool, object_hook) -> Iterator[Any]:
+    with open(path, 'rb') as f:
+        yield from Unpacker(f, items=items, object_hook=object_hook)
+
+
+_SCHEMA_TYPES = {
+    bool: "bool", int: "int", float: "float", str: "str", bytes: "bytes",
+    object: "any", Any: "any",
+}
+
+
+def _schema_name(name: Any) -> str:
+    if not isinstance(name, str):
+        raise TypeError(f"schema field names must be str, not {type(name).__name__}")
+    if name and all(c.isascii() and (c.isalnum() or c == "_") for c in name):
+        return name
+    return '"' + name.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def _schema_text(spec: Any) -> str:
+    """Schema text for a field mapping, a type, or text already."""
+    if isinstance(spec, str):
+        return spec
+    if isinstance(spec, _crous_ext.Schema):
+        return spec.spec
+    if isinstance(spec, Mapping):
+        fields = ", ".join(f"{_schema_name(k)}: {_schema_text(v)}" for k, v in spec.items())
+        return "{" + fields + "}"
+    if isinstance(spec, list) and len(spec) == 1:
+        return "[" + _schema_text(spec[0]) + "]"
+
+    origin, args = typing.get_origin(spec), typing.get_args(spec)
+    if origin is list and len(args) == 1:
+        return "[" + _schema_text(args[0]) + "]"
+    if origin is Union or (_UnionType is not None and origin is _UnionType):
+        present = [a for a in args if a is not type(None)]
+        if len(present) == 1 and len(args) == 2:
+            return _schema_text(present[0]) + "?"
+    try:
+        return _SCHEMA_TYPES[spec]
+    except (KeyError, TypeError):
+        pass
+    raise TypeError(f"{spec!r} has no schema type")
+
+
+class Schema(_crous_ext.Schema):
+    """
+    A fixed message shape, compiled once into a positional encoder and
+    decoder.
+    
+    Documents carry the schema id in their header and then the values
+    alone, field by field, with no keys and no type tags, so they are
+    smaller and faster to write than self-describing ones. dumps()
+    checks every value against the schema as it writes it.
+    
+    Args:
+        fields: Mapping of field name to type, in wire order. Types are
+            bool, int, float, str, bytes, object (any value), a nested
+            mapping or Schema (a record), a one-element list such as
+            [int] or list[int], and Optional[...] or `T | None` for
+            nullable fields. Schema text (see ARCHITECTURE.md) is taken
+            as is.
+        id: Schema id, 1 to 16777215, written in every document
+    
+    Example:
+        >>> point = crous.Schema({'x': float, 'y': float, 'label': Optional[str]}, id=7)
+        >>> data = point.dumps({'x': 1.0, 'y': 2.0, 'label': None})
+        >>> point.loads(data)
+        {'x': 1.0, 'y': 2.0, 'label': None}
+        >>> crous.register_schema(point)   # crous.loads() reads it too
+    """
+    
+    __slots__ = ()
+    
+    def __init__(self, fields: Any, id: int) -> None:
+        super().__init__(_schema_text(fields), id)
+
+
 def _ensure_api_compatibility() -> None:
     """
     Validate that all exported functions exist in the C extension.
@@ -381,6 +695,10 @@ def _ensure_api_compatibility() -> None:
         "register_decoder", "unregister_decoder",
         "CrousError", "CrousEncodeError", "CrousDecodeError",
         "dumps_text", "loads_text", "text_to_flux", "flux_to_text",
+        "loads_lazy", "LazyDict", "LazyList", "visit",
+        "iter_load", "FrameWriter", "FrameFile", "Unpacker",
+        "enable_stats", "get_stats", "reset_stats",
+        "Schema", "register_schema",
     ]
     
     for name in required:
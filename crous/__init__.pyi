@@ -7,12 +7,14 @@ It enables full IDE autocomplete, type checking, and hover help.
 Stubs follow PEP 561 conventions.
 """
 
-from typing import Any, Callable, Optional, Dict, List, Union, overload, TypeVar
+import os
+from typing import Any, Callable, Optional, Dict, Iterable, Iterator, List, Tuple, Union, overload, TypeVar
 
 # Type variables for generic support
 _T = TypeVar("_T")
 _SupportsWrite = Any  # File-like object with write() method
 _SupportsRead = Any   # File-like object with read() method
+_BufferLike = Any     # bytes, bytearray, memoryview, mmap: any buffer-protocol object
 
 # Supported serializable types
 CrousSerializable = Union[None, bool, int, float, str, bytes, list, dict]
@@ -63,6 +65,14 @@ def dumps(
     default: None = None,
     encoder: None = None,
     allow_custom: bool = True,
+    key_refs: bool = False,
+    columnar: bool = False,
+    compression: Optional[str] = None,
+    dictionary: Optional[int] = None,
+    checksum: bool = False,
+    threads: int = 1,
+    max_depth: Optional[int] = None,
+    dedup: bool = False,
 ) -> bytes:
     """
     Serialize obj to Crous binary format.
@@ -84,6 +94,31 @@ def dumps(
         default: Optional callable for custom types (not yet implemented).
         encoder: Optional encoder instance (not yet implemented).
         allow_custom: Whether to allow custom types (default True).
+        key_refs: Write each repeated dict key as a back-reference to its
+            first occurrence. Produces wire v3 output, which older readers
+            reject (default False).
+        columnar: Write each list of four or more dicts sharing the same
+            keys as a table of typed columns. Implies key_refs and produces
+            wire v4 output (default False).
+        compression: None, or 'lz4' to write a compressed envelope.
+        dictionary: Id of a dictionary from register_dictionary(): its keys
+            are written as one-byte references and blocks compress
+            against its content. Implies key_refs; readers need the same
+            dictionary registered (default None).
+        checksum: Give every envelope block a CRC-32C that loaders verify
+            as they decode, raising CrousDecodeError on a mismatch
+            (default False).
+        threads: Threads that compress and checksum envelope blocks; 0
+            means the pool size (set_threads()). The walk over obj runs
+            on the calling thread either way, and the output is the same
+            (default 1).
+        max_depth: Raise CrousEncodeError on values nested this deep.
+            None allows 65536 levels, so a container that contains itself
+            fails quickly instead of exhausting memory (default None).
+        dedup: Write each repeated string, bytes value or container once
+            and later copies as back-references. Implies key_refs and
+            produces wire v5 output; loaders still build a separate object
+            per occurrence. Encodes on one thread (default False).
     
     Returns:
         Binary bytes in Crous format.
@@ -108,16 +143,73 @@ def dumps(
     default: Optional[Callable[[Any], CrousSerializable]] = None,
     encoder: Optional[Any] = None,
     allow_custom: bool = True,
+    key_refs: bool = False,
+    columnar: bool = False,
+    compression: Optional[str] = None,
+    dictionary: Optional[int] = None,
+    checksum: bool = False,
+    threads: int = 1,
+    max_depth: Optional[int] = None,
+    dedup: bool = False,
 ) -> bytes:
     """Overload for custom default handler."""
     ...
 
+def dumps_into(
+    obj: Any,
+    buffer: Union[bytearray, memoryview, Any],
+    offset: int = 0,
+    *,
+    default: Optional[Callable[[Any], CrousSerializable]] = None,
+    key_refs: bool = False,
+    columnar: bool = False,
+    compression: Optional[str] = None,
+    dictionary: Optional[int] = None,
+    checksum: bool = False,
+    threads: int = 1,
+) -> int:
+    """
+    Serialize obj into a writable buffer instead of a new bytes object.
+    
+    Writes the same bytes dumps() returns, starting at buffer[offset].
+    A plain document is written in place, with no intermediate copy.
+    
+    Args:
+        obj: Python object to serialize.
+        buffer: Writable, contiguous bytes-like object: bytearray,
+            memoryview, mmap, multiprocessing.shared_memory buffers.
+        offset: Byte position in buffer to start at (default 0).
+        default, key_refs, columnar, compression, dictionary, checksum,
+        threads: As for dumps().
+    
+    Returns:
+        Number of bytes written.
+    
+    Raises:
+        CrousEncodeError: If object cannot be serialized, or if it does not
+            fit in buffer[offset:]. In that case the exception's needed
+            attribute is the number of bytes required, and the buffer may
+            have been partly written.
+        ValueError: If offset is outside the buffer.
+        BufferError: If buffer is read-only (TypeError if not bytes-like).
+    
+    Example:
+        >>> import crous
+        >>> ring = bytearray(4096)
+        >>> n = crous.dumps_into({'id': 1}, ring, 128)
+        >>> crous.loads(ring[128:128 + n])
+        {'id': 1}
+    """
+    ...
+
 @overload
 def loads(
-    data: Union[bytes, bytearray, memoryview],
+    data: _BufferLike,
     *,
     object_hook: None = None,
     decoder: None = None,
+    fields: Optional[Iterable[str]] = None,
+    max_depth: Optional[int] = None,
 ) -> CrousSerializable:
     """
     Deserialize Crous binary data to Python object.
@@ -126,9 +218,19 @@ def loads(
     Restores the exact structure that was serialized with dumps().
     
     Args:
-        data: Bytes-like object containing Crous-encoded data.
+        data: Bytes-like object containing Crous-encoded data (bytes,
+            bytearray, a contiguous memoryview, mmap, ...). It is decoded in
+            place, without a copy.
         object_hook: Optional callable for dict post-processing (not yet implemented).
         decoder: Optional decoder instance (not yet implemented).
+        fields: Optional paths to decode, such as "user.id" or "items[*].sku"
+            (dict keys joined by ".", [N] for one element, [*] for all).
+            Everything else is skipped without being built; the result keeps
+            the document's shape with only the selected parts. FLUX binary
+            input only.
+        max_depth: Reject FLUX documents nested this deep with
+            CrousDecodeError. None means 256, the limit of every other
+            decoder; fields= and legacy input keep that limit.
     
     Returns:
         Deserialized Python object (one of the supported types).
@@ -148,10 +250,12 @@ def loads(
 
 @overload
 def loads(
-    data: Union[bytes, bytearray, memoryview],
+    data: _BufferLike,
     *,
     object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
     decoder: Optional[Any] = None,
+    fields: Optional[Iterable[str]] = None,
+    max_depth: Optional[int] = None,
 ) -> Any:
     """Overload for custom object_hook."""
     ...
@@ -161,6 +265,12 @@ def dump(
     fp: _SupportsWrite,
     *,
     default: Optional[Callable[[Any], CrousSerializable]] = None,
+    key_refs: bool = False,
+    columnar: bool = False,
+    compression: Optional[str] = None,
+    dictionary: Optional[int] = None,
+    checksum: bool = False,
+    max_depth: Optional[int] = None,
 ) -> None:
     """
     Serialize obj to a file-like object.
@@ -172,6 +282,9 @@ def dump(
         obj: Python object to serialize.
         fp: File-like object with write(bytes) -> int method.
         default: Optional callable for custom types (not yet implemented).
+        key_refs: Write repeated dict keys as back-references (wire v3).
+        columnar: Write lists of same-shaped dicts as column tables (wire v4).
+        max_depth: As for dumps().
     
     Returns:
         None
@@ -192,16 +305,19 @@ def load(
     fp: _SupportsRead,
     *,
     object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
+    max_depth: Optional[int] = None,
 ) -> CrousSerializable:
     """
     Deserialize from a file-like object.
     
     Reads Crous binary data via fp.read() and decodes to Python object.
-    Equivalent to: loads(fp.read())
+    Equivalent to: loads(fp.read()). Regular files are memory-mapped and
+    io.BytesIO objects decoded from their buffer instead.
     
     Args:
-        fp: File-like object with read() -> bytes method.
+        fp: File-like object with read() -> bytes-like method.
         object_hook: Optional callable for dict post-processing (not yet implemented).
+        max_depth: As for loads().
     
     Returns:
         Deserialized Python object.
@@ -229,14 +345,22 @@ def dumps_stream(
     fp: _SupportsWrite,
     *,
     default: Optional[Callable[[Any], CrousSerializable]] = None,
+    key_refs: bool = False,
+    columnar: bool = False,
+    compression: Optional[str] = None,
+    dictionary: Optional[int] = None,
+    checksum: bool = False,
+    max_depth: Optional[int] = None,
 ) -> None:
     """
-    Stream-based serialization (currently same as dump).
+    Stream-based serialization, writing fp in blocks of up to 64 KiB.
     
     Args:
         obj: Object to serialize.
         fp: Output file-like object.
         default: Optional serializer for custom types.
+        key_refs: Write repeated dict keys as back-references (wire v3).
+        columnar: Write lists of same-shaped dicts as column tables (wire v4).
     
     Raises:
         CrousEncodeError: If serialization fails.
@@ -250,7 +374,8 @@ def loads_stream(
     object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
 ) -> CrousSerializable:
     """
-    Stream-based deserialization (currently same as load).
+    Stream-based deserialization, reading fp in chunks of up to 64 KiB,
+    through fp.readinto() when it has one and fp.read(n) otherwise.
     
     Args:
         fp: Input file-like object.
@@ -265,50 +390,394 @@ def loads_stream(
     """
     ...
 
+def iter_load(
+    fp: Union[str, _SupportsRead],
+    *,
+    object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
+) -> Iterator[Any]:
+    """
+    Iterate the records of a framed log written by FrameWriter.
+    
+    Args:
+        fp: File path, or input file-like object read in chunks of up to 64 KiB.
+        object_hook: Optional hook for dict post-processing.
+    
+    Returns:
+        Iterator over the decoded records.
+    
+    Raises:
+        CrousDecodeError: If fp is not a framed log, a record fails its
+            checksum, or the log ends part-way through a record.
+    """
+    ...
+
+def iter_loads(
+    fp: Union[str, _SupportsRead],
+    *,
+    items: bool = False,
+    object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
+) -> Iterator[Any]:
+    """
+    Iterate the documents of a stream of concatenated FLUX documents.
+    
+    Args:
+        fp: File path, or input file-like object (readinto() is used when available).
+        items: Yield the elements of top-level lists one by one as they arrive.
+        object_hook: Optional hook for dict post-processing.
+    
+    Returns:
+        Iterator over the decoded documents (or list elements).
+    
+    Raises:
+        CrousDecodeError: If a document is malformed or the stream ends
+            part-way through one.
+    """
+    ...
+
+def load_parallel(
+    path: str,
+    *,
+    workers: int = 0,
+    object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
+) -> List[Any]:
+    """
+    Decode every record of a framed log into a list, in log order.
+    
+    The file is memory-mapped and cut at its seek index into byte-balanced
+    record ranges. Workers check record checksums and unpack compressed
+    envelopes without the GIL, then the objects are built in order on the
+    calling thread.
+    
+    Args:
+        path: Path of the log.
+        workers: Threads to use; 0 means the pool size (set_threads()).
+        object_hook: Optional hook for dict post-processing.
+    
+    Returns:
+        The decoded records.
+    
+    Raises:
+        CrousDecodeError: If path is not a framed log, a record is corrupt
+            or fails its checksum, or the log ends part-way through a record.
+        OSError: If path cannot be opened.
+    """
+    ...
+
+def loads_lazy(data: Union[bytes, bytearray, memoryview]) -> Union["LazyDict", "LazyList", CrousSerializable]:
+    """
+    Open FLUX binary data for on-demand access.
+    
+    Dicts and lists come back as LazyDict / LazyList proxies that decode only
+    what is accessed and step over the rest without building it. Scalar
+    documents are returned decoded; legacy CROUS input is decoded outright.
+    
+    Args:
+        data: FLUX binary data. Kept alive by the proxies; must not change.
+    
+    Returns:
+        A proxy for the top-level container, or the top-level scalar.
+    
+    Raises:
+        CrousDecodeError: If the header, or any part walked, is malformed.
+    """
+    ...
+
+def visit(data: Union[bytes, bytearray, memoryview, str], visitor: Any) -> None:
+    """
+    Walk a document without building it, reporting each event to visitor.
+    
+    visitor may define any of these methods; missing ones skip their event:
+    
+        scalar(value)       None, bool, int, float, str or bytes
+        tag(tag)            the next value is tagged with this number
+        begin(kind, count)  'list', 'tuple' or 'dict' opens; count is None
+                            when the format doesn't store it (CROUT text)
+        key(name)           key of the next dict value
+        end(kind, count)    the innermost container closes
+    
+    Packed arrays and columnar tables are reported as the lists they read as.
+    
+    Args:
+        data: FLUX binary (bytes-like) or CROUT text (str).
+        visitor: Object receiving the events.
+    
+    Raises:
+        CrousDecodeError: If the input is malformed.
+        Any exception raised by a visitor method, which stops the walk.
+    """
+    ...
+
 # ============================================================================
 # ENCODER / DECODER CLASSES
 # ============================================================================
 
 class CrousEncoder:
     """
-    Encoder class for Crous serialization.
-    
-    Currently a stub class for API compatibility with json module.
-    In future versions, this may support incremental encoding and
-    custom type handlers.
+    Reusable encoder session with fixed options.
     
-    Methods:
-        (To be extended in future versions)
+    encode() gives the same bytes as dumps() with the options passed here,
+    but the output and envelope buffers are kept between calls, so a stream
+    of similar documents stops allocating once they have grown to size.
+    A call made while another is running on the same encoder (from another
+    thread, or from default) encodes with buffers of its own.
     
     Example:
         >>> import crous
-        >>> encoder = crous.CrousEncoder()
-        >>> # Future: encoder.encode(obj)
+        >>> encoder = crous.CrousEncoder(compression='lz4')
+        >>> packets = [encoder.encode(event) for event in [{'id': 1}, {'id': 2}]]
     """
     
-    def __init__(self) -> None:
-        """Initialize a Crous encoder."""
+    def __init__(
+        self,
+        default: Optional[Callable[[Any], CrousSerializable]] = None,
+        allow_custom: bool = True,
+        key_refs: bool = False,
+        columnar: bool = False,
+        compression: Optional[str] = None,
+        dictionary: Optional[int] = None,
+        checksum: bool = False,
+    ) -> None:
+        """Options as for dumps(); default is called for unsupported types."""
+        ...
+    
+    def encode(self, obj: CrousSerializable) -> bytes:
+        """
+        Serialize obj to FLUX binary, like dumps() with this encoder's options.
+        
+        Raises:
+            CrousEncodeError: If obj cannot be serialized.
+        """
         ...
 
 class CrousDecoder:
     """
-    Decoder class for Crous deserialization.
+    Reusable decoder session.
     
-    Currently a stub class for API compatibility with json module.
-    In future versions, this may support incremental decoding and
-    custom type handlers.
-    
-    Methods:
-        (To be extended in future versions)
+    decode() accepts everything loads() does. The decoder keeps its dict
+    key cache, envelope buffer and arena between calls, so repeated keys
+    are interned once and similar documents stop allocating scratch
+    memory. A call made while another is running on the same decoder
+    (from another thread, or from object_hook) decodes with buffers of its
+    own.
     
     Example:
         >>> import crous
         >>> decoder = crous.CrousDecoder()
-        >>> # Future: decoder.decode(binary_data)
+        >>> events = [decoder.decode(packet) for packet in packets]
+    """
+    
+    def __init__(self, object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None) -> None:
+        """object_hook is called with every decoded dict, as in loads()."""
+        ...
+    
+    def decode(self, data: _BufferLike) -> Any:
+        """
+        Deserialize FLUX binary, a compressed envelope or legacy CROUS data.
+        
+        Raises:
+            CrousDecodeError: If data is malformed.
+        """
+        ...
+
+class FrameWriter:
+    """
+    Appends records to a framed log, each an independent FLUX document.
+    
+    The file header is written only when fp starts empty (fp.tell() == 0),
+    so reopening a log in 'ab' mode continues it.
     """
     
-    def __init__(self) -> None:
-        """Initialize a Crous decoder."""
+    def __init__(
+        self,
+        fp: _SupportsWrite,
+        default: Optional[Callable[[Any], CrousSerializable]] = None,
+        checksum: bool = False,
+        key_refs: bool = False,
+        columnar: bool = False,
+        index: bool = False,
+        index_interval: int = 1024,
+    ) -> None:
+        """
+        Start or continue a log on fp; checksum=True gives each record a CRC-32C.
+        
+        With index=True, close() writes a sparse seek index of every
+        index_interval-th record, used by FrameFile.
+        """
+        ...
+    
+    def write(self, obj: CrousSerializable, key: Union[int, str, bytes, None] = None) -> None:
+        """
+        Append obj as one record.
+        
+        key is kept for indexed records and looked up by FrameFile.find();
+        keys must not decrease through the log. Ints order numerically.
+        """
+        ...
+    
+    def flush(self) -> None:
+        """Write buffered records to fp."""
+        ...
+    
+    def close(self) -> None:
+        """Flush and detach from fp. fp itself is not closed."""
+        ...
+    
+    @property
+    def closed(self) -> bool: ...
+    
+    def __enter__(self) -> "FrameWriter": ...
+    def __exit__(self, *args: Any) -> None: ...
+
+class FrameFile:
+    """
+    Random access to a framed log through a read-only memory mapping.
+    
+    Records are found through the index FrameWriter(index=True) leaves
+    behind; stretches without one are indexed on open by walking record
+    lengths.
+    
+    Example:
+        >>> with crous.FrameFile('events.log') as log:
+        ...     first, last = log[0], log[-1]
+        ...     for start, stop in log.split(4):
+        ...         pass  # hand each range to a worker: log.records(start, stop)
+    """
+    
+    def __init__(
+        self,
+        path: Union[str, "os.PathLike[str]"],
+        *,
+        object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
+    ) -> None: ...
+    
+    def __len__(self) -> int: ...
+    def __getitem__(self, index: int) -> Any: ...
+    def __iter__(self) -> Iterator[Any]: ...
+    
+    def records(self, start: int = 0, stop: Optional[int] = None) -> Iterator[Any]:
+        """Iterate records start to stop; without stop, to the end of the log."""
+        ...
+    
+    def find(self, key: Union[int, str, bytes]) -> int:
+        """Record number to scan from for key: the last indexed record whose key is <= key, or 0."""
+        ...
+    
+    def split(self, parts: int) -> List[Tuple[int, int]]:
+        """Up to parts (start, stop) record ranges of about equal bytes."""
+        ...
+    
+    def close(self) -> None: ...
+    
+    @property
+    def closed(self) -> bool: ...
+    
+    def __enter__(self) -> "FrameFile": ...
+    def __exit__(self, *args: Any) -> None: ...
+
+class Unpacker:
+    """
+    Incremental decoder for a stream of concatenated FLUX documents.
+    
+    Without fp, bytes are pushed with feed() and iteration yields every value
+    completed so far, stopping when more input is needed. With fp, iteration
+    reads it in read_size chunks until EOF.
+    
+    Example:
+        >>> u = crous.Unpacker(items=True)
+        >>> for chunk in chunks:
+        ...     u.feed(chunk)
+        ...     for row in u:
+        ...         handle(row)
+        >>> u.close()
+    """
+    
+    def __init__(
+        self,
+        fp: Optional[_SupportsRead] = None,
+        *,
+        items: bool = False,
+        object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
+        read_size: int = 65536,
+    ) -> None: ...
+    
+    def feed(self, data: _BufferLike) -> None:
+        """Push the next bytes of the stream; only without fp."""
+        ...
+    
+    def close(self) -> None:
+        """Free the decoder; raises CrousDecodeError if a document was cut off."""
+        ...
+    
+    def __iter__(self) -> "Unpacker": ...
+    def __next__(self) -> Any: ...
+
+class Schema:
+    """
+    A fixed message shape compiled into a positional encoder and decoder.
+    
+    Documents carry the schema id and then the values in field order, with
+    no keys and no type tags. dumps() checks every value as it writes it.
+    
+    Example:
+        >>> point = crous.Schema({'x': float, 'y': float, 'label': Optional[str]}, id=7)
+        >>> point.loads(point.dumps({'x': 1.0, 'y': 2.0, 'label': None}))
+        {'x': 1.0, 'y': 2.0, 'label': None}
+    """
+    
+    def __init__(self, fields: Any, id: int) -> None: ...
+    
+    def dumps(self, obj: Any) -> bytes:
+        """Encode obj, which must match the schema; raises CrousEncodeError otherwise."""
+        ...
+    
+    def loads(
+        self,
+        data: _BufferLike,
+        object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
+    ) -> Any:
+        """Decode a document written with this schema."""
+        ...
+    
+    @property
+    def id(self) -> int: ...
+    
+    @property
+    def spec(self) -> str:
+        """The compiled schema text."""
+        ...
+    
+    @property
+    def registered(self) -> bool: ...
+
+class LazyDict:
+    """
+    Read-only dict proxy returned by loads_lazy(). Values are decoded when
+    looked up; nested dicts and lists come back as further proxies.
+    """
+    
+    def __getitem__(self, key: str) -> Any: ...
+    def __contains__(self, key: object) -> bool: ...
+    def __len__(self) -> int: ...
+    def __iter__(self) -> Iterator[str]: ...
+    def get(self, key: str, default: Any = None) -> Any: ...
+    def keys(self) -> List[str]: ...
+    def values(self) -> List[Any]: ...
+    def items(self) -> List[Tuple[str, Any]]: ...
+    def to_python(self) -> Dict[str, Any]:
+        """Decode the whole dict into plain Python objects."""
+        ...
+
+class LazyList:
+    """
+    Read-only list proxy returned by loads_lazy(), also used for tuples and
+    column tables. Iterating or indexing upward walks the input once.
+    """
+    
+    def __getitem__(self, index: Union[int, slice]) -> Any: ...
+    def __len__(self) -> int: ...
+    def __iter__(self) -> Iterator[Any]: ...
+    def to_python(self) -> Union[List[Any], Tuple[Any, ...]]:
+        """Decode the whole list (or tuple) into plain Python objects."""
         ...
 
 # ============================================================================
@@ -397,6 +866,114 @@ def unregister_decoder(tag: int) -> None:
     """
     ...
 
+def register_dictionary(id: int, samples: Iterable[Any]) -> None:
+    """
+    Train a shared dictionary on sample messages and register it.
+    
+    The most frequent dict keys of the samples become the dictionary's
+    keys, and their encodings its compression content. Messages written
+    with dictionary=id name it in their header; every process that
+    decodes them registers the same dictionary under the same id.
+    
+    Args:
+        id: Dictionary id, 1 to 16777215. Ids are registered once per
+            process and cannot be replaced.
+        samples: Representative objects.
+    
+    Returns:
+        None
+    
+    Raises:
+        ValueError: If id is out of range or already registered.
+        CrousEncodeError: If a sample cannot be serialized.
+    """
+    ...
+
+def register_schema(schema: Schema) -> None:
+    """
+    Register schema so that loads() and load() decode documents written
+    with it. Ids are registered once per process and cannot be replaced.
+    
+    Raises:
+        ValueError: If another schema already has the id.
+    """
+    ...
+
+def crc32c(data: Union[bytes, bytearray, memoryview], value: int = 0) -> int:
+    """
+    CRC-32C (Castagnoli) of a bytes-like object.
+    
+    Uses the CPU's CRC instructions where available. Pass a previous
+    result as value to continue over data given in pieces.
+    
+    Args:
+        data: Bytes to checksum.
+        value: CRC to continue from (default 0).
+    
+    Returns:
+        Unsigned 32-bit CRC.
+    """
+    ...
+
+def set_threads(n: int) -> None:
+    """
+    Set the size of the worker pool shared by every parallel path.
+    
+    Compression and checksums in dumps(threads=...), load_parallel() and
+    the C parallel encoders all run on one pool of persistent worker
+    threads. Workers start as work needs them and park when the pool
+    shrinks.
+    
+    Args:
+        n: Threads one operation may use, the calling thread included;
+            0 or less for one per CPU.
+    """
+    ...
+
+def get_threads() -> int:
+    """
+    Size of the worker pool, one per CPU until set_threads() is called.
+    """
+    ...
+
+def enable_stats(enabled: bool = True) -> None:
+    """
+    Turn the built-in counters on or off; they are off by default.
+    
+    While on, the codecs count bytes per format, values built per type,
+    heap and arena allocations, varint reads and calls into serializers,
+    decoders and hooks, and time each top-level call by phase. Counting
+    costs a branch and an increment per value; off, only the branch.
+    Counts are kept while off.
+    
+    Args:
+        enabled: True to count, False to stop.
+    """
+    ...
+
+def get_stats(*, thread: bool = False) -> Dict[str, Any]:
+    """
+    Counters since the last reset_stats(), summed over all threads.
+    
+    Keys: enabled; bytes_encoded and bytes_decoded, each a dict keyed by
+    format (flux, legacy, flux_text, crout); values_created keyed by type;
+    mallocs, malloc_bytes, pool_hits (mallocs served from the thread's
+    node pool), arena_chunks, arena_bytes, varint_reads and callbacks; and calls and time_ns keyed by phase. Phases are decode
+    (wire to C tree), encode (C tree to wire), transcode (wire to wire)
+    and convert (Python objects to or from wire or tree; dumps() and
+    loads() of FLUX run entirely in this phase).
+    
+    Args:
+        thread: Only the calling thread's counters.
+    """
+    ...
+
+def reset_stats() -> None:
+    """
+    Zero the counters of every thread.
+    """
+    ...
+
 # ============================================================================
 # MODULE METADATA
 # ============================================================================
@@ -11,5 +11,13 @@
 #include "crous_value.h"
 #include "crous_binary.h"
 #include "crous_crout.h"
+#include "crous_scan.h"
+#include "crous_checksum.h"
+#include "crous_compress.h"
+#include "crous_frame.h"
+#include "crous_parallel.h"
+#include "crous_session.h"
+#include "crous_visitor.h"
+#include "crous_stats.h"
 
 #endif /* CROUS_H */
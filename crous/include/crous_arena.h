@@ -13,6 +13,15 @@
  * Allocates memory in chunks and frees all at once
  */
 
+/* Alignment of every pointer returned by crous_arena_alloc() */
+#define CROUS_ARENA_ALIGN 8
+
+/* Largest alignment crous_arena_alloc_aligned() accepts */
+#define CROUS_ARENA_MAX_ALIGN 4096
+
+/* Chunks double in size as an arena grows, up to this many bytes */
+#define CROUS_ARENA_CHUNK_MAX ((size_t)16 << 20)
+
 /* Opaque arena structure - implementation in arena.c */
 typedef struct {
     void *_impl;
@@ -24,12 +33,26 @@ typedef struct {
 crous_arena* crous_arena_create(size_t chunk_size);
 
 /**
- * Allocate memory from arena
+ * Allocate memory from arena. When the newest chunk is full, the few
+ * before it are tried too; then a chunk twice the size of the last is
+ * added. Requests bigger than a quarter of that get a block of their own,
+ * so they never strand the free space of the current chunk.
  */
 void* crous_arena_alloc(crous_arena *arena, size_t size);
 
 /**
- * Reset arena (keep structure but free all allocations)
+ * crous_arena_alloc() at a multiple of align, a power of two up to
+ * CROUS_ARENA_MAX_ALIGN (smaller ones give CROUS_ARENA_ALIGN). Returns
+ * NULL for any other align.
+ */
+void* crous_arena_alloc_aligned(crous_arena *arena, size_t size, size_t align);
+
+/**
+ * Reset arena (keep structure but free all allocations). One chunk is
+ * kept for reuse, sized to what was allocated since the last reset (at
+ * least the creation chunk size): an arena reused for inputs of similar
+ * size stops allocating after its first reset, and one that handled a
+ * single large input gives the memory back on the next reset.
  */
 void crous_arena_reset(crous_arena *arena);
 
@@ -43,4 +66,44 @@ void crous_arena_free(crous_arena *arena);
  */
 size_t crous_arena_used(const crous_arena *arena);
 
+/**
+ * Bytes the arena holds in chunks, used or not
+ */
+size_t crous_arena_capacity(const crous_arena *arena);
+
+/* ============================================================================
+   NODE POOLS
+   ============================================================================ */
+
+/**
+ * Per-thread free lists of small heap blocks, one per 8-byte size class
+ * up to CROUS_POOL_MAX_SIZE. The heap value constructors draw their nodes
+ * from them, so building and freeing trees over and over reuses nodes on
+ * each thread instead of contending for the malloc lock. A thread keeps
+ * at most CROUS_POOL_DEPTH blocks per class and frees the rest; its blocks
+ * are released when it exits (POSIX) or calls crous_pool_trim().
+ *
+ * Blocks are plain malloc() blocks of their class size, so any thread may
+ * free one, and free() on one is safe. Building with CROUS_NO_POOL, or a
+ * compiler without thread-local storage, turns the pools into malloc/free.
+ */
+#define CROUS_POOL_MAX_SIZE 64
+#define CROUS_POOL_DEPTH 1024
+
+/**
+ * A block of at least size bytes, 8-byte aligned
+ */
+void* crous_pool_alloc(size_t size);
+
+/**
+ * Return ptr, from crous_pool_alloc(size) on any thread, to the calling
+ * thread's pool. NULL is ignored.
+ */
+void crous_pool_free(void *ptr, size_t size);
+
+/**
+ * Free the blocks the calling thread's pools hold
+ */
+void crous_pool_trim(void);
+
 #endif /* CROUS_ARENA_H */
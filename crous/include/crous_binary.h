@@ -2,6 +2,7 @@
 #define CROUS_BINARY_H
 
 #include "crous_types.h"
+#include "crous_arena.h"
 
 /* ============================================================================
    BINARY ENCODING AND DECODING
@@ -43,6 +44,23 @@ crous_err_t crous_encode(
     uint8_t **out_buf,
     size_t *out_size);
 
+/**
+ * Exact size in bytes of crous_encode() output for value, or 0 if value
+ * can't be encoded
+ */
+size_t crous_encoded_size(const crous_value *value);
+
+/**
+ * Encode into a caller-provided buffer of buf_size bytes. Returns
+ * CROUS_ERR_OVERFLOW if it is too small, with *out_size set to the size
+ * needed (crous_encoded_size()).
+ */
+crous_err_t crous_encode_into(
+    const crous_value *value,
+    uint8_t *buf,
+    size_t buf_size,
+    size_t *out_size);
+
 /**
  * Convenience: decode from buffer
  */
@@ -51,6 +69,28 @@ crous_err_t crous_decode(
     size_t buf_size,
     crous_value **out_value);
 
+/**
+ * Convenience: decode from buffer into an arena.
+ * The whole tree lives in arena; release it with crous_arena_reset() or
+ * crous_arena_free() instead of crous_value_free_tree().
+ */
+crous_err_t crous_decode_arena(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_arena *arena,
+    crous_value **out_value);
+
+/**
+ * Convenience: decode from buffer, borrowing string/bytes payloads and
+ * dict keys from buf where the format allows it (FLUX). buf must outlive
+ * the tree. Legacy CROUS input is copied as usual.
+ */
+crous_err_t crous_decode_borrowed(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_arena *arena,
+    crous_value **out_value);
+
 /**
  * Convenience: encode to file
  */
@@ -59,10 +99,52 @@ crous_err_t crous_encode_file(
     const char *path);
 
 /**
- * Convenience: decode from file
+ * Convenience: decode from file. Regular files are memory-mapped and
+ * decoded straight from the mapped pages instead of being read into a copy.
  */
 crous_err_t crous_decode_file(
     const char *path,
     crous_value **out_value);
 
+/* ============================================================================
+   FILE VIEWS
+   ============================================================================ */
+
+/**
+ * Read-only view of a file's bytes: a memory mapping (mmap on POSIX,
+ * MapViewOfFile on Windows) for regular files, or a heap copy of what
+ * could be read otherwise. Pass data/size to crous_decode_borrowed() for a
+ * tree that points into the mapped pages; the view must then outlive it.
+ * A mapped file must not be truncated while its view is open.
+ */
+typedef struct {
+    const uint8_t *data;    /* NULL when size is 0 */
+    size_t size;
+    int mapped;             /* 1 = file mapping, 0 = heap copy */
+    size_t _offset;         /* Mapped bytes before data */
+} crous_file_view;
+
+/**
+ * Open a view of the whole file at path
+ */
+crous_err_t crous_file_view_open(
+    const char *path,
+    crous_file_view *view);
+
+/**
+ * Map a view of the file open on fd, from offset to its end. fd stays
+ * owned by the caller and may be closed while the view is open. Fails with
+ * CROUS_ERR_STREAM, leaving *view empty, if the file cannot be mapped
+ * (pipes, sockets, special files).
+ */
+crous_err_t crous_file_view_map_fd(
+    int fd,
+    uint64_t offset,
+    crous_file_view *view);
+
+/**
+ * Release a view opened by crous_file_view_open() or crous_file_view_map_fd()
+ */
+void crous_file_view_close(crous_file_view *view);
+
 #endif /* CROUS_BINARY_H */
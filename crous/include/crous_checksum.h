@@ -0,0 +1,30 @@
+#ifndef CROUS_CHECKSUM_H
+#define CROUS_CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ============================================================================
+   CHECKSUMS
+   ============================================================================ */
+
+/**
+ * CRC-32C (Castagnoli) of len bytes, continuing from crc. Start with 0;
+ * feeding data in pieces gives the same result as one call over all of it:
+ *
+ *   crc = crous_crc32c(0, a, a_len);
+ *   crc = crous_crc32c(crc, b, b_len);
+ *
+ * Runs on the SSE4.2 or ARMv8 CRC instructions when the CPU has them
+ * (picked at runtime on x86; on ARM when the compiler targets them), a
+ * lookup table otherwise. CROUS_NO_SIMD forces the table.
+ */
+uint32_t crous_crc32c(uint32_t crc, const void *data, size_t len);
+
+/**
+ * Name of the crous_crc32c() implementation in use: "sse4.2",
+ * "armv8-crc" or "table"
+ */
+const char* crous_crc32c_impl(void);
+
+#endif /* CROUS_CHECKSUM_H */
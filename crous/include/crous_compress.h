@@ -0,0 +1,120 @@
+#ifndef CROUS_COMPRESS_H
+#define CROUS_COMPRESS_H
+
+#include "crous_types.h"
+
+/* ============================================================================
+   BLOCK COMPRESSION CODECS
+   ============================================================================ */
+
+/**
+ * Codec identifiers, as stored in compressed FLUX envelopes. Numbers are
+ * part of the wire format and never reused.
+ *
+ * CROUS_CODEC_LZ4 is built in: a self-contained implementation of the
+ * LZ4 block format whose output any LZ4 block decoder reads. Zstandard
+ * has an identifier but no implementation in this build.
+ */
+typedef enum {
+    CROUS_CODEC_NONE = 0,
+    CROUS_CODEC_LZ4  = 1,
+    CROUS_CODEC_ZSTD = 2,
+} crous_codec_t;
+
+/**
+ * Whether this build can compress and decompress with codec
+ */
+int crous_codec_available(crous_codec_t codec);
+
+/**
+ * Codec name ("none", "lz4", "zstd"), or NULL for an unknown code
+ */
+const char *crous_codec_name(crous_codec_t codec);
+
+/**
+ * Largest compressed size of len input bytes
+ */
+size_t crous_compress_bound(crous_codec_t codec, size_t len);
+
+/**
+ * Compress len bytes of src into dst, which holds cap bytes. *out_len is
+ * 0 when the result would not fit in cap: callers size cap at len to
+ * find out, in one pass, that a block does not shrink and should be
+ * stored as is.
+ */
+crous_err_t crous_compress_block(
+    crous_codec_t codec,
+    const uint8_t *src,
+    size_t len,
+    uint8_t *dst,
+    size_t cap,
+    size_t *out_len);
+
+/**
+ * Decompress len bytes of src into exactly raw_len bytes at dst.
+ * CROUS_ERR_DECODE for input that is malformed or does not produce
+ * exactly raw_len bytes; never reads or writes out of bounds.
+ */
+crous_err_t crous_decompress_block(
+    crous_codec_t codec,
+    const uint8_t *src,
+    size_t len,
+    uint8_t *dst,
+    size_t raw_len);
+
+/* ============================================================================
+   COMPRESSION DICTIONARIES
+   ============================================================================ */
+
+/**
+ * Bytes a block may reference as if they came right before it, so that
+ * even a block of a few dozen bytes finds matches: LZ4's "prefix
+ * dictionary". Only the last CROUS_COMPRESS_DICT_MAX bytes are in reach.
+ * A dictionary is immutable once built and may be shared between
+ * threads; a block must be decompressed with the dictionary it was
+ * compressed with.
+ */
+typedef struct crous_compress_dict crous_compress_dict;
+
+#define CROUS_COMPRESS_DICT_MAX 65535
+
+/**
+ * Copy the last CROUS_COMPRESS_DICT_MAX bytes of content (all of it when
+ * shorter) into a new dictionary and index it for the compressor
+ */
+crous_err_t crous_compress_dict_new(
+    const uint8_t *content,
+    size_t len,
+    crous_compress_dict **out_dict);
+
+/**
+ * The dictionary's bytes
+ */
+const uint8_t *crous_compress_dict_content(const crous_compress_dict *dict, size_t *out_len);
+
+void crous_compress_dict_free(crous_compress_dict *dict);
+
+/**
+ * crous_compress_block() against dict; a NULL dict is the same call
+ */
+crous_err_t crous_compress_block_dict(
+    crous_codec_t codec,
+    const crous_compress_dict *dict,
+    const uint8_t *src,
+    size_t len,
+    uint8_t *dst,
+    size_t cap,
+    size_t *out_len);
+
+/**
+ * crous_decompress_block() against dict; a NULL dict is the same call
+ */
+crous_err_t crous_decompress_block_dict(
+    crous_codec_t codec,
+    const crous_compress_dict *dict,
+    const uint8_t *src,
+    size_t len,
+    uint8_t *dst,
+    size_t raw_len);
+
+#endif /* CROUS_COMPRESS_H */
@@ -3,6 +3,7 @@
 
 #include "crous_types.h"
 #include "crous_value.h"
+#include "crous_visitor.h"
 
 /**
  * CROUT: Compact Readable Object Utility Text
@@ -36,21 +37,34 @@
    CROUT OPTIONS
    ============================================================================ */
 
+typedef struct crout_tokens crout_tokens_t;
+
 typedef struct {
     int use_tokens;    /* 1 = build token table for repeated keys */
     int pretty;        /* 1 = newlines + indentation */
     int indent;        /* spaces per indent level (default 2) */
     int token_threshold; /* minimum occurrences to tokenize a key (default 2) */
-    int max_tokens;    /* maximum token table entries (default 55) */
+    int max_tokens;    /* maximum token table entries (default 4096, at most CROUT_MAX_TOKENS) */
+    int token_sample;  /* count keys in the first N dicts only (default 0 = all) */
+    const crout_tokens_t *tokens; /* fixed table; skips key counting (default NULL) */
 } crout_options_t;
 
+/**
+ * Largest token table the encoder writes or the decoder accepts. The
+ * first 54 tokens are one character long; later ones take two or three,
+ * and are only given to keys whose savings cover their header line.
+ */
+#define CROUT_MAX_TOKENS 65536
+
 static inline crout_options_t crout_options_default(void) {
     crout_options_t o;
     o.use_tokens = 1;
     o.pretty = 0;
     o.indent = 2;
     o.token_threshold = 2;
-    o.max_tokens = 55;
+    o.max_tokens = 4096;
+    o.token_sample = 0;
+    o.tokens = NULL;
     return o;
 }
 
@@ -68,6 +82,48 @@ crous_err_t crout_encode(
     char **out_buf,
     size_t *out_size);
 
+/* ============================================================================
+   CROUT TOKEN TABLES
+   ============================================================================ */
+
+/**
+ * A token table kept across documents. Set crout_options_t.tokens and the
+ * encoders write this table as the header and look keys up in it instead
+ * of counting them first, so the tree is walked once. Keys missing from
+ * the table are written as literals; every entry is written to the header
+ * whether the document uses it or not.
+ *
+ * The same table must not be changed while an encode is using it, but
+ * any number of encodes may share it.
+ */
+crous_err_t crout_tokens_new(crout_tokens_t **out_tokens);
+
+/**
+ * Give key the next free token. A key already in the table keeps its
+ * token. CROUS_ERR_OVERFLOW once the table holds CROUT_MAX_TOKENS keys.
+ */
+crous_err_t crout_tokens_add(
+    crout_tokens_t *tokens,
+    const char *key,
+    size_t key_len);
+
+/**
+ * Count the keys of a sample document and add those crout_encode() would
+ * tokenize, most frequent first, under opts' threshold, max_tokens and
+ * token_sample (NULL for defaults).
+ */
+crous_err_t crout_tokens_learn(
+    crout_tokens_t *tokens,
+    const crous_value *sample,
+    const crout_options_t *opts);
+
+/**
+ * Number of keys in the table
+ */
+size_t crout_tokens_count(const crout_tokens_t *tokens);
+
+void crout_tokens_free(crout_tokens_t *tokens);
+
 /* ============================================================================
    CROUT DECODER
    ============================================================================ */
@@ -81,10 +137,28 @@ crous_err_t crout_decode(
     size_t buf_size,
     crous_value **out_value);
 
+/**
+ * Parse CROUT text, reporting it to visitor (crous_visitor.h) instead of
+ * building a tree. Containers begin with CROUS_VISIT_COUNT_UNKNOWN, and
+ * duplicate dict keys are reported as written.
+ */
+crous_err_t crout_visit(
+    const char *text, size_t text_len,
+    const crous_visitor *visitor, void *ctx);
+
 /* ============================================================================
    CROUT ↔ FLUX HELPERS
    ============================================================================ */
 
+/**
+ * Transcoding runs straight from one format to the other: no crous_value
+ * tree is built, and memory beyond the output is the stack of open
+ * containers plus, for text -> FLUX, one element count per container
+ * (FLUX writes counts up front, so the text is read twice). Duplicate
+ * dict keys pass through as written. Inputs are whole buffers; map large
+ * files with crous_file_view_open().
+ */
+
 /**
  * Convert CROUT text to FLUX binary.
  * Caller must free(*out_buf).
@@ -94,7 +168,16 @@ crous_err_t crout_text_to_flux(
     uint8_t **out_buf, size_t *out_size);
 
 /**
- * Convert FLUX binary to CROUT text.
+ * Convert CROUT text to FLUX binary, written to out in
+ * CROUS_STREAM_CHUNK_SIZE blocks
+ */
+crous_err_t crout_text_to_flux_stream(
+    const char *text, size_t text_len,
+    crous_output_stream *out);
+
+/**
+ * Convert FLUX binary to CROUT text. Output matches crout_encode() of
+ * the decoded value; packed arrays and tables come out as plain lists.
  * Caller must free(*out_buf).
  */
 crous_err_t crout_flux_to_text(
@@ -102,6 +185,15 @@ crous_err_t crout_flux_to_text(
     const crout_options_t *opts,
     char **out_buf, size_t *out_size);
 
+/**
+ * Convert FLUX binary to CROUT text, written to out in
+ * CROUS_STREAM_CHUNK_SIZE blocks (without a trailing NUL)
+ */
+crous_err_t crout_flux_to_text_stream(
+    const uint8_t *flux, size_t flux_len,
+    const crout_options_t *opts,
+    crous_output_stream *out);
+
 /* Magic and version */
 #define CROUT_MAGIC   "CROUT1"
 #define CROUT_MAGIC_LEN 6
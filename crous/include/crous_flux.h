@@ -2,6 +2,9 @@
 #define CROUS_FLUX_H
 
 #include "crous_types.h"
+#include "crous_arena.h"
+#include "crous_compress.h"
+#include "crous_visitor.h"
 
 /**
  * FLUX: Flattened Unified eXchange Format
@@ -73,6 +76,31 @@ flux_token_t* flux_lexer_peek(flux_lexer_t *lexer);
  */
 int flux_lexer_indent_level(flux_lexer_t *lexer);
 
+/**
+ * Tokens in bulk, as parallel arrays: token i has type type[i] and its
+ * value is the length[i] bytes at base + offset[i], base being the text
+ * at base_pos. Tokens without a value (INDENT, DEDENT, EOF, ERROR) have
+ * length 0 and the offset where they were found.
+ */
+#define FLUX_TOKEN_BATCH_SIZE 1024
+
+typedef struct {
+    const char *base;
+    size_t      base_pos;
+    size_t      count;
+    uint8_t     type[FLUX_TOKEN_BATCH_SIZE];    /* flux_token_type_t */
+    uint32_t    offset[FLUX_TOKEN_BATCH_SIZE];
+    uint32_t    length[FLUX_TOKEN_BATCH_SIZE];
+    uint32_t    line[FLUX_TOKEN_BATCH_SIZE];
+} flux_token_batch_t;
+
+/**
+ * Lex up to FLUX_TOKEN_BATCH_SIZE tokens into batch, the same stream
+ * flux_lexer_next() returns one at a time. A batch ends early after
+ * EOF. Returns the token count (at least 1).
+ */
+size_t flux_lexer_next_batch(flux_lexer_t *lexer, flux_token_batch_t *batch);
+
 /* ============================================================================
    FLUX PARSER
    ============================================================================ */
@@ -97,6 +125,15 @@ crous_err_t flux_parse(
     flux_parser_t *parser,
     crous_value **out_value);
 
+/**
+ * Parse FLUX text, reporting it to visitor (crous_visitor.h) instead of
+ * building a tree. Containers begin with CROUS_VISIT_COUNT_UNKNOWN.
+ */
+crous_err_t flux_parse_visit(
+    flux_parser_t *parser,
+    const crous_visitor *visitor,
+    void *ctx);
+
 /* ============================================================================
    FLUX SERIALIZER
    ============================================================================ */
@@ -113,6 +150,8 @@ crous_err_t flux_serialize_text(
  * Serialize crous_value to FLUX binary format
  * Binary form has same structure as text but optimized for space/speed
  * Format: [MAGIC:4][VERSION:1][BODY]
+ * Output reaches the stream in CROUS_STREAM_CHUNK_SIZE blocks as they fill;
+ * payloads of a block or more are passed through without staging.
  */
 crous_err_t flux_serialize_binary(
     const crous_value *value,
@@ -146,14 +185,997 @@ crous_err_t flux_encode_binary(
     uint8_t **out_buf,
     size_t *out_size);
 
+/* A shared dictionary (FLUX SHARED DICTIONARIES) */
+typedef struct flux_dictionary flux_dictionary_t;
+
+/**
+ * Binary encoding options
+ */
+typedef struct {
+    int key_refs;       /* Wire v3: repeated dict keys become back-references */
+    int columnar;       /* Wire v4: lists of same-keyed dicts become tables (implies key_refs) */
+    int compression;    /* A crous_codec_t: non-NONE wraps the output in a compressed envelope */
+    const flux_dictionary_t *dictionary;  /* Non-NULL: envelope naming it (implies key_refs) */
+    int checksum;       /* Envelope with a CRC-32C per block, compressed or not */
+    int max_depth;      /* > 0: fail with CROUS_ERR_DEPTH_EXCEEDED on values nested this deep; 0 = no limit */
+    int dedup;          /* Wire v5: repeated subtrees become back-references (implies key_refs) */
+} flux_binary_options_t;
+
+/**
+ * Default binary options (wire v1 output, readable by every decoder)
+ */
+flux_binary_options_t flux_binary_options_default(void);
+
+/**
+ * Encode to FLUX binary format (buffer) with options. NULL opts is the
+ * same as flux_encode_binary().
+ */
+crous_err_t flux_encode_binary_opts(
+    const crous_value *value,
+    const flux_binary_options_t *opts,
+    uint8_t **out_buf,
+    size_t *out_size);
+
+/**
+ * flux_encode_binary_opts() on up to nthreads pool threads (<= 0: all),
+ * with byte-identical output. Large lists, tuples and dicts, at the root
+ * or below small containers, are cut into runs of items that are sized
+ * and then written in parallel straight into the one output buffer;
+ * envelope blocks are compressed in parallel. Key references (key_refs,
+ * columnar, dictionary) and shared values (dedup) tie every key and value
+ * to the ones before it, so those documents are encoded on one thread, and
+ * only their compression is parallel.
+ */
+crous_err_t flux_encode_binary_parallel(
+    const crous_value *value,
+    const flux_binary_options_t *opts,
+    int nthreads,
+    uint8_t **out_buf,
+    size_t *out_size);
+
+/**
+ * The plain document flux_encode_binary_opts() would put in an envelope:
+ * opts with the envelope for their compression, dictionary and checksum
+ * left out. With a
+ * dictionary it is only readable inside an envelope naming it.
+ */
+crous_err_t flux_encode_binary_inner(
+    const crous_value *value,
+    const flux_binary_options_t *opts,
+    uint8_t **out_buf,
+    size_t *out_size);
+
 /**
- * Decode from FLUX binary format (buffer)
+ * flux_encode_binary_inner() into a buffer the caller keeps: *buf, of
+ * capacity *buf_cap (NULL and 0 to start), grows with realloc as needed
+ * and stays the caller's to pass again or free(). Repeated encodes stop
+ * allocating once it fits the largest document. On error *buf remains
+ * valid.
+ */
+crous_err_t flux_encode_binary_inner_reuse(
+    const crous_value *value,
+    const flux_binary_options_t *opts,
+    uint8_t **buf,
+    size_t *buf_cap,
+    size_t *out_size);
+
+/**
+ * flux_serialize_binary() with options. NULL opts gives the default format.
+ */
+crous_err_t flux_serialize_binary_opts(
+    const crous_value *value,
+    const flux_binary_options_t *opts,
+    crous_output_stream *out);
+
+/**
+ * Exact number of bytes flux_encode_binary() produces for value, header
+ * included. Returns 0 if value contains something that can't be encoded.
+ */
+size_t flux_encoded_size(const crous_value *value);
+
+/**
+ * Encode to FLUX binary format into a caller-provided buffer. Returns
+ * CROUS_ERR_OVERFLOW if buf_size is too small, with *out_size set to the
+ * size needed (flux_encoded_size()); buf may have been partly written.
+ */
+crous_err_t flux_encode_binary_into(
+    const crous_value *value,
+    uint8_t *buf,
+    size_t buf_size,
+    size_t *out_size);
+
+/**
+ * Decode from FLUX binary format (buffer). This and the other binary
+ * decoders also accept compressed envelopes (FLUX COMPRESSED ENVELOPE).
  */
 crous_err_t flux_decode_binary(
     const uint8_t *buf,
     size_t buf_size,
     crous_value **out_value);
 
+/**
+ * Decode from FLUX binary format (buffer) with every node, payload and
+ * container array allocated from arena. A NULL arena is the same as
+ * flux_decode_binary(). On error, partial allocations stay in the arena.
+ */
+crous_err_t flux_decode_binary_arena(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_arena *arena,
+    crous_value **out_value);
+
+/**
+ * Decode from FLUX binary format (buffer) without copying payloads.
+ * String/bytes data and dict keys point into buf and are flagged
+ * CROUS_VALUE_FLAG_BORROWED, so buf must outlive the tree and stay
+ * unchanged. Nodes come from arena, or the heap when arena is NULL.
+ * A compressed envelope is unpacked into arena and borrowed from there;
+ * without an arena its payloads are copied.
+ */
+crous_err_t flux_decode_binary_borrowed(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_arena *arena,
+    crous_value **out_value);
+
+/**
+ * Binary decoding options
+ */
+typedef struct {
+    int max_depth;      /* Values nested this deep fail to decode; <= 0 = CROUS_MAX_DEPTH */
+    int borrow;         /* Point payloads into buf, as flux_decode_binary_borrowed() */
+    int share_refs;     /* With an arena: wire v5 REFs reuse the shared node instead of copying it */
+} flux_decode_options_t;
+
+/**
+ * Default decoding options (the limits of flux_decode_binary())
+ */
+flux_decode_options_t flux_decode_options_default(void);
+
+/**
+ * flux_decode_binary_arena(), or _borrowed() with opts->borrow, with
+ * opts. The decoder keeps its open containers on a heap stack, so a
+ * max_depth far above CROUS_MAX_DEPTH costs memory, not C stack; raise it
+ * only for trusted input. NULL opts is the same as the defaults.
+ *
+ * With opts->share_refs the tree is a DAG: one node sits under every
+ * parent that referred to it, so walks see it once per reference and it
+ * must not be changed in place. max_depth is checked along the wire, not
+ * through REFs. Without it each REF decodes a copy.
+ */
+crous_err_t flux_decode_binary_opts(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_arena *arena,
+    const flux_decode_options_t *opts,
+    crous_value **out_value);
+
+/* ============================================================================
+   FLUX STREAMING DECODER
+   ============================================================================ */
+
+/**
+ * Incremental FLUX binary decoder. Input is pushed in chunks of any size
+ * with flux_stream_decoder_feed(); the decoder keeps an explicit stack of
+ * open containers, so memory is bounded by the tree being built plus the
+ * payload currently in flight, never the whole wire image.
+ */
+typedef struct flux_stream_decoder flux_stream_decoder_t;
+
+typedef struct {
+    size_t bytes_consumed;      /* Input bytes accepted so far (header included) */
+    size_t values_decoded;      /* Completed values, nested ones included */
+    int depth;                  /* Containers currently open */
+    int done;                   /* Non-zero once the top-level value is complete */
+} flux_stream_progress_t;
+
+/**
+ * Create a streaming decoder expecting a FLUX header
+ */
+flux_stream_decoder_t* flux_stream_decoder_new(void);
+
+/**
+ * Free decoder resources, including any partially built or untaken value
+ */
+void flux_stream_decoder_free(flux_stream_decoder_t *dec);
+
+/**
+ * Feed the next chunk of input. Stops consuming as soon as the top-level
+ * value is complete; *consumed (optional) reports how many bytes were used.
+ * Errors are sticky: every later call returns the same error.
+ */
+crous_err_t flux_stream_decoder_feed(
+    flux_stream_decoder_t *dec,
+    const uint8_t *data,
+    size_t len,
+    size_t *consumed);
+
+/**
+ * Non-zero once a complete value has been decoded
+ */
+int flux_stream_decoder_done(const flux_stream_decoder_t *dec);
+
+/**
+ * Take ownership of the decoded value. Returns CROUS_ERR_TRUNCATED if the
+ * input ended before the value was complete.
+ */
+crous_err_t flux_stream_decoder_finish(
+    flux_stream_decoder_t *dec,
+    crous_value **out_value);
+
+/**
+ * Items mode, set before the first feed: the elements of a top-level list
+ * or tuple are handed out through flux_stream_decoder_next_item() as each
+ * one completes instead of being collected, so memory holds one element
+ * at a time. Any other top-level value is handed out whole when done, and
+ * finish() then has nothing left (CROUS_ERR_NOT_FOUND). A columnar table
+ * is only complete at its last column, so its rows come out together.
+ */
+crous_err_t flux_stream_decoder_set_items(flux_stream_decoder_t *dec, int enable);
+
+/**
+ * Take the next finished item in items mode. CROUS_ERR_NOT_FOUND if none
+ * is ready yet.
+ */
+crous_err_t flux_stream_decoder_next_item(
+    flux_stream_decoder_t *dec,
+    crous_value **out_value);
+
+/**
+ * Forget the current document and expect a new header, for a stream of
+ * concatenated documents. Keeps the mode and any items not yet taken.
+ */
+void flux_stream_decoder_reset(flux_stream_decoder_t *dec);
+
+/**
+ * Report how far decoding has got
+ */
+void flux_stream_decoder_progress(
+    const flux_stream_decoder_t *dec,
+    flux_stream_progress_t *out);
+
+/* ============================================================================
+   FLUX BINARY WRITER
+   ============================================================================ */
+
+/**
+ * Builds a document from a sequence of calls instead of a crous_value
+ * tree, holding only the stack of open containers. Transcoders and
+ * streaming producers use it to write FLUX without materializing their
+ * input. Containers declare their element count up front, as the wire
+ * format stores it ahead of the elements, and the writer checks that
+ * exactly that many follow; misuse is CROUS_ERR_ENCODE. Output is the
+ * plain (wire v1) format, byte-identical to flux_encode_binary() of the
+ * equivalent tree.
+ */
+typedef struct flux_writer flux_writer_t;
+
+/**
+ * Start a document. With out set, bytes are passed to it in blocks of
+ * CROUS_STREAM_CHUNK_SIZE as they are produced; with out NULL, they
+ * collect in memory for flux_writer_finish().
+ */
+crous_err_t flux_writer_new(
+    crous_output_stream *out,
+    flux_writer_t **out_writer);
+
+/**
+ * Write value, a scalar or a whole tree, as the next element
+ */
+crous_err_t flux_writer_value(flux_writer_t *w, const crous_value *value);
+
+/**
+ * Open a list, tuple or dict of count elements as the next element. Each
+ * dict element is a flux_writer_key() followed by its value.
+ */
+crous_err_t flux_writer_begin(flux_writer_t *w, crous_type_t type, size_t count);
+
+/**
+ * Key of the next entry of the innermost dict
+ */
+crous_err_t flux_writer_key(flux_writer_t *w, const char *key, size_t key_len);
+
+/**
+ * Wrap the next element in a tagged value carrying tag
+ */
+crous_err_t flux_writer_tag(flux_writer_t *w, uint32_t tag);
+
+/**
+ * Close the innermost container once all its elements are written
+ */
+crous_err_t flux_writer_end(flux_writer_t *w);
+
+/**
+ * Check the document is complete and free w. A memory writer hands over
+ * its output (caller frees *out_buf); a stream writer flushes, and
+ * out_buf/out_size may be NULL.
+ */
+crous_err_t flux_writer_finish(
+    flux_writer_t *w,
+    uint8_t **out_buf,
+    size_t *out_size);
+
+/**
+ * Abandon a writer without finishing the document
+ */
+void flux_writer_free(flux_writer_t *w);
+
+/* ============================================================================
+   FLUX LAZY VIEWS
+   ============================================================================ */
+
+/**
+ * Read-only cursors over a FLUX binary buffer. Navigating walks the wire
+ * format in place and steps over unwanted sub-trees without building them;
+ * only the value actually asked for is read. Strings, bytes and packed
+ * arrays are skipped in constant time, containers by walking their heads.
+ *
+ * A document holds the state views share: the wire v3 key table (the only
+ * thing that grows while walking), the resume point of the last ascending
+ * walk through a list, and the column offsets of the last table read, so
+ * iterating or indexing upward is linear overall. The buffer must outlive
+ * the document, and a document and its views must not be used from several
+ * threads at once. Input is validated as far as it is walked.
+ */
+typedef struct flux_view_doc flux_view_doc_t;
+
+/* How a view's value is stored */
+enum {
+    FLUX_VIEW_VALUE = 0,    /* A tagged value */
+    FLUX_VIEW_ROW,          /* One row of a table, read as a dict */
+    FLUX_VIEW_CELL,         /* A typed table cell or packed array element */
+};
+
+typedef struct {
+    flux_view_doc_t *doc;
+    size_t pos;             /* Offset just past the value's tag (rows: the table's) */
+    size_t row;             /* Row index of FLUX_VIEW_ROW views */
+    int64_t ival;           /* Decoded value of ints */
+    uint8_t tag;            /* FLUX_TAG_* the value reads as */
+    uint8_t form;           /* FLUX_VIEW_* */
+    int depth;
+} flux_view_t;
+
+/**
+ * Iteration state over a container view
+ */
+typedef struct {
+    flux_view_t parent;
+    size_t index;           /* Next element */
+    size_t count;
+    size_t pos;             /* Offset of the next element */
+} flux_view_iter_t;
+
+/**
+ * Check the header of buf and open a document over it. A compressed
+ * envelope is unpacked into a copy the document owns, so views then point
+ * into that copy rather than buf.
+ */
+crous_err_t flux_view_open(
+    const uint8_t *buf,
+    size_t buf_size,
+    flux_view_doc_t **out_doc);
+
+/**
+ * Free a document; its views become invalid
+ */
+void flux_view_close(flux_view_doc_t *doc);
+
+/**
+ * View of the top-level value
+ */
+crous_err_t flux_view_root(
+    flux_view_doc_t *doc,
+    flux_view_t *out);
+
+/**
+ * Type of the viewed value. Tables read as lists of dicts.
+ */
+crous_type_t flux_view_type(const flux_view_t *view);
+
+/**
+ * Element count of containers and packed arrays, byte length of strings
+ * and bytes
+ */
+crous_err_t flux_view_len(
+    const flux_view_t *view,
+    size_t *out_len);
+
+/**
+ * Element i of a list, tuple, table or packed array.
+ * CROUS_ERR_NOT_FOUND if i is out of range.
+ */
+crous_err_t flux_view_index(
+    const flux_view_t *view,
+    size_t index,
+    flux_view_t *out);
+
+/**
+ * Value stored under key in a dict. CROUS_ERR_NOT_FOUND if absent.
+ */
+crous_err_t flux_view_get_key(
+    const flux_view_t *view,
+    const char *key,
+    size_t key_len,
+    flux_view_t *out);
+
+/**
+ * Start iterating a container or packed array
+ */
+crous_err_t flux_view_iter_init(
+    const flux_view_t *view,
+    flux_view_iter_t *it);
+
+/**
+ * Next element; dicts also report its key (pointing into the buffer).
+ * key and key_len may be NULL. CROUS_ERR_NOT_FOUND once exhausted.
+ */
+crous_err_t flux_view_next(
+    flux_view_iter_t *it,
+    const char **key,
+    size_t *key_len,
+    flux_view_t *out);
+
+/**
+ * Offset just past the value, walking over it without building anything.
+ * Only FLUX_VIEW_VALUE views have an extent of their own; for a wire v5
+ * back-reference it is the extent of the shared value it stands for.
+ */
+crous_err_t flux_view_skip(
+    const flux_view_t *view,
+    size_t *out_end);
+
+/* Scalar accessors; CROUS_ERR_INVALID_TYPE if the value has another type */
+crous_err_t flux_view_get_bool(const flux_view_t *view, int *out);
+crous_err_t flux_view_get_int(const flux_view_t *view, int64_t *out);
+crous_err_t flux_view_get_float(const flux_view_t *view, double *out);
+
+/**
+ * String or bytes payload, pointing into the buffer
+ */
+crous_err_t flux_view_get_string(const flux_view_t *view, const char **out, size_t *out_len);
+crous_err_t flux_view_get_bytes(const flux_view_t *view, const uint8_t **out, size_t *out_len);
+
+/**
+ * Tag number and inner value of a tagged value
+ */
+crous_err_t flux_view_get_tagged(
+    const flux_view_t *view,
+    uint32_t *out_tag,
+    flux_view_t *out_inner);
+
+/**
+ * Raw little-endian elements of a packed array, pointing into the buffer
+ * (aligned only if the buffer is)
+ */
+crous_err_t flux_view_get_array(
+    const flux_view_t *view,
+    const uint8_t **out_data,
+    size_t *out_count);
+
+/**
+ * Build the viewed sub-tree as a crous_value, copying payloads. Nodes come
+ * from arena, or the heap when arena is NULL.
+ */
+crous_err_t flux_view_decode(
+    const flux_view_t *view,
+    crous_arena *arena,
+    crous_value **out_value);
+
+/* ============================================================================
+   FLUX BINARY VISITOR
+   ============================================================================ */
+
+/**
+ * Walk a FLUX binary document (envelopes, key references and tables
+ * included), reporting it to visitor as described in crous_visitor.h.
+ * Nothing is decoded into a tree; memory use is one lazy-view document.
+ */
+crous_err_t flux_visit_binary(
+    const uint8_t *buf,
+    size_t buf_size,
+    const crous_visitor *visitor,
+    void *ctx);
+
+/**
+ * flux_visit_binary() over the sub-tree under view
+ */
+crous_err_t flux_view_visit(
+    const flux_view_t *view,
+    const crous_visitor *visitor,
+    void *ctx);
+
+/* ============================================================================
+   FLUX FIELD PROJECTION
+   ============================================================================ */
+
+/**
+ * A set of field paths to decode out of a FLUX binary document, leaving
+ * everything else unbuilt. A path is a sequence of steps:
+ *
+ *   name      a dict key (the first step; later ones are written ".name")
+ *   [N]       element N of a list, tuple, table or packed array
+ *   [*]       every element
+ *
+ * e.g. "user.id", "items[*].sku", "matrix[0][*]". Keys cannot contain
+ * '.' or '['. Paths are merged: "items[*].sku" with "items[0].price"
+ * keeps both fields of the first item.
+ */
+typedef struct flux_projection flux_projection_t;
+
+/**
+ * Create an empty projection
+ */
+crous_err_t flux_projection_new(flux_projection_t **out_proj);
+
+/**
+ * Add one path of path_len bytes. CROUS_ERR_SYNTAX if it is malformed.
+ */
+crous_err_t flux_projection_add(
+    flux_projection_t *proj,
+    const char *path,
+    size_t path_len);
+
+/**
+ * Free a projection
+ */
+void flux_projection_free(flux_projection_t *proj);
+
+/**
+ * Decode only the parts of buf that proj selects, in one pass over the
+ * input; the rest is stepped over without being built. The result keeps
+ * the shape of the document: dicts hold just the selected keys, lists just
+ * the selected elements, both in input order. Selections that miss (absent
+ * keys, out-of-range indices, a step into a scalar) are left out, and a
+ * top-level value that nothing selects decodes as null.
+ *
+ * Nodes come from arena, or the heap when arena is NULL. The _borrowed
+ * variant leaves payloads in buf, as flux_decode_binary_borrowed() does.
+ */
+crous_err_t flux_decode_binary_fields(
+    const uint8_t *buf,
+    size_t buf_size,
+    const flux_projection_t *proj,
+    crous_arena *arena,
+    crous_value **out_value);
+
+crous_err_t flux_decode_binary_fields_borrowed(
+    const uint8_t *buf,
+    size_t buf_size,
+    const flux_projection_t *proj,
+    crous_arena *arena,
+    crous_value **out_value);
+
+/* ============================================================================
+   FLUX COMPRESSED ENVELOPE
+   ============================================================================ */
+
+/**
+ * A complete FLUX binary document, header included, compressed block by
+ * block (CROUS_FEATURE_COMPRESSION):
+ *
+ *   header   "FLUX", the document's wire version, flags FLUX_FLAG_EXTENDED,
+ *            u16 BE features (CROUS_FEATURE_COMPRESSION | required bit),
+ *            codec byte, u24 LE dictionary id (0 = none)
+ *   block    u32 LE raw_len, u32 LE stored_len, [u32 LE crc], stored_len
+ *            bytes; a block that did not shrink is stored as is
+ *            (stored_len == raw_len)
+ *   end      u32 LE 0
+ *
+ * Blocks are compressed independently, FLUX_COMPRESS_BLOCK_SIZE raw bytes
+ * each, so the writer and the streaming reader hold one block at a time.
+ * A reader predating envelopes stops at the features word, which is not
+ * a valid value tag.
+ *
+ * A dictionary id names a registered shared dictionary: its content is in
+ * reach of every block (crous_compress_block_dict()), and its keys open
+ * the document's wire v3 key table. Decoding needs the dictionary
+ * registered; CROUS_ERR_NOT_FOUND if it is not.
+ *
+ * With CROUS_FEATURE_CHECKSUMS also set in the features word, every block
+ * carries the CRC-32C (crous_crc32c()) of its raw bytes. Readers check it
+ * as each block is unpacked and fail with CROUS_ERR_CHECKSUM, so a damaged
+ * block never reaches the value decoder. Codec CROUS_CODEC_NONE gives a
+ * checksummed but uncompressed document.
+ */
+
+typedef struct flux_compress_stream flux_compress_stream_t;
+
+/**
+ * Non-zero if buf starts with a compressed envelope header
+ */
+int flux_binary_is_compressed(const uint8_t *buf, size_t buf_size);
+
+/**
+ * Check an envelope header and get its codec. CROUS_ERR_TRUNCATED for
+ * fewer than FLUX_ENVELOPE_HEADER_SIZE bytes, CROUS_ERR_INVALID_HEADER if
+ * the header is malformed or names a codec this build lacks.
+ */
+crous_err_t flux_envelope_codec(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_codec_t *out_codec);
+
+/**
+ * Non-zero if buf starts with an envelope header whose blocks carry
+ * checksums
+ */
+int flux_envelope_checksummed(const uint8_t *buf, size_t buf_size);
+
+/**
+ * The registered dictionary an envelope names, NULL for none.
+ * CROUS_ERR_NOT_FOUND if the id is not registered in this process.
+ */
+crous_err_t flux_envelope_dictionary(
+    const uint8_t *buf,
+    size_t buf_size,
+    const flux_dictionary_t **out_dict);
+
+/**
+ * Largest envelope produced for a doc_size-byte document, with any codec
+ */
+size_t flux_compress_bound(size_t doc_size);
+
+/**
+ * Wrap the FLUX binary document doc in an envelope compressed with codec,
+ * against dict when not NULL (which must be the dictionary doc's keys were
+ * encoded with, if any). flags are FLUX_ENVELOPE_* bits.
+ * CROUS_ERR_INVALID_TYPE if this build lacks codec (see
+ * crous_codec_available()), CROUS_ERR_OVERFLOW if buf_size is too small;
+ * size it with flux_compress_bound().
+ */
+crous_err_t flux_compress_binary_into(
+    const uint8_t *doc,
+    size_t doc_size,
+    crous_codec_t codec,
+    const flux_dictionary_t *dict,
+    unsigned flags,
+    uint8_t *buf,
+    size_t buf_size,
+    size_t *out_size);
+
+/**
+ * flux_compress_binary_into() into a new buffer
+ */
+crous_err_t flux_compress_binary(
+    const uint8_t *doc,
+    size_t doc_size,
+    crous_codec_t codec,
+    const flux_dictionary_t *dict,
+    unsigned flags,
+    uint8_t **out_buf,
+    size_t *out_size);
+
+/**
+ * flux_compress_binary_into() with blocks compressed on up to nthreads
+ * pool threads (<= 0: all). Gives the same bytes. Runs on the calling
+ * thread alone for a single block, or when buf_size is below
+ * flux_compress_bound(doc_size), which parallel compression needs.
+ */
+crous_err_t flux_compress_binary_into_parallel(
+    const uint8_t *doc,
+    size_t doc_size,
+    crous_codec_t codec,
+    const flux_dictionary_t *dict,
+    unsigned flags,
+    int nthreads,
+    uint8_t *buf,
+    size_t buf_size,
+    size_t *out_size);
+
+/**
+ * Size of the document inside an envelope, found by walking its block
+ * headers. Checks the structure only; the blocks are checked as they are
+ * decompressed.
+ */
+crous_err_t flux_decompressed_size(
+    const uint8_t *buf,
+    size_t buf_size,
+    size_t *out_size);
+
+/**
+ * Unpack an envelope into exactly out_size bytes, as given by
+ * flux_decompressed_size()
+ */
+crous_err_t flux_decompress_binary_into(
+    const uint8_t *buf,
+    size_t buf_size,
+    uint8_t *out,
+    size_t out_size);
+
+/**
+ * Unpack an envelope into a new buffer
+ */
+crous_err_t flux_decompress_binary(
+    const uint8_t *buf,
+    size_t buf_size,
+    uint8_t **out_buf,
+    size_t *out_size);
+
+/**
+ * Compress a document as it is written. Bytes written to the stream from
+ * flux_compress_stream_input() reach out as envelope blocks; the header
+ * goes out with the first block, once the document's version is known.
+ */
+crous_err_t flux_compress_stream_new(
+    crous_output_stream *out,
+    crous_codec_t codec,
+    const flux_dictionary_t *dict,
+    unsigned flags,
+    flux_compress_stream_t **out_stream);
+
+/**
+ * The stream to write the document into
+ */
+crous_output_stream *flux_compress_stream_input(flux_compress_stream_t *stream);
+
+/**
+ * Write the last block and the end marker, then free the stream. The
+ * stream is freed even on error; the first write error is returned.
+ */
+crous_err_t flux_compress_stream_finish(flux_compress_stream_t *stream);
+
+/**
+ * Free a stream without finishing its envelope
+ */
+void flux_compress_stream_free(flux_compress_stream_t *stream);
+
+/* ============================================================================
+   FLUX SHARED DICTIONARIES
+   ============================================================================ */
+
+/**
+ * What small messages of one shape have in common, agreed on once instead
+ * of sent with each: an id, dict keys that start every document's wire v3
+ * key table (index 0 onwards, the document's own keys after them), and
+ * content that compressed blocks may match against. Messages name the
+ * dictionary by id in their envelope and readers find it in the process
+ * registry, so writers and readers register the same dictionary under the
+ * same id. A dictionary never changes once built.
+ */
+
+/**
+ * Build a dictionary from its parts. id is 1 to FLUX_DICTIONARY_ID_MAX;
+ * repeated keys keep their first position. Content past the last
+ * CROUS_COMPRESS_DICT_MAX bytes is dropped.
+ */
+crous_err_t flux_dictionary_new(
+    uint32_t id,
+    const char *const *keys,
+    const size_t *key_lens,
+    size_t key_count,
+    const uint8_t *content,
+    size_t content_len,
+    flux_dictionary_t **out_dict);
+
+/**
+ * Train a dictionary on count FLUX binary samples: up to
+ * FLUX_DICTIONARY_TRAIN_KEYS of their dict keys, most frequent first so
+ * they get the shortest references, and as content the samples encoded
+ * against those keys, the last samples nearest the end.
+ */
+crous_err_t flux_dictionary_train(
+    uint32_t id,
+    const uint8_t *const *samples,
+    const size_t *sample_sizes,
+    size_t count,
+    flux_dictionary_t **out_dict);
+
+/**
+ * Free a dictionary that was never registered
+ */
+void flux_dictionary_free(flux_dictionary_t *dict);
+
+uint32_t flux_dictionary_id(const flux_dictionary_t *dict);
+size_t flux_dictionary_key_count(const flux_dictionary_t *dict);
+
+/**
+ * Key at index; CROUS_ERR_NOT_FOUND past the last one
+ */
+crous_err_t flux_dictionary_key(
+    const flux_dictionary_t *dict,
+    size_t index,
+    const char **out_key,
+    size_t *out_len);
+
+/**
+ * Non-zero, with the key's index, if the dictionary has key
+ */
+int flux_dictionary_find_key(
+    const flux_dictionary_t *dict,
+    const char *key,
+    size_t len,
+    size_t *out_index);
+
+/**
+ * The compression content, NULL if there is none
+ */
+const crous_compress_dict *flux_dictionary_content(const flux_dictionary_t *dict);
+
+/**
+ * Hand dict to the process registry, which owns it from then on and keeps
+ * it until the process exits. CROUS_ERR_INVALID_TYPE if its id is already
+ * registered (ids are never reassigned, since messages may still name
+ * them), CROUS_ERR_OVERFLOW if the registry is full. Safe to call from
+ * any thread, as is flux_dictionary_lookup().
+ */
+crous_err_t flux_dictionary_register(flux_dictionary_t *dict);
+
+/**
+ * The dictionary registered under id, or NULL
+ */
+const flux_dictionary_t *flux_dictionary_lookup(uint32_t id);
+
+/* ============================================================================
+   FLUX SCHEMAS
+   ============================================================================ */
+
+/**
+ * A fixed message shape, compiled once, for documents that carry no keys
+ * and no per-value tags (CROUS_FEATURE_SCHEMA):
+ *
+ *   header   "FLUX", FLUX_VERSION, flags FLUX_FLAG_EXTENDED, u16 BE
+ *            features (CROUS_FEATURE_SCHEMA | required bit), a zero
+ *            byte, u24 LE schema id
+ *   body     the root value, laid out by its schema node
+ *
+ * Node layouts: bool one byte 0 or 1; int a zigzag varint; float 8 raw
+ * bytes, as FLUX_TAG_FLOAT; str and bytes a length varint and the bytes;
+ * list a count varint and that many elements; record its fields in
+ * order; any a tagged wire v1 value. A nullable node is preceded by a
+ * byte, 0 for null or 1 for the value.
+ *
+ * Schemas are written as text, whitespace allowed anywhere:
+ *
+ *   type   := ("bool" | "int" | "float" | "str" | "bytes" | "any"
+ *             | "[" type "]" | record) ["?"]
+ *   record := "{" [field ("," field)*] "}"
+ *   field  := (name | '"' name '"') ":" type
+ *
+ * Bare names are letters, digits and underscores; quoted ones may hold
+ * any byte but '"' and '\', which are escaped with a '\'. Types nest at
+ * most FLUX_SCHEMA_MAX_DEPTH deep. Encoding validates as it writes: a
+ * value of the wrong type, a record missing a field or holding another
+ * fails with CROUS_ERR_INVALID_TYPE. Records are dicts on both sides,
+ * lists are lists (or tuples and packed arrays when encoding), and any
+ * takes whatever a FLUX document holds.
+ *
+ * Like dictionaries, schemas are agreed on by id: writers and readers
+ * register the same text under the same id, and the decoders find a
+ * document's schema in the process registry.
+ */
+
+typedef struct flux_schema flux_schema_t;
+
+typedef enum {
+    FLUX_SCHEMA_BOOL = 1,
+    FLUX_SCHEMA_INT,
+    FLUX_SCHEMA_FLOAT,
+    FLUX_SCHEMA_STRING,
+    FLUX_SCHEMA_BYTES,
+    FLUX_SCHEMA_ANY,
+    FLUX_SCHEMA_LIST,       /* Element type in the next node */
+    FLUX_SCHEMA_RECORD      /* Fields in the nodes after it, each subtree in turn */
+} flux_schema_kind_t;
+
+/**
+ * One node of a compiled schema, in preorder: node 0 is the root, and a
+ * node's subtree runs up to its end index
+ */
+typedef struct {
+    uint8_t kind;           /* flux_schema_kind_t */
+    uint8_t nullable;
+    uint32_t count;         /* Records: fields */
+    uint32_t end;           /* Index just past this node's subtree */
+    const char *name;       /* Field name in the enclosing record, else NULL */
+    size_t name_len;
+} flux_schema_node_t;
+
+/**
+ * Compile spec_len bytes of schema text under id, 1 to
+ * FLUX_SCHEMA_ID_MAX. CROUS_ERR_SYNTAX for malformed text or a record
+ * naming a field twice, CROUS_ERR_DEPTH_EXCEEDED past
+ * FLUX_SCHEMA_MAX_DEPTH.
+ */
+crous_err_t flux_schema_new(
+    uint32_t id,
+    const char *spec,
+    size_t spec_len,
+    flux_schema_t **out_schema);
+
+/**
+ * Free a schema that was never registered
+ */
+void flux_schema_free(flux_schema_t *schema);
+
+uint32_t flux_schema_id(const flux_schema_t *schema);
+
+/**
+ * The compiled nodes, *out_count of them, for bindings that walk their
+ * own objects
+ */
+const flux_schema_node_t *flux_schema_nodes(const flux_schema_t *schema, size_t *out_count);
+
+/**
+ * Encode value, which must match schema, into a new buffer
+ */
+crous_err_t flux_schema_encode(
+    const flux_schema_t *schema,
+    const crous_value *value,
+    uint8_t **out_buf,
+    size_t *out_size);
+
+/**
+ * Decode a document written with schema, into arena when not NULL.
+ * CROUS_ERR_INVALID_HEADER if it names another schema, or none.
+ */
+crous_err_t flux_schema_decode(
+    const flux_schema_t *schema,
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_arena *arena,
+    crous_value **out_value);
+
+/**
+ * Write the FLUX_SCHEMA_HEADER_SIZE header of schema's documents to out
+ */
+void flux_schema_put_header(const flux_schema_t *schema, uint8_t *out);
+
+/**
+ * CROUS_OK if buf starts with the header of a document written with
+ * schema, CROUS_ERR_TRUNCATED if it is too short to, else
+ * CROUS_ERR_INVALID_HEADER
+ */
+crous_err_t flux_schema_check_header(const flux_schema_t *schema, const uint8_t *buf, size_t buf_size);
+
+/**
+ * Non-zero, with the id it names, if buf starts with a schema header.
+ * flux_decode_binary() and the other tree decoders read such documents
+ * through the registry, failing with CROUS_ERR_NOT_FOUND for an id this
+ * process has not registered.
+ */
+int flux_binary_schema_id(const uint8_t *buf, size_t buf_size, uint32_t *out_id);
+
+/**
+ * Hand schema to the process registry, as flux_dictionary_register().
+ * CROUS_ERR_INVALID_TYPE if its id is already registered,
+ * CROUS_ERR_OVERFLOW if the registry is full.
+ */
+crous_err_t flux_schema_register(flux_schema_t *schema);
+
+/**
+ * The schema registered under id, or NULL
+ */
+const flux_schema_t *flux_schema_lookup(uint32_t id);
+
+/* ============================================================================
+   FLUX VALUES (for codecs that embed them)
+   ============================================================================ */
+
+/**
+ * Append value as one tagged wire v1 value, no header, to the malloc'd
+ * buffer *buf holding *pos of *cap bytes, growing it as needed.
+ * max_depth as in flux_binary_options_t.
+ */
+crous_err_t flux_value_append(
+    const crous_value *value,
+    int max_depth,
+    uint8_t **buf,
+    size_t *pos,
+    size_t *cap);
+
+/**
+ * Decode the wire v1 value at *pos in buf, into arena when not NULL, and
+ * move *pos past it. max_depth <= 0 means CROUS_MAX_DEPTH.
+ */
+crous_err_t flux_value_read(
+    const uint8_t *buf,
+    size_t buf_size,
+    size_t *pos,
+    crous_arena *arena,
+    int max_depth,
+    crous_value **out_value);
+
 /* ============================================================================
    FLUX BINARY FORMAT MAGIC
    ============================================================================ */
@@ -163,5 +1185,112 @@ crous_err_t flux_decode_binary(
 #define FLUX_MAGIC_2 'U'
 #define FLUX_MAGIC_3 'X'
 #define FLUX_VERSION 1
+#define FLUX_VERSION_KEY_REFS 3     /* Wire v3 (CROUS_WIRE_V3) */
+#define FLUX_VERSION_COLUMNAR 4     /* Wire v4 (CROUS_WIRE_V4): v3 + FLUX_TAG_TABLE */
+#define FLUX_VERSION_VALUE_REFS 5   /* Wire v5 (CROUS_WIRE_V5): v4 + FLUX_TAG_SHARE/REF */
+
+/* Header flags byte; an extended header adds 6 bytes (see crous_version.h) */
+#define FLUX_FLAG_EXTENDED 0x80
+#define FLUX_FEATURE_REQUIRED 0x8000   /* Features word bit: readers lacking one must refuse */
+
+/* Compressed envelopes */
+#define FLUX_ENVELOPE_HEADER_SIZE 12
+#define FLUX_COMPRESS_BLOCK_SIZE 65536          /* Raw bytes per block written */
+#define FLUX_COMPRESS_BLOCK_MAX (1u << 22)      /* Largest raw block read */
+#define FLUX_ENVELOPE_CHECKSUM 0x01             /* Envelope flag: a CRC-32C per block */
+
+/* Shared dictionaries */
+#define FLUX_DICTIONARY_ID_MAX 0xFFFFFFu        /* Ids fill the envelope's u24 */
+#define FLUX_DICTIONARY_KEYS_MAX 4096
+#define FLUX_DICTIONARY_TRAIN_KEYS 1024         /* Keys kept by training */
+#define FLUX_DICTIONARY_TRAIN_KEY_MAX 256       /* Longer keys are not trained on */
+#define FLUX_DICTIONARY_REGISTRY_SIZE 1024      /* Dictionaries per process */
+
+/* Schemas */
+#define FLUX_SCHEMA_HEADER_SIZE 12
+#define FLUX_SCHEMA_ID_MAX 0xFFFFFFu            /* Ids fill the header's u24 */
+#define FLUX_SCHEMA_MAX_DEPTH 64                /* Nested list and record types */
+#define FLUX_SCHEMA_REGISTRY_SIZE 1024          /* Schemas per process */
+
+/*
+ * Wire v3 dict keys: the key length varint carries a flag in its low bit.
+ * (len << 1) is followed by len key bytes, which the reader appends to the
+ * document's key table while it has fewer than FLUX_KEY_TABLE_MAX entries.
+ * (index << 1) | 1 repeats the key at that table index.
+ */
+#define FLUX_KEY_TABLE_MAX 65536
+
+/*
+ * Wire v4 tables: a list of dicts that all have the same keys in the same
+ * order, stored column by column. Layout after FLUX_TAG_TABLE:
+ *   [rows varint][cols varint][cols x key (v3 key prefix)]
+ *   cols x ([column kind byte][rows values])
+ * rows and cols are at least 1. Decodes to a list of rows dicts.
+ */
+#define FLUX_TABLE_MIN_ROWS 4       /* Shorter lists stay row by row */
+
+/*
+ * Tables inside table cells, at most; encoders write lists nested deeper
+ * row by row. Each table takes two levels of depth, so no document within
+ * CROUS_MAX_DEPTH reaches this.
+ */
+#define FLUX_TABLE_MAX_NESTING (CROUS_MAX_DEPTH / 2)
+
+/*
+ * Packed arrays: after FLUX_TAG_I64_ARRAY / FLUX_TAG_F64_ARRAY,
+ *   [count varint][pad byte p < 8][p zero bytes][count x 8 bytes]
+ * Elements are little-endian int64 or IEEE 754 doubles, as for FLUX_TAG_FLOAT.
+ * p places the elements at a multiple of 8 from the start of the document,
+ * so an aligned input buffer can be read in place.
+ */
+#define FLUX_ARRAY_ALIGN 8
+
+/*
+ * Wire v5 shared values: FLUX_TAG_SHARE before a value's tag makes it the
+ * document's next shared value, numbered from 0 in the order the SHAREs
+ * appear; FLUX_TAG_REF followed by [index varint] stands for an earlier
+ * shared value that is complete. A SHARE is never followed by another
+ * SHARE or a REF. Encoders share repeated strings and bytes of at least
+ * FLUX_SHARE_MIN_BYTES bytes, packed arrays, tagged values and non-empty
+ * containers.
+ *
+ * A REF decodes to a copy of its value, so a document can expand far past
+ * its size. Decoders stop with CROUS_ERR_DECODE once the copies add up to
+ * FLUX_REF_EXPANSION times the document's length plus
+ * FLUX_REF_EXPANSION_BASE bytes (values, for the stream decoder).
+ */
+#define FLUX_SHARE_MIN_BYTES 4
+#define FLUX_REF_EXPANSION 64
+#define FLUX_REF_EXPANSION_BASE (1u << 20)
+
+/* Column encodings inside a table */
+enum {
+    FLUX_COLUMN_ANY = 0x00,         /* Tagged values, as in a list */
+    FLUX_COLUMN_INT = 0x01,         /* Zigzag varints */
+    FLUX_COLUMN_INT_DELTA = 0x02,   /* Zigzag varints: first value, then differences (mod 2^64) */
+    FLUX_COLUMN_FLOAT = 0x03,       /* Raw 8-byte doubles, as FLUX_TAG_FLOAT */
+    FLUX_COLUMN_BOOL = 0x04,        /* Bitmap, row i in bit i % 8 of byte i / 8 */
+    FLUX_COLUMN_STRING = 0x05,      /* Length varint + UTF-8 bytes */
+};
+
+/* Binary value tags */
+enum {
+    FLUX_TAG_NULL = 0x00,
+    FLUX_TAG_FALSE = 0x01,
+    FLUX_TAG_TRUE = 0x02,
+    FLUX_TAG_INT = 0x03,
+    FLUX_TAG_FLOAT = 0x04,
+    FLUX_TAG_STRING = 0x05,
+    FLUX_TAG_BYTES = 0x06,
+    FLUX_TAG_LIST = 0x07,
+    FLUX_TAG_DICT = 0x08,
+    FLUX_TAG_TAGGED = 0x09,
+    FLUX_TAG_TUPLE = 0x0A,
+    FLUX_TAG_TABLE = 0x0B,          /* Wire v4 */
+    FLUX_TAG_I64_ARRAY = 0x0C,      /* Packed arrays, any wire version */
+    FLUX_TAG_F64_ARRAY = 0x0D,
+    FLUX_TAG_SHARE = 0x0E,          /* Wire v5 */
+    FLUX_TAG_REF = 0x0F,            /* Wire v5 */
+};
 
 #endif /* CROUS_FLUX_H */
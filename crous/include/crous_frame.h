@@ -0,0 +1,305 @@
+#ifndef CROUS_FRAME_H
+#define CROUS_FRAME_H
+
+#include "crous_types.h"
+#include "crous_arena.h"
+
+/* ============================================================================
+   RECORD-FRAMED LOGS
+   ============================================================================ */
+
+/**
+ * An appendable sequence of independent records, each a complete FLUX
+ * binary document:
+ *
+ *   file header   "FLXR", version (1), 3 reserved zero bytes
+ *   record        u32 LE (body_len << 2 | is_index << 1 | has_crc),
+ *                 [u32 LE CRC-32C of the body when has_crc], then
+ *                 body_len bytes of body
+ *
+ * Each record says on its own whether it carries a checksum, so a writer
+ * appending to an existing log never has to read it first. A log that
+ * ends part-way through a record (an interrupted append) reads as
+ * CROUS_ERR_TRUNCATED once the complete records before it are consumed.
+ *
+ * Index records (is_index) are footers left by an indexing writer on
+ * close; sequential readers step over them. A footer body is
+ *
+ *   entries       entry_count x { u64 record, u64 offset, u32 key_off,
+ *                 u32 key_len }, record numbers relative to the segment
+ *   keys          key_bytes bytes of user keys, addressed by the entries
+ *   trailer       u64 segment_start, u64 segment_records, u64 footer
+ *                 offset, u32 entry_count, u32 key_bytes, u32 interval,
+ *                 "FLXI"
+ *
+ * all little-endian, with offsets counted from the start of the log. A
+ * segment is the run of records one writer added; a log appended to by
+ * indexing writers is a chain of segments, each ending in its footer.
+ */
+
+#define CROUS_FRAME_MAGIC_0 'F'
+#define CROUS_FRAME_MAGIC_1 'L'
+#define CROUS_FRAME_MAGIC_2 'X'
+#define CROUS_FRAME_MAGIC_3 'R'
+#define CROUS_FRAME_VERSION 1
+#define CROUS_FRAME_HEADER_SIZE 8
+#define CROUS_FRAME_MAX_RECORD 0x3FFFFFFFu  /* Body bytes per record */
+#define CROUS_FRAME_INDEX_INTERVAL 1024     /* Default records per index entry */
+
+/* Writer flags */
+#define CROUS_FRAME_CHECKSUM 0x01   /* Give every record a CRC-32C */
+#define CROUS_FRAME_APPEND   0x02   /* out continues an existing log: no file header */
+
+typedef struct crous_frame_writer crous_frame_writer;
+typedef struct crous_frame_reader crous_frame_reader;
+typedef struct crous_frame_index crous_frame_index;
+
+/**
+ * Start a log on out, writing the file header unless CROUS_FRAME_APPEND
+ * is set. Records are buffered and reach out in CROUS_STREAM_CHUNK_SIZE
+ * blocks; records larger than a block are written straight through.
+ */
+crous_err_t crous_frame_writer_new(
+    crous_output_stream *out,
+    unsigned flags,
+    crous_frame_writer **out_writer);
+
+/**
+ * Append one record whose body is len bytes of FLUX binary
+ */
+crous_err_t crous_frame_writer_write(
+    crous_frame_writer *writer,
+    const uint8_t *body,
+    size_t len);
+
+/**
+ * Append a record with a user key. Keys are compared bytewise (memcmp,
+ * shorter first on a tie) and, for crous_frame_index_find(), must not
+ * decrease from record to record. Only the keys of indexed records are
+ * kept. Without an index this is crous_frame_writer_write().
+ */
+crous_err_t crous_frame_writer_write_keyed(
+    crous_frame_writer *writer,
+    const uint8_t *body,
+    size_t len,
+    const uint8_t *key,
+    size_t key_len);
+
+/**
+ * Append a record encoding value as FLUX binary
+ */
+crous_err_t crous_frame_writer_write_value(
+    crous_frame_writer *writer,
+    const crous_value *value);
+
+/**
+ * Keep a sparse index of every interval-th record (0 for
+ * CROUS_FRAME_INDEX_INTERVAL), written as a footer by
+ * crous_frame_writer_close(). log_size is the size of the log being
+ * continued under CROUS_FRAME_APPEND, so offsets count from its start; it
+ * is ignored for a new log. Call before the first record.
+ */
+crous_err_t crous_frame_writer_set_index(
+    crous_frame_writer *writer,
+    uint32_t interval,
+    uint64_t log_size);
+
+/**
+ * Hand buffered records to the output stream
+ */
+crous_err_t crous_frame_writer_flush(crous_frame_writer *writer);
+
+/**
+ * Write the index footer, if any, flush, and free the writer. The writer
+ * is freed even if the flush fails.
+ */
+crous_err_t crous_frame_writer_close(crous_frame_writer *writer);
+
+/**
+ * Read a log from in. The file header is checked by the first
+ * crous_frame_reader_next() call.
+ */
+crous_err_t crous_frame_reader_new(
+    crous_input_stream *in,
+    crous_frame_reader **out_reader);
+
+/**
+ * Next record's body, valid until the next call or until the reader is
+ * freed. CROUS_ERR_NOT_FOUND at the end of the log, CROUS_ERR_INVALID_HEADER
+ * if in is not a log, CROUS_ERR_TRUNCATED for a partial record and
+ * CROUS_ERR_CHECKSUM for a checksum mismatch. An empty input is an empty
+ * log.
+ *
+ * The reader buffers CROUS_STREAM_CHUNK_SIZE bytes at a time; it only
+ * grows past that, to the size of the largest record, as the record's
+ * bytes actually arrive.
+ */
+crous_err_t crous_frame_reader_next(
+    crous_frame_reader *reader,
+    const uint8_t **out_body,
+    size_t *out_len);
+
+/**
+ * Free a reader
+ */
+void crous_frame_reader_free(crous_frame_reader *reader);
+
+/* ============================================================================
+   SEEK INDEX
+   ============================================================================ */
+
+/**
+ * Random access to a log held in memory (typically a crous_file_view).
+ * Opening follows the footer chain back from the end of the log; any
+ * stretch not covered by a footer (unindexed appends, a crash before
+ * close) is indexed by walking its length words. data must outlive the
+ * index. A log cut off part-way through a record opens with its complete
+ * records; reading past them gives CROUS_ERR_TRUNCATED.
+ */
+crous_err_t crous_frame_index_open(
+    const uint8_t *data,
+    size_t size,
+    crous_frame_index **out_index);
+
+/**
+ * Number of complete records
+ */
+uint64_t crous_frame_index_count(const crous_frame_index *index);
+
+/**
+ * Offset of record number record, in O(log n) plus at most one index
+ * interval of length words. CROUS_ERR_NOT_FOUND past the last record.
+ */
+crous_err_t crous_frame_index_seek(
+    const crous_frame_index *index,
+    uint64_t record,
+    uint64_t *out_offset);
+
+/**
+ * Last indexed record whose key is <= key: where a scan for key starts.
+ * CROUS_ERR_NOT_FOUND if every indexed key is greater, or none was kept.
+ */
+crous_err_t crous_frame_index_find(
+    const crous_frame_index *index,
+    const uint8_t *key,
+    size_t key_len,
+    uint64_t *out_record,
+    uint64_t *out_offset);
+
+/**
+ * Cut the log into parts ranges of about equal bytes at index entries:
+ * fills out_records[0..parts] with ascending record numbers from 0 to the
+ * record count. Ranges may be empty when the log has few entries.
+ */
+crous_err_t crous_frame_index_split(
+    const crous_frame_index *index,
+    size_t parts,
+    uint64_t *out_records);
+
+/**
+ * Body of the record at *offset, stepping over footers, checked against
+ * its CRC when it has one; *offset moves past it. An *offset of 0 starts
+ * at the first record. CROUS_ERR_NOT_FOUND at the end of the log,
+ * CROUS_ERR_CHECKSUM for a checksum mismatch.
+ */
+crous_err_t crous_frame_index_read(
+    const crous_frame_index *index,
+    uint64_t *offset,
+    const uint8_t **out_body,
+    size_t *out_len);
+
+/**
+ * Free an index (not the data it reads)
+ */
+void crous_frame_index_free(crous_frame_index *index);
+
+/* ============================================================================
+   PARALLEL DECODE
+   ============================================================================ */
+
+/**
+ * Every record of a log, decoded. values[i] is the tree of record i, in
+ * log order. The trees live in arenas owned by the set; free them all
+ * with crous_record_set_free(), never one by one.
+ */
+typedef struct {
+    crous_value **values;
+    size_t count;
+    crous_arena **_arenas;      /* One per decoded range */
+    size_t _arena_count;
+} crous_record_set;
+
+/**
+ * Decode every record of the log in data on up to nthreads threads
+ * of the pool (<= 0 for all of it). The log is cut at seek index entries into
+ * byte-balanced record ranges, several per thread. Each range is decoded
+ * into its own arena. Trees copy their payloads, so data may go away
+ * afterwards. Parallelism is bounded by the index: a log with fewer
+ * entries than threads (few records, or a coarse interval) decodes on
+ * fewer threads.
+ *
+ * Errors are those of crous_frame_index_open() and
+ * crous_frame_index_read(), or of the first record that fails to
+ * decode, in log order. A log cut off part-way through a record is
+ * CROUS_ERR_TRUNCATED. On failure *out_set is left empty.
+ */
+crous_err_t crous_decode_log_parallel(
+    const uint8_t *data,
+    size_t size,
+    int nthreads,
+    crous_record_set *out_set);
+
+/**
+ * crous_decode_log_parallel() on a memory-mapped view of the file at
+ * path. An unreadable file is CROUS_ERR_STREAM.
+ */
+crous_err_t crous_decode_file_parallel(
+    const char *path,
+    int nthreads,
+    crous_record_set *out_set);
+
+/**
+ * Free every tree of a set and empty it
+ */
+void crous_record_set_free(crous_record_set *set);
+
+/* ============================================================================
+   MIGRATION
+   ============================================================================ */
+
+/* Migration flags, alongside CROUS_FRAME_CHECKSUM */
+#define CROUS_MIGRATE_INDEX 0x04    /* Give the migrated log a seek index at the default interval */
+
+/**
+ * Copy the log read from in to out record by record, migrating each body
+ * to target_version through the crous_version.h registry. Header-only
+ * paths rewrite the version byte in the reader's buffer; others run
+ * crous_migrate() on the one record. Memory is bounded by the largest
+ * record. flags takes CROUS_FRAME_CHECKSUM and CROUS_MIGRATE_INDEX;
+ * index footers of the input are dropped, user keys with them. Errors are
+ * those of crous_frame_reader_next() and of the migrations; out has the
+ * records migrated before the failure.
+ */
+crous_err_t crous_migrate_log(
+    crous_input_stream *in,
+    crous_output_stream *out,
+    uint8_t target_version,
+    unsigned flags);
+
+/**
+ * crous_migrate_log() from each src_paths[i] to dst_paths[i], files
+ * spread over up to nthreads threads of the pool (<= 0 for all of it).
+ * out_errors, if not NULL, receives each file's result; the return value
+ * is the first failure in path order. An unopenable file is
+ * CROUS_ERR_STREAM, and a failed file's destination is removed.
+ */
+crous_err_t crous_migrate_files_parallel(
+    const char *const *src_paths,
+    const char *const *dst_paths,
+    size_t count,
+    uint8_t target_version,
+    unsigned flags,
+    int nthreads,
+    crous_err_t *out_errors);
+
+#endif /* CROUS_FRAME_H */
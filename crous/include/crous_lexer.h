@@ -13,10 +13,16 @@
 typedef struct crous_lexer_s crous_lexer;
 
 /**
- * Create lexer for input text
+ * Create lexer for input text. With an arena the lexer itself is
+ * allocated there and goes away with it.
  */
 crous_lexer* crous_lexer_create(const char *input, size_t input_len, crous_arena *arena);
 
+/**
+ * Free a lexer (no-op for one created in an arena)
+ */
+void crous_lexer_free(crous_lexer *lexer);
+
 /**
  * Get next token from lexer
  */
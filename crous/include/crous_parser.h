@@ -13,12 +13,22 @@
 typedef struct crous_parser_s crous_parser;
 
 /**
- * Create parser from lexer
+ * Create parser from lexer. With an arena the parser, its scratch space
+ * and every value it builds live in the arena; with NULL the tree is
+ * heap-allocated and freed with crous_value_free_tree().
  */
 crous_parser* crous_parser_create(crous_lexer *lexer, crous_arena *arena);
 
 /**
- * Parse complete value from token stream
+ * Free a parser (no-op for one created in an arena). Trees it returned
+ * are not affected.
+ */
+void crous_parser_free(crous_parser *parser);
+
+/**
+ * Parse complete value from token stream. In arena mode, strings without
+ * escapes and all dict keys point into the lexer input, which must then
+ * outlive the tree.
  */
 crous_err_t crous_parser_parse(crous_parser *parser, crous_value **out_value);
 
@@ -0,0 +1,62 @@
+#ifndef CROUS_SCAN_H
+#define CROUS_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ============================================================================
+   BYTE SCANNING
+   ============================================================================ */
+
+/**
+ * Vectorised byte-class scans shared by the validators and text lexers.
+ *
+ * Each call is dispatched at runtime to the widest kernel the CPU supports
+ * (AVX2, then SSE2 on x86; NEON on AArch64) and falls back to a scalar loop
+ * elsewhere. Define CROUS_NO_SIMD at build time to force the scalar loops.
+ * All kernels return identical results.
+ */
+
+/* Kernel selected by runtime dispatch */
+typedef enum {
+    CROUS_SIMD_SCALAR = 0,
+    CROUS_SIMD_SSE2,
+    CROUS_SIMD_AVX2,
+    CROUS_SIMD_NEON,
+} crous_simd_level_t;
+
+/* Byte classes, combinable as a bitmask */
+#define CROUS_CHAR_BLANK   0x01u  /* ' ' and '\t' */
+#define CROUS_CHAR_CR      0x02u  /* '\r' */
+#define CROUS_CHAR_LF      0x04u  /* '\n' */
+#define CROUS_CHAR_IDENT   0x08u  /* [A-Za-z0-9_] */
+#define CROUS_CHAR_SPECIAL 0x10u  /* Forces quoting in FLUX text: isspace, NUL, : @ [ ] # " ' */
+#define CROUS_CHAR_QUOTE   0x20u  /* Ends a quoted-string run: " ' and backslash */
+
+/**
+ * Kernel used by the scans in this process (detected once, on first use)
+ */
+crous_simd_level_t crous_simd_level(void);
+
+/**
+ * Name of a kernel: "scalar", "sse2", "avx2" or "neon"
+ */
+const char* crous_simd_level_name(crous_simd_level_t level);
+
+/**
+ * Length of the leading run of bytes that belong to any class in `classes`
+ */
+size_t crous_scan_span(const char *data, size_t len, unsigned classes);
+
+/**
+ * Length of the leading run of bytes that belong to none of `classes`
+ */
+size_t crous_scan_cspan(const char *data, size_t len, unsigned classes);
+
+/**
+ * Check that data is structurally valid UTF-8 (lead bytes followed by the
+ * right number of continuation bytes). Returns 1 if valid, 0 otherwise.
+ */
+int crous_utf8_valid(const uint8_t *data, size_t len);
+
+#endif /* CROUS_SCAN_H */
@@ -0,0 +1,67 @@
+#ifndef CROUS_SESSION_H
+#define CROUS_SESSION_H
+
+#include "crous_types.h"
+#include "crous_arena.h"
+#include "crous_flux.h"
+
+/* ============================================================================
+   ENCODE/DECODE SESSIONS
+   ============================================================================ */
+
+/**
+ * Reusable state for encoding or decoding many documents in a row. A
+ * session keeps its output buffers and its decode arena between calls,
+ * growing them to fit the largest document seen, so a steady stream of
+ * similar messages is handled without heap allocation. Key-reference and
+ * columnar encodes still build their key index per call.
+ *
+ * Results belong to the session and last until the next call of the same
+ * kind. A session is not thread-safe; use one per thread.
+ */
+typedef struct crous_session crous_session;
+
+/**
+ * Create an empty session; buffers are allocated on first use
+ */
+crous_err_t crous_session_new(crous_session **out_session);
+
+/**
+ * Free a session, its buffers and the tree of its last decode
+ */
+void crous_session_free(crous_session *session);
+
+/**
+ * Encode value as flux_encode_binary_opts() would (NULL opts for the
+ * defaults), into the session's buffer. *out_buf stays valid until the
+ * next crous_session_encode() or crous_session_free().
+ */
+crous_err_t crous_session_encode(
+    crous_session *session,
+    const crous_value *value,
+    const flux_binary_options_t *opts,
+    const uint8_t **out_buf,
+    size_t *out_size);
+
+/**
+ * Decode into the session's arena as crous_decode_arena() does, resetting
+ * it first: the previous decode's tree is released, and *out_value lives
+ * until the next decode. Never pass it to crous_value_free_tree().
+ */
+crous_err_t crous_session_decode(
+    crous_session *session,
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_value **out_value);
+
+/**
+ * crous_session_decode() borrowing payloads and keys from buf, as
+ * crous_decode_borrowed() does; buf must outlive the tree
+ */
+crous_err_t crous_session_decode_borrowed(
+    crous_session *session,
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_value **out_value);
+
+#endif /* CROUS_SESSION_H */
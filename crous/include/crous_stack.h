@@ -0,0 +1,60 @@
+#ifndef CROUS_STACK_H
+#define CROUS_STACK_H
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+   WORK STACKS
+   ============================================================================ */
+
+/**
+ * Growable frame stacks for the iterative tree walks, so document depth is
+ * bounded by memory and the caller's limit rather than the C stack.
+ *
+ * A walk starts on a small array of its own frames and moves to the heap
+ * only when a document nests deeper than that:
+ *
+ *     frame_t local[CROUS_STACK_INLINE], *stack = local;
+ *     size_t top = 0, cap = CROUS_STACK_INLINE;
+ *     ...
+ *     if (top == cap) {
+ *         frame_t *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+ *         if (!grown) return CROUS_ERR_OOM;
+ *         stack = grown;
+ *     }
+ *     ...
+ *     crous_stack_release(stack, local);
+ */
+
+/* Frames a walk keeps on the C stack before growing onto the heap */
+#define CROUS_STACK_INLINE 32
+
+/**
+ * Double the capacity *cap of stack, whose frames are size bytes, moving it
+ * off the inline array local on the first growth. Returns the new base, or
+ * NULL, with stack and *cap untouched, when out of memory.
+ */
+static inline void *crous_stack_grow(void *stack, size_t *cap, size_t size, const void *local) {
+    size_t grown_cap = *cap * 2;
+    if (grown_cap < *cap || grown_cap > (size_t)-1 / size) return NULL;
+
+    void *grown;
+    if (stack == local) {
+        grown = malloc(grown_cap * size);
+        if (grown) memcpy(grown, stack, *cap * size);
+    } else {
+        grown = realloc(stack, grown_cap * size);
+    }
+    if (grown) *cap = grown_cap;
+    return grown;
+}
+
+/**
+ * Free stack if it grew onto the heap
+ */
+static inline void crous_stack_release(void *stack, const void *local) {
+    if (stack != local) free(stack);
+}
+
+#endif /* CROUS_STACK_H */
@@ -0,0 +1,228 @@
+#ifndef CROUS_STATS_H
+#define CROUS_STATS_H
+
+#include "crous_types.h"
+
+/* ============================================================================
+   INSTRUMENTATION
+   ============================================================================ */
+
+/**
+ * Opt-in counters and trace hooks for finding where encode and decode
+ * time goes.
+ *
+ * Both are off by default. While they are, every hook in the codecs is one
+ * well-predicted branch on a global flag; building with CROUS_NO_STATS
+ * removes the hooks altogether. Counters live in one block per thread, so
+ * counting never contends; crous_stats_get() sums the blocks of every
+ * thread that has counted, including threads that have since exited.
+ *
+ * Timing is taken per entry point: each public encode, decode and
+ * transcode function opens a span, and only the outermost span on a
+ * thread records, so nested calls never count bytes or time twice.
+ */
+
+/* Wire formats a span reads or writes */
+typedef enum {
+    CROUS_STATS_FMT_NONE = 0,   /* A value tree, or host objects in a binding */
+    CROUS_STATS_FMT_FLUX,       /* FLUX binary */
+    CROUS_STATS_FMT_LEGACY,     /* CROUS binary */
+    CROUS_STATS_FMT_FLUX_TEXT,
+    CROUS_STATS_FMT_CROUT,
+    CROUS_STATS_FMT_COUNT
+} crous_stats_format_t;
+
+/* What a span spends its time on */
+typedef enum {
+    CROUS_PHASE_DECODE = 0,     /* Wire bytes to a value tree */
+    CROUS_PHASE_ENCODE,         /* A value tree to wire bytes */
+    CROUS_PHASE_TRANSCODE,      /* One wire format to another */
+    CROUS_PHASE_CONVERT,        /* Host objects to or from wire bytes or trees, in bindings */
+    CROUS_PHASE_COUNT
+} crous_phase_t;
+
+#define CROUS_STATS_TYPES (CROUS_TYPE_F64_ARRAY + 1)
+
+typedef struct {
+    uint64_t bytes_encoded[CROUS_STATS_FMT_COUNT];  /* Output of successful spans */
+    uint64_t bytes_decoded[CROUS_STATS_FMT_COUNT];  /* Input of successful spans */
+    uint64_t values_created[CROUS_STATS_TYPES];     /* Value nodes (or host objects) built, by type */
+    uint64_t mallocs;           /* Heap allocations and reallocations by the value and arena code, pool hits included */
+    uint64_t malloc_bytes;
+    uint64_t pool_hits;         /* Of mallocs, value nodes served from the calling thread's pool */
+    uint64_t arena_chunks;      /* Arena chunks allocated, the first one included */
+    uint64_t arena_bytes;
+    uint64_t varint_reads;
+    uint64_t callbacks;         /* Calls into user code: serializers, decoders, hooks */
+    uint64_t calls[CROUS_PHASE_COUNT];      /* Outermost spans, successful or not */
+    uint64_t phase_ns[CROUS_PHASE_COUNT];   /* Wall time inside them */
+} crous_stats_t;
+
+/**
+ * Turn counting on or off for every thread. Counts are kept while off.
+ */
+void crous_stats_enable(int enabled);
+
+int crous_stats_enabled(void);
+
+/**
+ * Sum of the counters of every thread
+ */
+void crous_stats_get(crous_stats_t *out);
+
+/**
+ * The calling thread's counters alone
+ */
+void crous_stats_get_thread(crous_stats_t *out);
+
+/**
+ * Zero every thread's counters. Counts made concurrently may survive.
+ */
+void crous_stats_reset(void);
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+uint64_t crous_stats_now_ns(void);
+
+/* ============================================================================
+   TRACE HOOKS
+   ============================================================================ */
+
+enum {
+    CROUS_TRACE_BEGIN = 0,
+    CROUS_TRACE_END = 1,
+};
+
+typedef struct {
+    int event;                  /* CROUS_TRACE_BEGIN or CROUS_TRACE_END */
+    const char *entry;          /* Entry point, e.g. "flux_decode_binary" */
+    crous_phase_t phase;
+    crous_stats_format_t in_format;
+    crous_stats_format_t out_format;
+    size_t in_size;             /* Input bytes; for streams, 0 until END */
+    size_t out_size;            /* Output bytes; END only */
+    crous_err_t err;            /* END only */
+    uint64_t elapsed_ns;        /* END only */
+} crous_trace_info;
+
+typedef void (*crous_trace_fn)(void *user, const crous_trace_info *info);
+
+/**
+ * Call fn around every outermost entry point, on the thread running it,
+ * with BEGIN before any work and END after. NULL removes the hook. Meant
+ * to be set before codec calls start on other threads; fn must not call
+ * back into crous.
+ */
+void crous_stats_set_trace(crous_trace_fn fn, void *user);
+
+/* ============================================================================
+   HOOKS (for codec implementations)
+   ============================================================================ */
+
+#define CROUS_STATS_COUNT 1     /* crous_stats_mode bit: counting on */
+#define CROUS_STATS_TRACE 2     /* crous_stats_mode bit: a trace hook is set */
+
+typedef struct {
+    crous_trace_info info;
+    uint64_t start_ns;
+    int active;                 /* Outermost span with stats or a trace on */
+    crous_input_stream in;      /* Counting wrappers, see crous_span_input() */
+    crous_input_stream *in_inner;
+    crous_output_stream out;
+    crous_output_stream *out_inner;
+} crous_span;
+
+/* Thread-local storage, where the compiler has it (the arena's node pools use it too) */
+#if defined(_MSC_VER)
+#  define CROUS_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#  define CROUS_THREAD_LOCAL __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#  define CROUS_THREAD_LOCAL _Thread_local
+#endif
+
+#if defined(CROUS_NO_STATS)
+
+#define CROUS_STAT_ADD(field, n) ((void)0)
+
+static inline void crous_span_begin(crous_span *s, const char *entry, crous_phase_t phase,
+                                    crous_stats_format_t in_format, crous_stats_format_t out_format,
+                                    size_t in_size) {
+    (void)entry; (void)phase; (void)in_format; (void)out_format; (void)in_size;
+    s->active = 0;
+}
+
+static inline crous_err_t crous_span_end(crous_span *s, crous_err_t err, size_t out_size) {
+    (void)s; (void)out_size;
+    return err;
+}
+
+static inline crous_input_stream *crous_span_input(crous_span *s, crous_input_stream *in) {
+    (void)s;
+    return in;
+}
+
+static inline crous_output_stream *crous_span_output(crous_span *s, crous_output_stream *out) {
+    (void)s;
+    return out;
+}
+
+#else
+
+/* CROUS_STATS_COUNT | CROUS_STATS_TRACE; read without synchronization */
+extern int crous_stats_mode;
+
+/* The calling thread's block, registered on first use */
+crous_stats_t *crous_stats_local_slow(void);
+
+#if defined(CROUS_THREAD_LOCAL)
+extern CROUS_THREAD_LOCAL crous_stats_t *crous_stats_tls;
+
+static inline crous_stats_t *crous_stats_local(void) {
+    crous_stats_t *s = crous_stats_tls;
+    return s ? s : crous_stats_local_slow();
+}
+#else
+/* No thread-local storage: one shared block, counted without atomics */
+#  define crous_stats_local crous_stats_local_slow
+#endif
+
+/* Add n to a crous_stats_t field of the calling thread when counting is on */
+#define CROUS_STAT_ADD(field, n) do { \
+        if (crous_stats_mode & CROUS_STATS_COUNT) crous_stats_local()->field += (uint64_t)(n); \
+    } while (0)
+
+void crous_span_open(crous_span *s, const char *entry, crous_phase_t phase,
+                     crous_stats_format_t in_format, crous_stats_format_t out_format, size_t in_size);
+crous_err_t crous_span_close(crous_span *s, crous_err_t err, size_t out_size);
+
+/**
+ * Open a span around an entry point; in_size is the input length, 0 for
+ * streams or tree input. Every begin needs a matching crous_span_end().
+ */
+static inline void crous_span_begin(crous_span *s, const char *entry, crous_phase_t phase,
+                                    crous_stats_format_t in_format, crous_stats_format_t out_format,
+                                    size_t in_size) {
+    s->active = 0;
+    if (crous_stats_mode) crous_span_open(s, entry, phase, in_format, out_format, in_size);
+}
+
+/**
+ * Close the span and pass err through; out_size adds to the bytes any
+ * counting output stream saw
+ */
+static inline crous_err_t crous_span_end(crous_span *s, crous_err_t err, size_t out_size) {
+    return s->active ? crous_span_close(s, err, out_size) : err;
+}
+
+/**
+ * A stream that counts into the span what it passes through, or in itself
+ * when the span is not recording. Valid until crous_span_end().
+ */
+crous_input_stream *crous_span_input(crous_span *s, crous_input_stream *in);
+crous_output_stream *crous_span_output(crous_span *s, crous_output_stream *out);
+
+#endif /* CROUS_NO_STATS */
+
+#endif /* CROUS_STATS_H */
@@ -0,0 +1,193 @@
+#ifndef CROUS_STDTYPES_H
+#define CROUS_STDTYPES_H
+
+#include "crous_types.h"
+#include "crous_varint.h"
+#include <string.h>
+
+/* ============================================================================
+   BUILT-IN TAGS
+   ============================================================================ */
+
+/**
+ * Tags with a meaning shared by every binding. The standard types travel
+ * as a tagged scalar or short list, so any reader that doesn't know them
+ * still sees plain values:
+ *
+ *   DATETIME   int: microseconds since 1970-01-01T00:00:00 of a naive
+ *              (wall-clock) datetime, or [int, int]: the UTC instant in
+ *              microseconds since the epoch and the UTC offset in seconds
+ *   DATE       int: days since 1970-01-01
+ *   TIME       int: microseconds since midnight, or [int, int] with the
+ *              UTC offset in seconds
+ *   DECIMAL    bytes: crous_decimal_pack() layout
+ *   UUID       bytes: the 16 bytes of the UUID, big-endian
+ *
+ * Dates run from year 1 to 9999 of the proleptic Gregorian calendar.
+ */
+enum {
+    CROUS_TAG_DATETIME  = 80,
+    CROUS_TAG_DATE      = 81,
+    CROUS_TAG_TIME      = 82,
+    CROUS_TAG_DECIMAL   = 83,
+    CROUS_TAG_UUID      = 84,
+    CROUS_TAG_SET       = 90,
+    CROUS_TAG_FROZENSET = 91,
+    CROUS_TAG_PATH      = 92,
+    CROUS_TAG_CUSTOM    = 100,  /* First tag handed out for custom types */
+};
+
+#define CROUS_US_PER_DAY  86400000000LL
+#define CROUS_DAYS_MIN    (-719162LL)   /* 0001-01-01 */
+#define CROUS_DAYS_MAX    2932896LL     /* 9999-12-31 */
+
+/* ============================================================================
+   CALENDAR
+   ============================================================================ */
+
+/**
+ * Days since 1970-01-01 of a proleptic Gregorian date (month 1-12)
+ */
+static inline int64_t crous_days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+/**
+ * Inverse of crous_days_from_civil()
+ */
+static inline void crous_civil_from_days(int64_t days, int *y, unsigned *m, unsigned *d) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = (unsigned)(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = (int)(yoe + era * 400 + (*m <= 2));
+}
+
+/**
+ * Split microseconds since the epoch into days and microseconds of the
+ * day, rounding towards negative infinity
+ */
+static inline int64_t crous_split_us(int64_t us, int64_t *us_of_day) {
+    int64_t days = us / CROUS_US_PER_DAY;
+    int64_t rem = us % CROUS_US_PER_DAY;
+    if (rem < 0) {
+        rem += CROUS_US_PER_DAY;
+        days--;
+    }
+    *us_of_day = rem;
+    return days;
+}
+
+/* ============================================================================
+   PACKED DECIMALS
+   ============================================================================ */
+
+/**
+ * A decimal is one flags byte, then for finite values the zigzag varint
+ * exponent, then the coefficient digits packed two per byte, most
+ * significant first, with an odd count padded by a 0xF low nibble:
+ *
+ *   flags bit 0      sign (1 = negative)
+ *   flags bits 1-2   CROUS_DECIMAL_FINITE / _INF / _NAN / _SNAN
+ *
+ * The value is (-1)^sign * digits * 10^exponent. NaNs keep their payload
+ * digits; infinities have none. Leading zero digits are kept, so 0.00 and
+ * 0 stay distinct.
+ */
+enum {
+    CROUS_DECIMAL_FINITE = 0,
+    CROUS_DECIMAL_INF    = 1,
+    CROUS_DECIMAL_NAN    = 2,
+    CROUS_DECIMAL_SNAN   = 3,
+};
+
+/**
+ * Packed size of a decimal with ndigits digits
+ */
+static inline size_t crous_decimal_packed_size(size_t ndigits) {
+    return 1 + CROUS_VARINT_MAX + (ndigits + 1) / 2;
+}
+
+/**
+ * Pack digits (values 0-9) into out, which holds
+ * crous_decimal_packed_size(ndigits) bytes. Returns the bytes written.
+ */
+static inline size_t crous_decimal_pack(int negative, int special, int64_t exponent,
+                                        const uint8_t *digits, size_t ndigits, uint8_t *out) {
+    uint8_t *p = out;
+    *p++ = (uint8_t)((negative ? 1 : 0) | (special << 1));
+    if (special == CROUS_DECIMAL_FINITE)
+        p = crous_varint_put(p, crous_zigzag_encode(exponent));
+    for (size_t i = 0; i < ndigits; i += 2) {
+        uint8_t lo = i + 1 < ndigits ? digits[i + 1] : 0x0F;
+        *p++ = (uint8_t)(digits[i] << 4 | lo);
+    }
+    return (size_t)(p - out);
+}
+
+/**
+ * Parse the header of a packed decimal. On success *digits points at the
+ * packed digits and *ndigits is their count; the digits themselves are
+ * read with crous_decimal_digit(). CROUS_ERR_DECODE if data is malformed.
+ */
+static inline crous_err_t crous_decimal_unpack(const uint8_t *data, size_t len, int *negative,
+                                               int *special, int64_t *exponent,
+                                               const uint8_t **digits, size_t *ndigits) {
+    if (len < 1 || data[0] > 7) return CROUS_ERR_DECODE;
+    *negative = data[0] & 1;
+    *special = data[0] >> 1;
+    *exponent = 0;
+    size_t pos = 1;
+    if (*special == CROUS_DECIMAL_FINITE) {
+        uint64_t u;
+        size_t used;
+        if (crous_varint_get(data + 1, len - 1, &u, &used) != CROUS_OK) return CROUS_ERR_DECODE;
+        *exponent = crous_zigzag_decode(u);
+        pos += used;
+    }
+    size_t n = (len - pos) * 2;
+    if (n > 0 && (data[len - 1] & 0x0F) == 0x0F) n--;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t b = data[pos + i / 2];
+        if (((i & 1) ? b & 0x0F : b >> 4) > 9) return CROUS_ERR_DECODE;
+    }
+    if (*special == CROUS_DECIMAL_INF && n > 0) return CROUS_ERR_DECODE;
+    *digits = data + pos;
+    *ndigits = n;
+    return CROUS_OK;
+}
+
+static inline unsigned crous_decimal_digit(const uint8_t *digits, size_t i) {
+    uint8_t b = digits[i / 2];
+    return (i & 1) ? b & 0x0F : b >> 4;
+}
+
+/* ============================================================================
+   UUIDS
+   ============================================================================ */
+
+/**
+ * The canonical 36-character lowercase form of a 16-byte UUID; out holds
+ * 37 bytes and is NUL-terminated
+ */
+static inline void crous_uuid_format(const uint8_t *uuid, char *out) {
+    static const char hex[] = "0123456789abcdef";
+    char *p = out;
+    for (int i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) *p++ = '-';
+        *p++ = hex[uuid[i] >> 4];
+        *p++ = hex[uuid[i] & 0x0F];
+    }
+    *p = '\0';
+}
+
+#endif /* CROUS_STDTYPES_H */
@@ -30,6 +30,8 @@ typedef enum {
     CROUS_TYPE_TUPLE,
     CROUS_TYPE_DICT,
     CROUS_TYPE_TAGGED,
+    CROUS_TYPE_I64_ARRAY,
+    CROUS_TYPE_F64_ARRAY,
 } crous_type_t;
 
 /* Error codes */
@@ -47,6 +49,8 @@ typedef enum {
     CROUS_ERR_INVALID_HEADER = 10,
     CROUS_ERR_SYNTAX = 11,
     CROUS_ERR_DEPTH_EXCEEDED = 12,
+    CROUS_ERR_NOT_FOUND = 13,
+    CROUS_ERR_CHECKSUM = 14,
 } crous_err_t;
 
 /* ============================================================================
@@ -89,11 +93,20 @@ struct crous_list {
     size_t cap;
 };
 
-/* Dictionary structure */
+/* Dictionary structure
+ *
+ * entries[] keeps insertion order. index is an optional open-addressing
+ * hash table (slot = entry position + 1, 0 = empty) that is built by the
+ * append that brings len to CROUS_DICT_INDEX_THRESHOLD; NULL until then.
+ * Arena dicts created with that many slots reserve index in the arena up
+ * front and fill it as entries are appended. Lookups never write to it.
+ */
 struct crous_dict {
     crous_dict_entry *entries;
     size_t len;
     size_t cap;
+    uint32_t *index;
+    size_t index_cap;
 };
 
 /* String/Bytes structure */
@@ -102,6 +115,13 @@ typedef struct {
     size_t len;
 } crous_buffer_t;
 
+/* Packed numeric array: len int64_t or double elements in one block,
+ * 8-byte aligned unless the value borrows it from a caller buffer */
+typedef struct {
+    void *data;
+    size_t len;
+} crous_array_t;
+
 /* Value union */
 typedef union {
     int b;                      /* bool */
@@ -112,14 +132,37 @@ typedef union {
     crous_list list;            /* list/tuple */
     crous_dict dict;            /* dict */
     crous_tagged_t tagged;      /* tagged value */
+    crous_array_t array;        /* i64/f64 array */
 } crous_value_data_t;
 
-/* Main value structure */
+/* Main value structure
+ *
+ * Nodes from the crous_value_new_* constructors are allocated at the size
+ * of the union member their type uses (CROUS_VALUE_NODE_SIZE()), not at
+ * sizeof(crous_value): an int node is 16 bytes, a dict node the full 48.
+ * Read them through pointers; never copy one by value or change its type,
+ * except between list and tuple.
+ */
 struct crous_value {
     crous_type_t type;
+    uint8_t flags;              /* CROUS_VALUE_FLAG_* */
     crous_value_data_t data;
 };
 
+/* Value flags */
+#define CROUS_VALUE_FLAG_ARENA 0x01   /* Node and payload live in a crous_arena */
+#define CROUS_VALUE_FLAG_BORROWED 0x02 /* String/bytes/array data or dict keys point into a caller buffer */
+#define CROUS_VALUE_FLAG_INLINE 0x04  /* String/bytes data follows the node in its own allocation */
+
+/* Bytes of a node of type t, without inline string data */
+#define CROUS_VALUE_HEADER_SIZE offsetof(crous_value, data)
+#define CROUS_VALUE_NODE_SIZE(t) (CROUS_VALUE_HEADER_SIZE + \
+    ((t) == CROUS_TYPE_DICT ? sizeof(crous_dict) : \
+     (t) == CROUS_TYPE_LIST || (t) == CROUS_TYPE_TUPLE ? sizeof(crous_list) : \
+     (t) == CROUS_TYPE_STRING || (t) == CROUS_TYPE_BYTES ? sizeof(crous_buffer_t) : \
+     (t) == CROUS_TYPE_I64_ARRAY || (t) == CROUS_TYPE_F64_ARRAY ? sizeof(crous_array_t) : \
+     (t) == CROUS_TYPE_TAGGED ? sizeof(crous_tagged_t) : sizeof(int64_t)))
+
 /* ============================================================================
    CONSTANTS
    ============================================================================ */
@@ -129,6 +172,10 @@ struct crous_value {
 #define CROUS_MAX_BYTES_SIZE (1UL << 26)    /* 64 MB */
 #define CROUS_MAX_LIST_SIZE (1UL << 26)     /* 64 MB */
 #define CROUS_MAX_DICT_SIZE (1UL << 26)     /* 64 MB */
+#define CROUS_MAX_ARRAY_LEN (1UL << 26)     /* Elements of a packed array */
+#define CROUS_DICT_INDEX_THRESHOLD 16       /* Entries before a dict gets a hash index */
+#define CROUS_INLINE_STRING_MAX 15          /* Longest string or bytes copied into its node's allocation */
+#define CROUS_STREAM_CHUNK_SIZE 65536       /* Block size for chunked stream reads and writes */
 
 #define CROUS_MAGIC_0 0x43  /* 'C' */
 #define CROUS_MAGIC_1 0x52  /* 'R' */
@@ -2,6 +2,7 @@
 #define CROUS_VALUE_H
 
 #include "crous_types.h"
+#include "crous_arena.h"
 
 /* ============================================================================
    VALUE CONSTRUCTORS
@@ -18,6 +19,72 @@ crous_value* crous_value_new_tuple(size_t capacity);
 crous_value* crous_value_new_dict(size_t capacity);
 crous_value* crous_value_new_tagged(uint32_t tag, crous_value *inner);
 
+/**
+ * Packed numeric arrays: len elements copied into one 8-byte aligned
+ * block. Returns NULL if len * 8 overflows or allocation fails.
+ */
+crous_value* crous_value_new_i64_array(const int64_t *data, size_t len);
+crous_value* crous_value_new_f64_array(const double *data, size_t len);
+
+/**
+ * Heap string/bytes values that take ownership of a malloc'd buffer
+ * instead of copying it. data may be NULL only when len is 0. On failure
+ * the caller keeps ownership of data.
+ */
+crous_value* crous_value_new_string_take(uint8_t *data, size_t len);
+crous_value* crous_value_new_bytes_take(uint8_t *data, size_t len);
+crous_value* crous_value_new_i64_array_take(int64_t *data, size_t len);
+crous_value* crous_value_new_f64_array_take(double *data, size_t len);
+
+/* ============================================================================
+   ARENA CONSTRUCTORS
+   ============================================================================ */
+
+/**
+ * Arena variants of the constructors above. The node, its payload and any
+ * container backing array are carved out of the arena and the value is
+ * flagged CROUS_VALUE_FLAG_ARENA, so crous_value_free_tree() ignores it and
+ * the whole tree is released by crous_arena_reset()/crous_arena_free().
+ *
+ * Arena containers are sized once at creation and cannot grow: appending
+ * past capacity returns CROUS_ERR_OVERFLOW. They should only hold values
+ * from the same arena. Passing a NULL arena gives the heap constructor.
+ * Dicts of CROUS_DICT_INDEX_THRESHOLD slots or more also reserve their
+ * hash index in the arena and fill it on append, so lookups stay O(1)
+ * like on heap dicts.
+ */
+crous_value* crous_value_new_null_arena(crous_arena *arena);
+crous_value* crous_value_new_bool_arena(crous_arena *arena, int b);
+crous_value* crous_value_new_int_arena(crous_arena *arena, int64_t v);
+crous_value* crous_value_new_float_arena(crous_arena *arena, double d);
+crous_value* crous_value_new_string_arena(crous_arena *arena, const char *data, size_t len);
+crous_value* crous_value_new_bytes_arena(crous_arena *arena, const uint8_t *data, size_t len);
+crous_value* crous_value_new_list_arena(crous_arena *arena, size_t capacity);
+crous_value* crous_value_new_tuple_arena(crous_arena *arena, size_t capacity);
+crous_value* crous_value_new_dict_arena(crous_arena *arena, size_t capacity);
+crous_value* crous_value_new_tagged_arena(crous_arena *arena, uint32_t tag, crous_value *inner);
+crous_value* crous_value_new_i64_array_arena(crous_arena *arena, const int64_t *data, size_t len);
+crous_value* crous_value_new_f64_array_arena(crous_arena *arena, const double *data, size_t len);
+
+/* ============================================================================
+   BORROWED CONSTRUCTORS
+   ============================================================================ */
+
+/**
+ * String/bytes values whose payload points at data instead of a copy.
+ * The value is flagged CROUS_VALUE_FLAG_BORROWED and never frees data;
+ * the caller must keep data alive and unchanged for the value's lifetime.
+ * arena may be NULL for a heap node.
+ */
+crous_value* crous_value_new_string_borrowed(crous_arena *arena, const char *data, size_t len);
+crous_value* crous_value_new_bytes_borrowed(crous_arena *arena, const uint8_t *data, size_t len);
+
+/**
+ * Borrowed packed arrays of len elements. data must be 8-byte aligned.
+ */
+crous_value* crous_value_new_i64_array_borrowed(crous_arena *arena, const void *data, size_t len);
+crous_value* crous_value_new_f64_array_borrowed(crous_arena *arena, const void *data, size_t len);
+
 /* ============================================================================
    VALUE GETTERS
    ============================================================================ */
@@ -30,6 +97,8 @@ const char* crous_value_get_string(const crous_value *v, size_t *out_len);
 const uint8_t* crous_value_get_bytes(const crous_value *v, size_t *out_len);
 uint32_t crous_value_get_tag(const crous_value *v);
 const crous_value* crous_value_get_tagged_inner(const crous_value *v);
+const int64_t* crous_value_get_i64_array(const crous_value *v, size_t *out_len);
+const double* crous_value_get_f64_array(const crous_value *v, size_t *out_len);
 
 /* ============================================================================
    LIST/TUPLE OPERATIONS
@@ -45,15 +114,99 @@ crous_err_t crous_value_list_append(crous_value *v, crous_value *item);
    ============================================================================ */
 
 size_t crous_value_dict_size(const crous_value *v);
+
+/**
+ * Lookups only read the dict (its hash index is kept up to date by the
+ * setters), so any number of threads may look up the same dict at once
+ * as long as none of them modifies it.
+ */
 crous_value* crous_value_dict_get(const crous_value *v, const char *key);
 crous_err_t crous_value_dict_set(crous_value *v, const char *key, crous_value *value);
 crous_err_t crous_value_dict_set_binary(crous_value *v, const char *key, size_t key_len, crous_value *value);
+crous_value* crous_value_dict_get_binary(const crous_value *v, const char *key, size_t key_len);
+
+/**
+ * Append a key/value pair without checking for an existing key.
+ * Intended for decoders reading input whose keys are already known to be
+ * unique. If the input does repeat a key, both entries are kept and
+ * lookups return the first one.
+ */
+crous_err_t crous_value_dict_append_unique(crous_value *v, const char *key, size_t key_len, crous_value *value);
+
+/**
+ * Same as crous_value_dict_append_unique(), but the key copy is taken from
+ * arena. Use this to fill dicts created with crous_value_new_dict_arena().
+ */
+crous_err_t crous_value_dict_append_arena(crous_arena *arena, crous_value *v, const char *key, size_t key_len, crous_value *value);
+
+/**
+ * Unique append that stores key as-is instead of copying it. The dict is
+ * flagged CROUS_VALUE_FLAG_BORROWED; all of its keys must then be borrowed
+ * and outlive it. Heap dicts take private copies of their keys the first
+ * time a key is added through any other setter.
+ */
+crous_err_t crous_value_dict_append_borrowed(crous_arena *arena, crous_value *v, const char *key, size_t key_len, crous_value *value);
 const crous_dict_entry* crous_value_dict_get_entry(const crous_value *v, size_t index);
 
+/* ============================================================================
+   CONTENT HASHING AND COPYING
+   ============================================================================ */
+
+/**
+ * 64-bit hash of a tree's content. Types are kept apart (a list never
+ * hashes like a tuple, nor 1 like 1.0), floats hash by bit pattern, and
+ * dicts hash their entries in order. Storage doesn't matter: arena, inline
+ * and borrowed values hash like their heap copies, on every platform.
+ * A NULL child hashes like a null value.
+ *
+ * Returns CROUS_ERR_OOM only when a tree nests too deep for the walk's
+ * stack to grow.
+ */
+crous_err_t crous_value_hash(const crous_value *v, uint64_t *out_hash);
+
+/**
+ * Called for every node of a tree, children before their parent, with the
+ * node's crous_value_hash() and its height (1 for a scalar or an empty
+ * container). A non-OK return stops the walk and is passed back.
+ */
+typedef crous_err_t (*crous_value_hash_visit_fn)(void *user, const crous_value *node,
+                                                  uint64_t hash, int height);
+
+/**
+ * Hash v like crous_value_hash(), reporting each subtree to visit on the
+ * way. One pass gives the hash of every subtree, so callers can look for
+ * repeated content without hashing any node twice.
+ */
+crous_err_t crous_value_hash_subtrees(const crous_value *v, crous_value_hash_visit_fn visit,
+                                      void *user, uint64_t *out_hash);
+
+/**
+ * Compare two trees by content, under the rules of crous_value_hash():
+ * values that compare equal hash alike. Returns 1 if equal, 0 if not, and
+ * -1 when out of memory.
+ */
+int crous_value_equal(const crous_value *a, const crous_value *b);
+
+/**
+ * Deep copy of v that shares nothing with it: borrowed data and keys are
+ * copied too. Returns NULL when out of memory, with nothing leaked.
+ */
+crous_value* crous_value_clone(const crous_value *v);
+
+/**
+ * crous_value_clone() into arena, sized exactly; NULL arena clones to the
+ * heap
+ */
+crous_value* crous_value_clone_arena(crous_arena *arena, const crous_value *v);
+
 /* ============================================================================
    MEMORY MANAGEMENT
    ============================================================================ */
 
+/**
+ * Free a heap-allocated value tree. Arena values are left alone. Walks
+ * without recursion or allocation, so trees of any depth are safe.
+ */
 void crous_value_free_tree(crous_value *v);
 
 #endif /* CROUS_VALUE_H */
@@ -11,6 +11,9 @@
  * Version History:
  *   Wire v1: Initial FLUX binary format
  *   Wire v2: Added tagged values, tuples, set/frozenset support
+ *   Wire v3: Added dict key back-references (opt-in, CROUS_FEATURE_KEY_TABLE)
+ *   Wire v4: Added columnar tables for lists of records (opt-in, CROUS_FEATURE_COLUMNAR)
+ *   Wire v5: Added shared-value back-references (opt-in, CROUS_FEATURE_VALUE_REFS)
  * 
  * Library Version follows SemVer:
  *   MAJOR: Breaking API changes
@@ -23,6 +26,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "crous_types.h"
 
 /* ============================================================================
    LIBRARY VERSION (SemVer)
@@ -67,11 +71,14 @@
 #define CROUS_WIRE_VERSION_MIN_READ 1
 
 /* Maximum wire version this library can read */
-#define CROUS_WIRE_VERSION_MAX_READ 2
+#define CROUS_WIRE_VERSION_MAX_READ 5
 
 /* Wire version history */
 #define CROUS_WIRE_V1 1  /* Initial format: basic types */
 #define CROUS_WIRE_V2 2  /* Added: tagged values, tuples, set/frozenset */
+#define CROUS_WIRE_V3 3  /* Added: dict key back-references */
+#define CROUS_WIRE_V4 4  /* Added: columnar tables */
+#define CROUS_WIRE_V5 5  /* Added: shared-value back-references */
 
 /* ============================================================================
    FEATURE FLAGS
@@ -96,7 +103,7 @@ typedef enum {
     /* Encoding features */
     CROUS_FEATURE_COMPRESSION   = 0x0010,  /* LZ4/ZSTD compression */
     CROUS_FEATURE_STREAMING     = 0x0020,  /* Streaming mode */
-    CROUS_FEATURE_SCHEMA        = 0x0040,  /* Schema validation */
+    CROUS_FEATURE_SCHEMA        = 0x0040,  /* Schema-compiled positional layout (id in the extended header) */
     CROUS_FEATURE_ENCRYPTION    = 0x0080,  /* Encrypted payload */
     
     /* Extended types */
@@ -110,6 +117,14 @@ typedef enum {
     CROUS_FEATURE_METADATA      = 0x2000,  /* Header metadata */
     CROUS_FEATURE_CHECKSUMS     = 0x4000,  /* Integrity checksums */
     
+    /* Layout features, signalled by wire version rather than header flags
+       (0x8000 marks required header features) */
+    CROUS_FEATURE_KEY_TABLE     = 0x10000, /* Dict key back-references (wire v3) */
+    CROUS_FEATURE_COLUMNAR      = 0x20000, /* Columnar tables (wire v4) */
+    CROUS_FEATURE_PACKED_ARRAYS = 0x40000, /* Packed i64/f64 arrays (type tags, any wire version) */
+    CROUS_FEATURE_DICTIONARY    = 0x80000, /* Shared dictionaries (named in compressed envelopes) */
+    CROUS_FEATURE_VALUE_REFS    = 0x100000, /* Shared-value back-references (wire v5) */
+    
     /* All features for v2 */
     CROUS_FEATURE_V2_ALL = (CROUS_FEATURE_TAGGED | CROUS_FEATURE_TUPLE | 
                             CROUS_FEATURE_SET | CROUS_FEATURE_FROZENSET),
@@ -119,7 +134,15 @@ typedef enum {
 #define CROUS_FEATURES_SUPPORTED (CROUS_FEATURE_V2_ALL | \
                                    CROUS_FEATURE_DATETIME | \
                                    CROUS_FEATURE_DECIMAL | \
-                                   CROUS_FEATURE_UUID)
+                                   CROUS_FEATURE_UUID | \
+                                   CROUS_FEATURE_COMPRESSION | \
+                                   CROUS_FEATURE_CHECKSUMS | \
+                                   CROUS_FEATURE_KEY_TABLE | \
+                                   CROUS_FEATURE_COLUMNAR | \
+                                   CROUS_FEATURE_PACKED_ARRAYS | \
+                                   CROUS_FEATURE_DICTIONARY | \
+                                   CROUS_FEATURE_VALUE_REFS | \
+                                   CROUS_FEATURE_SCHEMA)
 
 /* ============================================================================
    VERSION INFO STRUCTURE
@@ -282,8 +305,29 @@ int crous_register_migration(
     uint8_t to_version,
     crous_migration_fn fn);
 
+/**
+ * Register a migration whose only change is the version byte. Paths made
+ * of these hops migrate without touching the body: crous_migrate_in_place()
+ * rewrites the header byte and the stream migrators copy the rest through.
+ */
+int crous_register_header_migration(
+    uint8_t from_version,
+    uint8_t to_version);
+
+/**
+ * Register the built-in migrations (v1 -> v2, header only). Safe to call
+ * more than once.
+ */
+void crous_init_migrations(void);
+
 /**
  * Migrate data from one wire version to another.
+ *
+ * The path is the direct migration if one is registered, otherwise one
+ * hop per version upwards. Each hop frees the buffer the previous one
+ * returned, so at most two copies are alive at once, and a run of
+ * header-only hops costs one copy in total. CROUS_ERR_INTERNAL if there
+ * is no path.
  */
 int crous_migrate(
     const uint8_t *data,
@@ -292,4 +336,28 @@ int crous_migrate(
     uint8_t **out_data,
     size_t *out_size);
 
+/**
+ * Rewrite the version byte of data in place when every hop to
+ * target_version is header-only. CROUS_ERR_NOT_FOUND if some hop needs to
+ * rewrite the body (use crous_migrate()), CROUS_ERR_INTERNAL if there is
+ * no path; data is left untouched in both cases.
+ */
+int crous_migrate_in_place(
+    uint8_t *data,
+    size_t size,
+    uint8_t target_version);
+
+/**
+ * Migrate the single document read from in, writing it to out. A
+ * header-only path streams the document through a fixed stack buffer and
+ * allocates nothing; other paths read the whole document and run
+ * crous_migrate() on it. Record-framed logs are migrated record by record
+ * with crous_migrate_log() (crous_frame.h). CROUS_ERR_STREAM if out
+ * accepts fewer bytes than it is given.
+ */
+int crous_migrate_stream(
+    crous_input_stream *in,
+    crous_output_stream *out,
+    uint8_t target_version);
+
 #endif /* CROUS_VERSION_H */
@@ -0,0 +1,101 @@
+#ifndef CROUS_VISITOR_H
+#define CROUS_VISITOR_H
+
+#include "crous_types.h"
+
+/* ============================================================================
+   EVENT VISITORS
+   ============================================================================ */
+
+/**
+ * Callbacks a reader drives as it walks a document, in document order,
+ * without building a crous_value tree. Every format reports the same
+ * events:
+ *
+ *   scalar    null, bool, int, float, string or bytes
+ *   tag       the next value (scalar or container) is wrapped in a tag
+ *   begin     a list, tuple or dict opens
+ *   key       the key of the next dict value
+ *   end       the innermost open container closes
+ *
+ * begin gets the element count when the format stores it up front, or
+ * CROUS_VISIT_COUNT_UNKNOWN; end always gets the count. Packed arrays and
+ * FLUX tables are reported as the lists they read as. Scalar payloads and
+ * keys point into the input or reader scratch space and are only valid
+ * during the call.
+ *
+ * A NULL callback ignores its event. A callback returning anything but
+ * CROUS_OK stops the walk, and the driver returns that code.
+ *
+ * Drivers: flux_visit_binary(), flux_parse_visit(), crout_visit() and
+ * crous_visit_value() for trees.
+ */
+#define CROUS_VISIT_COUNT_UNKNOWN ((size_t)-1)
+
+typedef struct {
+    crous_err_t (*scalar)(void *ctx, const crous_value *value);
+    crous_err_t (*tag)(void *ctx, uint32_t tag);
+    crous_err_t (*begin)(void *ctx, crous_type_t type, size_t count);
+    crous_err_t (*key)(void *ctx, const char *key, size_t key_len);
+    crous_err_t (*end)(void *ctx, crous_type_t type, size_t count);
+} crous_visitor;
+
+/* Deliver one event, skipping NULL callbacks (for drivers) */
+static inline crous_err_t crous_visit_scalar(const crous_visitor *vis, void *ctx, const crous_value *value) {
+    return vis->scalar ? vis->scalar(ctx, value) : CROUS_OK;
+}
+static inline crous_err_t crous_visit_tag(const crous_visitor *vis, void *ctx, uint32_t tag) {
+    return vis->tag ? vis->tag(ctx, tag) : CROUS_OK;
+}
+static inline crous_err_t crous_visit_begin(const crous_visitor *vis, void *ctx, crous_type_t type, size_t count) {
+    return vis->begin ? vis->begin(ctx, type, count) : CROUS_OK;
+}
+static inline crous_err_t crous_visit_key(const crous_visitor *vis, void *ctx, const char *key, size_t key_len) {
+    return vis->key ? vis->key(ctx, key, key_len) : CROUS_OK;
+}
+static inline crous_err_t crous_visit_end(const crous_visitor *vis, void *ctx, crous_type_t type, size_t count) {
+    return vis->end ? vis->end(ctx, type, count) : CROUS_OK;
+}
+
+/**
+ * Report a value tree to visitor, packed arrays as lists
+ */
+crous_err_t crous_visit_value(
+    const crous_value *value,
+    const crous_visitor *visitor,
+    void *ctx);
+
+/* ============================================================================
+   TREE BUILDER
+   ============================================================================ */
+
+/**
+ * A visitor that builds the tree a driver reports, copying payloads and
+ * keys. Pass crous_builder_visitor() and the builder as the context to
+ * any driver, then take the root with crous_builder_finish(). Duplicate
+ * dict keys keep the last value, as the tree decoders do.
+ */
+typedef struct crous_builder crous_builder;
+
+crous_err_t crous_builder_new(crous_builder **out_builder);
+
+/**
+ * Callbacks for a builder context
+ */
+const crous_visitor* crous_builder_visitor(void);
+
+/**
+ * Hand over the finished tree (caller frees it with
+ * crous_value_free_tree()). CROUS_ERR_TRUNCATED if no value or an
+ * unclosed container was reported. The builder is freed either way.
+ */
+crous_err_t crous_builder_finish(
+    crous_builder *builder,
+    crous_value **out_value);
+
+/**
+ * Free a builder and whatever it has built so far
+ */
+void crous_builder_free(crous_builder *builder);
+
+#endif /* CROUS_VISITOR_H */
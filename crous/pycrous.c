@@ -1,10 +1,15 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <datetime.h>
 #include <pythread.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <crous.h>
+#include <crous_flux.h>
+#include <crous_varint.h>
+#include <crous_stack.h>
+#include <crous_stdtypes.h>
 
 /* ============================================================================
    PYTHON MODULE ERRORS
@@ -33,6 +38,9 @@ static uint32_t next_custom_tag = 100;
 /* Dictionary mapping Python types to their assigned tags */
 static PyObject *type_to_tag = NULL;
 
+/* Dictionary mapping schema ids to their registered Schema objects */
+static PyObject *registered_schemas = NULL;
+
 /* Acquire/release helpers for registry lock */
 static inline void registry_lock_acquire(void) {
     if (registry_lock) PyThread_acquire_lock(registry_lock, WAIT_LOCK);
@@ -41,94 +49,188 @@ static inline void registry_lock_release(void) {
     if (registry_lock) PyThread_release_lock(registry_lock);
 }
 
+/* Bumped under the lock whenever a registry dict is replaced */
+static uint64_t registry_generation = 0;
+
+/*
+ * The registry dicts are copy-on-write: registration builds a modified copy
+ * and swaps it in under the lock, so a dict is never mutated once published.
+ * An encode/decode call takes the lock once to snapshot the current dicts
+ * and then reads them lock-free, so concurrent calls don't serialize on it.
+ *
+ * Since the dicts can't change under a snapshot, it also caches what each
+ * type resolved to (serializer or none, and tag), so a list of a million
+ * instances walks the MRO once. Sessions keep their snapshot across calls
+ * and refresh it only when the generation has moved.
+ */
+#define REGISTRY_CACHE_SIZE 32      /* Power of two */
+
+typedef struct {
+    PyTypeObject *type;         /* Strong reference; NULL when empty */
+    PyObject *serializer;       /* Borrowed from serializers; NULL for none */
+    uint32_t tag;
+} registry_resolved;
+
+typedef struct {
+    PyObject *serializers;      /* type -> serializer */
+    PyObject *type_to_tag;      /* type -> tag */
+    PyObject *decoders;         /* tag -> decoder */
+    uint64_t generation;
+    registry_resolved resolved[REGISTRY_CACHE_SIZE];
+} registry_snapshot;
+
+static void registry_snapshot_release(registry_snapshot *snap) {
+    Py_CLEAR(snap->serializers);
+    Py_CLEAR(snap->type_to_tag);
+    Py_CLEAR(snap->decoders);
+    for (size_t i = 0; i < REGISTRY_CACHE_SIZE; i++) {
+        Py_CLEAR(snap->resolved[i].type);
+        snap->resolved[i].serializer = NULL;
+    }
+}
+
+/* Point snap at the current registry, keeping its cache if nothing was
+ * registered since it was taken. snap must be zeroed or previously taken. */
+static void registry_snapshot_take(registry_snapshot *snap) {
+    registry_lock_acquire();
+    if (snap->serializers && snap->generation == registry_generation) {
+        registry_lock_release();
+        return;
+    }
+    PyObject *serializers = custom_serializers;
+    PyObject *tags = type_to_tag;
+    PyObject *decoders = custom_decoders;
+    Py_XINCREF(serializers);
+    Py_XINCREF(tags);
+    Py_XINCREF(decoders);
+    uint64_t generation = registry_generation;
+    registry_lock_release();
+    
+    registry_snapshot_release(snap);
+    snap->serializers = serializers;
+    snap->type_to_tag = tags;
+    snap->decoders = decoders;
+    snap->generation = generation;
+}
+
+/* Modified copy of a registry dict (a new empty dict if there is none) */
+static PyObject* registry_copy(PyObject *dict) {
+    return dict ? PyDict_Copy(dict) : PyDict_New();
+}
+
 /* ============================================================================
    FORWARD DECLARATIONS
    ============================================================================ */
 
-static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default_func, crous_err_t *err);
+/* Nesting dumps() allows when no max_depth is given: far beyond any real
+ * document, and a reference cycle fails in milliseconds rather than
+ * running out of memory */
+#define PY_ENCODE_MAX_DEPTH 65536
+
+static crous_value* pyobj_to_crous_tree(PyObject *obj, PyObject *default_func,
+                                        registry_snapshot *snap, int depth, int max_depth,
+                                        crous_err_t *err);
 static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object_hook);
 
 /* ============================================================================
    CUSTOM SERIALIZER IMPLEMENTATION
    ============================================================================ */
 
-/**
- * Try to serialize an object using custom serializers.
- * Returns: new crous_value* on success, NULL if no custom serializer or on error.
- * Sets *handled = 1 if a custom serializer was found (even if it failed).
+/*
+ * What snap maps obj_type to: the serializer registered for it or its
+ * nearest base in MRO order (NULL for none), and the tag registered for
+ * the type itself (100 if it has none). Resolved once per type and cached.
  */
-static crous_value* try_custom_serializer(PyObject *obj, PyObject *default_func, 
-                                          crous_err_t *err, int *handled) {
-    *handled = 0;
-    
-    registry_lock_acquire();
-    
-    if (!custom_serializers || PyDict_Size(custom_serializers) == 0) {
-        /* No custom serializers registered, try default_func */
-        if (!default_func || default_func == Py_None) {
-            registry_lock_release();
-            return NULL;
-        }
-    }
+static const registry_resolved* registry_resolve(registry_snapshot *snap, PyTypeObject *obj_type) {
+    registry_resolved *r = &snap->resolved[((uintptr_t)obj_type >> 4) & (REGISTRY_CACHE_SIZE - 1)];
+    if (r->type == obj_type) return r;
     
-    /* Get the type of the object */
-    PyTypeObject *obj_type = Py_TYPE(obj);
     PyObject *serializer = NULL;
-    
-    if (custom_serializers) {
-        /* Look up serializer for this type */
-        serializer = PyDict_GetItem(custom_serializers, (PyObject *)obj_type);
+    /* Borrowed lookups cannot raise for type keys */
+    if (snap->serializers) {
+        serializer = PyDict_GetItem(snap->serializers, (PyObject *)obj_type);
         
         if (!serializer) {
             /* Try checking base classes using tp_mro */
             PyObject *mro = obj_type->tp_mro;
             if (mro && PyTuple_Check(mro)) {
-                Py_ssize_t mro_len = PyTuple_Size(mro);
-                for (Py_ssize_t i = 0; i < mro_len; i++) {
-                    PyObject *base = PyTuple_GetItem(mro, i);
-                    serializer = PyDict_GetItem(custom_serializers, base);
-                    if (serializer) break;
-                }
+                Py_ssize_t mro_len = PyTuple_GET_SIZE(mro);
+                for (Py_ssize_t i = 0; i < mro_len && !serializer; i++)
+                    serializer = PyDict_GetItem(snap->serializers, PyTuple_GET_ITEM(mro, i));
             }
         }
     }
     
-    if (!serializer && default_func && default_func != Py_None) {
-        /* Use the default function as fallback */
-        serializer = default_func;
+    uint32_t tag = 100;
+    if (snap->type_to_tag) {
+        PyObject *tag_obj = PyDict_GetItem(snap->type_to_tag, (PyObject *)obj_type);
+        if (tag_obj && PyLong_Check(tag_obj)) {
+            tag = (uint32_t)PyLong_AsUnsignedLong(tag_obj);
+        }
     }
     
-    if (!serializer) {
-        registry_lock_release();
+    /* The entry owns its type, so the address can't be reused by another
+     * type while the snapshot lives */
+    Py_INCREF(obj_type);
+    Py_XDECREF(r->type);
+    r->type = obj_type;
+    r->serializer = serializer;
+    r->tag = tag;
+    return r;
+}
+
+/**
+ * Find and call the custom serializer (or default_func) for obj, looking
+ * types up in snap.
+ * Returns: new reference to the serializer's result, NULL if there is no
+ * serializer or the call failed. Sets *handled = 1 if a serializer was
+ * found (even if it failed) and *tag to the registered tag for the type.
+ */
+static PyObject* call_custom_serializer(PyObject *obj, PyObject *default_func,
+                                        registry_snapshot *snap,
+                                        uint32_t *tag, int *handled) {
+    *handled = 0;
+    
+    PyObject *serializers = snap->serializers;
+    if (serializers && PyDict_GET_SIZE(serializers) == 0) serializers = NULL;
+    if (!serializers && (!default_func || default_func == Py_None)) {
+        /* No custom serializers registered and no default_func */
         return NULL;
     }
     
-    /* Incref serializer before releasing lock so it stays alive */
-    Py_INCREF(serializer);
-    
-    /* Get the tag for this type while we hold the lock */
-    uint32_t tag = 100;  /* Default custom tag */
-    if (type_to_tag) {
-        PyObject *tag_obj = PyDict_GetItem(type_to_tag, (PyObject *)obj_type);
-        if (tag_obj && PyLong_Check(tag_obj)) {
-            tag = (uint32_t)PyLong_AsUnsignedLong(tag_obj);
-        }
+    const registry_resolved *r = registry_resolve(snap, Py_TYPE(obj));
+    PyObject *serializer = r->serializer;
+    if (!serializer && default_func && default_func != Py_None) {
+        /* Use the default function as fallback */
+        serializer = default_func;
     }
     
-    registry_lock_release();
+    if (!serializer) return NULL;
     
+    *tag = r->tag;
     *handled = 1;
     
-    /* Call the serializer function (outside lock to avoid deadlock) */
-    PyObject *result = PyObject_CallFunctionObjArgs(serializer, obj, NULL);
-    Py_DECREF(serializer);
+    /* snap keeps the serializer alive even if it is unregistered meanwhile */
+    CROUS_STAT_ADD(callbacks, 1);
+    return PyObject_CallFunctionObjArgs(serializer, obj, NULL);
+}
+
+/**
+ * Try to serialize an object using custom serializers.
+ * Returns: new crous_value* on success, NULL if no custom serializer or on error.
+ * Sets *handled = 1 if a custom serializer was found (even if it failed).
+ */
+static crous_value* try_custom_serializer(PyObject *obj, PyObject *default_func, registry_snapshot *snap,
+                                          int depth, int max_depth, crous_err_t *err, int *handled) {
+    uint32_t tag = 0;
+    PyObject *result = call_custom_serializer(obj, default_func, snap, &tag, handled);
     if (!result) {
-        *err = CROUS_ERR_ENCODE;
+        if (*handled) *err = CROUS_ERR_ENCODE;
         return NULL;
     }
     
     /* Recursively convert the result */
-    crous_value *inner = pyobj_to_crous_with_default(result, NULL, err);
+    crous_value *inner = pyobj_to_crous_tree(result, NULL, snap, depth + 1, max_depth, err);
     Py_DECREF(result);
     
     if (!inner) {
@@ -146,12 +248,653 @@ static crous_value* try_custom_serializer(PyObject *obj, PyObject *default_func,
     return tagged;
 }
 
+/* ============================================================================
+   PACKED ARRAYS (BUFFER PROTOCOL)
+   ============================================================================ */
+
+/*
+ * One-dimensional C-contiguous buffers (array.array, memoryview, numpy)
+ * encode without per-element objects: signed and narrow unsigned integers
+ * as an i64 array, float32/float64 as an f64 array, unsigned bytes as
+ * plain bytes. Anything else (uint64, big-endian, multi-dimensional) is
+ * left to the custom serializers. Packed arrays decode to array.array.
+ */
+typedef enum {
+    PY_BUF_NONE,
+    PY_BUF_BYTES,
+    PY_BUF_I64,
+    PY_BUF_F64,
+} py_buf_kind;
+
+static py_buf_kind py_buffer_kind(const Py_buffer *view, int *is_signed) {
+    const char *fmt = view->format ? view->format : "B";
+    if (view->ndim != 1) return PY_BUF_NONE;
+    if (*fmt == '@' || *fmt == '=' || *fmt == '<') fmt++;
+    if (fmt[0] == '\0' || fmt[1] != '\0') return PY_BUF_NONE;
+    
+    Py_ssize_t size = view->itemsize;
+    *is_signed = 1;
+    switch (fmt[0]) {
+        case 'B':
+        case 'c':
+            return size == 1 ? PY_BUF_BYTES : PY_BUF_NONE;
+        case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+            return (size == 1 || size == 2 || size == 4 || size == 8) ? PY_BUF_I64 : PY_BUF_NONE;
+        case 'H': case 'I': case 'L':
+            *is_signed = 0;
+            return (size == 2 || size == 4) ? PY_BUF_I64 : PY_BUF_NONE;
+        case 'f':
+            return size == 4 ? PY_BUF_F64 : PY_BUF_NONE;
+        case 'd':
+            return size == 8 ? PY_BUF_F64 : PY_BUF_NONE;
+        default:
+            return PY_BUF_NONE;
+    }
+}
+
+/* Copy n elements starting at element first into out as int64/double */
+static void py_buffer_widen(const Py_buffer *view, py_buf_kind kind, int is_signed,
+                            size_t first, size_t n, void *out) {
+    const uint8_t *src = (const uint8_t *)view->buf + first * (size_t)view->itemsize;
+    size_t size = (size_t)view->itemsize;
+    
+    if (size == 8) {
+        memcpy(out, src, n * 8);
+        return;
+    }
+    
+    for (size_t i = 0; i < n; i++, src += size) {
+        if (kind == PY_BUF_F64) {
+            float f;
+            memcpy(&f, src, 4);
+            ((double *)out)[i] = f;
+            continue;
+        }
+        int64_t val;
+        if (size == 1) {
+            val = (int8_t)src[0];
+        } else if (size == 2) {
+            uint16_t u;
+            memcpy(&u, src, 2);
+            val = is_signed ? (int64_t)(int16_t)u : (int64_t)u;
+        } else {
+            uint32_t u;
+            memcpy(&u, src, 4);
+            val = is_signed ? (int64_t)(int32_t)u : (int64_t)u;
+        }
+        ((int64_t *)out)[i] = val;
+    }
+}
+
+/* Buffer view of obj if it maps to a packed type; PY_BUF_NONE (no view
+ * held, no error set) otherwise */
+static py_buf_kind py_buffer_open(PyObject *obj, Py_buffer *view, int *is_signed) {
+    if (!PyObject_CheckBuffer(obj)) return PY_BUF_NONE;
+    if (PyObject_GetBuffer(obj, view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) < 0) {
+        PyErr_Clear();
+        return PY_BUF_NONE;
+    }
+    py_buf_kind kind = py_buffer_kind(view, is_signed);
+    if (kind == PY_BUF_NONE) PyBuffer_Release(view);
+    return kind;
+}
+
+static PyObject *array_type = NULL;
+
+/* New array.array of typecode ('q' or 'd') holding a copy of len*8 bytes */
+static PyObject* py_array_from_bytes(char typecode, const void *data, size_t nbytes) {
+    if (!array_type) {
+        PyObject *mod = PyImport_ImportModule("array");
+        if (!mod) return NULL;
+        array_type = PyObject_GetAttrString(mod, "array");
+        Py_DECREF(mod);
+        if (!array_type) return NULL;
+    }
+    
+    PyObject *arr = PyObject_CallFunction(array_type, "C", typecode);
+    if (!arr || nbytes == 0) return arr;
+    
+    PyObject *view = PyMemoryView_FromMemory((char *)data, (Py_ssize_t)nbytes, PyBUF_READ);
+    if (!view) {
+        Py_DECREF(arr);
+        return NULL;
+    }
+    PyObject *res = PyObject_CallMethod(arr, "frombytes", "O", view);
+    Py_DECREF(view);
+    if (!res) {
+        Py_DECREF(arr);
+        return NULL;
+    }
+    Py_DECREF(res);
+    return arr;
+}
+
+/* Tree-path conversion of a buffer: packed array or bytes, else NULL with
+ * *handled = 0 */
+static crous_value* buffer_to_crous(PyObject *obj, crous_err_t *err, int *handled) {
+    Py_buffer view;
+    int is_signed;
+    py_buf_kind kind = py_buffer_open(obj, &view, &is_signed);
+    
+    *handled = kind != PY_BUF_NONE;
+    if (!*handled) return NULL;
+    
+    size_t n = (size_t)(view.len / view.itemsize);
+    crous_value *v = NULL;
+    if (kind == PY_BUF_BYTES) {
+        v = crous_value_new_bytes(view.buf, n);
+    } else {
+        void *data = malloc(n ? n * 8 : 1);
+        if (data) {
+            py_buffer_widen(&view, kind, is_signed, 0, n, data);
+            v = kind == PY_BUF_I64 ? crous_value_new_i64_array_take(data, n)
+                                   : crous_value_new_f64_array_take(data, n);
+            if (!v) free(data);
+        }
+    }
+    PyBuffer_Release(&view);
+    
+    if (!v) *err = CROUS_ERR_OOM;
+    return v;
+}
+
+/* ============================================================================
+   STANDARD LIBRARY TYPES
+   ============================================================================ */
+
+/*
+ * datetime, date, time, Decimal and UUID are encoded natively with the
+ * built-in tags of crous_stdtypes.h and decoded straight back, without a
+ * Python callback. Only the exact types are handled; subclasses, and the
+ * rare values the wire form can't hold (UTC offsets with microseconds),
+ * go to the custom serializers as before. A serializer registered for one
+ * of the types, or a decoder registered for one of the tags, still takes
+ * precedence. Aware values keep only their UTC offset: they decode with a
+ * fixed-offset timezone, and fold is dropped.
+ */
+
+#ifndef PyDateTime_DATE_GET_TZINFO
+#define PyDateTime_DATE_GET_TZINFO(o) (((PyDateTime_DateTime *)(o))->hastzinfo ? \
+    ((PyDateTime_DateTime *)(o))->tzinfo : Py_None)
+#define PyDateTime_TIME_GET_TZINFO(o) (((PyDateTime_Time *)(o))->hastzinfo ? \
+    ((PyDateTime_Time *)(o))->tzinfo : Py_None)
+#endif
+
+static PyObject *decimal_type = NULL;       /* decimal.Decimal */
+static PyObject *uuid_type = NULL;          /* uuid.UUID */
+static PyObject *uuid_safe_unknown = NULL;  /* uuid.SafeUUID.unknown */
+
+/*
+ * module.attr, cached in *slot (borrowed). With load unset a module that
+ * hasn't been imported yet gives NULL with no exception: none of its
+ * types can have instances.
+ */
+static PyObject* stdtype_get(PyObject **slot, const char *module, const char *attr, int load) {
+    if (*slot) return *slot;
+
+    PyObject *mod;
+    if (load) {
+        mod = PyImport_ImportModule(module);
+    } else {
+        PyObject *name = PyUnicode_FromString(module);
+        if (!name) return NULL;
+        mod = PyImport_GetModule(name);
+        Py_DECREF(name);
+    }
+    if (!mod) return NULL;
+
+    /* attr may be dotted */
+    PyObject *obj = mod;
+    char part[32];
+    for (const char *p = attr; obj && *p; ) {
+        size_t n = strcspn(p, ".");
+        if (n >= sizeof(part)) n = sizeof(part) - 1;
+        memcpy(part, p, n);
+        part[n] = '\0';
+        PyObject *next = PyObject_GetAttrString(obj, part);
+        Py_DECREF(obj);
+        obj = next;
+        p += n + (p[n] == '.');
+    }
+    if (!obj) return NULL;
+
+    /* Racing loaders find the same object; keep the first */
+    registry_lock_acquire();
+    if (!*slot) {
+        *slot = obj;
+        obj = NULL;
+    }
+    registry_lock_release();
+    Py_XDECREF(obj);
+    return *slot;
+}
+
+/* A native encoding: tag over a, [a, b] or a bytes payload */
+typedef struct {
+    uint32_t tag;
+    int pair;
+    int64_t a, b;
+    const uint8_t *data;        /* Payload of DECIMAL and UUID, else NULL */
+    size_t len;
+    uint8_t small[64];
+    uint8_t *heap;
+} py_stdtype;
+
+/*
+ * UTC offset of tz in seconds for a datetime or time (arg is the datetime,
+ * or None for a time). Returns 1 with *aware set, 0 if the offset has
+ * microseconds, -1 with an exception set.
+ */
+static int stdtype_utcoffset(PyObject *tz, PyObject *arg, int64_t *offset, int *aware) {
+    *aware = 0;
+    *offset = 0;
+    if (tz == Py_None) return 1;
+    if (tz == PyDateTime_TimeZone_UTC) {
+        *aware = 1;
+        return 1;
+    }
+
+    PyObject *delta = PyObject_CallMethod(tz, "utcoffset", "O", arg);
+    if (!delta) return -1;
+    if (delta == Py_None) {
+        Py_DECREF(delta);
+        return 1;
+    }
+    if (!PyDelta_Check(delta)) {
+        PyErr_SetString(PyExc_TypeError, "tzinfo.utcoffset() must return None or timedelta");
+        Py_DECREF(delta);
+        return -1;
+    }
+    int ok = PyDateTime_DELTA_GET_MICROSECONDS(delta) == 0;
+    *offset = (int64_t)PyDateTime_DELTA_GET_DAYS(delta) * 86400 + PyDateTime_DELTA_GET_SECONDS(delta);
+    *aware = 1;
+    Py_DECREF(delta);
+    return ok;
+}
+
+/* Decimal as_tuple() into the packed layout */
+static int stdtype_pack_decimal(PyObject *obj, py_stdtype *st) {
+    PyObject *t = PyObject_CallMethod(obj, "as_tuple", NULL);
+    if (!t) return -1;
+    if (!PyTuple_Check(t) || PyTuple_GET_SIZE(t) != 3 || !PyTuple_Check(PyTuple_GET_ITEM(t, 1))) {
+        Py_DECREF(t);
+        return 0;
+    }
+
+    int negative = PyObject_IsTrue(PyTuple_GET_ITEM(t, 0));
+    PyObject *digits = PyTuple_GET_ITEM(t, 1);
+    PyObject *exp = PyTuple_GET_ITEM(t, 2);
+    int special = CROUS_DECIMAL_FINITE;
+    int64_t exponent = 0;
+    if (PyUnicode_Check(exp)) {
+        if (PyUnicode_CompareWithASCIIString(exp, "F") == 0) special = CROUS_DECIMAL_INF;
+        else if (PyUnicode_CompareWithASCIIString(exp, "n") == 0) special = CROUS_DECIMAL_NAN;
+        else special = CROUS_DECIMAL_SNAN;
+    } else {
+        exponent = PyLong_AsLongLong(exp);
+    }
+    if (negative < 0 || PyErr_Occurred()) {
+        Py_DECREF(t);
+        return -1;
+    }
+
+    /* Digit values first, after the room the packed form needs */
+    size_t n = (size_t)PyTuple_GET_SIZE(digits);
+    size_t packed = crous_decimal_packed_size(n);
+    uint8_t *buf = st->small;
+    if (packed + n > sizeof(st->small)) {
+        buf = st->heap = malloc(packed + n);
+        if (!buf) {
+            Py_DECREF(t);
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    uint8_t *values = buf + packed;
+    for (size_t i = 0; i < n; i++) {
+        long d = PyLong_AsLong(PyTuple_GET_ITEM(digits, i));
+        if (d < 0 || d > 9) {
+            Py_DECREF(t);
+            if (!PyErr_Occurred()) PyErr_SetString(CrousEncodeError, "Decimal digit out of range");
+            return -1;
+        }
+        values[i] = (uint8_t)d;
+    }
+    Py_DECREF(t);
+
+    if (special == CROUS_DECIMAL_INF) n = 0;
+    st->data = buf;
+    st->len = crous_decimal_pack(negative, special, exponent, values, n, buf);
+    return 1;
+}
+
+static int stdtype_pack_uuid(PyObject *obj, py_stdtype *st) {
+    PyObject *value = PyObject_GetAttrString(obj, "int");
+    if (!value) return -1;
+    PyObject *shift = PyLong_FromLong(64);
+    PyObject *high = shift ? PyNumber_Rshift(value, shift) : NULL;
+    unsigned long long hi = high ? PyLong_AsUnsignedLongLong(high) : 0;
+    unsigned long long lo = PyLong_AsUnsignedLongLongMask(value);
+    Py_XDECREF(shift);
+    Py_XDECREF(high);
+    Py_DECREF(value);
+    if (PyErr_Occurred()) return -1;
+
+    for (int i = 0; i < 8; i++) {
+        st->small[i] = (uint8_t)(hi >> (56 - 8 * i));
+        st->small[8 + i] = (uint8_t)(lo >> (56 - 8 * i));
+    }
+    st->data = st->small;
+    st->len = 16;
+    return 1;
+}
+
+/*
+ * Fill st when obj has a native encoding and snap has no serializer for
+ * its type. Returns 1 if so, 0 if obj goes the custom serializer way, -1
+ * with an exception set. Release st with stdtype_clear().
+ */
+static int stdtype_encode(PyObject *obj, registry_snapshot *snap, py_stdtype *st) {
+    PyTypeObject *type = Py_TYPE(obj);
+    memset(st, 0, offsetof(py_stdtype, small));
+    st->heap = NULL;
+
+    if (PyDateTime_CheckExact(obj)) st->tag = CROUS_TAG_DATETIME;
+    else if (PyDate_CheckExact(obj)) st->tag = CROUS_TAG_DATE;
+    else if (PyTime_CheckExact(obj)) st->tag = CROUS_TAG_TIME;
+    else if (strcmp(type->tp_name, "decimal.Decimal") == 0 || strcmp(type->tp_name, "Decimal") == 0) {
+        PyObject *dec = stdtype_get(&decimal_type, "decimal", "Decimal", 0);
+        if (!dec) return PyErr_Occurred() ? -1 : 0;
+        if ((PyObject *)type != dec) return 0;
+        st->tag = CROUS_TAG_DECIMAL;
+    } else if (strcmp(type->tp_name, "UUID") == 0) {
+        PyObject *uu = stdtype_get(&uuid_type, "uuid", "UUID", 0);
+        if (!uu) return PyErr_Occurred() ? -1 : 0;
+        if ((PyObject *)type != uu) return 0;
+        st->tag = CROUS_TAG_UUID;
+    } else {
+        return 0;
+    }
+
+    if (snap && registry_resolve(snap, type)->serializer) return 0;
+
+    int64_t offset;
+    int aware, rc;
+    switch (st->tag) {
+        case CROUS_TAG_DATETIME: {
+            int64_t days = crous_days_from_civil(PyDateTime_GET_YEAR(obj), PyDateTime_GET_MONTH(obj),
+                                                 PyDateTime_GET_DAY(obj));
+            int64_t us = days * CROUS_US_PER_DAY +
+                ((int64_t)PyDateTime_DATE_GET_HOUR(obj) * 3600 + PyDateTime_DATE_GET_MINUTE(obj) * 60 +
+                 PyDateTime_DATE_GET_SECOND(obj)) * 1000000 + PyDateTime_DATE_GET_MICROSECOND(obj);
+            rc = stdtype_utcoffset(PyDateTime_DATE_GET_TZINFO(obj), obj, &offset, &aware);
+            if (rc <= 0) return rc;
+            st->pair = aware;
+            st->a = us - offset * 1000000;
+            st->b = offset;
+            return 1;
+        }
+        case CROUS_TAG_DATE:
+            st->a = crous_days_from_civil(PyDateTime_GET_YEAR(obj), PyDateTime_GET_MONTH(obj),
+                                          PyDateTime_GET_DAY(obj));
+            return 1;
+        case CROUS_TAG_TIME:
+            st->a = ((int64_t)PyDateTime_TIME_GET_HOUR(obj) * 3600 + PyDateTime_TIME_GET_MINUTE(obj) * 60 +
+                     PyDateTime_TIME_GET_SECOND(obj)) * 1000000 + PyDateTime_TIME_GET_MICROSECOND(obj);
+            rc = stdtype_utcoffset(PyDateTime_TIME_GET_TZINFO(obj), Py_None, &offset, &aware);
+            if (rc <= 0) return rc;
+            st->pair = aware;
+            st->b = offset;
+            return 1;
+        case CROUS_TAG_DECIMAL:
+            return stdtype_pack_decimal(obj, st);
+        default:
+            return stdtype_pack_uuid(obj, st);
+    }
+}
+
+static void stdtype_clear(py_stdtype *st) {
+    free(st->heap);
+    st->heap = NULL;
+}
+
+/* Native obj as a tree value. Sets *handled when it has one. */
+static crous_value* stdtype_to_crous(PyObject *obj, registry_snapshot *snap, crous_err_t *err, int *handled) {
+    py_stdtype st;
+    int rc = stdtype_encode(obj, snap, &st);
+    *handled = rc != 0;
+    if (rc <= 0) {
+        stdtype_clear(&st);
+        if (rc < 0) *err = CROUS_ERR_ENCODE;
+        return NULL;
+    }
+
+    crous_value *inner;
+    if (st.data) {
+        inner = crous_value_new_bytes(st.data, st.len);
+    } else if (st.pair) {
+        inner = crous_value_new_list(2);
+        crous_value *a = crous_value_new_int(st.a);
+        crous_value *b = crous_value_new_int(st.b);
+        if (!inner || !a || crous_value_list_append(inner, a) != CROUS_OK) {
+            crous_value_free_tree(a);
+            crous_value_free_tree(b);
+            crous_value_free_tree(inner);
+            inner = NULL;
+        } else if (!b || crous_value_list_append(inner, b) != CROUS_OK) {
+            crous_value_free_tree(b);
+            crous_value_free_tree(inner);
+            inner = NULL;
+        }
+    } else {
+        inner = crous_value_new_int(st.a);
+    }
+    stdtype_clear(&st);
+
+    crous_value *tagged = inner ? crous_value_new_tagged(st.tag, inner) : NULL;
+    if (!tagged) {
+        crous_value_free_tree(inner);
+        *err = CROUS_ERR_OOM;
+    }
+    return tagged;
+}
+
+static PyObject* stdtype_range_error(const char *what) {
+    PyErr_Format(CrousDecodeError, "%s out of range", what);
+    return NULL;
+}
+
+/* Fixed-offset tzinfo for offset seconds (new reference) */
+static PyObject* stdtype_timezone(int64_t offset) {
+    if (offset == 0) {
+        Py_INCREF(PyDateTime_TimeZone_UTC);
+        return PyDateTime_TimeZone_UTC;
+    }
+    PyObject *delta = PyDelta_FromDSU(0, (int)offset, 0);
+    if (!delta) return NULL;
+    PyObject *tz = PyTimeZone_FromOffset(delta);
+    Py_DECREF(delta);
+    return tz;
+}
+
+/* int or [int, int] as a / b / *pair */
+static int stdtype_ints(PyObject *inner, int64_t *a, int64_t *b, int *pair) {
+    *pair = 0;
+    if (PyLong_CheckExact(inner)) {
+        *a = PyLong_AsLongLong(inner);
+        return !PyErr_Occurred();
+    }
+    if ((PyList_CheckExact(inner) || PyTuple_CheckExact(inner)) && PySequence_Fast_GET_SIZE(inner) == 2) {
+        PyObject *x = PySequence_Fast_GET_ITEM(inner, 0);
+        PyObject *y = PySequence_Fast_GET_ITEM(inner, 1);
+        if (!PyLong_CheckExact(x) || !PyLong_CheckExact(y)) return 0;
+        *a = PyLong_AsLongLong(x);
+        *b = PyLong_AsLongLong(y);
+        *pair = 1;
+        return !PyErr_Occurred();
+    }
+    return 0;
+}
+
+static PyObject* stdtype_decode_datetime(int64_t us, PyObject *tz) {
+    if (us < CROUS_DAYS_MIN * CROUS_US_PER_DAY || us >= (CROUS_DAYS_MAX + 1) * CROUS_US_PER_DAY)
+        return stdtype_range_error("datetime");
+    int64_t tod;
+    int64_t days = crous_split_us(us, &tod);
+    int y;
+    unsigned m, d;
+    crous_civil_from_days(days, &y, &m, &d);
+    return PyDateTimeAPI->DateTime_FromDateAndTime(
+        y, (int)m, (int)d, (int)(tod / 3600000000LL), (int)(tod / 60000000 % 60),
+        (int)(tod / 1000000 % 60), (int)(tod % 1000000), tz, PyDateTimeAPI->DateTimeType);
+}
+
+static PyObject* stdtype_decode_decimal(const uint8_t *data, size_t len) {
+    int negative, special;
+    int64_t exponent;
+    const uint8_t *packed;
+    size_t n;
+    if (crous_decimal_unpack(data, len, &negative, &special, &exponent, &packed, &n) != CROUS_OK) {
+        PyErr_SetString(CrousDecodeError, "Malformed packed decimal");
+        return NULL;
+    }
+    if (!stdtype_get(&decimal_type, "decimal", "Decimal", 1)) return NULL;
+
+    PyObject *digits = PyTuple_New((Py_ssize_t)n);
+    if (!digits) return NULL;
+    for (size_t i = 0; i < n; i++)
+        PyTuple_SET_ITEM(digits, (Py_ssize_t)i, PyLong_FromLong((long)crous_decimal_digit(packed, i)));
+
+    static const char *const specials[] = { NULL, "F", "n", "N" };
+    PyObject *exp = special ? PyUnicode_FromString(specials[special]) : PyLong_FromLongLong(exponent);
+    PyObject *t = exp ? Py_BuildValue("(iNN)", negative, digits, exp) : NULL;
+    if (!t) {
+        if (!exp) Py_DECREF(digits);
+        return NULL;
+    }
+    PyObject *result = PyObject_CallFunctionObjArgs(decimal_type, t, NULL);
+    Py_DECREF(t);
+    return result;
+}
+
+/* UUID without running UUID.__init__: set its slots as pickle does */
+static PyObject* stdtype_decode_uuid(const uint8_t *data) {
+    if (!stdtype_get(&uuid_type, "uuid", "UUID", 1) ||
+        !stdtype_get(&uuid_safe_unknown, "uuid", "SafeUUID.unknown", 1))
+        return NULL;
+
+    unsigned long long hi = 0, lo = 0;
+    for (int i = 0; i < 8; i++) {
+        hi = hi << 8 | data[i];
+        lo = lo << 8 | data[8 + i];
+    }
+    PyObject *high = PyLong_FromUnsignedLongLong(hi);
+    PyObject *low = PyLong_FromUnsignedLongLong(lo);
+    PyObject *shift = PyLong_FromLong(64);
+    PyObject *shifted = high && shift ? PyNumber_Lshift(high, shift) : NULL;
+    PyObject *value = shifted && low ? PyNumber_Or(shifted, low) : NULL;
+    Py_XDECREF(high);
+    Py_XDECREF(low);
+    Py_XDECREF(shift);
+    Py_XDECREF(shifted);
+    if (!value) return NULL;
+
+    PyObject *args = PyTuple_New(0);
+    PyObject *uuid = args ? PyBaseObject_Type.tp_new((PyTypeObject *)uuid_type, args, NULL) : NULL;
+    Py_XDECREF(args);
+    PyObject *int_name = PyUnicode_FromString("int");
+    PyObject *safe_name = PyUnicode_FromString("is_safe");
+    if (!uuid || !int_name || !safe_name ||
+        PyObject_GenericSetAttr(uuid, int_name, value) < 0 ||
+        PyObject_GenericSetAttr(uuid, safe_name, uuid_safe_unknown) < 0) {
+        Py_CLEAR(uuid);
+    }
+    Py_XDECREF(int_name);
+    Py_XDECREF(safe_name);
+    Py_DECREF(value);
+    return uuid;
+}
+
+/*
+ * Decoded value for a built-in standard type tag. Steals inner; returns
+ * it unchanged when it doesn't have the native shape (a text document's
+ * @datetime "2024-01-01", say), NULL with an exception when it does but
+ * is out of range.
+ */
+static PyObject* stdtype_decode(uint32_t tag, PyObject *inner) {
+    int64_t a = 0, b = 0;
+    int pair;
+    PyObject *result;
+
+    switch (tag) {
+        case CROUS_TAG_DATETIME:
+        case CROUS_TAG_DATE:
+        case CROUS_TAG_TIME:
+            if (!stdtype_ints(inner, &a, &b, &pair)) {
+                if (!PyErr_Occurred()) return inner;
+                Py_DECREF(inner);
+                return stdtype_range_error("datetime");
+            }
+            if (pair && tag == CROUS_TAG_DATE) return inner;
+            Py_DECREF(inner);
+            if (pair && (b <= -86400 || b >= 86400)) return stdtype_range_error("UTC offset");
+
+            PyObject *tz = Py_None;
+            if (pair) {
+                tz = stdtype_timezone(b);
+                if (!tz) return NULL;
+            }
+            if (tag == CROUS_TAG_DATETIME) {
+                /* a is UTC when aware; stay clear of overflow before shifting it */
+                if (a < CROUS_DAYS_MIN * CROUS_US_PER_DAY - CROUS_US_PER_DAY ||
+                    a > (CROUS_DAYS_MAX + 2) * CROUS_US_PER_DAY)
+                    result = stdtype_range_error("datetime");
+                else
+                    result = stdtype_decode_datetime(a + b * 1000000, tz);
+            } else if (tag == CROUS_TAG_DATE) {
+                if (a < CROUS_DAYS_MIN || a > CROUS_DAYS_MAX) {
+                    result = stdtype_range_error("date");
+                } else {
+                    int y;
+                    unsigned m, d;
+                    crous_civil_from_days(a, &y, &m, &d);
+                    result = PyDateTimeAPI->Date_FromDate(y, (int)m, (int)d, PyDateTimeAPI->DateType);
+                }
+            } else if (a < 0 || a >= CROUS_US_PER_DAY) {
+                result = stdtype_range_error("time");
+            } else {
+                result = PyDateTimeAPI->Time_FromTime(
+                    (int)(a / 3600000000LL), (int)(a / 60000000 % 60), (int)(a / 1000000 % 60),
+                    (int)(a % 1000000), tz, PyDateTimeAPI->TimeType);
+            }
+            if (pair) Py_DECREF(tz);
+            return result;
+
+        case CROUS_TAG_DECIMAL:
+            if (!PyBytes_CheckExact(inner)) return inner;
+            result = stdtype_decode_decimal((const uint8_t *)PyBytes_AS_STRING(inner),
+                                            (size_t)PyBytes_GET_SIZE(inner));
+            Py_DECREF(inner);
+            return result;
+
+        case CROUS_TAG_UUID:
+            if (!PyBytes_CheckExact(inner) || PyBytes_GET_SIZE(inner) != 16) return inner;
+            result = stdtype_decode_uuid((const uint8_t *)PyBytes_AS_STRING(inner));
+            Py_DECREF(inner);
+            return result;
+
+        default:
+            return inner;
+    }
+}
+
 /* ============================================================================
    PYTHON VALUE -> CROUS VALUE CONVERSION
    ============================================================================ */
 
-static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default_func, crous_err_t *err) {
-    *err = CROUS_OK;
+static crous_value* pyobj_to_crous_node(PyObject *obj, PyObject *default_func,
+                                        registry_snapshot *snap, int depth, int max_depth,
+                                        crous_err_t *err) {
     
     /* None */
     if (obj == Py_None) {
@@ -171,7 +914,7 @@ static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default
         if (overflow != 0) {
             /* Value doesn't fit in long long, try custom serializer or fail */
             int handled = 0;
-            crous_value *result = try_custom_serializer(obj, default_func, err, &handled);
+            crous_value *result = try_custom_serializer(obj, default_func, snap, depth, max_depth, err, &handled);
             if (handled) return result;
             
             PyErr_SetString(CrousEncodeError, "Integer value too large to serialize");
@@ -252,7 +995,7 @@ static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default
                 return NULL;
             }
             
-            crous_value *citem = pyobj_to_crous_with_default(item, default_func, err);
+            crous_value *citem = pyobj_to_crous_tree(item, default_func, snap, depth + 1, max_depth, err);
             if (*err != CROUS_OK) {
                 crous_value_free_tree(list);
                 return NULL;
@@ -291,7 +1034,7 @@ static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default
                 return NULL;
             }
             
-            crous_value *citem = pyobj_to_crous_with_default(item, default_func, err);
+            crous_value *citem = pyobj_to_crous_tree(item, default_func, snap, depth + 1, max_depth, err);
             if (*err != CROUS_OK) {
                 crous_value_free_tree(tuple);
                 return NULL;
@@ -335,7 +1078,7 @@ static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default
                 return NULL;
             }
             
-            crous_value *cval = pyobj_to_crous_with_default(value, default_func, err);
+            crous_value *cval = pyobj_to_crous_tree(value, default_func, snap, depth + 1, max_depth, err);
             if (*err != CROUS_OK) {
                 crous_value_free_tree(dict);
                 return NULL;
@@ -355,7 +1098,7 @@ static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default
     /* Sets - convert to list with tag */
     if (PySet_Check(obj) || PyFrozenSet_Check(obj)) {
         int handled = 0;
-        crous_value *result = try_custom_serializer(obj, default_func, err, &handled);
+        crous_value *result = try_custom_serializer(obj, default_func, snap, depth, max_depth, err, &handled);
         if (handled) return result;
         
         /* Default: convert to list */
@@ -365,7 +1108,7 @@ static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default
             return NULL;
         }
         
-        crous_value *list_val = pyobj_to_crous_with_default(as_list, default_func, err);
+        crous_value *list_val = pyobj_to_crous_tree(as_list, default_func, snap, depth + 1, max_depth, err);
         Py_DECREF(as_list);
         
         if (*err != CROUS_OK) return NULL;
@@ -381,9 +1124,17 @@ static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default
         return tagged;
     }
     
-    /* Try custom serializer for unsupported types */
+    /* datetime, date, time, Decimal and UUID */
     int handled = 0;
-    crous_value *result = try_custom_serializer(obj, default_func, err, &handled);
+    crous_value *result = stdtype_to_crous(obj, snap, err, &handled);
+    if (handled) return result;
+    
+    /* Try custom serializer for unsupported types */
+    result = try_custom_serializer(obj, default_func, snap, depth, max_depth, err, &handled);
+    if (handled) return result;
+    
+    /* Numeric buffers as packed arrays */
+    result = buffer_to_crous(obj, err, &handled);
     if (handled) return result;
     
     /* Unsupported type */
@@ -393,16 +1144,119 @@ static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default
     return NULL;
 }
 
+/*
+ * obj at depth as a tree. The conversion recurses, so besides max_depth,
+ * which a reference cycle always reaches, it stops where the interpreter's
+ * recursion limit does; both fail like pyobj_to_flux() past its depth.
+ */
+static crous_value* pyobj_to_crous_tree(PyObject *obj, PyObject *default_func,
+                                        registry_snapshot *snap, int depth, int max_depth,
+                                        crous_err_t *err) {
+    *err = CROUS_OK;
+    int too_deep = depth >= max_depth;
+    if (!too_deep && Py_EnterRecursiveCall(" while encoding")) {
+        if (!PyErr_ExceptionMatches(PyExc_RecursionError)) {
+            *err = CROUS_ERR_ENCODE;
+            return NULL;
+        }
+        PyErr_Clear();
+        too_deep = 1;
+        max_depth = depth;
+    }
+    if (too_deep) {
+        PyErr_Format(CrousEncodeError,
+                     "maximum nesting depth of %d exceeded (a container that contains itself?)",
+                     max_depth);
+        *err = CROUS_ERR_DEPTH_EXCEEDED;
+        return NULL;
+    }
+    
+    crous_value *value = pyobj_to_crous_node(obj, default_func, snap, depth, max_depth, err);
+    Py_LeaveRecursiveCall();
+    return value;
+}
+
+/* obj as a tree, resolving custom types against one registry snapshot.
+ * max_depth <= 0 gives dumps()'s default limit. */
+static crous_value* pyobj_to_crous_with_default(PyObject *obj, PyObject *default_func,
+                                                int max_depth, crous_err_t *err) {
+    registry_snapshot snap = { NULL };
+    registry_snapshot_take(&snap);
+    crous_value *value = pyobj_to_crous_tree(obj, default_func, &snap, 0,
+                                             max_depth > 0 ? max_depth : PY_ENCODE_MAX_DEPTH, err);
+    registry_snapshot_release(&snap);
+    return value;
+}
+
 /* Legacy function for backwards compatibility */
 static crous_value* pyobj_to_crous(PyObject *obj, crous_err_t *err) {
-    return pyobj_to_crous_with_default(obj, NULL, err);
+    return pyobj_to_crous_with_default(obj, NULL, 0, err);
+}
+
+/* ============================================================================
+   DICT KEY CACHE
+   ============================================================================ */
+
+/*
+ * Record arrays repeat the same keys row after row. Decoders look dict keys
+ * up in a small direct-mapped cache of str objects, so a repeated key costs
+ * one hash of its bytes and a memcmp instead of a new str (and its hash).
+ * Only short ASCII keys are cached: their UTF-8 bytes are the str's data.
+ */
+#define PY_KEY_CACHE_SIZE 512       /* Power of two */
+#define PY_KEY_CACHE_MAX_LEN 64
+#define PY_KEY_CACHE_MIN_INPUT 1024 /* Smaller inputs rarely repeat keys */
+
+typedef struct {
+    PyObject *slots[PY_KEY_CACHE_SIZE];
+} py_key_cache;
+
+static PyObject* key_cache_get(py_key_cache *cache, const char *data, size_t len) {
+    if (!cache || len > PY_KEY_CACHE_MAX_LEN) {
+        return PyUnicode_FromStringAndSize(data, (Py_ssize_t)len);
+    }
+    
+    /* FNV-1a over the key bytes */
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)data[i];
+        h *= 16777619u;
+    }
+    PyObject **slot = &cache->slots[h & (PY_KEY_CACHE_SIZE - 1)];
+    
+    PyObject *key = *slot;
+    if (key && (size_t)PyUnicode_GET_LENGTH(key) == len &&
+        memcmp(PyUnicode_1BYTE_DATA(key), data, len) == 0) {
+        Py_INCREF(key);
+        return key;
+    }
+    
+    key = PyUnicode_FromStringAndSize(data, (Py_ssize_t)len);
+    if (!key) return NULL;
+    
+    if (PyUnicode_IS_ASCII(key)) {
+        /* Hash once here; every dict insert of this key reuses it */
+        if (PyObject_Hash(key) == -1) {
+            Py_DECREF(key);
+            return NULL;
+        }
+        Py_INCREF(key);
+        Py_XSETREF(*slot, key);
+    }
+    return key;
+}
+
+static void key_cache_clear(py_key_cache *cache) {
+    for (size_t i = 0; i < PY_KEY_CACHE_SIZE; i++) {
+        Py_CLEAR(cache->slots[i]);
+    }
 }
 
 /* ============================================================================
    CROUS VALUE -> PYTHON VALUE CONVERSION
    ============================================================================ */
 
-static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object_hook) {
+static PyObject* tree_to_pyobj(const crous_value *v, PyObject *object_hook, py_key_cache *keys) {
     if (!v) {
         Py_RETURN_NONE;
     }
@@ -436,13 +1290,18 @@ static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object
             return PyBytes_FromStringAndSize((const char *)data, (Py_ssize_t)len);
         }
         
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY:
+            return py_array_from_bytes(v->type == CROUS_TYPE_I64_ARRAY ? 'q' : 'd',
+                                       v->data.array.data, v->data.array.len * 8);
+        
         case CROUS_TYPE_LIST: {
             size_t size = crous_value_list_size(v);
             PyObject *list = PyList_New((Py_ssize_t)size);
             if (!list) return NULL;
             
             for (size_t i = 0; i < size; i++) {
-                PyObject *item = crous_to_pyobj_with_hook(crous_value_list_get(v, i), object_hook);
+                PyObject *item = tree_to_pyobj(crous_value_list_get(v, i), object_hook, keys);
                 if (!item) {
                     Py_DECREF(list);
                     return NULL;
@@ -458,7 +1317,7 @@ static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object
             if (!tuple) return NULL;
             
             for (size_t i = 0; i < size; i++) {
-                PyObject *item = crous_to_pyobj_with_hook(crous_value_list_get(v, i), object_hook);
+                PyObject *item = tree_to_pyobj(crous_value_list_get(v, i), object_hook, keys);
                 if (!item) {
                     Py_DECREF(tuple);
                     return NULL;
@@ -480,13 +1339,13 @@ static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object
                     return NULL;
                 }
                 
-                PyObject *key = PyUnicode_FromStringAndSize(entry->key, (Py_ssize_t)entry->key_len);
+                PyObject *key = key_cache_get(keys, entry->key, entry->key_len);
                 if (!key) {
                     Py_DECREF(dict);
                     return NULL;
                 }
                 
-                PyObject *val = crous_to_pyobj_with_hook(entry->value, object_hook);
+                PyObject *val = tree_to_pyobj(entry->value, object_hook, keys);
                 if (!val) {
                     Py_DECREF(key);
                     Py_DECREF(dict);
@@ -506,6 +1365,7 @@ static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object
             
             /* Apply object_hook if provided */
             if (object_hook && object_hook != Py_None) {
+                CROUS_STAT_ADD(callbacks, 1);
                 PyObject *result = PyObject_CallFunctionObjArgs(object_hook, dict, NULL);
                 Py_DECREF(dict);
                 return result;
@@ -521,14 +1381,14 @@ static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object
             /* Check for built-in tag types */
             if (tag == 90) {
                 /* Set */
-                PyObject *list = crous_to_pyobj_with_hook(inner, object_hook);
+                PyObject *list = tree_to_pyobj(inner, object_hook, keys);
                 if (!list) return NULL;
                 PyObject *set = PySet_New(list);
                 Py_DECREF(list);
                 return set;
             } else if (tag == 91) {
                 /* Frozenset */
-                PyObject *list = crous_to_pyobj_with_hook(inner, object_hook);
+                PyObject *list = tree_to_pyobj(inner, object_hook, keys);
                 if (!list) return NULL;
                 PyObject *fset = PyFrozenSet_New(list);
                 Py_DECREF(list);
@@ -549,10 +1409,11 @@ static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object
                 
                 if (decoder) {
                     /* Get the inner value as Python object */
-                    PyObject *inner_py = crous_to_pyobj_with_hook(inner, object_hook);
+                    PyObject *inner_py = tree_to_pyobj(inner, object_hook, keys);
                     if (!inner_py) { Py_DECREF(decoder); return NULL; }
                     
                     /* Call the decoder */
+                    CROUS_STAT_ADD(callbacks, 1);
                     PyObject *result = PyObject_CallFunctionObjArgs(decoder, inner_py, NULL);
                     Py_DECREF(inner_py);
                     Py_DECREF(decoder);
@@ -560,8 +1421,9 @@ static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object
                 }
             }
             
-            /* No decoder found, return inner value */
-            return crous_to_pyobj_with_hook(inner, object_hook);
+            /* No decoder found: standard library types, else the inner value */
+            PyObject *inner_py = tree_to_pyobj(inner, object_hook, keys);
+            return inner_py ? stdtype_decode(tag, inner_py) : NULL;
         }
         
         default:
@@ -570,319 +1432,4555 @@ static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object
     }
 }
 
+/* A tree to Python objects, timed as one conversion span */
+static PyObject* crous_to_pyobj_cached(const crous_value *v, PyObject *object_hook, py_key_cache *keys) {
+    crous_span span;
+    crous_span_begin(&span, "to_python", CROUS_PHASE_CONVERT, CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_NONE, 0);
+    PyObject *result = tree_to_pyobj(v, object_hook, keys);
+    crous_span_end(&span, result ? CROUS_OK : CROUS_ERR_DECODE, 0);
+    return result;
+}
+
+static PyObject* crous_to_pyobj_with_hook(const crous_value *v, PyObject *object_hook) {
+    py_key_cache *keys = PyMem_Calloc(1, sizeof(py_key_cache));
+    if (!keys) return PyErr_NoMemory();
+    
+    PyObject *result = crous_to_pyobj_cached(v, object_hook, keys);
+    key_cache_clear(keys);
+    PyMem_Free(keys);
+    return result;
+}
+
 /* Legacy function */
 static PyObject* crous_to_pyobj(const crous_value *v) {
     return crous_to_pyobj_with_hook(v, NULL);
 }
 
 /* ============================================================================
-   CROUSENCODER CLASS
+   FLUX BINARY -> PYTHON VALUE (FUSED DECODER)
+   ============================================================================ */
+
+/*
+ * Builds Python objects straight from FLUX binary, with no intermediate
+ * crous_value tree. Applies the same limits and checks as the C decoder in
+ * flux_serializer.c and produces the same objects as decoding followed by
+ * crous_to_pyobj_with_hook().
+ */
+typedef struct {
+    const uint8_t *buf;
+    size_t pos;
+    size_t len;
+    PyObject *object_hook;      /* NULL when not set */
+    PyObject *decoders;         /* Snapshot of custom_decoders, or NULL */
+    py_key_cache *keys;
+    PyObject *key_table;        /* Wire v3: list of keys seen so far, else NULL */
+    int columnar;               /* Wire v4: tables allowed */
+    const flux_dictionary_t *dict;  /* Keys ahead of key_table's, or NULL */
+    size_t dict_keys;
+    int max_depth;              /* Values must sit above this depth */
+    int tables;                 /* Tables being read, each through a nested call */
+    int value_refs;             /* Wire v5: SHARE and REF allowed */
+    int replaying;              /* REFs being read again: register no keys or shares */
+    struct py_flux_share *shares;
+    size_t share_count;
+    size_t share_cap;
+    size_t ref_budget;          /* Bytes REFs may still read again */
+} py_flux_reader;
+
+/* Wire v5 shared value: where its bytes are, end 0 until it is complete */
+typedef struct py_flux_share {
+    size_t pos;
+    size_t end;
+} py_flux_share;
+
+static PyObject* flux_decode_fail(crous_err_t err) {
+    PyErr_SetString(CrousDecodeError, crous_err_str(err));
+    return NULL;
+}
+
+static inline crous_err_t py_flux_read_varint(py_flux_reader *r, uint64_t *out) {
+    size_t used;
+    CROUS_STAT_ADD(varint_reads, 1);
+    crous_err_t err = crous_varint_get(r->buf + r->pos, r->len - r->pos, out, &used);
+    if (err == CROUS_OK) r->pos += used;
+    return err;
+}
+
+/* Read a length varint and borrow that many bytes of payload */
+static inline crous_err_t py_flux_read_span(py_flux_reader *r, size_t max_len,
+                                            const char **data, size_t *len) {
+    uint64_t n;
+    crous_err_t err = py_flux_read_varint(r, &n);
+    if (err != CROUS_OK) return err;
+    if (n > max_len) return CROUS_ERR_DECODE;
+    if (n > r->len - r->pos) return CROUS_ERR_TRUNCATED;
+    
+    *data = (const char *)r->buf + r->pos;
+    *len = (size_t)n;
+    r->pos += (size_t)n;
+    return CROUS_OK;
+}
+
+/* Read one dict key as a new reference, resolving wire v3 key references */
+static PyObject* flux_key_to_pyobj(py_flux_reader *r) {
+    const char *kdata;
+    size_t klen;
+    crous_err_t err;
+    
+    if (r->key_table) {
+        uint64_t prefix;
+        err = py_flux_read_varint(r, &prefix);
+        if (err != CROUS_OK) return flux_decode_fail(err);
+        
+        if (prefix & 1) {
+            uint64_t index = prefix >> 1;
+            if (index < r->dict_keys) {
+                flux_dictionary_key(r->dict, (size_t)index, &kdata, &klen);
+                return key_cache_get(r->keys, kdata, klen);
+            }
+            index -= r->dict_keys;
+            if (index >= (uint64_t)PyList_GET_SIZE(r->key_table))
+                return flux_decode_fail(CROUS_ERR_DECODE);
+            PyObject *key = PyList_GET_ITEM(r->key_table, (Py_ssize_t)index);
+            Py_INCREF(key);
+            return key;
+        }
+        
+        prefix >>= 1;
+        if (prefix > CROUS_MAX_STRING_BYTES) return flux_decode_fail(CROUS_ERR_DECODE);
+        if (prefix > r->len - r->pos) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+        kdata = (const char *)r->buf + r->pos;
+        klen = (size_t)prefix;
+        r->pos += klen;
+        
+        PyObject *key = key_cache_get(r->keys, kdata, klen);
+        if (key && !r->replaying &&
+            r->dict_keys + (size_t)PyList_GET_SIZE(r->key_table) < FLUX_KEY_TABLE_MAX &&
+            PyList_Append(r->key_table, key) < 0) {
+            Py_CLEAR(key);
+        }
+        return key;
+    }
+    
+    err = py_flux_read_span(r, CROUS_MAX_STRING_BYTES, &kdata, &klen);
+    if (err != CROUS_OK) return flux_decode_fail(err);
+    return key_cache_get(r->keys, kdata, klen);
+}
+
+static PyObject* flux_to_pyobj(py_flux_reader *r, int depth);
+
+/* One cell of a typed table column, as a new reference. Int columns are
+ * bulk-decoded through run. */
+static PyObject* flux_cell_to_pyobj(py_flux_reader *r, uint8_t kind, size_t row,
+                                    const uint8_t *bitmap, crous_varint_run_t *run,
+                                    int64_t *prev) {
+    crous_err_t err;
+    
+    switch (kind) {
+        case FLUX_COLUMN_INT:
+        case FLUX_COLUMN_INT_DELTA: {
+            uint64_t encoded;
+            size_t used;
+            err = crous_varint_run_next(run, r->buf + r->pos, r->len - r->pos, &encoded, &used);
+            if (err != CROUS_OK) return flux_decode_fail(err);
+            r->pos += used;
+            int64_t val = crous_zigzag_decode(encoded);
+            if (kind == FLUX_COLUMN_INT_DELTA) {
+                val = (int64_t)((uint64_t)*prev + (uint64_t)val);
+                *prev = val;
+            }
+            return PyLong_FromLongLong(val);
+        }
+        
+        case FLUX_COLUMN_FLOAT: {
+            if (r->len - r->pos < 8) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+            double val;
+            memcpy(&val, r->buf + r->pos, 8);
+            r->pos += 8;
+            return PyFloat_FromDouble(val);
+        }
+        
+        case FLUX_COLUMN_BOOL:
+            return PyBool_FromLong((bitmap[row / 8] >> (row % 8)) & 1);
+        
+        case FLUX_COLUMN_STRING: {
+            const char *data;
+            size_t len;
+            err = py_flux_read_span(r, CROUS_MAX_STRING_BYTES, &data, &len);
+            if (err != CROUS_OK) return flux_decode_fail(err);
+            return PyUnicode_FromStringAndSize(data, (Py_ssize_t)len);
+        }
+        
+        default:
+            return flux_decode_fail(CROUS_ERR_DECODE);
+    }
+}
+
+/* Fill one column of every row dict */
+static int flux_column_to_pyobj(py_flux_reader *r, PyObject *rows, PyObject *key, int depth) {
+    Py_ssize_t nrows = PyList_GET_SIZE(rows);
+    if (r->pos >= r->len) {
+        flux_decode_fail(CROUS_ERR_TRUNCATED);
+        return -1;
+    }
+    uint8_t kind = r->buf[r->pos++];
+    
+    const uint8_t *bitmap = NULL;
+    if (kind == FLUX_COLUMN_BOOL) {
+        size_t bitmap_len = ((size_t)nrows + 7) / 8;
+        if (bitmap_len > r->len - r->pos) {
+            flux_decode_fail(CROUS_ERR_TRUNCATED);
+            return -1;
+        }
+        bitmap = r->buf + r->pos;
+        r->pos += bitmap_len;
+    }
+    
+    crous_varint_run_t run;
+    crous_varint_run_init(&run, (size_t)nrows);
+    int64_t prev = 0;
+    for (Py_ssize_t i = 0; i < nrows; i++) {
+        PyObject *val = kind == FLUX_COLUMN_ANY ? flux_to_pyobj(r, depth + 2)
+                                                : flux_cell_to_pyobj(r, kind, (size_t)i, bitmap, &run, &prev);
+        if (!val) return -1;
+        int rc = PyDict_SetItem(PyList_GET_ITEM(rows, i), key, val);
+        Py_DECREF(val);
+        if (rc < 0) return -1;
+    }
+    return 0;
+}
+
+/* Wire v4 table: the list of dicts it was written from. object_hook runs
+ * on each row once all its columns are in. */
+static PyObject* flux_table_to_pyobj(py_flux_reader *r, int depth) {
+    uint64_t rows, cols;
+    crous_err_t err = py_flux_read_varint(r, &rows);
+    if (err == CROUS_OK) err = py_flux_read_varint(r, &cols);
+    if (err != CROUS_OK) return flux_decode_fail(err);
+    
+    /* Same limits as deserialize_table_binary() */
+    if (depth + 2 >= r->max_depth || r->tables >= FLUX_TABLE_MAX_NESTING) return flux_decode_fail(CROUS_ERR_DECODE);
+    if (rows == 0 || rows > CROUS_MAX_LIST_SIZE) return flux_decode_fail(CROUS_ERR_DECODE);
+    if (cols == 0 || cols > CROUS_MAX_DICT_SIZE) return flux_decode_fail(CROUS_ERR_DECODE);
+    if ((rows + 7) / 8 + 2 > (r->len - r->pos) / cols) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+    
+    PyObject *keys = PyList_New((Py_ssize_t)cols);
+    if (!keys) return NULL;
+    for (Py_ssize_t c = 0; c < (Py_ssize_t)cols; c++) {
+        PyObject *key = flux_key_to_pyobj(r);
+        if (!key) {
+            Py_DECREF(keys);
+            return NULL;
+        }
+        PyList_SET_ITEM(keys, c, key);
+    }
+    
+    PyObject *list = PyList_New((Py_ssize_t)rows);
+    if (!list) {
+        Py_DECREF(keys);
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < (Py_ssize_t)rows; i++) {
+        PyObject *row = PyDict_New();
+        if (!row) goto fail;
+        PyList_SET_ITEM(list, i, row);
+    }
+    
+    r->tables++;
+    for (Py_ssize_t c = 0; c < (Py_ssize_t)cols; c++) {
+        if (flux_column_to_pyobj(r, list, PyList_GET_ITEM(keys, c), depth) < 0) {
+            r->tables--;
+            goto fail;
+        }
+    }
+    r->tables--;
+    Py_DECREF(keys);
+    
+    if (r->object_hook) {
+        for (Py_ssize_t i = 0; i < (Py_ssize_t)rows; i++) {
+            CROUS_STAT_ADD(callbacks, 1);
+            PyObject *result = PyObject_CallFunctionObjArgs(r->object_hook, PyList_GET_ITEM(list, i), NULL);
+            if (!result) {
+                Py_DECREF(list);
+                return NULL;
+            }
+            PyList_SetItem(list, i, result);
+        }
+    }
+    return list;
+    
+fail:
+    Py_DECREF(keys);
+    Py_DECREF(list);
+    return NULL;
+}
+
+/* Packed array after its tag, as array.array of typecode */
+static PyObject* flux_packed_to_pyobj(py_flux_reader *r, char typecode) {
+    uint64_t count;
+    crous_err_t err = py_flux_read_varint(r, &count);
+    if (err != CROUS_OK) return flux_decode_fail(err);
+    if (count > CROUS_MAX_ARRAY_LEN) return flux_decode_fail(CROUS_ERR_DECODE);
+    
+    if (r->pos >= r->len) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+    uint8_t pad = r->buf[r->pos++];
+    if (pad >= FLUX_ARRAY_ALIGN) return flux_decode_fail(CROUS_ERR_DECODE);
+    if (pad > r->len - r->pos) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+    for (uint8_t i = 0; i < pad; i++) {
+        if (r->buf[r->pos++] != 0) return flux_decode_fail(CROUS_ERR_DECODE);
+    }
+    
+    size_t nbytes = (size_t)count * 8;
+    if (nbytes > r->len - r->pos) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+    const uint8_t *data = r->buf + r->pos;
+    r->pos += nbytes;
+    return py_array_from_bytes(typecode, data, nbytes);
+}
+
+/* The value type a FLUX tag stands for, for the values_created counters */
+static inline crous_type_t flux_tag_type(uint8_t tag) {
+    static const uint8_t types[] = {
+        CROUS_TYPE_NULL, CROUS_TYPE_BOOL, CROUS_TYPE_BOOL, CROUS_TYPE_INT, CROUS_TYPE_FLOAT,
+        CROUS_TYPE_STRING, CROUS_TYPE_BYTES, CROUS_TYPE_LIST, CROUS_TYPE_DICT, CROUS_TYPE_TAGGED,
+        CROUS_TYPE_TUPLE, CROUS_TYPE_LIST, CROUS_TYPE_I64_ARRAY, CROUS_TYPE_F64_ARRAY
+    };
+    return tag < sizeof(types) ? (crous_type_t)types[tag] : CROUS_TYPE_NULL;
+}
+
+/* A value with no children read through the work stack: scalars, packed
+ * arrays and tables, after its tag */
+static PyObject* flux_leaf_to_pyobj(py_flux_reader *r, uint8_t tag, int depth) {
+    crous_err_t err;
+    
+    switch (tag) {
+        case FLUX_TAG_NULL:
+            Py_RETURN_NONE;
+        
+        case FLUX_TAG_FALSE:
+            Py_RETURN_FALSE;
+        
+        case FLUX_TAG_TRUE:
+            Py_RETURN_TRUE;
+        
+        case FLUX_TAG_INT: {
+            uint64_t encoded;
+            err = py_flux_read_varint(r, &encoded);
+            if (err != CROUS_OK) return flux_decode_fail(err);
+            
+            /* Decode zigzag encoding */
+            int64_t val = crous_zigzag_decode(encoded);
+            return PyLong_FromLongLong(val);
+        }
+        
+        case FLUX_TAG_FLOAT: {
+            if (r->len - r->pos < 8) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+            double val;
+            memcpy(&val, r->buf + r->pos, 8);
+            r->pos += 8;
+            return PyFloat_FromDouble(val);
+        }
+        
+        case FLUX_TAG_STRING: {
+            const char *data;
+            size_t len;
+            err = py_flux_read_span(r, CROUS_MAX_STRING_BYTES, &data, &len);
+            if (err != CROUS_OK) return flux_decode_fail(err);
+            return PyUnicode_FromStringAndSize(data, (Py_ssize_t)len);
+        }
+        
+        case FLUX_TAG_BYTES: {
+            const char *data;
+            size_t len;
+            err = py_flux_read_span(r, CROUS_MAX_BYTES_SIZE, &data, &len);
+            if (err != CROUS_OK) return flux_decode_fail(err);
+            return PyBytes_FromStringAndSize(data, (Py_ssize_t)len);
+        }
+        
+        case FLUX_TAG_TABLE:
+            if (!r->columnar) return flux_decode_fail(CROUS_ERR_DECODE);
+            return flux_table_to_pyobj(r, depth);
+        
+        case FLUX_TAG_I64_ARRAY:
+            return flux_packed_to_pyobj(r, 'q');
+        
+        case FLUX_TAG_F64_ARRAY:
+            return flux_packed_to_pyobj(r, 'd');
+        
+        default:
+            return flux_decode_fail(CROUS_ERR_DECODE);
+    }
+}
+
+/* A dict with all its entries in, through object_hook if one is set */
+static PyObject* flux_dict_finish(py_flux_reader *r, PyObject *dict) {
+    if (!r->object_hook) return dict;
+    
+    CROUS_STAT_ADD(callbacks, 1);
+    PyObject *result = PyObject_CallFunctionObjArgs(r->object_hook, dict, NULL);
+    Py_DECREF(dict);
+    return result;
+}
+
+/* A tagged value from its tag and inner value, which it takes over */
+static PyObject* flux_tagged_finish(py_flux_reader *r, uint32_t tag, PyObject *inner) {
+    /* Check for built-in tag types */
+    if (tag == 90 || tag == 91) {
+        PyObject *set = tag == 90 ? PySet_New(inner) : PyFrozenSet_New(inner);
+        Py_DECREF(inner);
+        return set;
+    }
+    
+    /* Check for custom decoder; the snapshot keeps it alive */
+    PyObject *decoder = NULL;
+    if (r->decoders && PyDict_GET_SIZE(r->decoders) > 0) {
+        PyObject *tag_key = PyLong_FromUnsignedLong(tag);
+        if (tag_key) {
+            decoder = PyDict_GetItem(r->decoders, tag_key);
+            Py_DECREF(tag_key);
+        }
+    }
+    
+    /* No decoder found: standard library types, else the inner value */
+    if (!decoder) return stdtype_decode(tag, inner);
+    
+    CROUS_STAT_ADD(callbacks, 1);
+    PyObject *result = PyObject_CallFunctionObjArgs(decoder, inner, NULL);
+    Py_DECREF(inner);
+    return result;
+}
+
+/* One open list, tuple, dict or tagged value of the decoder */
+typedef struct {
+    PyObject *obj;              /* The container; a tagged value's inner value once read */
+    PyObject *key;              /* Dict key whose value is being read, or NULL */
+    Py_ssize_t next;            /* Children read so far */
+    Py_ssize_t count;
+    uint32_t tag;               /* Tagged values */
+    uint8_t kind;               /* FLUX_TAG_* */
+    size_t share;               /* Wire v5: shares index + 1 it completes, 0 = none */
+} py_flux_frame_in;
+
+/* Where the reader resumes once the value a REF reads again is complete */
+typedef struct {
+    size_t pos;                 /* Just past the REF */
+    size_t len;
+    size_t top;                 /* Open containers when the REF was read */
+} py_flux_replay;
+
+/*
+ * A wire v5 prefix, whose tag byte *tag was just read. SHARE registers the
+ * value after it (unless replaying) and reads that value's own tag into
+ * *tag, with *share its index + 1. REF sets *ref to the index + 1 of a
+ * complete shared value. Both are errors before wire v5.
+ */
+static crous_err_t py_flux_read_share(py_flux_reader *r, uint8_t *tag, size_t *share, size_t *ref) {
+    *share = 0;
+    *ref = 0;
+    if (!r->value_refs) return CROUS_ERR_DECODE;
+    
+    if (*tag == FLUX_TAG_REF) {
+        uint64_t index;
+        crous_err_t err = py_flux_read_varint(r, &index);
+        if (err != CROUS_OK) return err;
+        /* Only finished values: a REF inside its own value would never end */
+        if (index >= r->share_count || r->shares[index].end == 0) return CROUS_ERR_DECODE;
+        *ref = (size_t)index + 1;
+        return CROUS_OK;
+    }
+    
+    if (!r->replaying) {
+        if (r->share_count == r->share_cap) {
+            size_t new_cap = r->share_cap ? r->share_cap * 2 : 16;
+            py_flux_share *grown = PyMem_Realloc(r->shares, new_cap * sizeof(*grown));
+            if (!grown) return CROUS_ERR_OOM;
+            r->shares = grown;
+            r->share_cap = new_cap;
+        }
+        r->shares[r->share_count].pos = r->pos;
+        r->shares[r->share_count].end = 0;
+        *share = ++r->share_count;
+    }
+    if (r->pos >= r->len) return CROUS_ERR_TRUNCATED;
+    *tag = r->buf[r->pos++];
+    if (*tag == FLUX_TAG_SHARE || *tag == FLUX_TAG_REF) return CROUS_ERR_DECODE;
+    return CROUS_OK;
+}
+
+/*
+ * The value at depth, without recursion: containers and tagged values
+ * go on a work stack when their head is read, pre-sized lists and tuples
+ * are filled by index, and a finished value is attached to its parent,
+ * finishing it in turn once its last child is in. Tables nest through a
+ * nested call per table, at most FLUX_TABLE_MAX_NESTING deep. A wire v5
+ * REF reads its shared value's bytes again, so every occurrence is a new
+ * object, as object_hook and mutable containers need.
+ */
+static PyObject* flux_to_pyobj(py_flux_reader *r, int depth) {
+    py_flux_frame_in local[CROUS_STACK_INLINE];
+    py_flux_frame_in *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+    py_flux_replay replay_local[CROUS_STACK_INLINE];
+    py_flux_replay *replays = replay_local;
+    size_t replay_top = 0, replay_cap = CROUS_STACK_INLINE;
+    crous_err_t err;
+    
+    for (;;) {
+        int d = depth + (int)top;
+        if (d >= r->max_depth) {
+            flux_decode_fail(CROUS_ERR_DECODE);
+            goto fail;
+        }
+        if (r->pos >= r->len) {
+            flux_decode_fail(CROUS_ERR_TRUNCATED);
+            goto fail;
+        }
+        
+        uint8_t tag = r->buf[r->pos++];
+        size_t share = 0, ref = 0;
+        if (tag == FLUX_TAG_SHARE || tag == FLUX_TAG_REF) {
+            err = py_flux_read_share(r, &tag, &share, &ref);
+            if (err != CROUS_OK) {
+                flux_decode_fail(err);
+                goto fail;
+            }
+            
+            if (ref) {
+                const py_flux_share *span = &r->shares[ref - 1];
+                if (span->end - span->pos > r->ref_budget) {
+                    flux_decode_fail(CROUS_ERR_DECODE);
+                    goto fail;
+                }
+                r->ref_budget -= span->end - span->pos;
+                
+                if (replay_top == replay_cap) {
+                    py_flux_replay *grown = crous_stack_grow(replays, &replay_cap, sizeof(*replays),
+                                                             replay_local);
+                    if (!grown) {
+                        PyErr_NoMemory();
+                        goto fail;
+                    }
+                    replays = grown;
+                }
+                replays[replay_top].pos = r->pos;
+                replays[replay_top].len = r->len;
+                replays[replay_top].top = top;
+                replay_top++;
+                r->replaying++;
+                r->pos = span->pos;
+                r->len = span->end;
+                continue;
+            }
+        }
+        CROUS_STAT_ADD(values_created[flux_tag_type(tag)], 1);
+        
+        PyObject *v;
+        uint64_t count, tag_num = 0;
+        if (tag == FLUX_TAG_LIST || tag == FLUX_TAG_TUPLE || tag == FLUX_TAG_DICT) {
+            err = py_flux_read_varint(r, &count);
+            if (err != CROUS_OK) {
+                flux_decode_fail(err);
+                goto fail;
+            }
+            if (tag == FLUX_TAG_DICT) {
+                if (count > CROUS_MAX_DICT_SIZE) err = CROUS_ERR_DECODE;
+                /* Every entry takes at least two bytes (key length + value tag) */
+                else if (count > (r->len - r->pos) / 2) err = CROUS_ERR_TRUNCATED;
+            } else {
+                if (count > CROUS_MAX_LIST_SIZE) err = CROUS_ERR_DECODE;
+                /* Every element takes at least one byte; reject counts the input can't hold */
+                else if (count > r->len - r->pos) err = CROUS_ERR_TRUNCATED;
+            }
+            if (err != CROUS_OK) {
+                flux_decode_fail(err);
+                goto fail;
+            }
+            
+            v = tag == FLUX_TAG_DICT ? PyDict_New()
+                : tag == FLUX_TAG_TUPLE ? PyTuple_New((Py_ssize_t)count) : PyList_New((Py_ssize_t)count);
+            if (!v) goto fail;
+            if (count == 0 && tag == FLUX_TAG_DICT) {
+                v = flux_dict_finish(r, v);
+                if (!v) goto fail;
+            }
+        } else if (tag == FLUX_TAG_TAGGED) {
+            err = py_flux_read_varint(r, &tag_num);
+            if (err != CROUS_OK) {
+                flux_decode_fail(err);
+                goto fail;
+            }
+            v = NULL;
+            count = 1;
+        } else {
+            v = flux_leaf_to_pyobj(r, tag, d);
+            if (!v) goto fail;
+            count = 0;
+        }
+        
+        if (count > 0) {
+            if (top == cap) {
+                py_flux_frame_in *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+                if (!grown) {
+                    Py_XDECREF(v);
+                    PyErr_NoMemory();
+                    goto fail;
+                }
+                stack = grown;
+            }
+            py_flux_frame_in *f = &stack[top++];
+            f->obj = v;
+            f->key = NULL;
+            f->next = 0;
+            f->count = (Py_ssize_t)count;
+            f->tag = (uint32_t)tag_num;
+            f->kind = tag;
+            f->share = share;
+            if (tag == FLUX_TAG_DICT && !(f->key = flux_key_to_pyobj(r))) goto fail;
+            continue;
+        }
+        if (share) r->shares[share - 1].end = r->pos;
+        
+        /* Attach v to its parent, finishing every container it completes */
+        for (;;) {
+            /* A value read again for a REF: carry on after the REF */
+            while (replay_top > 0 && replays[replay_top - 1].top == top) {
+                replay_top--;
+                r->pos = replays[replay_top].pos;
+                r->len = replays[replay_top].len;
+                r->replaying--;
+            }
+            if (top == 0) break;
+            
+            py_flux_frame_in *f = &stack[top - 1];
+            switch (f->kind) {
+                case FLUX_TAG_LIST:
+                    PyList_SET_ITEM(f->obj, f->next, v);
+                    break;
+                
+                case FLUX_TAG_TUPLE:
+                    PyTuple_SET_ITEM(f->obj, f->next, v);
+                    break;
+                
+                case FLUX_TAG_DICT: {
+                    int rc = PyDict_SetItem(f->obj, f->key, v);
+                    Py_DECREF(v);
+                    Py_CLEAR(f->key);
+                    if (rc < 0) goto fail;
+                    break;
+                }
+                
+                default:
+                    f->obj = v;
+                    break;
+            }
+            
+            if (++f->next < f->count) {
+                if (f->kind == FLUX_TAG_DICT && !(f->key = flux_key_to_pyobj(r))) goto fail;
+                v = NULL;
+                break;
+            }
+            
+            top--;
+            if (f->share) r->shares[f->share - 1].end = r->pos;
+            if (f->kind == FLUX_TAG_DICT) v = flux_dict_finish(r, f->obj);
+            else if (f->kind == FLUX_TAG_TAGGED) v = flux_tagged_finish(r, f->tag, f->obj);
+            else v = f->obj;
+            if (!v) goto fail;
+        }
+        
+        if (v) {
+            crous_stack_release(stack, local);
+            crous_stack_release(replays, replay_local);
+            return v;
+        }
+    }
+    
+fail:
+    while (top > 0) {
+        top--;
+        Py_XDECREF(stack[top].obj);
+        Py_XDECREF(stack[top].key);
+    }
+    if (replay_top > 0) {
+        r->pos = replays[0].pos;
+        r->len = replays[0].len;
+        r->replaying -= (int)replay_top;
+    }
+    crous_stack_release(stack, local);
+    crous_stack_release(replays, replay_local);
+    return NULL;
+}
+
+/* ============================================================================
+   SCHEMA DOCUMENTS
    ============================================================================ */
 
+/*
+ * A compiled flux_schema_t with what the Python walks need beside its
+ * nodes: each field name as an interned str, so records are read and
+ * written with no per-field string work.
+ */
 typedef struct {
     PyObject_HEAD
-    PyObject *default_func;
-    int allow_custom;
-} CrousEncoderObject;
+    flux_schema_t *schema;          /* Given to the C registry once registered */
+    const flux_schema_node_t *nodes;
+    size_t count;
+    PyObject **names;               /* Per node: field name, or NULL */
+    PyObject *spec;
+    int registered;
+} SchemaObject;
+
+/* One value laid out by node index of s, as a new reference. Schemas nest
+ * at most FLUX_SCHEMA_MAX_DEPTH deep, which bounds the recursion. */
+static PyObject* schema_node_to_pyobj(py_flux_reader *r, const SchemaObject *s, size_t index) {
+    const flux_schema_node_t *n = &s->nodes[index];
+    crous_err_t err;
+    uint64_t u;
+    
+    if (n->nullable) {
+        if (r->pos == r->len) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+        uint8_t present = r->buf[r->pos++];
+        if (present > 1) return flux_decode_fail(CROUS_ERR_DECODE);
+        if (!present) Py_RETURN_NONE;
+    }
+    
+    switch (n->kind) {
+        case FLUX_SCHEMA_BOOL:
+            if (r->pos == r->len) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+            if (r->buf[r->pos] > 1) return flux_decode_fail(CROUS_ERR_DECODE);
+            return PyBool_FromLong(r->buf[r->pos++]);
+        
+        case FLUX_SCHEMA_INT:
+            err = py_flux_read_varint(r, &u);
+            if (err != CROUS_OK) return flux_decode_fail(err);
+            return PyLong_FromLongLong(crous_zigzag_decode(u));
+        
+        case FLUX_SCHEMA_FLOAT: {
+            if (r->len - r->pos < 8) return flux_decode_fail(CROUS_ERR_TRUNCATED);
+            double val;
+            memcpy(&val, r->buf + r->pos, 8);
+            r->pos += 8;
+            return PyFloat_FromDouble(val);
+        }
+        
+        case FLUX_SCHEMA_STRING:
+        case FLUX_SCHEMA_BYTES: {
+            const char *data;
+            size_t len;
+            err = py_flux_read_span(r, CROUS_MAX_STRING_BYTES, &data, &len);
+            if (err != CROUS_OK) return flux_decode_fail(err);
+            return n->kind == FLUX_SCHEMA_STRING ? PyUnicode_FromStringAndSize(data, (Py_ssize_t)len)
+                                                 : PyBytes_FromStringAndSize(data, (Py_ssize_t)len);
+        }
+        
+        case FLUX_SCHEMA_ANY:
+            return flux_to_pyobj(r, 0);
+        
+        case FLUX_SCHEMA_LIST: {
+            err = py_flux_read_varint(r, &u);
+            if (err != CROUS_OK) return flux_decode_fail(err);
+            if (u > CROUS_MAX_LIST_SIZE) return flux_decode_fail(CROUS_ERR_DECODE);
+            
+            /* Empty records take no bytes, so only a count the input can
+               back is allocated up front */
+            Py_ssize_t count = (Py_ssize_t)u;
+            int sized = u <= r->len - r->pos;
+            PyObject *list = PyList_New(sized ? count : 0);
+            if (!list) return NULL;
+            for (Py_ssize_t i = 0; i < count; i++) {
+                PyObject *item = schema_node_to_pyobj(r, s, index + 1);
+                if (!item) {
+                    Py_DECREF(list);
+                    return NULL;
+                }
+                if (sized) {
+                    PyList_SET_ITEM(list, i, item);
+                } else {
+                    int rc = PyList_Append(list, item);
+                    Py_DECREF(item);
+                    if (rc < 0) {
+                        Py_DECREF(list);
+                        return NULL;
+                    }
+                }
+            }
+            return list;
+        }
+        
+        case FLUX_SCHEMA_RECORD: {
+            PyObject *dict = PyDict_New();
+            if (!dict) return NULL;
+            for (size_t f = index + 1; f < n->end; f = s->nodes[f].end) {
+                PyObject *value = schema_node_to_pyobj(r, s, f);
+                if (!value || PyDict_SetItem(dict, s->names[f], value) < 0) {
+                    Py_XDECREF(value);
+                    Py_DECREF(dict);
+                    return NULL;
+                }
+                Py_DECREF(value);
+            }
+            return flux_dict_finish(r, dict);
+        }
+    }
+    return flux_decode_fail(CROUS_ERR_INTERNAL);
+}
+
+/* A document written with s straight to Python objects; max_depth limits
+ * the values of any fields, <= 0 meaning CROUS_MAX_DEPTH */
+static PyObject* schema_document_to_pyobj(const SchemaObject *s, const uint8_t *buf, size_t buf_size,
+                                          PyObject *object_hook, py_key_cache *keys, int max_depth) {
+    uint32_t id;
+    if (!flux_binary_schema_id(buf, buf_size, &id)) return flux_decode_fail(CROUS_ERR_INVALID_HEADER);
+    if (id != flux_schema_id(s->schema)) {
+        PyErr_Format(CrousDecodeError, "document was written with schema %u, not %u",
+                     (unsigned)id, (unsigned)flux_schema_id(s->schema));
+        return NULL;
+    }
+    crous_err_t err = flux_schema_check_header(s->schema, buf, buf_size);
+    if (err != CROUS_OK) return flux_decode_fail(err);
+    
+    /* Values of any fields are plain wire v1 values */
+    py_flux_reader r = { buf, FLUX_SCHEMA_HEADER_SIZE, buf_size, object_hook, NULL, keys, NULL,
+                         0, NULL, 0, max_depth > 0 ? max_depth : CROUS_MAX_DEPTH, 0,
+                         0, 0, NULL, 0, 0, 0 };
+    
+    crous_span span;
+    crous_span_begin(&span, "schema_to_python", CROUS_PHASE_CONVERT,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, buf_size);
+    registry_snapshot snap = { NULL };
+    registry_snapshot_take(&snap);
+    r.decoders = snap.decoders;
+    PyObject *result = schema_node_to_pyobj(&r, s, 0);
+    registry_snapshot_release(&snap);
+    
+    /* Bytes left over mean the writer's schema was another one */
+    if (result && r.pos != buf_size) {
+        Py_CLEAR(result);
+        PyErr_SetString(CrousDecodeError, "document does not match its schema: trailing bytes");
+    }
+    crous_span_end(&span, result ? CROUS_OK : CROUS_ERR_DECODE, 0);
+    return result;
+}
+
+/* ============================================================================
+   DECODE HELPER
+   ============================================================================ */
+
+/* A plain FLUX document straight to Python objects; dict is the
+ * dictionary of the envelope it came in, if any. max_depth <= 0 means
+ * CROUS_MAX_DEPTH. */
+static PyObject* flux_document_to_pyobj(const uint8_t *buf, size_t buf_size, PyObject *object_hook,
+                                        py_key_cache *keys, const flux_dictionary_t *dict, int max_depth) {
+    if (buf_size < 6 || buf[0] != FLUX_MAGIC_0 || buf[1] != FLUX_MAGIC_1 ||
+        buf[2] != FLUX_MAGIC_2 || buf[3] != FLUX_MAGIC_3 ||
+        buf[4] < FLUX_VERSION || buf[4] > FLUX_VERSION_VALUE_REFS) {
+        return flux_decode_fail(CROUS_ERR_INVALID_HEADER);
+    }
+    
+    size_t ref_budget = buf_size < (SIZE_MAX - FLUX_REF_EXPANSION_BASE) / FLUX_REF_EXPANSION
+        ? buf_size * FLUX_REF_EXPANSION + FLUX_REF_EXPANSION_BASE : SIZE_MAX;
+    py_flux_reader r = { buf, 6, buf_size, object_hook, NULL, keys, NULL,
+                         buf[4] >= FLUX_VERSION_COLUMNAR, dict, flux_dictionary_key_count(dict),
+                         max_depth > 0 ? max_depth : CROUS_MAX_DEPTH, 0,
+                         buf[4] >= FLUX_VERSION_VALUE_REFS, 0, NULL, 0, 0, ref_budget };
+    if (buf[4] >= FLUX_VERSION_KEY_REFS) {
+        r.key_table = PyList_New(0);
+        if (!r.key_table) return NULL;
+    }
+    
+    crous_span span;
+    crous_span_begin(&span, "flux_to_python", CROUS_PHASE_CONVERT,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, buf_size);
+    registry_snapshot snap = { NULL };
+    registry_snapshot_take(&snap);
+    r.decoders = snap.decoders;
+    PyObject *result = flux_to_pyobj(&r, 0);
+    registry_snapshot_release(&snap);
+    Py_XDECREF(r.key_table);
+    PyMem_Free(r.shares);
+    crous_span_end(&span, result ? CROUS_OK : CROUS_ERR_DECODE, 0);
+    return result;
+}
+
+/*
+ * Scratch memory a CrousDecoder keeps between calls: the buffer compressed
+ * envelopes are unpacked into and the arena legacy trees are built in.
+ * Both are dropped after use once past PY_SESSION_KEEP_MAX.
+ */
+#define PY_SESSION_KEEP_MAX ((size_t)4 << 20)
+
+typedef struct {
+    uint8_t *raw;
+    size_t raw_cap;
+    crous_arena *arena;
+} py_decode_scratch;
+
+static void decode_scratch_clear(py_decode_scratch *scratch) {
+    free(scratch->raw);
+    crous_arena_free(scratch->arena);
+    scratch->raw = NULL;
+    scratch->raw_cap = 0;
+    scratch->arena = NULL;
+}
+
+/* FLUX input is decoded straight to Python objects. Legacy CROUS input
+ * goes through a tree that only lives until it is converted, so build it
+ * in an arena sized from the input and drop the whole thing in one call.
+ * buf stays alive for the whole conversion, so payloads are borrowed.
+ * With scratch, its buffers replace the per-call ones. max_depth limits
+ * FLUX input; the legacy decoder keeps CROUS_MAX_DEPTH. readonly is 0 when
+ * buf belongs to a mutable object such as a bytearray. */
+static PyObject* decode_buffer_to_pyobj_scratch(const uint8_t *buf, size_t buf_size, PyObject *object_hook,
+                                                py_key_cache *keys, py_decode_scratch *scratch,
+                                                int max_depth, int readonly) {
+    if (object_hook == Py_None) object_hook = NULL;
+    
+    /* Envelopes are unpacked and legacy input decoded without the GIL, and
+     * legacy values borrow from buf until object_hook has seen them. The
+     * caller's export stops a resize but not a write, so mutable input
+     * takes those paths through a private copy. */
+    int plain_flux = buf_size >= 6 && buf[0] == FLUX_MAGIC_0 && buf[1] == FLUX_MAGIC_1 &&
+                     buf[2] == FLUX_MAGIC_2 && buf[3] == FLUX_MAGIC_3;
+    uint32_t schema_id;
+    if (!readonly && (flux_binary_is_compressed(buf, buf_size) ||
+                      (!plain_flux && !flux_binary_schema_id(buf, buf_size, &schema_id)))) {
+        uint8_t *copy = PyMem_Malloc(buf_size ? buf_size : 1);
+        if (!copy) return PyErr_NoMemory();
+        memcpy(copy, buf, buf_size);
+        PyObject *result = decode_buffer_to_pyobj_scratch(copy, buf_size, object_hook, keys, scratch,
+                                                          max_depth, 1);
+        PyMem_Free(copy);
+        return result;
+    }
+    
+    /* A compressed envelope is unpacked to a scratch copy, then decoded from that */
+    if (flux_binary_is_compressed(buf, buf_size)) {
+        const flux_dictionary_t *dict;
+        size_t raw_size;
+        crous_err_t err = flux_envelope_dictionary(buf, buf_size, &dict);
+        if (err == CROUS_ERR_NOT_FOUND) {
+            PyErr_Format(CrousDecodeError, "document names dictionary %u, which is not registered",
+                         (unsigned)(buf[9] | (buf[10] << 8) | (buf[11] << 16)));
+            return NULL;
+        }
+        if (err == CROUS_OK) err = flux_decompressed_size(buf, buf_size, &raw_size);
+        if (err != CROUS_OK) return flux_decode_fail(err);
+        
+        uint8_t *raw;
+        if (scratch && raw_size <= scratch->raw_cap) {
+            raw = scratch->raw;
+        } else if (scratch) {
+            raw = realloc(scratch->raw, raw_size);
+            if (!raw) return PyErr_NoMemory();
+            scratch->raw = raw;
+            scratch->raw_cap = raw_size;
+        } else {
+            raw = malloc(raw_size ? raw_size : 1);
+            if (!raw) return PyErr_NoMemory();
+        }
+        Py_BEGIN_ALLOW_THREADS
+        err = flux_decompress_binary_into(buf, buf_size, raw, raw_size);
+        Py_END_ALLOW_THREADS
+        
+        PyObject *result = err == CROUS_OK ? flux_document_to_pyobj(raw, raw_size, object_hook, keys, dict, max_depth)
+                                           : flux_decode_fail(err);
+        if (!scratch) {
+            free(raw);
+        } else if (scratch->raw_cap > PY_SESSION_KEEP_MAX) {
+            free(scratch->raw);
+            scratch->raw = NULL;
+            scratch->raw_cap = 0;
+        }
+        return result;
+    }
+    
+    /* A schema document is read by the registered schema it names */
+    if (flux_binary_schema_id(buf, buf_size, &schema_id)) {
+        PyObject *id_obj = PyLong_FromUnsignedLong(schema_id);
+        if (!id_obj) return NULL;
+        PyObject *schema = PyDict_GetItemWithError(registered_schemas, id_obj);
+        Py_DECREF(id_obj);
+        if (!schema) {
+            if (!PyErr_Occurred()) {
+                PyErr_Format(CrousDecodeError, "document names schema %u, which is not registered",
+                             (unsigned)schema_id);
+            }
+            return NULL;
+        }
+        Py_INCREF(schema);
+        PyObject *result = schema_document_to_pyobj((SchemaObject *)schema, buf, buf_size, object_hook, keys,
+                                                    max_depth);
+        Py_DECREF(schema);
+        return result;
+    }
+    
+    if (plain_flux) {
+        return flux_document_to_pyobj(buf, buf_size, object_hook, keys, NULL, max_depth);
+    }
+    
+    size_t chunk_size = buf_size * 8;
+    if (chunk_size < 4096) chunk_size = 4096;
+    if (chunk_size > (1u << 20)) chunk_size = 1u << 20;
+    
+    crous_arena *arena = scratch && scratch->arena ? scratch->arena : crous_arena_create(chunk_size);
+    if (!arena) return PyErr_NoMemory();
+    
+    /* Pure C phase: buf is read-only input or a private copy */
+    crous_value *value = NULL;
+    crous_err_t err;
+    Py_BEGIN_ALLOW_THREADS
+    err = crous_decode_borrowed(buf, buf_size, arena, &value);
+    Py_END_ALLOW_THREADS
+    
+    PyObject *result = NULL;
+    if (err != CROUS_OK) {
+        PyErr_SetString(CrousDecodeError, crous_err_str(err));
+    } else {
+        result = crous_to_pyobj_cached(value, object_hook, keys);
+    }
+    
+    if (scratch && crous_arena_used(arena) <= PY_SESSION_KEEP_MAX) {
+        crous_arena_reset(arena);
+        scratch->arena = arena;
+    } else {
+        crous_arena_free(arena);
+        if (scratch) scratch->arena = NULL;
+    }
+    return result;
+}
+
+static PyObject* decode_buffer_to_pyobj_keys(const uint8_t *buf, size_t buf_size,
+                                             PyObject *object_hook, py_key_cache *keys) {
+    return decode_buffer_to_pyobj_scratch(buf, buf_size, object_hook, keys, NULL, CROUS_MAX_DEPTH, 1);
+}
+
+/* Decode with a key cache scoped to this call (skipped for small inputs) */
+static PyObject* decode_buffer_to_pyobj_depth(const uint8_t *buf, size_t buf_size, PyObject *object_hook,
+                                              int max_depth, int readonly) {
+    py_key_cache *keys = NULL;
+    if (buf_size >= PY_KEY_CACHE_MIN_INPUT) {
+        /* Without a cache decoding still works, just slower */
+        keys = PyMem_Calloc(1, sizeof(py_key_cache));
+    }
+    
+    PyObject *result = decode_buffer_to_pyobj_scratch(buf, buf_size, object_hook, keys, NULL, max_depth, readonly);
+    if (keys) {
+        key_cache_clear(keys);
+        PyMem_Free(keys);
+    }
+    return result;
+}
+
+static PyObject* decode_buffer_to_pyobj(const uint8_t *buf, size_t buf_size, PyObject *object_hook,
+                                        int readonly) {
+    return decode_buffer_to_pyobj_depth(buf, buf_size, object_hook, CROUS_MAX_DEPTH, readonly);
+}
+
+/* Compile an iterable of path strings; NULL with an exception set on failure */
+static flux_projection_t* projection_from_pyobj(PyObject *fields) {
+    if (PyUnicode_Check(fields) || PyBytes_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "fields must be an iterable of path strings, not a single string");
+        return NULL;
+    }
+    PyObject *iter = PyObject_GetIter(fields);
+    if (!iter) return NULL;
+
+    flux_projection_t *proj;
+    if (flux_projection_new(&proj) != CROUS_OK) {
+        Py_DECREF(iter);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    PyObject *item;
+    while ((item = PyIter_Next(iter))) {
+        if (!PyUnicode_Check(item)) {
+            PyErr_Format(PyExc_TypeError, "field paths must be str, not %.200s", Py_TYPE(item)->tp_name);
+            Py_DECREF(item);
+            break;
+        }
+        Py_ssize_t len;
+        const char *path = PyUnicode_AsUTF8AndSize(item, &len);
+        crous_err_t err = path ? flux_projection_add(proj, path, (size_t)len) : CROUS_OK;
+        if (err == CROUS_ERR_SYNTAX) {
+            PyErr_Format(PyExc_ValueError, "invalid field path: %R", item);
+        } else if (err != CROUS_OK) {
+            PyErr_NoMemory();
+        }
+        Py_DECREF(item);
+        if (!path || err != CROUS_OK) break;
+    }
+    Py_DECREF(iter);
+
+    if (PyErr_Occurred()) {
+        flux_projection_free(proj);
+        return NULL;
+    }
+    return proj;
+}
+
+/* Decode only the paths listed in fields out of a FLUX binary buffer.
+ * readonly is 0 when buf belongs to a mutable object. */
+static PyObject* decode_fields_to_pyobj(const uint8_t *buf, size_t buf_size, PyObject *fields,
+                                        PyObject *object_hook, int readonly) {
+    if (object_hook == Py_None) object_hook = NULL;
+    
+    /* Decoded without the GIL into values that borrow from buf, so a
+     * mutable buffer is read through a private copy */
+    if (!readonly) {
+        uint8_t *copy = PyMem_Malloc(buf_size ? buf_size : 1);
+        if (!copy) return PyErr_NoMemory();
+        memcpy(copy, buf, buf_size);
+        PyObject *result = decode_fields_to_pyobj(copy, buf_size, fields, object_hook, 1);
+        PyMem_Free(copy);
+        return result;
+    }
+
+    flux_projection_t *proj = projection_from_pyobj(fields);
+    if (!proj) return NULL;
+
+    /* The selection is usually a small part of the input */
+    crous_arena *arena = crous_arena_create(4096);
+    if (!arena) {
+        flux_projection_free(proj);
+        return PyErr_NoMemory();
+    }
+
+    crous_value *value = NULL;
+    crous_err_t err;
+    Py_BEGIN_ALLOW_THREADS
+    err = flux_decode_binary_fields_borrowed(buf, buf_size, proj, arena, &value);
+    Py_END_ALLOW_THREADS
+    flux_projection_free(proj);
+
+    PyObject *result = err == CROUS_OK ? crous_to_pyobj_cached(value, object_hook, NULL) : flux_decode_fail(err);
+    crous_arena_free(arena);
+    return result;
+}
+
+/*
+ * crous_input_stream adapter over a Python file object. Binary files fill
+ * the decoder's chunk in place through readinto(); anything else goes
+ * through read(n), which may return any bytes-like object.
+ */
+typedef struct {
+    PyObject *read;
+    PyObject *readinto;     /* NULL when fp has none or it is unsupported */
+    int failed;             /* A Python exception is pending */
+} py_read_stream_state;
+
+/* Look up fp's read methods; -1 with TypeError when there is no read() */
+static int read_stream_init(py_read_stream_state *state, PyObject *fp) {
+    state->failed = 0;
+    state->readinto = NULL;
+    state->read = PyObject_GetAttrString(fp, "read");
+    if (!state->read) {
+        PyErr_SetString(PyExc_TypeError, "fp must have a read() method");
+        return -1;
+    }
+    /* Text files have no readinto(); read() reports their str chunks */
+    if (!PyObject_HasAttrString(fp, "encoding")) {
+        state->readinto = PyObject_GetAttrString(fp, "readinto");
+        if (!state->readinto) PyErr_Clear();
+    }
+    return 0;
+}
+
+static void read_stream_clear(py_read_stream_state *state) {
+    Py_CLEAR(state->read);
+    Py_CLEAR(state->readinto);
+}
+
+/* readinto() straight into buf; -1 to fall back to read(), -2 on error */
+static Py_ssize_t read_stream_into(py_read_stream_state *state, uint8_t *buf, size_t max_len) {
+    PyObject *view = PyMemoryView_FromMemory((char *)buf, (Py_ssize_t)max_len, PyBUF_WRITE);
+    if (!view) return -2;
+    PyObject *res = PyObject_CallFunctionObjArgs(state->readinto, view, NULL);
+    /* The memory belongs to the decoder; a view kept by fp must not outlive it */
+    PyObject *type, *value, *tb;
+    PyErr_Fetch(&type, &value, &tb);
+    PyObject *released = PyObject_CallMethod(view, "release", NULL);
+    Py_DECREF(view);
+    if (released) {
+        Py_DECREF(released);
+        PyErr_Restore(type, value, tb);
+    } else {
+        Py_XDECREF(type);
+        Py_XDECREF(value);
+        Py_XDECREF(tb);
+        Py_CLEAR(res);
+    }
+
+    /* RawIOBase subclasses that only implement read() end up here */
+    if (!res && (PyErr_ExceptionMatches(PyExc_NotImplementedError) ||
+                 PyErr_ExceptionMatches(PyExc_AttributeError))) {
+        PyErr_Clear();
+        Py_CLEAR(state->readinto);
+        return -1;
+    }
+    if (!res) return -2;
+
+    Py_ssize_t n = PyLong_Check(res) ? PyLong_AsSsize_t(res) : -1;
+    Py_DECREF(res);
+    if (n < 0 || (size_t)n > max_len) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, "readinto() must return a byte count within the buffer");
+        }
+        return -2;
+    }
+    return n;
+}
+
+static size_t py_read_stream(void *user_data, uint8_t *buf, size_t max_len) {
+    py_read_stream_state *state = (py_read_stream_state *)user_data;
+    if (state->failed) return 0;
+    
+    if (state->readinto) {
+        Py_ssize_t n = read_stream_into(state, buf, max_len);
+        if (n >= 0) return (size_t)n;
+        if (n == -2) {
+            state->failed = 1;
+            return 0;
+        }
+    }
+    
+    PyObject *chunk = PyObject_CallFunction(state->read, "n", (Py_ssize_t)max_len);
+    if (!chunk) {
+        state->failed = 1;
+        return 0;
+    }
+    Py_buffer view;
+    if (PyObject_GetBuffer(chunk, &view, PyBUF_SIMPLE) < 0) {
+        PyErr_SetString(PyExc_TypeError, "read() must return a bytes-like object");
+        Py_DECREF(chunk);
+        state->failed = 1;
+        return 0;
+    }
+    
+    size_t len = (size_t)view.len;
+    if (len > max_len) {
+        PyErr_SetString(PyExc_ValueError, "read() returned more bytes than requested");
+        PyBuffer_Release(&view);
+        Py_DECREF(chunk);
+        state->failed = 1;
+        return 0;
+    }
+    memcpy(buf, view.buf, len);
+    PyBuffer_Release(&view);
+    Py_DECREF(chunk);
+    return len;
+}
+
+/* Call fp.name(), returning a new reference or NULL with the error cleared */
+static PyObject* call_method_quiet(PyObject *fp, const char *name) {
+    PyObject *res = PyObject_CallMethod(fp, name, NULL);
+    if (!res) PyErr_Clear();
+    return res;
+}
+
+/* crous_output_stream adapter over a Python write(b) method */
+typedef struct {
+    PyObject *write;
+    int failed;             /* A Python exception is pending */
+} py_write_stream_state;
+
+static size_t py_write_stream(void *user_data, const uint8_t *buf, size_t len) {
+    py_write_stream_state *state = (py_write_stream_state *)user_data;
+    if (state->failed) return (size_t)-1;
+    
+    PyObject *chunk = PyBytes_FromStringAndSize((const char *)buf, (Py_ssize_t)len);
+    if (!chunk) {
+        state->failed = 1;
+        return (size_t)-1;
+    }
+    PyObject *result = PyObject_CallFunctionObjArgs(state->write, chunk, NULL);
+    Py_DECREF(chunk);
+    if (!result) {
+        state->failed = 1;
+        return (size_t)-1;
+    }
+    Py_DECREF(result);
+    return len;
+}
+
+/* ============================================================================
+   PYTHON VALUE -> FLUX BINARY (FUSED ENCODER)
+   ============================================================================ */
+
+/*
+ * Writes FLUX binary straight from Python objects, with no intermediate
+ * crous_value tree. Output is byte-identical to pyobj_to_crous_with_default()
+ * followed by flux_encode_binary_opts(). With out set, buf is a fixed block flushed to
+ * the stream as it fills; with bytes set, buf is the body of a bytes object
+ * that grows in place and is trimmed to size at the end; with neither, buf
+ * is a heap buffer an encoder session keeps between calls, or, with
+ * borrowed set, a caller buffer that moves to the heap if it fills up.
+ */
+typedef struct {
+    PyObject *bytes;            /* Output object (memory target) */
+    crous_output_stream *out;   /* Stream target, or NULL */
+    uint8_t *buf;
+    size_t pos;
+    size_t cap;
+    registry_snapshot *registry;    /* A session's, or NULL for one per call */
+    PyObject *key_table;        /* Wire v3: {key: table index}, else NULL */
+    int columnar;               /* Wire v4: write qualifying lists as tables */
+    size_t flushed;             /* Bytes already handed to out before buf[0] */
+    const flux_dictionary_t *dict;  /* Keys ahead of key_table's, or NULL */
+    int borrowed;               /* buf is caller memory: copy it out to grow */
+    int max_depth;              /* Values must sit above this depth */
+    int tables;                 /* Tables being written, each through a nested call */
+} py_flux_writer;
+
+#define PY_FLUX_WRITER_INITIAL 256
+
+static crous_err_t py_flux_flush(py_flux_writer *w) {
+    if (w->pos == 0) return CROUS_OK;
+    if (w->out->write(w->out->user_data, w->buf, w->pos) != w->pos)
+        return CROUS_ERR_STREAM;
+    w->flushed += w->pos;
+    w->pos = 0;
+    return CROUS_OK;
+}
+
+/* Make room for len more bytes: flush a stream block or grow the bytes */
+static crous_err_t py_flux_make_room(py_flux_writer *w, size_t len) {
+    if (w->out) return py_flux_flush(w);
+    
+    size_t new_cap = w->cap ? w->cap * 2 : PY_FLUX_WRITER_INITIAL;
+    while (new_cap - w->pos < len) {
+        if (new_cap > (size_t)PY_SSIZE_T_MAX / 2) return CROUS_ERR_OOM;
+        new_cap *= 2;
+    }
+    if (w->borrowed) {
+        uint8_t *buf = malloc(new_cap);
+        if (!buf) return CROUS_ERR_OOM;
+        memcpy(buf, w->buf, w->pos);
+        w->buf = buf;
+        w->borrowed = 0;
+    } else if (!w->bytes) {
+        uint8_t *buf = realloc(w->buf, new_cap);
+        if (!buf) return CROUS_ERR_OOM;
+        w->buf = buf;
+    } else {
+        if (_PyBytes_Resize(&w->bytes, (Py_ssize_t)new_cap) < 0) return CROUS_ERR_OOM;
+        w->buf = (uint8_t *)PyBytes_AS_STRING(w->bytes);
+    }
+    w->cap = new_cap;
+    return CROUS_OK;
+}
+
+/* Pointer to len writable bytes (len must be below one stream block) */
+static inline uint8_t *py_flux_reserve(py_flux_writer *w, size_t len, crous_err_t *err) {
+    if (len > w->cap - w->pos) {
+        *err = py_flux_make_room(w, len);
+        if (*err != CROUS_OK) return NULL;
+    }
+    return w->buf + w->pos;
+}
+
+static crous_err_t py_flux_write(py_flux_writer *w, const void *data, size_t len) {
+    if (len > w->cap - w->pos) {
+        crous_err_t err = py_flux_make_room(w, len);
+        if (err != CROUS_OK) return err;
+        /* Payloads of a whole block or more go straight to the stream */
+        if (w->out && len >= w->cap) {
+            if (w->out->write(w->out->user_data, data, len) != len)
+                return CROUS_ERR_STREAM;
+            w->flushed += len;
+            return CROUS_OK;
+        }
+    }
+    memcpy(w->buf + w->pos, data, len);
+    w->pos += len;
+    return CROUS_OK;
+}
+
+/* Tag byte alone */
+static crous_err_t py_flux_write_tag(py_flux_writer *w, uint8_t tag) {
+    crous_err_t err = CROUS_OK;
+    uint8_t *p = py_flux_reserve(w, 1, &err);
+    if (!p) return err;
+    *p = tag;
+    w->pos++;
+    return CROUS_OK;
+}
+
+/* Tag byte followed by a varint (int value, length, count or tag number) */
+static crous_err_t py_flux_write_head(py_flux_writer *w, uint8_t tag, uint64_t val) {
+    crous_err_t err = CROUS_OK;
+    uint8_t *p = py_flux_reserve(w, 1 + CROUS_VARINT_MAX, &err);
+    if (!p) return err;
+    *p++ = tag;
+    w->pos = (size_t)(crous_varint_put(p, val) - w->buf);
+    return CROUS_OK;
+}
+
+/* Length-prefixed payload, optionally preceded by a tag byte */
+static crous_err_t py_flux_write_span(py_flux_writer *w, int tag, const void *data, size_t len) {
+    crous_err_t err = CROUS_OK;
+    uint8_t *p = py_flux_reserve(w, 1 + CROUS_VARINT_MAX, &err);
+    if (!p) return err;
+    if (tag >= 0) *p++ = (uint8_t)tag;
+    w->pos = (size_t)(crous_varint_put(p, len) - w->buf);
+    return py_flux_write(w, data, len);
+}
+
+/* Dict key: literal, or with a key table a back-reference to its first use */
+static crous_err_t py_flux_write_key(py_flux_writer *w, PyObject *key, const char *kdata, size_t klen) {
+    if (!w->key_table) return py_flux_write_span(w, -1, kdata, klen);
+    
+    /* Dictionary keys are matched by their bytes, as flux_serializer.c does */
+    size_t dict_index;
+    if (w->dict && flux_dictionary_find_key(w->dict, kdata, klen, &dict_index)) {
+        crous_err_t err = CROUS_OK;
+        uint8_t *p = py_flux_reserve(w, CROUS_VARINT_MAX, &err);
+        if (!p) return err;
+        w->pos = (size_t)(crous_varint_put(p, ((uint64_t)dict_index << 1) | 1) - w->buf);
+        return CROUS_OK;
+    }
+    
+    /* str subclasses may redefine equality, so only exact str keys are shared */
+    int shareable = PyUnicode_CheckExact(key);
+    if (shareable) {
+        PyObject *index = PyDict_GetItemWithError(w->key_table, key);
+        if (index) {
+            crous_err_t err = CROUS_OK;
+            uint8_t *p = py_flux_reserve(w, CROUS_VARINT_MAX, &err);
+            if (!p) return err;
+            w->pos = (size_t)(crous_varint_put(p, ((uint64_t)PyLong_AsSize_t(index) << 1) | 1) - w->buf);
+            return CROUS_OK;
+        }
+        if (PyErr_Occurred()) return CROUS_ERR_ENCODE;
+    }
+    
+    Py_ssize_t count = (Py_ssize_t)flux_dictionary_key_count(w->dict) + PyDict_GET_SIZE(w->key_table);
+    if (shareable && count < FLUX_KEY_TABLE_MAX) {
+        PyObject *index = PyLong_FromSsize_t(count);
+        if (!index) return CROUS_ERR_OOM;
+        int rc = PyDict_SetItem(w->key_table, key, index);
+        Py_DECREF(index);
+        if (rc < 0) return CROUS_ERR_ENCODE;
+    }
+    
+    crous_err_t err = CROUS_OK;
+    uint8_t *p = py_flux_reserve(w, CROUS_VARINT_MAX, &err);
+    if (!p) return err;
+    w->pos = (size_t)(crous_varint_put(p, (uint64_t)klen << 1) - w->buf);
+    return py_flux_write(w, kdata, klen);
+}
+
+static crous_err_t pyobj_to_flux(py_flux_writer *w, PyObject *obj, PyObject *default_func, int depth);
+
+/* Try custom serializers / default_func. Returns CROUS_OK with *handled = 0
+ * when obj has none; otherwise writes the tag of a tagged value and sets
+ * *inner to the serializer's output, to be written as its value without
+ * default_func, as in the tree path. */
+static crous_err_t custom_to_flux(py_flux_writer *w, PyObject *obj, PyObject *default_func, int *handled,
+                                  PyObject **inner) {
+    uint32_t tag = 0;
+    PyObject *result = call_custom_serializer(obj, default_func, w->registry, &tag, handled);
+    if (!result) return *handled ? CROUS_ERR_ENCODE : CROUS_OK;
+    
+    crous_err_t err = py_flux_write_head(w, FLUX_TAG_TAGGED, tag);
+    if (err != CROUS_OK) {
+        Py_DECREF(result);
+        return err;
+    }
+    *inner = result;
+    return CROUS_OK;
+}
+
+/* Native encodings of standard library types, as stdtype_to_crous() */
+static crous_err_t stdtype_to_flux(py_flux_writer *w, PyObject *obj, int *handled) {
+    py_stdtype st;
+    int rc = stdtype_encode(obj, w->registry, &st);
+    *handled = rc != 0;
+    if (rc <= 0) {
+        stdtype_clear(&st);
+        return rc < 0 ? CROUS_ERR_ENCODE : CROUS_OK;
+    }
+    
+    crous_err_t err = py_flux_write_head(w, FLUX_TAG_TAGGED, st.tag);
+    if (err == CROUS_OK) {
+        if (st.data) {
+            err = py_flux_write_span(w, FLUX_TAG_BYTES, st.data, st.len);
+        } else if (st.pair) {
+            err = py_flux_write_head(w, FLUX_TAG_LIST, 2);
+            if (err == CROUS_OK) err = py_flux_write_head(w, FLUX_TAG_INT, crous_zigzag_encode(st.a));
+            if (err == CROUS_OK) err = py_flux_write_head(w, FLUX_TAG_INT, crous_zigzag_encode(st.b));
+        } else {
+            err = py_flux_write_head(w, FLUX_TAG_INT, crous_zigzag_encode(st.a));
+        }
+    }
+    stdtype_clear(&st);
+    return err;
+}
+
+/*
+ * Wire v4 tables. The list is snapshotted up front (one reference per key
+ * and cell), so default_func mutating the rows can't break the layout.
+ * Column kinds follow the types pyobj_to_flux() would write, so output
+ * matches flux_encode_binary_opts() on the equivalent tree.
+ */
+typedef struct {
+    Py_ssize_t rows;
+    Py_ssize_t cols;
+    PyObject **keys;            /* cols keys of the first row */
+    PyObject **cells;           /* rows x cols, row-major */
+} py_flux_table;
+
+static void py_table_release(py_flux_table *t) {
+    if (t->keys) {
+        for (Py_ssize_t c = 0; c < t->cols; c++) Py_XDECREF(t->keys[c]);
+        PyMem_Free(t->keys);
+    }
+    if (t->cells) {
+        for (Py_ssize_t i = 0; i < t->rows * t->cols; i++) Py_XDECREF(t->cells[i]);
+        PyMem_Free(t->cells);
+    }
+}
+
+/* Snapshot list obj into t if every row is a dict with the same str keys
+ * in the same order. Returns 1 if so, 0 if not a table, -1 on error. */
+static int py_table_collect(PyObject *obj, py_flux_table *t) {
+    Py_ssize_t rows = PyList_GET_SIZE(obj);
+    if (rows < FLUX_TABLE_MIN_ROWS) return 0;
+    
+    PyObject *first = PyList_GET_ITEM(obj, 0);
+    if (!PyDict_Check(first) || PyDict_GET_SIZE(first) == 0) return 0;
+    Py_ssize_t cols = PyDict_GET_SIZE(first);
+    
+    for (Py_ssize_t r = 1; r < rows; r++) {
+        PyObject *row = PyList_GET_ITEM(obj, r);
+        if (!PyDict_Check(row) || PyDict_GET_SIZE(row) != cols) return 0;
+    }
+    
+    t->rows = rows;
+    t->cols = cols;
+    t->keys = PyMem_Calloc((size_t)cols, sizeof(PyObject *));
+    t->cells = PyMem_Calloc((size_t)(rows * cols), sizeof(PyObject *));
+    if (!t->keys || !t->cells) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    
+    PyObject *key, *value;
+    Py_ssize_t pos = 0, c = 0;
+    while (PyDict_Next(first, &pos, &key, &value)) {
+        if (!PyUnicode_Check(key)) return 0;
+        Py_INCREF(key);
+        t->keys[c++] = key;
+    }
+    
+    for (Py_ssize_t r = 0; r < rows; r++) {
+        PyObject *row = PyList_GET_ITEM(obj, r);
+        pos = 0;
+        c = 0;
+        while (PyDict_Next(row, &pos, &key, &value)) {
+            if (key != t->keys[c] &&
+                (!PyUnicode_Check(key) || PyUnicode_Compare(key, t->keys[c]) != 0)) {
+                return 0;
+            }
+            Py_INCREF(value);
+            t->cells[r * cols + c++] = value;
+        }
+    }
+    return 1;
+}
+
+/* FLUX_COLUMN_* pyobj_to_flux() gives cell, or FLUX_COLUMN_ANY */
+static uint8_t py_cell_kind(PyObject *cell) {
+    if (PyBool_Check(cell)) return FLUX_COLUMN_BOOL;
+    if (PyLong_Check(cell)) {
+        int overflow = 0;
+        PyLong_AsLongLongAndOverflow(cell, &overflow);
+        return overflow ? FLUX_COLUMN_ANY : FLUX_COLUMN_INT;
+    }
+    if (PyFloat_Check(cell)) return FLUX_COLUMN_FLOAT;
+    if (PyUnicode_Check(cell)) return FLUX_COLUMN_STRING;
+    return FLUX_COLUMN_ANY;
+}
+
+/* Same choice as table_column_kind() in flux_serializer.c */
+static uint8_t py_column_kind(const py_flux_table *t, Py_ssize_t col) {
+    uint8_t kind = py_cell_kind(t->cells[col]);
+    if (kind == FLUX_COLUMN_ANY) return kind;
+    
+    for (Py_ssize_t r = 1; r < t->rows; r++) {
+        if (py_cell_kind(t->cells[r * t->cols + col]) != kind) return FLUX_COLUMN_ANY;
+    }
+    
+    if (kind == FLUX_COLUMN_INT) {
+        size_t plain = 0, delta = 0;
+        int64_t prev = 0;
+        for (Py_ssize_t r = 0; r < t->rows; r++) {
+            int64_t val = PyLong_AsLongLong(t->cells[r * t->cols + col]);
+            plain += crous_varint_size(crous_zigzag_encode(val));
+            delta += crous_varint_size(crous_zigzag_encode((int64_t)((uint64_t)val - (uint64_t)prev)));
+            prev = val;
+        }
+        if (delta < plain) kind = FLUX_COLUMN_INT_DELTA;
+    }
+    return kind;
+}
+
+static crous_err_t py_column_to_flux(py_flux_writer *w, const py_flux_table *t, Py_ssize_t col,
+                                     PyObject *default_func, int depth) {
+    uint8_t kind = py_column_kind(t, col);
+    crous_err_t err = py_flux_write(w, &kind, 1);
+    if (err != CROUS_OK) return err;
+    
+    if (kind == FLUX_COLUMN_BOOL) {
+        for (Py_ssize_t r = 0; r < t->rows; r += 8) {
+            uint8_t bits = 0;
+            for (Py_ssize_t i = 0; i < 8 && r + i < t->rows; i++) {
+                if (t->cells[(r + i) * t->cols + col] == Py_True) bits |= (uint8_t)(1u << i);
+            }
+            err = py_flux_write(w, &bits, 1);
+            if (err != CROUS_OK) return err;
+        }
+        return CROUS_OK;
+    }
+    
+    int64_t prev = 0;
+    for (Py_ssize_t r = 0; r < t->rows; r++) {
+        PyObject *cell = t->cells[r * t->cols + col];
+        
+        switch (kind) {
+            case FLUX_COLUMN_INT:
+            case FLUX_COLUMN_INT_DELTA: {
+                int64_t val = PyLong_AsLongLong(cell);
+                uint64_t zz = kind == FLUX_COLUMN_INT ? crous_zigzag_encode(val)
+                                                      : crous_zigzag_encode((int64_t)((uint64_t)val - (uint64_t)prev));
+                prev = val;
+                uint8_t *p = py_flux_reserve(w, CROUS_VARINT_MAX, &err);
+                if (!p) return err;
+                w->pos = (size_t)(crous_varint_put(p, zz) - w->buf);
+                break;
+            }
+            case FLUX_COLUMN_FLOAT: {
+                double val = PyFloat_AS_DOUBLE(cell);
+                err = py_flux_write(w, &val, 8);
+                break;
+            }
+            case FLUX_COLUMN_STRING: {
+                Py_ssize_t len;
+                const char *data = PyUnicode_AsUTF8AndSize(cell, &len);
+                if (!data) return CROUS_ERR_ENCODE;
+                err = py_flux_write_span(w, -1, data, (size_t)len);
+                break;
+            }
+            default:
+                err = pyobj_to_flux(w, cell, default_func, depth + 2);
+                break;
+        }
+        if (err != CROUS_OK) return err;
+    }
+    return CROUS_OK;
+}
+
+/* Rows sit at depth + 1, as in the list of dicts */
+static crous_err_t py_table_to_flux(py_flux_writer *w, const py_flux_table *t, PyObject *default_func, int depth) {
+    crous_err_t err = py_flux_write_head(w, FLUX_TAG_TABLE, (uint64_t)t->rows);
+    if (err != CROUS_OK) return err;
+    
+    uint8_t *p = py_flux_reserve(w, CROUS_VARINT_MAX, &err);
+    if (!p) return err;
+    w->pos = (size_t)(crous_varint_put(p, (uint64_t)t->cols) - w->buf);
+    
+    for (Py_ssize_t c = 0; c < t->cols; c++) {
+        Py_ssize_t klen;
+        const char *kdata = PyUnicode_AsUTF8AndSize(t->keys[c], &klen);
+        if (!kdata) return CROUS_ERR_ENCODE;
+        err = py_flux_write_key(w, t->keys[c], kdata, (size_t)klen);
+        if (err != CROUS_OK) return err;
+    }
+    
+    w->tables++;
+    for (Py_ssize_t c = 0; c < t->cols && err == CROUS_OK; c++) {
+        err = py_column_to_flux(w, t, c, default_func, depth);
+    }
+    w->tables--;
+    return err;
+}
+
+/* List obj as a table if it qualifies; *handled says whether it did */
+static crous_err_t list_to_flux_table(py_flux_writer *w, PyObject *obj, PyObject *default_func, int depth,
+                                      int *handled) {
+    py_flux_table t = { 0, 0, NULL, NULL };
+    int rc = py_table_collect(obj, &t);
+    *handled = rc != 0;
+    
+    crous_err_t err = rc < 0 ? CROUS_ERR_OOM : CROUS_OK;
+    if (rc > 0) err = py_table_to_flux(w, &t, default_func, depth);
+    py_table_release(&t);
+    return err;
+}
+
+/* Numeric buffer as a packed array (layout in crous_flux.h), or as bytes.
+ * Sets *handled = 0 and writes nothing for other buffers. */
+static crous_err_t buffer_to_flux(py_flux_writer *w, PyObject *obj, int *handled) {
+    Py_buffer view;
+    int is_signed;
+    py_buf_kind kind = py_buffer_open(obj, &view, &is_signed);
+    
+    *handled = kind != PY_BUF_NONE;
+    if (!*handled) return CROUS_OK;
+    
+    size_t n = (size_t)(view.len / view.itemsize);
+    crous_err_t err = CROUS_OK;
+    
+    if (kind == PY_BUF_BYTES) {
+        err = py_flux_write_span(w, FLUX_TAG_BYTES, view.buf, n);
+        PyBuffer_Release(&view);
+        return err;
+    }
+    
+    uint8_t *p = py_flux_reserve(w, 1 + CROUS_VARINT_MAX + 1 + FLUX_ARRAY_ALIGN, &err);
+    if (p) {
+        uint8_t *start = p;
+        *p++ = kind == PY_BUF_I64 ? FLUX_TAG_I64_ARRAY : FLUX_TAG_F64_ARRAY;
+        p = crous_varint_put(p, n);
+        size_t at = w->flushed + w->pos + (size_t)(p - start) + 1;
+        size_t pad = (FLUX_ARRAY_ALIGN - at % FLUX_ARRAY_ALIGN) % FLUX_ARRAY_ALIGN;
+        *p++ = (uint8_t)pad;
+        memset(p, 0, pad);
+        w->pos += (size_t)(p - start) + pad;
+        
+        if (view.itemsize == 8) {
+            err = py_flux_write(w, view.buf, n * 8);
+        } else {
+            /* Widen through a small block rather than a full-size copy */
+            uint64_t block[512];
+            for (size_t i = 0; i < n && err == CROUS_OK; i += 512) {
+                size_t m = n - i < 512 ? n - i : 512;
+                py_buffer_widen(&view, kind, is_signed, i, m, block);
+                err = py_flux_write(w, block, m * 8);
+            }
+        }
+    }
+    
+    PyBuffer_Release(&view);
+    return err;
+}
+
+/* One open list, tuple or dict of the encoder */
+typedef struct {
+    PyObject *obj;              /* Owned, so default_func can't free it under us */
+    PyObject *default_func;     /* For its items; NULL below a custom serializer's output */
+    Py_ssize_t pos;             /* Next list index, or the PyDict_Next() position */
+    Py_ssize_t size;            /* Length written in the head */
+    Py_ssize_t count;           /* Dict entries written so far */
+    int depth;
+} py_flux_frame;
+
+/*
+ * Write obj at depth, or as much of it as is written in place: scalars
+ * whole, lists, tuples and dicts as their head (*open set), values that
+ * encode as a tagged value as their tag, with *inner (a new reference) to
+ * be written as its value and *default_func updated for it.
+ */
+static crous_err_t pyobj_head_to_flux(py_flux_writer *w, PyObject *obj, PyObject **default_func, int depth,
+                                      PyObject **inner, int *open) {
+    int handled = 0;
+    crous_err_t err;
+    
+    /* None */
+    if (obj == Py_None) {
+        return py_flux_write_tag(w, FLUX_TAG_NULL);
+    }
+    
+    /* Booleans (must check before int since bool is subclass of int) */
+    if (PyBool_Check(obj)) {
+        return py_flux_write_tag(w, obj == Py_True ? FLUX_TAG_TRUE : FLUX_TAG_FALSE);
+    }
+    
+    /* Integers, zigzag encoded */
+    if (PyLong_Check(obj)) {
+        int overflow = 0;
+        long long val = PyLong_AsLongLongAndOverflow(obj, &overflow);
+        
+        if (overflow != 0) {
+            /* Value doesn't fit in long long, try custom serializer or fail */
+            err = custom_to_flux(w, obj, *default_func, &handled, inner);
+            if (handled) {
+                *default_func = NULL;
+                return err;
+            }
+            
+            PyErr_SetString(CrousEncodeError, "Integer value too large to serialize");
+            return CROUS_ERR_OVERFLOW;
+        }
+        
+        if (val == -1 && PyErr_Occurred()) return CROUS_ERR_ENCODE;
+        
+        return py_flux_write_head(w, FLUX_TAG_INT, crous_zigzag_encode(val));
+    }
+    
+    /* Floats */
+    if (PyFloat_Check(obj)) {
+        double val = PyFloat_AS_DOUBLE(obj);
+        crous_err_t rerr = CROUS_OK;
+        uint8_t *p = py_flux_reserve(w, 9, &rerr);
+        if (!p) return rerr;
+        p[0] = FLUX_TAG_FLOAT;
+        memcpy(p + 1, &val, 8);
+        w->pos += 9;
+        return CROUS_OK;
+    }
+    
+    /* Strings */
+    if (PyUnicode_Check(obj)) {
+        Py_ssize_t len;
+        const char *data = PyUnicode_AsUTF8AndSize(obj, &len);
+        if (!data) return CROUS_ERR_ENCODE;
+        return py_flux_write_span(w, FLUX_TAG_STRING, data, (size_t)len);
+    }
+    
+    /* Bytes */
+    if (PyBytes_Check(obj)) {
+        return py_flux_write_span(w, FLUX_TAG_BYTES, PyBytes_AS_STRING(obj),
+                                  (size_t)PyBytes_GET_SIZE(obj));
+    }
+    
+    /* Bytearray */
+    if (PyByteArray_Check(obj)) {
+        return py_flux_write_span(w, FLUX_TAG_BYTES, PyByteArray_AS_STRING(obj),
+                                  (size_t)PyByteArray_GET_SIZE(obj));
+    }
+    
+    /* Lists */
+    if (PyList_Check(obj)) {
+        if (w->columnar && w->tables < FLUX_TABLE_MAX_NESTING) {
+            err = list_to_flux_table(w, obj, *default_func, depth, &handled);
+            if (handled) return err;
+        }
+        *open = 1;
+        return py_flux_write_head(w, FLUX_TAG_LIST, (uint64_t)PyList_GET_SIZE(obj));
+    }
+    
+    /* Tuples */
+    if (PyTuple_Check(obj)) {
+        *open = 1;
+        return py_flux_write_head(w, FLUX_TAG_TUPLE, (uint64_t)PyTuple_GET_SIZE(obj));
+    }
+    
+    /* Dictionaries */
+    if (PyDict_Check(obj)) {
+        *open = 1;
+        return py_flux_write_head(w, FLUX_TAG_DICT, (uint64_t)PyDict_GET_SIZE(obj));
+    }
+    
+    /* Sets - list wrapped in tag 90 (set) or 91 (frozenset) */
+    if (PySet_Check(obj) || PyFrozenSet_Check(obj)) {
+        err = custom_to_flux(w, obj, *default_func, &handled, inner);
+        if (handled) {
+            *default_func = NULL;
+            return err;
+        }
+        
+        PyObject *as_list = PySequence_List(obj);
+        if (!as_list) return CROUS_ERR_ENCODE;
+        
+        err = py_flux_write_head(w, FLUX_TAG_TAGGED, PyFrozenSet_Check(obj) ? 91 : 90);
+        if (err != CROUS_OK) {
+            Py_DECREF(as_list);
+            return err;
+        }
+        *inner = as_list;
+        return CROUS_OK;
+    }
+    
+    /* datetime, date, time, Decimal and UUID */
+    err = stdtype_to_flux(w, obj, &handled);
+    if (handled) return err;
+    
+    /* Try custom serializer for unsupported types */
+    err = custom_to_flux(w, obj, *default_func, &handled, inner);
+    if (handled) {
+        *default_func = NULL;
+        return err;
+    }
+    
+    /* Numeric buffers as packed arrays */
+    err = buffer_to_flux(w, obj, &handled);
+    if (handled) return err;
+    
+    /* Unsupported type */
+    PyErr_Format(CrousEncodeError, "Unsupported type for encoding: %s", 
+                 Py_TYPE(obj)->tp_name);
+    return CROUS_ERR_INVALID_TYPE;
+}
+
+/*
+ * obj at depth, without recursion: lists, tuples and dicts write their
+ * head and go on a work stack, and each turn of the loop writes the next
+ * item of the innermost one. Tables are written through a nested call per
+ * table, at most FLUX_TABLE_MAX_NESTING deep. Past w->max_depth, which a
+ * reference cycle always reaches, encoding fails.
+ */
+static crous_err_t pyobj_to_flux(py_flux_writer *w, PyObject *obj, PyObject *default_func, int depth) {
+    py_flux_frame local[CROUS_STACK_INLINE];
+    py_flux_frame *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+    crous_err_t err = CROUS_OK;
+    
+    Py_INCREF(obj);
+    for (;;) {
+        if (depth >= w->max_depth) {
+            PyErr_Format(CrousEncodeError,
+                         "maximum nesting depth of %d exceeded (a container that contains itself?)",
+                         w->max_depth);
+            err = CROUS_ERR_DEPTH_EXCEEDED;
+            break;
+        }
+        
+        PyObject *inner = NULL;
+        int open = 0;
+        err = pyobj_head_to_flux(w, obj, &default_func, depth, &inner, &open);
+        if (err != CROUS_OK) break;
+        
+        if (inner) {
+            /* A tagged value's inner value takes its place */
+            Py_DECREF(obj);
+            obj = inner;
+            depth++;
+            continue;
+        }
+        
+        if (open) {
+            if (top == cap) {
+                py_flux_frame *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+                if (!grown) {
+                    PyErr_NoMemory();
+                    err = CROUS_ERR_OOM;
+                    break;
+                }
+                stack = grown;
+            }
+            py_flux_frame *f = &stack[top++];
+            f->obj = obj;
+            f->default_func = default_func;
+            f->pos = 0;
+            f->size = PyDict_Check(obj) ? PyDict_GET_SIZE(obj) : Py_SIZE(obj);
+            f->count = 0;
+            f->depth = depth;
+        } else {
+            Py_DECREF(obj);
+        }
+        obj = NULL;
+        
+        /* Next: the next item of the innermost open container */
+        while (top > 0) {
+            py_flux_frame *f = &stack[top - 1];
+            if (PyDict_Check(f->obj)) {
+                PyObject *key, *value;
+                if (PyDict_Next(f->obj, &f->pos, &key, &value)) {
+                    if (!PyUnicode_Check(key)) {
+                        PyErr_SetString(CrousEncodeError, "Dictionary keys must be strings");
+                        err = CROUS_ERR_INVALID_TYPE;
+                        break;
+                    }
+                    Py_ssize_t klen;
+                    const char *kdata = PyUnicode_AsUTF8AndSize(key, &klen);
+                    err = kdata ? py_flux_write_key(w, key, kdata, (size_t)klen) : CROUS_ERR_ENCODE;
+                    if (err != CROUS_OK) break;
+                    f->count++;
+                    Py_INCREF(value);
+                    obj = value;
+                    break;
+                }
+                /* The entry count is already written, so the dict must not have changed */
+                if (f->count != f->size || PyDict_GET_SIZE(f->obj) != f->size) {
+                    PyErr_SetString(PyExc_RuntimeError, "dictionary changed size during iteration");
+                    err = CROUS_ERR_ENCODE;
+                    break;
+                }
+            } else if (f->pos < f->size) {
+                /* default_func may have mutated the container */
+                PyObject *item = PyList_Check(f->obj) ? PyList_GetItem(f->obj, f->pos)
+                                                      : PyTuple_GetItem(f->obj, f->pos);
+                if (!item) {
+                    err = CROUS_ERR_ENCODE;
+                    break;
+                }
+                f->pos++;
+                Py_INCREF(item);
+                obj = item;
+                break;
+            }
+            Py_DECREF(f->obj);
+            top--;
+        }
+        if (!obj) break;
+        
+        default_func = stack[top - 1].default_func;
+        depth = stack[top - 1].depth + 1;
+    }
+    
+    Py_XDECREF(obj);
+    while (top > 0) Py_DECREF(stack[--top].obj);
+    crous_stack_release(stack, local);
+    return err;
+}
+
+/* Header, then obj; opts select the wire version, as in flux_serializer.c */
+static crous_err_t py_flux_write_document(py_flux_writer *w, PyObject *obj, PyObject *default_func,
+                                          const flux_binary_options_t *opts) {
+    const uint8_t header[6] = {
+        FLUX_MAGIC_0, FLUX_MAGIC_1, FLUX_MAGIC_2, FLUX_MAGIC_3,
+        opts->columnar ? FLUX_VERSION_COLUMNAR
+            : opts->key_refs || opts->dictionary ? FLUX_VERSION_KEY_REFS : FLUX_VERSION,
+        0x00
+    };
+    
+    w->columnar = opts->columnar;
+    w->dict = opts->dictionary;
+    w->max_depth = opts->max_depth > 0 ? opts->max_depth : PY_ENCODE_MAX_DEPTH;
+    if (opts->key_refs || opts->columnar || opts->dictionary) {
+        w->key_table = PyDict_New();
+        if (!w->key_table) return CROUS_ERR_OOM;
+    }
+    
+    crous_span span;
+    crous_span_begin(&span, "python_to_flux", CROUS_PHASE_CONVERT,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    size_t start = w->flushed + w->pos;
+    registry_snapshot local = { NULL };
+    registry_snapshot *session = w->registry;
+    if (!session) w->registry = &local;
+    registry_snapshot_take(w->registry);
+    crous_err_t err = py_flux_write(w, header, sizeof(header));
+    if (err == CROUS_OK) err = pyobj_to_flux(w, obj, default_func, 0);
+    registry_snapshot_release(&local);
+    w->registry = session;
+    Py_CLEAR(w->key_table);
+    return crous_span_end(&span, err, err == CROUS_OK ? w->flushed + w->pos - start : 0);
+}
+
+/* Encode obj to a new bytes object, compressing and checksumming on up to
+ * nthreads threads (the walk over obj needs the GIL). Sets a Python
+ * exception on failure. */
+static PyObject* encode_pyobj_to_bytes(PyObject *obj, PyObject *default_func,
+                                       const flux_binary_options_t *opts, int nthreads) {
+    py_flux_writer w = { NULL, NULL, NULL, 0, PY_FLUX_WRITER_INITIAL, NULL, NULL, 0, 0, NULL, 0, 0, 0 };
+    w.bytes = PyBytes_FromStringAndSize(NULL, PY_FLUX_WRITER_INITIAL);
+    if (!w.bytes) return NULL;
+    w.buf = (uint8_t *)PyBytes_AS_STRING(w.bytes);
+    
+    crous_err_t err = py_flux_write_document(&w, obj, default_func, opts);
+    
+    if (err != CROUS_OK) {
+        Py_XDECREF(w.bytes);
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(CrousEncodeError, crous_err_str(err));
+        }
+        return NULL;
+    }
+    
+    if (_PyBytes_Resize(&w.bytes, (Py_ssize_t)w.pos) < 0) return NULL;
+    if (opts->compression == CROUS_CODEC_NONE && !opts->dictionary && !opts->checksum) return w.bytes;
+    
+    /* Compress the finished document into a second object */
+    const uint8_t *doc = (const uint8_t *)PyBytes_AS_STRING(w.bytes);
+    PyObject *packed = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)flux_compress_bound(w.pos));
+    if (!packed) {
+        Py_DECREF(w.bytes);
+        return NULL;
+    }
+    size_t packed_size;
+    Py_BEGIN_ALLOW_THREADS
+    err = flux_compress_binary_into_parallel(doc, w.pos, (crous_codec_t)opts->compression, opts->dictionary,
+                                             opts->checksum ? FLUX_ENVELOPE_CHECKSUM : 0, nthreads,
+                                             (uint8_t *)PyBytes_AS_STRING(packed),
+                                             (size_t)PyBytes_GET_SIZE(packed), &packed_size);
+    Py_END_ALLOW_THREADS
+    Py_DECREF(w.bytes);
+    
+    if (err != CROUS_OK) {
+        Py_DECREF(packed);
+        PyErr_SetString(CrousEncodeError, crous_err_str(err));
+        return NULL;
+    }
+    if (_PyBytes_Resize(&packed, (Py_ssize_t)packed_size) < 0) return NULL;
+    return packed;
+}
+
+/* encode_pyobj_to_bytes() through a crous_value tree. Wire v5 dedup has
+ * to see every subtree before writing the first, which the fused writer
+ * never does. */
+static PyObject* encode_tree_to_bytes(PyObject *obj, PyObject *default_func,
+                                      const flux_binary_options_t *opts, int nthreads) {
+    crous_err_t err = CROUS_OK;
+    crous_value *value = pyobj_to_crous_with_default(obj, default_func, opts->max_depth, &err);
+    if (!value) {
+        if (!PyErr_Occurred()) PyErr_SetString(CrousEncodeError, crous_err_str(err));
+        return NULL;
+    }
+    
+    uint8_t *buf = NULL;
+    size_t size = 0;
+    Py_BEGIN_ALLOW_THREADS
+    err = flux_encode_binary_parallel(value, opts, nthreads, &buf, &size);
+    crous_value_free_tree(value);
+    Py_END_ALLOW_THREADS
+    
+    if (err != CROUS_OK) {
+        PyErr_SetString(CrousEncodeError, crous_err_str(err));
+        return NULL;
+    }
+    PyObject *result = PyBytes_FromStringAndSize((const char *)buf, (Py_ssize_t)size);
+    free(buf);
+    return result;
+}
+
+/* Encode obj into dst[0, cap), as encode_pyobj_to_bytes() would. On
+ * CROUS_ERR_OVERFLOW *out_size is the size needed and no exception is set
+ * (dst may have been partly written); other failures set one. */
+static crous_err_t encode_pyobj_to_buffer(PyObject *obj, PyObject *default_func,
+                                          const flux_binary_options_t *opts, int nthreads,
+                                          uint8_t *dst, size_t cap, size_t *out_size) {
+    int envelope = opts->compression != CROUS_CODEC_NONE || opts->dictionary || opts->checksum;
+    
+    /* A plain document is written straight into dst, an envelope's source
+     * into a heap buffer. One that outgrows dst finishes on the heap so
+     * its size is known without calling default() a second time. Writes
+     * reserve their worst case, so a document that just fits spills too,
+     * and is copied back. */
+    py_flux_writer w = { NULL, NULL, envelope ? NULL : dst, 0, envelope ? 0 : cap,
+                         NULL, NULL, 0, 0, NULL, !envelope, 0, 0 };
+    crous_err_t err = py_flux_write_document(&w, obj, default_func, opts);
+    
+    if (err == CROUS_OK && !w.borrowed && !envelope) {
+        if (w.pos <= cap) memcpy(dst, w.buf, w.pos);
+        else err = CROUS_ERR_OVERFLOW;
+        *out_size = w.pos;
+    } else if (err == CROUS_OK && envelope) {
+        Py_BEGIN_ALLOW_THREADS
+        err = flux_compress_binary_into_parallel(w.buf, w.pos, (crous_codec_t)opts->compression, opts->dictionary,
+                                                 opts->checksum ? FLUX_ENVELOPE_CHECKSUM : 0, nthreads,
+                                                 dst, cap, out_size);
+        if (err == CROUS_ERR_OVERFLOW) {
+            /* Pack it again where it fits to learn its size */
+            uint8_t *tmp = malloc(flux_compress_bound(w.pos));
+            crous_err_t size_err = tmp
+                ? flux_compress_binary_into_parallel(w.buf, w.pos, (crous_codec_t)opts->compression,
+                                                     opts->dictionary, opts->checksum ? FLUX_ENVELOPE_CHECKSUM : 0,
+                                                     nthreads, tmp, flux_compress_bound(w.pos), out_size)
+                : CROUS_ERR_OOM;
+            free(tmp);
+            if (size_err != CROUS_OK) err = size_err;
+        }
+        Py_END_ALLOW_THREADS
+    } else if (err == CROUS_OK) {
+        *out_size = w.pos;
+    }
+    if (!w.borrowed) free(w.buf);
+    
+    if (err != CROUS_OK && err != CROUS_ERR_OVERFLOW && !PyErr_Occurred()) {
+        PyErr_SetString(CrousEncodeError, crous_err_str(err));
+    }
+    return err;
+}
+
+/* ============================================================================
+   ENCODER SESSIONS
+   ============================================================================ */
+
+/*
+ * Buffers a CrousEncoder or FrameWriter keeps between calls. They grow to
+ * fit the largest document, so a stream of similar messages encodes with
+ * no allocation beyond the result; buffers past PY_SESSION_KEEP_MAX are
+ * dropped after use rather than held for the object's lifetime.
+ */
+
+typedef struct {
+    uint8_t *doc;               /* Plain document */
+    size_t doc_cap;
+    uint8_t *packed;            /* Envelope around doc, when options need one */
+    size_t packed_cap;
+    registry_snapshot registry; /* Kept until something is registered */
+    PyThread_type_lock lock;    /* Held by the call using the buffers */
+} py_encode_session;
+
+static int encode_session_init(py_encode_session *session) {
+    session->lock = PyThread_allocate_lock();
+    return session->lock != NULL;
+}
+
+static void encode_session_clear(py_encode_session *session) {
+    free(session->doc);
+    free(session->packed);
+    session->doc = session->packed = NULL;
+    session->doc_cap = session->packed_cap = 0;
+    registry_snapshot_release(&session->registry);
+    if (session->lock) PyThread_free_lock(session->lock);
+    session->lock = NULL;
+}
+
+/* Drop buffers grown past PY_SESSION_KEEP_MAX once their output is used */
+static void encode_session_trim(py_encode_session *session) {
+    if (session->doc_cap > PY_SESSION_KEEP_MAX) {
+        free(session->doc);
+        session->doc = NULL;
+        session->doc_cap = 0;
+    }
+    if (session->packed_cap > PY_SESSION_KEEP_MAX) {
+        free(session->packed);
+        session->packed = NULL;
+        session->packed_cap = 0;
+    }
+}
+
+/* encode_pyobj_to_bytes() into the session's buffers, the caller holding
+ * its lock. *out is valid until the next call. Sets a Python exception on
+ * failure. */
+static crous_err_t encode_pyobj_to_session(PyObject *obj, PyObject *default_func,
+                                           const flux_binary_options_t *opts, int nthreads,
+                                           py_encode_session *session,
+                                           const uint8_t **out, size_t *out_size) {
+    py_flux_writer w = { NULL, NULL, session->doc, 0, session->doc_cap, &session->registry, NULL, 0, 0, NULL, 0, 0, 0 };
+    crous_err_t err = py_flux_write_document(&w, obj, default_func, opts);
+    session->doc = w.buf;
+    session->doc_cap = w.cap;
+    
+    if (err == CROUS_OK && (opts->compression != CROUS_CODEC_NONE || opts->dictionary || opts->checksum)) {
+        size_t bound = flux_compress_bound(w.pos);
+        if (bound > session->packed_cap) {
+            uint8_t *packed = realloc(session->packed, bound);
+            if (!packed) {
+                PyErr_NoMemory();
+                return CROUS_ERR_OOM;
+            }
+            session->packed = packed;
+            session->packed_cap = bound;
+        }
+        Py_BEGIN_ALLOW_THREADS
+        err = flux_compress_binary_into_parallel(session->doc, w.pos, (crous_codec_t)opts->compression,
+                                                 opts->dictionary, opts->checksum ? FLUX_ENVELOPE_CHECKSUM : 0,
+                                                 nthreads, session->packed, session->packed_cap, out_size);
+        Py_END_ALLOW_THREADS
+        *out = session->packed;
+    } else {
+        *out = session->doc;
+        *out_size = w.pos;
+    }
+    
+    if (err != CROUS_OK && !PyErr_Occurred()) {
+        PyErr_SetString(CrousEncodeError, crous_err_str(err));
+    }
+    return err;
+}
+
+/* Encode obj to fp.write() in fixed-size blocks. Sets a Python exception
+ * on failure. */
+static crous_err_t encode_pyobj_to_pyfile(PyObject *obj, PyObject *default_func, PyObject *fp,
+                                          const flux_binary_options_t *opts) {
+    PyObject *write_method = PyObject_GetAttrString(fp, "write");
+    if (!write_method) {
+        PyErr_SetString(PyExc_TypeError, "fp must have a write() method");
+        return CROUS_ERR_STREAM;
+    }
+    
+    py_write_stream_state state = { write_method, 0 };
+    crous_output_stream out = { &state, py_write_stream };
+    py_flux_writer w = { NULL, &out, NULL, 0, CROUS_STREAM_CHUNK_SIZE, NULL, NULL, 0, 0, NULL, 0, 0, 0 };
+    
+    /* Compressed: blocks go through the envelope writer on their way to fp */
+    flux_compress_stream_t *packer = NULL;
+    crous_err_t err = CROUS_OK;
+    if (opts->compression != CROUS_CODEC_NONE || opts->dictionary || opts->checksum) {
+        err = flux_compress_stream_new(&out, (crous_codec_t)opts->compression, opts->dictionary,
+                                       opts->checksum ? FLUX_ENVELOPE_CHECKSUM : 0, &packer);
+        if (err == CROUS_OK) w.out = flux_compress_stream_input(packer);
+    }
+    
+    if (err == CROUS_OK) {
+        w.buf = malloc(CROUS_STREAM_CHUNK_SIZE);
+        err = CROUS_ERR_OOM;
+    }
+    if (w.buf) {
+        err = py_flux_write_document(&w, obj, default_func, opts);
+        if (err == CROUS_OK) err = py_flux_flush(&w);
+        free(w.buf);
+    }
+    if (packer) {
+        if (err == CROUS_OK) err = flux_compress_stream_finish(packer);
+        else flux_compress_stream_free(packer);
+    }
+    Py_DECREF(write_method);
+    
+    if (err != CROUS_OK && !PyErr_Occurred()) {
+        PyErr_SetString(CrousEncodeError, crous_err_str(err));
+    }
+    return err;
+}
+
+/*
+ * PyArg "O&" converter for compression=: None or a codec name to an int
+ * crous_codec_t. Names this build has no codec for are a ValueError.
+ */
+static int compression_converter(PyObject *obj, void *addr) {
+    int *codec = (int *)addr;
+    if (obj == Py_None) {
+        *codec = CROUS_CODEC_NONE;
+        return 1;
+    }
+    if (!PyUnicode_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "compression must be a codec name or None, not %s", Py_TYPE(obj)->tp_name);
+        return 0;
+    }
+    
+    const char *name = PyUnicode_AsUTF8(obj);
+    if (!name) return 0;
+    for (int c = CROUS_CODEC_NONE; crous_codec_name((crous_codec_t)c); c++) {
+        if (strcmp(name, crous_codec_name((crous_codec_t)c)) != 0) continue;
+        if (!crous_codec_available((crous_codec_t)c)) {
+            PyErr_Format(PyExc_ValueError, "compression '%s' is not available in this build", name);
+            return 0;
+        }
+        *codec = c;
+        return 1;
+    }
+    PyErr_Format(PyExc_ValueError, "unknown compression '%s' (expected 'lz4', 'none' or None)", name);
+    return 0;
+}
+
+/*
+ * PyArg "O&" converter for max_depth=: None (the default limit, stored as
+ * 0) or a positive int.
+ */
+static int depth_converter(PyObject *obj, void *addr) {
+    int *depth = (int *)addr;
+    if (obj == Py_None) {
+        *depth = 0;
+        return 1;
+    }
+    if (!PyLong_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "max_depth must be an int or None, not %s", Py_TYPE(obj)->tp_name);
+        return 0;
+    }
+    
+    int overflow;
+    long val = PyLong_AsLongAndOverflow(obj, &overflow);
+    if (val == -1 && PyErr_Occurred()) return 0;
+    if (overflow > 0 || val > INT_MAX) val = INT_MAX;
+    if (overflow < 0 || val < 1) {
+        PyErr_SetString(PyExc_ValueError, "max_depth must be positive");
+        return 0;
+    }
+    *depth = (int)val;
+    return 1;
+}
+
+/*
+ * PyArg "O&" converter for dictionary=: None or the id of a registered
+ * dictionary to its flux_dictionary_t.
+ */
+static int dictionary_converter(PyObject *obj, void *addr) {
+    const flux_dictionary_t **dict = (const flux_dictionary_t **)addr;
+    if (obj == Py_None) {
+        *dict = NULL;
+        return 1;
+    }
+    if (!PyLong_Check(obj) || PyBool_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "dictionary must be a dictionary id or None, not %s", Py_TYPE(obj)->tp_name);
+        return 0;
+    }
+    
+    unsigned long id = PyLong_AsUnsignedLong(obj);
+    if (id == (unsigned long)-1 && PyErr_Occurred()) {
+        PyErr_Clear();
+        id = 0;
+    }
+    *dict = id && id <= FLUX_DICTIONARY_ID_MAX ? flux_dictionary_lookup((uint32_t)id) : NULL;
+    if (!*dict) {
+        PyErr_Format(PyExc_ValueError, "dictionary %R is not registered", obj);
+        return 0;
+    }
+    return 1;
+}
+
+/* ============================================================================
+   CROUSENCODER CLASS
+   ============================================================================ */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *default_func;
+    int allow_custom;
+    flux_binary_options_t opts;
+    py_encode_session session;      /* Kept across encode() calls */
+} CrousEncoderObject;
+
+static void CrousEncoder_dealloc(CrousEncoderObject *self) {
+    Py_XDECREF(self->default_func);
+    encode_session_clear(&self->session);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject* CrousEncoder_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    CrousEncoderObject *self = (CrousEncoderObject *)type->tp_alloc(type, 0);
+    if (self) {
+        self->default_func = NULL;
+        self->allow_custom = 1;
+        self->opts = flux_binary_options_default();
+        if (!encode_session_init(&self->session)) {
+            Py_DECREF(self);
+            return PyErr_NoMemory();
+        }
+    }
+    return (PyObject *)self;
+}
+
+static int CrousEncoder_init(CrousEncoderObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"default", "allow_custom", "key_refs", "columnar", "compression", "dictionary",
+                             "checksum", NULL};
+    PyObject *default_func = NULL;
+    int allow_custom = 1;
+    flux_binary_options_t opts = flux_binary_options_default();
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OpppO&O&p", kwlist, 
+                                      &default_func, &allow_custom, &opts.key_refs, &opts.columnar,
+                                      compression_converter, &opts.compression,
+                                      dictionary_converter, &opts.dictionary, &opts.checksum)) {
+        return -1;
+    }
+    
+    Py_XINCREF(default_func);
+    Py_XDECREF(self->default_func);
+    self->default_func = default_func;
+    self->allow_custom = allow_custom;
+    self->opts = opts;
+    
+    return 0;
+}
+
+static PyObject* CrousEncoder_encode(CrousEncoderObject *self, PyObject *args) {
+    PyObject *obj;
+    
+    if (!PyArg_ParseTuple(args, "O", &obj)) {
+        return NULL;
+    }
+    
+    /* Buffers stay with the encoder. A concurrent or re-entrant call (from
+     * default) finds them busy and encodes on its own. */
+    if (!PyThread_acquire_lock(self->session.lock, NOWAIT_LOCK)) {
+        return encode_pyobj_to_bytes(obj, self->default_func, &self->opts, 1);
+    }
+    const uint8_t *data;
+    size_t size;
+    PyObject *result = NULL;
+    if (encode_pyobj_to_session(obj, self->default_func, &self->opts, 1, &self->session, &data, &size) == CROUS_OK) {
+        result = PyBytes_FromStringAndSize((const char *)data, (Py_ssize_t)size);
+    }
+    encode_session_trim(&self->session);
+    PyThread_release_lock(self->session.lock);
+    return result;
+}
+
+static PyMethodDef CrousEncoder_methods[] = {
+    {"encode", (PyCFunction)CrousEncoder_encode, METH_VARARGS, 
+     "Encode a Python object to Crous binary format."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject CrousEncoderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous.CrousEncoder",
+    .tp_doc = "Crous encoder class for serializing Python objects to binary format.",
+    .tp_basicsize = sizeof(CrousEncoderObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = CrousEncoder_new,
+    .tp_init = (initproc)CrousEncoder_init,
+    .tp_dealloc = (destructor)CrousEncoder_dealloc,
+    .tp_methods = CrousEncoder_methods,
+};
+
+/* ============================================================================
+   CROUSDECODER CLASS
+   ============================================================================ */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *object_hook;
+    py_key_cache *keys;             /* Kept across decode() calls */
+    py_decode_scratch scratch;      /* Likewise */
+    PyThread_type_lock keys_lock;   /* Held by the decode() using keys and scratch */
+} CrousDecoderObject;
+
+static void CrousDecoder_dealloc(CrousDecoderObject *self) {
+    Py_XDECREF(self->object_hook);
+    if (self->keys) {
+        key_cache_clear(self->keys);
+        PyMem_Free(self->keys);
+    }
+    decode_scratch_clear(&self->scratch);
+    if (self->keys_lock) PyThread_free_lock(self->keys_lock);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject* CrousDecoder_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    CrousDecoderObject *self = (CrousDecoderObject *)type->tp_alloc(type, 0);
+    if (self) {
+        self->object_hook = NULL;
+        self->keys = PyMem_Calloc(1, sizeof(py_key_cache));
+        self->keys_lock = PyThread_allocate_lock();
+        if (!self->keys || !self->keys_lock) {
+            Py_DECREF(self);
+            return PyErr_NoMemory();
+        }
+    }
+    return (PyObject *)self;
+}
+
+static int CrousDecoder_init(CrousDecoderObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"object_hook", NULL};
+    PyObject *object_hook = NULL;
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &object_hook)) {
+        return -1;
+    }
+    
+    Py_XINCREF(object_hook);
+    Py_XDECREF(self->object_hook);
+    self->object_hook = object_hook;
+    
+    return 0;
+}
+
+static PyObject* CrousDecoder_decode(CrousDecoderObject *self, PyObject *args) {
+    Py_buffer data;
+    
+    if (!PyArg_ParseTuple(args, "y*", &data)) {
+        return NULL;
+    }
+    
+    /* Keys and scratch memory stay across calls. A concurrent or re-entrant
+     * call (from object_hook) finds them busy and uses per-call ones instead. */
+    PyObject *result;
+    if (!PyThread_acquire_lock(self->keys_lock, NOWAIT_LOCK)) {
+        result = decode_buffer_to_pyobj(data.buf, (size_t)data.len, self->object_hook, data.readonly);
+    } else {
+        result = decode_buffer_to_pyobj_scratch(data.buf, (size_t)data.len, self->object_hook,
+                                                self->keys, &self->scratch, CROUS_MAX_DEPTH, data.readonly);
+        PyThread_release_lock(self->keys_lock);
+    }
+    PyBuffer_Release(&data);
+    return result;
+}
+
+static PyMethodDef CrousDecoder_methods[] = {
+    {"decode", (PyCFunction)CrousDecoder_decode, METH_VARARGS,
+     "Decode Crous binary data to a Python object."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject CrousDecoderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous.CrousDecoder",
+    .tp_doc = "Crous decoder class for deserializing binary data to Python objects.",
+    .tp_basicsize = sizeof(CrousDecoderObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = CrousDecoder_new,
+    .tp_init = (initproc)CrousDecoder_init,
+    .tp_dealloc = (destructor)CrousDecoder_dealloc,
+    .tp_methods = CrousDecoder_methods,
+};
+
+/* ============================================================================
+   FRAMED LOGS
+   ============================================================================ */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *default_func;
+    flux_binary_options_t opts;
+    py_write_stream_state state;    /* Holds fp.write */
+    crous_output_stream out;
+    crous_frame_writer *writer;     /* NULL once closed */
+    py_encode_session session;      /* Record bodies are encoded here */
+} FrameWriterObject;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *object_hook;
+    py_read_stream_state state;     /* Holds fp.read and fp.readinto */
+    crous_input_stream in;
+    crous_frame_reader *reader;     /* NULL once exhausted */
+    py_key_cache *keys;             /* Shared by all records */
+} FrameIterObject;
+
+/* Raise for a failed frame call unless the file object already did */
+static PyObject* frame_fail(crous_err_t err, PyObject *error_type) {
+    if (!PyErr_Occurred()) PyErr_SetString(error_type, crous_err_str(err));
+    return NULL;
+}
+
+static crous_err_t FrameWriter_release(FrameWriterObject *self) {
+    crous_err_t err = CROUS_OK;
+    if (self->writer) {
+        err = crous_frame_writer_close(self->writer);
+        self->writer = NULL;
+    }
+    Py_CLEAR(self->state.write);
+    return err;
+}
+
+static void FrameWriter_dealloc(FrameWriterObject *self) {
+    if (self->writer) {
+        /* Buffered records still go out, as with a file object */
+        PyObject *type, *value, *tb;
+        PyErr_Fetch(&type, &value, &tb);
+        if (FrameWriter_release(self) != CROUS_OK) {
+            if (!PyErr_Occurred()) PyErr_SetString(CrousEncodeError, "FrameWriter: final flush failed");
+            PyErr_WriteUnraisable(NULL);
+        }
+        PyErr_Restore(type, value, tb);
+    }
+    Py_CLEAR(self->state.write);
+    Py_XDECREF(self->default_func);
+    encode_session_clear(&self->session);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int FrameWriter_init(FrameWriterObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"fp", "default", "checksum", "key_refs", "columnar",
+                             "index", "index_interval", NULL};
+    PyObject *fp;
+    PyObject *default_func = NULL;
+    int checksum = 0;
+    int index = 0;
+    unsigned int interval = 0;
+    flux_binary_options_t opts = flux_binary_options_default();
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OppppI", kwlist, &fp, &default_func,
+                                     &checksum, &opts.key_refs, &opts.columnar, &index, &interval)) {
+        return -1;
+    }
+    if (self->writer) {
+        PyErr_SetString(PyExc_RuntimeError, "FrameWriter is already initialized");
+        return -1;
+    }
+    if (!self->session.lock && !encode_session_init(&self->session)) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    PyObject *write_method = PyObject_GetAttrString(fp, "write");
+    if (!write_method) {
+        PyErr_SetString(PyExc_TypeError, "fp must have a write() method");
+        return -1;
+    }
+
+    /* A file that already has bytes is a log being appended to */
+    unsigned flags = checksum ? CROUS_FRAME_CHECKSUM : 0;
+    long long log_size = 0;
+    PyObject *pos = call_method_quiet(fp, "tell");
+    if (pos) {
+        log_size = PyLong_AsLongLong(pos);
+        Py_DECREF(pos);
+        if (log_size == -1 && PyErr_Occurred()) {
+            PyErr_Clear();
+            log_size = 0;
+        }
+        if (log_size > 0) flags |= CROUS_FRAME_APPEND;
+    }
+
+    self->state.write = write_method;
+    self->state.failed = 0;
+    self->out.user_data = &self->state;
+    self->out.write = py_write_stream;
+    crous_err_t err = crous_frame_writer_new(&self->out, flags, &self->writer);
+    if (err == CROUS_OK && index) {
+        err = crous_frame_writer_set_index(self->writer, (uint32_t)interval, (uint64_t)(log_size > 0 ? log_size : 0));
+    }
+    if (err != CROUS_OK) {
+        FrameWriter_release(self);
+        frame_fail(err, CrousEncodeError);
+        return -1;
+    }
+
+    Py_XINCREF(default_func);
+    Py_XDECREF(self->default_func);
+    self->default_func = default_func;
+    self->opts = opts;
+    return 0;
+}
+
+/*
+ * Bytes of a record key: str as UTF-8, bytes as is, and int as 8 big-endian
+ * bytes with the sign bit flipped, so byte order is numeric order
+ */
+static int frame_key_from_pyobj(PyObject *key, uint8_t tmp[8], const uint8_t **out, size_t *out_len) {
+    if (PyLong_Check(key)) {
+        long long v = PyLong_AsLongLong(key);
+        if (v == -1 && PyErr_Occurred()) return -1;
+        uint64_t u = (uint64_t)v ^ ((uint64_t)1 << 63);
+        for (int i = 0; i < 8; i++) tmp[i] = (uint8_t)(u >> (56 - 8 * i));
+        *out = tmp;
+        *out_len = 8;
+        return 0;
+    }
+    if (PyUnicode_Check(key)) {
+        Py_ssize_t len;
+        const char *utf8 = PyUnicode_AsUTF8AndSize(key, &len);
+        if (!utf8) return -1;
+        *out = (const uint8_t *)utf8;
+        *out_len = (size_t)len;
+        return 0;
+    }
+    if (PyBytes_Check(key)) {
+        *out = (const uint8_t *)PyBytes_AS_STRING(key);
+        *out_len = (size_t)PyBytes_GET_SIZE(key);
+        return 0;
+    }
+    PyErr_Format(PyExc_TypeError, "record key must be int, str or bytes, not %.200s", Py_TYPE(key)->tp_name);
+    return -1;
+}
+
+static int FrameWriter_check_open(FrameWriterObject *self) {
+    if (self->writer) return 1;
+    PyErr_SetString(PyExc_ValueError, "I/O operation on closed FrameWriter");
+    return 0;
+}
+
+static PyObject* FrameWriter_write(FrameWriterObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"obj", "key", NULL};
+    PyObject *obj;
+    PyObject *key = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &obj, &key)) return NULL;
+    if (!FrameWriter_check_open(self)) return NULL;
+
+    uint8_t key_tmp[8];
+    const uint8_t *key_data = NULL;
+    size_t key_len = 0;
+    if (key != Py_None && frame_key_from_pyobj(key, key_tmp, &key_data, &key_len) < 0) return NULL;
+
+    /* A re-entrant call (from default) finds the session busy and encodes
+     * to a bytes object of its own */
+    PyObject *owner = NULL;
+    const uint8_t *body;
+    size_t size;
+    int locked = PyThread_acquire_lock(self->session.lock, NOWAIT_LOCK);
+    if (locked) {
+        if (encode_pyobj_to_session(obj, self->default_func, &self->opts, 1, &self->session,
+                                    &body, &size) != CROUS_OK) {
+            PyThread_release_lock(self->session.lock);
+            return NULL;
+        }
+    } else {
+        owner = encode_pyobj_to_bytes(obj, self->default_func, &self->opts, 1);
+        if (!owner) return NULL;
+        body = (const uint8_t *)PyBytes_AS_STRING(owner);
+        size = (size_t)PyBytes_GET_SIZE(owner);
+    }
+    
+    /* default may have closed the writer */
+    crous_err_t err = FrameWriter_check_open(self)
+        ? crous_frame_writer_write_keyed(self->writer, body, size, key_data, key_len)
+        : CROUS_ERR_STREAM;
+    if (locked) {
+        encode_session_trim(&self->session);
+        PyThread_release_lock(self->session.lock);
+    }
+    Py_XDECREF(owner);
+    if (err != CROUS_OK) return frame_fail(err, CrousEncodeError);
+    Py_RETURN_NONE;
+}
+
+static PyObject* FrameWriter_flush(FrameWriterObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (!FrameWriter_check_open(self)) return NULL;
+    crous_err_t err = crous_frame_writer_flush(self->writer);
+    if (err != CROUS_OK) return frame_fail(err, CrousEncodeError);
+    Py_RETURN_NONE;
+}
+
+static PyObject* FrameWriter_close(FrameWriterObject *self, PyObject *Py_UNUSED(ignored)) {
+    crous_err_t err = FrameWriter_release(self);
+    if (err != CROUS_OK) return frame_fail(err, CrousEncodeError);
+    Py_RETURN_NONE;
+}
+
+static PyObject* FrameWriter_enter(FrameWriterObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (!FrameWriter_check_open(self)) return NULL;
+    Py_INCREF(self);
+    return (PyObject *)self;
+}
+
+static PyObject* FrameWriter_exit(FrameWriterObject *self, PyObject *Py_UNUSED(args)) {
+    return FrameWriter_close(self, NULL);
+}
+
+static PyObject* FrameWriter_get_closed(FrameWriterObject *self, void *closure) {
+    (void)closure;
+    return PyBool_FromLong(self->writer == NULL);
+}
+
+static PyMethodDef FrameWriter_methods[] = {
+    {"write", (PyCFunction)(void(*)(void))FrameWriter_write, METH_VARARGS | METH_KEYWORDS,
+     "write(obj, key=None)\n\nAppend obj to the log as one record. key (int, str or bytes)\n"
+     "is kept for indexed records and found by FrameFile.find()."},
+    {"flush", (PyCFunction)FrameWriter_flush, METH_NOARGS,
+     "Write buffered records to fp."},
+    {"close", (PyCFunction)FrameWriter_close, METH_NOARGS,
+     "Flush and stop writing. fp is left open."},
+    {"__enter__", (PyCFunction)FrameWriter_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)FrameWriter_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef FrameWriter_getset[] = {
+    {"closed", (getter)FrameWriter_get_closed, NULL, "True once close() has been called.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyTypeObject FrameWriterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous.FrameWriter",
+    .tp_doc = "FrameWriter(fp, *, default=None, checksum=False, key_refs=False, columnar=False,\n"
+              "            index=False, index_interval=1024)\n\n"
+              "Append records to a framed log. The file header is written when fp is\n"
+              "empty (tell() is 0 or unavailable); otherwise records are appended to\n"
+              "the log already there. Records are buffered; flush() or close() writes\n"
+              "them out. With index=True, close() also writes a sparse seek index of\n"
+              "every index_interval-th record for FrameFile.",
+    .tp_basicsize = sizeof(FrameWriterObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)FrameWriter_init,
+    .tp_dealloc = (destructor)FrameWriter_dealloc,
+    .tp_methods = FrameWriter_methods,
+    .tp_getset = FrameWriter_getset,
+};
+
+static void FrameIter_release(FrameIterObject *self) {
+    crous_frame_reader_free(self->reader);
+    self->reader = NULL;
+    read_stream_clear(&self->state);
+    if (self->keys) {
+        key_cache_clear(self->keys);
+        PyMem_Free(self->keys);
+        self->keys = NULL;
+    }
+}
+
+static void FrameIter_dealloc(FrameIterObject *self) {
+    FrameIter_release(self);
+    Py_XDECREF(self->object_hook);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject* FrameIter_next(FrameIterObject *self) {
+    if (!self->reader) return NULL;
+
+    const uint8_t *body;
+    size_t len;
+    crous_err_t err = crous_frame_reader_next(self->reader, &body, &len);
+    if (self->state.failed) {
+        FrameIter_release(self);
+        return NULL;
+    }
+    if (err == CROUS_ERR_NOT_FOUND) {
+        FrameIter_release(self);
+        return NULL;
+    }
+    if (err != CROUS_OK) {
+        FrameIter_release(self);
+        if (err == CROUS_ERR_CHECKSUM) {
+            PyErr_SetString(CrousDecodeError, "record checksum mismatch");
+            return NULL;
+        }
+        return flux_decode_fail(err);
+    }
+    return decode_buffer_to_pyobj_keys(body, len, self->object_hook, self->keys);
+}
+
+static PyTypeObject FrameIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous._FrameIterator",
+    .tp_basicsize = sizeof(FrameIterObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)FrameIter_dealloc,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)FrameIter_next,
+};
+
+static PyObject* py_iter_load(PyObject *self, PyObject *args, PyObject *kwargs) {
+    (void)self;
+    PyObject *fp;
+    PyObject *object_hook = NULL;
+    static char *kwlist[] = {"fp", "object_hook", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &fp, &object_hook)) {
+        return NULL;
+    }
+
+    py_read_stream_state state;
+    if (read_stream_init(&state, fp) < 0) return NULL;
+
+    FrameIterObject *it = PyObject_New(FrameIterObject, &FrameIterType);
+    if (!it) {
+        read_stream_clear(&state);
+        return NULL;
+    }
+    if (object_hook == Py_None) object_hook = NULL;
+    Py_XINCREF(object_hook);
+    it->object_hook = object_hook;
+    it->state = state;
+    it->in.user_data = &it->state;
+    it->in.read = py_read_stream;
+    it->reader = NULL;
+    /* Records of one log repeat keys; without a cache decoding still works */
+    it->keys = PyMem_Calloc(1, sizeof(py_key_cache));
+
+    crous_err_t err = crous_frame_reader_new(&it->in, &it->reader);
+    if (err != CROUS_OK) {
+        Py_DECREF(it);
+        return frame_fail(err, CrousDecodeError);
+    }
+    return (PyObject *)it;
+}
+
+/* ----- Unpacker: incremental decode of a document stream ----- */
+
+/*
+ * Input is pushed with feed() or pulled from fp in read_size chunks and run
+ * through the incremental FLUX decoder. Finished documents, or in items
+ * mode the elements of a top-level list, are converted as soon as they
+ * complete and wait in a small list until iteration takes them.
+ */
+typedef struct {
+    PyObject_HEAD
+    PyObject *object_hook;
+    flux_stream_decoder_t *dec;     /* NULL once closed */
+    int items;
+    int has_fp;
+    int eof;
+    py_read_stream_state state;     /* fp.read and fp.readinto when has_fp */
+    uint8_t *chunk;                 /* read_size bytes, fp only */
+    size_t chunk_size;
+    PyObject *ready;                /* Decoded values not yet yielded */
+    Py_ssize_t ready_pos;
+    py_key_cache *keys;             /* Shared by all documents */
+} UnpackerObject;
+
+static void Unpacker_release(UnpackerObject *self) {
+    flux_stream_decoder_free(self->dec);
+    self->dec = NULL;
+    read_stream_clear(&self->state);
+    PyMem_Free(self->chunk);
+    self->chunk = NULL;
+    Py_CLEAR(self->ready);
+    if (self->keys) {
+        key_cache_clear(self->keys);
+        PyMem_Free(self->keys);
+        self->keys = NULL;
+    }
+}
+
+static void Unpacker_dealloc(UnpackerObject *self) {
+    Unpacker_release(self);
+    Py_XDECREF(self->object_hook);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int Unpacker_init(UnpackerObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"fp", "items", "object_hook", "read_size", NULL};
+    PyObject *fp = Py_None;
+    PyObject *object_hook = NULL;
+    int items = 0;
+    Py_ssize_t read_size = CROUS_STREAM_CHUNK_SIZE;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O$pOn", kwlist, &fp, &items, &object_hook,
+                                     &read_size)) {
+        return -1;
+    }
+    if (read_size <= 0) {
+        PyErr_SetString(PyExc_ValueError, "read_size must be positive");
+        return -1;
+    }
+
+    Unpacker_release(self);
+    self->has_fp = fp != Py_None;
+    self->eof = 0;
+    self->items = items;
+    self->ready_pos = 0;
+    if (self->has_fp) {
+        if (read_stream_init(&self->state, fp) < 0) return -1;
+        self->chunk_size = (size_t)read_size;
+        self->chunk = PyMem_Malloc(self->chunk_size);
+        if (!self->chunk) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    self->ready = PyList_New(0);
+    if (!self->ready) return -1;
+    self->dec = flux_stream_decoder_new();
+    if (!self->dec) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    flux_stream_decoder_set_items(self->dec, items);
+    /* Documents of one stream repeat keys; without a cache decoding still works */
+    self->keys = PyMem_Calloc(1, sizeof(py_key_cache));
+
+    if (object_hook == Py_None) object_hook = NULL;
+    Py_XINCREF(object_hook);
+    Py_XSETREF(self->object_hook, object_hook);
+    return 0;
+}
+
+static int Unpacker_check_open(UnpackerObject *self) {
+    if (self->dec) return 1;
+    PyErr_SetString(PyExc_ValueError, "Unpacker is closed");
+    return 0;
+}
+
+/* Convert and queue one finished value; takes v */
+static int Unpacker_put(UnpackerObject *self, crous_value *v) {
+    PyObject *obj = crous_to_pyobj_cached(v, self->object_hook, self->keys);
+    crous_value_free_tree(v);
+    if (!obj) return -1;
+    int rc = PyList_Append(self->ready, obj);
+    Py_DECREF(obj);
+    return rc;
+}
+
+/* Run bytes through the decoder, queueing everything that completes */
+static int Unpacker_process(UnpackerObject *self, const uint8_t *data, size_t len) {
+    size_t pos = 0;
+    while (pos < len) {
+        size_t used;
+        crous_err_t err = flux_stream_decoder_feed(self->dec, data + pos, len - pos, &used);
+        pos += used;
+
+        crous_value *v;
+        while (flux_stream_decoder_next_item(self->dec, &v) == CROUS_OK) {
+            if (Unpacker_put(self, v) < 0) return -1;
+        }
+        if (err != CROUS_OK) {
+            flux_decode_fail(err);
+            return -1;
+        }
+        if (!flux_stream_decoder_done(self->dec)) continue;
+
+        /* Document done: the rest of the input starts the next one */
+        if (!self->items) {
+            err = flux_stream_decoder_finish(self->dec, &v);
+            if (err != CROUS_OK) {
+                flux_decode_fail(err);
+                return -1;
+            }
+            if (Unpacker_put(self, v) < 0) return -1;
+        }
+        flux_stream_decoder_reset(self->dec);
+    }
+    return 0;
+}
+
+static PyObject* Unpacker_feed(UnpackerObject *self, PyObject *args) {
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "y*", &data)) return NULL;
+    if (!Unpacker_check_open(self)) {
+        PyBuffer_Release(&data);
+        return NULL;
+    }
+    if (self->has_fp) {
+        PyBuffer_Release(&data);
+        PyErr_SetString(PyExc_TypeError, "feed() is for an Unpacker without fp");
+        return NULL;
+    }
+    int rc = Unpacker_process(self, data.buf, (size_t)data.len);
+    PyBuffer_Release(&data);
+    if (rc < 0) return NULL;
+    Py_RETURN_NONE;
+}
+
+/* Input ended: fine on a document boundary, truncated otherwise */
+static int Unpacker_check_end(UnpackerObject *self) {
+    flux_stream_progress_t progress;
+    flux_stream_decoder_progress(self->dec, &progress);
+    if (progress.bytes_consumed == 0) return 0;
+    flux_decode_fail(CROUS_ERR_TRUNCATED);
+    return -1;
+}
+
+static PyObject* Unpacker_next(UnpackerObject *self) {
+    if (!Unpacker_check_open(self)) return NULL;
+    for (;;) {
+        if (self->ready_pos < PyList_GET_SIZE(self->ready)) {
+            PyObject *obj = PyList_GET_ITEM(self->ready, self->ready_pos);
+            Py_INCREF(obj);
+            self->ready_pos++;
+            return obj;
+        }
+        if (self->ready_pos > 0) {
+            if (PyList_SetSlice(self->ready, 0, PY_SSIZE_T_MAX, NULL) < 0) return NULL;
+            self->ready_pos = 0;
+        }
+
+        /* Without fp, iteration pauses until more is fed */
+        if (!self->has_fp || self->eof) return NULL;
+
+        size_t n = py_read_stream(&self->state, self->chunk, self->chunk_size);
+        if (self->state.failed) return NULL;
+        if (n == 0) {
+            self->eof = 1;
+            Unpacker_check_end(self);
+            return NULL;
+        }
+        if (Unpacker_process(self, self->chunk, n) < 0) return NULL;
+    }
+}
+
+static PyObject* Unpacker_close(UnpackerObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (!self->dec) Py_RETURN_NONE;
+    int rc = Unpacker_check_end(self);
+    Unpacker_release(self);
+    if (rc < 0) return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef Unpacker_methods[] = {
+    {"feed", (PyCFunction)Unpacker_feed, METH_VARARGS,
+     "feed(data)\n\nPush the next bytes of the stream. Values they complete are\n"
+     "decoded right away and yielded by iteration."},
+    {"close", (PyCFunction)Unpacker_close, METH_NOARGS,
+     "Free the decoder. Raises CrousDecodeError if the input stopped\n"
+     "part-way through a document."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject UnpackerType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous.Unpacker",
+    .tp_doc = "Unpacker(fp=None, *, items=False, object_hook=None, read_size=65536)\n\n"
+              "Incremental decoder for a stream of concatenated FLUX documents.\n"
+              "Without fp, push bytes with feed() and iterate to take every value\n"
+              "completed so far; iteration stops when more input is needed. With\n"
+              "fp, iteration reads it in read_size chunks (readinto() when it has\n"
+              "one) until EOF. With items=True the elements of a top-level list\n"
+              "are yielded one by one as they arrive instead of the whole list.",
+    .tp_basicsize = sizeof(UnpackerObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Unpacker_init,
+    .tp_dealloc = (destructor)Unpacker_dealloc,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)Unpacker_next,
+    .tp_methods = Unpacker_methods,
+};
+
+/* ----- FrameFile: mapped, indexed access ----- */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *object_hook;
+    crous_file_view view;
+    crous_frame_index *index;       /* NULL once closed */
+    py_key_cache *keys;
+} FrameFileObject;
+
+typedef struct {
+    PyObject_HEAD
+    FrameFileObject *file;
+    uint64_t offset;
+    uint64_t remaining;             /* UINT64_MAX: to the end of the log */
+} FrameFileIterObject;
+
+static PyTypeObject FrameFileIterType;
+
+static void FrameFile_release(FrameFileObject *self) {
+    crous_frame_index_free(self->index);
+    self->index = NULL;
+    crous_file_view_close(&self->view);
+    if (self->keys) {
+        key_cache_clear(self->keys);
+        PyMem_Free(self->keys);
+        self->keys = NULL;
+    }
+}
+
+static void FrameFile_dealloc(FrameFileObject *self) {
+    FrameFile_release(self);
+    Py_XDECREF(self->object_hook);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int FrameFile_init(FrameFileObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"path", "object_hook", NULL};
+    PyObject *path;
+    PyObject *object_hook = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O", kwlist, PyUnicode_FSConverter, &path,
+                                     &object_hook)) {
+        return -1;
+    }
+    if (self->index) {
+        Py_DECREF(path);
+        PyErr_SetString(PyExc_RuntimeError, "FrameFile is already open");
+        return -1;
+    }
+
+    crous_err_t err;
+    Py_BEGIN_ALLOW_THREADS
+    err = crous_file_view_open(PyBytes_AS_STRING(path), &self->view);
+    if (err == CROUS_OK) {
+        err = crous_frame_index_open(self->view.data, self->view.size, &self->index);
+        if (err != CROUS_OK) crous_file_view_close(&self->view);
+    }
+    Py_END_ALLOW_THREADS
+
+    if (err == CROUS_ERR_STREAM) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        Py_DECREF(path);
+        return -1;
+    }
+    Py_DECREF(path);
+    if (err != CROUS_OK) {
+        flux_decode_fail(err);
+        return -1;
+    }
+
+    if (object_hook == Py_None) object_hook = NULL;
+    Py_XINCREF(object_hook);
+    Py_XDECREF(self->object_hook);
+    self->object_hook = object_hook;
+    self->keys = PyMem_Calloc(1, sizeof(py_key_cache));
+    return 0;
+}
+
+static int FrameFile_check_open(FrameFileObject *self) {
+    if (self->index) return 1;
+    PyErr_SetString(PyExc_ValueError, "I/O operation on closed FrameFile");
+    return 0;
+}
+
+static PyObject* frame_index_fail(crous_err_t err) {
+    if (err == CROUS_ERR_CHECKSUM) {
+        PyErr_SetString(CrousDecodeError, "record checksum mismatch");
+        return NULL;
+    }
+    return flux_decode_fail(err);
+}
+
+/* Decode the record at *offset and move past it */
+static PyObject* FrameFile_read_at(FrameFileObject *self, uint64_t *offset) {
+    const uint8_t *body;
+    size_t len;
+    crous_err_t err = crous_frame_index_read(self->index, offset, &body, &len);
+    if (err != CROUS_OK) return frame_index_fail(err);
+    return decode_buffer_to_pyobj_keys(body, len, self->object_hook, self->keys);
+}
+
+static Py_ssize_t FrameFile_length(FrameFileObject *self) {
+    if (!FrameFile_check_open(self)) return -1;
+    return (Py_ssize_t)crous_frame_index_count(self->index);
+}
+
+static PyObject* FrameFile_item(FrameFileObject *self, Py_ssize_t index) {
+    if (!FrameFile_check_open(self)) return NULL;
+    uint64_t offset;
+    crous_err_t err = index < 0 ? CROUS_ERR_NOT_FOUND
+                                : crous_frame_index_seek(self->index, (uint64_t)index, &offset);
+    if (err == CROUS_ERR_NOT_FOUND) {
+        PyErr_SetString(PyExc_IndexError, "record index out of range");
+        return NULL;
+    }
+    if (err != CROUS_OK) return frame_index_fail(err);
+    return FrameFile_read_at(self, &offset);
+}
+
+static PyObject* FrameFile_subscript(FrameFileObject *self, PyObject *key) {
+    if (!PyIndex_Check(key)) {
+        PyErr_Format(PyExc_TypeError, "record indices must be integers, not %.200s",
+                     Py_TYPE(key)->tp_name);
+        return NULL;
+    }
+    Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+    if (index == -1 && PyErr_Occurred()) return NULL;
+    if (index < 0) {
+        Py_ssize_t len = FrameFile_length(self);
+        if (len < 0) return NULL;
+        index += len;
+    }
+    return FrameFile_item(self, index);
+}
+
+/*
+ * Iterator over records [start, stop); without a stop it runs to the end
+ * of the log, so a cut-off last record raises as it does for iter_load()
+ */
+static PyObject* frame_file_iter_new(FrameFileObject *self, Py_ssize_t start, Py_ssize_t stop, int to_end) {
+    if (!FrameFile_check_open(self)) return NULL;
+    Py_ssize_t count = (Py_ssize_t)crous_frame_index_count(self->index);
+    if (start < 0) start = 0;
+    if (to_end || stop > count) stop = count;
+
+    uint64_t offset = 0;
+    if (start < stop) {
+        crous_err_t err = crous_frame_index_seek(self->index, (uint64_t)start, &offset);
+        if (err != CROUS_OK) return frame_index_fail(err);
+    } else if (to_end && count > 0) {
+        /* Just past the last record: only a cut-off tail is left to report */
+        const uint8_t *body;
+        size_t len;
+        crous_err_t err = crous_frame_index_seek(self->index, (uint64_t)count - 1, &offset);
+        if (err == CROUS_OK) err = crous_frame_index_read(self->index, &offset, &body, &len);
+        if (err != CROUS_OK && err != CROUS_ERR_CHECKSUM) return frame_index_fail(err);
+    }
+
+    FrameFileIterObject *it = PyObject_New(FrameFileIterObject, &FrameFileIterType);
+    if (!it) return NULL;
+    Py_INCREF(self);
+    it->file = self;
+    it->offset = offset;
+    it->remaining = to_end ? UINT64_MAX : start < stop ? (uint64_t)(stop - start) : 0;
+    return (PyObject *)it;
+}
+
+static PyObject* FrameFile_iter(FrameFileObject *self) {
+    return frame_file_iter_new(self, 0, 0, 1);
+}
+
+static PyObject* FrameFile_records(FrameFileObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"start", "stop", NULL};
+    Py_ssize_t start = 0;
+    PyObject *stop_obj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nO", kwlist, &start, &stop_obj)) return NULL;
+    Py_ssize_t stop = 0;
+    if (stop_obj != Py_None) {
+        stop = PyNumber_AsSsize_t(stop_obj, PyExc_OverflowError);
+        if (stop == -1 && PyErr_Occurred()) return NULL;
+    }
+    return frame_file_iter_new(self, start, stop, stop_obj == Py_None);
+}
+
+static PyObject* FrameFile_find(FrameFileObject *self, PyObject *key) {
+    if (!FrameFile_check_open(self)) return NULL;
+
+    uint8_t key_tmp[8];
+    const uint8_t *key_data;
+    size_t key_len;
+    if (frame_key_from_pyobj(key, key_tmp, &key_data, &key_len) < 0) return NULL;
+
+    uint64_t record = 0, offset;
+    crous_err_t err = crous_frame_index_find(self->index, key_data, key_len, &record, &offset);
+    if (err == CROUS_ERR_NOT_FOUND) record = 0;
+    else if (err != CROUS_OK) return flux_decode_fail(err);
+    return PyLong_FromUnsignedLongLong(record);
+}
+
+static PyObject* FrameFile_split(FrameFileObject *self, PyObject *arg) {
+    if (!FrameFile_check_open(self)) return NULL;
+    Py_ssize_t parts = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+    if (parts == -1 && PyErr_Occurred()) return NULL;
+    if (parts < 1) {
+        PyErr_SetString(PyExc_ValueError, "parts must be at least 1");
+        return NULL;
+    }
+
+    uint64_t *bounds = PyMem_Malloc(((size_t)parts + 1) * sizeof(*bounds));
+    if (!bounds) return PyErr_NoMemory();
+    crous_err_t err = crous_frame_index_split(self->index, (size_t)parts, bounds);
+    if (err != CROUS_OK) {
+        PyMem_Free(bounds);
+        return flux_decode_fail(err);
+    }
+
+    /* Empty ranges are dropped */
+    PyObject *ranges = PyList_New(0);
+    for (Py_ssize_t k = 0; ranges && k < parts; k++) {
+        if (bounds[k] == bounds[k + 1]) continue;
+        PyObject *range = Py_BuildValue("(KK)", (unsigned long long)bounds[k], (unsigned long long)bounds[k + 1]);
+        if (!range || PyList_Append(ranges, range) < 0) Py_CLEAR(ranges);
+        Py_XDECREF(range);
+    }
+    PyMem_Free(bounds);
+    return ranges;
+}
+
+static PyObject* FrameFile_close(FrameFileObject *self, PyObject *Py_UNUSED(ignored)) {
+    FrameFile_release(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject* FrameFile_enter(FrameFileObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (!FrameFile_check_open(self)) return NULL;
+    Py_INCREF(self);
+    return (PyObject *)self;
+}
+
+static PyObject* FrameFile_exit(FrameFileObject *self, PyObject *Py_UNUSED(args)) {
+    return FrameFile_close(self, NULL);
+}
+
+static PyObject* FrameFile_get_closed(FrameFileObject *self, void *closure) {
+    (void)closure;
+    return PyBool_FromLong(self->index == NULL);
+}
+
+static PyMethodDef FrameFile_methods[] = {
+    {"records", (PyCFunction)(void(*)(void))FrameFile_records, METH_VARARGS | METH_KEYWORDS,
+     "records(start=0, stop=None)\n\nIterate records start to stop, seeking to start through the index.\n"
+     "Without stop, iteration runs to the end of the log and raises on a cut-off last record."},
+    {"find", (PyCFunction)FrameFile_find, METH_O,
+     "find(key)\n\nRecord number to scan from for key: the last indexed record whose key\n"
+     "is <= key, or 0. Keys must not decrease through the log."},
+    {"split", (PyCFunction)FrameFile_split, METH_O,
+     "split(parts)\n\nUp to parts (start, stop) record ranges of about equal bytes, cut at\n"
+     "index entries, for reading in parallel with records()."},
+    {"close", (PyCFunction)FrameFile_close, METH_NOARGS,
+     "Unmap the file. Records already decoded stay valid."},
+    {"__enter__", (PyCFunction)FrameFile_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)FrameFile_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef FrameFile_getset[] = {
+    {"closed", (getter)FrameFile_get_closed, NULL, "True once close() has been called.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyMappingMethods FrameFile_as_mapping = {
+    .mp_length = (lenfunc)FrameFile_length,
+    .mp_subscript = (binaryfunc)FrameFile_subscript,
+};
+
+static PySequenceMethods FrameFile_as_sequence = {
+    .sq_length = (lenfunc)FrameFile_length,
+    .sq_item = (ssizeargfunc)FrameFile_item,
+};
+
+static PyTypeObject FrameFileType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous.FrameFile",
+    .tp_doc = "FrameFile(path, *, object_hook=None)\n\n"
+              "Random access to a framed log through a read-only memory mapping.\n"
+              "len() is the record count and f[i] decodes record i, found through\n"
+              "the seek index FrameWriter(index=True) leaves behind; stretches\n"
+              "without one are indexed on open by walking record lengths.",
+    .tp_basicsize = sizeof(FrameFileObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)FrameFile_init,
+    .tp_dealloc = (destructor)FrameFile_dealloc,
+    .tp_as_mapping = &FrameFile_as_mapping,
+    .tp_as_sequence = &FrameFile_as_sequence,
+    .tp_iter = (getiterfunc)FrameFile_iter,
+    .tp_methods = FrameFile_methods,
+    .tp_getset = FrameFile_getset,
+};
+
+static void FrameFileIter_dealloc(FrameFileIterObject *self) {
+    Py_XDECREF(self->file);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject* FrameFileIter_next(FrameFileIterObject *self) {
+    if (self->remaining == 0) return NULL;
+    if (!FrameFile_check_open(self->file)) return NULL;
+
+    const uint8_t *body;
+    size_t len;
+    crous_err_t err = crous_frame_index_read(self->file->index, &self->offset, &body, &len);
+    if (err != CROUS_OK) {
+        self->remaining = 0;
+        return err == CROUS_ERR_NOT_FOUND ? NULL : frame_index_fail(err);
+    }
+    if (self->remaining != UINT64_MAX) self->remaining--;
+    return decode_buffer_to_pyobj_keys(body, len, self->file->object_hook, self->file->keys);
+}
+
+static PyTypeObject FrameFileIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous._FrameFileIterator",
+    .tp_basicsize = sizeof(FrameFileIterObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)FrameFileIter_dealloc,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)FrameFileIter_next,
+};
+
+/* ----- load_parallel: a whole log at once ----- */
+
+/* A record's FLUX document, unpacked from its envelope into owned when it had one */
+typedef struct {
+    const uint8_t *doc;
+    size_t len;
+    uint8_t *owned;
+    const flux_dictionary_t *dict;
+} py_log_record;
+
+typedef struct {
+    const crous_frame_index *index;
+    const uint64_t *bounds;         /* Range k is [bounds[k], bounds[k + 1]) */
+    py_log_record *records;
+    uint64_t *stops;                /* Per range: first record not prepared */
+    crous_err_t *errs;              /* Per range: why it stopped there */
+} py_log_job;
+
+/* Check and unpack one range of records; runs without the GIL */
+static void py_log_prepare_task(void *ctx, size_t k) {
+    py_log_job *job = ctx;
+    uint64_t r = job->bounds[k], stop = job->bounds[k + 1];
+    uint64_t offset;
+    crous_err_t err = r < stop ? crous_frame_index_seek(job->index, r, &offset) : CROUS_OK;
+
+    for (; err == CROUS_OK && r < stop; r++) {
+        py_log_record *rec = &job->records[r];
+        err = crous_frame_index_read(job->index, &offset, &rec->doc, &rec->len);
+        if (err != CROUS_OK) break;
+        /* Unregistered dictionaries stay packed, for the decoder to name */
+        if (!flux_binary_is_compressed(rec->doc, rec->len) ||
+            flux_envelope_dictionary(rec->doc, rec->len, &rec->dict) != CROUS_OK) {
+            continue;
+        }
+
+        size_t raw_size;
+        err = flux_decompressed_size(rec->doc, rec->len, &raw_size);
+        if (err != CROUS_OK) break;
+        rec->owned = malloc(raw_size ? raw_size : 1);
+        if (!rec->owned) {
+            err = CROUS_ERR_OOM;
+            break;
+        }
+        err = flux_decompress_binary_into(rec->doc, rec->len, rec->owned, raw_size);
+        if (err != CROUS_OK) break;
+        rec->doc = rec->owned;
+        rec->len = raw_size;
+    }
+    job->stops[k] = r;
+    job->errs[k] = err;
+}
+
+static PyObject* py_load_parallel(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *path;
+    int workers = 0;
+    PyObject *object_hook = NULL;
+    static char *kwlist[] = {"path", "workers", "object_hook", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|iO", kwlist, PyUnicode_FSConverter, &path,
+                                     &workers, &object_hook)) {
+        return NULL;
+    }
+    if (object_hook == Py_None) object_hook = NULL;
+    int pool = crous_pool_threads();
+    if (workers <= 0 || workers > pool) workers = pool;
+
+    crous_file_view view;
+    crous_frame_index *index = NULL;
+    crous_err_t err;
+    Py_BEGIN_ALLOW_THREADS
+    err = crous_file_view_open(PyBytes_AS_STRING(path), &view);
+    if (err == CROUS_OK) {
+        err = crous_frame_index_open(view.data, view.size, &index);
+        if (err != CROUS_OK) crous_file_view_close(&view);
+    }
+    Py_END_ALLOW_THREADS
+
+    if (err == CROUS_ERR_STREAM) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        Py_DECREF(path);
+        return NULL;
+    }
+    Py_DECREF(path);
+    if (err != CROUS_OK) return flux_decode_fail(err);
+
+    uint64_t count = crous_frame_index_count(index);
+    size_t parts = workers == 1 ? 1 : (size_t)workers * 4;
+    py_log_job job = { index, NULL, NULL, NULL, NULL };
+    uint64_t *bounds = NULL;
+    PyObject *result = NULL;
+    if (count > PY_SSIZE_T_MAX / sizeof(py_log_record)) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    bounds = PyMem_Malloc((parts + 1) * sizeof(*bounds));
+    job.records = PyMem_Calloc(count ? (size_t)count : 1, sizeof(*job.records));
+    job.stops = PyMem_Calloc(parts, sizeof(*job.stops));
+    job.errs = PyMem_Calloc(parts, sizeof(*job.errs));
+    if (!bounds || !job.records || !job.stops || !job.errs) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    crous_frame_index_split(index, parts, bounds);
+    job.bounds = bounds;
+
+    /* Checksums and decompression run in parallel; objects need the GIL */
+    crous_err_t tail;
+    Py_BEGIN_ALLOW_THREADS
+    crous_parallel_for(parts, workers, py_log_prepare_task, &job);
+    /* Past the last record is either the end of the log or a cut-off append */
+    uint64_t offset = 0;
+    tail = count ? crous_frame_index_seek(index, count - 1, &offset) : CROUS_OK;
+    if (tail == CROUS_OK && count) {
+        const uint8_t *body;
+        size_t len;
+        tail = crous_frame_index_read(index, &offset, &body, &len);
+    }
+    if (tail == CROUS_OK) {
+        const uint8_t *body;
+        size_t len;
+        tail = crous_frame_index_read(index, &offset, &body, &len);
+    }
+    Py_END_ALLOW_THREADS
+
+    result = PyList_New((Py_ssize_t)count);
+    if (!result) goto done;
+    /* Records of one log repeat keys; without a cache decoding still works */
+    py_key_cache *keys = PyMem_Calloc(1, sizeof(py_key_cache));
+    for (size_t k = 0; k < parts && result; k++) {
+        for (uint64_t r = bounds[k]; r < job.stops[k]; r++) {
+            py_log_record *rec = &job.records[r];
+            PyObject *item = rec->owned ? flux_document_to_pyobj(rec->doc, rec->len, object_hook, keys,
+                                                               rec->dict, CROUS_MAX_DEPTH)
+                                        : decode_buffer_to_pyobj_keys(rec->doc, rec->len, object_hook, keys);
+            free(rec->owned);
+            rec->owned = NULL;
+            if (!item) {
+                Py_CLEAR(result);
+                break;
+            }
+            PyList_SET_ITEM(result, (Py_ssize_t)r, item);
+        }
+        if (result && job.errs[k] != CROUS_OK) {
+            frame_index_fail(job.errs[k]);
+            Py_CLEAR(result);
+        }
+    }
+    if (result && tail != CROUS_ERR_NOT_FOUND) {
+        frame_index_fail(tail);
+        Py_CLEAR(result);
+    }
+    if (keys) {
+        key_cache_clear(keys);
+        PyMem_Free(keys);
+    }
+
+done:
+    if (job.records) {
+        for (uint64_t r = 0; r < count; r++) free(job.records[r].owned);
+    }
+    PyMem_Free(job.records);
+    PyMem_Free(job.stops);
+    PyMem_Free(job.errs);
+    PyMem_Free(bounds);
+    crous_frame_index_free(index);
+    crous_file_view_close(&view);
+    return result;
+}
+
+/* ============================================================================
+   LAZY VIEWS
+   ============================================================================ */
+
+/*
+ * loads_lazy() proxies over a flux_view_doc_t. Dicts and lists come back as
+ * LazyDict / LazyList objects that walk the input on access; everything
+ * else is converted when reached. The view code runs under the document's
+ * lock and never calls into Python there; objects are built after it is
+ * released.
+ */
+typedef struct {
+    PyObject_HEAD
+    Py_buffer buf;              /* Keeps the input alive */
+    flux_view_doc_t *doc;
+    PyThread_type_lock lock;
+} LazyDocObject;
+
+typedef struct {
+    PyObject_HEAD
+    LazyDocObject *doc;
+    flux_view_t view;
+} LazyValueObject;
+
+/* What a view resolves to, read under the lock and built into Python after */
+typedef struct {
+    flux_view_t view;
+    const void *data;           /* String, bytes or packed array payload */
+    size_t len;                 /* Payload bytes */
+    double fval;
+    crous_arena *arena;         /* Tagged values: the built sub-tree */
+    crous_value *tree;
+} lazy_item;
+
+static PyTypeObject LazyDocType;
+static PyTypeObject LazyDictType;
+static PyTypeObject LazyListType;
+static PyTypeObject LazyIterType;
+
+static void LazyDoc_dealloc(LazyDocObject *self) {
+    flux_view_close(self->doc);
+    if (self->buf.obj) PyBuffer_Release(&self->buf);
+    if (self->lock) PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyTypeObject LazyDocType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous._LazyDocument",
+    .tp_doc = "Input buffer and shared walk state of loads_lazy() proxies.",
+    .tp_basicsize = sizeof(LazyDocObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)LazyDoc_dealloc,
+};
+
+static inline void lazy_lock(LazyDocObject *doc) {
+    PyThread_acquire_lock(doc->lock, WAIT_LOCK);
+}
+
+static inline void lazy_unlock(LazyDocObject *doc) {
+    PyThread_release_lock(doc->lock);
+}
+
+/* Under the lock: read whatever building v into Python will need */
+static crous_err_t lazy_resolve(const flux_view_t *v, lazy_item *item) {
+    item->view = *v;
+    item->arena = NULL;
+    item->tree = NULL;
+    
+    switch (flux_view_type(v)) {
+        case CROUS_TYPE_FLOAT:
+            return flux_view_get_float(v, &item->fval);
+        case CROUS_TYPE_STRING:
+            return flux_view_get_string(v, (const char **)&item->data, &item->len);
+        case CROUS_TYPE_BYTES:
+            return flux_view_get_bytes(v, (const uint8_t **)&item->data, &item->len);
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY: {
+            crous_err_t err = flux_view_get_array(v, (const uint8_t **)&item->data, &item->len);
+            item->len *= 8;
+            return err;
+        }
+        case CROUS_TYPE_TAGGED: {
+            /* Custom decoders need the whole value */
+            item->arena = crous_arena_create(4096);
+            if (!item->arena) return CROUS_ERR_OOM;
+            crous_err_t err = flux_view_decode(v, item->arena, &item->tree);
+            if (err != CROUS_OK) {
+                crous_arena_free(item->arena);
+                item->arena = NULL;
+            }
+            return err;
+        }
+        default:
+            return CROUS_OK;
+    }
+}
+
+static PyObject* lazy_wrap(LazyDocObject *doc, const flux_view_t *v) {
+    PyTypeObject *type = flux_view_type(v) == CROUS_TYPE_DICT ? &LazyDictType : &LazyListType;
+    LazyValueObject *self = PyObject_New(LazyValueObject, type);
+    if (!self) return NULL;
+    Py_INCREF(doc);
+    self->doc = doc;
+    self->view = *v;
+    return (PyObject *)self;
+}
+
+/* After the lock: the Python value of a resolved item */
+static PyObject* lazy_build(LazyDocObject *doc, lazy_item *item) {
+    const flux_view_t *v = &item->view;
+    int b;
+    int64_t i;
+    
+    switch (flux_view_type(v)) {
+        case CROUS_TYPE_NULL:
+            Py_RETURN_NONE;
+        case CROUS_TYPE_BOOL:
+            flux_view_get_bool(v, &b);
+            return PyBool_FromLong(b);
+        case CROUS_TYPE_INT:
+            flux_view_get_int(v, &i);
+            return PyLong_FromLongLong(i);
+        case CROUS_TYPE_FLOAT:
+            return PyFloat_FromDouble(item->fval);
+        case CROUS_TYPE_STRING:
+            return PyUnicode_FromStringAndSize(item->data, (Py_ssize_t)item->len);
+        case CROUS_TYPE_BYTES:
+            return PyBytes_FromStringAndSize(item->data, (Py_ssize_t)item->len);
+        case CROUS_TYPE_I64_ARRAY:
+            return py_array_from_bytes('q', item->data, item->len);
+        case CROUS_TYPE_F64_ARRAY:
+            return py_array_from_bytes('d', item->data, item->len);
+        case CROUS_TYPE_TAGGED: {
+            PyObject *result = crous_to_pyobj_cached(item->tree, NULL, NULL);
+            crous_arena_free(item->arena);
+            return result;
+        }
+        default:
+            return lazy_wrap(doc, v);
+    }
+}
 
-static void CrousEncoder_dealloc(CrousEncoderObject *self) {
-    Py_XDECREF(self->default_func);
-    Py_TYPE(self)->tp_free((PyObject *)self);
+/* Resolve under the lock, then build; NULL with CrousDecodeError on failure */
+static PyObject* lazy_value(LazyDocObject *doc, const flux_view_t *v) {
+    lazy_item item;
+    lazy_lock(doc);
+    crous_err_t err = lazy_resolve(v, &item);
+    lazy_unlock(doc);
+    if (err != CROUS_OK) return flux_decode_fail(err);
+    return lazy_build(doc, &item);
 }
 
-static PyObject* CrousEncoder_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
-    CrousEncoderObject *self = (CrousEncoderObject *)type->tp_alloc(type, 0);
-    if (self) {
-        self->default_func = NULL;
-        self->allow_custom = 1;
+/* The whole value behind a proxy, decoded eagerly */
+static PyObject* Lazy_to_python(LazyValueObject *self, PyObject *Py_UNUSED(ignored)) {
+    crous_arena *arena = crous_arena_create(4096);
+    if (!arena) return PyErr_NoMemory();
+    
+    crous_value *tree = NULL;
+    lazy_lock(self->doc);
+    crous_err_t err = flux_view_decode(&self->view, arena, &tree);
+    lazy_unlock(self->doc);
+    
+    PyObject *result = err == CROUS_OK ? crous_to_pyobj_cached(tree, NULL, NULL) : flux_decode_fail(err);
+    crous_arena_free(arena);
+    return result;
+}
+
+static Py_ssize_t Lazy_length(LazyValueObject *self) {
+    size_t len = 0;
+    lazy_lock(self->doc);
+    crous_err_t err = flux_view_len(&self->view, &len);
+    lazy_unlock(self->doc);
+    if (err != CROUS_OK) {
+        flux_decode_fail(err);
+        return -1;
     }
-    return (PyObject *)self;
+    return (Py_ssize_t)len;
 }
 
-static int CrousEncoder_init(CrousEncoderObject *self, PyObject *args, PyObject *kwargs) {
-    static char *kwlist[] = {"default", "allow_custom", NULL};
-    PyObject *default_func = NULL;
-    int allow_custom = 1;
-    
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|Op", kwlist, 
-                                      &default_func, &allow_custom)) {
+/* Proxies compare equal to the objects they stand for */
+static PyObject* Lazy_richcompare(PyObject *self, PyObject *other, int op) {
+    if (op != Py_EQ && op != Py_NE) Py_RETURN_NOTIMPLEMENTED;
+    
+    PyObject *a = Lazy_to_python((LazyValueObject *)self, NULL);
+    if (!a) return NULL;
+    PyObject *b;
+    if (Py_TYPE(other) == &LazyDictType || Py_TYPE(other) == &LazyListType) {
+        b = Lazy_to_python((LazyValueObject *)other, NULL);
+        if (!b) {
+            Py_DECREF(a);
+            return NULL;
+        }
+    } else {
+        Py_INCREF(other);
+        b = other;
+    }
+    PyObject *result = PyObject_RichCompare(a, b, op);
+    Py_DECREF(a);
+    Py_DECREF(b);
+    return result;
+}
+
+static void Lazy_dealloc(LazyValueObject *self) {
+    Py_DECREF(self->doc);
+    PyObject_Free(self);
+}
+
+/* ----- LazyDict ----- */
+
+/* Look key up; 0 found, 1 absent, -1 error */
+static int LazyDict_find(LazyValueObject *self, PyObject *key, lazy_item *item) {
+    if (!PyUnicode_Check(key)) return 1;
+    Py_ssize_t key_len;
+    const char *key_data = PyUnicode_AsUTF8AndSize(key, &key_len);
+    if (!key_data) return -1;
+    
+    flux_view_t child;
+    lazy_lock(self->doc);
+    crous_err_t err = flux_view_get_key(&self->view, key_data, (size_t)key_len, &child);
+    if (err == CROUS_OK) err = lazy_resolve(&child, item);
+    lazy_unlock(self->doc);
+    
+    if (err == CROUS_ERR_NOT_FOUND) return 1;
+    if (err != CROUS_OK) {
+        flux_decode_fail(err);
         return -1;
     }
-    
-    Py_XINCREF(default_func);
-    Py_XDECREF(self->default_func);
-    self->default_func = default_func;
-    self->allow_custom = allow_custom;
-    
     return 0;
 }
 
-static PyObject* CrousEncoder_encode(CrousEncoderObject *self, PyObject *args) {
-    PyObject *obj;
-    
-    if (!PyArg_ParseTuple(args, "O", &obj)) {
+static PyObject* LazyDict_subscript(LazyValueObject *self, PyObject *key) {
+    lazy_item item;
+    int rc = LazyDict_find(self, key, &item);
+    if (rc < 0) return NULL;
+    if (rc > 0) {
+        PyErr_SetObject(PyExc_KeyError, key);
         return NULL;
     }
-    
-    crous_err_t err = CROUS_OK;
-    crous_value *value = pyobj_to_crous_with_default(obj, self->default_func, &err);
-    if (!value) {
-        if (!PyErr_Occurred()) {
-            PyErr_SetString(CrousEncodeError, crous_err_str(err));
-        }
-        return NULL;
+    return lazy_build(self->doc, &item);
+}
+
+static int LazyDict_contains(LazyValueObject *self, PyObject *key) {
+    lazy_item item;
+    int rc = LazyDict_find(self, key, &item);
+    if (rc < 0) return -1;
+    if (rc > 0) return 0;
+    if (item.arena) crous_arena_free(item.arena);
+    return 1;
+}
+
+static PyObject* LazyDict_get(LazyValueObject *self, PyObject *args) {
+    PyObject *key;
+    PyObject *default_value = Py_None;
+    if (!PyArg_ParseTuple(args, "O|O", &key, &default_value)) return NULL;
+    
+    lazy_item item;
+    int rc = LazyDict_find(self, key, &item);
+    if (rc < 0) return NULL;
+    if (rc > 0) {
+        Py_INCREF(default_value);
+        return default_value;
     }
-    
-    uint8_t *buf = NULL;
-    size_t size = 0;
-    err = crous_encode(value, &buf, &size);
-    crous_value_free_tree(value);
-    
+    return lazy_build(self->doc, &item);
+}
+
+/* ----- Iteration ----- */
+
+enum { LAZY_ITER_KEYS, LAZY_ITER_VALUES, LAZY_ITER_ITEMS };
+
+typedef struct {
+    PyObject_HEAD
+    LazyDocObject *doc;
+    flux_view_iter_t it;
+    int mode;
+} LazyIterObject;
+
+static PyObject* lazy_iter_new(LazyValueObject *self, int mode) {
+    LazyIterObject *iter = PyObject_New(LazyIterObject, &LazyIterType);
+    if (!iter) return NULL;
+    Py_INCREF(self->doc);
+    iter->doc = self->doc;
+    iter->mode = mode;
+    
+    lazy_lock(self->doc);
+    crous_err_t err = flux_view_iter_init(&self->view, &iter->it);
+    lazy_unlock(self->doc);
     if (err != CROUS_OK) {
-        PyErr_SetString(CrousEncodeError, crous_err_str(err));
-        free(buf);
-        return NULL;
+        Py_DECREF(iter);
+        return flux_decode_fail(err);
+    }
+    return (PyObject *)iter;
+}
+
+static PyObject* LazyIter_next(LazyIterObject *self) {
+    const char *key = NULL;
+    size_t key_len = 0;
+    flux_view_t child;
+    lazy_item item;
+    
+    lazy_lock(self->doc);
+    crous_err_t err = flux_view_next(&self->it, &key, &key_len, &child);
+    if (err == CROUS_OK && self->mode != LAZY_ITER_KEYS) err = lazy_resolve(&child, &item);
+    lazy_unlock(self->doc);
+    
+    if (err == CROUS_ERR_NOT_FOUND) return NULL;
+    if (err != CROUS_OK) return flux_decode_fail(err);
+    
+    PyObject *k = NULL;
+    if (self->mode != LAZY_ITER_VALUES) {
+        k = PyUnicode_FromStringAndSize(key, (Py_ssize_t)key_len);
+        if (!k) {
+            if (self->mode == LAZY_ITER_ITEMS && item.arena) crous_arena_free(item.arena);
+            return NULL;
+        }
+        if (self->mode == LAZY_ITER_KEYS) return k;
     }
     
-    PyObject *result = PyBytes_FromStringAndSize((const char *)buf, (Py_ssize_t)size);
-    free(buf);
-    return result;
+    PyObject *v = lazy_build(self->doc, &item);
+    if (self->mode == LAZY_ITER_VALUES || !v) {
+        Py_XDECREF(k);
+        return v;
+    }
+    PyObject *pair = PyTuple_Pack(2, k, v);
+    Py_DECREF(k);
+    Py_DECREF(v);
+    return pair;
 }
 
-static PyMethodDef CrousEncoder_methods[] = {
-    {"encode", (PyCFunction)CrousEncoder_encode, METH_VARARGS, 
-     "Encode a Python object to Crous binary format."},
-    {NULL, NULL, 0, NULL}
-};
+static void LazyIter_dealloc(LazyIterObject *self) {
+    Py_DECREF(self->doc);
+    PyObject_Free(self);
+}
 
-static PyTypeObject CrousEncoderType = {
+static PyTypeObject LazyIterType = {
     PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "crous.CrousEncoder",
-    .tp_doc = "Crous encoder class for serializing Python objects to binary format.",
-    .tp_basicsize = sizeof(CrousEncoderObject),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = CrousEncoder_new,
-    .tp_init = (initproc)CrousEncoder_init,
-    .tp_dealloc = (destructor)CrousEncoder_dealloc,
-    .tp_methods = CrousEncoder_methods,
+    .tp_name = "crous._LazyIterator",
+    .tp_basicsize = sizeof(LazyIterObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)LazyIter_dealloc,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)LazyIter_next,
 };
 
-/* ============================================================================
-   CROUSDECODER CLASS
-   ============================================================================ */
+static PyObject* LazyDict_iter(LazyValueObject *self) {
+    return lazy_iter_new(self, LAZY_ITER_KEYS);
+}
 
-typedef struct {
-    PyObject_HEAD
-    PyObject *object_hook;
-} CrousDecoderObject;
+/* keys(), values() and items() return lists, built in one walk */
+static PyObject* lazy_collect(LazyValueObject *self, int mode) {
+    PyObject *iter = lazy_iter_new(self, mode);
+    if (!iter) return NULL;
+    PyObject *list = PySequence_List(iter);
+    Py_DECREF(iter);
+    return list;
+}
 
-static void CrousDecoder_dealloc(CrousDecoderObject *self) {
-    Py_XDECREF(self->object_hook);
-    Py_TYPE(self)->tp_free((PyObject *)self);
+static PyObject* LazyDict_keys(LazyValueObject *self, PyObject *Py_UNUSED(ignored)) {
+    return lazy_collect(self, LAZY_ITER_KEYS);
 }
 
-static PyObject* CrousDecoder_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
-    CrousDecoderObject *self = (CrousDecoderObject *)type->tp_alloc(type, 0);
-    if (self) {
-        self->object_hook = NULL;
-    }
-    return (PyObject *)self;
+static PyObject* LazyDict_values(LazyValueObject *self, PyObject *Py_UNUSED(ignored)) {
+    return lazy_collect(self, LAZY_ITER_VALUES);
 }
 
-static int CrousDecoder_init(CrousDecoderObject *self, PyObject *args, PyObject *kwargs) {
-    static char *kwlist[] = {"object_hook", NULL};
-    PyObject *object_hook = NULL;
-    
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &object_hook)) {
-        return -1;
-    }
-    
-    Py_XINCREF(object_hook);
-    Py_XDECREF(self->object_hook);
-    self->object_hook = object_hook;
-    
-    return 0;
+static PyObject* LazyDict_items(LazyValueObject *self, PyObject *Py_UNUSED(ignored)) {
+    return lazy_collect(self, LAZY_ITER_ITEMS);
 }
 
-static PyObject* CrousDecoder_decode(CrousDecoderObject *self, PyObject *args) {
-    const uint8_t *buf;
-    Py_ssize_t buf_size;
-    
-    if (!PyArg_ParseTuple(args, "y#", &buf, &buf_size)) {
+static PyObject* LazyDict_repr(LazyValueObject *self) {
+    Py_ssize_t len = Lazy_length(self);
+    if (len < 0) return NULL;
+    return PyUnicode_FromFormat("<crous.LazyDict with %zd keys>", len);
+}
+
+static PyMethodDef LazyDict_methods[] = {
+    {"get", (PyCFunction)LazyDict_get, METH_VARARGS,
+     "Value for key if present, else default (None)."},
+    {"keys", (PyCFunction)LazyDict_keys, METH_NOARGS, "List of the keys."},
+    {"values", (PyCFunction)LazyDict_values, METH_NOARGS, "List of the values, containers still lazy."},
+    {"items", (PyCFunction)LazyDict_items, METH_NOARGS, "List of (key, value) pairs, containers still lazy."},
+    {"to_python", (PyCFunction)Lazy_to_python, METH_NOARGS, "Decode the whole dict into plain Python objects."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMappingMethods LazyDict_as_mapping = {
+    .mp_length = (lenfunc)Lazy_length,
+    .mp_subscript = (binaryfunc)LazyDict_subscript,
+};
+
+static PySequenceMethods LazyDict_as_sequence = {
+    .sq_contains = (objobjproc)LazyDict_contains,
+};
+
+static PyTypeObject LazyDictType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous.LazyDict",
+    .tp_doc = "Read-only dict proxy returned by loads_lazy(); fields are decoded on access.",
+    .tp_basicsize = sizeof(LazyValueObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)Lazy_dealloc,
+    .tp_repr = (reprfunc)LazyDict_repr,
+    .tp_as_mapping = &LazyDict_as_mapping,
+    .tp_as_sequence = &LazyDict_as_sequence,
+    .tp_richcompare = Lazy_richcompare,
+    .tp_iter = (getiterfunc)LazyDict_iter,
+    .tp_methods = LazyDict_methods,
+};
+
+/* ----- LazyList ----- */
+
+static PyObject* LazyList_item(LazyValueObject *self, Py_ssize_t index) {
+    flux_view_t child;
+    lazy_item item;
+    crous_err_t err = CROUS_ERR_NOT_FOUND;
+    
+    lazy_lock(self->doc);
+    if (index >= 0) err = flux_view_index(&self->view, (size_t)index, &child);
+    if (err == CROUS_OK) err = lazy_resolve(&child, &item);
+    lazy_unlock(self->doc);
+    
+    if (err == CROUS_ERR_NOT_FOUND) {
+        PyErr_SetString(PyExc_IndexError, "list index out of range");
         return NULL;
     }
+    if (err != CROUS_OK) return flux_decode_fail(err);
+    return lazy_build(self->doc, &item);
+}
+
+static PyObject* LazyList_subscript(LazyValueObject *self, PyObject *key) {
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred()) return NULL;
+        if (index < 0) {
+            Py_ssize_t len = Lazy_length(self);
+            if (len < 0) return NULL;
+            index += len;
+        }
+        return LazyList_item(self, index);
+    }
     
-    crous_value *value = NULL;
-    crous_err_t err = crous_decode(buf, (size_t)buf_size, &value);
-    
-    if (err != CROUS_OK) {
-        PyErr_SetString(CrousDecodeError, crous_err_str(err));
-        if (value) crous_value_free_tree(value);
-        return NULL;
+    if (PySlice_Check(key)) {
+        Py_ssize_t start, stop, step;
+        if (PySlice_Unpack(key, &start, &stop, &step) < 0) return NULL;
+        Py_ssize_t len = Lazy_length(self);
+        if (len < 0) return NULL;
+        Py_ssize_t count = PySlice_AdjustIndices(len, &start, &stop, step);
+        
+        PyObject *list = PyList_New(count);
+        if (!list) return NULL;
+        for (Py_ssize_t i = 0; i < count; i++) {
+            PyObject *item = LazyList_item(self, start + i * step);
+            if (!item) {
+                Py_DECREF(list);
+                return NULL;
+            }
+            PyList_SET_ITEM(list, i, item);
+        }
+        return list;
     }
     
-    PyObject *result = crous_to_pyobj_with_hook(value, self->object_hook);
-    crous_value_free_tree(value);
-    return result;
+    PyErr_Format(PyExc_TypeError, "list indices must be integers or slices, not %.200s",
+                 Py_TYPE(key)->tp_name);
+    return NULL;
 }
 
-static PyMethodDef CrousDecoder_methods[] = {
-    {"decode", (PyCFunction)CrousDecoder_decode, METH_VARARGS,
-     "Decode Crous binary data to a Python object."},
+static PyObject* LazyList_iter(LazyValueObject *self) {
+    return lazy_iter_new(self, LAZY_ITER_VALUES);
+}
+
+static PyObject* LazyList_repr(LazyValueObject *self) {
+    Py_ssize_t len = Lazy_length(self);
+    if (len < 0) return NULL;
+    return PyUnicode_FromFormat("<crous.LazyList with %zd items>", len);
+}
+
+static PyMethodDef LazyList_methods[] = {
+    {"to_python", (PyCFunction)Lazy_to_python, METH_NOARGS,
+     "Decode the whole list (or tuple) into plain Python objects."},
     {NULL, NULL, 0, NULL}
 };
 
-static PyTypeObject CrousDecoderType = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "crous.CrousDecoder",
-    .tp_doc = "Crous decoder class for deserializing binary data to Python objects.",
-    .tp_basicsize = sizeof(CrousDecoderObject),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = CrousDecoder_new,
-    .tp_init = (initproc)CrousDecoder_init,
-    .tp_dealloc = (destructor)CrousDecoder_dealloc,
-    .tp_methods = CrousDecoder_methods,
+static PyMappingMethods LazyList_as_mapping = {
+    .mp_length = (lenfunc)Lazy_length,
+    .mp_subscript = (binaryfunc)LazyList_subscript,
 };
 
-/* ============================================================================
-   PYTHON MODULE FUNCTIONS
-   ============================================================================ */
+static PySequenceMethods LazyList_as_sequence = {
+    .sq_length = (lenfunc)Lazy_length,
+    .sq_item = (ssizeargfunc)LazyList_item,
+};
 
-static PyObject* py_dumps(PyObject *self, PyObject *args, PyObject *kwargs) {
-    PyObject *obj;
-    PyObject *default_func = NULL;
-    PyObject *encoder = NULL;
-    int allow_custom = 1;
-    static char *kwlist[] = {"obj", "default", "encoder", "allow_custom", NULL};
+static PyTypeObject LazyListType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous.LazyList",
+    .tp_doc = "Read-only list proxy returned by loads_lazy(); items are decoded on access.",
+    .tp_basicsize = sizeof(LazyValueObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)Lazy_dealloc,
+    .tp_repr = (reprfunc)LazyList_repr,
+    .tp_as_mapping = &LazyList_as_mapping,
+    .tp_as_sequence = &LazyList_as_sequence,
+    .tp_richcompare = Lazy_richcompare,
+    .tp_iter = (getiterfunc)LazyList_iter,
+    .tp_methods = LazyList_methods,
+};
+
+static PyObject* py_loads_lazy(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *data;
+    static char *kwlist[] = {"data", NULL};
     
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOp", kwlist, 
-                                      &obj, &default_func, &encoder, &allow_custom)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &data)) {
         return NULL;
     }
     
-    crous_err_t err = CROUS_OK;
-    crous_value *value = pyobj_to_crous_with_default(obj, default_func, &err);
-    if (!value) {
-        if (!PyErr_Occurred()) {
-            PyErr_SetString(CrousEncodeError, crous_err_str(err));
-        }
+    LazyDocObject *doc = PyObject_New(LazyDocObject, &LazyDocType);
+    if (!doc) return NULL;
+    doc->doc = NULL;
+    doc->lock = NULL;
+    doc->buf.obj = NULL;
+    if (PyObject_GetBuffer(data, &doc->buf, PyBUF_SIMPLE) < 0) {
+        doc->buf.obj = NULL;
+        Py_DECREF(doc);
         return NULL;
     }
     
-    uint8_t *buf = NULL;
-    size_t size = 0;
-    err = crous_encode(value, &buf, &size);
-    crous_value_free_tree(value);
-    
+    const uint8_t *buf = doc->buf.buf;
+    size_t buf_size = (size_t)doc->buf.len;
+    crous_err_t err = flux_view_open(buf, buf_size, &doc->doc);
+    if (err == CROUS_ERR_INVALID_HEADER && buf[0] == CROUS_MAGIC_0 && buf[1] == CROUS_MAGIC_1 &&
+        buf[2] == CROUS_MAGIC_2 && buf[3] == CROUS_MAGIC_3) {
+        /* Legacy CROUS input has no lazy form; decode it outright */
+        PyObject *result = decode_buffer_to_pyobj(buf, buf_size, NULL, doc->buf.readonly);
+        Py_DECREF(doc);
+        return result;
+    }
     if (err != CROUS_OK) {
-        PyErr_SetString(CrousEncodeError, crous_err_str(err));
-        free(buf);
-        return NULL;
+        Py_DECREF(doc);
+        return flux_decode_fail(err);
     }
     
-    PyObject *result = PyBytes_FromStringAndSize((const char *)buf, (Py_ssize_t)size);
-    free(buf);
+    doc->lock = PyThread_allocate_lock();
+    if (!doc->lock) {
+        Py_DECREF(doc);
+        return PyErr_NoMemory();
+    }
+    
+    flux_view_t root;
+    err = flux_view_root(doc->doc, &root);
+    PyObject *result = err == CROUS_OK ? lazy_value(doc, &root) : flux_decode_fail(err);
+    Py_DECREF(doc);
     return result;
 }
 
-static PyObject* py_loads(PyObject *self, PyObject *args, PyObject *kwargs) {
-    const uint8_t *buf;
-    Py_ssize_t buf_size;
-    PyObject *object_hook = NULL;
-    PyObject *decoder = NULL;
-    static char *kwlist[] = {"data", "object_hook", "decoder", NULL};
+/* ============================================================================
+   EVENT VISITORS
+   ============================================================================ */
+
+/* Bound methods of a Python visitor object; NULL where it has none */
+typedef struct {
+    PyObject *scalar;
+    PyObject *tag;
+    PyObject *begin;
+    PyObject *key;
+    PyObject *end;
+} py_visitor_state;
+
+/* Call a handler with a new reference to its arguments. A Python exception
+ * stops the walk. */
+static crous_err_t py_visitor_call(PyObject *method, PyObject *args) {
+    if (!args) return CROUS_ERR_OOM;
+    PyObject *res = PyObject_CallObject(method, args);
+    Py_DECREF(args);
+    if (!res) return CROUS_ERR_STREAM;
+    Py_DECREF(res);
+    return CROUS_OK;
+}
+
+static const char* py_visitor_kind(crous_type_t type) {
+    return type == CROUS_TYPE_DICT ? "dict" : type == CROUS_TYPE_TUPLE ? "tuple" : "list";
+}
+
+static crous_err_t py_visitor_scalar(void *ctx, const crous_value *v) {
+    py_visitor_state *st = (py_visitor_state *)ctx;
+    PyObject *obj;
+    switch (v->type) {
+        case CROUS_TYPE_NULL:   obj = Py_None; Py_INCREF(obj); break;
+        case CROUS_TYPE_BOOL:   obj = PyBool_FromLong(v->data.b); break;
+        case CROUS_TYPE_INT:    obj = PyLong_FromLongLong(v->data.i); break;
+        case CROUS_TYPE_FLOAT:  obj = PyFloat_FromDouble(v->data.f); break;
+        case CROUS_TYPE_STRING:
+            obj = PyUnicode_DecodeUTF8((const char *)v->data.s.data, (Py_ssize_t)v->data.s.len, "strict");
+            break;
+        case CROUS_TYPE_BYTES:
+            obj = PyBytes_FromStringAndSize((const char *)v->data.bytes.data, (Py_ssize_t)v->data.bytes.len);
+            break;
+        default:
+            return CROUS_ERR_INVALID_TYPE;
+    }
+    if (!obj) return CROUS_ERR_STREAM;
+    return py_visitor_call(st->scalar, Py_BuildValue("(N)", obj));
+}
+
+static crous_err_t py_visitor_tag(void *ctx, uint32_t tag) {
+    return py_visitor_call(((py_visitor_state *)ctx)->tag, Py_BuildValue("(k)", (unsigned long)tag));
+}
+
+static crous_err_t py_visitor_begin(void *ctx, crous_type_t type, size_t count) {
+    const char *kind = py_visitor_kind(type);
+    PyObject *args = count == CROUS_VISIT_COUNT_UNKNOWN ? Py_BuildValue("(sO)", kind, Py_None)
+                                                        : Py_BuildValue("(sn)", kind, (Py_ssize_t)count);
+    return py_visitor_call(((py_visitor_state *)ctx)->begin, args);
+}
+
+static crous_err_t py_visitor_key(void *ctx, const char *key, size_t key_len) {
+    PyObject *k = PyUnicode_DecodeUTF8(key, (Py_ssize_t)key_len, "strict");
+    if (!k) return CROUS_ERR_STREAM;
+    return py_visitor_call(((py_visitor_state *)ctx)->key, Py_BuildValue("(N)", k));
+}
+
+static crous_err_t py_visitor_end(void *ctx, crous_type_t type, size_t count) {
+    return py_visitor_call(((py_visitor_state *)ctx)->end, Py_BuildValue("(sn)", py_visitor_kind(type), (Py_ssize_t)count));
+}
+
+static PyObject* py_visit(PyObject *self, PyObject *args, PyObject *kwargs) {
+    (void)self;
+    PyObject *data, *visitor;
+    static char *kwlist[] = {"data", "visitor", NULL};
     
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y#|OO", kwlist, 
-                                      &buf, &buf_size, &object_hook, &decoder)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", kwlist, &data, &visitor)) {
         return NULL;
     }
     
-    crous_value *value = NULL;
-    crous_err_t err = crous_decode(buf, (size_t)buf_size, &value);
+    py_visitor_state st;
+    PyObject **slots[] = { &st.scalar, &st.tag, &st.begin, &st.key, &st.end };
+    static const char *names[] = { "scalar", "tag", "begin", "key", "end" };
+    for (int i = 0; i < 5; i++) {
+        *slots[i] = PyObject_GetAttrString(visitor, names[i]);
+        if (!*slots[i]) PyErr_Clear();
+    }
+    crous_visitor vis = {
+        st.scalar ? py_visitor_scalar : NULL,
+        st.tag ? py_visitor_tag : NULL,
+        st.begin ? py_visitor_begin : NULL,
+        st.key ? py_visitor_key : NULL,
+        st.end ? py_visitor_end : NULL,
+    };
+    
+    crous_err_t err;
+    if (PyUnicode_Check(data)) {
+        Py_ssize_t len;
+        const char *text = PyUnicode_AsUTF8AndSize(data, &len);
+        err = text ? crout_visit(text, (size_t)len, &vis, &st) : CROUS_ERR_STREAM;
+    } else {
+        Py_buffer buf;
+        if (PyObject_GetBuffer(data, &buf, PyBUF_SIMPLE) < 0) {
+            err = CROUS_ERR_STREAM;
+        } else {
+            err = flux_visit_binary(buf.buf, (size_t)buf.len, &vis, &st);
+            PyBuffer_Release(&buf);
+        }
+    }
     
+    for (int i = 0; i < 5; i++) Py_XDECREF(*slots[i]);
     if (err != CROUS_OK) {
-        PyErr_SetString(CrousDecodeError, crous_err_str(err));
-        if (value) crous_value_free_tree(value);
-        return NULL;
+        return PyErr_Occurred() ? NULL : flux_decode_fail(err);
     }
-    
-    PyObject *result = crous_to_pyobj_with_hook(value, object_hook);
-    crous_value_free_tree(value);
-    return result;
+    Py_RETURN_NONE;
 }
 
-static PyObject* py_dump(PyObject *self, PyObject *args, PyObject *kwargs) {
+/* ============================================================================
+   PYTHON MODULE FUNCTIONS
+   ============================================================================ */
+
+static PyObject* py_dumps(PyObject *self, PyObject *args, PyObject *kwargs) {
     PyObject *obj;
-    PyObject *fp;
     PyObject *default_func = NULL;
-    static char *kwlist[] = {"obj", "fp", "default", NULL};
-    
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", kwlist, 
-                                      &obj, &fp, &default_func)) {
+    PyObject *encoder = NULL;
+    int allow_custom = 1;
+    int threads = 1;
+    flux_binary_options_t opts = flux_binary_options_default();
+    static char *kwlist[] = {"obj", "default", "encoder", "allow_custom", "key_refs", "columnar",
+                             "compression", "dictionary", "checksum", "threads", "max_depth", "dedup", NULL};
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOpppO&O&piO&p", kwlist, 
+                                      &obj, &default_func, &encoder, &allow_custom,
+                                      &opts.key_refs, &opts.columnar, compression_converter, &opts.compression,
+                                      dictionary_converter, &opts.dictionary, &opts.checksum, &threads,
+                                      depth_converter, &opts.max_depth, &opts.dedup)) {
         return NULL;
     }
     
-    /* Convert Python object to crous value */
-    crous_err_t err = CROUS_OK;
-    crous_value *value = pyobj_to_crous_with_default(obj, default_func, &err);
-    if (!value) {
-        if (!PyErr_Occurred()) {
-            PyErr_SetString(CrousEncodeError, crous_err_str(err));
-        }
+    if (opts.dedup) return encode_tree_to_bytes(obj, default_func, &opts, threads);
+    return encode_pyobj_to_bytes(obj, default_func, &opts, threads);
+}
+
+static PyObject* py_dumps_into(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *obj;
+    PyObject *target;
+    Py_ssize_t offset = 0;
+    PyObject *default_func = NULL;
+    int threads = 1;
+    flux_binary_options_t opts = flux_binary_options_default();
+    static char *kwlist[] = {"obj", "buffer", "offset", "default", "key_refs", "columnar",
+                             "compression", "dictionary", "checksum", "threads", NULL};
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|n$OppO&O&pi", kwlist,
+                                      &obj, &target, &offset, &default_func,
+                                      &opts.key_refs, &opts.columnar, compression_converter, &opts.compression,
+                                      dictionary_converter, &opts.dictionary, &opts.checksum, &threads)) {
         return NULL;
     }
     
-    /* Encode to binary */
-    uint8_t *buf = NULL;
-    size_t size = 0;
-    err = crous_encode(value, &buf, &size);
-    crous_value_free_tree(value);
-    
-    if (err != CROUS_OK) {
-        PyErr_SetString(CrousEncodeError, crous_err_str(err));
-        free(buf);
+    /* Holding the export keeps a bytearray from being resized under us */
+    Py_buffer view;
+    if (PyObject_GetBuffer(target, &view, PyBUF_WRITABLE) < 0) return NULL;
+    if (offset < 0 || offset > view.len) {
+        PyBuffer_Release(&view);
+        PyErr_Format(PyExc_ValueError, "offset %zd is outside a buffer of %zd bytes", offset, view.len);
         return NULL;
     }
     
-    /* Write to file object */
-    PyObject *write_method = PyObject_GetAttrString(fp, "write");
-    if (!write_method) {
-        PyErr_SetString(PyExc_TypeError, "fp must have a write() method");
-        free(buf);
+    size_t cap = (size_t)(view.len - offset);
+    size_t size;
+    crous_err_t err = encode_pyobj_to_buffer(obj, default_func, &opts, threads,
+                                             (uint8_t *)view.buf + offset, cap, &size);
+    PyBuffer_Release(&view);
+    if (err == CROUS_OK) return PyLong_FromSize_t(size);
+    if (err != CROUS_ERR_OVERFLOW) return NULL;
+    
+    /* Too small: the error carries the room the encoding needs */
+    PyObject *exc = PyObject_CallFunction(CrousEncodeError, "N",
+                                          PyUnicode_FromFormat("buffer too small: need %zu bytes from offset %zd, have %zu",
+                                                               size, offset, cap));
+    if (!exc) return NULL;
+    PyObject *needed = PyLong_FromSize_t(size);
+    if (!needed || PyObject_SetAttrString(exc, "needed", needed) < 0) {
+        Py_XDECREF(needed);
+        Py_DECREF(exc);
         return NULL;
     }
+    Py_DECREF(needed);
+    PyErr_SetObject(CrousEncodeError, exc);
+    Py_DECREF(exc);
+    return NULL;
+}
+
+static PyObject* py_loads(PyObject *self, PyObject *args, PyObject *kwargs) {
+    Py_buffer data;
+    PyObject *object_hook = NULL;
+    PyObject *decoder = NULL;
+    PyObject *fields = NULL;
+    int max_depth = 0;
+    static char *kwlist[] = {"data", "object_hook", "decoder", "fields", "max_depth", NULL};
     
-    PyObject *bytes_obj = PyBytes_FromStringAndSize((const char *)buf, (Py_ssize_t)size);
-    free(buf);
-    if (!bytes_obj) {
-        Py_DECREF(write_method);
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|OOOO&", kwlist, 
+                                      &data, &object_hook, &decoder, &fields, depth_converter, &max_depth)) {
         return NULL;
     }
     
-    PyObject *result = PyObject_CallFunctionObjArgs(write_method, bytes_obj, NULL);
-    Py_DECREF(bytes_obj);
-    Py_DECREF(write_method);
-    
-    if (!result) {
+    /* Decoded in place; the export keeps a bytearray or mmap from being
+     * resized or closed under us, and paths that drop the GIL copy mutable
+     * input. A projection keeps the default depth limit. */
+    const uint8_t *buf = data.buf;
+    PyObject *result = fields && fields != Py_None
+        ? decode_fields_to_pyobj(buf, (size_t)data.len, fields, object_hook, data.readonly)
+        : decode_buffer_to_pyobj_depth(buf, (size_t)data.len, object_hook, max_depth, data.readonly);
+    PyBuffer_Release(&data);
+    return result;
+}
+
+static PyObject* py_dump(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *obj;
+    PyObject *fp;
+    PyObject *default_func = NULL;
+    flux_binary_options_t opts = flux_binary_options_default();
+    static char *kwlist[] = {"obj", "fp", "default", "key_refs", "columnar", "compression", "dictionary",
+                             "checksum", "max_depth", NULL};
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|OppO&O&pO&", kwlist, 
+                                      &obj, &fp, &default_func, &opts.key_refs, &opts.columnar,
+                                      compression_converter, &opts.compression,
+                                      dictionary_converter, &opts.dictionary, &opts.checksum,
+                                      depth_converter, &opts.max_depth)) {
         return NULL;
     }
     
-    Py_DECREF(result);
+    /* Encode and write to the file object block by block */
+    if (encode_pyobj_to_pyfile(obj, default_func, fp, &opts) != CROUS_OK) return NULL;
     Py_RETURN_NONE;
 }
 
+/*
+ * Decode a binary file object from a memory mapping of its remaining bytes.
+ * Returns 1 with *result set (NULL on a decode error) when the mapping was
+ * used, 0 when fp has to be read instead: no fileno(), text mode, or a file
+ * that cannot be mapped. Leaves fp at EOF, as read() would.
+ */
+static int load_mapped(PyObject *fp, PyObject *object_hook, int max_depth, PyObject **result) {
+    /* Text files get the read() path and its "must return bytes" error */
+    if (PyObject_HasAttrString(fp, "encoding")) return 0;
+
+    PyObject *fileno_obj = call_method_quiet(fp, "fileno");
+    if (!fileno_obj) return 0;
+    int fd = (int)PyLong_AsLong(fileno_obj);
+    Py_DECREF(fileno_obj);
+    if (fd == -1 && PyErr_Occurred()) {
+        PyErr_Clear();
+        return 0;
+    }
+
+    /* Pending writes of a read/write file must reach the file first */
+    PyObject *flushed = call_method_quiet(fp, "flush");
+    if (!flushed) return 0;
+    Py_DECREF(flushed);
+
+    PyObject *pos_obj = call_method_quiet(fp, "tell");
+    if (!pos_obj) return 0;
+    long long pos = PyLong_AsLongLong(pos_obj);
+    Py_DECREF(pos_obj);
+    if (pos < 0) {
+        PyErr_Clear();
+        return 0;
+    }
+
+    crous_file_view view;
+    if (crous_file_view_map_fd(fd, (uint64_t)pos, &view) != CROUS_OK) return 0;
+
+    *result = decode_buffer_to_pyobj_depth(view.data, view.size, object_hook, max_depth, 1);
+    crous_file_view_close(&view);
+
+    PyObject *end = PyObject_CallMethod(fp, "seek", "ii", 0, 2);
+    if (!end) {
+        Py_CLEAR(*result);
+        return 1;
+    }
+    Py_DECREF(end);
+    return 1;
+}
+
+/*
+ * Decode an in-memory file (io.BytesIO) straight from its getbuffer() view.
+ * Same contract as load_mapped(): 1 with *result set when used, 0 when fp
+ * has no buffer to lend. Leaves fp at EOF.
+ */
+static int load_buffered(PyObject *fp, PyObject *object_hook, int max_depth, PyObject **result) {
+    PyObject *view_obj = call_method_quiet(fp, "getbuffer");
+    if (!view_obj) return 0;
+    Py_buffer view;
+    if (PyObject_GetBuffer(view_obj, &view, PyBUF_SIMPLE) < 0) {
+        PyErr_Clear();
+        Py_DECREF(view_obj);
+        return 0;
+    }
+
+    PyObject *pos_obj = call_method_quiet(fp, "tell");
+    Py_ssize_t pos = pos_obj ? PyLong_AsSsize_t(pos_obj) : -1;
+    Py_XDECREF(pos_obj);
+    if (pos < 0 || pos > view.len) {
+        PyErr_Clear();
+        PyBuffer_Release(&view);
+        Py_DECREF(view_obj);
+        return 0;
+    }
+
+    *result = decode_buffer_to_pyobj_depth((const uint8_t *)view.buf + pos, (size_t)(view.len - pos),
+                                           object_hook, max_depth, view.readonly);
+    Py_ssize_t end = view.len;
+    PyBuffer_Release(&view);
+    /* Drop the export before seeking, or the BytesIO stays locked against resizing */
+    PyObject *released = PyObject_CallMethod(view_obj, "release", NULL);
+    Py_DECREF(view_obj);
+    if (!released) {
+        Py_CLEAR(*result);
+        return 1;
+    }
+    Py_DECREF(released);
+
+    PyObject *moved = PyObject_CallMethod(fp, "seek", "n", end);
+    if (!moved) {
+        Py_CLEAR(*result);
+        return 1;
+    }
+    Py_DECREF(moved);
+    return 1;
+}
+
 static PyObject* py_load(PyObject *self, PyObject *args, PyObject *kwargs) {
     PyObject *fp;
     PyObject *object_hook = NULL;
-    static char *kwlist[] = {"fp", "object_hook", NULL};
-    
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, 
-                                      &fp, &object_hook)) {
+    int max_depth = 0;
+    static char *kwlist[] = {"fp", "object_hook", "max_depth", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OO&", kwlist,
+                                      &fp, &object_hook, depth_converter, &max_depth)) {
         return NULL;
     }
-    
+
+    /* Regular files are decoded from a mapping and in-memory files from
+       their own buffer, without a read() copy */
+    PyObject *mapped_result = NULL;
+    if (load_mapped(fp, object_hook, max_depth, &mapped_result)) return mapped_result;
+    if (load_buffered(fp, object_hook, max_depth, &mapped_result)) return mapped_result;
+
     /* Read from file object */
     PyObject *read_method = PyObject_GetAttrString(fp, "read");
     if (!read_method) {
@@ -890,296 +5988,901 @@ static PyObject* py_load(PyObject *self, PyObject *args, PyObject *kwargs) {
         return NULL;
     }
     
-    PyObject *bytes_obj = PyObject_CallFunction(read_method, NULL);
+    PyObject *data_obj = PyObject_CallFunction(read_method, NULL);
     Py_DECREF(read_method);
     
-    if (!bytes_obj) {
+    if (!data_obj) {
+        return NULL;
+    }
+    
+    Py_buffer data;
+    if (PyObject_GetBuffer(data_obj, &data, PyBUF_SIMPLE) < 0) {
+        PyErr_SetString(PyExc_TypeError, "read() must return a bytes-like object");
+        Py_DECREF(data_obj);
+        return NULL;
+    }
+    
+    /* Decode from binary and convert to a Python object */
+    PyObject *result = decode_buffer_to_pyobj_depth(data.buf, (size_t)data.len, object_hook, max_depth,
+                                                    data.readonly);
+    PyBuffer_Release(&data);
+    Py_DECREF(data_obj);
+    return result;
+}
+
+static PyObject* py_dumps_stream(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *obj;
+    PyObject *fp;
+    PyObject *default_func = NULL;
+    flux_binary_options_t opts = flux_binary_options_default();
+    static char *kwlist[] = {"obj", "fp", "default", "key_refs", "columnar", "compression", "dictionary",
+                             "checksum", "max_depth", NULL};
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|OppO&O&pO&", kwlist, 
+                                      &obj, &fp, &default_func, &opts.key_refs, &opts.columnar,
+                                      compression_converter, &opts.compression,
+                                      dictionary_converter, &opts.dictionary, &opts.checksum,
+                                      depth_converter, &opts.max_depth)) {
         return NULL;
     }
     
-    if (!PyBytes_Check(bytes_obj)) {
-        PyErr_SetString(PyExc_TypeError, "read() must return bytes");
-        Py_DECREF(bytes_obj);
+    /* Use already-parsed arguments directly instead of re-forwarding
+       args/kwargs to py_dump, which would double-parse and could
+       silently corrupt keyword argument binding. */
+    
+    /* Encode and write to the file object block by block */
+    if (encode_pyobj_to_pyfile(obj, default_func, fp, &opts) != CROUS_OK) return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_loads_stream(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *fp;
+    PyObject *object_hook = NULL;
+    static char *kwlist[] = {"fp", "object_hook", NULL};
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, 
+                                      &fp, &object_hook)) {
         return NULL;
     }
     
-    const uint8_t *buf = (uint8_t *)PyBytes_AsString(bytes_obj);
-    Py_ssize_t buf_size = PyBytes_Size(bytes_obj);
+    /* Pull the input through crous_decode_stream in chunks instead of
+       reading the whole file into one bytes object first */
+    py_read_stream_state state;
+    if (read_stream_init(&state, fp) < 0) return NULL;
+    crous_input_stream in = { &state, py_read_stream };
     
-    /* Decode from binary */
     crous_value *value = NULL;
-    crous_err_t err = crous_decode(buf, (size_t)buf_size, &value);
+    crous_err_t err = crous_decode_stream(&in, &value);
+    read_stream_clear(&state);
     
-    Py_DECREF(bytes_obj);
+    if (state.failed) {
+        crous_value_free_tree(value);
+        return NULL;
+    }
     
     if (err != CROUS_OK) {
         PyErr_SetString(CrousDecodeError, crous_err_str(err));
-        if (value) crous_value_free_tree(value);
         return NULL;
     }
     
-    /* Convert crous value to Python object */
     PyObject *result = crous_to_pyobj_with_hook(value, object_hook);
     crous_value_free_tree(value);
     return result;
 }
 
-static PyObject* py_dumps_stream(PyObject *self, PyObject *args, PyObject *kwargs) {
-    PyObject *obj;
-    PyObject *fp;
-    PyObject *default_func = NULL;
-    static char *kwlist[] = {"obj", "fp", "default", NULL};
+/* ============================================================================
+   CUSTOM SERIALIZER/DECODER REGISTRATION
+   ============================================================================ */
+
+static PyObject* py_register_serializer(PyObject *self, PyObject *args) {
+    PyObject *type_obj;
+    PyObject *func;
     
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", kwlist, 
-                                      &obj, &fp, &default_func)) {
+    if (!PyArg_ParseTuple(args, "OO", &type_obj, &func)) {
         return NULL;
     }
     
-    /* Use already-parsed arguments directly instead of re-forwarding
-       args/kwargs to py_dump, which would double-parse and could
-       silently corrupt keyword argument binding. */
+    if (!PyType_Check(type_obj)) {
+        PyErr_SetString(PyExc_TypeError, "First argument must be a type");
+        return NULL;
+    }
     
-    /* Convert Python object to crous value */
-    crous_err_t err = CROUS_OK;
-    crous_value *value = pyobj_to_crous_with_default(obj, default_func, &err);
-    if (!value) {
-        if (!PyErr_Occurred()) {
-            PyErr_SetString(CrousEncodeError, crous_err_str(err));
-        }
+    if (!PyCallable_Check(func)) {
+        PyErr_SetString(PyExc_TypeError, "Second argument must be callable");
         return NULL;
     }
     
-    /* Encode to binary */
-    uint8_t *buf = NULL;
-    size_t size = 0;
-    err = crous_encode(value, &buf, &size);
-    crous_value_free_tree(value);
+    registry_lock_acquire();
     
-    if (err != CROUS_OK) {
-        PyErr_SetString(CrousEncodeError, crous_err_str(err));
-        free(buf);
+    /* Build modified copies; published dicts are never mutated */
+    PyObject *serializers = registry_copy(custom_serializers);
+    PyObject *tags = registry_copy(type_to_tag);
+    PyObject *tag_obj = PyLong_FromUnsignedLong(next_custom_tag);
+    
+    if (!serializers || !tags || !tag_obj ||
+        PyDict_SetItem(serializers, type_obj, func) < 0 ||
+        PyDict_SetItem(tags, type_obj, tag_obj) < 0) {
+        registry_lock_release();
+        Py_XDECREF(serializers);
+        Py_XDECREF(tags);
+        Py_XDECREF(tag_obj);
         return NULL;
     }
+    Py_DECREF(tag_obj);
     
-    /* Write to file object */
-    PyObject *write_method = PyObject_GetAttrString(fp, "write");
-    if (!write_method) {
-        PyErr_SetString(PyExc_TypeError, "fp must have a write() method");
-        free(buf);
+    /* Assign a tag to this type */
+    next_custom_tag++;
+    
+    PyObject *old_serializers = custom_serializers;
+    PyObject *old_tags = type_to_tag;
+    custom_serializers = serializers;
+    type_to_tag = tags;
+    registry_generation++;
+    
+    registry_lock_release();
+    Py_XDECREF(old_serializers);
+    Py_XDECREF(old_tags);
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_unregister_serializer(PyObject *self, PyObject *args) {
+    PyObject *type_obj;
+    
+    if (!PyArg_ParseTuple(args, "O", &type_obj)) {
         return NULL;
     }
     
-    PyObject *bytes_obj = PyBytes_FromStringAndSize((const char *)buf, (Py_ssize_t)size);
-    free(buf);
-    if (!bytes_obj) {
-        Py_DECREF(write_method);
+    if (!PyType_Check(type_obj)) {
+        PyErr_SetString(PyExc_TypeError, "Argument must be a type");
         return NULL;
     }
     
-    PyObject *result = PyObject_CallFunctionObjArgs(write_method, bytes_obj, NULL);
-    Py_DECREF(bytes_obj);
-    Py_DECREF(write_method);
+    registry_lock_acquire();
     
-    if (!result) {
+    PyObject *serializers = registry_copy(custom_serializers);
+    PyObject *tags = registry_copy(type_to_tag);
+    if (!serializers || !tags) {
+        registry_lock_release();
+        Py_XDECREF(serializers);
+        Py_XDECREF(tags);
         return NULL;
     }
     
-    Py_DECREF(result);
+    /* Ignore if key not found */
+    if (PyDict_DelItem(serializers, type_obj) < 0) PyErr_Clear();
+    if (PyDict_DelItem(tags, type_obj) < 0) PyErr_Clear();
+    
+    PyObject *old_serializers = custom_serializers;
+    PyObject *old_tags = type_to_tag;
+    custom_serializers = serializers;
+    type_to_tag = tags;
+    registry_generation++;
+    
+    registry_lock_release();
+    Py_XDECREF(old_serializers);
+    Py_XDECREF(old_tags);
     Py_RETURN_NONE;
 }
 
-static PyObject* py_loads_stream(PyObject *self, PyObject *args, PyObject *kwargs) {
-    PyObject *fp;
-    PyObject *object_hook = NULL;
-    static char *kwlist[] = {"fp", "object_hook", NULL};
+static PyObject* py_register_decoder(PyObject *self, PyObject *args) {
+    unsigned int tag;
+    PyObject *func;
     
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, 
-                                      &fp, &object_hook)) {
+    if (!PyArg_ParseTuple(args, "IO", &tag, &func)) {
         return NULL;
     }
     
-    /* Use already-parsed arguments directly instead of re-forwarding
-       args/kwargs to py_load. */
-    
-    /* Read from file object */
-    PyObject *read_method = PyObject_GetAttrString(fp, "read");
-    if (!read_method) {
-        PyErr_SetString(PyExc_TypeError, "fp must have a read() method");
+    if (!PyCallable_Check(func)) {
+        PyErr_SetString(PyExc_TypeError, "Second argument must be callable");
         return NULL;
     }
     
-    PyObject *bytes_obj = PyObject_CallFunction(read_method, NULL);
-    Py_DECREF(read_method);
+    PyObject *tag_key = PyLong_FromUnsignedLong(tag);
+    if (!tag_key) return NULL;
     
-    if (!bytes_obj) {
+    registry_lock_acquire();
+    
+    /* Add to a copy of the registry and publish it */
+    PyObject *decoders = registry_copy(custom_decoders);
+    if (!decoders || PyDict_SetItem(decoders, tag_key, func) < 0) {
+        registry_lock_release();
+        Py_XDECREF(decoders);
+        Py_DECREF(tag_key);
         return NULL;
     }
     
-    if (!PyBytes_Check(bytes_obj)) {
-        PyErr_SetString(PyExc_TypeError, "read() must return bytes");
-        Py_DECREF(bytes_obj);
+    PyObject *old_decoders = custom_decoders;
+    custom_decoders = decoders;
+    registry_generation++;
+    
+    registry_lock_release();
+    Py_XDECREF(old_decoders);
+    Py_DECREF(tag_key);
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_unregister_decoder(PyObject *self, PyObject *args) {
+    unsigned int tag;
+    
+    if (!PyArg_ParseTuple(args, "I", &tag)) {
         return NULL;
     }
     
-    const uint8_t *buf = (uint8_t *)PyBytes_AsString(bytes_obj);
-    Py_ssize_t buf_size = PyBytes_Size(bytes_obj);
-    
-    /* Decode from binary */
-    crous_value *value = NULL;
-    crous_err_t err = crous_decode(buf, (size_t)buf_size, &value);
+    PyObject *tag_key = PyLong_FromUnsignedLong(tag);
+    if (!tag_key) return NULL;
     
-    Py_DECREF(bytes_obj);
+    registry_lock_acquire();
     
-    if (err != CROUS_OK) {
-        PyErr_SetString(CrousDecodeError, crous_err_str(err));
-        if (value) crous_value_free_tree(value);
+    PyObject *decoders = registry_copy(custom_decoders);
+    if (!decoders) {
+        registry_lock_release();
+        Py_DECREF(tag_key);
         return NULL;
     }
     
-    /* Convert crous value to Python object */
-    PyObject *result = crous_to_pyobj_with_hook(value, object_hook);
-    crous_value_free_tree(value);
-    return result;
+    /* Ignore if key not found */
+    if (PyDict_DelItem(decoders, tag_key) < 0) PyErr_Clear();
+    
+    PyObject *old_decoders = custom_decoders;
+    custom_decoders = decoders;
+    registry_generation++;
+    
+    registry_lock_release();
+    Py_XDECREF(old_decoders);
+    Py_DECREF(tag_key);
+    Py_RETURN_NONE;
+}
+
+/* ============================================================================
+   CHECKSUMS
+   ============================================================================ */
+
+static PyObject* py_crc32c(PyObject *self, PyObject *args) {
+    (void)self;
+    Py_buffer data;
+    unsigned int crc = 0;
+    if (!PyArg_ParseTuple(args, "y*|I", &data, &crc)) return NULL;
+
+    /* Large buffers are hashed without the GIL; the buffer stays exported */
+    if (data.len >= CROUS_STREAM_CHUNK_SIZE) {
+        Py_BEGIN_ALLOW_THREADS
+        crc = crous_crc32c(crc, data.buf, (size_t)data.len);
+        Py_END_ALLOW_THREADS
+    } else {
+        crc = crous_crc32c(crc, data.buf, (size_t)data.len);
+    }
+    PyBuffer_Release(&data);
+    return PyLong_FromUnsignedLong(crc);
+}
+
+/* ============================================================================
+   THREAD POOL
+   ============================================================================ */
+
+static PyObject* py_set_threads(PyObject *self, PyObject *arg) {
+    (void)self;
+    int n = _PyLong_AsInt(arg);
+    if (n == -1 && PyErr_Occurred()) return NULL;
+    crous_pool_set_threads(n);
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_get_threads(PyObject *self, PyObject *Py_UNUSED(ignored)) {
+    (void)self;
+    return PyLong_FromLong(crous_pool_threads());
+}
+
+/* ============================================================================
+   INSTRUMENTATION
+   ============================================================================ */
+
+/* Key names of the crous_stats_t arrays; NULL entries are left out */
+static const char *const stats_format_names[CROUS_STATS_FMT_COUNT] = {
+    NULL, "flux", "legacy", "flux_text", "crout"
+};
+static const char *const stats_type_names[CROUS_STATS_TYPES] = {
+    "null", "bool", "int", "float", "string", "bytes", "list", "tuple", "dict", "tagged",
+    "i64_array", "f64_array"
+};
+static const char *const stats_phase_names[CROUS_PHASE_COUNT] = {
+    "decode", "encode", "transcode", "convert"
+};
+
+static int stats_set(PyObject *dict, const char *key, uint64_t value) {
+    PyObject *v = PyLong_FromUnsignedLongLong(value);
+    if (!v) return -1;
+    int rc = PyDict_SetItemString(dict, key, v);
+    Py_DECREF(v);
+    return rc;
+}
+
+static int stats_set_counts(PyObject *dict, const char *key, const uint64_t *counts,
+                            const char *const *names, int n) {
+    PyObject *sub = PyDict_New();
+    if (!sub) return -1;
+    for (int i = 0; i < n; i++) {
+        if (names[i] && stats_set(sub, names[i], counts[i]) < 0) {
+            Py_DECREF(sub);
+            return -1;
+        }
+    }
+    int rc = PyDict_SetItemString(dict, key, sub);
+    Py_DECREF(sub);
+    return rc;
+}
+
+static PyObject* py_get_stats(PyObject *self, PyObject *args, PyObject *kwargs) {
+    (void)self;
+    static char *kwlist[] = {"thread", NULL};
+    int thread = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$p", kwlist, &thread)) return NULL;
+    
+    crous_stats_t st;
+    if (thread) crous_stats_get_thread(&st);
+    else crous_stats_get(&st);
+    
+    PyObject *dict = PyDict_New();
+    if (!dict) return NULL;
+    if (PyDict_SetItemString(dict, "enabled", crous_stats_enabled() ? Py_True : Py_False) < 0 ||
+        stats_set_counts(dict, "bytes_encoded", st.bytes_encoded, stats_format_names, CROUS_STATS_FMT_COUNT) < 0 ||
+        stats_set_counts(dict, "bytes_decoded", st.bytes_decoded, stats_format_names, CROUS_STATS_FMT_COUNT) < 0 ||
+        stats_set_counts(dict, "values_created", st.values_created, stats_type_names, CROUS_STATS_TYPES) < 0 ||
+        stats_set(dict, "mallocs", st.mallocs) < 0 ||
+        stats_set(dict, "malloc_bytes", st.malloc_bytes) < 0 ||
+        stats_set(dict, "pool_hits", st.pool_hits) < 0 ||
+        stats_set(dict, "arena_chunks", st.arena_chunks) < 0 ||
+        stats_set(dict, "arena_bytes", st.arena_bytes) < 0 ||
+        stats_set(dict, "varint_reads", st.varint_reads) < 0 ||
+        stats_set(dict, "callbacks", st.callbacks) < 0 ||
+        stats_set_counts(dict, "calls", st.calls, stats_phase_names, CROUS_PHASE_COUNT) < 0 ||
+        stats_set_counts(dict, "time_ns", st.phase_ns, stats_phase_names, CROUS_PHASE_COUNT) < 0) {
+        Py_DECREF(dict);
+        return NULL;
+    }
+    return dict;
+}
+
+static PyObject* py_reset_stats(PyObject *self, PyObject *Py_UNUSED(ignored)) {
+    (void)self;
+    crous_stats_reset();
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_enable_stats(PyObject *self, PyObject *args, PyObject *kwargs) {
+    (void)self;
+    static char *kwlist[] = {"enabled", NULL};
+    int enabled = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p", kwlist, &enabled)) return NULL;
+    crous_stats_enable(enabled);
+    Py_RETURN_NONE;
 }
 
 /* ============================================================================
-   CUSTOM SERIALIZER/DECODER REGISTRATION
+   SHARED DICTIONARIES
    ============================================================================ */
 
-static PyObject* py_register_serializer(PyObject *self, PyObject *args) {
-    PyObject *type_obj;
-    PyObject *func;
+/*
+ * Train a dictionary on samples and register it under id. The samples go
+ * through the normal encoder first, so custom serializers apply to them as
+ * they will to the messages.
+ */
+static PyObject* py_register_dictionary(PyObject *self, PyObject *args) {
+    (void)self;
+    PyObject *id_obj;
+    PyObject *samples;
     
-    if (!PyArg_ParseTuple(args, "OO", &type_obj, &func)) {
+    if (!PyArg_ParseTuple(args, "O!O", &PyLong_Type, &id_obj, &samples)) {
         return NULL;
     }
     
-    if (!PyType_Check(type_obj)) {
-        PyErr_SetString(PyExc_TypeError, "First argument must be a type");
+    unsigned long id = PyLong_AsUnsignedLong(id_obj);
+    if (id == (unsigned long)-1 && PyErr_Occurred()) PyErr_Clear();
+    if (id == 0 || id == (unsigned long)-1 || id > FLUX_DICTIONARY_ID_MAX) {
+        PyErr_Format(PyExc_ValueError, "dictionary id must be between 1 and %lu", (unsigned long)FLUX_DICTIONARY_ID_MAX);
+        return NULL;
+    }
+    if (flux_dictionary_lookup((uint32_t)id)) {
+        PyErr_Format(PyExc_ValueError, "dictionary %lu is already registered", id);
         return NULL;
     }
     
-    if (!PyCallable_Check(func)) {
-        PyErr_SetString(PyExc_TypeError, "Second argument must be callable");
+    PyObject *encoded = PyList_New(0);
+    if (!encoded) return NULL;
+    PyObject *iter = PyObject_GetIter(samples);
+    if (!iter) {
+        Py_DECREF(encoded);
         return NULL;
     }
     
-    registry_lock_acquire();
+    flux_binary_options_t opts = flux_binary_options_default();
+    PyObject *item;
+    while ((item = PyIter_Next(iter))) {
+        PyObject *doc = encode_pyobj_to_bytes(item, NULL, &opts, 1);
+        Py_DECREF(item);
+        if (!doc || PyList_Append(encoded, doc) < 0) {
+            Py_XDECREF(doc);
+            break;
+        }
+        Py_DECREF(doc);
+    }
+    Py_DECREF(iter);
+    if (PyErr_Occurred()) {
+        Py_DECREF(encoded);
+        return NULL;
+    }
     
-    /* Initialize registries if needed */
-    if (!custom_serializers) {
-        custom_serializers = PyDict_New();
-        if (!custom_serializers) { registry_lock_release(); return NULL; }
+    Py_ssize_t count = PyList_GET_SIZE(encoded);
+    const uint8_t **docs = PyMem_Malloc((count ? count : 1) * sizeof(*docs));
+    size_t *sizes = PyMem_Malloc((count ? count : 1) * sizeof(*sizes));
+    if (!docs || !sizes) {
+        PyMem_Free(docs);
+        PyMem_Free(sizes);
+        Py_DECREF(encoded);
+        return PyErr_NoMemory();
     }
-    if (!type_to_tag) {
-        type_to_tag = PyDict_New();
-        if (!type_to_tag) { registry_lock_release(); return NULL; }
+    for (Py_ssize_t i = 0; i < count; i++) {
+        PyObject *doc = PyList_GET_ITEM(encoded, i);
+        docs[i] = (const uint8_t *)PyBytes_AS_STRING(doc);
+        sizes[i] = (size_t)PyBytes_GET_SIZE(doc);
     }
     
-    /* Add to registry */
-    if (PyDict_SetItem(custom_serializers, type_obj, func) < 0) {
-        registry_lock_release();
+    flux_dictionary_t *dict = NULL;
+    crous_err_t err;
+    Py_BEGIN_ALLOW_THREADS
+    err = flux_dictionary_train((uint32_t)id, docs, sizes, (size_t)count, &dict);
+    if (err == CROUS_OK) {
+        err = flux_dictionary_register(dict);
+        if (err != CROUS_OK) flux_dictionary_free(dict);
+    }
+    Py_END_ALLOW_THREADS
+    PyMem_Free(docs);
+    PyMem_Free(sizes);
+    Py_DECREF(encoded);
+    
+    if (err == CROUS_ERR_INVALID_TYPE) {
+        /* Another thread registered the id first */
+        PyErr_Format(PyExc_ValueError, "dictionary %lu is already registered", id);
         return NULL;
     }
-    
-    /* Assign a tag to this type */
-    PyObject *tag_obj = PyLong_FromUnsignedLong(next_custom_tag++);
-    if (!tag_obj) { registry_lock_release(); return NULL; }
-    
-    if (PyDict_SetItem(type_to_tag, type_obj, tag_obj) < 0) {
-        Py_DECREF(tag_obj);
-        registry_lock_release();
+    if (err == CROUS_ERR_OVERFLOW) {
+        PyErr_SetString(PyExc_ValueError, "too many dictionaries registered");
+        return NULL;
+    }
+    if (err != CROUS_OK) {
+        PyErr_SetString(CrousEncodeError, crous_err_str(err));
         return NULL;
     }
-    Py_DECREF(tag_obj);
-    
-    registry_lock_release();
     Py_RETURN_NONE;
 }
 
-static PyObject* py_unregister_serializer(PyObject *self, PyObject *args) {
-    PyObject *type_obj;
-    
-    if (!PyArg_ParseTuple(args, "O", &type_obj)) {
-        return NULL;
+/* ============================================================================
+   SCHEMAS
+   ============================================================================ */
+
+/* Encoder state; path is set once a value fails its node */
+typedef struct {
+    py_flux_writer *w;
+    const SchemaObject *s;
+    PyObject *path;         /* Field names and list indices, innermost first */
+    PyObject *problem;      /* What was wrong, as a str */
+} py_schema_encoder;
+
+static const char *schema_kind_name(const flux_schema_node_t *n) {
+    switch (n->kind) {
+        case FLUX_SCHEMA_BOOL: return "bool";
+        case FLUX_SCHEMA_INT: return "int";
+        case FLUX_SCHEMA_FLOAT: return "float";
+        case FLUX_SCHEMA_STRING: return "str";
+        case FLUX_SCHEMA_BYTES: return "bytes";
+        case FLUX_SCHEMA_LIST: return "list";
+        case FLUX_SCHEMA_RECORD: return "dict";
+        default: return "any";
     }
+}
+
+/* Start a failure: problem describes it, and the unwinding walk adds the
+ * path to it */
+static crous_err_t schema_fail(py_schema_encoder *e, PyObject *problem) {
+    e->problem = problem;
+    e->path = PyList_New(0);
+    return CROUS_ERR_INVALID_TYPE;
+}
+
+static crous_err_t schema_mismatch(py_schema_encoder *e, const flux_schema_node_t *n, PyObject *obj) {
+    return schema_fail(e, PyUnicode_FromFormat("expects %s%s, not %.200s", schema_kind_name(n),
+                                               n->nullable ? " or None" : "", Py_TYPE(obj)->tp_name));
+}
+
+/* On the way out of a failed value, note where it was */
+static crous_err_t schema_unwind(py_schema_encoder *e, crous_err_t err, PyObject *segment) {
+    if (e->path && segment && PyList_Append(e->path, segment) < 0) Py_CLEAR(e->path);
+    return err;
+}
+
+static crous_err_t schema_list_unwind(py_schema_encoder *e, crous_err_t err, Py_ssize_t i) {
+    if (!e->path) return err;
+    PyObject *index = PyLong_FromSsize_t(i);
+    schema_unwind(e, err, index);
+    Py_XDECREF(index);
+    return err;
+}
+
+/* obj laid out by node index. Schemas nest at most FLUX_SCHEMA_MAX_DEPTH
+ * deep, which bounds the recursion. */
+static crous_err_t pyobj_to_schema_node(py_schema_encoder *e, size_t index, PyObject *obj) {
+    const flux_schema_node_t *n = &e->s->nodes[index];
+    py_flux_writer *w = e->w;
+    crous_err_t err = CROUS_OK;
+    uint8_t *p;
     
-    if (!PyType_Check(type_obj)) {
-        PyErr_SetString(PyExc_TypeError, "Argument must be a type");
-        return NULL;
+    if (n->nullable) {
+        if (!(p = py_flux_reserve(w, 1, &err))) return err;
+        p[0] = obj != Py_None;
+        w->pos++;
+        if (obj == Py_None) return CROUS_OK;
     }
     
-    registry_lock_acquire();
-    
-    if (custom_serializers) {
-        PyDict_DelItem(custom_serializers, type_obj);
-        PyErr_Clear();  /* Ignore if key not found */
+    switch (n->kind) {
+        case FLUX_SCHEMA_BOOL:
+            if (!PyBool_Check(obj)) return schema_mismatch(e, n, obj);
+            if (!(p = py_flux_reserve(w, 1, &err))) return err;
+            p[0] = obj == Py_True;
+            w->pos++;
+            return CROUS_OK;
+        
+        case FLUX_SCHEMA_INT: {
+            if (!PyLong_Check(obj) || PyBool_Check(obj)) return schema_mismatch(e, n, obj);
+            int overflow = 0;
+            long long val = PyLong_AsLongLongAndOverflow(obj, &overflow);
+            if (overflow) return schema_fail(e, PyUnicode_FromString("holds an int too large to serialize"));
+            if (val == -1 && PyErr_Occurred()) return CROUS_ERR_ENCODE;
+            if (!(p = py_flux_reserve(w, CROUS_VARINT_MAX, &err))) return err;
+            w->pos = (size_t)(crous_varint_put(p, crous_zigzag_encode(val)) - w->buf);
+            return CROUS_OK;
+        }
+        
+        case FLUX_SCHEMA_FLOAT: {
+            if (!PyFloat_Check(obj)) return schema_mismatch(e, n, obj);
+            double val = PyFloat_AS_DOUBLE(obj);
+            if (!(p = py_flux_reserve(w, 8, &err))) return err;
+            memcpy(p, &val, 8);
+            w->pos += 8;
+            return CROUS_OK;
+        }
+        
+        case FLUX_SCHEMA_STRING: {
+            if (!PyUnicode_Check(obj)) return schema_mismatch(e, n, obj);
+            Py_ssize_t len;
+            const char *data = PyUnicode_AsUTF8AndSize(obj, &len);
+            if (!data) return CROUS_ERR_ENCODE;
+            return py_flux_write_span(w, -1, data, (size_t)len);
+        }
+        
+        case FLUX_SCHEMA_BYTES:
+            if (PyBytes_Check(obj))
+                return py_flux_write_span(w, -1, PyBytes_AS_STRING(obj), (size_t)PyBytes_GET_SIZE(obj));
+            if (PyByteArray_Check(obj))
+                return py_flux_write_span(w, -1, PyByteArray_AS_STRING(obj), (size_t)PyByteArray_GET_SIZE(obj));
+            return schema_mismatch(e, n, obj);
+        
+        case FLUX_SCHEMA_ANY:
+            return pyobj_to_flux(w, obj, NULL, 0);
+        
+        case FLUX_SCHEMA_LIST: {
+            if (!PyList_Check(obj) && !PyTuple_Check(obj)) return schema_mismatch(e, n, obj);
+            Py_ssize_t count = PySequence_Fast_GET_SIZE(obj);
+            if (!(p = py_flux_reserve(w, CROUS_VARINT_MAX, &err))) return err;
+            w->pos = (size_t)(crous_varint_put(p, (uint64_t)count) - w->buf);
+            
+            /* A list may change size under a nested default; index it each time */
+            for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(obj); i++) {
+                PyObject *item = PySequence_Fast_GET_ITEM(obj, i);
+                Py_INCREF(item);
+                err = pyobj_to_schema_node(e, index + 1, item);
+                Py_DECREF(item);
+                if (err != CROUS_OK) return schema_list_unwind(e, err, i);
+            }
+            if (PySequence_Fast_GET_SIZE(obj) != count) {
+                PyErr_SetString(PyExc_RuntimeError, "list changed size during iteration");
+                return CROUS_ERR_ENCODE;
+            }
+            return CROUS_OK;
+        }
+        
+        case FLUX_SCHEMA_RECORD: {
+            if (!PyDict_Check(obj)) return schema_mismatch(e, n, obj);
+            
+            for (size_t f = index + 1; f < n->end; f = e->s->nodes[f].end) {
+                PyObject *value = PyDict_GetItemWithError(obj, e->s->names[f]);
+                if (!value) {
+                    if (PyErr_Occurred()) return CROUS_ERR_ENCODE;
+                    return schema_unwind(e, schema_fail(e, PyUnicode_FromString("is missing")), e->s->names[f]);
+                }
+                Py_INCREF(value);
+                err = pyobj_to_schema_node(e, f, value);
+                Py_DECREF(value);
+                if (err != CROUS_OK) return schema_unwind(e, err, e->s->names[f]);
+            }
+            
+            /* Every field was there, so a larger dict holds keys the schema lacks */
+            if ((size_t)PyDict_GET_SIZE(obj) != n->count) {
+                PyObject *key, *value;
+                Py_ssize_t pos = 0;
+                while (PyDict_Next(obj, &pos, &key, &value)) {
+                    size_t f = index + 1;
+                    while (f < n->end && PyObject_RichCompareBool(key, e->s->names[f], Py_EQ) != 1) {
+                        f = e->s->nodes[f].end;
+                    }
+                    if (f == n->end) {
+                        return schema_unwind(e, schema_fail(e, PyUnicode_FromString("is not in the schema")), key);
+                    }
+                }
+                PyErr_SetString(PyExc_RuntimeError, "dictionary changed size during iteration");
+                return CROUS_ERR_ENCODE;
+            }
+            return CROUS_OK;
+        }
+    }
+    return CROUS_ERR_INTERNAL;
+}
+
+/* Raise what a failed encode found: "schema field 'a.b[2]' expects int, not str" */
+static void schema_raise(py_schema_encoder *e) {
+    if (!e->problem || !e->path) {
+        if (!PyErr_Occurred()) PyErr_NoMemory();
+        return;
     }
     
-    if (type_to_tag) {
-        PyDict_DelItem(type_to_tag, type_obj);
-        PyErr_Clear();
+    PyObject *where = PyUnicode_FromString("");
+    for (Py_ssize_t i = PyList_GET_SIZE(e->path) - 1; where && i >= 0; i--) {
+        PyObject *seg = PyList_GET_ITEM(e->path, i);
+        PyObject *next = PyLong_Check(seg) ? PyUnicode_FromFormat("%U[%S]", where, seg)
+                       : PyUnicode_GET_LENGTH(where) ? PyUnicode_FromFormat("%U.%S", where, seg)
+                       : PyUnicode_FromFormat("%S", seg);
+        Py_DECREF(where);
+        where = next;
     }
+    if (!where) return;
     
-    registry_lock_release();
-    Py_RETURN_NONE;
+    if (PyUnicode_GET_LENGTH(where)) {
+        PyErr_Format(CrousEncodeError, "schema field '%U' %U", where, e->problem);
+    } else {
+        PyErr_Format(CrousEncodeError, "schema value %U", e->problem);
+    }
+    Py_DECREF(where);
 }
 
-static PyObject* py_register_decoder(PyObject *self, PyObject *args) {
-    unsigned int tag;
-    PyObject *func;
-    
-    if (!PyArg_ParseTuple(args, "IO", &tag, &func)) {
-        return NULL;
+static void Schema_clear_compiled(SchemaObject *self) {
+    if (self->names) {
+        for (size_t i = 0; i < self->count; i++) Py_XDECREF(self->names[i]);
+        PyMem_Free(self->names);
     }
+    if (!self->registered) flux_schema_free(self->schema);
+    Py_CLEAR(self->spec);
+    self->schema = NULL;
+    self->nodes = NULL;
+    self->names = NULL;
+    self->count = 0;
+}
+
+static void Schema_dealloc(SchemaObject *self) {
+    Schema_clear_compiled(self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int Schema_init(SchemaObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"spec", "id", NULL};
+    PyObject *spec;
+    unsigned long id;
     
-    if (!PyCallable_Check(func)) {
-        PyErr_SetString(PyExc_TypeError, "Second argument must be callable");
-        return NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Uk", kwlist, &spec, &id)) {
+        return -1;
+    }
+    if (self->registered) {
+        PyErr_SetString(PyExc_TypeError, "a registered schema cannot be changed");
+        return -1;
+    }
+    if (id == 0 || id > FLUX_SCHEMA_ID_MAX) {
+        PyErr_Format(PyExc_ValueError, "schema id must be between 1 and %lu", (unsigned long)FLUX_SCHEMA_ID_MAX);
+        return -1;
     }
     
-    registry_lock_acquire();
+    Py_ssize_t len;
+    const char *text = PyUnicode_AsUTF8AndSize(spec, &len);
+    if (!text) return -1;
     
-    /* Initialize registry if needed */
-    if (!custom_decoders) {
-        custom_decoders = PyDict_New();
-        if (!custom_decoders) { registry_lock_release(); return NULL; }
+    flux_schema_t *schema;
+    crous_err_t err = flux_schema_new((uint32_t)id, text, (size_t)len, &schema);
+    if (err != CROUS_OK) {
+        if (err == CROUS_ERR_OOM) {
+            PyErr_NoMemory();
+        } else if (err == CROUS_ERR_DEPTH_EXCEEDED) {
+            PyErr_Format(PyExc_ValueError, "schema nests types deeper than %d", FLUX_SCHEMA_MAX_DEPTH);
+        } else {
+            PyErr_Format(PyExc_ValueError, "invalid schema %R", spec);
+        }
+        return -1;
     }
     
-    /* Add to registry */
-    PyObject *tag_key = PyLong_FromUnsignedLong(tag);
-    if (!tag_key) { registry_lock_release(); return NULL; }
-    
-    if (PyDict_SetItem(custom_decoders, tag_key, func) < 0) {
-        Py_DECREF(tag_key);
-        registry_lock_release();
-        return NULL;
+    size_t count;
+    const flux_schema_node_t *nodes = flux_schema_nodes(schema, &count);
+    PyObject **names = PyMem_Calloc(count, sizeof(*names));
+    if (!names) {
+        flux_schema_free(schema);
+        PyErr_NoMemory();
+        return -1;
     }
     
-    Py_DECREF(tag_key);
-    registry_lock_release();
-    Py_RETURN_NONE;
+    Schema_clear_compiled(self);
+    self->schema = schema;
+    self->nodes = nodes;
+    self->count = count;
+    self->names = names;
+    Py_INCREF(spec);
+    self->spec = spec;
+    
+    for (size_t i = 0; i < count; i++) {
+        if (!nodes[i].name) continue;
+        names[i] = PyUnicode_DecodeUTF8(nodes[i].name, (Py_ssize_t)nodes[i].name_len, "strict");
+        if (!names[i]) {
+            Schema_clear_compiled(self);
+            return -1;
+        }
+        PyUnicode_InternInPlace(&names[i]);
+    }
+    return 0;
 }
 
-static PyObject* py_unregister_decoder(PyObject *self, PyObject *args) {
-    unsigned int tag;
+static int Schema_check(SchemaObject *self) {
+    if (self->schema) return 1;
+    PyErr_SetString(PyExc_ValueError, "schema was not initialized");
+    return 0;
+}
+
+static PyObject* Schema_dumps(SchemaObject *self, PyObject *obj) {
+    if (!Schema_check(self)) return NULL;
+    
+    py_flux_writer w = { NULL, NULL, NULL, 0, PY_FLUX_WRITER_INITIAL, NULL, NULL, 0, 0, NULL, 0, 0, 0 };
+    w.bytes = PyBytes_FromStringAndSize(NULL, PY_FLUX_WRITER_INITIAL);
+    if (!w.bytes) return NULL;
+    w.buf = (uint8_t *)PyBytes_AS_STRING(w.bytes);
+    w.max_depth = PY_ENCODE_MAX_DEPTH;
+    
+    uint8_t header[FLUX_SCHEMA_HEADER_SIZE];
+    flux_schema_put_header(self->schema, header);
+    
+    crous_span span;
+    crous_span_begin(&span, "python_to_schema", CROUS_PHASE_CONVERT,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    py_schema_encoder e = { &w, self, NULL, NULL };
+    registry_snapshot local = { NULL };
+    w.registry = &local;
+    registry_snapshot_take(&local);
+    crous_err_t err = py_flux_write(&w, header, sizeof(header));
+    if (err == CROUS_OK) err = pyobj_to_schema_node(&e, 0, obj);
+    registry_snapshot_release(&local);
+    crous_span_end(&span, err, err == CROUS_OK ? w.pos : 0);
     
-    if (!PyArg_ParseTuple(args, "I", &tag)) {
+    if (err != CROUS_OK) {
+        Py_DECREF(w.bytes);
+        if (e.path || e.problem) schema_raise(&e);
+        else if (!PyErr_Occurred()) PyErr_SetString(CrousEncodeError, crous_err_str(err));
+        Py_XDECREF(e.path);
+        Py_XDECREF(e.problem);
         return NULL;
     }
+    if (_PyBytes_Resize(&w.bytes, (Py_ssize_t)w.pos) < 0) return NULL;
+    return w.bytes;
+}
+
+static PyObject* Schema_loads(SchemaObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"data", "object_hook", NULL};
+    Py_buffer data;
+    PyObject *object_hook = NULL;
     
-    registry_lock_acquire();
+    if (!Schema_check(self)) return NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|O", kwlist, &data, &object_hook)) {
+        return NULL;
+    }
+    if (object_hook == Py_None) object_hook = NULL;
     
-    if (custom_decoders) {
-        PyObject *tag_key = PyLong_FromUnsignedLong(tag);
-        if (tag_key) {
-            PyDict_DelItem(custom_decoders, tag_key);
-            Py_DECREF(tag_key);
-            PyErr_Clear();  /* Ignore if key not found */
-        }
+    py_key_cache keys;
+    memset(&keys, 0, sizeof(keys));
+    PyObject *result = schema_document_to_pyobj(self, data.buf, (size_t)data.len, object_hook, &keys, 0);
+    key_cache_clear(&keys);
+    PyBuffer_Release(&data);
+    return result;
+}
+
+static PyObject* Schema_get_id(SchemaObject *self, void *closure) {
+    (void)closure;
+    if (!Schema_check(self)) return NULL;
+    return PyLong_FromUnsignedLong(flux_schema_id(self->schema));
+}
+
+static PyObject* Schema_get_spec(SchemaObject *self, void *closure) {
+    (void)closure;
+    if (!Schema_check(self)) return NULL;
+    Py_INCREF(self->spec);
+    return self->spec;
+}
+
+static PyObject* Schema_get_registered(SchemaObject *self, void *closure) {
+    (void)closure;
+    return PyBool_FromLong(self->registered);
+}
+
+static PyObject* Schema_repr(SchemaObject *self) {
+    if (!self->schema) return PyUnicode_FromFormat("<%s (uninitialized)>", Py_TYPE(self)->tp_name);
+    return PyUnicode_FromFormat("%s(%R, id=%lu)", Py_TYPE(self)->tp_name, self->spec,
+                                (unsigned long)flux_schema_id(self->schema));
+}
+
+static PyMethodDef Schema_methods[] = {
+    {"dumps", (PyCFunction)Schema_dumps, METH_O,
+     "Encode obj, which must match the schema, to a schema document.\n\n"
+     "Raises CrousEncodeError naming the first field that does not match."},
+    {"loads", (PyCFunction)(void(*)(void))Schema_loads, METH_VARARGS | METH_KEYWORDS,
+     "Decode a document written with this schema, registered or not."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef Schema_getset[] = {
+    {"id", (getter)Schema_get_id, NULL, "Schema id, written in every document's header", NULL},
+    {"spec", (getter)Schema_get_spec, NULL, "Schema text the schema was compiled from", NULL},
+    {"registered", (getter)Schema_get_registered, NULL, "True once passed to register_schema()", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyTypeObject SchemaType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "crous.Schema",
+    .tp_doc = "A fixed message shape compiled into a positional encoder and decoder.",
+    .tp_basicsize = sizeof(SchemaObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Schema_init,
+    .tp_dealloc = (destructor)Schema_dealloc,
+    .tp_repr = (reprfunc)Schema_repr,
+    .tp_methods = Schema_methods,
+    .tp_getset = Schema_getset,
+};
+
+/*
+ * Register a Schema so loads() reads the documents that name its id. The
+ * compiled schema goes to the C registry as well, where tree decoders
+ * find it.
+ */
+static PyObject* py_register_schema(PyObject *self, PyObject *arg) {
+    (void)self;
+    if (!PyObject_TypeCheck(arg, &SchemaType)) {
+        PyErr_Format(PyExc_TypeError, "register_schema() takes a Schema, not %.200s", Py_TYPE(arg)->tp_name);
+        return NULL;
+    }
+    SchemaObject *schema = (SchemaObject *)arg;
+    if (!Schema_check(schema)) return NULL;
+    if (schema->registered) Py_RETURN_NONE;
+    
+    uint32_t id = flux_schema_id(schema->schema);
+    crous_err_t err = flux_schema_register(schema->schema);
+    if (err == CROUS_ERR_INVALID_TYPE) {
+        PyErr_Format(PyExc_ValueError, "schema %lu is already registered", (unsigned long)id);
+        return NULL;
+    }
+    if (err == CROUS_ERR_OVERFLOW) {
+        PyErr_SetString(PyExc_ValueError, "too many schemas registered");
+        return NULL;
     }
     
-    registry_lock_release();
+    /* From here on the registry owns the compiled schema */
+    schema->registered = 1;
+    PyObject *id_obj = PyLong_FromUnsignedLong(id);
+    if (!id_obj || PyDict_SetItem(registered_schemas, id_obj, arg) < 0) {
+        Py_XDECREF(id_obj);
+        return NULL;
+    }
+    Py_DECREF(id_obj);
     Py_RETURN_NONE;
 }
 
@@ -1194,17 +6897,48 @@ static PyObject* py_dumps_text(PyObject *self, PyObject *args, PyObject *kwargs)
     int use_tokens = 1;
     int pretty = 0;
     int indent = 2;
-    static char *kwlist[] = {"obj", "default", "use_tokens", "pretty", "indent", NULL};
+    int token_sample = 0;
+    PyObject *tokens_obj = Py_None;
+    static char *kwlist[] = {"obj", "default", "use_tokens", "pretty", "indent",
+                             "token_sample", "tokens", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Oppi", kwlist,
-                                      &obj, &default_func, &use_tokens, &pretty, &indent))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OppiiO", kwlist,
+                                      &obj, &default_func, &use_tokens, &pretty, &indent,
+                                      &token_sample, &tokens_obj))
         return NULL;
+    if (token_sample < 0) {
+        PyErr_SetString(PyExc_ValueError, "token_sample must be >= 0");
+        return NULL;
+    }
+
+    /* A fixed token table: keys in the order they get tokens */
+    crout_tokens_t *tokens = NULL;
+    if (tokens_obj != Py_None) {
+        PyObject *seq = PySequence_Fast(tokens_obj, "tokens must be a sequence of str");
+        if (!seq) return NULL;
+        crous_err_t terr = crout_tokens_new(&tokens);
+        Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+        for (Py_ssize_t i = 0; i < n && terr == CROUS_OK; i++) {
+            Py_ssize_t klen;
+            const char *k = PyUnicode_AsUTF8AndSize(PySequence_Fast_GET_ITEM(seq, i), &klen);
+            if (!k) break;
+            terr = crout_tokens_add(tokens, k, (size_t)klen);
+        }
+        Py_DECREF(seq);
+        if (terr != CROUS_OK || PyErr_Occurred()) {
+            if (!PyErr_Occurred())
+                PyErr_SetString(CrousEncodeError, crous_err_str(terr));
+            crout_tokens_free(tokens);
+            return NULL;
+        }
+    }
 
     crous_err_t err = CROUS_OK;
-    crous_value *value = pyobj_to_crous_with_default(obj, default_func, &err);
+    crous_value *value = pyobj_to_crous_with_default(obj, default_func, 0, &err);
     if (!value) {
         if (!PyErr_Occurred())
             PyErr_SetString(CrousEncodeError, crous_err_str(err));
+        crout_tokens_free(tokens);
         return NULL;
     }
 
@@ -1212,11 +6946,16 @@ static PyObject* py_dumps_text(PyObject *self, PyObject *args, PyObject *kwargs)
     opts.use_tokens = use_tokens;
     opts.pretty = pretty;
     opts.indent = indent;
+    opts.token_sample = token_sample;
+    opts.tokens = tokens;
 
     char *buf = NULL;
     size_t size = 0;
+    Py_BEGIN_ALLOW_THREADS
     err = crout_encode(value, &opts, &buf, &size);
     crous_value_free_tree(value);
+    crout_tokens_free(tokens);
+    Py_END_ALLOW_THREADS
 
     if (err != CROUS_OK) {
         PyErr_SetString(CrousEncodeError, crous_err_str(err));
@@ -1241,7 +6980,10 @@ static PyObject* py_loads_text(PyObject *self, PyObject *args, PyObject *kwargs)
         return NULL;
 
     crous_value *value = NULL;
-    crous_err_t err = crout_decode(buf, (size_t)buf_size, &value);
+    crous_err_t err;
+    Py_BEGIN_ALLOW_THREADS
+    err = crout_decode(buf, (size_t)buf_size, &value);
+    Py_END_ALLOW_THREADS
 
     if (err != CROUS_OK) {
         PyErr_SetString(CrousDecodeError, crous_err_str(err));
@@ -1254,17 +6996,49 @@ static PyObject* py_loads_text(PyObject *self, PyObject *args, PyObject *kwargs)
     return result;
 }
 
-static PyObject* py_text_to_flux(PyObject *self, PyObject *args) {
+/* Transcode into fp.write(), holding the GIL for the callbacks. Sets a
+ * Python exception on failure. */
+static PyObject* transcode_to_pyfile(PyObject *fp, const char *text, size_t text_len,
+                                     const uint8_t *flux, size_t flux_len,
+                                     const crout_options_t *opts) {
+    PyObject *write_method = PyObject_GetAttrString(fp, "write");
+    if (!write_method) {
+        PyErr_SetString(PyExc_TypeError, "fp must have a write() method");
+        return NULL;
+    }
+
+    py_write_stream_state state = { write_method, 0 };
+    crous_output_stream out = { &state, py_write_stream };
+    crous_err_t err = text ? crout_text_to_flux_stream(text, text_len, &out)
+                           : crout_flux_to_text_stream(flux, flux_len, opts, &out);
+    Py_DECREF(write_method);
+
+    if (err != CROUS_OK) {
+        if (!PyErr_Occurred()) PyErr_SetString(CrousError, crous_err_str(err));
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_text_to_flux(PyObject *self, PyObject *args, PyObject *kwargs) {
     (void)self;
     const char *text;
     Py_ssize_t text_len;
+    PyObject *fp = Py_None;
+    static char *kwlist[] = {"data", "fp", NULL};
 
-    if (!PyArg_ParseTuple(args, "s#", &text, &text_len))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s#|O", kwlist, &text, &text_len, &fp))
         return NULL;
 
+    if (fp != Py_None)
+        return transcode_to_pyfile(fp, text, (size_t)text_len, NULL, 0, NULL);
+
     uint8_t *buf = NULL;
     size_t size = 0;
-    crous_err_t err = crout_text_to_flux(text, (size_t)text_len, &buf, &size);
+    crous_err_t err;
+    Py_BEGIN_ALLOW_THREADS
+    err = crout_text_to_flux(text, (size_t)text_len, &buf, &size);
+    Py_END_ALLOW_THREADS
 
     if (err != CROUS_OK) {
         PyErr_SetString(CrousError, crous_err_str(err));
@@ -1283,19 +7057,33 @@ static PyObject* py_flux_to_text(PyObject *self, PyObject *args, PyObject *kwarg
     Py_ssize_t flux_len;
     int use_tokens = 1;
     int pretty = 0;
-    static char *kwlist[] = {"data", "use_tokens", "pretty", NULL};
+    PyObject *fp = Py_None;
+    int token_sample = 0;
+    static char *kwlist[] = {"data", "use_tokens", "pretty", "fp", "token_sample", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y#|pp", kwlist,
-                                      &flux, &flux_len, &use_tokens, &pretty))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y#|ppOi", kwlist,
+                                      &flux, &flux_len, &use_tokens, &pretty, &fp,
+                                      &token_sample))
+        return NULL;
+    if (token_sample < 0) {
+        PyErr_SetString(PyExc_ValueError, "token_sample must be >= 0");
         return NULL;
+    }
 
     crout_options_t opts = crout_options_default();
     opts.use_tokens = use_tokens;
     opts.pretty = pretty;
+    opts.token_sample = token_sample;
+
+    if (fp != Py_None)
+        return transcode_to_pyfile(fp, NULL, 0, flux, (size_t)flux_len, &opts);
 
     char *buf = NULL;
     size_t size = 0;
-    crous_err_t err = crout_flux_to_text(flux, (size_t)flux_len, &opts, &buf, &size);
+    crous_err_t err;
+    Py_BEGIN_ALLOW_THREADS
+    err = crout_flux_to_text(flux, (size_t)flux_len, &opts, &buf, &size);
+    Py_END_ALLOW_THREADS
 
     if (err != CROUS_OK) {
         PyErr_SetString(CrousError, crous_err_str(err));
@@ -1319,15 +7107,33 @@ static PyMethodDef crous_methods[] = {
      "    obj: Python object to serialize\n"
      "    default: Optional callable for custom types\n"
      "    encoder: Optional encoder instance (reserved)\n"
-     "    allow_custom: Whether to allow custom types (default True)\n\n"
+     "    allow_custom: Whether to allow custom types (default True)\n"
+     "    compression: None, or 'lz4' to compress the output block by block\n"
+     "    dictionary: None, or the id of a dictionary from register_dictionary()\n"
+     "    checksum: If true, give every block a CRC-32C that decoders verify\n"
+     "    threads: Threads for compressing and checksumming blocks, 0 for the pool size\n\n"
      "Returns:\n"
      "    bytes: Binary encoded data"},
+    {"dumps_into", (PyCFunction)(void(*)(void))py_dumps_into, METH_VARARGS | METH_KEYWORDS,
+     "Encode Python object into a writable buffer.\n\n"
+     "Args:\n"
+     "    obj: Python object to serialize\n"
+     "    buffer: Writable bytes-like object (bytearray, memoryview, mmap, ...)\n"
+     "    offset: Position in buffer to write at (default 0)\n"
+     "    default, key_refs, columnar, compression, dictionary, checksum, threads: as for dumps()\n\n"
+     "Returns:\n"
+     "    int: Number of bytes written\n\n"
+     "Raises:\n"
+     "    CrousEncodeError: If the encoding does not fit; its needed attribute is\n"
+     "        the size required from offset. The buffer may have been partly written"},
     {"loads", (PyCFunction)(void(*)(void))py_loads, METH_VARARGS | METH_KEYWORDS, 
      "Decode CROUS binary format to Python object.\n\n"
      "Args:\n"
      "    data: Bytes to decode\n"
      "    object_hook: Optional callable for dict post-processing\n"
-     "    decoder: Optional decoder instance (reserved)\n\n"
+     "    decoder: Optional decoder instance (reserved)\n"
+     "    fields: Optional iterable of paths such as \"user.id\" or \"items[*].sku\";\n"
+     "        only those are decoded (FLUX binary input only)\n\n"
      "Returns:\n"
      "    Deserialized Python object"},
     {"dump", (PyCFunction)(void(*)(void))py_dump, METH_VARARGS | METH_KEYWORDS, 
@@ -1335,16 +7141,60 @@ static PyMethodDef crous_methods[] = {
      "Args:\n"
      "    obj: Python object to serialize\n"
      "    fp: File-like object with write() method\n"
-     "    default: Optional callable for custom types"},
+     "    default: Optional callable for custom types\n"
+     "    compression: None, or 'lz4' to compress the output block by block\n"
+     "    dictionary: None, or the id of a dictionary from register_dictionary()\n"
+     "    checksum: If true, give every block a CRC-32C that decoders verify"},
     {"load", (PyCFunction)(void(*)(void))py_load, METH_VARARGS | METH_KEYWORDS, 
      "Deserialize object from file.\n\n"
      "Args:\n"
      "    fp: File-like object with read() method\n"
      "    object_hook: Optional callable for dict post-processing"},
     {"dumps_stream", (PyCFunction)(void(*)(void))py_dumps_stream, METH_VARARGS | METH_KEYWORDS, 
-     "Serialize object to stream (same as dump for file objects)."},
+     "Serialize object to stream, writing fp in blocks of up to 64 KiB."},
     {"loads_stream", (PyCFunction)(void(*)(void))py_loads_stream, METH_VARARGS | METH_KEYWORDS, 
-     "Deserialize object from stream (same as load for file objects)."},
+     "Deserialize object from stream, reading fp in chunks of up to 64 KiB."},
+    {"loads_lazy", (PyCFunction)(void(*)(void))py_loads_lazy, METH_VARARGS | METH_KEYWORDS,
+     "Open FLUX binary data for on-demand access.\n\n"
+     "Dicts and lists come back as LazyDict / LazyList proxies that decode\n"
+     "only the fields and items actually accessed, stepping over the rest\n"
+     "of the input without building it. Proxies keep data alive; it must\n"
+     "not be modified while they are in use.\n\n"
+     "Args:\n"
+     "    data: bytes-like FLUX binary data\n\n"
+     "Returns:\n"
+     "    LazyDict, LazyList, or the decoded value for scalar documents"},
+    {"visit", (PyCFunction)(void(*)(void))py_visit, METH_VARARGS | METH_KEYWORDS,
+     "Walk a document without building it, calling visitor methods per event.\n\n"
+     "Args:\n"
+     "    data: FLUX binary (bytes-like) or CROUT text (str)\n"
+     "    visitor: Object with any of scalar(value), tag(n), begin(kind, count),\n"
+     "        key(name) and end(kind, count); kind is 'list', 'tuple' or 'dict',\n"
+     "        and count is None in begin() when the format does not store it\n\n"
+     "Raises:\n"
+     "    CrousDecodeError: Malformed input; exceptions from visitor methods propagate"},
+    {"iter_load", (PyCFunction)(void(*)(void))py_iter_load, METH_VARARGS | METH_KEYWORDS,
+     "Iterate the records of a framed log written by FrameWriter.\n\n"
+     "fp is read in chunks of up to 64 KiB; only the record being decoded is\n"
+     "held in memory. A record cut short at the end of the log (an\n"
+     "interrupted append) or failing its checksum raises CrousDecodeError.\n\n"
+     "Args:\n"
+     "    fp: File-like object with read() method\n"
+     "    object_hook: Optional callable for dict post-processing\n\n"
+     "Returns:\n"
+     "    Iterator over the decoded records"},
+    {"load_parallel", (PyCFunction)(void(*)(void))py_load_parallel, METH_VARARGS | METH_KEYWORDS,
+     "Decode every record of a framed log into a list, in log order.\n\n"
+     "The file is memory-mapped and cut at its seek index into byte-balanced\n"
+     "record ranges. Workers check record checksums and unpack compressed\n"
+     "envelopes without the GIL; the objects are then built in order on the\n"
+     "calling thread.\n\n"
+     "Args:\n"
+     "    path: Path of the log\n"
+     "    workers: Threads to use, 0 for the pool size (set_threads())\n"
+     "    object_hook: Optional callable for dict post-processing\n\n"
+     "Returns:\n"
+     "    list of the decoded records"},
     {"register_serializer", py_register_serializer, METH_VARARGS, 
      "Register a custom serializer for a Python type.\n\n"
      "Args:\n"
@@ -1371,6 +7221,61 @@ static PyMethodDef crous_methods[] = {
      "Unregister a custom decoder.\n\n"
      "Args:\n"
      "    tag: Tag identifier to unregister"},
+    {"set_threads", py_set_threads, METH_O,
+     "Set the size of the worker pool shared by every parallel path.\n\n"
+     "Args:\n"
+     "    n: Threads one operation may use, the calling thread included;\n"
+     "       0 or less for one per CPU"},
+    {"get_threads", py_get_threads, METH_NOARGS,
+     "Size of the worker pool (one per CPU until set_threads() is called)."},
+    {"enable_stats", (PyCFunction)(void(*)(void))py_enable_stats, METH_VARARGS | METH_KEYWORDS,
+     "Turn the built-in counters on or off (off by default).\n\n"
+     "Counting adds a branch and an increment per value, so leave it off\n"
+     "outside diagnosis. Counts are kept while it is off.\n\n"
+     "Args:\n"
+     "    enabled: True to count (default), False to stop"},
+    {"get_stats", (PyCFunction)(void(*)(void))py_get_stats, METH_VARARGS | METH_KEYWORDS,
+     "Counters since the last reset_stats(), summed over all threads.\n\n"
+     "Args:\n"
+     "    thread: Only the calling thread's counters (default False)\n\n"
+     "Returns:\n"
+     "    dict: enabled; bytes_encoded and bytes_decoded per format;\n"
+     "    values_created per type; mallocs, malloc_bytes, pool_hits,\n"
+     "    arena_chunks, arena_bytes, varint_reads, callbacks; and calls and\n"
+     "    time_ns per phase (decode, encode, transcode, convert)"},
+    {"reset_stats", py_reset_stats, METH_NOARGS,
+     "Zero the counters of every thread."},
+    {"crc32c", py_crc32c, METH_VARARGS,
+     "CRC-32C (Castagnoli) of a bytes-like object.\n\n"
+     "Uses the CPU's CRC instructions where available. Pass a previous\n"
+     "result as value to continue over data in pieces.\n\n"
+     "Args:\n"
+     "    data: bytes, bytearray, memoryview or another buffer\n"
+     "    value: CRC to continue from (default 0)\n\n"
+     "Returns:\n"
+     "    int: Unsigned 32-bit CRC"},
+    {"register_dictionary", py_register_dictionary, METH_VARARGS,
+     "Train a shared dictionary on sample messages and register it.\n\n"
+     "Messages encoded with dictionary=id refer to its keys by index and\n"
+     "compress against its content, which saves most on small messages of\n"
+     "one shape. Decoding needs the same dictionary registered under the\n"
+     "same id, so every process registers it from the same samples.\n"
+     "Registration is for the life of the process; an id cannot be reused.\n\n"
+     "Args:\n"
+     "    id: Dictionary id, 1 to 16777215\n"
+     "    samples: Iterable of representative objects\n\n"
+     "Example:\n"
+     "    crous.register_dictionary(1, recent_events)\n"
+     "    data = crous.dumps(event, dictionary=1, compression='lz4')"},
+    {"register_schema", py_register_schema, METH_O,
+     "Register a Schema so loads() reads the documents written with it.\n\n"
+     "Documents name their schema by id, so every process registers the\n"
+     "same schema under the same id. Registration is for the life of the\n"
+     "process; an id cannot be reused.\n\n"
+     "Example:\n"
+     "    request = crous.Schema({'id': int, 'method': str, 'params': object}, id=1)\n"
+     "    crous.register_schema(request)\n"
+     "    crous.loads(request.dumps(msg)) == msg"},
     {"dumps_text", (PyCFunction)(void(*)(void))py_dumps_text, METH_VARARGS | METH_KEYWORDS,
      "Encode Python object to CROUT text format.\n\n"
      "Args:\n"
@@ -1378,7 +7283,10 @@ static PyMethodDef crous_methods[] = {
      "    default: Optional callable for custom types\n"
      "    use_tokens: Build token table for repeated keys (default True)\n"
      "    pretty: Pretty-print with indentation (default False)\n"
-     "    indent: Spaces per indent level (default 2)\n\n"
+     "    indent: Spaces per indent level (default 2)\n"
+     "    token_sample: Count keys in the first N dicts only (default 0 = all)\n"
+     "    tokens: Fixed token table as a sequence of keys, used instead of\n"
+     "        counting; skips the walk over the data before encoding\n\n"
      "Returns:\n"
      "    str: CROUT-encoded text"},
     {"loads_text", (PyCFunction)(void(*)(void))py_loads_text, METH_VARARGS | METH_KEYWORDS,
@@ -1388,20 +7296,23 @@ static PyMethodDef crous_methods[] = {
      "    object_hook: Optional callable for dict post-processing\n\n"
      "Returns:\n"
      "    Deserialized Python object"},
-    {"text_to_flux", py_text_to_flux, METH_VARARGS,
+    {"text_to_flux", (PyCFunction)(void(*)(void))py_text_to_flux, METH_VARARGS | METH_KEYWORDS,
      "Convert CROUT text to FLUX binary.\n\n"
      "Args:\n"
-     "    data: CROUT text string\n\n"
+     "    data: CROUT text string\n"
+     "    fp: Optional binary file to write the output to instead\n\n"
      "Returns:\n"
-     "    bytes: FLUX binary data"},
+     "    bytes: FLUX binary data, or None when fp is given"},
     {"flux_to_text", (PyCFunction)(void(*)(void))py_flux_to_text, METH_VARARGS | METH_KEYWORDS,
      "Convert FLUX binary to CROUT text.\n\n"
      "Args:\n"
      "    data: FLUX binary bytes\n"
      "    use_tokens: Build token table (default True)\n"
-     "    pretty: Pretty-print (default False)\n\n"
+     "    pretty: Pretty-print (default False)\n"
+     "    fp: Optional binary file to write the UTF-8 text to instead\n"
+     "    token_sample: Count keys in the first N dicts only (default 0 = all)\n\n"
      "Returns:\n"
-     "    str: CROUT text"},
+     "    str: CROUT text, or None when fp is given"},
     {NULL, NULL, 0, NULL}
 };
 
@@ -1423,6 +7334,12 @@ PyMODINIT_FUNC PyInit_crous(void) {
     PyObject *m = PyModule_Create(&crous_module);
     if (!m) return NULL;
     
+    PyDateTime_IMPORT;
+    if (!PyDateTimeAPI) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    
     /* Initialize type objects */
     if (PyType_Ready(&CrousEncoderType) < 0) {
         Py_DECREF(m);
@@ -1432,6 +7349,17 @@ PyMODINIT_FUNC PyInit_crous(void) {
         Py_DECREF(m);
         return NULL;
     }
+    if (PyType_Ready(&LazyDocType) < 0 || PyType_Ready(&LazyDictType) < 0 ||
+        PyType_Ready(&LazyListType) < 0 || PyType_Ready(&LazyIterType) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    if (PyType_Ready(&FrameWriterType) < 0 || PyType_Ready(&FrameIterType) < 0 ||
+        PyType_Ready(&FrameFileType) < 0 || PyType_Ready(&FrameFileIterType) < 0 ||
+        PyType_Ready(&UnpackerType) < 0 || PyType_Ready(&SchemaType) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
     
     /* Create exception classes */
     CrousError = PyErr_NewException("crous.CrousError", NULL, NULL);
@@ -1485,10 +7413,53 @@ PyMODINIT_FUNC PyInit_crous(void) {
         return NULL;
     }
     
+    Py_INCREF(&LazyDictType);
+    if (PyModule_AddObject(m, "LazyDict", (PyObject *)&LazyDictType) < 0) {
+        Py_DECREF(&LazyDictType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    
+    Py_INCREF(&LazyListType);
+    if (PyModule_AddObject(m, "LazyList", (PyObject *)&LazyListType) < 0) {
+        Py_DECREF(&LazyListType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    
+    Py_INCREF(&FrameWriterType);
+    if (PyModule_AddObject(m, "FrameWriter", (PyObject *)&FrameWriterType) < 0) {
+        Py_DECREF(&FrameWriterType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    
+    Py_INCREF(&FrameFileType);
+    if (PyModule_AddObject(m, "FrameFile", (PyObject *)&FrameFileType) < 0) {
+        Py_DECREF(&FrameFileType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    
+    Py_INCREF(&UnpackerType);
+    if (PyModule_AddObject(m, "Unpacker", (PyObject *)&UnpackerType) < 0) {
+        Py_DECREF(&UnpackerType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    
+    Py_INCREF(&SchemaType);
+    if (PyModule_AddObject(m, "Schema", (PyObject *)&SchemaType) < 0) {
+        Py_DECREF(&SchemaType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    
     /* Initialize custom serializer/decoder registries */
     custom_serializers = PyDict_New();
     custom_decoders = PyDict_New();
     type_to_tag = PyDict_New();
+    registered_schemas = PyDict_New();
     
     /* Initialize registry lock for thread-safety (C-3 fix) */
     registry_lock = PyThread_allocate_lock();
@@ -1497,5 +7468,10 @@ PyMODINIT_FUNC PyInit_crous(void) {
         return NULL;
     }
     
+#ifdef Py_GIL_DISABLED
+    /* Shared state is the copy-on-write registry, guarded by registry_lock */
+    PyUnstable_Module_SetGIL(m, Py_MOD_GIL_NOT_USED);
+#endif
+    
     return m;
 }
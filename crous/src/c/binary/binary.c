@@ -1,6 +1,8 @@
 #include "../include/crous_binary.h"
 #include "../include/crous_value.h"
+#include "../include/crous_scan.h"
 #include "../include/crous_flux.h"
+#include "../include/crous_stats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -61,8 +63,13 @@ static crous_err_t stream_write_varint(crous_output_stream *out, uint64_t value)
 
 static crous_err_t stream_read(crous_input_stream *in, uint8_t *buf, size_t len) {
     if (in->read == NULL) return CROUS_ERR_STREAM;
-    size_t read = in->read(in->user_data, buf, len);
-    if (read < len) return CROUS_ERR_TRUNCATED;
+    /* Sources such as pipes and sockets may return short reads */
+    size_t got = 0;
+    while (got < len) {
+        size_t read = in->read(in->user_data, buf + got, len - got);
+        if (read == 0 || read == (size_t)-1) return CROUS_ERR_TRUNCATED;
+        got += read;
+    }
     return CROUS_OK;
 }
 
@@ -74,6 +81,7 @@ static crous_err_t stream_read_varint(crous_input_stream *in, uint64_t *out) {
     uint64_t result = 0;
     int shift = 0;
     
+    CROUS_STAT_ADD(varint_reads, 1);
     for (int i = 0; i < 10; i++) {
         uint8_t byte;
         crous_err_t err = stream_read_byte(in, &byte);
@@ -102,33 +110,6 @@ static inline int is_small_negint(int64_t v) {
     return v >= -32 && v <= -1;
 }
 
-static int is_utf8_valid(const uint8_t *data, size_t len) {
-    for (size_t i = 0; i < len; ) {
-        uint8_t byte = data[i];
-        int cont_bytes = 0;
-        
-        if ((byte & 0x80) == 0) {
-            cont_bytes = 0;
-        } else if ((byte & 0xE0) == 0xC0) {
-            cont_bytes = 1;
-        } else if ((byte & 0xF0) == 0xE0) {
-            cont_bytes = 2;
-        } else if ((byte & 0xF8) == 0xF0) {
-            cont_bytes = 3;
-        } else {
-            return 0;
-        }
-        
-        i++;
-        for (int j = 0; j < cont_bytes; j++) {
-            if (i >= len) return 0;
-            uint8_t cont = data[i++];
-            if ((cont & 0xC0) != 0x80) return 0;
-        }
-    }
-    return 1;
-}
-
 /* ============================================================================
    ENCODING
    ============================================================================ */
@@ -275,9 +256,9 @@ static crous_err_t encode_value_to_stream(const crous_value *v, crous_output_str
    DECODING
    ============================================================================ */
 
-static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value **out_value, int depth);
+static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_arena *arena, crous_value **out_value, int depth);
 
-static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value **out_value, int depth) {
+static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_arena *arena, crous_value **out_value, int depth) {
     if (depth >= CROUS_MAX_DEPTH) return CROUS_ERR_DECODE;
     
     uint8_t tag;
@@ -287,21 +268,21 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
     crous_value *v = NULL;
     
     if (tag == CROUS_TAG_NULL) {
-        v = crous_value_new_null();
+        v = crous_value_new_null_arena(arena);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag == CROUS_TAG_FALSE) {
-        v = crous_value_new_bool(0);
+        v = crous_value_new_bool_arena(arena, 0);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag == CROUS_TAG_TRUE) {
-        v = crous_value_new_bool(1);
+        v = crous_value_new_bool_arena(arena, 1);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag >= CROUS_TAG_POSINT_BASE && tag <= CROUS_TAG_POSINT_MAX) {
         int64_t val = tag - CROUS_TAG_POSINT_BASE;
-        v = crous_value_new_int(val);
+        v = crous_value_new_int_arena(arena, val);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag >= CROUS_TAG_NEGINT_BASE && tag <= CROUS_TAG_NEGINT_MAX) {
         int64_t val = -1 - (tag - CROUS_TAG_NEGINT_BASE);
-        v = crous_value_new_int(val);
+        v = crous_value_new_int_arena(arena, val);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag == CROUS_TAG_INT64) {
         uint8_t bytes[8];
@@ -311,7 +292,7 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
         for (int i = 0; i < 8; i++) {
             val |= ((int64_t)bytes[i]) << (i * 8);
         }
-        v = crous_value_new_int(val);
+        v = crous_value_new_int_arena(arena, val);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag == CROUS_TAG_FLOAT64) {
         uint8_t bytes[8];
@@ -319,7 +300,7 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
         if (err != CROUS_OK) return err;
         double d;
         memcpy(&d, bytes, 8);
-        v = crous_value_new_float(d);
+        v = crous_value_new_float_arena(arena, d);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag == CROUS_TAG_STRING) {
         uint64_t len;
@@ -335,12 +316,12 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
             return err;
         }
         
-        if (!is_utf8_valid(str_data, len)) {
+        if (!crous_utf8_valid(str_data, len)) {
             free(str_data);
             return CROUS_ERR_DECODE;
         }
         
-        v = crous_value_new_string((const char *)str_data, len);
+        v = crous_value_new_string_arena(arena, (const char *)str_data, len);
         free(str_data);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag == CROUS_TAG_BYTES) {
@@ -357,7 +338,7 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
             return err;
         }
         
-        v = crous_value_new_bytes(bytes_data, len);
+        v = crous_value_new_bytes_arena(arena, bytes_data, len);
         free(bytes_data);
         if (!v) return CROUS_ERR_OOM;
     } else if (tag == CROUS_TAG_LIST) {
@@ -365,12 +346,12 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
         err = stream_read_varint(in, &count);
         if (err != CROUS_OK || count > CROUS_MAX_LIST_SIZE) return CROUS_ERR_DECODE;
         
-        v = crous_value_new_list(count);
+        v = crous_value_new_list_arena(arena, count);
         if (!v) return CROUS_ERR_OOM;
         
         for (uint64_t i = 0; i < count; i++) {
             crous_value *item = NULL;
-            err = decode_value_from_stream(in, &item, depth + 1);
+            err = decode_value_from_stream(in, arena, &item, depth + 1);
             if (err != CROUS_OK) {
                 crous_value_free_tree(v);
                 return err;
@@ -386,12 +367,12 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
         err = stream_read_varint(in, &count);
         if (err != CROUS_OK || count > CROUS_MAX_LIST_SIZE) return CROUS_ERR_DECODE;
         
-        v = crous_value_new_tuple(count);
+        v = crous_value_new_tuple_arena(arena, count);
         if (!v) return CROUS_ERR_OOM;
         
         for (uint64_t i = 0; i < count; i++) {
             crous_value *item = NULL;
-            err = decode_value_from_stream(in, &item, depth + 1);
+            err = decode_value_from_stream(in, arena, &item, depth + 1);
             if (err != CROUS_OK) {
                 crous_value_free_tree(v);
                 return err;
@@ -412,7 +393,7 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
         
         for (uint64_t i = 0; i < count; i++) {
             crous_value *key_val = NULL;
-            err = decode_value_from_stream(in, &key_val, depth + 1);
+            err = decode_value_from_stream(in, arena, &key_val, depth + 1);
             if (err != CROUS_OK || !key_val || key_val->type != CROUS_TYPE_STRING) {
                 crous_value_free_tree(v);
                 if (key_val) crous_value_free_tree(key_val);
@@ -420,7 +401,7 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
             }
             
             crous_value *val_val = NULL;
-            err = decode_value_from_stream(in, &val_val, depth + 1);
+            err = decode_value_from_stream(in, arena, &val_val, depth + 1);
             if (err != CROUS_OK) {
                 crous_value_free_tree(v);
                 crous_value_free_tree(key_val);
@@ -430,7 +411,9 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
             const char *key_str;
             size_t key_len;
             key_str = crous_value_get_string(key_val, &key_len);
-            if (crous_value_dict_set_binary(v, key_str, key_len, val_val) != CROUS_OK) {
+            err = arena ? crous_value_dict_append_arena(arena, v, key_str, key_len, val_val)
+                        : crous_value_dict_set_binary(v, key_str, key_len, val_val);
+            if (err != CROUS_OK) {
                 crous_value_free_tree(v);
                 crous_value_free_tree(key_val);
                 crous_value_free_tree(val_val);
@@ -445,10 +428,10 @@ static crous_err_t decode_value_from_stream(crous_input_stream *in, crous_value
         if (err != CROUS_OK) return err;
         
         crous_value *inner = NULL;
-        err = decode_value_from_stream(in, &inner, depth + 1);
+        err = decode_value_from_stream(in, arena, &inner, depth + 1);
         if (err != CROUS_OK) return err;
         
-        v = crous_value_new_tagged(tag_id, inner);
+        v = crous_value_new_tagged_arena(arena, tag_id, inner);
         if (!v) {
             crous_value_free_tree(inner);
             return CROUS_ERR_OOM;
@@ -473,7 +456,32 @@ crous_err_t crous_encode_stream(
         return CROUS_ERR_INVALID_TYPE;
     
     /* Use FLUX binary format as primary encoding */
-    return flux_serialize_binary(value, out);
+    crous_span span;
+    crous_span_begin(&span, "crous_encode_stream", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    return crous_span_end(&span, flux_serialize_binary(value, crous_span_output(&span, out)), 0);
+}
+
+/* The FLUX document after its header, fed through the incremental decoder */
+static crous_err_t decode_flux_stream(crous_input_stream *in, const uint8_t *header, crous_value **out_value) {
+    /* Push fixed-size chunks through the incremental decoder so peak
+       memory is the tree plus one chunk, not the whole wire image */
+    flux_stream_decoder_t *dec = flux_stream_decoder_new();
+    if (!dec) return CROUS_ERR_OOM;
+    
+    crous_err_t err = flux_stream_decoder_feed(dec, header, 6, NULL);
+    
+    uint8_t chunk[CROUS_STREAM_CHUNK_SIZE];
+    while (err == CROUS_OK && !flux_stream_decoder_done(dec)) {
+        size_t read = in->read(in->user_data, chunk, sizeof(chunk));
+        if (read == 0 || read == (size_t)-1) break;
+        err = flux_stream_decoder_feed(dec, chunk, read, NULL);
+    }
+    
+    if (err == CROUS_OK)
+        err = flux_stream_decoder_finish(dec, out_value);
+    flux_stream_decoder_free(dec);
+    return err;
 }
 
 crous_err_t crous_decode_stream(
@@ -490,49 +498,14 @@ crous_err_t crous_decode_stream(
     
     /* Check for FLUX format first */
     if (header[0] == 'F' && header[1] == 'L' && header[2] == 'U' && header[3] == 'X') {
-        if (header[4] != 1) {
+        if (header[4] < FLUX_VERSION || header[4] > FLUX_VERSION_VALUE_REFS) {
             return CROUS_ERR_INVALID_HEADER;  /* Unsupported FLUX version */
         }
         
-        /* Read the rest of the data to decode with FLUX */
-        /* We need to use flux_decode_binary which expects the full buffer */
-        /* This is a limitation of the streaming API - for now, we'll buffer the data */
-        
-        /* Get remaining data size - we can't know this in streaming, 
-           so we'll use a hybrid approach: buffer everything and use flux_decode_binary */
-        size_t buffer_cap = 4096;
-        uint8_t *full_buf = malloc(buffer_cap);
-        if (!full_buf) return CROUS_ERR_OOM;
-        
-        /* Copy the header we already read */
-        memcpy(full_buf, header, 6);
-        size_t pos = 6;
-        
-        /* Read remaining data */
-        uint8_t temp_buf[4096];
-        while (1) {
-            size_t read = in->read(in->user_data, temp_buf, sizeof(temp_buf));
-            if (read == 0) break;
-            
-            if (pos + read > buffer_cap) {
-                size_t new_cap = buffer_cap * 2;
-                while (new_cap < pos + read) new_cap *= 2;
-                uint8_t *new_buf = realloc(full_buf, new_cap);
-                if (!new_buf) {
-                    free(full_buf);
-                    return CROUS_ERR_OOM;
-                }
-                full_buf = new_buf;
-                buffer_cap = new_cap;
-            }
-            
-            memcpy(full_buf + pos, temp_buf, read);
-            pos += read;
-        }
-        
-        err = flux_decode_binary(full_buf, pos, out_value);
-        free(full_buf);
-        return err;
+        crous_span span;
+        crous_span_begin(&span, "crous_decode_stream", CROUS_PHASE_DECODE,
+                         CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, 6);
+        return crous_span_end(&span, decode_flux_stream(crous_span_input(&span, in), header, out_value), 0);
     }
     
     /* Fall back to old CROUS format */
@@ -545,19 +518,29 @@ crous_err_t crous_decode_stream(
         return CROUS_ERR_INVALID_HEADER;
     }
     
-    return decode_value_from_stream(in, out_value, 0);
+    crous_span span;
+    crous_span_begin(&span, "crous_decode_stream", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_LEGACY, CROUS_STATS_FMT_NONE, 6);
+    err = decode_value_from_stream(crous_span_input(&span, in), NULL, out_value, 0);
+    return crous_span_end(&span, err, 0);
 }
 
 crous_err_t crous_encode_value_to_stream(
     const crous_value *value,
     crous_output_stream *out) {
-    return encode_value_to_stream(value, out);
+    crous_span span;
+    crous_span_begin(&span, "crous_encode_value_to_stream", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_LEGACY, 0);
+    return crous_span_end(&span, encode_value_to_stream(value, crous_span_output(&span, out)), 0);
 }
 
 crous_err_t crous_decode_value_from_stream(
     crous_input_stream *in,
     crous_value **out_value) {
-    return decode_value_from_stream(in, out_value, 0);
+    crous_span span;
+    crous_span_begin(&span, "crous_decode_value_from_stream", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_LEGACY, CROUS_STATS_FMT_NONE, 0);
+    return crous_span_end(&span, decode_value_from_stream(crous_span_input(&span, in), NULL, out_value, 0), 0);
 }
 
 /* ============================================================================
@@ -614,9 +597,25 @@ crous_err_t crous_encode(
     return flux_encode_binary(value, out_buf, out_size);
 }
 
-crous_err_t crous_decode(
+size_t crous_encoded_size(const crous_value *value) {
+    return flux_encoded_size(value);
+}
+
+crous_err_t crous_encode_into(
+    const crous_value *value,
+    uint8_t *buf,
+    size_t buf_size,
+    size_t *out_size) {
+    
+    return flux_encode_binary_into(value, buf, buf_size, out_size);
+}
+
+/* Shared buffer decode: dispatch on magic, optionally into an arena/borrowing */
+static crous_err_t decode_buffer(
     const uint8_t *buf,
     size_t buf_size,
+    crous_arena *arena,
+    int borrow,
     crous_value **out_value) {
     
     if (!buf || !out_value || buf_size < 6) return CROUS_ERR_TRUNCATED;
@@ -624,7 +623,8 @@ crous_err_t crous_decode(
     /* Check format by magic bytes */
     if (buf[0] == 'F' && buf[1] == 'L' && buf[2] == 'U' && buf[3] == 'X') {
         /* FLUX format */
-        return flux_decode_binary(buf, buf_size, out_value);
+        return borrow ? flux_decode_binary_borrowed(buf, buf_size, arena, out_value)
+                      : flux_decode_binary_arena(buf, buf_size, arena, out_value);
     }
     
     if (buf[0] == CROUS_MAGIC_0 && buf[1] == CROUS_MAGIC_1 &&
@@ -640,14 +640,40 @@ crous_err_t crous_decode(
         in.user_data = state;
         in.read = buffer_input_read;
         
-        crous_err_t err = decode_value_from_stream(&in, out_value, 0);
+        crous_span span;
+        crous_span_begin(&span, borrow ? "crous_decode_borrowed" : "crous_decode_arena", CROUS_PHASE_DECODE,
+                         CROUS_STATS_FMT_LEGACY, CROUS_STATS_FMT_NONE, buf_size);
+        crous_err_t err = decode_value_from_stream(&in, arena, out_value, 0);
         free(state);
-        return err;
+        return crous_span_end(&span, err, 0);
     }
     
     return CROUS_ERR_INVALID_HEADER;
 }
 
+crous_err_t crous_decode(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_value **out_value) {
+    return crous_decode_arena(buf, buf_size, NULL, out_value);
+}
+
+crous_err_t crous_decode_arena(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_arena *arena,
+    crous_value **out_value) {
+    return decode_buffer(buf, buf_size, arena, 0, out_value);
+}
+
+crous_err_t crous_decode_borrowed(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_arena *arena,
+    crous_value **out_value) {
+    return decode_buffer(buf, buf_size, arena, 1, out_value);
+}
+
 /* ============================================================================
    FILE API
    ============================================================================ */
@@ -659,13 +685,16 @@ crous_err_t crous_encode_file(
     uint8_t *buf = NULL;
     size_t size = 0;
     
+    crous_span span;
+    crous_span_begin(&span, "crous_encode_file", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
     crous_err_t err = crous_encode(value, &buf, &size);
-    if (err != CROUS_OK) return err;
+    if (err != CROUS_OK) return crous_span_end(&span, err, 0);
     
     FILE *f = fopen(path, "wb");
     if (!f) {
         free(buf);
-        return CROUS_ERR_ENCODE;
+        return crous_span_end(&span, CROUS_ERR_ENCODE, 0);
     }
     
     size_t written = fwrite(buf, 1, size, f);
@@ -673,44 +702,28 @@ crous_err_t crous_encode_file(
     free(buf);
     
     if (written != size || close_status != 0) {
-        return CROUS_ERR_ENCODE;
+        return crous_span_end(&span, CROUS_ERR_ENCODE, 0);
     }
     
-    return CROUS_OK;
+    return crous_span_end(&span, CROUS_OK, size);
 }
 
 crous_err_t crous_decode_file(
     const char *path,
     crous_value **out_value) {
     
-    FILE *f = fopen(path, "rb");
-    if (!f) return CROUS_ERR_DECODE;
-    
-    fseek(f, 0, SEEK_END);
-    long file_size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    
-    if (file_size < 0) {
-        fclose(f);
-        return CROUS_ERR_DECODE;
-    }
-    
-    uint8_t *buf = malloc(file_size);
-    if (!buf) {
-        fclose(f);
-        return CROUS_ERR_OOM;
-    }
-    
-    size_t read_bytes = fread(buf, 1, file_size, f);
-    fclose(f);
-    
-    if (read_bytes != (size_t)file_size) {
-        free(buf);
-        return CROUS_ERR_DECODE;
-    }
+    crous_file_view view;
+    crous_err_t err = crous_file_view_open(path, &view);
+    /* Unreadable files have always been reported as decode errors */
+    if (err == CROUS_ERR_STREAM) return CROUS_ERR_DECODE;
+    if (err != CROUS_OK) return err;
     
-    crous_err_t err = crous_decode(buf, file_size, out_value);
-    free(buf);
+    crous_span span;
+    crous_span_begin(&span, "crous_decode_file", CROUS_PHASE_DECODE,
+                     view.size >= 4 && view.data[0] == 'F' ? CROUS_STATS_FMT_FLUX : CROUS_STATS_FMT_LEGACY,
+                     CROUS_STATS_FMT_NONE, view.size);
+    err = crous_decode(view.data, view.size, out_value);
+    crous_file_view_close(&view);
     
-    return err;
+    return crous_span_end(&span, err, 0);
 }
@@ -0,0 +1,182 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "../include/crous_binary.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#  include <io.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/* ============================================================================
+   FILE VIEWS
+   ============================================================================ */
+
+static void view_clear(crous_file_view *view) {
+    view->data = NULL;
+    view->size = 0;
+    view->mapped = 0;
+    view->_offset = 0;
+}
+
+/* Install a mapping of a total-byte file, exposed from offset on */
+static void view_set_mapping(crous_file_view *view, const uint8_t *base,
+                             uint64_t total, uint64_t offset) {
+    view->data = base + offset;
+    view->size = (size_t)(total - offset);
+    view->mapped = 1;
+    view->_offset = (size_t)offset;
+}
+
+#if defined(_WIN32)
+
+static crous_err_t map_handle(HANDLE file, uint64_t offset, crous_file_view *view) {
+    LARGE_INTEGER size;
+
+    if (file == INVALID_HANDLE_VALUE || GetFileType(file) != FILE_TYPE_DISK ||
+        !GetFileSizeEx(file, &size)) {
+        return CROUS_ERR_STREAM;
+    }
+
+    uint64_t total = (uint64_t)size.QuadPart;
+    if (total > (uint64_t)SIZE_MAX) return CROUS_ERR_OVERFLOW;
+    /* Empty files cannot be mapped; past the end there is nothing to read */
+    if (offset >= total) return CROUS_OK;
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) return CROUS_ERR_STREAM;
+    const uint8_t *base = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);  /* The view keeps the mapping alive */
+    if (!base) return CROUS_ERR_STREAM;
+
+    view_set_mapping(view, base, total, offset);
+    return CROUS_OK;
+}
+
+#else
+
+static crous_err_t map_fd(int fd, uint64_t offset, crous_file_view *view) {
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return CROUS_ERR_STREAM;
+
+    uint64_t total = (uint64_t)st.st_size;
+    if (total > (uint64_t)SIZE_MAX) return CROUS_ERR_OVERFLOW;
+    /* Empty files cannot be mapped; past the end there is nothing to read */
+    if (offset >= total) return CROUS_OK;
+
+    void *base = mmap(NULL, (size_t)total, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) return CROUS_ERR_STREAM;
+
+    view_set_mapping(view, (const uint8_t *)base, total, offset);
+    return CROUS_OK;
+}
+
+#endif
+
+/* Fallback for files that cannot be mapped: read everything into the heap */
+static crous_err_t read_all(const char *path, crous_file_view *view) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return CROUS_ERR_STREAM;
+
+    size_t cap = CROUS_STREAM_CHUNK_SIZE;
+    size_t len = 0;
+    uint8_t *buf = malloc(cap);
+    if (!buf) {
+        fclose(f);
+        return CROUS_ERR_OOM;
+    }
+
+    for (;;) {
+        if (len == cap) {
+            uint8_t *grown = cap <= SIZE_MAX / 2 ? realloc(buf, cap * 2) : NULL;
+            if (!grown) {
+                free(buf);
+                fclose(f);
+                return CROUS_ERR_OOM;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+        size_t got = fread(buf + len, 1, cap - len, f);
+        len += got;
+        if (got == 0) break;
+    }
+
+    int failed = ferror(f);
+    fclose(f);
+    if (failed) {
+        free(buf);
+        return CROUS_ERR_STREAM;
+    }
+
+    view->data = buf;
+    view->size = len;
+    return CROUS_OK;
+}
+
+crous_err_t crous_file_view_open(
+    const char *path,
+    crous_file_view *view) {
+
+    if (!path || !view) return CROUS_ERR_INVALID_TYPE;
+    view_clear(view);
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return CROUS_ERR_STREAM;
+    crous_err_t err = map_handle(file, 0, view);
+    CloseHandle(file);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return CROUS_ERR_STREAM;
+    crous_err_t err = map_fd(fd, 0, view);
+    close(fd);
+#endif
+
+    if (err == CROUS_ERR_STREAM) return read_all(path, view);
+    return err;
+}
+
+crous_err_t crous_file_view_map_fd(
+    int fd,
+    uint64_t offset,
+    crous_file_view *view) {
+
+    if (!view) return CROUS_ERR_INVALID_TYPE;
+    view_clear(view);
+    if (fd < 0) return CROUS_ERR_STREAM;
+
+#if defined(_WIN32)
+    return map_handle((HANDLE)_get_osfhandle(fd), offset, view);
+#else
+    return map_fd(fd, offset, view);
+#endif
+}
+
+void crous_file_view_close(crous_file_view *view) {
+    if (!view) return;
+
+    if (view->mapped) {
+        const uint8_t *base = view->data - view->_offset;
+#if defined(_WIN32)
+        UnmapViewOfFile(base);
+#else
+        munmap((void *)base, view->size + view->_offset);
+#endif
+    } else {
+        free((void *)view->data);
+    }
+    view_clear(view);
+}
@@ -0,0 +1,927 @@
+#include "../include/crous_frame.h"
+#include "../include/crous_checksum.h"
+#include "../include/crous_flux.h"
+#include "../include/crous_binary.h"
+#include "../include/crous_parallel.h"
+#include "../include/crous_version.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+   FRAME HELPERS
+   ============================================================================ */
+
+#define FRAME_PREFIX_MAX 8      /* Length word and CRC */
+#define FRAME_WORD_CRC   0x1u
+#define FRAME_WORD_INDEX 0x2u
+#define FRAME_ENTRY_SIZE 24     /* u64 record, u64 offset, u32 key_off, u32 key_len */
+#define FRAME_TRAILER_SIZE 40
+
+static const uint8_t index_magic[4] = {'F', 'L', 'X', 'I'};
+
+static const uint8_t frame_header[CROUS_FRAME_HEADER_SIZE] = {
+    CROUS_FRAME_MAGIC_0, CROUS_FRAME_MAGIC_1, CROUS_FRAME_MAGIC_2, CROUS_FRAME_MAGIC_3,
+    CROUS_FRAME_VERSION, 0, 0, 0
+};
+
+static void put_u32le(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32le(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u64le(uint8_t *p, uint64_t v) {
+    put_u32le(p, (uint32_t)v);
+    put_u32le(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t get_u64le(const uint8_t *p) {
+    return (uint64_t)get_u32le(p) | ((uint64_t)get_u32le(p + 4) << 32);
+}
+
+static size_t word_prefix_len(uint32_t word) {
+    return (word & FRAME_WORD_CRC) ? 8 : 4;
+}
+
+/* ============================================================================
+   FRAME WRITER
+   ============================================================================ */
+
+typedef struct {
+    uint64_t record;            /* Relative to the writer's first record */
+    uint64_t offset;
+    uint32_t key_off;
+    uint32_t key_len;
+} frame_entry;
+
+struct crous_frame_writer {
+    crous_output_stream *out;
+    unsigned flags;
+    uint8_t *buf;               /* CROUS_STREAM_CHUNK_SIZE bytes */
+    size_t len;
+    uint64_t pos;               /* Log offset of the next byte */
+    uint64_t start;             /* Log offset of the first record */
+    uint64_t records;
+    uint32_t interval;          /* 0: no index */
+    frame_entry *entries;
+    size_t entry_count;
+    size_t entry_cap;
+    uint8_t *keys;
+    size_t key_bytes;
+    size_t key_cap;
+};
+
+static crous_err_t writer_emit(crous_frame_writer *w, const uint8_t *data, size_t len) {
+    if (!w->out->write) return CROUS_ERR_STREAM;
+    return w->out->write(w->out->user_data, data, len) == len ? CROUS_OK : CROUS_ERR_STREAM;
+}
+
+crous_err_t crous_frame_writer_flush(crous_frame_writer *writer) {
+    if (!writer) return CROUS_ERR_INVALID_TYPE;
+    if (writer->len == 0) return CROUS_OK;
+    crous_err_t err = writer_emit(writer, writer->buf, writer->len);
+    writer->len = 0;
+    return err;
+}
+
+/* Buffer len bytes, flushing first if they don't fit; larger runs go straight out */
+static crous_err_t writer_append(crous_frame_writer *w, const uint8_t *data, size_t len) {
+    w->pos += len;
+    if (len > CROUS_STREAM_CHUNK_SIZE - w->len) {
+        crous_err_t err = crous_frame_writer_flush(w);
+        if (err != CROUS_OK) return err;
+        if (len > CROUS_STREAM_CHUNK_SIZE) return writer_emit(w, data, len);
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+    return CROUS_OK;
+}
+
+/* Length word and optional CRC of a body; returns the prefix size */
+static size_t frame_prefix(const crous_frame_writer *w, const uint8_t *body, size_t len,
+                           uint32_t kind, uint8_t prefix[FRAME_PREFIX_MAX]) {
+    int crc = (w->flags & CROUS_FRAME_CHECKSUM) != 0;
+    put_u32le(prefix, (uint32_t)len << 2 | kind | (crc ? FRAME_WORD_CRC : 0));
+    if (!crc) return 4;
+    put_u32le(prefix + 4, crous_crc32c(0, body, len));
+    return 8;
+}
+
+crous_err_t crous_frame_writer_new(crous_output_stream *out, unsigned flags, crous_frame_writer **out_writer) {
+    if (!out || !out_writer) return CROUS_ERR_INVALID_TYPE;
+
+    crous_frame_writer *w = malloc(sizeof(*w));
+    if (!w) return CROUS_ERR_OOM;
+    w->buf = malloc(CROUS_STREAM_CHUNK_SIZE);
+    if (!w->buf) {
+        free(w);
+        return CROUS_ERR_OOM;
+    }
+    w->out = out;
+    w->flags = flags;
+    w->len = 0;
+    w->pos = 0;
+    w->records = 0;
+    w->interval = 0;
+    w->entries = NULL;
+    w->entry_count = w->entry_cap = 0;
+    w->keys = NULL;
+    w->key_bytes = w->key_cap = 0;
+
+    if (!(flags & CROUS_FRAME_APPEND)) {
+        memcpy(w->buf, frame_header, CROUS_FRAME_HEADER_SIZE);
+        w->len = CROUS_FRAME_HEADER_SIZE;
+        w->pos = CROUS_FRAME_HEADER_SIZE;
+    }
+    w->start = w->pos;
+
+    *out_writer = w;
+    return CROUS_OK;
+}
+
+crous_err_t crous_frame_writer_set_index(crous_frame_writer *writer, uint32_t interval, uint64_t log_size) {
+    if (!writer || writer->records > 0) return CROUS_ERR_INVALID_TYPE;
+    writer->interval = interval ? interval : CROUS_FRAME_INDEX_INTERVAL;
+    if (writer->flags & CROUS_FRAME_APPEND) writer->pos = writer->start = log_size;
+    return CROUS_OK;
+}
+
+/* Index entry for the record about to be written at pos, if it is due one */
+static crous_err_t writer_note_record(crous_frame_writer *w, const uint8_t *key, size_t key_len) {
+    if (!w->interval || w->records % w->interval != 0) return CROUS_OK;
+    if (key_len > UINT32_MAX || w->key_bytes > UINT32_MAX - key_len) return CROUS_ERR_OVERFLOW;
+
+    if (w->entry_count == w->entry_cap) {
+        size_t new_cap = w->entry_cap ? w->entry_cap * 2 : 64;
+        frame_entry *grown = realloc(w->entries, new_cap * sizeof(*grown));
+        if (!grown) return CROUS_ERR_OOM;
+        w->entries = grown;
+        w->entry_cap = new_cap;
+    }
+    if (key_len > w->key_cap - w->key_bytes) {
+        size_t new_cap = w->key_cap ? w->key_cap : 1024;
+        while (new_cap - w->key_bytes < key_len) new_cap *= 2;
+        uint8_t *grown = realloc(w->keys, new_cap);
+        if (!grown) return CROUS_ERR_OOM;
+        w->keys = grown;
+        w->key_cap = new_cap;
+    }
+
+    frame_entry *e = &w->entries[w->entry_count++];
+    e->record = w->records;
+    e->offset = w->pos;
+    e->key_off = (uint32_t)w->key_bytes;
+    e->key_len = (uint32_t)key_len;
+    if (key_len) memcpy(w->keys + w->key_bytes, key, key_len);
+    w->key_bytes += key_len;
+    return CROUS_OK;
+}
+
+static crous_err_t writer_record(crous_frame_writer *w, const uint8_t *body, size_t len, uint32_t kind) {
+    uint8_t prefix[FRAME_PREFIX_MAX];
+    size_t prefix_len = frame_prefix(w, body, len, kind, prefix);
+    crous_err_t err = writer_append(w, prefix, prefix_len);
+    if (err == CROUS_OK) err = writer_append(w, body, len);
+    return err;
+}
+
+crous_err_t crous_frame_writer_write_keyed(crous_frame_writer *writer, const uint8_t *body, size_t len,
+                                           const uint8_t *key, size_t key_len) {
+    if (!writer || (!body && len) || (!key && key_len)) return CROUS_ERR_INVALID_TYPE;
+    if (len > CROUS_FRAME_MAX_RECORD) return CROUS_ERR_OVERFLOW;
+
+    crous_err_t err = writer_note_record(writer, key, key_len);
+    if (err == CROUS_OK) err = writer_record(writer, body, len, 0);
+    if (err == CROUS_OK) writer->records++;
+    return err;
+}
+
+crous_err_t crous_frame_writer_write(crous_frame_writer *writer, const uint8_t *body, size_t len) {
+    return crous_frame_writer_write_keyed(writer, body, len, NULL, 0);
+}
+
+crous_err_t crous_frame_writer_write_value(crous_frame_writer *writer, const crous_value *value) {
+    if (!writer || !value) return CROUS_ERR_INVALID_TYPE;
+
+    size_t size = flux_encoded_size(value);
+    if (size == 0) return CROUS_ERR_ENCODE;
+    if (size > CROUS_FRAME_MAX_RECORD) return CROUS_ERR_OVERFLOW;
+
+    /* Records that fit the block are encoded in place, behind their prefix */
+    size_t prefix_len = (writer->flags & CROUS_FRAME_CHECKSUM) ? 8 : 4;
+    if (prefix_len + size <= CROUS_STREAM_CHUNK_SIZE) {
+        if (prefix_len + size > CROUS_STREAM_CHUNK_SIZE - writer->len) {
+            crous_err_t err = crous_frame_writer_flush(writer);
+            if (err != CROUS_OK) return err;
+        }
+        uint8_t *body = writer->buf + writer->len + prefix_len;
+        size_t written;
+        crous_err_t err = flux_encode_binary_into(value, body, size, &written);
+        if (err == CROUS_OK) err = writer_note_record(writer, NULL, 0);
+        if (err != CROUS_OK) return err;
+
+        uint8_t prefix[FRAME_PREFIX_MAX];
+        frame_prefix(writer, body, written, 0, prefix);
+        memcpy(writer->buf + writer->len, prefix, prefix_len);
+        writer->len += prefix_len + written;
+        writer->pos += prefix_len + written;
+        writer->records++;
+        return CROUS_OK;
+    }
+
+    uint8_t *body;
+    size_t len;
+    crous_err_t err = flux_encode_binary(value, &body, &len);
+    if (err != CROUS_OK) return err;
+    err = crous_frame_writer_write(writer, body, len);
+    free(body);
+    return err;
+}
+
+/* Footer describing the records this writer added */
+static crous_err_t writer_write_index(crous_frame_writer *w) {
+    size_t body_len = w->entry_count * FRAME_ENTRY_SIZE + w->key_bytes + FRAME_TRAILER_SIZE;
+    if (w->entry_count > UINT32_MAX || body_len > CROUS_FRAME_MAX_RECORD) return CROUS_ERR_OVERFLOW;
+
+    uint8_t *body = malloc(body_len);
+    if (!body) return CROUS_ERR_OOM;
+    uint8_t *p = body;
+    for (size_t i = 0; i < w->entry_count; i++, p += FRAME_ENTRY_SIZE) {
+        put_u64le(p, w->entries[i].record);
+        put_u64le(p + 8, w->entries[i].offset);
+        put_u32le(p + 16, w->entries[i].key_off);
+        put_u32le(p + 20, w->entries[i].key_len);
+    }
+    if (w->key_bytes) memcpy(p, w->keys, w->key_bytes);
+    p += w->key_bytes;
+    put_u64le(p, w->start);
+    put_u64le(p + 8, w->records);
+    put_u64le(p + 16, w->pos);
+    put_u32le(p + 24, (uint32_t)w->entry_count);
+    put_u32le(p + 28, (uint32_t)w->key_bytes);
+    put_u32le(p + 32, w->interval);
+    memcpy(p + 36, index_magic, 4);
+
+    crous_err_t err = writer_record(w, body, body_len, FRAME_WORD_INDEX);
+    free(body);
+    return err;
+}
+
+crous_err_t crous_frame_writer_close(crous_frame_writer *writer) {
+    if (!writer) return CROUS_ERR_INVALID_TYPE;
+    crous_err_t err = CROUS_OK;
+    if (writer->interval && writer->records > 0) err = writer_write_index(writer);
+    crous_err_t flushed = crous_frame_writer_flush(writer);
+    if (err == CROUS_OK) err = flushed;
+    free(writer->entries);
+    free(writer->keys);
+    free(writer->buf);
+    free(writer);
+    return err;
+}
+
+/* ============================================================================
+   FRAME READER
+   ============================================================================ */
+
+struct crous_frame_reader {
+    crous_input_stream *in;
+    uint8_t *buf;
+    size_t cap;
+    size_t start;               /* First unconsumed byte */
+    size_t end;                 /* End of the bytes read so far */
+    int started;                /* File header checked */
+    int eof;
+};
+
+/*
+ * Make at least n bytes available from start. The buffer only doubles once
+ * it is full, so a corrupt length costs no more memory than the input
+ * really holds. Returns CROUS_ERR_NOT_FOUND if the input ends before any
+ * of them arrive and CROUS_ERR_TRUNCATED if it ends part-way.
+ */
+static crous_err_t reader_fill(crous_frame_reader *r, size_t n) {
+    while (r->end - r->start < n) {
+        if (r->eof) return r->end == r->start ? CROUS_ERR_NOT_FOUND : CROUS_ERR_TRUNCATED;
+
+        if (r->end == r->cap) {
+            if (r->start > 0) {
+                memmove(r->buf, r->buf + r->start, r->end - r->start);
+                r->end -= r->start;
+                r->start = 0;
+            } else {
+                size_t new_cap = r->cap * 2;
+                uint8_t *grown = new_cap > r->cap ? realloc(r->buf, new_cap) : NULL;
+                if (!grown) return CROUS_ERR_OOM;
+                r->buf = grown;
+                r->cap = new_cap;
+            }
+            continue;
+        }
+
+        size_t got = r->in->read ? r->in->read(r->in->user_data, r->buf + r->end, r->cap - r->end) : 0;
+        if (got == 0 || got == (size_t)-1) r->eof = 1;
+        else r->end += got;
+    }
+    return CROUS_OK;
+}
+
+crous_err_t crous_frame_reader_new(crous_input_stream *in, crous_frame_reader **out_reader) {
+    if (!in || !out_reader) return CROUS_ERR_INVALID_TYPE;
+
+    crous_frame_reader *r = calloc(1, sizeof(*r));
+    if (!r) return CROUS_ERR_OOM;
+    r->buf = malloc(CROUS_STREAM_CHUNK_SIZE);
+    if (!r->buf) {
+        free(r);
+        return CROUS_ERR_OOM;
+    }
+    r->cap = CROUS_STREAM_CHUNK_SIZE;
+    r->in = in;
+
+    *out_reader = r;
+    return CROUS_OK;
+}
+
+crous_err_t crous_frame_reader_next(crous_frame_reader *reader, const uint8_t **out_body, size_t *out_len) {
+    if (!reader || !out_body || !out_len) return CROUS_ERR_INVALID_TYPE;
+    crous_err_t err;
+
+    if (!reader->started) {
+        err = reader_fill(reader, CROUS_FRAME_HEADER_SIZE);
+        if (err != CROUS_OK) return err;
+        const uint8_t *h = reader->buf + reader->start;
+        if (memcmp(h, frame_header, 4) != 0 || h[4] != CROUS_FRAME_VERSION) return CROUS_ERR_INVALID_HEADER;
+        reader->start += CROUS_FRAME_HEADER_SIZE;
+        reader->started = 1;
+    }
+
+    for (;;) {
+        err = reader_fill(reader, 4);
+        if (err != CROUS_OK) return err;
+        uint32_t word = get_u32le(reader->buf + reader->start);
+        size_t prefix_len = word_prefix_len(word);
+        size_t len = word >> 2;
+
+        err = reader_fill(reader, prefix_len + len);
+        if (err == CROUS_ERR_NOT_FOUND) err = CROUS_ERR_TRUNCATED;
+        if (err != CROUS_OK) return err;
+
+        const uint8_t *body = reader->buf + reader->start + prefix_len;
+        reader->start += prefix_len + len;
+        if (word & FRAME_WORD_INDEX) continue;
+        if ((word & FRAME_WORD_CRC) && get_u32le(body - 4) != crous_crc32c(0, body, len)) {
+            return CROUS_ERR_CHECKSUM;
+        }
+
+        *out_body = body;
+        *out_len = len;
+        return CROUS_OK;
+    }
+}
+
+void crous_frame_reader_free(crous_frame_reader *reader) {
+    if (!reader) return;
+    free(reader->buf);
+    free(reader);
+}
+
+/* ============================================================================
+   SEEK INDEX
+   ============================================================================ */
+
+typedef struct {
+    uint64_t record;
+    uint64_t offset;
+    const uint8_t *key;         /* Into the log's data; NULL without a key */
+    uint32_t key_len;
+} index_entry;
+
+struct crous_frame_index {
+    const uint8_t *data;
+    size_t size;
+    size_t end;                 /* End of the complete records */
+    uint64_t count;
+    index_entry *entries;       /* Ascending by record and offset */
+    size_t entry_count;
+    size_t entry_cap;
+    size_t *keyed;              /* Entries with keys, ascending */
+    size_t keyed_count;
+};
+
+/* A footer parsed from its trailer */
+typedef struct {
+    uint64_t start;
+    uint64_t records;
+    uint64_t offset;            /* Of the footer record */
+    const uint8_t *entries;
+    uint32_t entry_count;
+    const uint8_t *keys;
+    uint32_t key_bytes;
+} index_footer;
+
+static crous_err_t index_push(crous_frame_index *idx, uint64_t record, uint64_t offset,
+                              const uint8_t *key, uint32_t key_len) {
+    if (idx->entry_count == idx->entry_cap) {
+        size_t new_cap = idx->entry_cap ? idx->entry_cap * 2 : 64;
+        index_entry *grown = realloc(idx->entries, new_cap * sizeof(*grown));
+        if (!grown) return CROUS_ERR_OOM;
+        idx->entries = grown;
+        idx->entry_cap = new_cap;
+    }
+    index_entry *e = &idx->entries[idx->entry_count++];
+    e->record = record;
+    e->offset = offset;
+    e->key = key;
+    e->key_len = key_len;
+    return CROUS_OK;
+}
+
+/* The footer whose record ends exactly at end, if there is one */
+static int index_footer_at(const crous_frame_index *idx, size_t end, index_footer *f) {
+    if (end < CROUS_FRAME_HEADER_SIZE + 4 + FRAME_TRAILER_SIZE) return 0;
+    const uint8_t *t = idx->data + end - FRAME_TRAILER_SIZE;
+    if (memcmp(t + 36, index_magic, 4) != 0) return 0;
+
+    f->start = get_u64le(t);
+    f->records = get_u64le(t + 8);
+    f->offset = get_u64le(t + 16);
+    f->entry_count = get_u32le(t + 24);
+    f->key_bytes = get_u32le(t + 28);
+    if (f->offset < CROUS_FRAME_HEADER_SIZE || f->offset > end - 4 - FRAME_TRAILER_SIZE) return 0;
+    if (f->start < CROUS_FRAME_HEADER_SIZE || f->start > f->offset) return 0;
+
+    const uint8_t *rec = idx->data + f->offset;
+    uint32_t word = get_u32le(rec);
+    size_t prefix_len = word_prefix_len(word);
+    uint64_t body_len = (uint64_t)f->entry_count * FRAME_ENTRY_SIZE + f->key_bytes + FRAME_TRAILER_SIZE;
+    if (!(word & FRAME_WORD_INDEX) || (word >> 2) != body_len) return 0;
+    if (f->offset + prefix_len + body_len != end) return 0;
+    if ((word & FRAME_WORD_CRC) && get_u32le(rec + 4) != crous_crc32c(0, rec + 8, (size_t)body_len)) return 0;
+
+    f->entries = rec + prefix_len;
+    f->keys = f->entries + (size_t)f->entry_count * FRAME_ENTRY_SIZE;
+    return 1;
+}
+
+/*
+ * Index [from, to) by its length words, an entry every
+ * CROUS_FRAME_INDEX_INTERVAL records. Stops early at a partial record
+ * only when to is the end of the data.
+ */
+static crous_err_t index_scan(crous_frame_index *idx, size_t from, size_t to) {
+    size_t pos = from;
+    uint64_t n = 0;
+    while (pos < to) {
+        if (to - pos < 4) break;
+        uint32_t word = get_u32le(idx->data + pos);
+        uint64_t next = (uint64_t)pos + word_prefix_len(word) + (word >> 2);
+        if (next > to) break;
+        if (!(word & FRAME_WORD_INDEX)) {
+            if (n % CROUS_FRAME_INDEX_INTERVAL == 0) {
+                crous_err_t err = index_push(idx, idx->count + n, pos, NULL, 0);
+                if (err != CROUS_OK) return err;
+            }
+            n++;
+        }
+        pos = (size_t)next;
+    }
+    if (pos != to && to != idx->size) return CROUS_ERR_DECODE;
+    idx->count += n;
+    idx->end = pos;
+    return CROUS_OK;
+}
+
+/* Fold one footer's entries into the index */
+static crous_err_t index_add_footer(crous_frame_index *idx, const index_footer *f) {
+    /* Seeks start from an entry, so a segment's first record always has one */
+    if (f->records > 0 && (f->entry_count == 0 || get_u64le(f->entries) != 0 ||
+                           get_u64le(f->entries + 8) != f->start)) {
+        return CROUS_ERR_DECODE;
+    }
+    uint64_t last_offset = 0;
+    for (uint32_t i = 0; i < f->entry_count; i++) {
+        const uint8_t *p = f->entries + (size_t)i * FRAME_ENTRY_SIZE;
+        uint64_t record = get_u64le(p);
+        uint64_t offset = get_u64le(p + 8);
+        uint32_t key_off = get_u32le(p + 16);
+        uint32_t key_len = get_u32le(p + 20);
+        if (record >= f->records || offset < f->start || offset >= f->offset ||
+            (i > 0 && offset <= last_offset) || key_off > f->key_bytes || key_len > f->key_bytes - key_off) {
+            return CROUS_ERR_DECODE;
+        }
+        if (i > 0 && record <= idx->entries[idx->entry_count - 1].record - idx->count) return CROUS_ERR_DECODE;
+        crous_err_t err = index_push(idx, idx->count + record, offset,
+                                     key_len ? f->keys + key_off : NULL, key_len);
+        if (err != CROUS_OK) return err;
+        last_offset = offset;
+    }
+    idx->count += f->records;
+    return CROUS_OK;
+}
+
+crous_err_t crous_frame_index_open(const uint8_t *data, size_t size, crous_frame_index **out_index) {
+    if ((!data && size) || !out_index) return CROUS_ERR_INVALID_TYPE;
+    if (size > 0 && (size < CROUS_FRAME_HEADER_SIZE || memcmp(data, frame_header, 4) != 0 ||
+                     data[4] != CROUS_FRAME_VERSION)) {
+        return CROUS_ERR_INVALID_HEADER;
+    }
+
+    crous_frame_index *idx = calloc(1, sizeof(*idx));
+    if (!idx) return CROUS_ERR_OOM;
+    idx->data = data;
+    idx->size = size;
+    idx->end = size;
+
+    /* Walk footers back from the end while each segment follows another */
+    index_footer *chain = NULL;
+    size_t chain_count = 0, chain_cap = 0;
+    size_t front = size;
+    index_footer f;
+    crous_err_t err = CROUS_OK;
+    while (front > CROUS_FRAME_HEADER_SIZE && index_footer_at(idx, front, &f)) {
+        if (chain_count == chain_cap) {
+            size_t new_cap = chain_cap ? chain_cap * 2 : 8;
+            index_footer *grown = realloc(chain, new_cap * sizeof(*grown));
+            if (!grown) {
+                err = CROUS_ERR_OOM;
+                break;
+            }
+            chain = grown;
+            chain_cap = new_cap;
+        }
+        chain[chain_count++] = f;
+        front = (size_t)f.start;
+    }
+
+    /* Whatever the chain does not reach is scanned; then the segments, oldest first */
+    if (err == CROUS_OK && size > 0) {
+        err = index_scan(idx, CROUS_FRAME_HEADER_SIZE, front);
+        if (err == CROUS_OK && chain_count > 0) idx->end = size;
+    }
+    for (size_t i = chain_count; err == CROUS_OK && i-- > 0;) {
+        err = index_add_footer(idx, &chain[i]);
+    }
+    free(chain);
+
+    if (err == CROUS_OK && idx->entry_count > 0) {
+        idx->keyed = malloc(idx->entry_count * sizeof(*idx->keyed));
+        if (!idx->keyed) err = CROUS_ERR_OOM;
+        for (size_t i = 0; err == CROUS_OK && i < idx->entry_count; i++) {
+            if (idx->entries[i].key) idx->keyed[idx->keyed_count++] = i;
+        }
+    }
+    if (err != CROUS_OK) {
+        crous_frame_index_free(idx);
+        return err;
+    }
+
+    *out_index = idx;
+    return CROUS_OK;
+}
+
+uint64_t crous_frame_index_count(const crous_frame_index *index) {
+    return index ? index->count : 0;
+}
+
+/* Last entry at or before record; entries exist whenever count > 0 */
+static size_t index_entry_for(const crous_frame_index *idx, uint64_t record) {
+    size_t lo = 0, hi = idx->entry_count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (idx->entries[mid].record <= record) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* Step *pos over footers to the next complete data record and return its word */
+static crous_err_t index_locate(const crous_frame_index *idx, uint64_t *pos, uint32_t *out_word) {
+    for (;;) {
+        if (*pos >= idx->end) return idx->end < idx->size ? CROUS_ERR_TRUNCATED : CROUS_ERR_NOT_FOUND;
+        if (idx->end - *pos < 4) return CROUS_ERR_TRUNCATED;
+        uint32_t word = get_u32le(idx->data + *pos);
+        uint64_t len = word_prefix_len(word) + (word >> 2);
+        if (len > idx->end - *pos) return CROUS_ERR_TRUNCATED;
+        if (!(word & FRAME_WORD_INDEX)) {
+            *out_word = word;
+            return CROUS_OK;
+        }
+        *pos += len;
+    }
+}
+
+crous_err_t crous_frame_index_read(const crous_frame_index *index, uint64_t *offset,
+                                   const uint8_t **out_body, size_t *out_len) {
+    if (!index || !offset || !out_body || !out_len) return CROUS_ERR_INVALID_TYPE;
+
+    uint64_t pos = *offset < CROUS_FRAME_HEADER_SIZE ? CROUS_FRAME_HEADER_SIZE : *offset;
+    uint32_t word;
+    crous_err_t err = index_locate(index, &pos, &word);
+    if (err != CROUS_OK) return err;
+
+    const uint8_t *rec = index->data + pos;
+    const uint8_t *body = rec + word_prefix_len(word);
+    size_t len = word >> 2;
+    if ((word & FRAME_WORD_CRC) && get_u32le(rec + 4) != crous_crc32c(0, body, len)) return CROUS_ERR_CHECKSUM;
+
+    *offset = (uint64_t)(body - index->data) + len;
+    *out_body = body;
+    *out_len = len;
+    return CROUS_OK;
+}
+
+crous_err_t crous_frame_index_seek(const crous_frame_index *index, uint64_t record, uint64_t *out_offset) {
+    if (!index || !out_offset) return CROUS_ERR_INVALID_TYPE;
+    if (record >= index->count) return CROUS_ERR_NOT_FOUND;
+
+    const index_entry *e = &index->entries[index_entry_for(index, record)];
+    uint64_t pos = e->offset;
+    for (uint64_t n = e->record;; n++) {
+        uint32_t word;
+        crous_err_t err = index_locate(index, &pos, &word);
+        if (err != CROUS_OK) return err;
+        if (n == record) break;
+        pos += word_prefix_len(word) + (word >> 2);
+    }
+    *out_offset = pos;
+    return CROUS_OK;
+}
+
+static int key_cmp(const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len) {
+    int c = memcmp(a, b, a_len < b_len ? a_len : b_len);
+    if (c) return c;
+    return a_len < b_len ? -1 : a_len > b_len;
+}
+
+crous_err_t crous_frame_index_find(const crous_frame_index *index, const uint8_t *key, size_t key_len,
+                                   uint64_t *out_record, uint64_t *out_offset) {
+    if (!index || (!key && key_len) || !out_record || !out_offset) return CROUS_ERR_INVALID_TYPE;
+
+    /* First keyed entry greater than key; the one before it is the answer */
+    size_t lo = 0, hi = index->keyed_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const index_entry *e = &index->entries[index->keyed[mid]];
+        if (key_cmp(e->key, e->key_len, key, key_len) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return CROUS_ERR_NOT_FOUND;
+
+    const index_entry *e = &index->entries[index->keyed[lo - 1]];
+    *out_record = e->record;
+    *out_offset = e->offset;
+    return CROUS_OK;
+}
+
+crous_err_t crous_frame_index_split(const crous_frame_index *index, size_t parts, uint64_t *out_records) {
+    if (!index || parts == 0 || !out_records) return CROUS_ERR_INVALID_TYPE;
+
+    out_records[0] = 0;
+    out_records[parts] = index->count;
+    if (index->entry_count == 0) {
+        for (size_t k = 1; k < parts; k++) out_records[k] = index->count;
+        return CROUS_OK;
+    }
+
+    uint64_t first = index->entries[0].offset;
+    uint64_t span = index->end - first;
+    size_t at = 0;
+    for (size_t k = 1; k < parts; k++) {
+        /* Last entry at or before the k-th byte mark */
+        uint64_t mark = first + (uint64_t)((double)span * (double)k / (double)parts);
+        while (at + 1 < index->entry_count && index->entries[at + 1].offset <= mark) at++;
+        out_records[k] = index->entries[at].record;
+    }
+    return CROUS_OK;
+}
+
+void crous_frame_index_free(crous_frame_index *index) {
+    if (!index) return;
+    free(index->entries);
+    free(index->keyed);
+    free(index);
+}
+
+/* ============================================================================
+   PARALLEL DECODE
+   ============================================================================ */
+
+/* Ranges per thread, so that uneven ranges balance out */
+#define FRAME_RANGES_PER_THREAD 4
+#define FRAME_ARENA_CHUNK_MIN 4096
+#define FRAME_ARENA_CHUNK_MAX (1u << 20)
+
+typedef struct {
+    const crous_frame_index *index;
+    const uint64_t *bounds;     /* Record numbers, range k is [bounds[k], bounds[k + 1]) */
+    crous_record_set *set;
+    crous_err_t *errs;          /* Per range */
+} frame_decode_t;
+
+static void frame_decode_task(void *ctx, size_t k) {
+    frame_decode_t *job = ctx;
+    uint64_t first = job->bounds[k], stop = job->bounds[k + 1];
+    if (first == stop) return;
+
+    uint64_t offset, end = job->index->end;
+    crous_err_t err = crous_frame_index_seek(job->index, first, &offset);
+    if (err == CROUS_OK && stop < job->index->count) err = crous_frame_index_seek(job->index, stop, &end);
+    if (err != CROUS_OK) {
+        job->errs[k] = err;
+        return;
+    }
+
+    /* Trees run a few times the size of their encoding */
+    uint64_t chunk = (end - offset) * 2;
+    if (chunk < FRAME_ARENA_CHUNK_MIN) chunk = FRAME_ARENA_CHUNK_MIN;
+    if (chunk > FRAME_ARENA_CHUNK_MAX) chunk = FRAME_ARENA_CHUNK_MAX;
+    crous_arena *arena = crous_arena_create((size_t)chunk);
+    if (!arena) {
+        job->errs[k] = CROUS_ERR_OOM;
+        return;
+    }
+    job->set->_arenas[k] = arena;
+
+    for (uint64_t r = first; err == CROUS_OK && r < stop; r++) {
+        const uint8_t *body;
+        size_t len;
+        err = crous_frame_index_read(job->index, &offset, &body, &len);
+        if (err == CROUS_OK) err = crous_decode_arena(body, len, arena, &job->set->values[r]);
+    }
+    job->errs[k] = err;
+}
+
+crous_err_t crous_decode_log_parallel(const uint8_t *data, size_t size, int nthreads, crous_record_set *out_set) {
+    if (!out_set) return CROUS_ERR_INVALID_TYPE;
+    memset(out_set, 0, sizeof(*out_set));
+
+    crous_frame_index *index;
+    crous_err_t err = crous_frame_index_open(data, size, &index);
+    if (err != CROUS_OK) return err;
+    if (index->end < index->size) {
+        crous_frame_index_free(index);
+        return CROUS_ERR_TRUNCATED;
+    }
+    if (index->count > SIZE_MAX / sizeof(crous_value *)) {
+        crous_frame_index_free(index);
+        return CROUS_ERR_OOM;
+    }
+
+    int pool = crous_pool_threads();
+    if (nthreads <= 0 || nthreads > pool) nthreads = pool;
+    size_t parts = nthreads == 1 ? 1 : (size_t)nthreads * FRAME_RANGES_PER_THREAD;
+    crous_record_set set = { NULL, (size_t)index->count, NULL, parts };
+    uint64_t *bounds = malloc((parts + 1) * sizeof(*bounds));
+    crous_err_t *errs = calloc(parts, sizeof(*errs));
+    set.values = calloc(set.count ? set.count : 1, sizeof(*set.values));
+    set._arenas = calloc(parts, sizeof(*set._arenas));
+    if (!bounds || !errs || !set.values || !set._arenas) err = CROUS_ERR_OOM;
+    if (err == CROUS_OK) err = crous_frame_index_split(index, parts, bounds);
+
+    if (err == CROUS_OK) {
+        frame_decode_t job = { index, bounds, &set, errs };
+        crous_parallel_for(parts, nthreads, frame_decode_task, &job);
+        for (size_t k = 0; err == CROUS_OK && k < parts; k++) err = errs[k];
+    }
+
+    free(bounds);
+    free(errs);
+    crous_frame_index_free(index);
+    if (err != CROUS_OK) {
+        crous_record_set_free(&set);
+        return err;
+    }
+    *out_set = set;
+    return CROUS_OK;
+}
+
+crous_err_t crous_decode_file_parallel(const char *path, int nthreads, crous_record_set *out_set) {
+    if (!path || !out_set) return CROUS_ERR_INVALID_TYPE;
+    memset(out_set, 0, sizeof(*out_set));
+
+    crous_file_view view;
+    crous_err_t err = crous_file_view_open(path, &view);
+    if (err != CROUS_OK) return err;
+    err = crous_decode_log_parallel(view.data, view.size, nthreads, out_set);
+    crous_file_view_close(&view);
+    return err;
+}
+
+void crous_record_set_free(crous_record_set *set) {
+    if (!set) return;
+    for (size_t k = 0; k < set->_arena_count; k++) {
+        if (set->_arenas && set->_arenas[k]) crous_arena_free(set->_arenas[k]);
+    }
+    free(set->_arenas);
+    free(set->values);
+    memset(set, 0, sizeof(*set));
+}
+
+/* ============================================================================
+   MIGRATION
+   ============================================================================ */
+
+crous_err_t crous_migrate_log(crous_input_stream *in, crous_output_stream *out, uint8_t target_version, unsigned flags) {
+    if (!in || !out) return CROUS_ERR_INVALID_TYPE;
+
+    crous_frame_reader *reader;
+    crous_err_t err = crous_frame_reader_new(in, &reader);
+    if (err != CROUS_OK) return err;
+    crous_frame_writer *writer;
+    err = crous_frame_writer_new(out, flags & CROUS_FRAME_CHECKSUM, &writer);
+    if (err != CROUS_OK) {
+        crous_frame_reader_free(reader);
+        return err;
+    }
+    if (flags & CROUS_MIGRATE_INDEX) err = crous_frame_writer_set_index(writer, 0, 0);
+
+    while (err == CROUS_OK) {
+        const uint8_t *body;
+        size_t len;
+        err = crous_frame_reader_next(reader, &body, &len);
+        if (err != CROUS_OK) break;
+
+        /* The body lives in the reader's own buffer, so a header-only
+           path rewrites it there */
+        err = crous_migrate_in_place((uint8_t *)body, len, target_version);
+        if (err == CROUS_OK) {
+            err = crous_frame_writer_write(writer, body, len);
+        } else if (err == CROUS_ERR_NOT_FOUND) {
+            uint8_t *migrated;
+            size_t migrated_len;
+            err = crous_migrate(body, len, target_version, &migrated, &migrated_len);
+            if (err == CROUS_OK) {
+                err = crous_frame_writer_write(writer, migrated, migrated_len);
+                free(migrated);
+            }
+        }
+    }
+    if (err == CROUS_ERR_NOT_FOUND) err = CROUS_OK;
+
+    crous_frame_reader_free(reader);
+    crous_err_t close_err = crous_frame_writer_close(writer);
+    return err != CROUS_OK ? err : close_err;
+}
+
+static size_t file_stream_read(void *user_data, uint8_t *buf, size_t max_len) {
+    return fread(buf, 1, max_len, (FILE *)user_data);
+}
+
+static size_t file_stream_write(void *user_data, const uint8_t *buf, size_t len) {
+    return fwrite(buf, 1, len, (FILE *)user_data);
+}
+
+typedef struct {
+    const char *const *src_paths;
+    const char *const *dst_paths;
+    uint8_t target_version;
+    unsigned flags;
+    crous_err_t *errs;
+} frame_migrate_t;
+
+static void frame_migrate_task(void *ctx, size_t k) {
+    frame_migrate_t *job = ctx;
+    FILE *src = fopen(job->src_paths[k], "rb");
+    FILE *dst = src ? fopen(job->dst_paths[k], "wb") : NULL;
+    crous_err_t err = CROUS_ERR_STREAM;
+
+    if (dst) {
+        crous_input_stream in = { src, file_stream_read };
+        crous_output_stream out = { dst, file_stream_write };
+        err = crous_migrate_log(&in, &out, job->target_version, job->flags);
+        if (err == CROUS_OK && ferror(src)) err = CROUS_ERR_STREAM;
+        if (fclose(dst) != 0 && err == CROUS_OK) err = CROUS_ERR_STREAM;
+        if (err != CROUS_OK) remove(job->dst_paths[k]);
+    }
+    if (src) fclose(src);
+    job->errs[k] = err;
+}
+
+crous_err_t crous_migrate_files_parallel(
+    const char *const *src_paths,
+    const char *const *dst_paths,
+    size_t count,
+    uint8_t target_version,
+    unsigned flags,
+    int nthreads,
+    crous_err_t *out_errors) {
+    if (count && (!src_paths || !dst_paths)) return CROUS_ERR_INVALID_TYPE;
+
+    crous_err_t *errs = out_errors ? out_errors : calloc(count ? count : 1, sizeof(*errs));
+    if (!errs) return CROUS_ERR_OOM;
+
+    frame_migrate_t job = { src_paths, dst_paths, target_version, flags, errs };
+    crous_parallel_for(count, nthreads, frame_migrate_task, &job);
+
+    crous_err_t err = CROUS_OK;
+    for (size_t k = 0; err == CROUS_OK && k < count; k++) err = errs[k];
+    if (!out_errors) free(errs);
+    return err;
+}
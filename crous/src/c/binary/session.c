@@ -0,0 +1,97 @@
+#include "../include/crous_session.h"
+#include "../include/crous_binary.h"
+#include <stdlib.h>
+
+/* ============================================================================
+   SESSION STATE
+   ============================================================================ */
+
+#define SESSION_ARENA_CHUNK 65536
+
+struct crous_session {
+    uint8_t *doc;               /* Plain document */
+    size_t doc_cap;
+    uint8_t *packed;            /* Envelope around doc, when options need one */
+    size_t packed_cap;
+    crous_arena *arena;         /* Decoded trees; created on first decode */
+};
+
+crous_err_t crous_session_new(crous_session **out_session) {
+    if (!out_session) return CROUS_ERR_INVALID_TYPE;
+    crous_session *session = calloc(1, sizeof(*session));
+    if (!session) return CROUS_ERR_OOM;
+    *out_session = session;
+    return CROUS_OK;
+}
+
+void crous_session_free(crous_session *session) {
+    if (!session) return;
+    free(session->doc);
+    free(session->packed);
+    crous_arena_free(session->arena);
+    free(session);
+}
+
+/* ============================================================================
+   ENCODE
+   ============================================================================ */
+
+crous_err_t crous_session_encode(crous_session *session, const crous_value *value,
+                                 const flux_binary_options_t *opts,
+                                 const uint8_t **out_buf, size_t *out_size) {
+    if (!session || !value || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    
+    size_t doc_size;
+    crous_err_t err = flux_encode_binary_inner_reuse(value, opts, &session->doc, &session->doc_cap, &doc_size);
+    if (err != CROUS_OK) return err;
+    
+    if (!opts || (opts->compression == CROUS_CODEC_NONE && !opts->dictionary && !opts->checksum)) {
+        *out_buf = session->doc;
+        *out_size = doc_size;
+        return CROUS_OK;
+    }
+    
+    size_t bound = flux_compress_bound(doc_size);
+    if (bound > session->packed_cap) {
+        uint8_t *packed = realloc(session->packed, bound);
+        if (!packed) return CROUS_ERR_OOM;
+        session->packed = packed;
+        session->packed_cap = bound;
+    }
+    
+    err = flux_compress_binary_into(session->doc, doc_size, (crous_codec_t)opts->compression, opts->dictionary,
+                                    opts->checksum ? FLUX_ENVELOPE_CHECKSUM : 0,
+                                    session->packed, session->packed_cap, out_size);
+    if (err != CROUS_OK) return err;
+    *out_buf = session->packed;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   DECODE
+   ============================================================================ */
+
+static crous_err_t session_arena(crous_session *session) {
+    if (session->arena) {
+        crous_arena_reset(session->arena);
+        return CROUS_OK;
+    }
+    session->arena = crous_arena_create(SESSION_ARENA_CHUNK);
+    return session->arena ? CROUS_OK : CROUS_ERR_OOM;
+}
+
+crous_err_t crous_session_decode(crous_session *session, const uint8_t *buf, size_t buf_size,
+                                 crous_value **out_value) {
+    if (!session || !out_value) return CROUS_ERR_INVALID_TYPE;
+    crous_err_t err = session_arena(session);
+    if (err != CROUS_OK) return err;
+    return crous_decode_arena(buf, buf_size, session->arena, out_value);
+}
+
+crous_err_t crous_session_decode_borrowed(crous_session *session, const uint8_t *buf, size_t buf_size,
+                                          crous_value **out_value) {
+    if (!session || !out_value) return CROUS_ERR_INVALID_TYPE;
+    crous_err_t err = session_arena(session);
+    if (err != CROUS_OK) return err;
+    return crous_decode_borrowed(buf, buf_size, session->arena, out_value);
+}
@@ -1,6 +1,31 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "../include/crous_arena.h"
+#include "../include/crous_stats.h"
+#include <stdint.h>
 #include <string.h>
 
+#if !defined(CROUS_NO_POOL) && defined(CROUS_THREAD_LOCAL)
+#  define CROUS_POOL_ENABLED 1
+#  if !defined(_WIN32) && defined(__GNUC__) && (defined(__unix__) || defined(__APPLE__))
+#    define CROUS_POOL_PTHREAD 1
+#    include <pthread.h>
+#  endif
+#endif
+
+/* ============================================================================
+   ARENA
+   ============================================================================ */
+
+/* Chunks tried before a new one is added, the newest included */
+#define ARENA_RETRY_CHUNKS 4
+
+/* A chunk that can't fit a request and has less than this left is retired */
+#define ARENA_RETIRE_BYTES 256
+
+/* The chunk header sits in front of its data, in one allocation */
 typedef struct arena_chunk {
     struct arena_chunk *next;
     uint8_t *data;
@@ -9,39 +34,60 @@ typedef struct arena_chunk {
 } arena_chunk_t;
 
 typedef struct {
-    arena_chunk_t *head;
-    size_t chunk_size;
+    arena_chunk_t *head;        /* Chunks with room, newest first */
+    arena_chunk_t *full;        /* Retired chunks and blocks of their own */
+    size_t chunk_size;          /* Size asked for at creation */
+    size_t next_size;           /* Size of the next chunk added */
     size_t total_used;
 } arena_impl_t;
 
+static arena_chunk_t* chunk_new(size_t size) {
+    if (size > SIZE_MAX - sizeof(arena_chunk_t)) return NULL;
+    arena_chunk_t *chunk = malloc(sizeof(arena_chunk_t) + size);
+    if (!chunk) return NULL;
+
+    CROUS_STAT_ADD(arena_chunks, 1);
+    CROUS_STAT_ADD(arena_bytes, size);
+    CROUS_STAT_ADD(mallocs, 1);
+    CROUS_STAT_ADD(malloc_bytes, sizeof(arena_chunk_t) + size);
+
+    chunk->next = NULL;
+    chunk->data = (uint8_t *)(chunk + 1);
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+static void chunk_list_free(arena_chunk_t *chunk) {
+    while (chunk) {
+        arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
 crous_arena* crous_arena_create(size_t chunk_size) {
     if (chunk_size == 0) chunk_size = 65536;
-    
+
     arena_impl_t *impl = malloc(sizeof(*impl));
     if (!impl) return NULL;
-    
-    impl->head = malloc(sizeof(arena_chunk_t));
+
+    impl->head = chunk_new(chunk_size);
     if (!impl->head) {
         free(impl);
         return NULL;
     }
-    
-    impl->head->data = malloc(chunk_size);
-    if (!impl->head->data) {
-        free(impl->head);
-        free(impl);
-        return NULL;
-    }
-    
-    impl->head->next = NULL;
-    impl->head->size = chunk_size;
-    impl->head->used = 0;
+
+    CROUS_STAT_ADD(mallocs, 2);
+    CROUS_STAT_ADD(malloc_bytes, sizeof(*impl) + sizeof(crous_arena));
+
+    impl->full = NULL;
     impl->chunk_size = chunk_size;
+    impl->next_size = chunk_size < CROUS_ARENA_CHUNK_MAX / 2 ? chunk_size * 2 : CROUS_ARENA_CHUNK_MAX;
     impl->total_used = 0;
-    
+
     crous_arena *arena = malloc(sizeof(*arena));
     if (!arena) {
-        free(impl->head->data);
         free(impl->head);
         free(impl);
         return NULL;
@@ -50,67 +96,108 @@ crous_arena* crous_arena_create(size_t chunk_size) {
     return arena;
 }
 
-void* crous_arena_alloc(crous_arena *arena, size_t size) {
+/* size bytes at a multiple of align from chunk, or NULL if they don't fit */
+static void* chunk_take(arena_impl_t *impl, arena_chunk_t *chunk, size_t size, size_t align) {
+    uintptr_t base = (uintptr_t)chunk->data;
+    size_t start = (size_t)(((base + chunk->used + align - 1) & ~(uintptr_t)(align - 1)) - base);
+    if (start > chunk->size || size > chunk->size - start) return NULL;
+
+    impl->total_used += start + size - chunk->used;
+    chunk->used = start + size;
+    return chunk->data + start;
+}
+
+void* crous_arena_alloc_aligned(crous_arena *arena, size_t size, size_t align) {
     if (!arena || size == 0) return NULL;
-    
+    if (align < CROUS_ARENA_ALIGN) align = CROUS_ARENA_ALIGN;
+    if (align > CROUS_ARENA_MAX_ALIGN || (align & (align - 1))) return NULL;
+    if (size > SIZE_MAX - CROUS_ARENA_MAX_ALIGN) return NULL;
+
     arena_impl_t *impl = (arena_impl_t *)arena->_impl;
-    
-    /* Try to allocate from current chunk */
-    arena_chunk_t *chunk = impl->head;
-    if (chunk->used + size <= chunk->size) {
-        void *ptr = chunk->data + chunk->used;
-        chunk->used += size;
-        impl->total_used += size;
-        return ptr;
-    }
-    
-    /* Need new chunk */
-    size_t new_chunk_size = impl->chunk_size;
-    if (size > new_chunk_size) {
-        new_chunk_size = size + 4096;
+
+    /* Round up so every allocation starts suitably aligned for value nodes */
+    size = (size + CROUS_ARENA_ALIGN - 1) & ~(size_t)(CROUS_ARENA_ALIGN - 1);
+
+    /* The newest chunks first; ones that are nearly full stop being tried */
+    arena_chunk_t **link = &impl->head;
+    for (int tries = 0; *link && tries < ARENA_RETRY_CHUNKS; tries++) {
+        arena_chunk_t *chunk = *link;
+        void *ptr = chunk_take(impl, chunk, size, align);
+        if (ptr) return ptr;
+        if (chunk->size - chunk->used < ARENA_RETIRE_BYTES) {
+            *link = chunk->next;
+            chunk->next = impl->full;
+            impl->full = chunk;
+        } else {
+            link = &chunk->next;
+        }
     }
-    
-    arena_chunk_t *new_chunk = malloc(sizeof(arena_chunk_t));
-    if (!new_chunk) return NULL;
-    
-    new_chunk->data = malloc(new_chunk_size);
-    if (!new_chunk->data) {
-        free(new_chunk);
-        return NULL;
+
+    /* Room for the worst-case padding; malloc already gives 16 bytes */
+    size_t need = size + (align > 16 ? align : 0);
+
+    /* A large request gets a block of its own behind the full chunks */
+    if (need > impl->next_size / 4) {
+        arena_chunk_t *block = chunk_new(need);
+        if (!block) return NULL;
+        block->next = impl->full;
+        impl->full = block;
+        return chunk_take(impl, block, size, align);
     }
-    
-    new_chunk->next = impl->head;
-    new_chunk->size = new_chunk_size;
-    new_chunk->used = size;
-    impl->head = new_chunk;
-    impl->total_used += size;
-    
-    return new_chunk->data;
+
+    arena_chunk_t *chunk = chunk_new(impl->next_size);
+    if (!chunk) return NULL;
+    chunk->next = impl->head;
+    impl->head = chunk;
+    if (impl->next_size <= CROUS_ARENA_CHUNK_MAX / 2) impl->next_size *= 2;
+    return chunk_take(impl, chunk, size, align);
+}
+
+void* crous_arena_alloc(crous_arena *arena, size_t size) {
+    return crous_arena_alloc_aligned(arena, size, CROUS_ARENA_ALIGN);
 }
 
 void crous_arena_reset(crous_arena *arena) {
     if (!arena) return;
-    
+
     arena_impl_t *impl = (arena_impl_t *)arena->_impl;
-    arena_chunk_t *chunk = impl->head;
-    while (chunk) {
-        chunk->used = 0;
-        chunk = chunk->next;
-    }
+    size_t high_water = impl->total_used > impl->chunk_size ? impl->total_used : impl->chunk_size;
     impl->total_used = 0;
+
+    /* Keep the largest chunk if it holds the high-water mark without
+     * being more than twice as big; otherwise one of exactly that size */
+    arena_chunk_t *lists[2] = { impl->head, impl->full };
+    arena_chunk_t *keep = NULL;
+    for (int i = 0; i < 2; i++)
+        for (arena_chunk_t *chunk = lists[i]; chunk; chunk = chunk->next)
+            if (!keep || chunk->size > keep->size) keep = chunk;
+
+    if (keep->size < high_water || keep->size / 2 > high_water) {
+        arena_chunk_t *fresh = chunk_new(high_water);
+        if (fresh) keep = fresh;    /* Out of memory: make do with the largest */
+    }
+
+    for (int i = 0; i < 2; i++) {
+        arena_chunk_t *chunk = lists[i];
+        while (chunk) {
+            arena_chunk_t *next = chunk->next;
+            if (chunk != keep) free(chunk);
+            chunk = next;
+        }
+    }
+    keep->next = NULL;
+    keep->used = 0;
+    impl->head = keep;
+    impl->full = NULL;
+    impl->next_size = keep->size < CROUS_ARENA_CHUNK_MAX / 2 ? keep->size * 2 : CROUS_ARENA_CHUNK_MAX;
 }
 
 void crous_arena_free(crous_arena *arena) {
     if (!arena) return;
-    
+
     arena_impl_t *impl = (arena_impl_t *)arena->_impl;
-    arena_chunk_t *chunk = impl->head;
-    while (chunk) {
-        arena_chunk_t *next = chunk->next;
-        free(chunk->data);
-        free(chunk);
-        chunk = next;
-    }
+    chunk_list_free(impl->head);
+    chunk_list_free(impl->full);
     free(impl);
     free(arena);
 }
@@ -120,3 +207,121 @@ size_t crous_arena_used(const crous_arena *arena) {
     arena_impl_t *impl = (arena_impl_t *)arena->_impl;
     return impl->total_used;
 }
+
+size_t crous_arena_capacity(const crous_arena *arena) {
+    if (!arena) return 0;
+    arena_impl_t *impl = (arena_impl_t *)arena->_impl;
+    size_t total = 0;
+    for (arena_chunk_t *chunk = impl->head; chunk; chunk = chunk->next) total += chunk->size;
+    for (arena_chunk_t *chunk = impl->full; chunk; chunk = chunk->next) total += chunk->size;
+    return total;
+}
+
+/* ============================================================================
+   NODE POOLS
+   ============================================================================ */
+
+#define POOL_CLASSES (CROUS_POOL_MAX_SIZE / 8)
+
+#if defined(CROUS_POOL_ENABLED)
+
+typedef struct pool_block {
+    struct pool_block *next;
+} pool_block;
+
+typedef struct {
+    pool_block *head[POOL_CLASSES];
+    uint32_t count[POOL_CLASSES];
+    int registered;             /* Flushed at thread exit */
+} pool_t;
+
+static CROUS_THREAD_LOCAL pool_t g_pool;
+
+#if defined(CROUS_POOL_PTHREAD)
+static pthread_key_t g_pool_key;
+static pthread_once_t g_pool_once = PTHREAD_ONCE_INIT;
+static int g_pool_key_ok;
+
+static void pool_release(pool_t *pool);
+
+static void pool_thread_exit(void *pool) {
+    pool_release(pool);
+}
+
+static void pool_key_init(void) {
+    g_pool_key_ok = pthread_key_create(&g_pool_key, pool_thread_exit) == 0;
+}
+#endif
+
+/* Have the pool flushed when its thread exits; only POSIX threads can */
+static void pool_register(pool_t *pool) {
+    pool->registered = 1;
+#if defined(CROUS_POOL_PTHREAD)
+    pthread_once(&g_pool_once, pool_key_init);
+    if (g_pool_key_ok) pthread_setspecific(g_pool_key, pool);
+#endif
+}
+
+static void pool_release(pool_t *pool) {
+    for (int c = 0; c < POOL_CLASSES; c++) {
+        pool_block *b = pool->head[c];
+        while (b) {
+            pool_block *next = b->next;
+            free(b);
+            b = next;
+        }
+        pool->head[c] = NULL;
+        pool->count[c] = 0;
+    }
+    /* Frees after the flush, by later thread-exit destructors, register again */
+    pool->registered = 0;
+}
+
+void* crous_pool_alloc(size_t size) {
+    if (size - 1 >= CROUS_POOL_MAX_SIZE) return malloc(size);
+
+    size_t c = (size - 1) >> 3;
+    pool_block *b = g_pool.head[c];
+    if (b) {
+        g_pool.head[c] = b->next;
+        g_pool.count[c]--;
+        CROUS_STAT_ADD(pool_hits, 1);
+        return b;
+    }
+    return malloc((c + 1) << 3);
+}
+
+void crous_pool_free(void *ptr, size_t size) {
+    if (!ptr) return;
+    if (size - 1 < CROUS_POOL_MAX_SIZE) {
+        size_t c = (size - 1) >> 3;
+        if (g_pool.count[c] < CROUS_POOL_DEPTH) {
+            if (!g_pool.registered) pool_register(&g_pool);
+            pool_block *b = ptr;
+            b->next = g_pool.head[c];
+            g_pool.head[c] = b;
+            g_pool.count[c]++;
+            return;
+        }
+    }
+    free(ptr);
+}
+
+void crous_pool_trim(void) {
+    pool_release(&g_pool);
+}
+
+#else
+
+void* crous_pool_alloc(size_t size) {
+    return malloc(size ? size : 1);
+}
+
+void crous_pool_free(void *ptr, size_t size) {
+    (void)size;
+    free(ptr);
+}
+
+void crous_pool_trim(void) {}
+
+#endif
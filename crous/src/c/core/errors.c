@@ -15,6 +15,8 @@ const char* crous_err_str(crous_err_t err) {
         case CROUS_ERR_INVALID_HEADER: return "Invalid header";
         case CROUS_ERR_SYNTAX: return "Syntax error";
         case CROUS_ERR_DEPTH_EXCEEDED: return "Depth exceeded";
+        case CROUS_ERR_NOT_FOUND: return "Not found";
+        case CROUS_ERR_CHECKSUM: return "Checksum mismatch";
         default: return "Unknown error";
     }
 }
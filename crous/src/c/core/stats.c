@@ -0,0 +1,255 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "../include/crous_stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
+
+/* ============================================================================
+   CLOCK
+   ============================================================================ */
+
+uint64_t crous_stats_now_ns(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    return (uint64_t)clock() * (1000000000u / CLOCKS_PER_SEC);
+#endif
+}
+
+#if defined(CROUS_NO_STATS)
+
+/* ============================================================================
+   STUBS
+   ============================================================================ */
+
+void crous_stats_enable(int enabled) { (void)enabled; }
+int crous_stats_enabled(void) { return 0; }
+void crous_stats_get(crous_stats_t *out) { memset(out, 0, sizeof(*out)); }
+void crous_stats_get_thread(crous_stats_t *out) { memset(out, 0, sizeof(*out)); }
+void crous_stats_reset(void) {}
+void crous_stats_set_trace(crous_trace_fn fn, void *user) { (void)fn; (void)user; }
+
+#else
+
+/* ============================================================================
+   THREAD BLOCKS
+   ============================================================================ */
+
+/*
+ * Each thread that counts gets a block, pushed once onto a lock-free list
+ * and never freed: threads are few and long-lived next to the calls they
+ * make, and an exited thread's counts stay in the totals. Readers sum the
+ * blocks without stopping the writers, so a total taken while work runs
+ * is approximate.
+ */
+typedef struct stats_block {
+    crous_stats_t counters;
+    struct stats_block *next;
+} stats_block;
+
+int crous_stats_mode;
+
+static stats_block *g_blocks;
+
+static crous_trace_fn g_trace;
+static void *g_trace_user;
+
+#if defined(CROUS_THREAD_LOCAL)
+CROUS_THREAD_LOCAL crous_stats_t *crous_stats_tls;
+static CROUS_THREAD_LOCAL int g_span_depth;
+#else
+static stats_block g_shared;
+static int g_shared_linked;
+static int g_span_depth;
+#endif
+
+#if defined(_WIN32)
+static stats_block *blocks_head(void) {
+    return (stats_block *)InterlockedCompareExchangePointer((PVOID volatile *)&g_blocks, NULL, NULL);
+}
+static int blocks_push(stats_block *b, stats_block *expect) {
+    return InterlockedCompareExchangePointer((PVOID volatile *)&g_blocks, b, expect) == expect;
+}
+#elif defined(__GNUC__)
+static stats_block *blocks_head(void) { return __atomic_load_n(&g_blocks, __ATOMIC_ACQUIRE); }
+static int blocks_push(stats_block *b, stats_block *expect) {
+    return __atomic_compare_exchange_n(&g_blocks, &expect, b, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#else
+static stats_block *blocks_head(void) { return g_blocks; }
+static int blocks_push(stats_block *b, stats_block *expect) {
+    if (g_blocks != expect) return 0;
+    g_blocks = b;
+    return 1;
+}
+#endif
+
+static void blocks_link(stats_block *b) {
+    stats_block *head;
+    do {
+        head = blocks_head();
+        b->next = head;
+    } while (!blocks_push(b, head));
+}
+
+/* Out of memory: counts from threads without a block land here */
+static stats_block g_overflow;
+
+crous_stats_t *crous_stats_local_slow(void) {
+#if defined(CROUS_THREAD_LOCAL)
+    stats_block *b = calloc(1, sizeof(*b));
+    if (!b) return &g_overflow.counters;
+    blocks_link(b);
+    crous_stats_tls = &b->counters;
+    return crous_stats_tls;
+#else
+    if (!g_shared_linked) {
+        g_shared_linked = 1;
+        blocks_link(&g_shared);
+    }
+    return &g_shared.counters;
+#endif
+}
+
+/* ============================================================================
+   COUNTERS
+   ============================================================================ */
+
+void crous_stats_enable(int enabled) {
+    if (enabled) crous_stats_mode |= CROUS_STATS_COUNT;
+    else crous_stats_mode &= ~CROUS_STATS_COUNT;
+}
+
+int crous_stats_enabled(void) {
+    return (crous_stats_mode & CROUS_STATS_COUNT) != 0;
+}
+
+static void stats_add(crous_stats_t *out, const crous_stats_t *in) {
+    const uint64_t *src = (const uint64_t *)in;
+    uint64_t *dst = (uint64_t *)out;
+    for (size_t i = 0; i < sizeof(*in) / sizeof(uint64_t); i++) dst[i] += src[i];
+}
+
+void crous_stats_get(crous_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    for (stats_block *b = blocks_head(); b; b = b->next) stats_add(out, &b->counters);
+    stats_add(out, &g_overflow.counters);
+}
+
+void crous_stats_get_thread(crous_stats_t *out) {
+#if defined(CROUS_THREAD_LOCAL)
+    if (crous_stats_tls) *out = *crous_stats_tls;
+    else memset(out, 0, sizeof(*out));
+#else
+    *out = g_shared.counters;
+#endif
+}
+
+void crous_stats_reset(void) {
+    for (stats_block *b = blocks_head(); b; b = b->next) memset(&b->counters, 0, sizeof(b->counters));
+    memset(&g_overflow.counters, 0, sizeof(g_overflow.counters));
+}
+
+/* ============================================================================
+   SPANS
+   ============================================================================ */
+
+void crous_stats_set_trace(crous_trace_fn fn, void *user) {
+    g_trace_user = user;
+    g_trace = fn;
+    if (fn) crous_stats_mode |= CROUS_STATS_TRACE;
+    else crous_stats_mode &= ~CROUS_STATS_TRACE;
+}
+
+void crous_span_open(crous_span *s, const char *entry, crous_phase_t phase,
+                     crous_stats_format_t in_format, crous_stats_format_t out_format, size_t in_size) {
+    if (g_span_depth++ > 0) return;
+
+    s->active = 1;
+    s->in_inner = NULL;
+    s->out_inner = NULL;
+    memset(&s->info, 0, sizeof(s->info));
+    s->info.event = CROUS_TRACE_BEGIN;
+    s->info.entry = entry;
+    s->info.phase = phase;
+    s->info.in_format = in_format;
+    s->info.out_format = out_format;
+    s->info.in_size = in_size;
+
+    crous_trace_fn trace = g_trace;
+    if (trace) trace(g_trace_user, &s->info);
+    s->start_ns = crous_stats_now_ns();
+}
+
+crous_err_t crous_span_close(crous_span *s, crous_err_t err, size_t out_size) {
+    uint64_t elapsed = crous_stats_now_ns() - s->start_ns;
+    s->info.event = CROUS_TRACE_END;
+    s->info.out_size += out_size;
+    s->info.err = err;
+    s->info.elapsed_ns = elapsed;
+    s->active = 0;
+    g_span_depth = 0;
+
+    if (crous_stats_mode & CROUS_STATS_COUNT) {
+        crous_stats_t *st = crous_stats_local();
+        st->calls[s->info.phase]++;
+        st->phase_ns[s->info.phase] += elapsed;
+        if (err == CROUS_OK) {
+            st->bytes_decoded[s->info.in_format] += s->info.in_size;
+            st->bytes_encoded[s->info.out_format] += s->info.out_size;
+        }
+    }
+
+    crous_trace_fn trace = g_trace;
+    if (trace) trace(g_trace_user, &s->info);
+    return err;
+}
+
+/* Counting stream wrappers: the span accumulates the bytes that pass */
+static size_t span_read(void *user_data, uint8_t *buf, size_t max_len) {
+    crous_span *s = (crous_span *)user_data;
+    size_t n = s->in_inner->read(s->in_inner->user_data, buf, max_len);
+    if (n != (size_t)-1) s->info.in_size += n;
+    return n;
+}
+
+static size_t span_write(void *user_data, const uint8_t *buf, size_t len) {
+    crous_span *s = (crous_span *)user_data;
+    size_t n = s->out_inner->write(s->out_inner->user_data, buf, len);
+    if (n != (size_t)-1) s->info.out_size += n;
+    return n;
+}
+
+crous_input_stream *crous_span_input(crous_span *s, crous_input_stream *in) {
+    if (!s->active || !in) return in;
+    s->in_inner = in;
+    s->in.user_data = s;
+    s->in.read = span_read;
+    return &s->in;
+}
+
+crous_output_stream *crous_span_output(crous_span *s, crous_output_stream *out) {
+    if (!s->active || !out) return out;
+    s->out_inner = out;
+    s->out.user_data = s;
+    s->out.write = span_write;
+    return &s->out;
+}
+
+#endif /* CROUS_NO_STATS */
@@ -1,4 +1,7 @@
 #include "../include/crous_value.h"
+#include "../include/crous_stats.h"
+#include "../include/crous_stack.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -6,86 +9,161 @@
    CONSTRUCTORS
    ============================================================================ */
 
-crous_value* crous_value_new_null(void) {
-    crous_value *v = malloc(sizeof(*v));
+/* Nodes are allocated at the size of their type, which GCC's bounds
+ * warning flags wherever it can see the allocation */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+
+/* Allocate a value node from arena, or from the calling thread's node pool
+ * when arena is NULL, sized for its type plus extra bytes of inline data */
+static crous_value* value_alloc_extra(crous_arena *arena, crous_type_t type, size_t extra) {
+    size_t size = CROUS_VALUE_NODE_SIZE(type) + extra;
+    crous_value *v = arena ? crous_arena_alloc(arena, size) : crous_pool_alloc(size);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_NULL;
+    CROUS_STAT_ADD(values_created[type], 1);
+    if (!arena) {
+        CROUS_STAT_ADD(mallocs, 1);
+        CROUS_STAT_ADD(malloc_bytes, size);
+    }
+    v->type = type;
+    v->flags = arena ? CROUS_VALUE_FLAG_ARENA : 0;
     return v;
 }
 
-crous_value* crous_value_new_bool(int b) {
-    crous_value *v = malloc(sizeof(*v));
+static crous_value* value_alloc(crous_arena *arena, crous_type_t type) {
+    return value_alloc_extra(arena, type, 0);
+}
+
+/* Allocate payload storage next to the node that owns it */
+static void* payload_alloc(crous_arena *arena, size_t size) {
+    if (size == 0) size = 1;
+    if (arena) return crous_arena_alloc(arena, size);
+    CROUS_STAT_ADD(mallocs, 1);
+    CROUS_STAT_ADD(malloc_bytes, size);
+    return malloc(size);
+}
+
+/* Give a heap node back to the pool, at the size it was allocated with */
+static void value_release(crous_value *v) {
+    size_t size = CROUS_VALUE_NODE_SIZE(v->type);
+    if (v->flags & CROUS_VALUE_FLAG_INLINE) size += v->data.bytes.len;
+    crous_pool_free(v, size);
+}
+
+/* Release a node whose payload could not be allocated */
+static void value_discard(crous_arena *arena, crous_value *v) {
+    if (!arena) value_release(v);
+}
+
+crous_value* crous_value_new_null_arena(crous_arena *arena) {
+    return value_alloc(arena, CROUS_TYPE_NULL);
+}
+
+crous_value* crous_value_new_bool_arena(crous_arena *arena, int b) {
+    crous_value *v = value_alloc(arena, CROUS_TYPE_BOOL);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_BOOL;
     v->data.b = b ? 1 : 0;
     return v;
 }
 
-crous_value* crous_value_new_int(int64_t v_val) {
-    crous_value *v = malloc(sizeof(*v));
+crous_value* crous_value_new_int_arena(crous_arena *arena, int64_t v_val) {
+    crous_value *v = value_alloc(arena, CROUS_TYPE_INT);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_INT;
     v->data.i = v_val;
     return v;
 }
 
-crous_value* crous_value_new_float(double d) {
-    crous_value *v = malloc(sizeof(*v));
+crous_value* crous_value_new_float_arena(crous_arena *arena, double d) {
+    crous_value *v = value_alloc(arena, CROUS_TYPE_FLOAT);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_FLOAT;
     v->data.f = d;
     return v;
 }
 
-crous_value* crous_value_new_string(const char *data, size_t len) {
-    crous_value *v = malloc(sizeof(*v));
-    if (!v) return NULL;
-    v->type = CROUS_TYPE_STRING;
-    v->data.s.data = malloc(len);
-    if (!v->data.s.data) {
-        free(v);
-        return NULL;
+/* A copy of data: short ones right after the node, in one allocation */
+static crous_value* new_buffer(crous_arena *arena, crous_type_t type, const void *data, size_t len) {
+    crous_value *v;
+    uint8_t *store;
+    if (len <= CROUS_INLINE_STRING_MAX) {
+        v = value_alloc_extra(arena, type, len);
+        if (!v) return NULL;
+        v->flags |= CROUS_VALUE_FLAG_INLINE;
+        store = (uint8_t *)v + CROUS_VALUE_NODE_SIZE(type);
+    } else {
+        v = value_alloc(arena, type);
+        if (!v) return NULL;
+        store = payload_alloc(arena, len);
+        if (!store) {
+            value_discard(arena, v);
+            return NULL;
+        }
     }
-    if (len > 0) memcpy(v->data.s.data, data, len);
-    v->data.s.len = len;
+    if (len > 0) memcpy(store, data, len);
+    /* String and bytes share the crous_buffer_t layout */
+    v->data.bytes.data = store;
+    v->data.bytes.len = len;
     return v;
 }
 
-crous_value* crous_value_new_bytes(const uint8_t *data, size_t len) {
-    crous_value *v = malloc(sizeof(*v));
+crous_value* crous_value_new_string_arena(crous_arena *arena, const char *data, size_t len) {
+    return new_buffer(arena, CROUS_TYPE_STRING, data, len);
+}
+
+crous_value* crous_value_new_bytes_arena(crous_arena *arena, const uint8_t *data, size_t len) {
+    return new_buffer(arena, CROUS_TYPE_BYTES, data, len);
+}
+
+/* On failure the caller keeps ownership of data */
+static crous_value* new_taken_buffer(crous_type_t type, uint8_t *data, size_t len) {
+    if (!data && len > 0) return NULL;
+    crous_value *v = value_alloc(NULL, type);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_BYTES;
-    v->data.bytes.data = malloc(len);
-    if (!v->data.bytes.data) {
-        free(v);
-        return NULL;
+    if (!data) {
+        data = payload_alloc(NULL, 0);
+        if (!data) {
+            value_release(v);
+            return NULL;
+        }
     }
-    if (len > 0) memcpy(v->data.bytes.data, data, len);
+    /* String and bytes share the crous_buffer_t layout */
+    v->data.bytes.data = data;
     v->data.bytes.len = len;
     return v;
 }
 
-crous_value* crous_value_new_list(size_t capacity) {
-    crous_value *v = malloc(sizeof(*v));
+crous_value* crous_value_new_string_take(uint8_t *data, size_t len) {
+    return new_taken_buffer(CROUS_TYPE_STRING, data, len);
+}
+
+crous_value* crous_value_new_bytes_take(uint8_t *data, size_t len) {
+    return new_taken_buffer(CROUS_TYPE_BYTES, data, len);
+}
+
+crous_value* crous_value_new_string_borrowed(crous_arena *arena, const char *data, size_t len) {
+    crous_value *v = value_alloc(arena, CROUS_TYPE_STRING);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_LIST;
-    v->data.list.items = capacity > 0 ? malloc(capacity * sizeof(crous_value *)) : NULL;
-    if (capacity > 0 && !v->data.list.items) {
-        free(v);
-        return NULL;
-    }
-    v->data.list.len = 0;
-    v->data.list.cap = capacity;
+    v->flags |= CROUS_VALUE_FLAG_BORROWED;
+    v->data.s.data = (uint8_t *)data;
+    v->data.s.len = len;
     return v;
 }
 
-crous_value* crous_value_new_tuple(size_t capacity) {
-    crous_value *v = malloc(sizeof(*v));
+crous_value* crous_value_new_bytes_borrowed(crous_arena *arena, const uint8_t *data, size_t len) {
+    crous_value *v = value_alloc(arena, CROUS_TYPE_BYTES);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_TUPLE;
-    v->data.list.items = capacity > 0 ? malloc(capacity * sizeof(crous_value *)) : NULL;
+    v->flags |= CROUS_VALUE_FLAG_BORROWED;
+    v->data.bytes.data = (uint8_t *)data;
+    v->data.bytes.len = len;
+    return v;
+}
+
+static crous_value* new_sequence(crous_arena *arena, crous_type_t type, size_t capacity) {
+    crous_value *v = value_alloc(arena, type);
+    if (!v) return NULL;
+    v->data.list.items = capacity > 0 ? payload_alloc(arena, capacity * sizeof(crous_value *)) : NULL;
     if (capacity > 0 && !v->data.list.items) {
-        free(v);
+        value_discard(arena, v);
         return NULL;
     }
     v->data.list.len = 0;
@@ -93,29 +171,168 @@ crous_value* crous_value_new_tuple(size_t capacity) {
     return v;
 }
 
-crous_value* crous_value_new_dict(size_t capacity) {
-    crous_value *v = malloc(sizeof(*v));
+crous_value* crous_value_new_list_arena(crous_arena *arena, size_t capacity) {
+    return new_sequence(arena, CROUS_TYPE_LIST, capacity);
+}
+
+crous_value* crous_value_new_tuple_arena(crous_arena *arena, size_t capacity) {
+    return new_sequence(arena, CROUS_TYPE_TUPLE, capacity);
+}
+
+/* Index slots for len entries at <= 50% load, a power of two */
+static size_t dict_index_cap(size_t len) {
+    size_t cap = 32;
+    while (cap < len * 2) cap *= 2;
+    return cap;
+}
+
+crous_value* crous_value_new_dict_arena(crous_arena *arena, size_t capacity) {
+    crous_value *v = value_alloc(arena, CROUS_TYPE_DICT);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_DICT;
-    v->data.dict.entries = capacity > 0 ? malloc(capacity * sizeof(crous_dict_entry)) : NULL;
+    v->data.dict.entries = capacity > 0 ? payload_alloc(arena, capacity * sizeof(crous_dict_entry)) : NULL;
     if (capacity > 0 && !v->data.dict.entries) {
-        free(v);
+        value_discard(arena, v);
         return NULL;
     }
     v->data.dict.len = 0;
     v->data.dict.cap = capacity;
+    v->data.dict.index = NULL;
+    v->data.dict.index_cap = 0;
+    
+    /* An arena dict never grows, so a large one reserves all of its index
+     * now and appends fill it; without room it stays unindexed */
+    if (arena && capacity >= CROUS_DICT_INDEX_THRESHOLD && capacity <= UINT32_MAX) {
+        size_t index_cap = dict_index_cap(capacity);
+        v->data.dict.index = payload_alloc(arena, index_cap * sizeof(uint32_t));
+        if (v->data.dict.index) {
+            memset(v->data.dict.index, 0, index_cap * sizeof(uint32_t));
+            v->data.dict.index_cap = index_cap;
+        }
+    }
     return v;
 }
 
-crous_value* crous_value_new_tagged(uint32_t tag, crous_value *inner) {
-    crous_value *v = malloc(sizeof(*v));
+crous_value* crous_value_new_tagged_arena(crous_arena *arena, uint32_t tag, crous_value *inner) {
+    crous_value *v = value_alloc(arena, CROUS_TYPE_TAGGED);
     if (!v) return NULL;
-    v->type = CROUS_TYPE_TAGGED;
     v->data.tagged.tag = tag;
     v->data.tagged.value = inner;
     return v;
 }
 
+/* i64 and f64 arrays share one layout; elements are always 8 bytes */
+static crous_value* new_array(crous_arena *arena, crous_type_t type, const void *data, size_t len) {
+    if (len > SIZE_MAX / 8) return NULL;
+    crous_value *v = value_alloc(arena, type);
+    if (!v) return NULL;
+    v->data.array.data = payload_alloc(arena, len * 8);
+    if (!v->data.array.data) {
+        value_discard(arena, v);
+        return NULL;
+    }
+    if (len > 0) memcpy(v->data.array.data, data, len * 8);
+    v->data.array.len = len;
+    return v;
+}
+
+crous_value* crous_value_new_i64_array_arena(crous_arena *arena, const int64_t *data, size_t len) {
+    return new_array(arena, CROUS_TYPE_I64_ARRAY, data, len);
+}
+
+crous_value* crous_value_new_f64_array_arena(crous_arena *arena, const double *data, size_t len) {
+    return new_array(arena, CROUS_TYPE_F64_ARRAY, data, len);
+}
+
+/* On failure the caller keeps ownership of data */
+static crous_value* new_taken_array(crous_type_t type, void *data, size_t len) {
+    if (!data && len > 0) return NULL;
+    crous_value *v = value_alloc(NULL, type);
+    if (!v) return NULL;
+    if (!data) {
+        data = payload_alloc(NULL, 0);
+        if (!data) {
+            value_release(v);
+            return NULL;
+        }
+    }
+    v->data.array.data = data;
+    v->data.array.len = len;
+    return v;
+}
+
+crous_value* crous_value_new_i64_array_take(int64_t *data, size_t len) {
+    return new_taken_array(CROUS_TYPE_I64_ARRAY, data, len);
+}
+
+crous_value* crous_value_new_f64_array_take(double *data, size_t len) {
+    return new_taken_array(CROUS_TYPE_F64_ARRAY, data, len);
+}
+
+static crous_value* new_borrowed_array(crous_arena *arena, crous_type_t type, const void *data, size_t len) {
+    crous_value *v = value_alloc(arena, type);
+    if (!v) return NULL;
+    v->flags |= CROUS_VALUE_FLAG_BORROWED;
+    v->data.array.data = (void *)data;
+    v->data.array.len = len;
+    return v;
+}
+
+crous_value* crous_value_new_i64_array_borrowed(crous_arena *arena, const void *data, size_t len) {
+    return new_borrowed_array(arena, CROUS_TYPE_I64_ARRAY, data, len);
+}
+
+crous_value* crous_value_new_f64_array_borrowed(crous_arena *arena, const void *data, size_t len) {
+    return new_borrowed_array(arena, CROUS_TYPE_F64_ARRAY, data, len);
+}
+
+crous_value* crous_value_new_null(void) {
+    return crous_value_new_null_arena(NULL);
+}
+
+crous_value* crous_value_new_bool(int b) {
+    return crous_value_new_bool_arena(NULL, b);
+}
+
+crous_value* crous_value_new_int(int64_t v_val) {
+    return crous_value_new_int_arena(NULL, v_val);
+}
+
+crous_value* crous_value_new_float(double d) {
+    return crous_value_new_float_arena(NULL, d);
+}
+
+crous_value* crous_value_new_string(const char *data, size_t len) {
+    return crous_value_new_string_arena(NULL, data, len);
+}
+
+crous_value* crous_value_new_bytes(const uint8_t *data, size_t len) {
+    return crous_value_new_bytes_arena(NULL, data, len);
+}
+
+crous_value* crous_value_new_list(size_t capacity) {
+    return crous_value_new_list_arena(NULL, capacity);
+}
+
+crous_value* crous_value_new_tuple(size_t capacity) {
+    return crous_value_new_tuple_arena(NULL, capacity);
+}
+
+crous_value* crous_value_new_dict(size_t capacity) {
+    return crous_value_new_dict_arena(NULL, capacity);
+}
+
+crous_value* crous_value_new_tagged(uint32_t tag, crous_value *inner) {
+    return crous_value_new_tagged_arena(NULL, tag, inner);
+}
+
+crous_value* crous_value_new_i64_array(const int64_t *data, size_t len) {
+    return new_array(NULL, CROUS_TYPE_I64_ARRAY, data, len);
+}
+
+crous_value* crous_value_new_f64_array(const double *data, size_t len) {
+    return new_array(NULL, CROUS_TYPE_F64_ARRAY, data, len);
+}
+
 /* ============================================================================
    GETTERS
    ============================================================================ */
@@ -164,6 +381,24 @@ const crous_value* crous_value_get_tagged_inner(const crous_value *v) {
     return NULL;
 }
 
+const int64_t* crous_value_get_i64_array(const crous_value *v, size_t *out_len) {
+    if (v && v->type == CROUS_TYPE_I64_ARRAY) {
+        if (out_len) *out_len = v->data.array.len;
+        return v->data.array.data;
+    }
+    if (out_len) *out_len = 0;
+    return NULL;
+}
+
+const double* crous_value_get_f64_array(const crous_value *v, size_t *out_len) {
+    if (v && v->type == CROUS_TYPE_F64_ARRAY) {
+        if (out_len) *out_len = v->data.array.len;
+        return v->data.array.data;
+    }
+    if (out_len) *out_len = 0;
+    return NULL;
+}
+
 /* ============================================================================
    LIST/TUPLE OPERATIONS
    ============================================================================ */
@@ -194,11 +429,14 @@ crous_err_t crous_value_list_append(crous_value *v, crous_value *item) {
     if (new_len < v->data.list.len) return CROUS_ERR_OVERFLOW;
     
     if (new_len > v->data.list.cap) {
+        if (v->flags & CROUS_VALUE_FLAG_ARENA) return CROUS_ERR_OVERFLOW;
         size_t new_cap = (v->data.list.cap == 0) ? 8 : v->data.list.cap * 2;
         while (new_cap < new_len) new_cap *= 2;
         
         crous_value **new_items = realloc(v->data.list.items, new_cap * sizeof(crous_value *));
         if (!new_items) return CROUS_ERR_OOM;
+        CROUS_STAT_ADD(mallocs, 1);
+        CROUS_STAT_ADD(malloc_bytes, new_cap * sizeof(crous_value *));
         v->data.list.items = new_items;
         v->data.list.cap = new_cap;
     }
@@ -216,56 +454,182 @@ size_t crous_value_dict_size(const crous_value *v) {
     return (v && v->type == CROUS_TYPE_DICT) ? v->data.dict.len : 0;
 }
 
-crous_value* crous_value_dict_get(const crous_value *v, const char *key) {
-    if (!v || v->type != CROUS_TYPE_DICT || !key) return NULL;
-    
-    for (size_t i = 0; i < v->data.dict.len; i++) {
-        if (strcmp(v->data.dict.entries[i].key, key) == 0)
-            return v->data.dict.entries[i].value;
+/* FNV-1a over the raw key bytes */
+static uint64_t dict_hash_key(const char *key, size_t key_len) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < key_len; i++) {
+        h ^= (uint8_t)key[i];
+        h *= 1099511628211ULL;
     }
-    return NULL;
+    return h;
 }
 
-/* Internal function that handles both null-terminated and binary-safe keys */
-static crous_err_t crous_value_dict_set_internal(crous_value *v, const char *key, size_t key_len, crous_value *value) {
-    if (!v || v->type != CROUS_TYPE_DICT || !key)
-        return CROUS_ERR_INVALID_TYPE;
-    
-    /* Check if key already exists */
-    for (size_t i = 0; i < v->data.dict.len; i++) {
-        if (v->data.dict.entries[i].key_len == key_len &&
-            memcmp(v->data.dict.entries[i].key, key, key_len) == 0) {
-            v->data.dict.entries[i].value = value;
-            return CROUS_OK;
+/* Place entry position pos into the index; caller guarantees a free slot */
+static void dict_index_insert(crous_dict *d, size_t pos) {
+    size_t mask = d->index_cap - 1;
+    size_t slot = (size_t)dict_hash_key(d->entries[pos].key, d->entries[pos].key_len) & mask;
+    while (d->index[slot] != 0)
+        slot = (slot + 1) & mask;
+    d->index[slot] = (uint32_t)(pos + 1);
+}
+
+/* (Re)build the index so that it holds at least min_len entries at <= 50% load */
+static crous_err_t dict_index_rebuild(crous_dict *d, size_t min_len) {
+    size_t new_cap = dict_index_cap(min_len);
+    uint32_t *new_index = calloc(new_cap, sizeof(uint32_t));
+    if (!new_index) return CROUS_ERR_OOM;
+    CROUS_STAT_ADD(mallocs, 1);
+    CROUS_STAT_ADD(malloc_bytes, new_cap * sizeof(uint32_t));
+
+    free(d->index);
+    d->index = new_index;
+    d->index_cap = new_cap;
+    for (size_t i = 0; i < d->len; i++)
+        dict_index_insert(d, i);
+    return CROUS_OK;
+}
+
+/* Make sure the index can take one more entry. Small dicts stay unindexed. */
+static crous_err_t dict_index_reserve(crous_dict *d) {
+    size_t want = d->len + 1;
+    if (!d->index) {
+        if (want < CROUS_DICT_INDEX_THRESHOLD) return CROUS_OK;
+        return dict_index_rebuild(d, want);
+    }
+    if (want * 2 > d->index_cap) return dict_index_rebuild(d, want);
+    return CROUS_OK;
+}
+
+/* Returns the position of key in entries[], or -1 if absent. Read-only,
+ * so concurrent lookups are safe. */
+static long dict_find(const crous_value *v, const char *key, size_t key_len) {
+    const crous_dict *d = &v->data.dict;
+    if (d->index) {
+        size_t mask = d->index_cap - 1;
+        size_t slot = (size_t)dict_hash_key(key, key_len) & mask;
+        while (d->index[slot] != 0) {
+            size_t pos = d->index[slot] - 1;
+            if (d->entries[pos].key_len == key_len &&
+                memcmp(d->entries[pos].key, key, key_len) == 0)
+                return (long)pos;
+            slot = (slot + 1) & mask;
         }
+        return -1;
+    }
+
+    for (size_t i = 0; i < d->len; i++) {
+        if (d->entries[i].key_len == key_len &&
+            memcmp(d->entries[i].key, key, key_len) == 0)
+            return (long)i;
     }
+    return -1;
+}
+
+crous_value* crous_value_dict_get_binary(const crous_value *v, const char *key, size_t key_len) {
+    if (!v || v->type != CROUS_TYPE_DICT || !key) return NULL;
+    long pos = dict_find(v, key, key_len);
+    return pos >= 0 ? v->data.dict.entries[pos].value : NULL;
+}
+
+crous_value* crous_value_dict_get(const crous_value *v, const char *key) {
+    if (!key) return NULL;
+    return crous_value_dict_get_binary(v, key, strlen(key));
+}
+
+/* Give a heap dict private copies of keys that were borrowed from a buffer */
+static crous_err_t dict_own_keys(crous_value *v) {
+    crous_dict *d = &v->data.dict;
+    char **copies = malloc((d->len ? d->len : 1) * sizeof(char *));
+    if (!copies) return CROUS_ERR_OOM;
     
-    /* Add new entry */
-    size_t new_len = v->data.dict.len + 1;
-    if (new_len < v->data.dict.len) return CROUS_ERR_OVERFLOW;
+    for (size_t i = 0; i < d->len; i++) {
+        copies[i] = payload_alloc(NULL, d->entries[i].key_len);
+        if (!copies[i]) {
+            while (i-- > 0) free(copies[i]);
+            free(copies);
+            return CROUS_ERR_OOM;
+        }
+        if (d->entries[i].key_len > 0) memcpy(copies[i], d->entries[i].key, d->entries[i].key_len);
+    }
     
-    if (new_len > v->data.dict.cap) {
-        size_t new_cap = (v->data.dict.cap == 0) ? 8 : v->data.dict.cap * 2;
+    for (size_t i = 0; i < d->len; i++)
+        d->entries[i].key = copies[i];
+    free(copies);
+    v->flags &= (uint8_t)~CROUS_VALUE_FLAG_BORROWED;
+    return CROUS_OK;
+}
+
+/* Append a new entry, growing entries[] and maintaining the index.
+ * Arena dicts take the key copy from arena and never grow; their index,
+ * if reserved, has room for every slot. With borrow set, key is stored
+ * as-is. */
+static crous_err_t dict_append(crous_arena *arena, crous_value *v, const char *key, size_t key_len,
+                               crous_value *value, int borrow) {
+    crous_dict *d = &v->data.dict;
+    size_t new_len = d->len + 1;
+    if (new_len < d->len) return CROUS_ERR_OVERFLOW;
+    if (new_len > UINT32_MAX) return CROUS_ERR_OVERFLOW;
+
+    if (new_len > d->cap) {
+        if (arena) return CROUS_ERR_OVERFLOW;
+        size_t new_cap = (d->cap == 0) ? 8 : d->cap * 2;
         while (new_cap < new_len) new_cap *= 2;
         
-        crous_dict_entry *new_entries = realloc(v->data.dict.entries, new_cap * sizeof(crous_dict_entry));
+        crous_dict_entry *new_entries = realloc(d->entries, new_cap * sizeof(crous_dict_entry));
         if (!new_entries) return CROUS_ERR_OOM;
-        v->data.dict.entries = new_entries;
-        v->data.dict.cap = new_cap;
+        CROUS_STAT_ADD(mallocs, 1);
+        CROUS_STAT_ADD(malloc_bytes, new_cap * sizeof(crous_dict_entry));
+        d->entries = new_entries;
+        d->cap = new_cap;
+    }
+
+    if (!arena) {
+        crous_err_t err = dict_index_reserve(d);
+        if (err != CROUS_OK) return err;
+        /* A heap dict frees either all of its keys or none of them */
+        if (!borrow && (v->flags & CROUS_VALUE_FLAG_BORROWED)) {
+            err = dict_own_keys(v);
+            if (err != CROUS_OK) return err;
+        }
     }
     
-    char *key_copy = malloc(key_len);
-    if (!key_copy) return CROUS_ERR_OOM;
-    memcpy(key_copy, key, key_len);
+    char *key_store;
+    if (borrow) {
+        key_store = (char *)key;
+        v->flags |= CROUS_VALUE_FLAG_BORROWED;
+    } else {
+        key_store = payload_alloc(arena, key_len);
+        if (!key_store) return CROUS_ERR_OOM;
+        if (key_len > 0) memcpy(key_store, key, key_len);
+    }
     
-    v->data.dict.entries[v->data.dict.len].key = key_copy;
-    v->data.dict.entries[v->data.dict.len].key_len = key_len;
-    v->data.dict.entries[v->data.dict.len].value = value;
-    v->data.dict.len = new_len;
+    d->entries[d->len].key = key_store;
+    d->entries[d->len].key_len = key_len;
+    d->entries[d->len].value = value;
+    if (d->index) dict_index_insert(d, d->len);
+    d->len = new_len;
     
     return CROUS_OK;
 }
 
+/* Internal function that handles both null-terminated and binary-safe keys */
+static crous_err_t crous_value_dict_set_internal(crous_value *v, const char *key, size_t key_len, crous_value *value) {
+    if (!v || v->type != CROUS_TYPE_DICT || !key)
+        return CROUS_ERR_INVALID_TYPE;
+    
+    /* Replace the value if the key already exists */
+    long pos = dict_find(v, key, key_len);
+    if (pos >= 0) {
+        crous_dict_entry *entry = &v->data.dict.entries[pos];
+        if (entry->value != value) crous_value_free_tree(entry->value);
+        entry->value = value;
+        return CROUS_OK;
+    }
+    
+    if (v->flags & CROUS_VALUE_FLAG_ARENA) return CROUS_ERR_INVALID_TYPE;
+    return dict_append(NULL, v, key, key_len, value, 0);
+}
+
 /* Public API - null-terminated key */
 crous_err_t crous_value_dict_set(crous_value *v, const char *key, crous_value *value) {
     if (!key) return CROUS_ERR_INVALID_TYPE;
@@ -277,45 +641,512 @@ crous_err_t crous_value_dict_set_binary(crous_value *v, const char *key, size_t
     return crous_value_dict_set_internal(v, key, key_len, value);
 }
 
+/* Public API - append without duplicate check (trusted decoder input) */
+crous_err_t crous_value_dict_append_unique(crous_value *v, const char *key, size_t key_len, crous_value *value) {
+    if (!v || v->type != CROUS_TYPE_DICT || !key)
+        return CROUS_ERR_INVALID_TYPE;
+    if (v->flags & CROUS_VALUE_FLAG_ARENA) return CROUS_ERR_INVALID_TYPE;
+    return dict_append(NULL, v, key, key_len, value, 0);
+}
+
+/* Public API - unique append into an arena dict */
+crous_err_t crous_value_dict_append_arena(crous_arena *arena, crous_value *v, const char *key, size_t key_len, crous_value *value) {
+    if (!v || v->type != CROUS_TYPE_DICT || !key)
+        return CROUS_ERR_INVALID_TYPE;
+    if (!arena || !(v->flags & CROUS_VALUE_FLAG_ARENA))
+        return crous_value_dict_append_unique(v, key, key_len, value);
+    return dict_append(arena, v, key, key_len, value, 0);
+}
+
+/* Public API - unique append that keeps a pointer to the caller's key */
+crous_err_t crous_value_dict_append_borrowed(crous_arena *arena, crous_value *v, const char *key, size_t key_len, crous_value *value) {
+    if (!v || v->type != CROUS_TYPE_DICT || !key)
+        return CROUS_ERR_INVALID_TYPE;
+    int in_arena = (v->flags & CROUS_VALUE_FLAG_ARENA) != 0;
+    if (in_arena != (arena != NULL))
+        return CROUS_ERR_INVALID_TYPE;
+    /* A heap dict that already owns its keys can't start borrowing */
+    if (!in_arena && v->data.dict.len > 0 && !(v->flags & CROUS_VALUE_FLAG_BORROWED))
+        return CROUS_ERR_INVALID_TYPE;
+    return dict_append(arena, v, key, key_len, value, 1);
+}
+
 const crous_dict_entry* crous_value_dict_get_entry(const crous_value *v, size_t index) {
     if (!v || v->type != CROUS_TYPE_DICT || index >= v->data.dict.len) return NULL;
     return &v->data.dict.entries[index];
 }
 
 /* ============================================================================
-   MEMORY MANAGEMENT
+   CONTENT HASHING AND COPYING
    ============================================================================ */
 
-void crous_value_free_tree(crous_value *v) {
-    if (!v) return;
-    
+/* Children a walk descends into: list items, dict values, a tagged inner */
+static size_t value_child_count(const crous_value *v) {
+    if (!v) return 0;
+    switch (v->type) {
+        case CROUS_TYPE_LIST:
+        case CROUS_TYPE_TUPLE:
+            return v->data.list.len;
+        case CROUS_TYPE_DICT:
+            return v->data.dict.len;
+        case CROUS_TYPE_TAGGED:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static const crous_value* value_child(const crous_value *v, size_t i) {
+    switch (v->type) {
+        case CROUS_TYPE_LIST:
+        case CROUS_TYPE_TUPLE:
+            return v->data.list.items[i];
+        case CROUS_TYPE_DICT:
+            return v->data.dict.entries[i].value;
+        default:
+            return v->data.tagged.value;
+    }
+}
+
+#define HASH_K1 0x9e3779b97f4a7c15ULL
+#define HASH_K2 0xff51afd7ed558ccdULL
+
+static inline uint64_t hash_word(uint64_t h, uint64_t w) {
+    h ^= w * HASH_K1;
+    h = (h << 27) | (h >> 37);
+    return h * HASH_K2;
+}
+
+/* murmur3 fmix64, so every input bit reaches every output bit */
+static inline uint64_t hash_finish(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/* Length first, then eight bytes at a time read little-endian, so the hash
+ * doesn't depend on the host's byte order */
+static uint64_t hash_bytes(uint64_t h, const uint8_t *p, size_t len) {
+    h = hash_word(h, len);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w = 0;
+        for (int b = 7; b >= 0; b--) w = (w << 8) | p[i + (size_t)b];
+        h = hash_word(h, w);
+    }
+    if (i < len) {
+        uint64_t w = 0;
+        for (size_t b = len; b > i; b--) w = (w << 8) | p[b - 1];
+        h = hash_word(h, w);
+    }
+    return h;
+}
+
+/* A node's type and own payload; children are folded in after it */
+static uint64_t hash_head(const crous_value *v) {
+    crous_type_t type = v ? v->type : CROUS_TYPE_NULL;
+    uint64_t h = hash_word(HASH_K2, (uint64_t)type + 1);
+    if (!v) return h;
+
+    uint64_t w;
     switch (v->type) {
+        case CROUS_TYPE_BOOL:
+            return hash_word(h, v->data.b != 0);
+        case CROUS_TYPE_INT:
+            return hash_word(h, (uint64_t)v->data.i);
+        case CROUS_TYPE_FLOAT:
+            memcpy(&w, &v->data.f, sizeof(w));
+            return hash_word(h, w);
+        case CROUS_TYPE_STRING:
+        case CROUS_TYPE_BYTES:
+            return hash_bytes(h, v->data.bytes.data, v->data.bytes.len);
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY: {
+            /* Elements by value, which is host independent for both types */
+            const uint8_t *p = v->data.array.data;
+            h = hash_word(h, v->data.array.len);
+            for (size_t i = 0; i < v->data.array.len; i++) {
+                memcpy(&w, p + i * 8, sizeof(w));
+                h = hash_word(h, w);
+            }
+            return h;
+        }
+        case CROUS_TYPE_LIST:
+        case CROUS_TYPE_TUPLE:
+        case CROUS_TYPE_DICT:
+            return hash_word(h, value_child_count(v));
+        case CROUS_TYPE_TAGGED:
+            return hash_word(h, v->data.tagged.tag);
+        default:
+            return h;
+    }
+}
+
+typedef struct {
+    const crous_value *v;
+    size_t next;            /* Child to start next */
+    uint64_t h;             /* v's head and the children folded in so far */
+    int height;
+} hash_frame_t;
+
+/*
+ * Post-order: a container's frame stays on the stack while its children
+ * are hashed, and each finished child is folded into it (after its key, for
+ * a dict) before the next one starts.
+ */
+crous_err_t crous_value_hash_subtrees(const crous_value *v, crous_value_hash_visit_fn visit,
+                                      void *user, uint64_t *out_hash) {
+    hash_frame_t local[CROUS_STACK_INLINE], *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+    crous_err_t err = CROUS_OK;
+    uint64_t h = 0;
+    int height = 0;
+
+    for (;;) {
+        /* Start v: scalars finish at once, containers wait for children */
+        if (value_child_count(v) > 0) {
+            if (top == cap) {
+                hash_frame_t *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+                if (!grown) {
+                    err = CROUS_ERR_OOM;
+                    break;
+                }
+                stack = grown;
+            }
+            stack[top++] = (hash_frame_t){ v, 0, hash_head(v), 1 };
+        } else {
+            h = hash_finish(hash_head(v));
+            height = 1;
+            if (visit && v) {
+                err = visit(user, v, h, height);
+                if (err != CROUS_OK) break;
+            }
+            if (top == 0) break;
+            hash_frame_t *f = &stack[top - 1];
+            f->h = hash_word(f->h, h);
+            if (height >= f->height) f->height = height + 1;
+        }
+
+        /* Close finished containers until one has a child left to start */
+        for (;;) {
+            hash_frame_t *f = &stack[top - 1];
+            if (f->next < value_child_count(f->v)) {
+                if (f->v->type == CROUS_TYPE_DICT) {
+                    const crous_dict_entry *entry = &f->v->data.dict.entries[f->next];
+                    f->h = hash_bytes(f->h, (const uint8_t *)entry->key, entry->key_len);
+                }
+                v = value_child(f->v, f->next++);
+                break;
+            }
+            h = hash_finish(f->h);
+            height = f->height;
+            if (visit) {
+                err = visit(user, f->v, h, height);
+                if (err != CROUS_OK) break;
+            }
+            if (--top == 0) break;
+            f = &stack[top - 1];
+            f->h = hash_word(f->h, h);
+            if (height >= f->height) f->height = height + 1;
+        }
+        if (err != CROUS_OK || top == 0) break;
+    }
+
+    crous_stack_release(stack, local);
+    if (err == CROUS_OK && out_hash) *out_hash = h;
+    return err;
+}
+
+crous_err_t crous_value_hash(const crous_value *v, uint64_t *out_hash) {
+    return crous_value_hash_subtrees(v, NULL, NULL, out_hash);
+}
+
+/* Type and own payload, leaving children and dict keys to the walk */
+static int value_head_equal(const crous_value *a, const crous_value *b) {
+    if (!a || !b) return a == b;
+    if (a->type != b->type) return 0;
+    switch (a->type) {
+        case CROUS_TYPE_BOOL:
+            return (a->data.b != 0) == (b->data.b != 0);
+        case CROUS_TYPE_INT:
+            return a->data.i == b->data.i;
+        case CROUS_TYPE_FLOAT:
+            return memcmp(&a->data.f, &b->data.f, sizeof(double)) == 0;
         case CROUS_TYPE_STRING:
-            free(v->data.s.data);
-            break;
         case CROUS_TYPE_BYTES:
-            free(v->data.bytes.data);
+            return a->data.bytes.len == b->data.bytes.len &&
+                   (a->data.bytes.len == 0 ||
+                    memcmp(a->data.bytes.data, b->data.bytes.data, a->data.bytes.len) == 0);
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY:
+            return a->data.array.len == b->data.array.len &&
+                   (a->data.array.len == 0 ||
+                    memcmp(a->data.array.data, b->data.array.data, a->data.array.len * 8) == 0);
+        case CROUS_TYPE_LIST:
+        case CROUS_TYPE_TUPLE:
+        case CROUS_TYPE_DICT:
+            return value_child_count(a) == value_child_count(b);
+        case CROUS_TYPE_TAGGED:
+            return a->data.tagged.tag == b->data.tagged.tag;
+        default:
+            return 1;
+    }
+}
+
+typedef struct {
+    const crous_value *a;
+    const crous_value *b;
+    size_t next;
+} equal_frame_t;
+
+int crous_value_equal(const crous_value *a, const crous_value *b) {
+    equal_frame_t local[CROUS_STACK_INLINE], *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+    int equal = 1;
+
+    if (a == b) return 1;
+    if (!value_head_equal(a, b)) return 0;
+    if (value_child_count(a) > 0) stack[top++] = (equal_frame_t){ a, b, 0 };
+
+    while (top > 0) {
+        equal_frame_t *f = &stack[top - 1];
+        if (f->next == value_child_count(f->a)) {
+            top--;
+            continue;
+        }
+        size_t i = f->next++;
+        if (f->a->type == CROUS_TYPE_DICT) {
+            const crous_dict_entry *ea = &f->a->data.dict.entries[i];
+            const crous_dict_entry *eb = &f->b->data.dict.entries[i];
+            if (ea->key_len != eb->key_len ||
+                (ea->key_len > 0 && memcmp(ea->key, eb->key, ea->key_len) != 0)) {
+                equal = 0;
+                break;
+            }
+        }
+        const crous_value *ca = value_child(f->a, i);
+        const crous_value *cb = value_child(f->b, i);
+        if (ca == cb) continue;
+        if (!value_head_equal(ca, cb)) {
+            equal = 0;
             break;
+        }
+        if (value_child_count(ca) == 0) continue;
+        if (top == cap) {
+            equal_frame_t *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+            if (!grown) {
+                equal = -1;
+                break;
+            }
+            stack = grown;
+        }
+        stack[top++] = (equal_frame_t){ ca, cb, 0 };
+    }
+
+    crous_stack_release(stack, local);
+    return equal;
+}
+
+/* A copy of v's node and payload, with containers sized for v's children
+ * but still empty and a tagged inner left NULL */
+static crous_value* clone_head(crous_arena *arena, const crous_value *v) {
+    switch (v->type) {
+        case CROUS_TYPE_NULL:
+            return crous_value_new_null_arena(arena);
+        case CROUS_TYPE_BOOL:
+            return crous_value_new_bool_arena(arena, v->data.b);
+        case CROUS_TYPE_INT:
+            return crous_value_new_int_arena(arena, v->data.i);
+        case CROUS_TYPE_FLOAT:
+            return crous_value_new_float_arena(arena, v->data.f);
+        case CROUS_TYPE_STRING:
+        case CROUS_TYPE_BYTES:
+            return new_buffer(arena, v->type, v->data.bytes.data, v->data.bytes.len);
         case CROUS_TYPE_LIST:
         case CROUS_TYPE_TUPLE:
-            for (size_t i = 0; i < v->data.list.len; i++) {
-                crous_value_free_tree(v->data.list.items[i]);
+            return new_sequence(arena, v->type, v->data.list.len);
+        case CROUS_TYPE_DICT:
+            return crous_value_new_dict_arena(arena, v->data.dict.len);
+        case CROUS_TYPE_TAGGED:
+            return crous_value_new_tagged_arena(arena, v->data.tagged.tag, NULL);
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY:
+            return new_array(arena, v->type, v->data.array.data, v->data.array.len);
+        default:
+            return NULL;
+    }
+}
+
+typedef struct {
+    const crous_value *src;
+    crous_value *dst;
+    size_t next;
+} clone_frame_t;
+
+crous_value* crous_value_clone_arena(crous_arena *arena, const crous_value *v) {
+    clone_frame_t local[CROUS_STACK_INLINE], *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+
+    if (!v) return NULL;
+    crous_value *root = clone_head(arena, v);
+    if (!root) return NULL;
+    if (value_child_count(v) > 0) stack[top++] = (clone_frame_t){ v, root, 0 };
+
+    while (top > 0) {
+        clone_frame_t *f = &stack[top - 1];
+        if (f->next == value_child_count(f->src)) {
+            top--;
+            continue;
+        }
+        size_t i = f->next++;
+        const crous_value *child = value_child(f->src, i);
+        crous_value *copy = NULL;
+        if (child) {
+            copy = clone_head(arena, child);
+            if (!copy) goto fail;
+        }
+
+        crous_err_t err = CROUS_OK;
+        switch (f->src->type) {
+            case CROUS_TYPE_LIST:
+            case CROUS_TYPE_TUPLE:
+                err = crous_value_list_append(f->dst, copy);
+                break;
+            case CROUS_TYPE_DICT: {
+                const crous_dict_entry *entry = &f->src->data.dict.entries[i];
+                err = crous_value_dict_append_arena(arena, f->dst, entry->key, entry->key_len, copy);
+                break;
             }
+            default:
+                f->dst->data.tagged.value = copy;
+                break;
+        }
+        if (err != CROUS_OK) {
+            crous_value_free_tree(copy);
+            goto fail;
+        }
+
+        if (value_child_count(child) == 0) continue;
+        if (top == cap) {
+            clone_frame_t *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+            if (!grown) goto fail;
+            stack = grown;
+        }
+        stack[top++] = (clone_frame_t){ child, copy, 0 };
+    }
+
+    crous_stack_release(stack, local);
+    return root;
+
+fail:
+    crous_stack_release(stack, local);
+    crous_value_free_tree(root);
+    return NULL;
+}
+
+crous_value* crous_value_clone(const crous_value *v) {
+    return crous_value_clone_arena(NULL, v);
+}
+
+/* ============================================================================
+   MEMORY MANAGEMENT
+   ============================================================================ */
+
+/* A node's own allocations and the node itself, children already freed */
+static void value_free_node(crous_value *v) {
+    switch (v->type) {
+        case CROUS_TYPE_STRING:
+        case CROUS_TYPE_BYTES:
+            if (!(v->flags & (CROUS_VALUE_FLAG_BORROWED | CROUS_VALUE_FLAG_INLINE))) free(v->data.bytes.data);
+            break;
+        case CROUS_TYPE_LIST:
+        case CROUS_TYPE_TUPLE:
             free(v->data.list.items);
             break;
         case CROUS_TYPE_DICT:
-            for (size_t i = 0; i < v->data.dict.len; i++) {
-                free(v->data.dict.entries[i].key);
-                crous_value_free_tree(v->data.dict.entries[i].value);
-            }
             free(v->data.dict.entries);
+            free(v->data.dict.index);
             break;
-        case CROUS_TYPE_TAGGED:
-            crous_value_free_tree(v->data.tagged.value);
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY:
+            if (!(v->flags & CROUS_VALUE_FLAG_BORROWED)) free(v->data.array.data);
             break;
         default:
             break;
     }
     
-    free(v);
+    value_release(v);
+}
+
+/*
+ * Depth-first, without recursion or allocation: a container gives up its
+ * children last to first, and the slot each one vacates keeps the pointer
+ * back to the container's parent until the walk returns to it. Freeing
+ * can't fail however deep the tree.
+ */
+void crous_value_free_tree(crous_value *v) {
+    crous_value *up = NULL;     /* Parent of v */
+    int returning = 0;          /* Back at v from one of its children */
+    
+    while (v) {
+        if (!(v->flags & CROUS_VALUE_FLAG_ARENA)) {
+            crous_value *child = NULL;
+            int popped = 0;
+            
+            switch (v->type) {
+                case CROUS_TYPE_LIST:
+                case CROUS_TYPE_TUPLE:
+                    if (returning) up = v->data.list.items[v->data.list.len];
+                    if (v->data.list.len > 0) {
+                        size_t i = --v->data.list.len;
+                        child = v->data.list.items[i];
+                        v->data.list.items[i] = up;
+                        popped = 1;
+                    }
+                    break;
+                case CROUS_TYPE_DICT:
+                    if (returning) up = v->data.dict.entries[v->data.dict.len].value;
+                    if (v->data.dict.len > 0) {
+                        crous_dict_entry *entry = &v->data.dict.entries[--v->data.dict.len];
+                        if (!(v->flags & CROUS_VALUE_FLAG_BORROWED)) free(entry->key);
+                        child = entry->value;
+                        entry->value = up;
+                        popped = 1;
+                    }
+                    break;
+                case CROUS_TYPE_TAGGED:
+                    if (returning) {
+                        up = v->data.tagged.value;
+                    } else {
+                        child = v->data.tagged.value;
+                        v->data.tagged.value = up;
+                        popped = 1;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            
+            if (popped) {
+                if (child) {
+                    up = v;
+                    v = child;
+                    returning = 0;
+                } else {
+                    /* A NULL slot: nothing to descend into, carry on with v */
+                    returning = 1;
+                }
+                continue;
+            }
+        }
+        
+        /* Nothing left below v: free it and return to its parent */
+        crous_value *parent = up;
+        if (!(v->flags & CROUS_VALUE_FLAG_ARENA)) value_free_node(v);
+        v = parent;
+        returning = 1;
+    }
 }
@@ -132,11 +132,11 @@ crous_compat_t crous_check_compatibility(
     
     /* Check feature flags */
     if (header.feature_flags != 0) {
-        uint32_t unsupported = header.feature_flags & ~CROUS_FEATURES_SUPPORTED;
+        uint32_t required_mask = 0x8000;  /* Top bit indicates required */
+        uint32_t unsupported = header.feature_flags & ~required_mask & ~CROUS_FEATURES_SUPPORTED;
         if (unsupported != 0) {
             /* Check if unsupported features are required */
-            uint32_t required_mask = 0x8000;  /* Top bit indicates required */
-            if (unsupported & required_mask) {
+            if (header.feature_flags & required_mask) {
                 return CROUS_COMPAT_ERR_FEATURES;
             }
             return CROUS_COMPAT_WARN_FEATURES;
@@ -240,28 +240,23 @@ int crous_version_compare(const char *v1, const char *v2) {
 
 #define MAX_MIGRATIONS 32
 
+/* Bytes a header-only stream migration copies through at a time */
+#define MIGRATE_STREAM_CHUNK 16384
+
 typedef struct {
     uint8_t from_version;
     uint8_t to_version;
-    crous_migration_fn fn;
+    crous_migration_fn fn;      /* NULL for a header-only hop */
 } migration_entry_t;
 
 static migration_entry_t migrations[MAX_MIGRATIONS];
 static int migration_count = 0;
 
-int crous_register_migration(
-    uint8_t from_version,
-    uint8_t to_version,
-    crous_migration_fn fn) {
-    
+static int add_migration(uint8_t from_version, uint8_t to_version, crous_migration_fn fn) {
     if (migration_count >= MAX_MIGRATIONS) {
         return CROUS_ERR_INTERNAL;
     }
     
-    if (!fn) {
-        return CROUS_ERR_INVALID_TYPE;
-    }
-    
     migrations[migration_count].from_version = from_version;
     migrations[migration_count].to_version = to_version;
     migrations[migration_count].fn = fn;
@@ -270,21 +265,76 @@ int crous_register_migration(
     return CROUS_OK;
 }
 
+int crous_register_migration(
+    uint8_t from_version,
+    uint8_t to_version,
+    crous_migration_fn fn) {
+    
+    if (!fn) {
+        return CROUS_ERR_INVALID_TYPE;
+    }
+    
+    return add_migration(from_version, to_version, fn);
+}
+
+int crous_register_header_migration(
+    uint8_t from_version,
+    uint8_t to_version) {
+    
+    return add_migration(from_version, to_version, NULL);
+}
+
 /**
  * Find migration path from one version to another.
  * Uses simple linear search for direct migrations.
  * For production, could implement Dijkstra for optimal paths.
  */
-static crous_migration_fn find_migration(uint8_t from, uint8_t to) {
+static const migration_entry_t *find_migration(uint8_t from, uint8_t to) {
     for (int i = 0; i < migration_count; i++) {
         if (migrations[i].from_version == from && 
             migrations[i].to_version == to) {
-            return migrations[i].fn;
+            return &migrations[i];
         }
     }
     return NULL;
 }
 
+/**
+ * Fill hops with the path from one version to another: the direct
+ * migration if there is one, otherwise one hop per version upwards.
+ * Returns the hop count (0 for the same version), or -1 if there is no
+ * path. Every hop is a distinct registry entry, so hops needs room for
+ * MAX_MIGRATIONS.
+ */
+static int plan_migration(uint8_t from, uint8_t to, const migration_entry_t **hops) {
+    if (from == to) return 0;
+    
+    const migration_entry_t *direct = find_migration(from, to);
+    if (direct) {
+        hops[0] = direct;
+        return 1;
+    }
+    
+    /* Downgrades are generally not supported as they may lose data */
+    if (from > to || to - from > MAX_MIGRATIONS) return -1;
+    
+    int count = 0;
+    for (uint8_t v = from; v < to; v++) {
+        hops[count] = find_migration(v, v + 1);
+        if (!hops[count]) return -1;
+        count++;
+    }
+    return count;
+}
+
+/* Whether every hop of a path only rewrites the version byte */
+static int path_is_header_only(const migration_entry_t *const *hops, int count) {
+    for (int i = 0; i < count; i++) {
+        if (hops[i]->fn) return 0;
+    }
+    return 1;
+}
+
 int crous_migrate(
     const uint8_t *data,
     size_t size,
@@ -296,102 +346,170 @@ int crous_migrate(
         return CROUS_ERR_INVALID_TYPE;
     }
     
-    /* Get current version from header */
-    uint8_t current_version = data[4];
+    const migration_entry_t *hops[MAX_MIGRATIONS];
+    int count = plan_migration(data[4], target_version, hops);
+    if (count < 0) {
+        return CROUS_ERR_INTERNAL;  /* No migration path */
+    }
+    
+    /*
+     * The first hop reads the input itself. After that each hop replaces
+     * the buffer the previous one made, and runs of header-only hops patch
+     * the current copy, so an all-header path copies the input once.
+     */
+    const uint8_t *current = data;
+    uint8_t *owned = NULL;
+    size_t current_size = size;
+    
+    for (int i = 0; i < count; i++) {
+        if (!hops[i]->fn) {
+            if (!owned) {
+                owned = malloc(current_size);
+                if (!owned) return CROUS_ERR_OOM;
+                memcpy(owned, current, current_size);
+                current = owned;
+            }
+            owned[4] = hops[i]->to_version;
+            continue;
+        }
+        
+        uint8_t *new_data = NULL;
+        size_t new_size = 0;
+        int err = hops[i]->fn(hops[i]->from_version, hops[i]->to_version,
+                              current, current_size, &new_data, &new_size);
+        free(owned);
+        
+        if (err != CROUS_OK) {
+            return err;
+        }
+        if (!new_data || new_size < 6) {
+            free(new_data);
+            return CROUS_ERR_INTERNAL;
+        }
+        
+        owned = new_data;
+        current = owned;
+        current_size = new_size;
+    }
     
     /* No migration needed */
-    if (current_version == target_version) {
-        uint8_t *copy = malloc(size);
-        if (!copy) return CROUS_ERR_OOM;
-        memcpy(copy, data, size);
-        *out_data = copy;
-        *out_size = size;
-        return CROUS_OK;
+    if (!owned) {
+        owned = malloc(size);
+        if (!owned) return CROUS_ERR_OOM;
+        memcpy(owned, data, size);
     }
     
-    /* Find direct migration */
-    crous_migration_fn migrate_fn = find_migration(current_version, target_version);
+    *out_data = owned;
+    *out_size = current_size;
+    return CROUS_OK;
+}
+
+int crous_migrate_in_place(
+    uint8_t *data,
+    size_t size,
+    uint8_t target_version) {
     
-    if (migrate_fn) {
-        return migrate_fn(current_version, target_version, 
-                         data, size, out_data, out_size);
+    if (!data || size < 6) {
+        return CROUS_ERR_INVALID_TYPE;
     }
     
-    /* Try multi-step migration (incremental versions) */
-    if (current_version < target_version) {
-        /* Upgrade path */
-        uint8_t *current_data = malloc(size);
-        if (!current_data) return CROUS_ERR_OOM;
-        memcpy(current_data, data, size);
-        size_t current_size = size;
-        
-        for (uint8_t v = current_version; v < target_version; v++) {
-            migrate_fn = find_migration(v, v + 1);
-            if (!migrate_fn) {
-                free(current_data);
-                return CROUS_ERR_INTERNAL;  /* No migration path */
-            }
-            
-            uint8_t *new_data = NULL;
-            size_t new_size = 0;
-            int err = migrate_fn(v, v + 1, current_data, current_size,
-                                 &new_data, &new_size);
-            free(current_data);
-            
-            if (err != CROUS_OK) {
-                return err;
-            }
-            
-            current_data = new_data;
-            current_size = new_size;
-        }
-        
-        *out_data = current_data;
-        *out_size = current_size;
-        return CROUS_OK;
-    }
+    const migration_entry_t *hops[MAX_MIGRATIONS];
+    int count = plan_migration(data[4], target_version, hops);
+    if (count < 0) return CROUS_ERR_INTERNAL;
+    if (!path_is_header_only(hops, count)) return CROUS_ERR_NOT_FOUND;
     
-    /* Downgrade path (from target to current, going backwards) */
-    /* Note: Downgrades are generally not supported as they may lose data */
-    return CROUS_ERR_INTERNAL;
+    data[4] = target_version;
+    return CROUS_OK;
 }
 
-/* ============================================================================
-   BUILT-IN MIGRATIONS
-   ============================================================================ */
+/* Read up to len bytes, looping over short reads; stops early only at EOF */
+static size_t read_full(crous_input_stream *in, uint8_t *buf, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        size_t n = in->read(in->user_data, buf + got, len - got);
+        if (n == 0) break;
+        got += n;
+    }
+    return got;
+}
 
-/**
- * Migration from wire v1 to v2.
- * v1 and v2 are largely compatible, just update version byte.
- */
-static int migrate_v1_to_v2(
-    uint8_t old_version,
-    uint8_t new_version,
-    const uint8_t *data,
-    size_t size,
-    uint8_t **out_data,
-    size_t *out_size) {
+static int write_full(crous_output_stream *out, const uint8_t *buf, size_t len) {
+    return len == 0 || out->write(out->user_data, buf, len) == len ? CROUS_OK : CROUS_ERR_STREAM;
+}
+
+int crous_migrate_stream(
+    crous_input_stream *in,
+    crous_output_stream *out,
+    uint8_t target_version) {
     
-    (void)old_version;
-    (void)new_version;
+    if (!in || !in->read || !out || !out->write) {
+        return CROUS_ERR_INVALID_TYPE;
+    }
     
-    uint8_t *output = malloc(size);
-    if (!output) return CROUS_ERR_OOM;
+    uint8_t chunk[MIGRATE_STREAM_CHUNK];
+    size_t n = read_full(in, chunk, sizeof(chunk));
+    if (n < 6) {
+        return CROUS_ERR_INVALID_TYPE;
+    }
     
-    memcpy(output, data, size);
-    output[4] = 2;  /* Update version byte */
+    const migration_entry_t *hops[MAX_MIGRATIONS];
+    int count = plan_migration(chunk[4], target_version, hops);
+    if (count < 0) return CROUS_ERR_INTERNAL;
     
-    *out_data = output;
-    *out_size = size;
-    return CROUS_OK;
+    if (path_is_header_only(hops, count)) {
+        chunk[4] = target_version;
+        while (n > 0) {
+            int err = write_full(out, chunk, n);
+            if (err != CROUS_OK) return err;
+            n = read_full(in, chunk, sizeof(chunk));
+        }
+        return CROUS_OK;
+    }
+    
+    /* Body-rewriting hops take the whole document */
+    size_t cap = sizeof(chunk) * 2, size = n;
+    uint8_t *doc = malloc(cap);
+    if (!doc) return CROUS_ERR_OOM;
+    memcpy(doc, chunk, n);
+    for (;;) {
+        if (size == cap) {
+            uint8_t *grown = cap * 2 > cap ? realloc(doc, cap * 2) : NULL;
+            if (!grown) {
+                free(doc);
+                return CROUS_ERR_OOM;
+            }
+            doc = grown;
+            cap *= 2;
+        }
+        n = read_full(in, doc + size, cap - size);
+        if (n == 0) break;
+        size += n;
+    }
+    
+    uint8_t *migrated = NULL;
+    size_t migrated_size = 0;
+    int err = crous_migrate(doc, size, target_version, &migrated, &migrated_size);
+    free(doc);
+    if (err != CROUS_OK) return err;
+    
+    err = write_full(out, migrated, migrated_size);
+    free(migrated);
+    return err;
 }
 
+/* ============================================================================
+   BUILT-IN MIGRATIONS
+   ============================================================================ */
+
 /**
  * Initialize built-in migrations.
- * Called automatically during module init.
+ * v1 and v2 are largely compatible: the hop only updates the version byte.
  */
 void crous_init_migrations(void) {
-    crous_register_migration(1, 2, migrate_v1_to_v2);
+    static int initialized = 0;
+    if (initialized) return;
+    initialized = 1;
+    crous_register_header_migration(1, 2);
 }
 
 /* ============================================================================
@@ -0,0 +1,235 @@
+#include "../include/crous_visitor.h"
+#include "../include/crous_value.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+   TREE WALK
+   ============================================================================ */
+
+static crous_err_t visit_node(const crous_value *v, const crous_visitor *vis, void *ctx, int depth) {
+    if (depth > CROUS_MAX_DEPTH) return CROUS_ERR_DEPTH_EXCEEDED;
+    crous_err_t err = CROUS_OK;
+
+    switch (v->type) {
+    case CROUS_TYPE_NULL:
+    case CROUS_TYPE_BOOL:
+    case CROUS_TYPE_INT:
+    case CROUS_TYPE_FLOAT:
+    case CROUS_TYPE_STRING:
+    case CROUS_TYPE_BYTES:
+        return crous_visit_scalar(vis, ctx, v);
+
+    case CROUS_TYPE_TAGGED:
+        err = crous_visit_tag(vis, ctx, v->data.tagged.tag);
+        if (err != CROUS_OK) return err;
+        if (!v->data.tagged.value) return CROUS_ERR_INVALID_TYPE;
+        return visit_node(v->data.tagged.value, vis, ctx, depth + 1);
+
+    case CROUS_TYPE_LIST:
+    case CROUS_TYPE_TUPLE: {
+        size_t n = v->data.list.len;
+        err = crous_visit_begin(vis, ctx, v->type, n);
+        for (size_t i = 0; i < n && err == CROUS_OK; i++)
+            err = visit_node(v->data.list.items[i], vis, ctx, depth + 1);
+        if (err == CROUS_OK) err = crous_visit_end(vis, ctx, v->type, n);
+        return err;
+    }
+
+    case CROUS_TYPE_DICT: {
+        size_t n = v->data.dict.len;
+        err = crous_visit_begin(vis, ctx, CROUS_TYPE_DICT, n);
+        for (size_t i = 0; i < n && err == CROUS_OK; i++) {
+            const crous_dict_entry *ent = &v->data.dict.entries[i];
+            err = crous_visit_key(vis, ctx, ent->key, ent->key_len);
+            if (err == CROUS_OK) err = visit_node(ent->value, vis, ctx, depth + 1);
+        }
+        if (err == CROUS_OK) err = crous_visit_end(vis, ctx, CROUS_TYPE_DICT, n);
+        return err;
+    }
+
+    case CROUS_TYPE_I64_ARRAY:
+    case CROUS_TYPE_F64_ARRAY: {
+        size_t n = v->data.array.len;
+        crous_value elem;
+        elem.flags = CROUS_VALUE_FLAG_BORROWED;
+        elem.type = v->type == CROUS_TYPE_I64_ARRAY ? CROUS_TYPE_INT : CROUS_TYPE_FLOAT;
+        err = crous_visit_begin(vis, ctx, CROUS_TYPE_LIST, n);
+        for (size_t i = 0; i < n && err == CROUS_OK && vis->scalar; i++) {
+            memcpy(&elem.data.i, (const uint8_t *)v->data.array.data + i * 8, 8);
+            err = vis->scalar(ctx, &elem);
+        }
+        if (err == CROUS_OK) err = crous_visit_end(vis, ctx, CROUS_TYPE_LIST, n);
+        return err;
+    }
+
+    default:
+        return CROUS_ERR_INVALID_TYPE;
+    }
+}
+
+crous_err_t crous_visit_value(const crous_value *value, const crous_visitor *visitor, void *ctx) {
+    if (!value || !visitor) return CROUS_ERR_INVALID_TYPE;
+    return visit_node(value, visitor, ctx, 0);
+}
+
+/* ============================================================================
+   TREE BUILDER
+   ============================================================================ */
+
+/*
+ * Every node is linked into its parent as soon as it is created, so the
+ * root always owns the whole partial tree and freeing it on error leaks
+ * nothing. The stack holds open containers and tagged values still
+ * waiting for their inner value.
+ */
+struct crous_builder {
+    crous_value *root;
+    crous_value *open[CROUS_MAX_DEPTH + 2];
+    int depth;
+    char *key;                  /* Pending dict key */
+    size_t key_len;
+    size_t key_cap;
+    int have_key;
+};
+
+crous_err_t crous_builder_new(crous_builder **out_builder) {
+    if (!out_builder) return CROUS_ERR_INVALID_TYPE;
+    crous_builder *b = calloc(1, sizeof(*b));
+    if (!b) return CROUS_ERR_OOM;
+    *out_builder = b;
+    return CROUS_OK;
+}
+
+void crous_builder_free(crous_builder *builder) {
+    if (!builder) return;
+    crous_value_free_tree(builder->root);
+    free(builder->key);
+    free(builder);
+}
+
+/* Link a new node under the innermost open node, closing finished tags */
+static crous_err_t builder_attach(crous_builder *b, crous_value *v) {
+    crous_err_t err = CROUS_OK;
+
+    if (b->depth == 0) {
+        if (b->root) err = CROUS_ERR_DECODE;
+        else b->root = v;
+    } else {
+        crous_value *parent = b->open[b->depth - 1];
+        switch (parent->type) {
+        case CROUS_TYPE_DICT:
+            if (!b->have_key) { err = CROUS_ERR_DECODE; break; }
+            b->have_key = 0;
+            err = crous_value_dict_set_binary(parent, b->key ? b->key : "", b->key_len, v);
+            break;
+        case CROUS_TYPE_TAGGED:
+            parent->data.tagged.value = v;
+            break;
+        default:
+            err = crous_value_list_append(parent, v);
+            break;
+        }
+    }
+    if (err != CROUS_OK) {
+        crous_value_free_tree(v);
+        return err;
+    }
+
+    while (b->depth > 0 && b->open[b->depth - 1]->type == CROUS_TYPE_TAGGED &&
+           b->open[b->depth - 1]->data.tagged.value)
+        b->depth--;
+    return CROUS_OK;
+}
+
+/* Attach an open node and push it */
+static crous_err_t builder_push(crous_builder *b, crous_value *v) {
+    if (!v) return CROUS_ERR_OOM;
+    if (b->depth >= CROUS_MAX_DEPTH + 2) {
+        crous_value_free_tree(v);
+        return CROUS_ERR_DEPTH_EXCEEDED;
+    }
+    crous_err_t err = builder_attach(b, v);
+    if (err == CROUS_OK) b->open[b->depth++] = v;
+    return err;
+}
+
+static crous_err_t builder_scalar(void *ctx, const crous_value *s) {
+    crous_value *v;
+    switch (s->type) {
+    case CROUS_TYPE_NULL:   v = crous_value_new_null(); break;
+    case CROUS_TYPE_BOOL:   v = crous_value_new_bool(s->data.b); break;
+    case CROUS_TYPE_INT:    v = crous_value_new_int(s->data.i); break;
+    case CROUS_TYPE_FLOAT:  v = crous_value_new_float(s->data.f); break;
+    case CROUS_TYPE_STRING: v = crous_value_new_string((const char *)s->data.s.data, s->data.s.len); break;
+    case CROUS_TYPE_BYTES:  v = crous_value_new_bytes(s->data.bytes.data, s->data.bytes.len); break;
+    default:                return CROUS_ERR_INVALID_TYPE;
+    }
+    if (!v) return CROUS_ERR_OOM;
+    return builder_attach((crous_builder *)ctx, v);
+}
+
+static crous_err_t builder_tag(void *ctx, uint32_t tag) {
+    return builder_push((crous_builder *)ctx, crous_value_new_tagged(tag, NULL));
+}
+
+static crous_err_t builder_begin(void *ctx, crous_type_t type, size_t count) {
+    size_t cap = count == CROUS_VISIT_COUNT_UNKNOWN || count > 4096 ? 4 : count;
+    crous_value *v;
+    switch (type) {
+    case CROUS_TYPE_LIST:  v = crous_value_new_list(cap); break;
+    case CROUS_TYPE_TUPLE: v = crous_value_new_tuple(cap); break;
+    case CROUS_TYPE_DICT:  v = crous_value_new_dict(cap); break;
+    default:               return CROUS_ERR_INVALID_TYPE;
+    }
+    return builder_push((crous_builder *)ctx, v);
+}
+
+static crous_err_t builder_key(void *ctx, const char *key, size_t key_len) {
+    crous_builder *b = (crous_builder *)ctx;
+    if (key_len + 1 > b->key_cap) {
+        size_t cap = b->key_cap ? b->key_cap : 64;
+        while (cap < key_len + 1) cap *= 2;
+        char *grown = realloc(b->key, cap);
+        if (!grown) return CROUS_ERR_OOM;
+        b->key = grown;
+        b->key_cap = cap;
+    }
+    memcpy(b->key, key, key_len);
+    b->key[key_len] = '\0';
+    b->key_len = key_len;
+    b->have_key = 1;
+    return CROUS_OK;
+}
+
+static crous_err_t builder_end(void *ctx, crous_type_t type, size_t count) {
+    (void)type; (void)count;
+    crous_builder *b = (crous_builder *)ctx;
+    if (b->depth == 0 || b->open[b->depth - 1]->type == CROUS_TYPE_TAGGED)
+        return CROUS_ERR_DECODE;
+    b->depth--;
+    return CROUS_OK;
+}
+
+static const crous_visitor builder_visitor = {
+    builder_scalar, builder_tag, builder_begin, builder_key, builder_end
+};
+
+const crous_visitor* crous_builder_visitor(void) {
+    return &builder_visitor;
+}
+
+crous_err_t crous_builder_finish(crous_builder *builder, crous_value **out_value) {
+    if (!builder || !out_value) {
+        crous_builder_free(builder);
+        return CROUS_ERR_INVALID_TYPE;
+    }
+    if (!builder->root || builder->depth > 0) {
+        crous_builder_free(builder);
+        return CROUS_ERR_TRUNCATED;
+    }
+    *out_value = builder->root;
+    builder->root = NULL;
+    crous_builder_free(builder);
+    return CROUS_OK;
+}
@@ -25,6 +25,10 @@
 #include "../include/crous_crout.h"
 #include "../include/crous_value.h"
 #include "../include/crous_binary.h"
+#include "../include/crous_flux.h"
+#include "../include/crous_scan.h"
+#include "../include/crous_stats.h"
+#include "../include/crous_stack.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -94,130 +98,353 @@ static void cbuf_free(cbuf_t *b) {
    TOKEN TABLE BUILDER (encoder side)
    ============================================================================ */
 
-#define MAX_TOKEN_ENTRIES 55   /* a-z + A-Z + 0-9 minus reserved prefixes */
+/*
+ * Every distinct key is counted in an open-addressing hash table, so
+ * counting is O(keys) and no key is shut out by the order it first
+ * appears in. The most frequent keys then get tokens from a space of
+ * 1-3 characters:
+ *
+ *   1 char    one of tok_first (54 tokens)
+ *   2 chars   tok_first + tok_rest (54 * 63)
+ *   3 chars   tok_first + tok_rest + tok_rest (54 * 63 * 63)
+ *
+ * The first character skips the value prefixes s, b, i, f, N, T and F so
+ * no token reads as a literal; the rest are any identifier character.
+ */
+
+static const char tok_first[] = "acdeghj"           /* a-z minus b,f,i,s */
+                                "klmnopqruvwxyz"
+                                "ABCDEGHI"          /* A-Z minus F,N,T */
+                                "JKLMOPQRSUVWXYZ"
+                                "0123456789";       /* digits are safe */
+static const char tok_rest[]  = "abcdefghijklmnopqrstuvwxyz"
+                                "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                "0123456789_";
+
+#define TOK_FIRST_COUNT ((int)sizeof(tok_first) - 1)
+#define TOK_REST_COUNT  ((int)sizeof(tok_rest) - 1)
+
+/* FNV-1a, shared by the encoder and reader tables */
+static inline uint32_t crout_hash(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
 
 typedef struct {
-    char  *key;          /* owned copy */
-    size_t key_len;
-    int    count;        /* occurrence count */
-    char   tok[4];       /* short token string (1-3 chars) */
-    int    tok_len;
+    char    *key;        /* owned copy */
+    size_t   key_len;
+    uint32_t hash;
+    int      count;      /* occurrence count */
+    int      first;      /* first-seen order, breaks count ties */
+    char     tok[4];     /* short token string (1-3 chars) */
+    int      tok_len;
 } token_entry_t;
 
 typedef struct {
-    token_entry_t entries[MAX_TOKEN_ENTRIES];
-    int           len;
+    token_entry_t *entries;
+    int            len;
+    int            cap;
+    uint32_t      *slots;     /* entry index + 1, 0 = empty */
+    size_t         slot_mask; /* slot count - 1 (power of two) */
 } token_table_t;
 
-/* Walk the tree and count key occurrences. */
-static void count_keys(const crous_value *v, token_table_t *tt, int max_entries) {
-    if (!v) return;
-    switch (crous_value_get_type(v)) {
-        case CROUS_TYPE_DICT: {
-            size_t n = crous_value_dict_size(v);
-            for (size_t i = 0; i < n; i++) {
-                const crous_dict_entry *e = crous_value_dict_get_entry(v, i);
-                if (!e) continue;
-                /* look up existing */
-                int found = 0;
-                for (int j = 0; j < tt->len; j++) {
-                    if (tt->entries[j].key_len == e->key_len &&
-                        memcmp(tt->entries[j].key, e->key, e->key_len) == 0) {
-                        tt->entries[j].count++;
-                        found = 1;
+static int token_find(const token_table_t *tt, const char *key, size_t key_len,
+                      uint32_t h, size_t *out_slot) {
+    size_t i = h & tt->slot_mask;
+    while (tt->slots[i]) {
+        const token_entry_t *te = &tt->entries[tt->slots[i] - 1];
+        if (te->hash == h && te->key_len == key_len &&
+            memcmp(te->key, key, key_len) == 0) {
+            *out_slot = i;
+            return 1;
+        }
+        i = (i + 1) & tt->slot_mask;
+    }
+    *out_slot = i;
+    return 0;
+}
+
+/* (Re)build the slots for the current entries at nslots (power of two) */
+static crous_err_t token_rehash(token_table_t *tt, size_t nslots) {
+    uint32_t *slots = (uint32_t *)calloc(nslots, sizeof(uint32_t));
+    if (!slots) return CROUS_ERR_OOM;
+    free(tt->slots);
+    tt->slots = slots;
+    tt->slot_mask = nslots - 1;
+    for (int j = 0; j < tt->len; j++) {
+        size_t i = tt->entries[j].hash & tt->slot_mask;
+        while (slots[i]) i = (i + 1) & tt->slot_mask;
+        slots[i] = (uint32_t)j + 1;
+    }
+    return CROUS_OK;
+}
+
+/* Count one occurrence of key */
+static crous_err_t count_key(token_table_t *tt, const char *key, size_t key_len) {
+    if (!tt->slots) {
+        crous_err_t err = token_rehash(tt, 64);
+        if (err != CROUS_OK) return err;
+    }
+    uint32_t h = crout_hash(key, key_len);
+    size_t slot;
+    if (token_find(tt, key, key_len, h, &slot)) {
+        tt->entries[tt->slots[slot] - 1].count++;
+        return CROUS_OK;
+    }
+
+    if (tt->len == tt->cap) {
+        int cap = tt->cap ? tt->cap * 2 : 32;
+        token_entry_t *grown = (token_entry_t *)realloc(tt->entries, (size_t)cap * sizeof(token_entry_t));
+        if (!grown) return CROUS_ERR_OOM;
+        tt->entries = grown;
+        tt->cap = cap;
+    }
+    token_entry_t *te = &tt->entries[tt->len];
+    te->key = (char *)malloc(key_len + 1);
+    if (!te->key) return CROUS_ERR_OOM;
+    memcpy(te->key, key, key_len);
+    te->key[key_len] = '\0';
+    te->key_len = key_len;
+    te->hash    = h;
+    te->count   = 1;
+    te->first   = tt->len;
+    te->tok_len = 0;
+    tt->slots[slot] = (uint32_t)++tt->len;
+
+    /* Keep the load factor at or below one half */
+    if ((size_t)tt->len * 2 > tt->slot_mask + 1)
+        return token_rehash(tt, (tt->slot_mask + 1) * 2);
+    return CROUS_OK;
+}
+
+/* Key counting state. With sampled set, counting stops at the dict after
+ * the first dicts_left dicts in document order. */
+typedef struct {
+    token_table_t *tt;
+    long dicts_left;
+    int  sampled;
+    int  stopped;
+} key_counter_t;
+
+/* Account for one dict; 0 once the sample is used up */
+static inline int key_counter_dict(key_counter_t *kc) {
+    if (kc->sampled && kc->dicts_left-- <= 0) kc->stopped = 1;
+    return !kc->stopped;
+}
+
+/* One open container of the key walk */
+typedef struct {
+    const crous_value *v;
+    size_t next;
+} key_walk_frame_t;
+
+/* Walk the tree and count key occurrences, in document order, on a work
+ * stack rather than the C stack. */
+static crous_err_t count_keys(const crous_value *v, key_counter_t *kc) {
+    key_walk_frame_t local[CROUS_STACK_INLINE];
+    key_walk_frame_t *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+    crous_err_t err = CROUS_OK;
+    
+    for (;;) {
+        while (v && crous_value_get_type(v) == CROUS_TYPE_TAGGED)
+            v = crous_value_get_tagged_inner(v);
+        
+        if (v && !kc->stopped) {
+            crous_type_t type = crous_value_get_type(v);
+            int open = type == CROUS_TYPE_LIST || type == CROUS_TYPE_TUPLE ||
+                       (type == CROUS_TYPE_DICT && key_counter_dict(kc));
+            if (open) {
+                if (top == cap) {
+                    key_walk_frame_t *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+                    if (!grown) {
+                        err = CROUS_ERR_OOM;
                         break;
                     }
+                    stack = grown;
                 }
-                if (!found && tt->len < max_entries) {
-                    token_entry_t *te = &tt->entries[tt->len];
-                    te->key = (char *)malloc(e->key_len + 1);
-                    if (te->key) {
-                        memcpy(te->key, e->key, e->key_len);
-                        te->key[e->key_len] = '\0';
-                        te->key_len = e->key_len;
-                        te->count   = 1;
-                        te->tok_len = 0;
-                        tt->len++;
-                    }
-                }
-                /* recurse into value */
-                count_keys(e->value, tt, max_entries);
+                stack[top].v = v;
+                stack[top].next = 0;
+                top++;
             }
-            break;
         }
-        case CROUS_TYPE_LIST:
-        case CROUS_TYPE_TUPLE: {
-            size_t n = crous_value_list_size(v);
-            for (size_t i = 0; i < n; i++)
-                count_keys(crous_value_list_get(v, i), tt, max_entries);
-            break;
+        
+        /* Next: the first unvisited item of the innermost container */
+        v = NULL;
+        while (top > 0 && !kc->stopped) {
+            key_walk_frame_t *f = &stack[top - 1];
+            if (crous_value_get_type(f->v) == CROUS_TYPE_DICT) {
+                if (f->next < crous_value_dict_size(f->v)) {
+                    const crous_dict_entry *e = crous_value_dict_get_entry(f->v, f->next++);
+                    if (!e) continue;
+                    err = count_key(kc->tt, e->key, e->key_len);
+                    v = e->value;
+                    break;
+                }
+            } else if (f->next < crous_value_list_size(f->v)) {
+                v = crous_value_list_get(f->v, f->next++);
+                break;
+            }
+            top--;
         }
-        case CROUS_TYPE_TAGGED:
-            count_keys((crous_value *)crous_value_get_tagged_inner(v), tt, max_entries);
-            break;
-        default:
-            break;
+        if (top == 0 || kc->stopped || err != CROUS_OK) break;
     }
+    
+    crous_stack_release(stack, local);
+    return err;
 }
 
-/* Assign single-char tokens: a-z, A-Z, 0-9 */
-static void assign_tokens(token_table_t *tt, int threshold) {
-    /* Sort by count descending (simple selection sort — at most 62 items) */
-    for (int i = 0; i < tt->len - 1; i++) {
-        int best = i;
-        for (int j = i + 1; j < tt->len; j++) {
-            if (tt->entries[j].count > tt->entries[best].count)
-                best = j;
-        }
-        if (best != i) {
-            token_entry_t tmp = tt->entries[i];
-            tt->entries[i] = tt->entries[best];
-            tt->entries[best] = tmp;
-        }
+static int token_entry_cmp(const void *pa, const void *pb) {
+    const token_entry_t *a = (const token_entry_t *)pa;
+    const token_entry_t *b = (const token_entry_t *)pb;
+    if (a->count != b->count) return a->count > b->count ? -1 : 1;
+    return a->first < b->first ? -1 : (a->first > b->first);
+}
+
+/* Write the n-th token of the token space into tok; returns its length */
+static int token_for_index(int n, char tok[4]) {
+    int len;
+    if (n < TOK_FIRST_COUNT) {
+        tok[0] = tok_first[n];
+        len = 1;
+    } else if ((n -= TOK_FIRST_COUNT) < TOK_FIRST_COUNT * TOK_REST_COUNT) {
+        tok[0] = tok_first[n / TOK_REST_COUNT];
+        tok[1] = tok_rest[n % TOK_REST_COUNT];
+        len = 2;
+    } else {
+        n -= TOK_FIRST_COUNT * TOK_REST_COUNT;
+        tok[0] = tok_first[n / (TOK_REST_COUNT * TOK_REST_COUNT)];
+        tok[1] = tok_rest[(n / TOK_REST_COUNT) % TOK_REST_COUNT];
+        tok[2] = tok_rest[n % TOK_REST_COUNT];
+        len = 3;
     }
+    tok[len] = '\0';
+    return len;
+}
+
+/* Bytes saved by writing tok_len-char tokens for key instead of
+ * s<len>:<key> literals, net of its "@ tok=key\n" header line */
+static long long token_saving(const token_entry_t *te, int tok_len) {
+    int digits = 1;
+    for (size_t n = te->key_len; n >= 10; n /= 10) digits++;
+    long long literal = 2 + digits + (long long)te->key_len;
+    long long header  = 4 + tok_len + (long long)te->key_len;
+    return (long long)te->count * (literal - tok_len) - header;
+}
+
+/* Keep the most frequent keys that reach threshold, at most max_tokens,
+ * and give them tokens in order. Single-char tokens go to every key that
+ * reaches threshold; longer ones only where they pay for their header. */
+static crous_err_t assign_tokens(token_table_t *tt, int threshold, int max_tokens) {
+    if (tt->len == 0) return CROUS_OK;
+    if (max_tokens > CROUT_MAX_TOKENS) max_tokens = CROUT_MAX_TOKENS;
+    qsort(tt->entries, (size_t)tt->len, sizeof(token_entry_t), token_entry_cmp);
 
-    /* Assign letters a-z, A-Z, 0-9, skipping chars that clash with
-     * CROUT value prefixes: s(string), b(bytes), i(int), f(float),
-     * N(null), T(true), F(false) */
-    static const char syms[] = "acdeghj"           /* a-z minus b,f,i,s */
-                                "klmnopqruvwxyz"
-                                "ABCDEGHI"          /* A-Z minus F,N,T */
-                                "JKLMOPQRSUVWXYZ"
-                                "0123456789";       /* digits are safe */
-    int sym_idx = 0;
-    int num_syms = (int)strlen(syms);
     int kept = 0;
-    for (int i = 0; i < tt->len && sym_idx < num_syms; i++) {
-        if (tt->entries[i].count < threshold) continue;
-        tt->entries[kept] = tt->entries[i];
-        tt->entries[kept].tok[0] = syms[sym_idx++];
-        tt->entries[kept].tok[1] = '\0';
-        tt->entries[kept].tok_len = 1;
-        kept++;
-    }
-    /* Free discarded entries */
-    for (int i = kept; i < tt->len; i++) {
-        free(tt->entries[i].key);
-        tt->entries[i].key = NULL;
+    for (int i = 0; i < tt->len; i++) {
+        token_entry_t *te = &tt->entries[i];
+        int keep = 0;
+        if (kept < max_tokens && te->count >= threshold) {
+            char tok[4];
+            int tok_len = token_for_index(kept, tok);
+            if (tok_len == 1 || token_saving(te, tok_len) > 0) {
+                memcpy(te->tok, tok, sizeof(tok));
+                te->tok_len = tok_len;
+                keep = 1;
+            }
+        }
+        if (keep) {
+            tt->entries[kept++] = *te;
+        } else {
+            free(te->key);
+            te->key = NULL;
+        }
     }
     tt->len = kept;
+    return token_rehash(tt, tt->slot_mask + 1);
 }
 
 static void token_table_free(token_table_t *tt) {
     for (int i = 0; i < tt->len; i++) {
         free(tt->entries[i].key);
     }
-    tt->len = 0;
+    free(tt->entries);
+    free(tt->slots);
+    memset(tt, 0, sizeof(*tt));
 }
 
 /* Look up key in token table; return token string or NULL */
 static const char* token_lookup(const token_table_t *tt, const char *key, size_t key_len) {
-    for (int i = 0; i < tt->len; i++) {
-        if (tt->entries[i].key_len == key_len &&
-            memcmp(tt->entries[i].key, key, key_len) == 0)
-            return tt->entries[i].tok;
-    }
-    return NULL;
+    if (tt->len == 0) return NULL;
+    size_t slot;
+    if (!token_find(tt, key, key_len, crout_hash(key, key_len), &slot)) return NULL;
+    return tt->entries[tt->slots[slot] - 1].tok;
+}
+
+/* Count value's keys under opts and assign tokens into tt */
+static crous_err_t build_token_table(const crous_value *value, const crout_options_t *opts,
+                                     token_table_t *tt) {
+    key_counter_t kc = { tt, opts->token_sample, opts->token_sample > 0, 0 };
+    crous_err_t err = count_keys(value, &kc);
+    if (err == CROUS_OK) err = assign_tokens(tt, opts->token_threshold, opts->max_tokens);
+    return err;
+}
+
+/* ============================================================================
+   PERSISTENT TOKEN TABLES
+   ============================================================================ */
+
+struct crout_tokens {
+    token_table_t tt;
+};
+
+crous_err_t crout_tokens_new(crout_tokens_t **out_tokens) {
+    if (!out_tokens) return CROUS_ERR_INVALID_TYPE;
+    crout_tokens_t *t = (crout_tokens_t *)calloc(1, sizeof(*t));
+    if (!t) return CROUS_ERR_OOM;
+    *out_tokens = t;
+    return CROUS_OK;
+}
+
+crous_err_t crout_tokens_add(crout_tokens_t *tokens, const char *key, size_t key_len) {
+    if (!tokens || (!key && key_len)) return CROUS_ERR_INVALID_TYPE;
+    token_table_t *tt = &tokens->tt;
+    if (token_lookup(tt, key ? key : "", key_len)) return CROUS_OK;
+    if (tt->len >= CROUT_MAX_TOKENS) return CROUS_ERR_OVERFLOW;
+
+    crous_err_t err = count_key(tt, key ? key : "", key_len);
+    if (err != CROUS_OK) return err;
+    token_entry_t *te = &tt->entries[tt->len - 1];
+    te->tok_len = token_for_index(tt->len - 1, te->tok);
+    return CROUS_OK;
+}
+
+crous_err_t crout_tokens_learn(crout_tokens_t *tokens, const crous_value *sample,
+                               const crout_options_t *opts_in) {
+    if (!tokens || !sample) return CROUS_ERR_INVALID_TYPE;
+    crout_options_t opts = opts_in ? *opts_in : crout_options_default();
+
+    token_table_t tt;
+    memset(&tt, 0, sizeof(tt));
+    crous_err_t err = build_token_table(sample, &opts, &tt);
+    for (int i = 0; i < tt.len && err == CROUS_OK; i++)
+        err = crout_tokens_add(tokens, tt.entries[i].key, tt.entries[i].key_len);
+    token_table_free(&tt);
+    return err;
+}
+
+size_t crout_tokens_count(const crout_tokens_t *tokens) {
+    return tokens ? (size_t)tokens->tt.len : 0;
+}
+
+void crout_tokens_free(crout_tokens_t *tokens) {
+    if (!tokens) return;
+    token_table_free(&tokens->tt);
+    free(tokens);
 }
 
 /* ============================================================================
@@ -261,6 +488,46 @@ static crous_err_t encode_bytes_value(cbuf_t *b, const uint8_t *data, size_t len
     return CROUS_OK;
 }
 
+static crous_err_t encode_float(cbuf_t *b, double d) {
+    char tmp[64];
+    int n;
+    if (isinf(d) || isnan(d)) {
+        if (isnan(d))       n = snprintf(tmp, sizeof(tmp), "fnan");
+        else if (d > 0)     n = snprintf(tmp, sizeof(tmp), "finf");
+        else                n = snprintf(tmp, sizeof(tmp), "f-inf");
+    } else {
+        n = snprintf(tmp, sizeof(tmp), "f%.17g", d);
+    }
+    return cbuf_append(b, tmp, (size_t)n);
+}
+
+/* Packed arrays have no CROUT syntax of their own: write a plain list */
+static crous_err_t encode_packed(cbuf_t *b, const crous_value *v, int pretty, int indent, int depth) {
+    const crous_array_t *a = &v->data.array;
+    crous_err_t e = cbuf_appendc(b, '['); if (e) return e;
+    for (size_t i = 0; i < a->len; i++) {
+        if (i > 0) {
+            e = cbuf_append(b, " , ", 3); if (e) return e;
+        }
+        if (pretty) {
+            e = cbuf_appendc(b, '\n'); if (e) return e;
+            e = write_indent(b, indent, depth + 1); if (e) return e;
+        }
+        if (v->type == CROUS_TYPE_I64_ARRAY) {
+            e = cbuf_appendc(b, 'i'); if (e) return e;
+            e = cbuf_append_decimal(b, ((const int64_t *)a->data)[i]);
+        } else {
+            e = encode_float(b, ((const double *)a->data)[i]);
+        }
+        if (e) return e;
+    }
+    if (pretty && a->len > 0) {
+        e = cbuf_appendc(b, '\n'); if (e) return e;
+        e = write_indent(b, indent, depth); if (e) return e;
+    }
+    return cbuf_appendc(b, ']');
+}
+
 static crous_err_t encode_key(cbuf_t *b, const char *key, size_t key_len,
                               const token_table_t *tt) {
     const char *tok = token_lookup(tt, key, key_len);
@@ -290,19 +557,8 @@ static crous_err_t encode_value(cbuf_t *b, const crous_value *v,
         return cbuf_append_decimal(b, crous_value_get_int(v));
     }
 
-    case CROUS_TYPE_FLOAT: {
-        double d = crous_value_get_float(v);
-        char tmp[64];
-        int n;
-        if (isinf(d) || isnan(d)) {
-            if (isnan(d))       n = snprintf(tmp, sizeof(tmp), "fnan");
-            else if (d > 0)     n = snprintf(tmp, sizeof(tmp), "finf");
-            else                n = snprintf(tmp, sizeof(tmp), "f-inf");
-        } else {
-            n = snprintf(tmp, sizeof(tmp), "f%.17g", d);
-        }
-        return cbuf_append(b, tmp, (size_t)n);
-    }
+    case CROUS_TYPE_FLOAT:
+        return encode_float(b, crous_value_get_float(v));
 
     case CROUS_TYPE_STRING: {
         size_t len;
@@ -392,12 +648,30 @@ static crous_err_t encode_value(cbuf_t *b, const crous_value *v,
         return encode_value(b, (crous_value *)inner, tt, pretty, indent, depth);
     }
 
+    case CROUS_TYPE_I64_ARRAY:
+    case CROUS_TYPE_F64_ARRAY:
+        return encode_packed(b, v, pretty, indent, depth);
+
     default:
         return CROUS_ERR_INVALID_TYPE;
     }
 }
 
-crous_err_t crout_encode(
+/* Magic line, then one "@ tok=key" line per token */
+static crous_err_t encode_header(cbuf_t *b, const token_table_t *tt) {
+    crous_err_t e = cbuf_append(b, CROUT_MAGIC "\n", CROUT_MAGIC_LEN + 1);
+    if (e) return e;
+    for (int i = 0; i < tt->len; i++) {
+        e = cbuf_append(b, "@ ", 2);                                    if (e) return e;
+        e = cbuf_append(b, tt->entries[i].tok, (size_t)tt->entries[i].tok_len); if (e) return e;
+        e = cbuf_appendc(b, '=');                                       if (e) return e;
+        e = cbuf_append(b, tt->entries[i].key, tt->entries[i].key_len); if (e) return e;
+        e = cbuf_appendc(b, '\n');                                      if (e) return e;
+    }
+    return CROUS_OK;
+}
+
+static crous_err_t encode_document(
     const crous_value *value,
     const crout_options_t *opts_in,
     char **out_buf,
@@ -407,36 +681,27 @@ crous_err_t crout_encode(
 
     crout_options_t opts = opts_in ? *opts_in : crout_options_default();
 
-    /* Build token table if requested */
+    /* Build token table if requested, unless the caller brought one */
     token_table_t tt;
     memset(&tt, 0, sizeof(tt));
-    if (opts.use_tokens) {
-        int max_tok = opts.max_tokens;
-        if (max_tok > MAX_TOKEN_ENTRIES) max_tok = MAX_TOKEN_ENTRIES;
-        count_keys(value, &tt, max_tok);
-        assign_tokens(&tt, opts.token_threshold);
+    const token_table_t *use_tt = &tt;
+    crous_err_t e = CROUS_OK;
+    if (opts.use_tokens && opts.tokens) {
+        use_tt = &opts.tokens->tt;
+    } else if (opts.use_tokens) {
+        e = build_token_table(value, &opts, &tt);
+        if (e != CROUS_OK) { token_table_free(&tt); return e; }
     }
 
     cbuf_t buf = cbuf_new(512);
     if (!buf.data) { token_table_free(&tt); return CROUS_ERR_OOM; }
 
-    crous_err_t e;
-
-    /* Header */
-    e = cbuf_append(&buf, CROUT_MAGIC "\n", CROUT_MAGIC_LEN + 1);
+    /* Header and token table */
+    e = encode_header(&buf, use_tt);
     if (e) goto fail;
 
-    /* Token table */
-    for (int i = 0; i < tt.len; i++) {
-        e = cbuf_append(&buf, "@ ", 2);                           if (e) goto fail;
-        e = cbuf_append(&buf, tt.entries[i].tok, (size_t)tt.entries[i].tok_len); if (e) goto fail;
-        e = cbuf_appendc(&buf, '=');                              if (e) goto fail;
-        e = cbuf_append(&buf, tt.entries[i].key, tt.entries[i].key_len); if (e) goto fail;
-        e = cbuf_appendc(&buf, '\n');                             if (e) goto fail;
-    }
-
     /* Root value */
-    e = encode_value(&buf, value, &tt, opts.pretty, opts.indent, 0);
+    e = encode_value(&buf, value, use_tt, opts.pretty, opts.indent, 0);
     if (e) goto fail;
 
     /* NUL-terminate for convenience */
@@ -454,6 +719,19 @@ fail:
     return e;
 }
 
+crous_err_t crout_encode(
+    const crous_value *value,
+    const crout_options_t *opts,
+    char **out_buf,
+    size_t *out_size)
+{
+    crous_span span;
+    crous_span_begin(&span, "crout_encode", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_CROUT, 0);
+    crous_err_t err = encode_document(value, opts, out_buf, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
 /* ============================================================================
    DECODER
    ============================================================================ */
@@ -462,9 +740,15 @@ typedef struct {
     const char *src;
     size_t      len;
     size_t      pos;
-    /* Reverse token table: tok -> (key, key_len) */
-    struct { char tok[4]; int tok_len; char *key; size_t key_len; } tokens[MAX_TOKEN_ENTRIES];
+    /* Reverse token table: tok -> (key, key_len), hashed on tok */
+    struct { char tok[4]; int tok_len; char *key; size_t key_len; } *tokens;
     int token_count;
+    int token_cap;
+    uint32_t *token_slots;    /* token index + 1, 0 = empty */
+    size_t    token_mask;     /* slot count - 1 (power of two) */
+    /* Decoded payload of the last bytes value read */
+    uint8_t *scratch;
+    size_t   scratch_cap;
 } crout_reader_t;
 
 static inline int rd_eof(const crout_reader_t *r) {
@@ -480,11 +764,12 @@ static inline void rd_skip_ws(crout_reader_t *r) {
     while (r->pos < r->len) {
         char c = r->src[r->pos];
         if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
-            r->pos++;
+            r->pos += crous_scan_span(r->src + r->pos, r->len - r->pos,
+                                      CROUS_CHAR_BLANK | CROUS_CHAR_CR | CROUS_CHAR_LF);
         else if (c == '/' && r->pos + 1 < r->len && r->src[r->pos + 1] == '/') {
             /* line comment */
-            r->pos += 2;
-            while (r->pos < r->len && r->src[r->pos] != '\n') r->pos++;
+            const char *eol = memchr(r->src + r->pos + 2, '\n', r->len - r->pos - 2);
+            r->pos = eol ? (size_t)(eol - r->src) : r->len;
         } else break;
     }
 }
@@ -515,6 +800,69 @@ static int rd_parse_int64(crout_reader_t *r, int64_t *out) {
     return 1;
 }
 
+/* Find the slot of tok, or the empty slot it would go in */
+static int rd_find_token(const crout_reader_t *r, const char *tok, size_t tok_len, size_t *out_slot) {
+    size_t i = crout_hash(tok, tok_len) & r->token_mask;
+    while (r->token_slots[i]) {
+        int idx = (int)r->token_slots[i] - 1;
+        if ((size_t)r->tokens[idx].tok_len == tok_len &&
+            memcmp(r->tokens[idx].tok, tok, tok_len) == 0) {
+            *out_slot = i;
+            return 1;
+        }
+        i = (i + 1) & r->token_mask;
+    }
+    *out_slot = i;
+    return 0;
+}
+
+/* Grow the slots to nslots (power of two) and reinsert every token */
+static crous_err_t rd_rehash_tokens(crout_reader_t *r, size_t nslots) {
+    uint32_t *slots = (uint32_t *)calloc(nslots, sizeof(uint32_t));
+    if (!slots) return CROUS_ERR_OOM;
+    free(r->token_slots);
+    r->token_slots = slots;
+    r->token_mask = nslots - 1;
+    for (int j = 0; j < r->token_count; j++) {
+        size_t i = crout_hash(r->tokens[j].tok, (size_t)r->tokens[j].tok_len) & r->token_mask;
+        while (slots[i]) i = (i + 1) & r->token_mask;
+        slots[i] = (uint32_t)j + 1;
+    }
+    return CROUS_OK;
+}
+
+/* Add one header entry. A token defined twice keeps its first key. */
+static crous_err_t rd_add_token(crout_reader_t *r, const char *tok, size_t tok_len,
+                                const char *key, size_t key_len) {
+    crous_err_t err;
+    if (!r->token_slots && (err = rd_rehash_tokens(r, 64)) != CROUS_OK) return err;
+    size_t slot;
+    if (rd_find_token(r, tok, tok_len, &slot)) return CROUS_OK;
+    if (r->token_count >= CROUT_MAX_TOKENS) return CROUS_ERR_OVERFLOW;
+
+    if (r->token_count == r->token_cap) {
+        int cap = r->token_cap ? r->token_cap * 2 : 32;
+        void *grown = realloc(r->tokens, (size_t)cap * sizeof(*r->tokens));
+        if (!grown) return CROUS_ERR_OOM;
+        r->tokens = grown;
+        r->token_cap = cap;
+    }
+    int idx = r->token_count;
+    memcpy(r->tokens[idx].tok, tok, tok_len);
+    r->tokens[idx].tok[tok_len] = '\0';
+    r->tokens[idx].tok_len = (int)tok_len;
+    r->tokens[idx].key = (char *)malloc(key_len + 1);
+    if (!r->tokens[idx].key) return CROUS_ERR_OOM;
+    memcpy(r->tokens[idx].key, key, key_len);
+    r->tokens[idx].key[key_len] = '\0';
+    r->tokens[idx].key_len = key_len;
+    r->token_slots[slot] = (uint32_t)++r->token_count;
+
+    if ((size_t)r->token_count * 2 > r->token_mask + 1)
+        return rd_rehash_tokens(r, (r->token_mask + 1) * 2);
+    return CROUS_OK;
+}
+
 /* Parse header: "CROUT1\n" + optional "@ tok=key\n" lines */
 static crous_err_t rd_parse_header(crout_reader_t *r) {
     /* Check magic */
@@ -543,44 +891,39 @@ static crous_err_t rd_parse_header(crout_reader_t *r) {
         size_t key_len = r->pos - key_start;
         if (r->pos < r->len) r->pos++; /* skip '\n' */
 
-        if (r->token_count >= MAX_TOKEN_ENTRIES) return CROUS_ERR_OVERFLOW;
-        int idx = r->token_count++;
-        memcpy(r->tokens[idx].tok, r->src + tok_start, tok_len);
-        r->tokens[idx].tok[tok_len] = '\0';
-        r->tokens[idx].tok_len = (int)tok_len;
-        r->tokens[idx].key = (char *)malloc(key_len + 1);
-        if (!r->tokens[idx].key) return CROUS_ERR_OOM;
-        memcpy(r->tokens[idx].key, r->src + key_start, key_len);
-        r->tokens[idx].key[key_len] = '\0';
-        r->tokens[idx].key_len = key_len;
+        crous_err_t err = rd_add_token(r, r->src + tok_start, tok_len,
+                                       r->src + key_start, key_len);
+        if (err != CROUS_OK) return err;
     }
     return CROUS_OK;
 }
 
-static void rd_free_tokens(crout_reader_t *r) {
+static void rd_free(crout_reader_t *r) {
     for (int i = 0; i < r->token_count; i++) {
         free(r->tokens[i].key);
     }
-    r->token_count = 0;
+    free(r->tokens);
+    free(r->token_slots);
+    r->tokens = NULL;
+    r->token_slots = NULL;
+    r->token_count = r->token_cap = 0;
+    free(r->scratch);
+    r->scratch = NULL;
+    r->scratch_cap = 0;
 }
 
 /* Resolve a token string to its full key; returns NULL if not found */
 static const char* rd_resolve_token(const crout_reader_t *r, const char *tok, size_t tok_len, size_t *out_key_len) {
-    for (int i = 0; i < r->token_count; i++) {
-        if ((size_t)r->tokens[i].tok_len == tok_len &&
-            memcmp(r->tokens[i].tok, tok, tok_len) == 0) {
-            *out_key_len = r->tokens[i].key_len;
-            return r->tokens[i].key;
-        }
-    }
-    return NULL;
+    size_t slot;
+    if (r->token_count == 0 || tok_len > 3 || !rd_find_token(r, tok, tok_len, &slot)) return NULL;
+    int idx = (int)r->token_slots[slot] - 1;
+    *out_key_len = r->tokens[idx].key_len;
+    return r->tokens[idx].key;
 }
 
-/* Forward declaration */
-static crous_value* rd_parse_value(crout_reader_t *r, crous_err_t *err, int depth);
-
-/* Parse a key (token identifier or s<len>:... string literal) */
-static crous_err_t rd_parse_key(crout_reader_t *r, char **out_key, size_t *out_len) {
+/* Read a key (token identifier or s<len>:... string literal). *out_key
+ * points into the source or the token table. */
+static crous_err_t rd_read_key(crout_reader_t *r, const char **out_key, size_t *out_len) {
     rd_skip_ws(r);
     char c = rd_peek(r);
 
@@ -591,40 +934,26 @@ static crous_err_t rd_parse_key(crout_reader_t *r, char **out_key, size_t *out_l
         if (slen < 0) return CROUS_ERR_SYNTAX;
         if (rd_eof(r) || rd_next(r) != ':') return CROUS_ERR_SYNTAX;
         if ((size_t)(r->len - r->pos) < (size_t)slen) return CROUS_ERR_TRUNCATED;
-        char *key = (char *)malloc((size_t)slen + 1);
-        if (!key) return CROUS_ERR_OOM;
-        memcpy(key, r->src + r->pos, (size_t)slen);
-        key[slen] = '\0';
-        r->pos += (size_t)slen;
-        *out_key = key;
+        *out_key = r->src + r->pos;
         *out_len = (size_t)slen;
+        r->pos += (size_t)slen;
         return CROUS_OK;
     }
 
     /* Token identifier: [A-Za-z0-9_]{1,3} */
     if (isalnum((unsigned char)c) || c == '_') {
         size_t start = r->pos;
-        while (!rd_eof(r) && (isalnum((unsigned char)rd_peek(r)) || rd_peek(r) == '_'))
-            rd_next(r);
+        r->pos += crous_scan_span(r->src + r->pos, r->len - r->pos, CROUS_CHAR_IDENT);
         size_t tok_len = r->pos - start;
 
-        /* Try to resolve from token table */
+        /* Resolve from the token table, else use the literal token */
         size_t resolved_len;
         const char *resolved = rd_resolve_token(r, r->src + start, tok_len, &resolved_len);
         if (resolved) {
-            char *key = (char *)malloc(resolved_len + 1);
-            if (!key) return CROUS_ERR_OOM;
-            memcpy(key, resolved, resolved_len);
-            key[resolved_len] = '\0';
-            *out_key = key;
+            *out_key = resolved;
             *out_len = resolved_len;
         } else {
-            /* Use the literal token as the key */
-            char *key = (char *)malloc(tok_len + 1);
-            if (!key) return CROUS_ERR_OOM;
-            memcpy(key, r->src + start, tok_len);
-            key[tok_len] = '\0';
-            *out_key = key;
+            *out_key = r->src + start;
             *out_len = tok_len;
         }
         return CROUS_OK;
@@ -633,6 +962,143 @@ static crous_err_t rd_parse_key(crout_reader_t *r, char **out_key, size_t *out_l
     return CROUS_ERR_SYNTAX;
 }
 
+/* Read a float after its 'f' prefix */
+static crous_err_t rd_read_float(crout_reader_t *r, double *out) {
+    /* Handle special values: nan, inf, -inf */
+    if (r->pos + 3 <= r->len && memcmp(r->src + r->pos, "nan", 3) == 0) {
+        r->pos += 3;
+        *out = NAN;
+        return CROUS_OK;
+    }
+    if (r->pos + 3 <= r->len && memcmp(r->src + r->pos, "inf", 3) == 0) {
+        r->pos += 3;
+        *out = INFINITY;
+        return CROUS_OK;
+    }
+    if (r->pos + 4 <= r->len && memcmp(r->src + r->pos, "-inf", 4) == 0) {
+        r->pos += 4;
+        *out = -INFINITY;
+        return CROUS_OK;
+    }
+    /* General float: consume until delimiter */
+    size_t start = r->pos;
+    while (!rd_eof(r)) {
+        char fc = rd_peek(r);
+        if (fc == ' ' || fc == ',' || fc == '}' || fc == ']' ||
+            fc == ')' || fc == '\n' || fc == '\r' || fc == '\t')
+            break;
+        rd_next(r);
+    }
+    size_t flen = r->pos - start;
+    if (flen == 0) return CROUS_ERR_SYNTAX;
+    /* Parse the float string */
+    char tmp[128];
+    if (flen >= sizeof(tmp)) return CROUS_ERR_OVERFLOW;
+    memcpy(tmp, r->src + start, flen);
+    tmp[flen] = '\0';
+    *out = strtod(tmp, NULL);
+    return CROUS_OK;
+}
+
+/* Read hex-encoded bytes after their 'b' prefix into r->scratch */
+static crous_err_t rd_read_bytes(crout_reader_t *r, size_t *out_len) {
+    int64_t blen = rd_parse_size(r);  /* original byte count */
+    if (blen < 0) return CROUS_ERR_SYNTAX;
+    if (rd_eof(r) || rd_next(r) != ':') return CROUS_ERR_SYNTAX;
+    /* Hex-encoded: need 2*blen hex chars in the stream */
+    size_t hex_len = (size_t)blen * 2;
+    if ((size_t)(r->len - r->pos) < hex_len) return CROUS_ERR_TRUNCATED;
+    if ((size_t)blen > r->scratch_cap) {
+        uint8_t *grown = (uint8_t *)realloc(r->scratch, (size_t)blen);
+        if (!grown) return CROUS_ERR_OOM;
+        r->scratch = grown;
+        r->scratch_cap = (size_t)blen;
+    }
+    for (int64_t i = 0; i < blen; i++) {
+        char hi = r->src[r->pos++];
+        char lo = r->src[r->pos++];
+        int h = (hi >= '0' && hi <= '9') ? hi - '0' :
+                (hi >= 'a' && hi <= 'f') ? hi - 'a' + 10 :
+                (hi >= 'A' && hi <= 'F') ? hi - 'A' + 10 : -1;
+        int l = (lo >= '0' && lo <= '9') ? lo - '0' :
+                (lo >= 'a' && lo <= 'f') ? lo - 'a' + 10 :
+                (lo >= 'A' && lo <= 'F') ? lo - 'A' + 10 : -1;
+        if (h < 0 || l < 0) return CROUS_ERR_SYNTAX;
+        r->scratch[i] = (uint8_t)((h << 4) | l);
+    }
+    *out_len = (size_t)blen;
+    return CROUS_OK;
+}
+
+/*
+ * Read the scalar at r (anything but a container or tagged value) into a
+ * node on the caller's stack. String data points into the source, bytes
+ * into r->scratch until the next bytes value.
+ */
+static crous_err_t rd_read_scalar(crout_reader_t *r, crous_value *out) {
+    out->flags = CROUS_VALUE_FLAG_BORROWED;
+
+    switch (rd_next(r)) {
+    case 'N':
+        out->type = CROUS_TYPE_NULL;
+        return CROUS_OK;
+
+    case 'T':
+    case 'F':
+        out->type = CROUS_TYPE_BOOL;
+        out->data.b = r->src[r->pos - 1] == 'T';
+        return CROUS_OK;
+
+    case 'i':
+        out->type = CROUS_TYPE_INT;
+        return rd_parse_int64(r, &out->data.i) ? CROUS_OK : CROUS_ERR_SYNTAX;
+
+    case 'f':
+        out->type = CROUS_TYPE_FLOAT;
+        return rd_read_float(r, &out->data.f);
+
+    case 's': {
+        int64_t slen = rd_parse_size(r);
+        if (slen < 0) return CROUS_ERR_SYNTAX;
+        if (rd_eof(r) || rd_next(r) != ':') return CROUS_ERR_SYNTAX;
+        if ((int64_t)(r->len - r->pos) < slen) return CROUS_ERR_TRUNCATED;
+        out->type = CROUS_TYPE_STRING;
+        out->data.s.data = (uint8_t *)(r->src + r->pos);
+        out->data.s.len = (size_t)slen;
+        r->pos += (size_t)slen;
+        return CROUS_OK;
+    }
+
+    case 'b':
+        out->type = CROUS_TYPE_BYTES;
+        out->data.bytes.data = r->scratch;
+        {
+            crous_err_t err = rd_read_bytes(r, &out->data.bytes.len);
+            out->data.bytes.data = r->scratch;
+            return err;
+        }
+
+    default:
+        return CROUS_ERR_SYNTAX;
+    }
+}
+
+/* Heap node for a scalar read by rd_read_scalar() */
+static crous_value* rd_new_scalar(const crous_value *v) {
+    switch (v->type) {
+    case CROUS_TYPE_NULL:   return crous_value_new_null();
+    case CROUS_TYPE_BOOL:   return crous_value_new_bool(v->data.b);
+    case CROUS_TYPE_INT:    return crous_value_new_int(v->data.i);
+    case CROUS_TYPE_FLOAT:  return crous_value_new_float(v->data.f);
+    case CROUS_TYPE_STRING: return crous_value_new_string((const char *)v->data.s.data, v->data.s.len);
+    case CROUS_TYPE_BYTES:  return crous_value_new_bytes(v->data.bytes.data, v->data.bytes.len);
+    default:                return NULL;
+    }
+}
+
+/* Forward declaration */
+static crous_value* rd_parse_value(crout_reader_t *r, crous_err_t *err, int depth);
+
 /* Parse dict: { key:value , key:value } */
 static crous_value* rd_parse_dict(crout_reader_t *r, crous_err_t *err, int depth) {
     rd_next(r); /* consume '{' */
@@ -644,23 +1110,22 @@ static crous_value* rd_parse_dict(crout_reader_t *r, crous_err_t *err, int depth
 
     while (1) {
         rd_skip_ws(r);
-        char *key = NULL;
+        const char *key = NULL;
         size_t key_len = 0;
-        *err = rd_parse_key(r, &key, &key_len);
+        *err = rd_read_key(r, &key, &key_len);
         if (*err != CROUS_OK) { crous_value_free_tree(dict); return NULL; }
 
         rd_skip_ws(r);
         if (rd_eof(r) || rd_next(r) != ':') {
-            free(key); crous_value_free_tree(dict);
+            crous_value_free_tree(dict);
             *err = CROUS_ERR_SYNTAX; return NULL;
         }
 
         rd_skip_ws(r);
         crous_value *val = rd_parse_value(r, err, depth + 1);
-        if (*err != CROUS_OK) { free(key); crous_value_free_tree(dict); return NULL; }
+        if (*err != CROUS_OK) { crous_value_free_tree(dict); return NULL; }
 
         *err = crous_value_dict_set_binary(dict, key, key_len, val);
-        free(key);
         if (*err != CROUS_OK) { crous_value_free_tree(dict); crous_value_free_tree(val); return NULL; }
 
         rd_skip_ws(r);
@@ -727,6 +1192,15 @@ static crous_value* rd_parse_tuple(crout_reader_t *r, crous_err_t *err, int dept
     return tup;
 }
 
+/* Parse a tag number and its ':' after the '#' prefix */
+static crous_err_t rd_read_tag(crout_reader_t *r, uint32_t *out_tag) {
+    int64_t tag;
+    if (!rd_parse_int64(r, &tag) || tag < 0) return CROUS_ERR_SYNTAX;
+    if (rd_eof(r) || rd_next(r) != ':') return CROUS_ERR_SYNTAX;
+    *out_tag = (uint32_t)tag;
+    return CROUS_OK;
+}
+
 /* Parse a single value */
 static crous_value* rd_parse_value(crout_reader_t *r, crous_err_t *err, int depth) {
     if (depth > CROUS_MAX_DEPTH) {
@@ -737,127 +1211,15 @@ static crous_value* rd_parse_value(crout_reader_t *r, crous_err_t *err, int dept
     rd_skip_ws(r);
     if (rd_eof(r)) { *err = CROUS_ERR_TRUNCATED; return NULL; }
 
-    char c = rd_peek(r);
-
-    switch (c) {
-    case 'N':
-        rd_next(r);
-        { crous_value *v = crous_value_new_null();
-          if (!v) *err = CROUS_ERR_OOM;
-          return v; }
-
-    case 'T':
-        rd_next(r);
-        { crous_value *v = crous_value_new_bool(1);
-          if (!v) *err = CROUS_ERR_OOM;
-          return v; }
-
-    case 'F':
-        rd_next(r);
-        { crous_value *v = crous_value_new_bool(0);
-          if (!v) *err = CROUS_ERR_OOM;
-          return v; }
-
-    case 'i': {
-        rd_next(r); /* consume 'i' */
-        int64_t val;
-        if (!rd_parse_int64(r, &val)) { *err = CROUS_ERR_SYNTAX; return NULL; }
-        crous_value *v = crous_value_new_int(val);
-        if (!v) *err = CROUS_ERR_OOM;
-        return v;
-    }
-
-    case 'f': {
-        rd_next(r); /* consume 'f' */
-        /* Handle special values: nan, inf, -inf */
-        if (r->pos + 3 <= r->len && memcmp(r->src + r->pos, "nan", 3) == 0) {
-            r->pos += 3;
-            crous_value *v = crous_value_new_float(NAN);
-            if (!v) *err = CROUS_ERR_OOM;
-            return v;
-        }
-        if (r->pos + 3 <= r->len && memcmp(r->src + r->pos, "inf", 3) == 0) {
-            r->pos += 3;
-            crous_value *v = crous_value_new_float(INFINITY);
-            if (!v) *err = CROUS_ERR_OOM;
-            return v;
-        }
-        if (r->pos + 4 <= r->len && memcmp(r->src + r->pos, "-inf", 4) == 0) {
-            r->pos += 4;
-            crous_value *v = crous_value_new_float(-INFINITY);
-            if (!v) *err = CROUS_ERR_OOM;
-            return v;
-        }
-        /* General float: consume until delimiter */
-        size_t start = r->pos;
-        while (!rd_eof(r)) {
-            char fc = rd_peek(r);
-            if (fc == ' ' || fc == ',' || fc == '}' || fc == ']' ||
-                fc == ')' || fc == '\n' || fc == '\r' || fc == '\t')
-                break;
-            rd_next(r);
-        }
-        size_t flen = r->pos - start;
-        if (flen == 0) { *err = CROUS_ERR_SYNTAX; return NULL; }
-        /* Parse the float string */
-        char tmp[128];
-        if (flen >= sizeof(tmp)) { *err = CROUS_ERR_OVERFLOW; return NULL; }
-        memcpy(tmp, r->src + start, flen);
-        tmp[flen] = '\0';
-        double d = strtod(tmp, NULL);
-        crous_value *v = crous_value_new_float(d);
-        if (!v) *err = CROUS_ERR_OOM;
-        return v;
-    }
-
-    case 's': {
-        rd_next(r); /* consume 's' */
-        int64_t slen = rd_parse_size(r);
-        if (slen < 0) { *err = CROUS_ERR_SYNTAX; return NULL; }
-        if (rd_eof(r) || rd_next(r) != ':') { *err = CROUS_ERR_SYNTAX; return NULL; }
-        if ((int64_t)(r->len - r->pos) < slen) { *err = CROUS_ERR_TRUNCATED; return NULL; }
-        crous_value *v = crous_value_new_string(r->src + r->pos, (size_t)slen);
-        r->pos += (size_t)slen;
-        if (!v) *err = CROUS_ERR_OOM;
-        return v;
-    }
-
-    case 'b': {
-        rd_next(r); /* consume 'b' */
-        int64_t blen = rd_parse_size(r);  /* original byte count */
-        if (blen < 0) { *err = CROUS_ERR_SYNTAX; return NULL; }
-        if (rd_eof(r) || rd_next(r) != ':') { *err = CROUS_ERR_SYNTAX; return NULL; }
-        /* Hex-encoded: need 2*blen hex chars in the stream */
-        size_t hex_len = (size_t)blen * 2;
-        if ((size_t)(r->len - r->pos) < hex_len) { *err = CROUS_ERR_TRUNCATED; return NULL; }
-        uint8_t *raw = (uint8_t *)malloc((size_t)blen);
-        if (!raw) { *err = CROUS_ERR_OOM; return NULL; }
-        for (int64_t i = 0; i < blen; i++) {
-            char hi = r->src[r->pos++];
-            char lo = r->src[r->pos++];
-            int h = (hi >= '0' && hi <= '9') ? hi - '0' :
-                    (hi >= 'a' && hi <= 'f') ? hi - 'a' + 10 :
-                    (hi >= 'A' && hi <= 'F') ? hi - 'A' + 10 : -1;
-            int l = (lo >= '0' && lo <= '9') ? lo - '0' :
-                    (lo >= 'a' && lo <= 'f') ? lo - 'a' + 10 :
-                    (lo >= 'A' && lo <= 'F') ? lo - 'A' + 10 : -1;
-            if (h < 0 || l < 0) { free(raw); *err = CROUS_ERR_SYNTAX; return NULL; }
-            raw[i] = (uint8_t)((h << 4) | l);
-        }
-        crous_value *v = crous_value_new_bytes(raw, (size_t)blen);
-        free(raw);
-        if (!v) *err = CROUS_ERR_OOM;
-        return v;
-    }
-
+    switch (rd_peek(r)) {
     case '#': {
         rd_next(r); /* consume '#' */
-        int64_t tag;
-        if (!rd_parse_int64(r, &tag) || tag < 0) { *err = CROUS_ERR_SYNTAX; return NULL; }
-        if (rd_eof(r) || rd_next(r) != ':') { *err = CROUS_ERR_SYNTAX; return NULL; }
+        uint32_t tag;
+        *err = rd_read_tag(r, &tag);
+        if (*err != CROUS_OK) return NULL;
         crous_value *inner = rd_parse_value(r, err, depth + 1);
         if (*err != CROUS_OK) return NULL;
-        crous_value *v = crous_value_new_tagged((uint32_t)tag, inner);
+        crous_value *v = crous_value_new_tagged(tag, inner);
         if (!v) { crous_value_free_tree(inner); *err = CROUS_ERR_OOM; }
         return v;
     }
@@ -871,9 +1233,14 @@ static crous_value* rd_parse_value(crout_reader_t *r, crous_err_t *err, int dept
     case '(':
         return rd_parse_tuple(r, err, depth);
 
-    default:
-        *err = CROUS_ERR_SYNTAX;
-        return NULL;
+    default: {
+        crous_value scalar;
+        *err = rd_read_scalar(r, &scalar);
+        if (*err != CROUS_OK) return NULL;
+        crous_value *v = rd_new_scalar(&scalar);
+        if (!v) *err = CROUS_ERR_OOM;
+        return v;
+    }
     }
 }
 
@@ -881,7 +1248,7 @@ static crous_value* rd_parse_value(crout_reader_t *r, crous_err_t *err, int dept
    PUBLIC DECODER ENTRY POINT
    ============================================================================ */
 
-crous_err_t crout_decode(
+static crous_err_t decode_document(
     const char *buf,
     size_t buf_size,
     crous_value **out_value)
@@ -895,11 +1262,11 @@ crous_err_t crout_decode(
     rd.pos = 0;
 
     crous_err_t err = rd_parse_header(&rd);
-    if (err != CROUS_OK) { rd_free_tokens(&rd); return err; }
+    if (err != CROUS_OK) { rd_free(&rd); return err; }
 
     err = CROUS_OK;
     crous_value *v = rd_parse_value(&rd, &err, 0);
-    rd_free_tokens(&rd);
+    rd_free(&rd);
 
     if (err != CROUS_OK) {
         if (v) crous_value_free_tree(v);
@@ -909,41 +1276,484 @@ crous_err_t crout_decode(
     return CROUS_OK;
 }
 
+crous_err_t crout_decode(
+    const char *buf,
+    size_t buf_size,
+    crous_value **out_value)
+{
+    crous_span span;
+    crous_span_begin(&span, "crout_decode", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_CROUT, CROUS_STATS_FMT_NONE, buf_size);
+    return crous_span_end(&span, decode_document(buf, buf_size, out_value), 0);
+}
+
 /* ============================================================================
-   CROUT ↔ FLUX CONVERSION HELPERS
+   EVENT DRIVER
    ============================================================================ */
 
-crous_err_t crout_text_to_flux(
+static crous_err_t rd_emit_value(crout_reader_t *r, const crous_visitor *vis, void *ctx, int depth);
+
+/* Report a container and its elements, in the rd_parse_dict/list/tuple grammar */
+static crous_err_t rd_emit_container(crout_reader_t *r, const crous_visitor *vis, void *ctx, int depth) {
+    char open = rd_next(r);
+    char close = open == '{' ? '}' : open == '[' ? ']' : ')';
+    crous_type_t type = open == '{' ? CROUS_TYPE_DICT : open == '[' ? CROUS_TYPE_LIST : CROUS_TYPE_TUPLE;
+
+    crous_err_t err = crous_visit_begin(vis, ctx, type, CROUS_VISIT_COUNT_UNKNOWN);
+    if (err != CROUS_OK) return err;
+
+    size_t count = 0;
+    rd_skip_ws(r);
+    if (rd_peek(r) == close) {
+        rd_next(r);
+        return crous_visit_end(vis, ctx, type, 0);
+    }
+
+    while (1) {
+        rd_skip_ws(r);
+        if (type == CROUS_TYPE_DICT) {
+            const char *key;
+            size_t key_len;
+            err = rd_read_key(r, &key, &key_len);
+            if (err == CROUS_OK) err = crous_visit_key(vis, ctx, key, key_len);
+            if (err != CROUS_OK) return err;
+            rd_skip_ws(r);
+            if (rd_eof(r) || rd_next(r) != ':') return CROUS_ERR_SYNTAX;
+            rd_skip_ws(r);
+        }
+
+        err = rd_emit_value(r, vis, ctx, depth + 1);
+        if (err != CROUS_OK) return err;
+        count++;
+
+        rd_skip_ws(r);
+        if (rd_peek(r) == close) { rd_next(r); break; }
+        if (rd_peek(r) == ',') { rd_next(r); continue; }
+        return CROUS_ERR_SYNTAX;
+    }
+    return crous_visit_end(vis, ctx, type, count);
+}
+
+/* rd_parse_value() reporting to a visitor instead of building nodes */
+static crous_err_t rd_emit_value(crout_reader_t *r, const crous_visitor *vis, void *ctx, int depth) {
+    if (depth > CROUS_MAX_DEPTH) return CROUS_ERR_DEPTH_EXCEEDED;
+
+    rd_skip_ws(r);
+    if (rd_eof(r)) return CROUS_ERR_TRUNCATED;
+
+    switch (rd_peek(r)) {
+    case '#': {
+        rd_next(r); /* consume '#' */
+        uint32_t tag;
+        crous_err_t err = rd_read_tag(r, &tag);
+        if (err == CROUS_OK) err = crous_visit_tag(vis, ctx, tag);
+        if (err != CROUS_OK) return err;
+        return rd_emit_value(r, vis, ctx, depth + 1);
+    }
+
+    case '{':
+    case '[':
+    case '(':
+        return rd_emit_container(r, vis, ctx, depth);
+
+    default: {
+        crous_value scalar;
+        crous_err_t err = rd_read_scalar(r, &scalar);
+        if (err != CROUS_OK) return err;
+        return crous_visit_scalar(vis, ctx, &scalar);
+    }
+    }
+}
+
+crous_err_t crout_visit(
     const char *text, size_t text_len,
-    uint8_t **out_buf, size_t *out_size)
+    const crous_visitor *visitor, void *ctx)
 {
-    if (!text || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    if (!text || !visitor) return CROUS_ERR_INVALID_TYPE;
+
+    crout_reader_t rd;
+    memset(&rd, 0, sizeof(rd));
+    rd.src = text;
+    rd.len = text_len;
 
-    /* Decode CROUT text → crous_value tree */
+    crous_err_t err = rd_parse_header(&rd);
+    if (err == CROUS_OK) err = rd_emit_value(&rd, visitor, ctx, 0);
+    rd_free(&rd);
+    return err;
+}
+
+/* ============================================================================
+   EVENT TRANSCODING
+   ============================================================================ */
+
+/*
+ * CROUT <-> FLUX without a value tree: one driver walks its input and a
+ * visitor writes the other format as the events arrive. The CROUT reader
+ * knows a container's size only at its end, so text -> FLUX makes a
+ * counting pass first and the FLUX writer takes the counts in document
+ * order. FLUX -> text reads the document through lazy views; with tokens
+ * on, a first walk over the keys builds the same table count_keys() would.
+ */
+
+/* ---- Container counts (text -> FLUX, first pass) ---- */
+
+typedef struct {
+    size_t *counts;             /* Per container, in document order */
+    size_t len;
+    size_t cap;
+    size_t open[CROUS_MAX_DEPTH + 1];
+    int depth;
+} count_sink_t;
+
+static crous_err_t count_begin(void *ctx, crous_type_t type, size_t count) {
+    (void)type; (void)count;
+    count_sink_t *cs = (count_sink_t *)ctx;
+    if (cs->depth > CROUS_MAX_DEPTH) return CROUS_ERR_DEPTH_EXCEEDED;
+    if (cs->len == cs->cap) {
+        size_t cap = cs->cap ? cs->cap * 2 : 256;
+        size_t *grown = (size_t *)realloc(cs->counts, cap * sizeof(*grown));
+        if (!grown) return CROUS_ERR_OOM;
+        cs->counts = grown;
+        cs->cap = cap;
+    }
+    cs->open[cs->depth++] = cs->len++;
+    return CROUS_OK;
+}
+
+static crous_err_t count_end(void *ctx, crous_type_t type, size_t count) {
+    (void)type;
+    count_sink_t *cs = (count_sink_t *)ctx;
+    cs->counts[cs->open[--cs->depth]] = count;
+    return CROUS_OK;
+}
+
+static const crous_visitor count_sink = {
+    NULL, NULL, count_begin, NULL, count_end
+};
+
+/* ---- FLUX binary output (text -> FLUX, second pass) ---- */
+
+typedef struct {
+    flux_writer_t *w;
+    const size_t *counts;
+    size_t next;
+} flux_sink_t;
+
+static crous_err_t flux_sink_value(void *ctx, const crous_value *v) {
+    return flux_writer_value(((flux_sink_t *)ctx)->w, v);
+}
+
+static crous_err_t flux_sink_tag(void *ctx, uint32_t tag) {
+    return flux_writer_tag(((flux_sink_t *)ctx)->w, tag);
+}
+
+static crous_err_t flux_sink_begin(void *ctx, crous_type_t type, size_t count) {
+    flux_sink_t *fs = (flux_sink_t *)ctx;
+    size_t known = fs->counts[fs->next++];
+    if (count != CROUS_VISIT_COUNT_UNKNOWN && count != known) return CROUS_ERR_INTERNAL;
+    return flux_writer_begin(fs->w, type, known);
+}
+
+static crous_err_t flux_sink_key(void *ctx, const char *key, size_t key_len) {
+    return flux_writer_key(((flux_sink_t *)ctx)->w, key, key_len);
+}
+
+static crous_err_t flux_sink_end(void *ctx, crous_type_t type, size_t count) {
+    (void)type; (void)count;
+    return flux_writer_end(((flux_sink_t *)ctx)->w);
+}
+
+static const crous_visitor flux_sink = {
+    flux_sink_value, flux_sink_tag, flux_sink_begin, flux_sink_key, flux_sink_end
+};
+
+/* ---- Key counts for the token table (FLUX -> text, first pass) ---- */
+
+/* Stops the walk with CROUS_ERR_OVERFLOW once the sample is used up */
+static crous_err_t key_count_begin(void *ctx, crous_type_t type, size_t count) {
+    (void)count;
+    key_counter_t *kc = (key_counter_t *)ctx;
+    if (type != CROUS_TYPE_DICT || key_counter_dict(kc)) return CROUS_OK;
+    return CROUS_ERR_OVERFLOW;
+}
+
+static crous_err_t key_count_key(void *ctx, const char *key, size_t key_len) {
+    return count_key(((key_counter_t *)ctx)->tt, key, key_len);
+}
+
+static const crous_visitor key_count_sink = {
+    NULL, NULL, key_count_begin, key_count_key, NULL
+};
+
+/* ---- CROUT text output (FLUX -> text), laid out as encode_value() does ---- */
+
+typedef struct {
+    cbuf_t buf;
+    crous_output_stream *out;   /* NULL = keep the whole text in buf */
+    const token_table_t *tt;
+    int pretty;
+    int indent;
+    int attached;               /* Next value follows its key or tag */
+    int depth;
+    char close[CROUS_MAX_DEPTH + 2];
+    size_t index[CROUS_MAX_DEPTH + 2];
+} text_sink_t;
+
+/* Pass a full block of text on to the stream */
+static crous_err_t text_sink_drain(text_sink_t *ts, int all) {
+    if (!ts->out || ts->buf.len == 0 || (!all && ts->buf.len < CROUS_STREAM_CHUNK_SIZE)) return CROUS_OK;
+    if (ts->out->write(ts->out->user_data, (const uint8_t *)ts->buf.data, ts->buf.len) != ts->buf.len)
+        return CROUS_ERR_STREAM;
+    ts->buf.len = 0;
+    return CROUS_OK;
+}
+
+/* Separator and indentation ahead of the next element */
+static crous_err_t text_sink_element(text_sink_t *ts) {
+    if (ts->attached) {
+        ts->attached = 0;
+        return CROUS_OK;
+    }
+    if (ts->depth == 0) return CROUS_OK;
+    crous_err_t e;
+    if (ts->index[ts->depth - 1]++ > 0) {
+        e = cbuf_append(&ts->buf, " , ", 3); if (e) return e;
+    }
+    if (ts->pretty) {
+        e = cbuf_appendc(&ts->buf, '\n'); if (e) return e;
+        e = write_indent(&ts->buf, ts->indent, ts->depth); if (e) return e;
+    }
+    return CROUS_OK;
+}
+
+static crous_err_t text_sink_value(void *ctx, const crous_value *v) {
+    text_sink_t *ts = (text_sink_t *)ctx;
+    crous_err_t e = text_sink_element(ts);
+    if (e == CROUS_OK) e = encode_value(&ts->buf, v, ts->tt, 0, 0, 0);
+    if (e == CROUS_OK) e = text_sink_drain(ts, 0);
+    return e;
+}
+
+static crous_err_t text_sink_tag(void *ctx, uint32_t tag) {
+    text_sink_t *ts = (text_sink_t *)ctx;
+    crous_err_t e = text_sink_element(ts);
+    if (e) return e;
+    char tmp[16];
+    int n = snprintf(tmp, sizeof(tmp), "#%u:", (unsigned)tag);
+    e = cbuf_append(&ts->buf, tmp, (size_t)n);
+    ts->attached = 1;
+    return e;
+}
+
+static crous_err_t text_sink_begin(void *ctx, crous_type_t type, size_t count) {
+    (void)count;
+    text_sink_t *ts = (text_sink_t *)ctx;
+    if (ts->depth >= CROUS_MAX_DEPTH + 2) return CROUS_ERR_DEPTH_EXCEEDED;
+    crous_err_t e = text_sink_element(ts);
+    if (e) return e;
+    e = cbuf_appendc(&ts->buf, type == CROUS_TYPE_DICT ? '{' : type == CROUS_TYPE_TUPLE ? '(' : '[');
+    ts->close[ts->depth] = type == CROUS_TYPE_DICT ? '}' : type == CROUS_TYPE_TUPLE ? ')' : ']';
+    ts->index[ts->depth] = 0;
+    ts->depth++;
+    return e;
+}
+
+static crous_err_t text_sink_key(void *ctx, const char *key, size_t key_len) {
+    text_sink_t *ts = (text_sink_t *)ctx;
+    crous_err_t e = text_sink_element(ts);
+    if (e == CROUS_OK) e = encode_key(&ts->buf, key, key_len, ts->tt);
+    if (e == CROUS_OK) e = cbuf_appendc(&ts->buf, ':');
+    ts->attached = 1;
+    return e;
+}
+
+static crous_err_t text_sink_end(void *ctx, crous_type_t type, size_t count) {
+    (void)type; (void)count;
+    text_sink_t *ts = (text_sink_t *)ctx;
+    crous_err_t e;
+    ts->depth--;
+    if (ts->pretty && ts->index[ts->depth] > 0) {
+        e = cbuf_appendc(&ts->buf, '\n'); if (e) return e;
+        e = write_indent(&ts->buf, ts->indent, ts->depth); if (e) return e;
+    }
+    e = cbuf_appendc(&ts->buf, ts->close[ts->depth]);
+    if (e == CROUS_OK) e = text_sink_drain(ts, 0);
+    return e;
+}
+
+static const crous_visitor text_sink = {
+    text_sink_value, text_sink_tag, text_sink_begin, text_sink_key, text_sink_end
+};
+
+/* ============================================================================
+   CROUT ↔ FLUX CONVERSION HELPERS
+   ============================================================================ */
+
+/* Text -> FLUX into out, or into a new buffer when out is NULL */
+static crous_err_t text_to_flux(const char *text, size_t text_len, crous_output_stream *out,
+                                uint8_t **out_buf, size_t *out_size) {
+    crout_reader_t rd;
+    memset(&rd, 0, sizeof(rd));
+    rd.src = text;
+    rd.len = text_len;
+
+    crous_err_t err = rd_parse_header(&rd);
+    size_t body = rd.pos;
+
+    /* Pass 1: every container's element count, in document order */
+    count_sink_t counts;
+    memset(&counts, 0, sizeof(counts));
+    if (err == CROUS_OK) err = rd_emit_value(&rd, &count_sink, &counts, 0);
+
+    /* Pass 2: the same events, written as FLUX */
+    flux_sink_t fs = { NULL, counts.counts, 0 };
+    if (err == CROUS_OK) err = flux_writer_new(out, &fs.w);
+    if (err == CROUS_OK) {
+        rd.pos = body;
+        err = rd_emit_value(&rd, &flux_sink, &fs, 0);
+        if (err == CROUS_OK) err = flux_writer_finish(fs.w, out_buf, out_size);
+        else flux_writer_free(fs.w);
+    }
+
+    free(counts.counts);
+    rd_free(&rd);
+    return err;
+}
+
+/* Legacy CROUS input has no view form: decode, then encode the tree */
+static crous_err_t flux_to_text_tree(const uint8_t *flux, size_t flux_len, const crout_options_t *opts,
+                                     char **out_buf, size_t *out_size) {
     crous_value *v = NULL;
-    crous_err_t err = crout_decode(text, text_len, &v);
+    crous_err_t err = crous_decode_borrowed(flux, flux_len, NULL, &v);
     if (err != CROUS_OK) return err;
-
-    /* Encode crous_value tree → FLUX binary */
-    err = crous_encode(v, out_buf, out_size);
+    err = crout_encode(v, opts, out_buf, out_size);
     crous_value_free_tree(v);
     return err;
 }
 
+static int is_legacy_binary(const uint8_t *buf, size_t len) {
+    return len >= 4 && buf[0] == CROUS_MAGIC_0 && buf[1] == CROUS_MAGIC_1 &&
+           buf[2] == CROUS_MAGIC_2 && buf[3] == CROUS_MAGIC_3;
+}
+
+/* FLUX -> text into out, or into a new NUL-terminated buffer when out is NULL */
+static crous_err_t flux_to_text(const uint8_t *flux, size_t flux_len, const crout_options_t *opts_in,
+                                crous_output_stream *out, char **out_buf, size_t *out_size) {
+    crout_options_t opts = opts_in ? *opts_in : crout_options_default();
+
+    flux_view_doc_t *doc;
+    crous_err_t err = flux_view_open(flux, flux_len, &doc);
+    if (err == CROUS_ERR_INVALID_HEADER && is_legacy_binary(flux, flux_len)) {
+        char *text;
+        size_t size;
+        err = flux_to_text_tree(flux, flux_len, &opts, &text, &size);
+        if (err != CROUS_OK) return err;
+        if (!out) {
+            *out_buf = text;
+            *out_size = size;
+            return CROUS_OK;
+        }
+        if (out->write(out->user_data, (const uint8_t *)text, size) != size) err = CROUS_ERR_STREAM;
+        free(text);
+        return err;
+    }
+    if (err != CROUS_OK) return err;
+
+    flux_view_t root;
+    err = flux_view_root(doc, &root);
+
+    /* Keys first, so the table comes out as crout_encode() would build it */
+    token_table_t tt;
+    memset(&tt, 0, sizeof(tt));
+    const token_table_t *use_tt = &tt;
+    if (err == CROUS_OK && opts.use_tokens && opts.tokens) {
+        use_tt = &opts.tokens->tt;
+    } else if (err == CROUS_OK && opts.use_tokens) {
+        key_counter_t kc = { &tt, opts.token_sample, opts.token_sample > 0, 0 };
+        err = flux_view_visit(&root, &key_count_sink, &kc);
+        if (kc.stopped) err = CROUS_OK;
+        if (err == CROUS_OK) err = assign_tokens(&tt, opts.token_threshold, opts.max_tokens);
+    }
+
+    text_sink_t *ts = NULL;
+    if (err == CROUS_OK) {
+        ts = (text_sink_t *)calloc(1, sizeof(*ts));
+        if (!ts) err = CROUS_ERR_OOM;
+    }
+    if (err == CROUS_OK) {
+        ts->buf = cbuf_new(512);
+        ts->out = out;
+        ts->tt = use_tt;
+        ts->pretty = opts.pretty;
+        ts->indent = opts.indent;
+        if (!ts->buf.data) err = CROUS_ERR_OOM;
+    }
+    if (err == CROUS_OK) err = encode_header(&ts->buf, use_tt);
+    if (err == CROUS_OK) err = flux_view_visit(&root, &text_sink, ts);
+
+    if (err == CROUS_OK && out) {
+        err = text_sink_drain(ts, 1);
+    } else if (err == CROUS_OK) {
+        /* NUL-terminate for convenience, as crout_encode() does */
+        err = cbuf_appendc(&ts->buf, '\0');
+        if (err == CROUS_OK) {
+            *out_buf = ts->buf.data;
+            *out_size = ts->buf.len - 1;
+            ts->buf.data = NULL;
+        }
+    }
+
+    if (ts) cbuf_free(&ts->buf);
+    free(ts);
+    token_table_free(&tt);
+    flux_view_close(doc);
+    return err;
+}
+
+crous_err_t crout_text_to_flux(
+    const char *text, size_t text_len,
+    uint8_t **out_buf, size_t *out_size)
+{
+    if (!text || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    crous_span span;
+    crous_span_begin(&span, "crout_text_to_flux", CROUS_PHASE_TRANSCODE,
+                     CROUS_STATS_FMT_CROUT, CROUS_STATS_FMT_FLUX, text_len);
+    crous_err_t err = text_to_flux(text, text_len, NULL, out_buf, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
+crous_err_t crout_text_to_flux_stream(
+    const char *text, size_t text_len,
+    crous_output_stream *out)
+{
+    if (!text || !out) return CROUS_ERR_INVALID_TYPE;
+    crous_span span;
+    crous_span_begin(&span, "crout_text_to_flux_stream", CROUS_PHASE_TRANSCODE,
+                     CROUS_STATS_FMT_CROUT, CROUS_STATS_FMT_FLUX, text_len);
+    return crous_span_end(&span, text_to_flux(text, text_len, crous_span_output(&span, out), NULL, NULL), 0);
+}
+
 crous_err_t crout_flux_to_text(
     const uint8_t *flux, size_t flux_len,
     const crout_options_t *opts,
     char **out_buf, size_t *out_size)
 {
     if (!flux || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    crous_span span;
+    crous_span_begin(&span, "crout_flux_to_text", CROUS_PHASE_TRANSCODE,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_CROUT, flux_len);
+    crous_err_t err = flux_to_text(flux, flux_len, opts, NULL, out_buf, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
 
-    /* Decode FLUX binary → crous_value tree */
-    crous_value *v = NULL;
-    crous_err_t err = crous_decode(flux, flux_len, &v);
-    if (err != CROUS_OK) return err;
-
-    /* Encode crous_value tree → CROUT text */
-    err = crout_encode(v, opts, out_buf, out_size);
-    crous_value_free_tree(v);
-    return err;
+crous_err_t crout_flux_to_text_stream(
+    const uint8_t *flux, size_t flux_len,
+    const crout_options_t *opts,
+    crous_output_stream *out)
+{
+    if (!flux || !out) return CROUS_ERR_INVALID_TYPE;
+    crous_span span;
+    crous_span_begin(&span, "crout_flux_to_text_stream", CROUS_PHASE_TRANSCODE,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_CROUT, flux_len);
+    return crous_span_end(&span, flux_to_text(flux, flux_len, opts, crous_span_output(&span, out), NULL, NULL), 0);
 }
@@ -0,0 +1,470 @@
+#include "../include/crous_flux.h"
+#include "../include/crous_version.h"
+#include "../include/crous_checksum.h"
+#include "../include/crous_parallel.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+   ENVELOPE HEADER
+   ============================================================================ */
+
+#define ENVELOPE_FEATURES (FLUX_FEATURE_REQUIRED | CROUS_FEATURE_COMPRESSION)
+#define BLOCK_HEADER_SIZE 8
+#define BLOCK_HEADER_MAX 12     /* With a checksum */
+
+static inline uint32_t env_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void env_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void env_put_header(uint8_t *p, uint8_t version, crous_codec_t codec, uint32_t dict_id,
+                           unsigned flags) {
+    unsigned features = ENVELOPE_FEATURES | ((flags & FLUX_ENVELOPE_CHECKSUM) ? CROUS_FEATURE_CHECKSUMS : 0);
+    p[0] = FLUX_MAGIC_0;
+    p[1] = FLUX_MAGIC_1;
+    p[2] = FLUX_MAGIC_2;
+    p[3] = FLUX_MAGIC_3;
+    p[4] = version;
+    p[5] = FLUX_FLAG_EXTENDED;
+    p[6] = (uint8_t)(features >> 8);
+    p[7] = (uint8_t)features;
+    p[8] = (uint8_t)codec;
+    p[9] = (uint8_t)dict_id;
+    p[10] = (uint8_t)(dict_id >> 8);
+    p[11] = (uint8_t)(dict_id >> 16);
+}
+
+int flux_binary_is_compressed(const uint8_t *buf, size_t buf_size) {
+    return buf && buf_size >= 8 &&
+           buf[0] == FLUX_MAGIC_0 && buf[1] == FLUX_MAGIC_1 &&
+           buf[2] == FLUX_MAGIC_2 && buf[3] == FLUX_MAGIC_3 &&
+           (buf[5] & FLUX_FLAG_EXTENDED) &&
+           (((unsigned)buf[6] << 8 | buf[7]) & CROUS_FEATURE_COMPRESSION);
+}
+
+crous_err_t flux_envelope_codec(const uint8_t *buf, size_t buf_size, crous_codec_t *out_codec) {
+    if (!buf || !out_codec) return CROUS_ERR_INVALID_TYPE;
+    if (buf_size < FLUX_ENVELOPE_HEADER_SIZE) return CROUS_ERR_TRUNCATED;
+    if (!flux_binary_is_compressed(buf, buf_size)) return CROUS_ERR_INVALID_HEADER;
+
+    /* Compression and block checksums are the header features this build understands */
+    unsigned features = (unsigned)buf[6] << 8 | buf[7];
+    if ((features & ~(unsigned)CROUS_FEATURE_CHECKSUMS) != ENVELOPE_FEATURES) return CROUS_ERR_INVALID_HEADER;
+
+    crous_codec_t codec = (crous_codec_t)buf[8];
+    if (!crous_codec_available(codec)) return CROUS_ERR_INVALID_HEADER;
+    *out_codec = codec;
+    return CROUS_OK;
+}
+
+int flux_envelope_checksummed(const uint8_t *buf, size_t buf_size) {
+    return flux_binary_is_compressed(buf, buf_size) &&
+           (((unsigned)buf[6] << 8 | buf[7]) & CROUS_FEATURE_CHECKSUMS);
+}
+
+crous_err_t flux_envelope_dictionary(const uint8_t *buf, size_t buf_size, const flux_dictionary_t **out_dict) {
+    crous_codec_t codec;
+    if (!out_dict) return CROUS_ERR_INVALID_TYPE;
+    crous_err_t err = flux_envelope_codec(buf, buf_size, &codec);
+    if (err != CROUS_OK) return err;
+
+    uint32_t id = (uint32_t)buf[9] | ((uint32_t)buf[10] << 8) | ((uint32_t)buf[11] << 16);
+    *out_dict = NULL;
+    if (id == 0) return CROUS_OK;
+    *out_dict = flux_dictionary_lookup(id);
+    return *out_dict ? CROUS_OK : CROUS_ERR_NOT_FOUND;
+}
+
+/* A document to wrap: plain FLUX binary, at least its header */
+static crous_err_t env_check_document(const uint8_t *doc, size_t doc_size) {
+    if (doc_size < 6) return CROUS_ERR_TRUNCATED;
+    if (doc[0] != FLUX_MAGIC_0 || doc[1] != FLUX_MAGIC_1 ||
+        doc[2] != FLUX_MAGIC_2 || doc[3] != FLUX_MAGIC_3) {
+        return CROUS_ERR_INVALID_HEADER;
+    }
+    if (flux_binary_is_compressed(doc, doc_size)) return CROUS_ERR_INVALID_TYPE;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   BLOCK ENCODING
+   ============================================================================ */
+
+/*
+ * Encode one block at dst, which holds cap bytes: its header, then the
+ * compressed bytes, or the raw ones when compression does not shrink them
+ * or does not fit. With FLUX_ENVELOPE_CHECKSUM the header ends with the
+ * raw bytes' CRC-32C. Returns the bytes written, 0 if even that overflows
+ * cap.
+ */
+static size_t env_put_block(crous_codec_t codec, const crous_compress_dict *content, unsigned flags,
+                            const uint8_t *raw, size_t raw_len, uint8_t *dst, size_t cap) {
+    size_t head = (flags & FLUX_ENVELOPE_CHECKSUM) ? BLOCK_HEADER_MAX : BLOCK_HEADER_SIZE;
+    if (cap < head) return 0;
+
+    size_t room = cap - head;
+    size_t stored = 0;
+    if (codec != CROUS_CODEC_NONE && raw_len > 1) {
+        size_t limit = raw_len - 1 < room ? raw_len - 1 : room;
+        if (crous_compress_block_dict(codec, content, raw, raw_len, dst + head, limit, &stored) != CROUS_OK) {
+            stored = 0;
+        }
+    }
+    if (!stored) {
+        if (room < raw_len) return 0;
+        memcpy(dst + head, raw, raw_len);
+        stored = raw_len;
+    }
+
+    env_put_u32(dst, (uint32_t)raw_len);
+    env_put_u32(dst + 4, (uint32_t)stored);
+    if (head == BLOCK_HEADER_MAX) env_put_u32(dst + 8, crous_crc32c(0, raw, raw_len));
+    return head + stored;
+}
+
+size_t flux_compress_bound(size_t doc_size) {
+    size_t blocks = (doc_size + FLUX_COMPRESS_BLOCK_SIZE - 1) / FLUX_COMPRESS_BLOCK_SIZE;
+    return FLUX_ENVELOPE_HEADER_SIZE + doc_size + blocks * BLOCK_HEADER_MAX + 4;
+}
+
+crous_err_t flux_compress_binary_into(const uint8_t *doc, size_t doc_size, crous_codec_t codec,
+                                      const flux_dictionary_t *dict, unsigned flags,
+                                      uint8_t *buf, size_t buf_size, size_t *out_size) {
+    if (!doc || !buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    if (!crous_codec_available(codec)) return CROUS_ERR_INVALID_TYPE;
+
+    crous_err_t err = env_check_document(doc, doc_size);
+    if (err != CROUS_OK) return err;
+    if (buf_size < FLUX_ENVELOPE_HEADER_SIZE + 4) return CROUS_ERR_OVERFLOW;
+
+    env_put_header(buf, doc[4], codec, flux_dictionary_id(dict), flags);
+    size_t pos = FLUX_ENVELOPE_HEADER_SIZE;
+
+    /* Keep 4 bytes back for the end marker */
+    for (size_t at = 0; at < doc_size; at += FLUX_COMPRESS_BLOCK_SIZE) {
+        size_t raw_len = doc_size - at < FLUX_COMPRESS_BLOCK_SIZE ? doc_size - at : FLUX_COMPRESS_BLOCK_SIZE;
+        size_t n = env_put_block(codec, flux_dictionary_content(dict), flags, doc + at, raw_len,
+                                 buf + pos, buf_size - pos - 4);
+        if (!n) return CROUS_ERR_OVERFLOW;
+        pos += n;
+    }
+
+    env_put_u32(buf + pos, 0);
+    *out_size = pos + 4;
+    return CROUS_OK;
+}
+
+/*
+ * Parallel compression: block i is compressed on a worker into slot i of
+ * buf, slots being a block and its largest header apart as
+ * flux_compress_bound() allows for, then the blocks are moved down in
+ * order to close the gaps.
+ * Each lands at or before its slot, so the moves never overtake.
+ */
+typedef struct {
+    const uint8_t *doc;
+    size_t doc_size;
+    crous_codec_t codec;
+    const crous_compress_dict *content;
+    unsigned flags;
+    uint8_t *slots;
+    size_t slot_size;
+    size_t *sizes;          /* Encoded bytes per block, 0 on failure */
+} env_parallel_t;
+
+static void env_block_task(void *ctx, size_t index) {
+    env_parallel_t *job = (env_parallel_t *)ctx;
+    size_t at = index * FLUX_COMPRESS_BLOCK_SIZE;
+    size_t raw_len = job->doc_size - at < FLUX_COMPRESS_BLOCK_SIZE ? job->doc_size - at : FLUX_COMPRESS_BLOCK_SIZE;
+    job->sizes[index] = env_put_block(job->codec, job->content, job->flags, job->doc + at, raw_len,
+                                      job->slots + index * job->slot_size, raw_len + BLOCK_HEADER_MAX);
+}
+
+crous_err_t flux_compress_binary_into_parallel(const uint8_t *doc, size_t doc_size, crous_codec_t codec,
+                                               const flux_dictionary_t *dict, unsigned flags, int nthreads,
+                                               uint8_t *buf, size_t buf_size, size_t *out_size) {
+    size_t blocks = (doc_size + FLUX_COMPRESS_BLOCK_SIZE - 1) / FLUX_COMPRESS_BLOCK_SIZE;
+    int pool = crous_pool_threads();
+    if (nthreads <= 0 || nthreads > pool) nthreads = pool;
+    if (nthreads == 1 || blocks < 2 || buf_size < flux_compress_bound(doc_size)) {
+        return flux_compress_binary_into(doc, doc_size, codec, dict, flags, buf, buf_size, out_size);
+    }
+    if (!doc || !buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    if (!crous_codec_available(codec)) return CROUS_ERR_INVALID_TYPE;
+
+    crous_err_t err = env_check_document(doc, doc_size);
+    if (err != CROUS_OK) return err;
+
+    env_parallel_t job = {
+        doc, doc_size, codec, flux_dictionary_content(dict), flags,
+        buf + FLUX_ENVELOPE_HEADER_SIZE, FLUX_COMPRESS_BLOCK_SIZE + BLOCK_HEADER_MAX,
+        malloc(blocks * sizeof(size_t))
+    };
+    if (!job.sizes) return CROUS_ERR_OOM;
+    crous_parallel_for(blocks, nthreads, env_block_task, &job);
+
+    env_put_header(buf, doc[4], codec, flux_dictionary_id(dict), flags);
+    size_t pos = FLUX_ENVELOPE_HEADER_SIZE;
+    for (size_t i = 0; i < blocks && err == CROUS_OK; i++) {
+        if (!job.sizes[i]) {
+            err = CROUS_ERR_INTERNAL;
+            break;
+        }
+        memmove(buf + pos, job.slots + i * job.slot_size, job.sizes[i]);
+        pos += job.sizes[i];
+    }
+    free(job.sizes);
+    if (err != CROUS_OK) return err;
+
+    env_put_u32(buf + pos, 0);
+    *out_size = pos + 4;
+    return CROUS_OK;
+}
+
+crous_err_t flux_compress_binary(const uint8_t *doc, size_t doc_size, crous_codec_t codec,
+                                 const flux_dictionary_t *dict, unsigned flags,
+                                 uint8_t **out_buf, size_t *out_size) {
+    if (!doc || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+
+    size_t cap = flux_compress_bound(doc_size);
+    uint8_t *buf = malloc(cap);
+    if (!buf) return CROUS_ERR_OOM;
+
+    size_t size;
+    crous_err_t err = flux_compress_binary_into(doc, doc_size, codec, dict, flags, buf, cap, &size);
+    if (err != CROUS_OK) {
+        free(buf);
+        return err;
+    }
+
+    /* Give back what compression saved */
+    uint8_t *shrunk = realloc(buf, size);
+    *out_buf = shrunk ? shrunk : buf;
+    *out_size = size;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   BLOCK DECODING
+   ============================================================================ */
+
+/*
+ * Walk the blocks after the header, each checked for its limits and
+ * present in full. With dst, decompress them there (dst_size bytes in
+ * all), checking each block's CRC-32C while it is still in cache;
+ * without, only add up their raw sizes.
+ */
+static crous_err_t env_walk(const uint8_t *buf, size_t buf_size, uint8_t *dst, size_t dst_size,
+                            size_t *out_total) {
+    crous_codec_t codec;
+    const flux_dictionary_t *dict;
+    crous_err_t err = flux_envelope_codec(buf, buf_size, &codec);
+    if (err == CROUS_OK) err = flux_envelope_dictionary(buf, buf_size, &dict);
+    if (err != CROUS_OK) return err;
+
+    size_t head = flux_envelope_checksummed(buf, buf_size) ? BLOCK_HEADER_MAX : BLOCK_HEADER_SIZE;
+    size_t pos = FLUX_ENVELOPE_HEADER_SIZE;
+    size_t total = 0;
+    for (;;) {
+        if (buf_size - pos < 4) return CROUS_ERR_TRUNCATED;
+        uint32_t raw_len = env_get_u32(buf + pos);
+        if (raw_len == 0) break;
+        if (buf_size - pos < head) return CROUS_ERR_TRUNCATED;
+        uint32_t stored = env_get_u32(buf + pos + 4);
+        uint32_t crc = head == BLOCK_HEADER_MAX ? env_get_u32(buf + pos + 8) : 0;
+        pos += head;
+
+        if (raw_len > FLUX_COMPRESS_BLOCK_MAX || stored > raw_len || stored == 0) return CROUS_ERR_DECODE;
+        if (buf_size - pos < stored) return CROUS_ERR_TRUNCATED;
+        if (total > SIZE_MAX - raw_len) return CROUS_ERR_OVERFLOW;
+
+        if (dst) {
+            if (dst_size - total < raw_len) return CROUS_ERR_DECODE;
+            crous_codec_t block_codec = stored == raw_len ? CROUS_CODEC_NONE : codec;
+            err = crous_decompress_block_dict(block_codec, flux_dictionary_content(dict), buf + pos, stored,
+                                              dst + total, raw_len);
+            if (err != CROUS_OK) return err;
+            if (head == BLOCK_HEADER_MAX && crous_crc32c(0, dst + total, raw_len) != crc) {
+                return CROUS_ERR_CHECKSUM;
+            }
+        }
+        pos += stored;
+        total += raw_len;
+    }
+
+    if (dst && total != dst_size) return CROUS_ERR_DECODE;
+    *out_total = total;
+    return CROUS_OK;
+}
+
+crous_err_t flux_decompressed_size(const uint8_t *buf, size_t buf_size, size_t *out_size) {
+    if (!buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    return env_walk(buf, buf_size, NULL, 0, out_size);
+}
+
+crous_err_t flux_decompress_binary_into(const uint8_t *buf, size_t buf_size, uint8_t *out, size_t out_size) {
+    if (!buf || (!out && out_size)) return CROUS_ERR_INVALID_TYPE;
+
+    /* An empty document still needs a destination to decompress into */
+    uint8_t none;
+    size_t total;
+    crous_err_t err = env_walk(buf, buf_size, out ? out : &none, out_size, &total);
+    if (err != CROUS_OK) return err;
+
+    /* Envelopes do not nest */
+    if (flux_binary_is_compressed(out, out_size)) return CROUS_ERR_DECODE;
+    return CROUS_OK;
+}
+
+crous_err_t flux_decompress_binary(const uint8_t *buf, size_t buf_size, uint8_t **out_buf, size_t *out_size) {
+    if (!buf || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+
+    size_t size;
+    crous_err_t err = flux_decompressed_size(buf, buf_size, &size);
+    if (err != CROUS_OK) return err;
+
+    uint8_t *raw = malloc(size ? size : 1);
+    if (!raw) return CROUS_ERR_OOM;
+
+    err = flux_decompress_binary_into(buf, buf_size, raw, size);
+    if (err != CROUS_OK) {
+        free(raw);
+        return err;
+    }
+
+    *out_buf = raw;
+    *out_size = size;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   COMPRESSING OUTPUT STREAM
+   ============================================================================ */
+
+struct flux_compress_stream {
+    crous_output_stream input;      /* Handed to the encoder */
+    crous_output_stream *out;
+    crous_codec_t codec;
+    const flux_dictionary_t *dict;  /* NULL = none */
+    unsigned flags;                 /* FLUX_ENVELOPE_* */
+    crous_err_t err;                /* First failure; later writes are refused */
+    int header_sent;
+
+    uint8_t *raw;                   /* FLUX_COMPRESS_BLOCK_SIZE bytes being filled */
+    size_t raw_len;
+    uint8_t *packed;                /* One encoded block, envelope header room in front */
+};
+
+#define PACKED_SIZE (FLUX_ENVELOPE_HEADER_SIZE + BLOCK_HEADER_MAX + FLUX_COMPRESS_BLOCK_SIZE)
+
+/* Encode and write one block of raw bytes */
+static crous_err_t stream_emit(flux_compress_stream_t *s, const uint8_t *raw, size_t raw_len) {
+    uint8_t *start = s->packed + FLUX_ENVELOPE_HEADER_SIZE;
+    size_t n = env_put_block(s->codec, flux_dictionary_content(s->dict), s->flags, raw, raw_len, start,
+                             PACKED_SIZE - FLUX_ENVELOPE_HEADER_SIZE);
+    if (!n) return CROUS_ERR_INTERNAL;
+
+    /* The first block carries the envelope header, with the version the document opened with */
+    if (!s->header_sent) {
+        start = s->packed;
+        env_put_header(start, raw_len > 4 ? raw[4] : FLUX_VERSION, s->codec, flux_dictionary_id(s->dict),
+                       s->flags);
+        n += FLUX_ENVELOPE_HEADER_SIZE;
+        s->header_sent = 1;
+    }
+
+    if (s->out->write(s->out->user_data, start, n) != n) return CROUS_ERR_STREAM;
+    return CROUS_OK;
+}
+
+static size_t stream_write(void *user_data, const uint8_t *data, size_t len) {
+    flux_compress_stream_t *s = (flux_compress_stream_t *)user_data;
+    if (s->err != CROUS_OK) return 0;
+
+    size_t left = len;
+    while (left) {
+        /* Whole blocks straight from the caller's buffer */
+        if (s->raw_len == 0 && left >= FLUX_COMPRESS_BLOCK_SIZE) {
+            s->err = stream_emit(s, data, FLUX_COMPRESS_BLOCK_SIZE);
+            if (s->err != CROUS_OK) return 0;
+            data += FLUX_COMPRESS_BLOCK_SIZE;
+            left -= FLUX_COMPRESS_BLOCK_SIZE;
+            continue;
+        }
+
+        size_t n = FLUX_COMPRESS_BLOCK_SIZE - s->raw_len;
+        if (n > left) n = left;
+        memcpy(s->raw + s->raw_len, data, n);
+        s->raw_len += n;
+        data += n;
+        left -= n;
+
+        if (s->raw_len == FLUX_COMPRESS_BLOCK_SIZE) {
+            s->err = stream_emit(s, s->raw, s->raw_len);
+            s->raw_len = 0;
+            if (s->err != CROUS_OK) return 0;
+        }
+    }
+    return len;
+}
+
+crous_err_t flux_compress_stream_new(crous_output_stream *out, crous_codec_t codec, const flux_dictionary_t *dict,
+                                     unsigned flags, flux_compress_stream_t **out_stream) {
+    if (!out || !out_stream) return CROUS_ERR_INVALID_TYPE;
+    if (!crous_codec_available(codec)) return CROUS_ERR_INVALID_TYPE;
+
+    flux_compress_stream_t *s = calloc(1, sizeof(*s));
+    if (!s) return CROUS_ERR_OOM;
+
+    s->raw = malloc(FLUX_COMPRESS_BLOCK_SIZE);
+    s->packed = malloc(PACKED_SIZE);
+    if (!s->raw || !s->packed) {
+        flux_compress_stream_free(s);
+        return CROUS_ERR_OOM;
+    }
+
+    s->input.user_data = s;
+    s->input.write = stream_write;
+    s->out = out;
+    s->codec = codec;
+    s->dict = dict;
+    s->flags = flags;
+    s->err = CROUS_OK;
+    *out_stream = s;
+    return CROUS_OK;
+}
+
+crous_output_stream *flux_compress_stream_input(flux_compress_stream_t *stream) {
+    return stream ? &stream->input : NULL;
+}
+
+crous_err_t flux_compress_stream_finish(flux_compress_stream_t *stream) {
+    if (!stream) return CROUS_ERR_INVALID_TYPE;
+
+    crous_err_t err = stream->err;
+    if (err == CROUS_OK && (stream->raw_len || !stream->header_sent)) {
+        if (!stream->header_sent && stream->raw_len < 6) err = CROUS_ERR_TRUNCATED;
+        else err = stream_emit(stream, stream->raw, stream->raw_len);
+    }
+    if (err == CROUS_OK) {
+        uint8_t end[4] = { 0, 0, 0, 0 };
+        if (stream->out->write(stream->out->user_data, end, 4) != 4) err = CROUS_ERR_STREAM;
+    }
+
+    flux_compress_stream_free(stream);
+    return err;
+}
+
+void flux_compress_stream_free(flux_compress_stream_t *stream) {
+    if (!stream) return;
+    free(stream->raw);
+    free(stream->packed);
+    free(stream);
+}
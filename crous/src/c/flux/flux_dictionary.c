@@ -0,0 +1,385 @@
+#include "../include/crous_flux.h"
+#include "../include/crous_value.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+   DICTIONARY OBJECT
+   ============================================================================ */
+
+typedef struct {
+    const char *data;       /* Into the key blob */
+    size_t len;
+} dict_key_t;
+
+struct flux_dictionary {
+    uint32_t id;
+    dict_key_t *keys;
+    size_t key_count;
+    char *key_blob;         /* Every key's bytes, back to back */
+    uint32_t *slots;        /* Open-addressed key index: position + 1, 0 = empty */
+    size_t slot_cap;        /* Power of two, at least twice key_count */
+    crous_compress_dict *content;
+};
+
+static uint64_t dict_key_hash(const char *key, size_t len) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)key[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static crous_err_t dict_set_keys(flux_dictionary_t *dict, const char *const *keys, const size_t *key_lens,
+                                 size_t key_count) {
+    size_t total = 0;
+    for (size_t i = 0; i < key_count; i++) {
+        if (!keys[i] && key_lens[i]) return CROUS_ERR_INVALID_TYPE;
+        if (key_lens[i] > CROUS_MAX_STRING_BYTES) return CROUS_ERR_OVERFLOW;
+        total += key_lens[i];
+    }
+
+    dict->keys = malloc((key_count ? key_count : 1) * sizeof(*dict->keys));
+    dict->key_blob = malloc(total ? total : 1);
+    size_t cap = 16;
+    while (cap < key_count * 2) cap *= 2;
+    dict->slots = calloc(cap, sizeof(*dict->slots));
+    if (!dict->keys || !dict->key_blob || !dict->slots) return CROUS_ERR_OOM;
+    dict->slot_cap = cap;
+
+    char *p = dict->key_blob;
+    for (size_t i = 0; i < key_count; i++) {
+        /* A repeated key keeps its first position; later copies are never referenced */
+        size_t found;
+        if (key_lens[i]) memcpy(p, keys[i], key_lens[i]);
+        dict->keys[i].data = p;
+        dict->keys[i].len = key_lens[i];
+        p += key_lens[i];
+
+        if (!flux_dictionary_find_key(dict, dict->keys[i].data, dict->keys[i].len, &found)) {
+            size_t j = dict_key_hash(dict->keys[i].data, dict->keys[i].len) & (cap - 1);
+            while (dict->slots[j]) j = (j + 1) & (cap - 1);
+            dict->slots[j] = (uint32_t)i + 1;
+        }
+        dict->key_count = i + 1;
+    }
+    return CROUS_OK;
+}
+
+crous_err_t flux_dictionary_new(uint32_t id, const char *const *keys, const size_t *key_lens, size_t key_count,
+                                const uint8_t *content, size_t content_len, flux_dictionary_t **out_dict) {
+    if (!out_dict || (key_count && (!keys || !key_lens)) || (!content && content_len)) return CROUS_ERR_INVALID_TYPE;
+    if (id == 0 || id > FLUX_DICTIONARY_ID_MAX) return CROUS_ERR_INVALID_TYPE;
+    if (key_count > FLUX_DICTIONARY_KEYS_MAX) return CROUS_ERR_OVERFLOW;
+
+    flux_dictionary_t *dict = calloc(1, sizeof(*dict));
+    if (!dict) return CROUS_ERR_OOM;
+    dict->id = id;
+
+    crous_err_t err = dict_set_keys(dict, keys, key_lens, key_count);
+    if (err == CROUS_OK && content_len) err = crous_compress_dict_new(content, content_len, &dict->content);
+    if (err != CROUS_OK) {
+        flux_dictionary_free(dict);
+        return err;
+    }
+
+    *out_dict = dict;
+    return CROUS_OK;
+}
+
+void flux_dictionary_free(flux_dictionary_t *dict) {
+    if (!dict) return;
+    free(dict->keys);
+    free(dict->key_blob);
+    free(dict->slots);
+    crous_compress_dict_free(dict->content);
+    free(dict);
+}
+
+uint32_t flux_dictionary_id(const flux_dictionary_t *dict) {
+    return dict ? dict->id : 0;
+}
+
+size_t flux_dictionary_key_count(const flux_dictionary_t *dict) {
+    return dict ? dict->key_count : 0;
+}
+
+crous_err_t flux_dictionary_key(const flux_dictionary_t *dict, size_t index, const char **out_key, size_t *out_len) {
+    if (!dict || !out_key || !out_len) return CROUS_ERR_INVALID_TYPE;
+    if (index >= dict->key_count) return CROUS_ERR_NOT_FOUND;
+    *out_key = dict->keys[index].data;
+    *out_len = dict->keys[index].len;
+    return CROUS_OK;
+}
+
+int flux_dictionary_find_key(const flux_dictionary_t *dict, const char *key, size_t len, size_t *out_index) {
+    if (!dict || !dict->slot_cap) return 0;
+
+    size_t j = dict_key_hash(key, len) & (dict->slot_cap - 1);
+    for (uint32_t slot; (slot = dict->slots[j]) != 0; j = (j + 1) & (dict->slot_cap - 1)) {
+        const dict_key_t *k = &dict->keys[slot - 1];
+        if (k->len == len && (len == 0 || memcmp(k->data, key, len) == 0)) {
+            *out_index = slot - 1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const crous_compress_dict *flux_dictionary_content(const flux_dictionary_t *dict) {
+    return dict ? dict->content : NULL;
+}
+
+/* ============================================================================
+   TRAINING
+   ============================================================================ */
+
+typedef struct {
+    const char *key;        /* Into a sample tree */
+    size_t len;
+    size_t count;
+    size_t first;           /* Order of first appearance, to break ties */
+} train_key_t;
+
+typedef struct {
+    train_key_t *keys;
+    size_t count;
+    size_t *slots;          /* Position + 1, 0 = empty */
+    size_t cap;
+} train_counts_t;
+
+static crous_err_t train_grow(train_counts_t *t) {
+    size_t new_cap = t->cap ? t->cap * 2 : 256;
+    size_t *slots = calloc(new_cap, sizeof(*slots));
+    train_key_t *keys = realloc(t->keys, (new_cap / 2) * sizeof(*keys));
+    if (!slots || !keys) {
+        free(slots);
+        if (keys) t->keys = keys;
+        return CROUS_ERR_OOM;
+    }
+    for (size_t i = 0; i < t->count; i++) {
+        size_t j = dict_key_hash(keys[i].key, keys[i].len) & (new_cap - 1);
+        while (slots[j]) j = (j + 1) & (new_cap - 1);
+        slots[j] = i + 1;
+    }
+    free(t->slots);
+    t->slots = slots;
+    t->keys = keys;
+    t->cap = new_cap;
+    return CROUS_OK;
+}
+
+static crous_err_t train_count(train_counts_t *t, const char *key, size_t len) {
+    if (len > FLUX_DICTIONARY_TRAIN_KEY_MAX) return CROUS_OK;
+
+    if (t->cap) {
+        size_t j = dict_key_hash(key, len) & (t->cap - 1);
+        for (size_t slot; (slot = t->slots[j]) != 0; j = (j + 1) & (t->cap - 1)) {
+            train_key_t *k = &t->keys[slot - 1];
+            if (k->len == len && (len == 0 || memcmp(k->key, key, len) == 0)) {
+                k->count++;
+                return CROUS_OK;
+            }
+        }
+    }
+
+    if ((t->count + 1) * 2 > t->cap) {
+        crous_err_t err = train_grow(t);
+        if (err != CROUS_OK) return err;
+    }
+    size_t j = dict_key_hash(key, len) & (t->cap - 1);
+    while (t->slots[j]) j = (j + 1) & (t->cap - 1);
+    t->slots[j] = t->count + 1;
+    t->keys[t->count] = (train_key_t){ key, len, 1, t->count };
+    t->count++;
+    return CROUS_OK;
+}
+
+static crous_err_t train_walk(train_counts_t *t, const crous_value *v, int depth) {
+    if (depth > CROUS_MAX_DEPTH) return CROUS_ERR_DEPTH_EXCEEDED;
+
+    switch (crous_value_get_type(v)) {
+        case CROUS_TYPE_LIST:
+        case CROUS_TYPE_TUPLE:
+            for (size_t i = 0; i < crous_value_list_size(v); i++) {
+                crous_err_t err = train_walk(t, crous_value_list_get(v, i), depth + 1);
+                if (err != CROUS_OK) return err;
+            }
+            return CROUS_OK;
+        case CROUS_TYPE_DICT:
+            for (size_t i = 0; i < crous_value_dict_size(v); i++) {
+                const crous_dict_entry *entry = crous_value_dict_get_entry(v, i);
+                crous_err_t err = train_count(t, entry->key, entry->key_len);
+                if (err == CROUS_OK) err = train_walk(t, entry->value, depth + 1);
+                if (err != CROUS_OK) return err;
+            }
+            return CROUS_OK;
+        case CROUS_TYPE_TAGGED:
+            return train_walk(t, crous_value_get_tagged_inner(v), depth + 1);
+        default:
+            return CROUS_OK;
+    }
+}
+
+/* Most frequent first, then in order of first appearance */
+static int train_key_cmp(const void *a, const void *b) {
+    const train_key_t *x = (const train_key_t *)a;
+    const train_key_t *y = (const train_key_t *)b;
+    if (x->count != y->count) return x->count > y->count ? -1 : 1;
+    return x->first < y->first ? -1 : x->first > y->first;
+}
+
+/*
+ * The content is what messages encoded with the dictionary look like:
+ * each sample encoded against the trained keys, the last samples nearest
+ * the end, where block offsets are shortest.
+ */
+static crous_err_t train_content(flux_dictionary_t *dict, crous_value *const *trees, size_t count,
+                                 uint8_t **out_content, size_t *out_len) {
+    flux_binary_options_t opts = flux_binary_options_default();
+    opts.key_refs = 1;
+    opts.dictionary = dict;
+
+    uint8_t *content = malloc(CROUS_COMPRESS_DICT_MAX);
+    if (!content) return CROUS_ERR_OOM;
+    size_t len = 0;
+
+    for (size_t i = count; i-- > 0 && len < CROUS_COMPRESS_DICT_MAX;) {
+        uint8_t *doc;
+        size_t doc_size;
+        crous_err_t err = flux_encode_binary_inner(trees[i], &opts, &doc, &doc_size);
+        if (err != CROUS_OK) {
+            free(content);
+            return err;
+        }
+        /* Fill from the back; a sample that does not fit keeps its tail */
+        size_t n = doc_size < CROUS_COMPRESS_DICT_MAX - len ? doc_size : CROUS_COMPRESS_DICT_MAX - len;
+        memcpy(content + CROUS_COMPRESS_DICT_MAX - len - n, doc + doc_size - n, n);
+        len += n;
+        free(doc);
+    }
+
+    memmove(content, content + CROUS_COMPRESS_DICT_MAX - len, len);
+    *out_content = content;
+    *out_len = len;
+    return CROUS_OK;
+}
+
+crous_err_t flux_dictionary_train(uint32_t id, const uint8_t *const *samples, const size_t *sample_sizes,
+                                  size_t count, flux_dictionary_t **out_dict) {
+    if (!out_dict || (count && (!samples || !sample_sizes))) return CROUS_ERR_INVALID_TYPE;
+    if (id == 0 || id > FLUX_DICTIONARY_ID_MAX) return CROUS_ERR_INVALID_TYPE;
+
+    crous_value **trees = calloc(count ? count : 1, sizeof(*trees));
+    if (!trees) return CROUS_ERR_OOM;
+
+    train_counts_t t = { NULL, 0, NULL, 0 };
+    crous_err_t err = CROUS_OK;
+    for (size_t i = 0; i < count && err == CROUS_OK; i++) {
+        err = flux_decode_binary(samples[i], sample_sizes[i], &trees[i]);
+        if (err == CROUS_OK) err = train_walk(&t, trees[i], 0);
+    }
+
+    flux_dictionary_t *dict = NULL;
+    const char **keys = NULL;
+    size_t *key_lens = NULL;
+    if (err == CROUS_OK) {
+        size_t n = t.count < FLUX_DICTIONARY_TRAIN_KEYS ? t.count : FLUX_DICTIONARY_TRAIN_KEYS;
+        if (t.count) qsort(t.keys, t.count, sizeof(*t.keys), train_key_cmp);
+        keys = malloc((n ? n : 1) * sizeof(*keys));
+        key_lens = malloc((n ? n : 1) * sizeof(*key_lens));
+        if (!keys || !key_lens) err = CROUS_ERR_OOM;
+        for (size_t i = 0; err == CROUS_OK && i < n; i++) {
+            keys[i] = t.keys[i].key;
+            key_lens[i] = t.keys[i].len;
+        }
+        if (err == CROUS_OK) err = flux_dictionary_new(id, keys, key_lens, n, NULL, 0, &dict);
+    }
+
+    if (err == CROUS_OK) {
+        uint8_t *content;
+        size_t content_len;
+        err = train_content(dict, trees, count, &content, &content_len);
+        if (err == CROUS_OK) {
+            if (content_len) err = crous_compress_dict_new(content, content_len, &dict->content);
+            free(content);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) crous_value_free_tree(trees[i]);
+    free(trees);
+    free(t.keys);
+    free(t.slots);
+    free(keys);
+    free(key_lens);
+
+    if (err != CROUS_OK) {
+        flux_dictionary_free(dict);
+        return err;
+    }
+    *out_dict = dict;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   PROCESS REGISTRY
+   ============================================================================ */
+
+/*
+ * Open-addressed by id. Slots only ever go from empty to set, so readers
+ * need no lock: a compare-and-swap claims a slot, and two registrations
+ * of one id meet on the same probe sequence, where the loser sees the
+ * winner. Registered dictionaries live as long as the process.
+ */
+static flux_dictionary_t *g_registry[FLUX_DICTIONARY_REGISTRY_SIZE];
+
+#if defined(__GNUC__)
+#  define SLOT_LOAD(i) __atomic_load_n(&g_registry[i], __ATOMIC_ACQUIRE)
+#else
+#  define SLOT_LOAD(i) (g_registry[i])
+#endif
+
+/* Set slot i to dict if it is still empty */
+static int slot_claim(size_t i, flux_dictionary_t *dict) {
+#if defined(__GNUC__)
+    flux_dictionary_t *empty = NULL;
+    return __atomic_compare_exchange_n(&g_registry[i], &empty, dict, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#else
+    if (g_registry[i]) return 0;
+    g_registry[i] = dict;
+    return 1;
+#endif
+}
+
+static size_t registry_home(uint32_t id) {
+    return (size_t)((id * 2654435761u) % FLUX_DICTIONARY_REGISTRY_SIZE);
+}
+
+crous_err_t flux_dictionary_register(flux_dictionary_t *dict) {
+    if (!dict) return CROUS_ERR_INVALID_TYPE;
+
+    size_t home = registry_home(dict->id);
+    for (size_t n = 0; n < FLUX_DICTIONARY_REGISTRY_SIZE; n++) {
+        size_t i = (home + n) % FLUX_DICTIONARY_REGISTRY_SIZE;
+        for (;;) {
+            flux_dictionary_t *seen = SLOT_LOAD(i);
+            if (seen) {
+                if (seen->id == dict->id) return CROUS_ERR_INVALID_TYPE;
+                break;
+            }
+            if (slot_claim(i, dict)) return CROUS_OK;
+        }
+    }
+    return CROUS_ERR_OVERFLOW;
+}
+
+const flux_dictionary_t *flux_dictionary_lookup(uint32_t id) {
+    size_t home = registry_home(id);
+    for (size_t n = 0; n < FLUX_DICTIONARY_REGISTRY_SIZE; n++) {
+        flux_dictionary_t *seen = SLOT_LOAD((home + n) % FLUX_DICTIONARY_REGISTRY_SIZE);
+        if (!seen) return NULL;
+        if (seen->id == id) return seen;
+    }
+    return NULL;
+}
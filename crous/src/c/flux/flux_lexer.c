@@ -1,4 +1,5 @@
 #include "../include/crous_flux.h"
+#include "../include/crous_scan.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -45,27 +46,34 @@ void flux_lexer_free(flux_lexer_t *lexer) {
     if (lexer) free(lexer);
 }
 
-static int is_identifier_char(char c) {
-    return isalnum((unsigned char)c) || c == '_';
-}
-
 static int is_identifier_start(char c) {
     return isalpha((unsigned char)c) || c == '_';
 }
 
 static void skip_whitespace_same_line(flux_lexer_t *lexer) {
-    while (lexer->pos < lexer->text_len && 
-           (lexer->text[lexer->pos] == ' ' || lexer->text[lexer->pos] == '\t')) {
-        lexer->pos++;
-        lexer->column++;
-    }
+    /* Most tokens have no blank before them; skip the scan call then */
+    if (lexer->pos >= lexer->text_len ||
+        (lexer->text[lexer->pos] != ' ' && lexer->text[lexer->pos] != '\t'))
+        return;
+    size_t n = crous_scan_span(lexer->text + lexer->pos, lexer->text_len - lexer->pos,
+                               CROUS_CHAR_BLANK);
+    lexer->pos += n;
+    lexer->column += (int)n;
+}
+
+/* Consume an identifier run, keeping the column in step */
+static void skip_identifier(flux_lexer_t *lexer) {
+    size_t n = crous_scan_span(lexer->text + lexer->pos, lexer->text_len - lexer->pos,
+                               CROUS_CHAR_IDENT);
+    lexer->pos += n;
+    lexer->column += (int)n;
 }
 
 static void skip_comment(flux_lexer_t *lexer) {
     if (lexer->pos < lexer->text_len && lexer->text[lexer->pos] == '#') {
-        while (lexer->pos < lexer->text_len && lexer->text[lexer->pos] != '\n') {
-            lexer->pos++;
-        }
+        const char *eol = memchr(lexer->text + lexer->pos, '\n',
+                                 lexer->text_len - lexer->pos);
+        lexer->pos = eol ? (size_t)(eol - lexer->text) : lexer->text_len;
     }
 }
 
@@ -90,10 +98,11 @@ static int count_indent(flux_lexer_t *lexer) {
     return indent;
 }
 
-flux_token_t* flux_lexer_next(flux_lexer_t *lexer) {
+/* Lex one token into current_token; shared by the one-at-a-time and
+ * batched interfaces so both see the same token stream */
+static inline flux_token_t* lex_token(flux_lexer_t *lexer) {
     /* Skip empty lines and comments */
     while (lexer->pos < lexer->text_len) {
-        int line_start_pos = lexer->pos;
         int indent = 0;
         
         /* Count indentation at line start */
@@ -147,26 +156,26 @@ flux_token_t* flux_lexer_next(flux_lexer_t *lexer) {
         lexer->pos++;
         lexer->line++;
         lexer->column = 1;
-        return make_token(lexer, FLUX_TOKEN_NEWLINE, "\n", 1);
+        return make_token(lexer, FLUX_TOKEN_NEWLINE, lexer->text + lexer->pos - 1, 1);
     }
     
     /* Colon */
     if (c == ':') {
         lexer->pos++;
         lexer->column++;
-        return make_token(lexer, FLUX_TOKEN_COLON, ":", 1);
+        return make_token(lexer, FLUX_TOKEN_COLON, lexer->text + lexer->pos - 1, 1);
     }
     
     /* Brackets */
     if (c == '[') {
         lexer->pos++;
         lexer->column++;
-        return make_token(lexer, FLUX_TOKEN_LBRACKET, "[", 1);
+        return make_token(lexer, FLUX_TOKEN_LBRACKET, lexer->text + lexer->pos - 1, 1);
     }
     if (c == ']') {
         lexer->pos++;
         lexer->column++;
-        return make_token(lexer, FLUX_TOKEN_RBRACKET, "]", 1);
+        return make_token(lexer, FLUX_TOKEN_RBRACKET, lexer->text + lexer->pos - 1, 1);
     }
     
     /* Symbol reference */
@@ -175,10 +184,7 @@ flux_token_t* flux_lexer_next(flux_lexer_t *lexer) {
         lexer->pos++;
         lexer->column++;
         const char *start = lexer->text + lexer->pos;
-        while (lexer->pos < lexer->text_len && is_identifier_char(lexer->text[lexer->pos])) {
-            lexer->pos++;
-            lexer->column++;
-        }
+        skip_identifier(lexer);
         return make_token(lexer, FLUX_TOKEN_SYMBOL, start, 
                          lexer->text + lexer->pos - start);
     }
@@ -189,7 +195,13 @@ flux_token_t* flux_lexer_next(flux_lexer_t *lexer) {
         lexer->pos++;
         lexer->column++;
         const char *start = lexer->text + lexer->pos;
-        while (lexer->pos < lexer->text_len && lexer->text[lexer->pos] != quote) {
+        while (lexer->pos < lexer->text_len) {
+            /* Plain run up to the next quote or backslash */
+            size_t n = crous_scan_cspan(lexer->text + lexer->pos, lexer->text_len - lexer->pos,
+                                        CROUS_CHAR_QUOTE);
+            lexer->pos += n;
+            lexer->column += (int)n;
+            if (lexer->pos >= lexer->text_len || lexer->text[lexer->pos] == quote) break;
             if (lexer->text[lexer->pos] == '\\' && lexer->pos + 1 < lexer->text_len) {
                 lexer->pos += 2;
             } else {
@@ -247,10 +259,7 @@ flux_token_t* flux_lexer_next(flux_lexer_t *lexer) {
     /* Keywords and identifiers */
     if (is_identifier_start(c)) {
         const char *start = lexer->text + lexer->pos;
-        while (lexer->pos < lexer->text_len && is_identifier_char(lexer->text[lexer->pos])) {
-            lexer->pos++;
-            lexer->column++;
-        }
+        skip_identifier(lexer);
         size_t len = lexer->text + lexer->pos - start;
         
         /* Check for keywords */
@@ -270,7 +279,62 @@ flux_token_t* flux_lexer_next(flux_lexer_t *lexer) {
     /* Unknown character */
     lexer->pos++;
     lexer->column++;
-    return make_token(lexer, FLUX_TOKEN_ERROR, &c, 1);
+    return make_token(lexer, FLUX_TOKEN_ERROR, lexer->text + lexer->pos - 1, 1);
+}
+
+flux_token_t* flux_lexer_next(flux_lexer_t *lexer) {
+    return lex_token(lexer);
+}
+
+size_t flux_lexer_next_batch(flux_lexer_t *lexer, flux_token_batch_t *batch) {
+    const size_t base_pos = lexer->pos;
+    size_t n = 0;
+
+    batch->base = lexer->text + base_pos;
+    batch->base_pos = base_pos;
+
+    while (n < FLUX_TOKEN_BATCH_SIZE) {
+        /* Enough to undo a token; a pop or push only moves the stack size */
+        size_t saved_pos = lexer->pos;
+        int saved_line = lexer->line;
+        int saved_column = lexer->column;
+        int saved_indent_size = lexer->indent_stack_size;
+
+        flux_token_t *tok = lex_token(lexer);
+        size_t off, len;
+        if (tok->value && tok->type != FLUX_TOKEN_ERROR) {
+            off = (size_t)(tok->value - lexer->text) - base_pos;
+            len = tok->value_len;
+        } else {
+            /* No value, or an error message that is not part of the text */
+            off = saved_pos - base_pos;
+            len = 0;
+        }
+
+        if (off + len > UINT32_MAX) {
+            if (n > 0) {
+                /* Leave it for a batch of its own */
+                lexer->pos = saved_pos;
+                lexer->line = saved_line;
+                lexer->column = saved_column;
+                lexer->indent_stack_size = saved_indent_size;
+                break;
+            }
+            tok->type = FLUX_TOKEN_ERROR;
+            off = 0;
+            len = 0;
+        }
+
+        batch->type[n] = (uint8_t)tok->type;
+        batch->offset[n] = (uint32_t)off;
+        batch->length[n] = (uint32_t)len;
+        batch->line[n] = (uint32_t)tok->line;
+        n++;
+        if (tok->type == FLUX_TOKEN_EOF) break;
+    }
+
+    batch->count = n;
+    return n;
 }
 
 flux_token_t* flux_lexer_peek(flux_lexer_t *lexer) {
@@ -9,25 +9,45 @@
    FLUX PARSER IMPLEMENTATION
    ============================================================================ */
 
+/*
+ * The parser pulls tokens a batch at a time and keeps the one it is
+ * looking at in tok, so lookahead is an index into the batch rather than
+ * a lexer save and restore.
+ */
 struct flux_parser {
     flux_lexer_t *lexer;
-    flux_token_t *current_token;
-    flux_token_t *peeked_token;
+    flux_token_t *current_token;    /* &tok */
+    flux_token_t tok;
+    size_t index;                   /* tok's slot in batch */
     int error_line;
     int error_column;
     char *error_msg;
+    flux_token_batch_t batch;
 };
 
+/* Load the token at batch slot index into tok */
+static inline void load_token(flux_parser_t *parser) {
+    const flux_token_batch_t *b = &parser->batch;
+    size_t i = parser->index;
+    parser->tok.type = (flux_token_type_t)b->type[i];
+    parser->tok.value = b->base + b->offset[i];
+    parser->tok.value_len = b->length[i];
+    parser->tok.line = (int)b->line[i];
+    parser->tok.column = 0;     /* worked out by set_error() */
+}
+
 flux_parser_t* flux_parser_new(flux_lexer_t *lexer) {
     flux_parser_t *parser = malloc(sizeof(flux_parser_t));
     if (!parser) return NULL;
     
     parser->lexer = lexer;
-    parser->current_token = flux_lexer_next(lexer);
-    parser->peeked_token = NULL;
+    parser->current_token = &parser->tok;
+    parser->index = 0;
     parser->error_line = 0;
     parser->error_column = 0;
     parser->error_msg = NULL;
+    flux_lexer_next_batch(lexer, &parser->batch);
+    load_token(parser);
     
     return parser;
 }
@@ -43,26 +63,25 @@ static void set_error(flux_parser_t *parser, const char *msg) {
     if (parser->error_msg) free(parser->error_msg);
     parser->error_msg = malloc(strlen(msg) + 1);
     if (parser->error_msg) strcpy(parser->error_msg, msg);
-    parser->error_line = parser->current_token->line;
-    parser->error_column = parser->current_token->column;
-}
 
-static flux_token_t* peek(flux_parser_t *parser) {
-    if (!parser->peeked_token) {
-        parser->peeked_token = flux_lexer_next(parser->lexer);
-    }
-    return parser->peeked_token;
+    /* Column of the token start, counted back to its line start */
+    const flux_token_batch_t *b = &parser->batch;
+    const char *text = b->base - b->base_pos;
+    const char *at = b->base + b->offset[parser->index];
+    const char *p = at;
+    while (p > text && p[-1] != '\n') p--;
+    parser->error_line = parser->current_token->line;
+    parser->error_column = (int)(at - p) + 1;
 }
 
-static flux_token_t* advance(flux_parser_t *parser) {
-    flux_token_t *prev = parser->current_token;
-    if (parser->peeked_token) {
-        parser->current_token = parser->peeked_token;
-        parser->peeked_token = NULL;
-    } else {
-        parser->current_token = flux_lexer_next(parser->lexer);
+static void advance(flux_parser_t *parser) {
+    /* EOF repeats, as the lexer does */
+    if (parser->tok.type == FLUX_TOKEN_EOF) return;
+    if (++parser->index >= parser->batch.count) {
+        flux_lexer_next_batch(parser->lexer, &parser->batch);
+        parser->index = 0;
     }
-    return prev;
+    load_token(parser);
 }
 
 static int match(flux_parser_t *parser, flux_token_type_t type) {
@@ -73,74 +92,60 @@ static int match(flux_parser_t *parser, flux_token_type_t type) {
     return 0;
 }
 
-static crous_value* parse_scalar(flux_parser_t *parser, crous_err_t *err) {
-    crous_value *v = NULL;
+/* Report the scalar at the current token */
+static crous_err_t parse_scalar(flux_parser_t *parser, const crous_visitor *vis, void *ctx) {
     flux_token_t *token = parser->current_token;
+    crous_value v;
+    v.flags = CROUS_VALUE_FLAG_BORROWED;
     
     switch (token->type) {
         case FLUX_TOKEN_NULL:
-            v = crous_value_new_null();
-            advance(parser);
+            v.type = CROUS_TYPE_NULL;
             break;
             
         case FLUX_TOKEN_BOOL_TRUE:
-            v = crous_value_new_bool(1);
-            advance(parser);
-            break;
-            
         case FLUX_TOKEN_BOOL_FALSE:
-            v = crous_value_new_bool(0);
-            advance(parser);
+            v.type = CROUS_TYPE_BOOL;
+            v.data.b = token->type == FLUX_TOKEN_BOOL_TRUE;
             break;
             
-        case FLUX_TOKEN_INT: {
+        case FLUX_TOKEN_INT:
             errno = 0;
-            int64_t val = strtoll(token->value, NULL, 10);
-            v = crous_value_new_int(val);
-            advance(parser);
+            v.type = CROUS_TYPE_INT;
+            v.data.i = strtoll(token->value, NULL, 10);
             break;
-        }
             
-        case FLUX_TOKEN_FLOAT: {
+        case FLUX_TOKEN_FLOAT:
             errno = 0;
-            double val = strtod(token->value, NULL);
-            v = crous_value_new_float(val);
-            advance(parser);
+            v.type = CROUS_TYPE_FLOAT;
+            v.data.f = strtod(token->value, NULL);
             break;
-        }
             
-        case FLUX_TOKEN_STRING: {
+        case FLUX_TOKEN_STRING:
             /* String value is already unquoted */
-            v = crous_value_new_string(token->value, token->value_len);
-            advance(parser);
-            break;
-        }
-            
-        case FLUX_TOKEN_KEY: {
+        case FLUX_TOKEN_KEY:
             /* Unquoted identifier treated as string */
-            v = crous_value_new_string(token->value, token->value_len);
-            advance(parser);
+            v.type = CROUS_TYPE_STRING;
+            v.data.s.data = (uint8_t *)token->value;
+            v.data.s.len = token->value_len;
             break;
-        }
             
         default:
             set_error(parser, "Expected scalar value");
-            *err = CROUS_ERR_DECODE;
-            return NULL;
+            return CROUS_ERR_DECODE;
     }
     
-    if (!v) *err = CROUS_ERR_OOM;
-    return v;
+    crous_err_t err = crous_visit_scalar(vis, ctx, &v);
+    advance(parser);
+    return err;
 }
 
-static crous_value* parse_value(flux_parser_t *parser, crous_err_t *err);
+static crous_err_t parse_value(flux_parser_t *parser, const crous_visitor *vis, void *ctx);
 
-static crous_value* parse_record(flux_parser_t *parser, crous_err_t *err) {
-    crous_value *record = crous_value_new_dict(0);
-    if (!record) {
-        *err = CROUS_ERR_OOM;
-        return NULL;
-    }
+static crous_err_t parse_record(flux_parser_t *parser, const crous_visitor *vis, void *ctx) {
+    crous_err_t err = crous_visit_begin(vis, ctx, CROUS_TYPE_DICT, CROUS_VISIT_COUNT_UNKNOWN);
+    if (err != CROUS_OK) return err;
+    size_t count = 0;
     
     /* Parse key:value pairs */
     while (parser->current_token->type != FLUX_TOKEN_EOF &&
@@ -153,49 +158,23 @@ static crous_value* parse_record(flux_parser_t *parser, crous_err_t *err) {
         
         if (parser->current_token->type != FLUX_TOKEN_KEY) {
             set_error(parser, "Expected key");
-            *err = CROUS_ERR_DECODE;
-            crous_value_free_tree(record);
-            return NULL;
+            return CROUS_ERR_DECODE;
         }
         
-        /* Get key (dynamic allocation to avoid truncation) */
-        size_t key_len = parser->current_token->value_len;
-        char *key_buf = malloc(key_len + 1);
-        if (!key_buf) {
-            *err = CROUS_ERR_OOM;
-            crous_value_free_tree(record);
-            return NULL;
-        }
-        memcpy(key_buf, parser->current_token->value, key_len);
-        key_buf[key_len] = '\0';
+        err = crous_visit_key(vis, ctx, parser->current_token->value, parser->current_token->value_len);
+        if (err != CROUS_OK) return err;
         advance(parser);
         
         /* Expect colon */
         if (!match(parser, FLUX_TOKEN_COLON)) {
             set_error(parser, "Expected ':' after key");
-            *err = CROUS_ERR_DECODE;
-            free(key_buf);
-            crous_value_free_tree(record);
-            return NULL;
+            return CROUS_ERR_DECODE;
         }
         
         /* Parse value */
-        crous_value *val = parse_value(parser, err);
-        if (*err != CROUS_OK) {
-            free(key_buf);
-            crous_value_free_tree(record);
-            return NULL;
-        }
-        
-        /* Add to dict */
-        if (crous_value_dict_set_binary(record, key_buf, key_len, val) != CROUS_OK) {
-            *err = CROUS_ERR_OOM;
-            free(key_buf);
-            crous_value_free_tree(record);
-            crous_value_free_tree(val);
-            return NULL;
-        }
-        free(key_buf);
+        err = parse_value(parser, vis, ctx);
+        if (err != CROUS_OK) return err;
+        count++;
         
         /* Consume newline */
         if (parser->current_token->type == FLUX_TOKEN_NEWLINE) {
@@ -203,16 +182,10 @@ static crous_value* parse_record(flux_parser_t *parser, crous_err_t *err) {
         }
     }
     
-    return record;
+    return crous_visit_end(vis, ctx, CROUS_TYPE_DICT, count);
 }
 
-static crous_value* parse_array(flux_parser_t *parser, crous_err_t *err) {
-    crous_value *array = crous_value_new_list(0);
-    if (!array) {
-        *err = CROUS_ERR_OOM;
-        return NULL;
-    }
-    
+static crous_err_t parse_array(flux_parser_t *parser, const crous_visitor *vis, void *ctx) {
     /* Skip type hint if present */
     if (match(parser, FLUX_TOKEN_LBRACKET)) {
         /* Type hint like [int], [string], [record], etc. */
@@ -221,9 +194,7 @@ static crous_value* parse_array(flux_parser_t *parser, crous_err_t *err) {
         }
         if (!match(parser, FLUX_TOKEN_RBRACKET)) {
             set_error(parser, "Expected ']'");
-            *err = CROUS_ERR_DECODE;
-            crous_value_free_tree(array);
-            return NULL;
+            return CROUS_ERR_DECODE;
         }
     }
     
@@ -235,12 +206,14 @@ static crous_value* parse_array(flux_parser_t *parser, crous_err_t *err) {
     /* Expect indent */
     if (parser->current_token->type != FLUX_TOKEN_INDENT) {
         set_error(parser, "Expected indented array elements");
-        *err = CROUS_ERR_DECODE;
-        crous_value_free_tree(array);
-        return NULL;
+        return CROUS_ERR_DECODE;
     }
     advance(parser);
     
+    crous_err_t err = crous_visit_begin(vis, ctx, CROUS_TYPE_LIST, CROUS_VISIT_COUNT_UNKNOWN);
+    if (err != CROUS_OK) return err;
+    size_t count = 0;
+    
     /* Parse array elements */
     while (parser->current_token->type != FLUX_TOKEN_DEDENT &&
            parser->current_token->type != FLUX_TOKEN_EOF) {
@@ -250,18 +223,9 @@ static crous_value* parse_array(flux_parser_t *parser, crous_err_t *err) {
             continue;
         }
         
-        crous_value *elem = parse_scalar(parser, err);
-        if (*err != CROUS_OK) {
-            crous_value_free_tree(array);
-            return NULL;
-        }
-        
-        if (crous_value_list_append(array, elem) != CROUS_OK) {
-            *err = CROUS_ERR_OOM;
-            crous_value_free_tree(array);
-            crous_value_free_tree(elem);
-            return NULL;
-        }
+        err = parse_scalar(parser, vis, ctx);
+        if (err != CROUS_OK) return err;
+        count++;
         
         /* Consume newline */
         if (parser->current_token->type == FLUX_TOKEN_NEWLINE) {
@@ -272,29 +236,26 @@ static crous_value* parse_array(flux_parser_t *parser, crous_err_t *err) {
     /* Expect dedent */
     if (!match(parser, FLUX_TOKEN_DEDENT)) {
         set_error(parser, "Expected dedent");
-        *err = CROUS_ERR_DECODE;
-        crous_value_free_tree(array);
-        return NULL;
+        return CROUS_ERR_DECODE;
     }
     
-    return array;
+    return crous_visit_end(vis, ctx, CROUS_TYPE_LIST, count);
 }
 
-static crous_value* parse_value(flux_parser_t *parser, crous_err_t *err) {
+static crous_err_t parse_value(flux_parser_t *parser, const crous_visitor *vis, void *ctx) {
     /* Peek ahead for array detection */
     if (parser->current_token->type == FLUX_TOKEN_LBRACKET) {
-        return parse_array(parser, err);
+        return parse_array(parser, vis, ctx);
     }
     
     /* Try to parse as scalar */
-    return parse_scalar(parser, err);
+    return parse_scalar(parser, vis, ctx);
 }
 
-crous_err_t flux_parse(flux_parser_t *parser, crous_value **out_value) {
-    crous_err_t err = CROUS_OK;
-    crous_value *root = NULL;
+crous_err_t flux_parse_visit(flux_parser_t *parser, const crous_visitor *visitor, void *ctx) {
+    crous_err_t err;
     
-    if (!parser || !out_value) {
+    if (!parser || !visitor) {
         return CROUS_ERR_INVALID_TYPE;
     }
     
@@ -306,16 +267,19 @@ crous_err_t flux_parse(flux_parser_t *parser, crous_value **out_value) {
     /* Parse root structure */
     if (parser->current_token->type == FLUX_TOKEN_EOF) {
         /* Empty document */
-        root = crous_value_new_null();
+        crous_value null_value;
+        null_value.type = CROUS_TYPE_NULL;
+        null_value.flags = 0;
+        err = crous_visit_scalar(visitor, ctx, &null_value);
     } else if (parser->current_token->type == FLUX_TOKEN_KEY) {
         /* Root is a record */
-        root = parse_record(parser, &err);
+        err = parse_record(parser, visitor, ctx);
     } else {
         /* Root is a single value */
-        root = parse_value(parser, &err);
+        err = parse_value(parser, visitor, ctx);
     }
     
-    if (err != CROUS_OK || !root) {
+    if (err != CROUS_OK) {
         return err;
     }
     
@@ -326,10 +290,25 @@ crous_err_t flux_parse(flux_parser_t *parser, crous_value **out_value) {
     
     if (parser->current_token->type != FLUX_TOKEN_EOF) {
         set_error(parser, "Unexpected token after document");
-        crous_value_free_tree(root);
         return CROUS_ERR_DECODE;
     }
     
-    *out_value = root;
     return CROUS_OK;
 }
+
+crous_err_t flux_parse(flux_parser_t *parser, crous_value **out_value) {
+    if (!parser || !out_value) {
+        return CROUS_ERR_INVALID_TYPE;
+    }
+    
+    crous_builder *builder = NULL;
+    crous_err_t err = crous_builder_new(&builder);
+    if (err != CROUS_OK) return err;
+    
+    err = flux_parse_visit(parser, crous_builder_visitor(), builder);
+    if (err != CROUS_OK) {
+        crous_builder_free(builder);
+        return err;
+    }
+    return crous_builder_finish(builder, out_value);
+}
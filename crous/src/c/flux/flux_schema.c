@@ -0,0 +1,637 @@
+#include "../include/crous_flux.h"
+#include "../include/crous_value.h"
+#include "../include/crous_version.h"
+#include "../include/crous_varint.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+   SCHEMA OBJECT
+   ============================================================================ */
+
+#define SCHEMA_FEATURES (FLUX_FEATURE_REQUIRED | CROUS_FEATURE_SCHEMA)
+
+struct flux_schema {
+    uint32_t id;
+    flux_schema_node_t *nodes;
+    size_t count;
+    char *names;            /* Every field name's bytes, back to back */
+};
+
+/* ============================================================================
+   SCHEMA TEXT
+   ============================================================================ */
+
+typedef struct {
+    const char *p;
+    const char *end;
+    flux_schema_node_t *nodes;
+    size_t count;
+    size_t cap;
+    size_t *name_offs;      /* Per node, into names; names move as they grow */
+    char *names;
+    size_t names_len;
+    size_t names_cap;
+} schema_parser_t;
+
+static void parse_space(schema_parser_t *ps) {
+    while (ps->p < ps->end && (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r')) ps->p++;
+}
+
+/* Skip whitespace, then take c if it is next */
+static int parse_take(schema_parser_t *ps, char c) {
+    parse_space(ps);
+    if (ps->p < ps->end && *ps->p == c) {
+        ps->p++;
+        return 1;
+    }
+    return 0;
+}
+
+static int is_name_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static crous_err_t parse_push(schema_parser_t *ps, uint8_t kind, size_t *out_index) {
+    if (ps->count == ps->cap) {
+        size_t cap = ps->cap ? ps->cap * 2 : 16;
+        flux_schema_node_t *nodes = realloc(ps->nodes, cap * sizeof(*nodes));
+        if (!nodes) return CROUS_ERR_OOM;
+        ps->nodes = nodes;
+        size_t *offs = realloc(ps->name_offs, cap * sizeof(*offs));
+        if (!offs) return CROUS_ERR_OOM;
+        ps->name_offs = offs;
+        ps->cap = cap;
+    }
+    if (ps->count >= UINT32_MAX) return CROUS_ERR_OVERFLOW;
+
+    flux_schema_node_t *n = &ps->nodes[ps->count];
+    memset(n, 0, sizeof(*n));
+    n->kind = kind;
+    ps->name_offs[ps->count] = (size_t)-1;
+    *out_index = ps->count++;
+    return CROUS_OK;
+}
+
+static crous_err_t names_append(schema_parser_t *ps, char c) {
+    if (ps->names_len == ps->names_cap) {
+        size_t cap = ps->names_cap ? ps->names_cap * 2 : 64;
+        char *names = realloc(ps->names, cap);
+        if (!names) return CROUS_ERR_OOM;
+        ps->names = names;
+        ps->names_cap = cap;
+    }
+    ps->names[ps->names_len++] = c;
+    return CROUS_OK;
+}
+
+/* A field name, bare or quoted, onto the end of names */
+static crous_err_t parse_name(schema_parser_t *ps, size_t *out_off, size_t *out_len) {
+    crous_err_t err;
+    size_t start = ps->names_len;
+
+    parse_space(ps);
+    if (ps->p < ps->end && *ps->p == '"') {
+        ps->p++;
+        for (;;) {
+            if (ps->p == ps->end) return CROUS_ERR_SYNTAX;
+            char c = *ps->p++;
+            if (c == '"') break;
+            if (c == '\\') {
+                if (ps->p == ps->end || (*ps->p != '"' && *ps->p != '\\')) return CROUS_ERR_SYNTAX;
+                c = *ps->p++;
+            }
+            if ((err = names_append(ps, c)) != CROUS_OK) return err;
+        }
+    } else {
+        while (ps->p < ps->end && is_name_char(*ps->p)) {
+            if ((err = names_append(ps, *ps->p++)) != CROUS_OK) return err;
+        }
+        if (ps->names_len == start) return CROUS_ERR_SYNTAX;
+    }
+    if (ps->names_len - start > CROUS_MAX_STRING_BYTES) return CROUS_ERR_OVERFLOW;
+
+    *out_off = start;
+    *out_len = ps->names_len - start;
+    return CROUS_OK;
+}
+
+static int parse_word(schema_parser_t *ps, const char *word) {
+    size_t len = strlen(word);
+    if ((size_t)(ps->end - ps->p) < len || memcmp(ps->p, word, len) != 0) return 0;
+    if ((size_t)(ps->end - ps->p) > len && is_name_char(ps->p[len])) return 0;
+    ps->p += len;
+    return 1;
+}
+
+static crous_err_t parse_type(schema_parser_t *ps, int depth, size_t *out_index);
+
+static crous_err_t parse_record(schema_parser_t *ps, size_t index, int depth) {
+    if (parse_take(ps, '}')) return CROUS_OK;
+
+    for (;;) {
+        size_t off, len, field;
+        crous_err_t err = parse_name(ps, &off, &len);
+        if (err != CROUS_OK) return err;
+        if (!parse_take(ps, ':')) return CROUS_ERR_SYNTAX;
+        if ((err = parse_type(ps, depth + 1, &field)) != CROUS_OK) return err;
+
+        /* Positions, not names, identify fields on the wire, but a record
+           must still be a dict that can hold every one of them */
+        for (size_t i = index + 1; i < field; i = ps->nodes[i].end) {
+            if (ps->nodes[i].name_len == len && memcmp(ps->names + ps->name_offs[i], ps->names + off, len) == 0)
+                return CROUS_ERR_SYNTAX;
+        }
+        ps->name_offs[field] = off;
+        ps->nodes[field].name_len = len;
+        if (ps->nodes[index].count == UINT32_MAX) return CROUS_ERR_OVERFLOW;
+        ps->nodes[index].count++;
+
+        if (parse_take(ps, '}')) return CROUS_OK;
+        if (!parse_take(ps, ',')) return CROUS_ERR_SYNTAX;
+    }
+}
+
+/* Types nest at most FLUX_SCHEMA_MAX_DEPTH deep, which bounds the recursion */
+static crous_err_t parse_type(schema_parser_t *ps, int depth, size_t *out_index) {
+    if (depth >= FLUX_SCHEMA_MAX_DEPTH) return CROUS_ERR_DEPTH_EXCEEDED;
+
+    static const struct {
+        const char *word;
+        uint8_t kind;
+    } words[] = {
+        { "bool", FLUX_SCHEMA_BOOL }, { "int", FLUX_SCHEMA_INT }, { "float", FLUX_SCHEMA_FLOAT },
+        { "str", FLUX_SCHEMA_STRING }, { "bytes", FLUX_SCHEMA_BYTES }, { "any", FLUX_SCHEMA_ANY },
+    };
+
+    crous_err_t err;
+    size_t index;
+    parse_space(ps);
+    if (parse_take(ps, '[')) {
+        size_t elem;
+        if ((err = parse_push(ps, FLUX_SCHEMA_LIST, &index)) != CROUS_OK) return err;
+        if ((err = parse_type(ps, depth + 1, &elem)) != CROUS_OK) return err;
+        if (!parse_take(ps, ']')) return CROUS_ERR_SYNTAX;
+    } else if (parse_take(ps, '{')) {
+        if ((err = parse_push(ps, FLUX_SCHEMA_RECORD, &index)) != CROUS_OK) return err;
+        if ((err = parse_record(ps, index, depth)) != CROUS_OK) return err;
+    } else {
+        size_t i = 0;
+        while (i < sizeof(words) / sizeof(words[0]) && !parse_word(ps, words[i].word)) i++;
+        if (i == sizeof(words) / sizeof(words[0])) return CROUS_ERR_SYNTAX;
+        if ((err = parse_push(ps, words[i].kind, &index)) != CROUS_OK) return err;
+    }
+
+    /* any already takes null */
+    if (parse_take(ps, '?') && ps->nodes[index].kind != FLUX_SCHEMA_ANY) ps->nodes[index].nullable = 1;
+    ps->nodes[index].end = (uint32_t)ps->count;
+    *out_index = index;
+    return CROUS_OK;
+}
+
+crous_err_t flux_schema_new(uint32_t id, const char *spec, size_t spec_len, flux_schema_t **out_schema) {
+    if (!out_schema || !spec) return CROUS_ERR_INVALID_TYPE;
+    if (id == 0 || id > FLUX_SCHEMA_ID_MAX) return CROUS_ERR_INVALID_TYPE;
+
+    schema_parser_t ps = { spec, spec + spec_len, NULL, 0, 0, NULL, NULL, 0, 0 };
+    size_t root;
+    crous_err_t err = parse_type(&ps, 0, &root);
+    parse_space(&ps);
+    if (err == CROUS_OK && ps.p != ps.end) err = CROUS_ERR_SYNTAX;
+
+    flux_schema_t *schema = NULL;
+    if (err == CROUS_OK && !(schema = calloc(1, sizeof(*schema)))) err = CROUS_ERR_OOM;
+    if (err != CROUS_OK) {
+        free(ps.nodes);
+        free(ps.name_offs);
+        free(ps.names);
+        return err;
+    }
+
+    /* Names stopped moving: point the nodes into them */
+    for (size_t i = 0; i < ps.count; i++) {
+        if (ps.name_offs[i] != (size_t)-1) ps.nodes[i].name = ps.names + ps.name_offs[i];
+    }
+    free(ps.name_offs);
+
+    schema->id = id;
+    schema->nodes = ps.nodes;
+    schema->count = ps.count;
+    schema->names = ps.names;
+    *out_schema = schema;
+    return CROUS_OK;
+}
+
+void flux_schema_free(flux_schema_t *schema) {
+    if (!schema) return;
+    free(schema->nodes);
+    free(schema->names);
+    free(schema);
+}
+
+uint32_t flux_schema_id(const flux_schema_t *schema) {
+    return schema ? schema->id : 0;
+}
+
+const flux_schema_node_t *flux_schema_nodes(const flux_schema_t *schema, size_t *out_count) {
+    if (out_count) *out_count = schema ? schema->count : 0;
+    return schema ? schema->nodes : NULL;
+}
+
+/* ============================================================================
+   HEADER
+   ============================================================================ */
+
+void flux_schema_put_header(const flux_schema_t *schema, uint8_t *p) {
+    uint32_t id = schema->id;
+    p[0] = FLUX_MAGIC_0;
+    p[1] = FLUX_MAGIC_1;
+    p[2] = FLUX_MAGIC_2;
+    p[3] = FLUX_MAGIC_3;
+    p[4] = FLUX_VERSION;
+    p[5] = FLUX_FLAG_EXTENDED;
+    p[6] = (uint8_t)(SCHEMA_FEATURES >> 8);
+    p[7] = (uint8_t)SCHEMA_FEATURES;
+    p[8] = 0;
+    p[9] = (uint8_t)id;
+    p[10] = (uint8_t)(id >> 8);
+    p[11] = (uint8_t)(id >> 16);
+}
+
+crous_err_t flux_schema_check_header(const flux_schema_t *schema, const uint8_t *buf, size_t buf_size) {
+    if (!schema || !buf) return CROUS_ERR_INVALID_TYPE;
+    if (buf_size < FLUX_SCHEMA_HEADER_SIZE) return CROUS_ERR_TRUNCATED;
+
+    /* Only the schema feature is understood alongside a schema */
+    uint8_t expect[FLUX_SCHEMA_HEADER_SIZE];
+    flux_schema_put_header(schema, expect);
+    return memcmp(buf, expect, FLUX_SCHEMA_HEADER_SIZE) == 0 ? CROUS_OK : CROUS_ERR_INVALID_HEADER;
+}
+
+int flux_binary_schema_id(const uint8_t *buf, size_t buf_size, uint32_t *out_id) {
+    if (!buf || buf_size < FLUX_SCHEMA_HEADER_SIZE ||
+        buf[0] != FLUX_MAGIC_0 || buf[1] != FLUX_MAGIC_1 ||
+        buf[2] != FLUX_MAGIC_2 || buf[3] != FLUX_MAGIC_3 ||
+        !(buf[5] & FLUX_FLAG_EXTENDED) ||
+        !((((unsigned)buf[6] << 8) | buf[7]) & CROUS_FEATURE_SCHEMA)) {
+        return 0;
+    }
+    if (out_id) *out_id = (uint32_t)buf[9] | ((uint32_t)buf[10] << 8) | ((uint32_t)buf[11] << 16);
+    return 1;
+}
+
+/* ============================================================================
+   ENCODER
+   ============================================================================ */
+
+typedef struct {
+    const flux_schema_node_t *nodes;
+    uint8_t *buf;
+    size_t pos;
+    size_t cap;
+} schema_writer_t;
+
+static crous_err_t writer_room(schema_writer_t *w, size_t len) {
+    if (len <= w->cap - w->pos) return CROUS_OK;
+
+    size_t cap = w->cap ? w->cap * 2 : 256;
+    while (cap - w->pos < len) {
+        if (cap > (size_t)-1 / 2) return CROUS_ERR_OOM;
+        cap *= 2;
+    }
+    uint8_t *buf = realloc(w->buf, cap);
+    if (!buf) return CROUS_ERR_OOM;
+    w->buf = buf;
+    w->cap = cap;
+    return CROUS_OK;
+}
+
+static crous_err_t writer_varint(schema_writer_t *w, uint64_t val) {
+    crous_err_t err = writer_room(w, CROUS_VARINT_MAX);
+    if (err != CROUS_OK) return err;
+    w->pos = (size_t)(crous_varint_put(w->buf + w->pos, val) - w->buf);
+    return CROUS_OK;
+}
+
+static crous_err_t writer_span(schema_writer_t *w, const void *data, size_t len) {
+    crous_err_t err = writer_varint(w, len);
+    if (err == CROUS_OK) err = writer_room(w, len);
+    if (err != CROUS_OK) return err;
+    if (len) memcpy(w->buf + w->pos, data, len);
+    w->pos += len;
+    return CROUS_OK;
+}
+
+static crous_err_t writer_float(schema_writer_t *w, double f) {
+    crous_err_t err = writer_room(w, 8);
+    if (err != CROUS_OK) return err;
+    memcpy(w->buf + w->pos, &f, 8);
+    w->pos += 8;
+    return CROUS_OK;
+}
+
+/* A packed array as a list of its element node's kind */
+static crous_err_t encode_array(schema_writer_t *w, const flux_schema_node_t *elem, const crous_value *v) {
+    size_t len = v->data.array.len;
+    crous_err_t err = writer_varint(w, len);
+    for (size_t i = 0; i < len && err == CROUS_OK; i++) {
+        if (elem->nullable) {
+            if ((err = writer_room(w, 1)) != CROUS_OK) break;
+            w->buf[w->pos++] = 1;
+        }
+        if (elem->kind == FLUX_SCHEMA_INT)
+            err = writer_varint(w, crous_zigzag_encode(((const int64_t *)v->data.array.data)[i]));
+        else
+            err = writer_float(w, ((const double *)v->data.array.data)[i]);
+    }
+    return err;
+}
+
+/* Schemas nest at most FLUX_SCHEMA_MAX_DEPTH deep, which bounds the recursion */
+static crous_err_t encode_node(schema_writer_t *w, size_t index, const crous_value *v) {
+    const flux_schema_node_t *n = &w->nodes[index];
+    crous_err_t err;
+
+    if (!v) return CROUS_ERR_INVALID_TYPE;
+    crous_type_t type = v->type;
+    if (n->nullable) {
+        if ((err = writer_room(w, 1)) != CROUS_OK) return err;
+        w->buf[w->pos++] = type != CROUS_TYPE_NULL;
+        if (type == CROUS_TYPE_NULL) return CROUS_OK;
+    }
+
+    switch (n->kind) {
+        case FLUX_SCHEMA_BOOL:
+            if (type != CROUS_TYPE_BOOL) return CROUS_ERR_INVALID_TYPE;
+            if ((err = writer_room(w, 1)) != CROUS_OK) return err;
+            w->buf[w->pos++] = v->data.b ? 1 : 0;
+            return CROUS_OK;
+
+        case FLUX_SCHEMA_INT:
+            if (type != CROUS_TYPE_INT) return CROUS_ERR_INVALID_TYPE;
+            return writer_varint(w, crous_zigzag_encode(v->data.i));
+
+        case FLUX_SCHEMA_FLOAT:
+            if (type != CROUS_TYPE_FLOAT) return CROUS_ERR_INVALID_TYPE;
+            return writer_float(w, v->data.f);
+
+        case FLUX_SCHEMA_STRING:
+        case FLUX_SCHEMA_BYTES:
+            if (type != (n->kind == FLUX_SCHEMA_STRING ? CROUS_TYPE_STRING : CROUS_TYPE_BYTES))
+                return CROUS_ERR_INVALID_TYPE;
+            return writer_span(w, v->data.s.data, v->data.s.len);
+
+        case FLUX_SCHEMA_ANY:
+            return flux_value_append(v, 0, &w->buf, &w->pos, &w->cap);
+
+        case FLUX_SCHEMA_LIST: {
+            const flux_schema_node_t *elem = &w->nodes[index + 1];
+            if ((type == CROUS_TYPE_I64_ARRAY && elem->kind == FLUX_SCHEMA_INT) ||
+                (type == CROUS_TYPE_F64_ARRAY && elem->kind == FLUX_SCHEMA_FLOAT)) {
+                return encode_array(w, elem, v);
+            }
+            if (type != CROUS_TYPE_LIST && type != CROUS_TYPE_TUPLE) return CROUS_ERR_INVALID_TYPE;
+
+            if ((err = writer_varint(w, v->data.list.len)) != CROUS_OK) return err;
+            for (size_t i = 0; i < v->data.list.len; i++) {
+                if ((err = encode_node(w, index + 1, v->data.list.items[i])) != CROUS_OK) return err;
+            }
+            return CROUS_OK;
+        }
+
+        case FLUX_SCHEMA_RECORD: {
+            if (type != CROUS_TYPE_DICT || v->data.dict.len != n->count) return CROUS_ERR_INVALID_TYPE;
+
+            /* Dicts built in field order find each field where it is expected */
+            size_t i = 0;
+            for (size_t f = index + 1; f < n->end; f = w->nodes[f].end, i++) {
+                const flux_schema_node_t *field = &w->nodes[f];
+                const crous_dict_entry *e = &v->data.dict.entries[i];
+                const crous_value *fv = e->key_len == field->name_len &&
+                                        memcmp(e->key, field->name, field->name_len) == 0
+                    ? e->value
+                    : crous_value_dict_get_binary(v, field->name, field->name_len);
+                if (!fv) return CROUS_ERR_INVALID_TYPE;
+                if ((err = encode_node(w, f, fv)) != CROUS_OK) return err;
+            }
+            return CROUS_OK;
+        }
+    }
+    return CROUS_ERR_INTERNAL;
+}
+
+crous_err_t flux_schema_encode(const flux_schema_t *schema, const crous_value *value,
+                               uint8_t **out_buf, size_t *out_size) {
+    if (!schema || !value || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+
+    schema_writer_t w = { schema->nodes, NULL, 0, 0 };
+    crous_err_t err = writer_room(&w, FLUX_SCHEMA_HEADER_SIZE);
+    if (err == CROUS_OK) {
+        flux_schema_put_header(schema, w.buf);
+        w.pos = FLUX_SCHEMA_HEADER_SIZE;
+        err = encode_node(&w, 0, value);
+    }
+    if (err != CROUS_OK) {
+        free(w.buf);
+        return err;
+    }
+
+    *out_buf = w.buf;
+    *out_size = w.pos;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   DECODER
+   ============================================================================ */
+
+typedef struct {
+    const flux_schema_node_t *nodes;
+    const uint8_t *buf;
+    size_t pos;
+    size_t len;
+    crous_arena *arena;     /* NULL = heap-allocated tree */
+} schema_reader_t;
+
+static crous_err_t reader_varint(schema_reader_t *r, uint64_t *out) {
+    size_t used;
+    crous_err_t err = crous_varint_get(r->buf + r->pos, r->len - r->pos, out, &used);
+    if (err == CROUS_OK) r->pos += used;
+    return err;
+}
+
+static crous_err_t decode_node(schema_reader_t *r, size_t index, crous_value **out) {
+    const flux_schema_node_t *n = &r->nodes[index];
+    crous_value *v = NULL;
+    crous_err_t err;
+    uint64_t u;
+
+    if (n->nullable) {
+        if (r->pos == r->len) return CROUS_ERR_TRUNCATED;
+        uint8_t present = r->buf[r->pos++];
+        if (present > 1) return CROUS_ERR_DECODE;
+        if (!present) {
+            *out = crous_value_new_null_arena(r->arena);
+            return *out ? CROUS_OK : CROUS_ERR_OOM;
+        }
+    }
+
+    switch (n->kind) {
+        case FLUX_SCHEMA_BOOL:
+            if (r->pos == r->len) return CROUS_ERR_TRUNCATED;
+            if (r->buf[r->pos] > 1) return CROUS_ERR_DECODE;
+            v = crous_value_new_bool_arena(r->arena, r->buf[r->pos++]);
+            break;
+
+        case FLUX_SCHEMA_INT:
+            if ((err = reader_varint(r, &u)) != CROUS_OK) return err;
+            v = crous_value_new_int_arena(r->arena, crous_zigzag_decode(u));
+            break;
+
+        case FLUX_SCHEMA_FLOAT: {
+            double f;
+            if (r->len - r->pos < 8) return CROUS_ERR_TRUNCATED;
+            memcpy(&f, r->buf + r->pos, 8);
+            r->pos += 8;
+            v = crous_value_new_float_arena(r->arena, f);
+            break;
+        }
+
+        case FLUX_SCHEMA_STRING:
+        case FLUX_SCHEMA_BYTES:
+            if ((err = reader_varint(r, &u)) != CROUS_OK) return err;
+            if (u > CROUS_MAX_STRING_BYTES) return CROUS_ERR_DECODE;
+            if (u > r->len - r->pos) return CROUS_ERR_TRUNCATED;
+            v = n->kind == FLUX_SCHEMA_STRING
+                ? crous_value_new_string_arena(r->arena, (const char *)r->buf + r->pos, (size_t)u)
+                : crous_value_new_bytes_arena(r->arena, r->buf + r->pos, (size_t)u);
+            r->pos += (size_t)u;
+            break;
+
+        case FLUX_SCHEMA_ANY:
+            return flux_value_read(r->buf, r->len, &r->pos, r->arena, 0, out);
+
+        case FLUX_SCHEMA_LIST: {
+            if ((err = reader_varint(r, &u)) != CROUS_OK) return err;
+            if (u > CROUS_MAX_LIST_SIZE) return CROUS_ERR_DECODE;
+
+            /* Empty records take no bytes, so the count alone bounds them */
+            size_t count = (size_t)u;
+            size_t reserve = count < r->len - r->pos ? count : r->len - r->pos;
+            v = crous_value_new_list_arena(r->arena, reserve);
+            if (!v) return CROUS_ERR_OOM;
+            for (size_t i = 0; i < count; i++) {
+                crous_value *item;
+                err = decode_node(r, index + 1, &item);
+                if (err == CROUS_OK && (err = crous_value_list_append(v, item)) != CROUS_OK)
+                    crous_value_free_tree(item);
+                if (err != CROUS_OK) {
+                    crous_value_free_tree(v);
+                    return err;
+                }
+            }
+            break;
+        }
+
+        case FLUX_SCHEMA_RECORD:
+            v = crous_value_new_dict_arena(r->arena, n->count);
+            if (!v) return CROUS_ERR_OOM;
+            for (size_t f = index + 1; f < n->end; f = r->nodes[f].end) {
+                crous_value *fv;
+                err = decode_node(r, f, &fv);
+                if (err == CROUS_OK &&
+                    (err = crous_value_dict_append_arena(r->arena, v, r->nodes[f].name, r->nodes[f].name_len, fv)) != CROUS_OK)
+                    crous_value_free_tree(fv);
+                if (err != CROUS_OK) {
+                    crous_value_free_tree(v);
+                    return err;
+                }
+            }
+            break;
+
+        default:
+            return CROUS_ERR_INTERNAL;
+    }
+
+    if (!v) return CROUS_ERR_OOM;
+    *out = v;
+    return CROUS_OK;
+}
+
+crous_err_t flux_schema_decode(const flux_schema_t *schema, const uint8_t *buf, size_t buf_size,
+                               crous_arena *arena, crous_value **out_value) {
+    if (!schema || !buf || !out_value) return CROUS_ERR_INVALID_TYPE;
+
+    crous_err_t err = flux_schema_check_header(schema, buf, buf_size);
+    if (err != CROUS_OK) return err;
+
+    schema_reader_t r = { schema->nodes, buf, FLUX_SCHEMA_HEADER_SIZE, buf_size, arena };
+    crous_value *value;
+    err = decode_node(&r, 0, &value);
+    if (err != CROUS_OK) return err;
+
+    /* Bytes left over mean the writer's schema was another one */
+    if (r.pos != buf_size) {
+        crous_value_free_tree(value);
+        return CROUS_ERR_DECODE;
+    }
+    *out_value = value;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   PROCESS REGISTRY
+   ============================================================================ */
+
+/* As the dictionary registry: slots only go from empty to set */
+static flux_schema_t *g_registry[FLUX_SCHEMA_REGISTRY_SIZE];
+
+#if defined(__GNUC__)
+#  define SLOT_LOAD(i) __atomic_load_n(&g_registry[i], __ATOMIC_ACQUIRE)
+#else
+#  define SLOT_LOAD(i) (g_registry[i])
+#endif
+
+/* Set slot i to schema if it is still empty */
+static int slot_claim(size_t i, flux_schema_t *schema) {
+#if defined(__GNUC__)
+    flux_schema_t *empty = NULL;
+    return __atomic_compare_exchange_n(&g_registry[i], &empty, schema, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#else
+    if (g_registry[i]) return 0;
+    g_registry[i] = schema;
+    return 1;
+#endif
+}
+
+static size_t registry_home(uint32_t id) {
+    return (size_t)((id * 2654435761u) % FLUX_SCHEMA_REGISTRY_SIZE);
+}
+
+crous_err_t flux_schema_register(flux_schema_t *schema) {
+    if (!schema) return CROUS_ERR_INVALID_TYPE;
+
+    size_t home = registry_home(schema->id);
+    for (size_t n = 0; n < FLUX_SCHEMA_REGISTRY_SIZE; n++) {
+        size_t i = (home + n) % FLUX_SCHEMA_REGISTRY_SIZE;
+        for (;;) {
+            flux_schema_t *seen = SLOT_LOAD(i);
+            if (seen) {
+                if (seen->id == schema->id) return CROUS_ERR_INVALID_TYPE;
+                break;
+            }
+            if (slot_claim(i, schema)) return CROUS_OK;
+        }
+    }
+    return CROUS_ERR_OVERFLOW;
+}
+
+const flux_schema_t *flux_schema_lookup(uint32_t id) {
+    size_t home = registry_home(id);
+    for (size_t n = 0; n < FLUX_SCHEMA_REGISTRY_SIZE; n++) {
+        flux_schema_t *seen = SLOT_LOAD((home + n) % FLUX_SCHEMA_REGISTRY_SIZE);
+        if (!seen) return NULL;
+        if (seen->id == id) return seen;
+    }
+    return NULL;
+}
@@ -1,5 +1,11 @@
 #include "../include/crous_flux.h"
 #include "../include/crous_value.h"
+#include "../include/crous_scan.h"
+#include "../include/crous_varint.h"
+#include "../include/crous_parallel.h"
+#include "../include/crous_stats.h"
+#include "../include/crous_stack.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -39,13 +45,7 @@ static crous_err_t serialize_string(flux_text_context_t *ctx, const crous_value
     const char *data = crous_value_get_string(v, &len);
     
     /* Check if quoting is needed */
-    int needs_quotes = 0;
-    for (size_t i = 0; i < len; i++) {
-        if (isspace((unsigned char)data[i]) || strchr(":@[]#\"'", data[i])) {
-            needs_quotes = 1;
-            break;
-        }
-    }
+    int needs_quotes = crous_scan_cspan(data, len, CROUS_CHAR_SPECIAL) < len;
     
     if (needs_quotes) {
         if (write_text(ctx->out, "\"", 1) != CROUS_OK) return CROUS_ERR_STREAM;
@@ -105,6 +105,30 @@ static crous_err_t serialize_array_text(flux_text_context_t *ctx, const crous_va
     return CROUS_OK;
 }
 
+/* Packed arrays read back as plain lists: text has no typed array syntax */
+static crous_err_t serialize_packed_text(flux_text_context_t *ctx, const crous_value *v) {
+    const crous_array_t *a = &v->data.array;
+    
+    if (write_text(ctx->out, "[item]\n", 7) != CROUS_OK) return CROUS_ERR_STREAM;
+    ctx->indent_level++;
+    
+    for (size_t i = 0; i < a->len; i++) {
+        char buf[32];
+        int len;
+        if (v->type == CROUS_TYPE_I64_ARRAY)
+            len = snprintf(buf, sizeof(buf), "%lld", (long long)((const int64_t *)a->data)[i]);
+        else
+            len = snprintf(buf, sizeof(buf), "%.17g", ((const double *)a->data)[i]);
+        
+        if (write_indent(ctx) != CROUS_OK) return CROUS_ERR_STREAM;
+        if (write_text(ctx->out, buf, len) != CROUS_OK) return CROUS_ERR_STREAM;
+        if (write_text(ctx->out, "\n", 1) != CROUS_OK) return CROUS_ERR_STREAM;
+    }
+    
+    ctx->indent_level--;
+    return CROUS_OK;
+}
+
 static crous_err_t serialize_value_text(flux_text_context_t *ctx, const crous_value *v) {
     if (!v) return CROUS_ERR_INVALID_TYPE;
     
@@ -164,6 +188,10 @@ static crous_err_t serialize_value_text(flux_text_context_t *ctx, const crous_va
         case CROUS_TYPE_DICT:
             return serialize_record_text(ctx, v);
         
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY:
+            return serialize_packed_text(ctx, v);
+        
         default:
             return CROUS_ERR_INVALID_TYPE;
     }
@@ -173,15 +201,243 @@ static crous_err_t serialize_value_text(flux_text_context_t *ctx, const crous_va
    FLUX BINARY SERIALIZER
    ============================================================================ */
 
+/*
+ * Binary writer. With out set, buf is a fixed block that is flushed to the
+ * stream whenever it fills, so serialization and I/O overlap and memory
+ * stays at one block. With out NULL, buf is the output itself: growable,
+ * or of exact fixed capacity when sized up front by flux_encoded_size().
+ */
+/*
+ * Wire v3 key table, encoder side: open-addressed map from key bytes to
+ * table index. Keys point into the value tree being encoded.
+ */
+typedef struct {
+    const char *key;        /* NULL = empty slot */
+    size_t key_len;
+    uint32_t index;
+} flux_key_slot_t;
+
+typedef struct {
+    flux_key_slot_t *slots;
+    size_t cap;             /* Power of two, kept at least twice count */
+    size_t count;
+    size_t base;            /* Indices below this are the dictionary's keys */
+} flux_key_index_t;
+
+/*
+ * Wire v5 shared values, encoder side. A first pass hashes every subtree
+ * and files each candidate under the class of values equal to it. A dry
+ * run of the writer then counts the occurrences of each class it reaches,
+ * not going into the second and later ones, which the real run writes as
+ * references. Classes reached twice or more are shared.
+ */
+typedef struct {
+    const crous_value *v;   /* First member */
+    uint64_t hash;
+    int height;
+    uint32_t count;         /* Occurrences the writer reaches */
+    uint32_t index;         /* Shared value index + 1 once written, 0 before */
+} flux_share_class_t;
+
+typedef struct {
+    const crous_value *v;   /* NULL = empty slot */
+    uint32_t cls;
+} flux_share_node_t;
+
+typedef struct {
+    flux_share_class_t *classes;
+    size_t class_count;
+    size_t class_cap;
+    uint32_t *class_slots;  /* Open addressed by hash: class + 1, 0 = empty */
+    size_t class_slot_cap;  /* Power of two, kept at least twice class_count */
+    flux_share_node_t *nodes;   /* Open addressed by node address */
+    size_t node_count;
+    size_t node_cap;        /* Power of two, kept at least twice node_count */
+    int counting;           /* Dry run: count, write nothing that is kept */
+    uint32_t next_index;
+} flux_share_index_t;
+
+static void share_index_free(flux_share_index_t *s) {
+    free(s->classes);
+    free(s->class_slots);
+    free(s->nodes);
+}
+
+/* Values worth a back-reference: a REF takes two or three bytes */
+static int share_candidate(const crous_value *v) {
+    switch (v->type) {
+        case CROUS_TYPE_STRING:
+        case CROUS_TYPE_BYTES:
+            return v->data.bytes.len >= FLUX_SHARE_MIN_BYTES;
+        case CROUS_TYPE_LIST:
+        case CROUS_TYPE_TUPLE:
+            return v->data.list.len > 0;
+        case CROUS_TYPE_DICT:
+            return v->data.dict.len > 0;
+        case CROUS_TYPE_TAGGED:
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static size_t share_node_slot(const crous_value *v, size_t cap) {
+    return (size_t)(((uintptr_t)v >> 3) * 0x9e3779b97f4a7c15ULL) & (cap - 1);
+}
+
+static crous_err_t share_nodes_grow(flux_share_index_t *s) {
+    size_t new_cap = s->node_cap ? s->node_cap * 2 : 256;
+    flux_share_node_t *nodes = calloc(new_cap, sizeof(*nodes));
+    if (!nodes) return CROUS_ERR_OOM;
+    
+    for (size_t i = 0; i < s->node_cap; i++) {
+        if (!s->nodes[i].v) continue;
+        size_t j = share_node_slot(s->nodes[i].v, new_cap);
+        while (nodes[j].v) j = (j + 1) & (new_cap - 1);
+        nodes[j] = s->nodes[i];
+    }
+    
+    free(s->nodes);
+    s->nodes = nodes;
+    s->node_cap = new_cap;
+    return CROUS_OK;
+}
+
+static crous_err_t share_class_slots_grow(flux_share_index_t *s) {
+    size_t new_cap = s->class_slot_cap ? s->class_slot_cap * 2 : 256;
+    uint32_t *slots = calloc(new_cap, sizeof(*slots));
+    if (!slots) return CROUS_ERR_OOM;
+    
+    for (size_t i = 0; i < s->class_count; i++) {
+        size_t j = (size_t)s->classes[i].hash & (new_cap - 1);
+        while (slots[j]) j = (j + 1) & (new_cap - 1);
+        slots[j] = (uint32_t)i + 1;
+    }
+    
+    free(s->class_slots);
+    s->class_slots = slots;
+    s->class_slot_cap = new_cap;
+    return CROUS_OK;
+}
+
+/* The class of values equal to node, made if it is the first */
+static crous_err_t share_class_find(flux_share_index_t *s, const crous_value *node, uint64_t hash,
+                                    int height, uint32_t *out_cls) {
+    if ((s->class_count + 1) * 2 > s->class_slot_cap) {
+        crous_err_t err = share_class_slots_grow(s);
+        if (err != CROUS_OK) return err;
+    }
+    
+    size_t j = (size_t)hash & (s->class_slot_cap - 1);
+    while (s->class_slots[j]) {
+        uint32_t cls = s->class_slots[j] - 1;
+        if (s->classes[cls].hash == hash) {
+            int equal = crous_value_equal(s->classes[cls].v, node);
+            if (equal < 0) return CROUS_ERR_OOM;
+            if (equal) {
+                *out_cls = cls;
+                return CROUS_OK;
+            }
+        }
+        j = (j + 1) & (s->class_slot_cap - 1);
+    }
+    
+    if (s->class_count >= UINT32_MAX - 1) return CROUS_ERR_OVERFLOW;
+    if (s->class_count == s->class_cap) {
+        size_t new_cap = s->class_cap ? s->class_cap * 2 : 64;
+        flux_share_class_t *classes = realloc(s->classes, new_cap * sizeof(*classes));
+        if (!classes) return CROUS_ERR_OOM;
+        s->classes = classes;
+        s->class_cap = new_cap;
+    }
+    
+    flux_share_class_t *c = &s->classes[s->class_count];
+    c->v = node;
+    c->hash = hash;
+    c->height = height;
+    c->count = 0;
+    c->index = 0;
+    s->class_slots[j] = (uint32_t)s->class_count + 1;
+    *out_cls = (uint32_t)s->class_count++;
+    return CROUS_OK;
+}
+
+/* crous_value_hash_subtrees() visitor of the first pass */
+static crous_err_t share_visit(void *user, const crous_value *node, uint64_t hash, int height) {
+    flux_share_index_t *s = user;
+    if (!share_candidate(node)) return CROUS_OK;
+    
+    uint32_t cls;
+    crous_err_t err = share_class_find(s, node, hash, height, &cls);
+    if (err != CROUS_OK) return err;
+    
+    if ((s->node_count + 1) * 2 > s->node_cap) {
+        err = share_nodes_grow(s);
+        if (err != CROUS_OK) return err;
+    }
+    /* A node reached twice (the input is a DAG) keeps its first entry */
+    size_t j = share_node_slot(node, s->node_cap);
+    while (s->nodes[j].v) {
+        if (s->nodes[j].v == node) return CROUS_OK;
+        j = (j + 1) & (s->node_cap - 1);
+    }
+    s->nodes[j].v = node;
+    s->nodes[j].cls = cls;
+    s->node_count++;
+    return CROUS_OK;
+}
+
+static flux_share_class_t *share_class_of(const flux_share_index_t *s, const crous_value *v) {
+    if (!s->node_cap) return NULL;
+    size_t j = share_node_slot(v, s->node_cap);
+    while (s->nodes[j].v) {
+        if (s->nodes[j].v == v) return &s->classes[s->nodes[j].cls];
+        j = (j + 1) & (s->node_cap - 1);
+    }
+    return NULL;
+}
+
 typedef struct {
     uint8_t *buf;
     size_t pos;
     size_t cap;
+    size_t flushed;         /* Bytes already handed to out before buf[0] */
+    crous_output_stream *out;
+    int fixed;              /* Memory target of fixed capacity: never grow */
+    flux_key_index_t *keys; /* Non-NULL = wire v3 key back-references */
+    const flux_dictionary_t *dict;  /* Keys ahead of the document's own, or NULL */
+    int columnar;           /* Wire v4: write qualifying lists as tables */
+    int max_depth;          /* Values must sit above this depth; 0 = no limit */
+    int tables;             /* Tables being written, each through a nested call */
+    flux_share_index_t *shares;     /* Non-NULL = wire v5 shared values */
 } flux_binary_context_t;
 
-static crous_err_t binary_write(flux_binary_context_t *ctx, const uint8_t *data, size_t len) {
-    if (ctx->pos + len > ctx->cap) {
-        size_t new_cap = ctx->cap * 2;
+static crous_err_t binary_flush(flux_binary_context_t *ctx) {
+    if (ctx->pos == 0) return CROUS_OK;
+    if (ctx->out->write(ctx->out->user_data, ctx->buf, ctx->pos) != ctx->pos)
+        return CROUS_ERR_STREAM;
+    ctx->flushed += ctx->pos;
+    ctx->pos = 0;
+    return CROUS_OK;
+}
+
+static crous_err_t binary_write_slow(flux_binary_context_t *ctx, const uint8_t *data, size_t len) {
+    if (ctx->out) {
+        crous_err_t err = binary_flush(ctx);
+        if (err != CROUS_OK) return err;
+        /* Payloads of a block or more go straight to the stream */
+        if (len >= ctx->cap) {
+            if (ctx->out->write(ctx->out->user_data, data, len) != len)
+                return CROUS_ERR_STREAM;
+            ctx->flushed += len;
+            return CROUS_OK;
+        }
+    } else if (ctx->fixed) {
+        return CROUS_ERR_OVERFLOW;
+    } else {
+        size_t new_cap = ctx->cap ? ctx->cap * 2 : 1024;
         while (new_cap < ctx->pos + len) new_cap *= 2;
         
         uint8_t *new_buf = realloc(ctx->buf, new_cap);
@@ -196,77 +452,315 @@ static crous_err_t binary_write(flux_binary_context_t *ctx, const uint8_t *data,
     return CROUS_OK;
 }
 
+static crous_err_t binary_write(flux_binary_context_t *ctx, const uint8_t *data, size_t len) {
+    if (len > ctx->cap - ctx->pos) return binary_write_slow(ctx, data, len);
+    /* Empty payloads may come with a NULL data */
+    if (len) memcpy(ctx->buf + ctx->pos, data, len);
+    ctx->pos += len;
+    return CROUS_OK;
+}
+
 static crous_err_t binary_write_varint(flux_binary_context_t *ctx, uint64_t val) {
-    uint8_t buf[10];
-    int count = 0;
-    
-    while (val >= 0x80) {
-        buf[count++] = (uint8_t)((val & 0x7F) | 0x80);
-        val >>= 7;
+    if (ctx->cap - ctx->pos >= CROUS_VARINT_MAX) {
+        ctx->pos = (size_t)(crous_varint_put(ctx->buf + ctx->pos, val) - ctx->buf);
+        return CROUS_OK;
     }
-    buf[count++] = (uint8_t)(val & 0x7F);
     
-    return binary_write(ctx, buf, count);
+    uint8_t buf[CROUS_VARINT_MAX];
+    return binary_write(ctx, buf, (size_t)(crous_varint_put(buf, val) - buf));
+}
+
+static uint64_t key_hash(const char *key, size_t len) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)key[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
 }
 
-static crous_err_t serialize_value_binary(flux_binary_context_t *ctx, const crous_value *v);
+static crous_err_t key_index_grow(flux_key_index_t *idx) {
+    size_t new_cap = idx->cap ? idx->cap * 2 : 64;
+    flux_key_slot_t *slots = calloc(new_cap, sizeof(*slots));
+    if (!slots) return CROUS_ERR_OOM;
+    
+    for (size_t i = 0; i < idx->cap; i++) {
+        if (!idx->slots[i].key) continue;
+        size_t j = key_hash(idx->slots[i].key, idx->slots[i].key_len) & (new_cap - 1);
+        while (slots[j].key) j = (j + 1) & (new_cap - 1);
+        slots[j] = idx->slots[i];
+    }
+    
+    free(idx->slots);
+    idx->slots = slots;
+    idx->cap = new_cap;
+    return CROUS_OK;
+}
 
-static crous_err_t serialize_record_binary(flux_binary_context_t *ctx, const crous_value *v) {
-    size_t count = crous_value_dict_size(v);
-    crous_err_t err = binary_write_varint(ctx, count);
-    if (err != CROUS_OK) return err;
+/*
+ * Look key up in the table. Returns its index in *found_index, or adds it
+ * (while the table has room) and sets *found_index to UINT32_MAX.
+ */
+static crous_err_t key_index_lookup(flux_key_index_t *idx, const char *key, size_t len,
+                                    uint32_t *found_index) {
+    *found_index = UINT32_MAX;
     
-    for (size_t i = 0; i < count; i++) {
-        const crous_dict_entry *entry = crous_value_dict_get_entry(v, i);
-        if (!entry) return CROUS_ERR_INVALID_TYPE;
-        
-        /* Write key */
-        err = binary_write_varint(ctx, entry->key_len);
-        if (err != CROUS_OK) return err;
-        err = binary_write(ctx, (const uint8_t *)entry->key, entry->key_len);
-        if (err != CROUS_OK) return err;
-        
-        /* Write value */
-        err = serialize_value_binary(ctx, entry->value);
+    if (idx->cap) {
+        size_t j = key_hash(key, len) & (idx->cap - 1);
+        while (idx->slots[j].key) {
+            const flux_key_slot_t *slot = &idx->slots[j];
+            if (slot->key_len == len && memcmp(slot->key, key, len) == 0) {
+                *found_index = slot->index;
+                return CROUS_OK;
+            }
+            j = (j + 1) & (idx->cap - 1);
+        }
+    }
+    
+    if (idx->base + idx->count >= FLUX_KEY_TABLE_MAX) return CROUS_OK;
+    
+    if ((idx->count + 1) * 2 > idx->cap) {
+        crous_err_t err = key_index_grow(idx);
         if (err != CROUS_OK) return err;
     }
     
+    size_t j = key_hash(key, len) & (idx->cap - 1);
+    while (idx->slots[j].key) j = (j + 1) & (idx->cap - 1);
+    /* Empty keys still need a non-NULL marker */
+    idx->slots[j].key = len ? key : "";
+    idx->slots[j].key_len = len;
+    idx->slots[j].index = (uint32_t)(idx->base + idx->count++);
     return CROUS_OK;
 }
 
-static crous_err_t serialize_array_binary(flux_binary_context_t *ctx, const crous_value *v) {
-    size_t count = crous_value_list_size(v);
-    crous_err_t err = binary_write_varint(ctx, count);
+static crous_err_t binary_write_key(flux_binary_context_t *ctx, const char *key, size_t len) {
+    crous_err_t err;
+    
+    if (!ctx->keys) {
+        err = binary_write_varint(ctx, len);
+        if (err != CROUS_OK) return err;
+        return binary_write(ctx, (const uint8_t *)key, len);
+    }
+    
+    /* Dictionary keys are in every document's table already */
+    size_t dict_index;
+    if (ctx->dict && flux_dictionary_find_key(ctx->dict, key, len, &dict_index))
+        return binary_write_varint(ctx, ((uint64_t)dict_index << 1) | 1);
+    
+    uint32_t index;
+    err = key_index_lookup(ctx->keys, key, len, &index);
     if (err != CROUS_OK) return err;
+    if (index != UINT32_MAX)
+        return binary_write_varint(ctx, ((uint64_t)index << 1) | 1);
     
-    for (size_t i = 0; i < count; i++) {
-        crous_value *elem = crous_value_list_get(v, i);
-        if (!elem) return CROUS_ERR_INVALID_TYPE;
+    err = binary_write_varint(ctx, (uint64_t)len << 1);
+    if (err != CROUS_OK) return err;
+    return binary_write(ctx, (const uint8_t *)key, len);
+}
+
+/*
+ * Wire v5: the SHARE or REF, if any, v starts with. Sets *ref when v is
+ * written as a reference and nothing more; the dry run only counts, and
+ * stops at the occurrences that will be references.
+ */
+static crous_err_t binary_write_share(flux_binary_context_t *ctx, const crous_value *v, int depth, int *ref) {
+    *ref = 0;
+    flux_share_class_t *c = share_class_of(ctx->shares, v);
+    if (!c) return CROUS_OK;
+    
+    if (ctx->shares->counting) {
+        if (c->count < UINT32_MAX) c->count++;
+        *ref = c->count >= 2;
+        return CROUS_OK;
+    }
+    if (c->count < 2) return CROUS_OK;
+    
+    if (c->index == 0) {
+        c->index = ++ctx->shares->next_index;
+        uint8_t tag = FLUX_TAG_SHARE;
+        return binary_write(ctx, &tag, 1);
+    }
+    
+    /* The reference decodes to the whole value, so its depth still counts */
+    if (ctx->max_depth && depth + c->height > ctx->max_depth) return CROUS_ERR_DEPTH_EXCEEDED;
+    uint8_t tag = FLUX_TAG_REF;
+    crous_err_t err = binary_write(ctx, &tag, 1);
+    if (err == CROUS_OK) err = binary_write_varint(ctx, c->index - 1);
+    *ref = 1;
+    return err;
+}
+
+static crous_err_t serialize_value_binary(flux_binary_context_t *ctx, const crous_value *v, int depth);
+
+/* Zero bytes that align a packed array of count elements whose tag sits at
+ * document offset at */
+static size_t array_pad(size_t at, size_t count) {
+    size_t start = at + 1 + crous_varint_size(count) + 1;
+    return (FLUX_ARRAY_ALIGN - start % FLUX_ARRAY_ALIGN) % FLUX_ARRAY_ALIGN;
+}
+
+static crous_err_t serialize_packed_binary(flux_binary_context_t *ctx, uint8_t tag, const crous_array_t *a) {
+    uint8_t head[1 + 10 + 1 + FLUX_ARRAY_ALIGN];
+    size_t n = 0;
+    size_t pad = array_pad(ctx->flushed + ctx->pos, a->len);
+    uint64_t count = a->len;
+    
+    head[n++] = tag;
+    while (count >= 0x80) {
+        head[n++] = (uint8_t)((count & 0x7F) | 0x80);
+        count >>= 7;
+    }
+    head[n++] = (uint8_t)count;
+    head[n++] = (uint8_t)pad;
+    memset(head + n, 0, pad);
+    n += pad;
+    
+    crous_err_t err = binary_write(ctx, head, n);
+    if (err != CROUS_OK) return err;
+    return binary_write(ctx, a->data, a->len * 8);
+}
+
+/* Non-zero if list v can be written as a table: enough rows, and every row
+ * a dict with the same non-empty key sequence */
+static int table_shape(const crous_value *v) {
+    size_t rows = v->data.list.len;
+    if (rows < FLUX_TABLE_MIN_ROWS) return 0;
+    
+    const crous_value *first = v->data.list.items[0];
+    if (!first || first->type != CROUS_TYPE_DICT || first->data.dict.len == 0) return 0;
+    size_t cols = first->data.dict.len;
+    
+    for (size_t r = 1; r < rows; r++) {
+        const crous_value *row = v->data.list.items[r];
+        if (!row || row->type != CROUS_TYPE_DICT || row->data.dict.len != cols) return 0;
+        for (size_t c = 0; c < cols; c++) {
+            const crous_dict_entry *a = &first->data.dict.entries[c];
+            const crous_dict_entry *b = &row->data.dict.entries[c];
+            if (a->key_len != b->key_len) return 0;
+            if (a->key != b->key && memcmp(a->key, b->key, a->key_len) != 0) return 0;
+        }
+    }
+    return 1;
+}
+
+#define TABLE_CELL(v, r, c) ((v)->data.list.items[r]->data.dict.entries[c].value)
+
+/* Pick the column encoding: typed when every cell has one scalar type */
+static uint8_t table_column_kind(const crous_value *v, size_t col) {
+    size_t rows = v->data.list.len;
+    crous_type_t type = TABLE_CELL(v, 0, col)->type;
+    
+    if (type != CROUS_TYPE_INT && type != CROUS_TYPE_FLOAT &&
+        type != CROUS_TYPE_BOOL && type != CROUS_TYPE_STRING) {
+        return FLUX_COLUMN_ANY;
+    }
+    
+    for (size_t r = 1; r < rows; r++) {
+        if (TABLE_CELL(v, r, col)->type != type) return FLUX_COLUMN_ANY;
+    }
+    
+    switch (type) {
+        case CROUS_TYPE_INT: {
+            /* Delta runs win for sorted or clustered values such as ids */
+            size_t plain = 0, delta = 0;
+            int64_t prev = 0;
+            for (size_t r = 0; r < rows; r++) {
+                int64_t val = TABLE_CELL(v, r, col)->data.i;
+                plain += crous_varint_size(crous_zigzag_encode(val));
+                delta += crous_varint_size(crous_zigzag_encode((int64_t)((uint64_t)val - (uint64_t)prev)));
+                prev = val;
+            }
+            return delta < plain ? FLUX_COLUMN_INT_DELTA : FLUX_COLUMN_INT;
+        }
+        case CROUS_TYPE_FLOAT:
+            return FLUX_COLUMN_FLOAT;
+        case CROUS_TYPE_BOOL:
+            return FLUX_COLUMN_BOOL;
+        default:
+            return FLUX_COLUMN_STRING;
+    }
+}
+
+static crous_err_t serialize_column_binary(flux_binary_context_t *ctx, const crous_value *v, size_t col, int depth) {
+    size_t rows = v->data.list.len;
+    uint8_t kind = table_column_kind(v, col);
+    crous_err_t err = binary_write(ctx, &kind, 1);
+    if (err != CROUS_OK) return err;
+    
+    if (kind == FLUX_COLUMN_BOOL) {
+        for (size_t r = 0; r < rows; r += 8) {
+            uint8_t bits = 0;
+            for (size_t i = 0; i < 8 && r + i < rows; i++) {
+                if (TABLE_CELL(v, r + i, col)->data.b) bits |= (uint8_t)(1u << i);
+            }
+            err = binary_write(ctx, &bits, 1);
+            if (err != CROUS_OK) return err;
+        }
+        return CROUS_OK;
+    }
+    
+    int64_t prev = 0;
+    for (size_t r = 0; r < rows; r++) {
+        const crous_value *cell = TABLE_CELL(v, r, col);
         
-        err = serialize_value_binary(ctx, elem);
+        switch (kind) {
+            case FLUX_COLUMN_INT:
+                err = binary_write_varint(ctx, crous_zigzag_encode(cell->data.i));
+                break;
+            case FLUX_COLUMN_INT_DELTA:
+                err = binary_write_varint(ctx, crous_zigzag_encode((int64_t)((uint64_t)cell->data.i - (uint64_t)prev)));
+                prev = cell->data.i;
+                break;
+            case FLUX_COLUMN_FLOAT: {
+                uint8_t bytes[8];
+                memcpy(bytes, &cell->data.f, 8);
+                err = binary_write(ctx, bytes, 8);
+                break;
+            }
+            case FLUX_COLUMN_STRING:
+                err = binary_write_varint(ctx, cell->data.s.len);
+                if (err == CROUS_OK) err = binary_write(ctx, (const uint8_t *)cell->data.s.data, cell->data.s.len);
+                break;
+            default:
+                err = serialize_value_binary(ctx, cell, depth + 2);
+                break;
+        }
         if (err != CROUS_OK) return err;
     }
     
     return CROUS_OK;
 }
 
-enum {
-    FLUX_TAG_NULL = 0x00,
-    FLUX_TAG_FALSE = 0x01,
-    FLUX_TAG_TRUE = 0x02,
-    FLUX_TAG_INT = 0x03,
-    FLUX_TAG_FLOAT = 0x04,
-    FLUX_TAG_STRING = 0x05,
-    FLUX_TAG_BYTES = 0x06,
-    FLUX_TAG_LIST = 0x07,
-    FLUX_TAG_DICT = 0x08,
-    FLUX_TAG_TAGGED = 0x09,
-    FLUX_TAG_TUPLE = 0x0A,
-};
-
-static crous_err_t serialize_value_binary(flux_binary_context_t *ctx, const crous_value *v) {
-    if (!v) return CROUS_ERR_INVALID_TYPE;
+/* List v, already checked by table_shape(), as a wire v4 table whose rows
+ * sit at depth + 1 */
+static crous_err_t serialize_table_binary(flux_binary_context_t *ctx, const crous_value *v, int depth) {
+    const crous_value *first = v->data.list.items[0];
+    size_t cols = first->data.dict.len;
+    
+    uint8_t tag = FLUX_TAG_TABLE;
+    crous_err_t err = binary_write(ctx, &tag, 1);
+    if (err == CROUS_OK) err = binary_write_varint(ctx, v->data.list.len);
+    if (err == CROUS_OK) err = binary_write_varint(ctx, cols);
+    if (err != CROUS_OK) return err;
+    
+    for (size_t c = 0; c < cols; c++) {
+        const crous_dict_entry *entry = &first->data.dict.entries[c];
+        err = binary_write_key(ctx, entry->key, entry->key_len);
+        if (err != CROUS_OK) return err;
+    }
+    
+    ctx->tables++;
+    for (size_t c = 0; c < cols && err == CROUS_OK; c++) {
+        err = serialize_column_binary(ctx, v, c, depth);
+    }
+    ctx->tables--;
     
+    return err;
+}
+
+/* Any value that is not a list, tuple, dict or tagged value; lists only
+ * when written as tables */
+static crous_err_t serialize_scalar_binary(flux_binary_context_t *ctx, const crous_value *v, int depth) {
     uint8_t tag;
     crous_err_t err;
     
@@ -285,9 +779,7 @@ static crous_err_t serialize_value_binary(flux_binary_context_t *ctx, const crou
             err = binary_write(ctx, &tag, 1);
             if (err != CROUS_OK) return err;
             
-            int64_t val = crous_value_get_int(v);
-            uint64_t encoded = (uint64_t)((val << 1) ^ (val >> 63));
-            return binary_write_varint(ctx, encoded);
+            return binary_write_varint(ctx, crous_zigzag_encode(crous_value_get_int(v)));
         }
         
         case CROUS_TYPE_FLOAT: {
@@ -325,50 +817,245 @@ static crous_err_t serialize_value_binary(flux_binary_context_t *ctx, const crou
             return binary_write(ctx, data, len);
         }
         
-        case CROUS_TYPE_LIST: {
-            tag = FLUX_TAG_LIST;
-            err = binary_write(ctx, &tag, 1);
-            if (err != CROUS_OK) return err;
-            return serialize_array_binary(ctx, v);
+        case CROUS_TYPE_LIST:
+            return serialize_table_binary(ctx, v, depth);
+        
+        case CROUS_TYPE_I64_ARRAY:
+            return serialize_packed_binary(ctx, FLUX_TAG_I64_ARRAY, &v->data.array);
+        
+        case CROUS_TYPE_F64_ARRAY:
+            return serialize_packed_binary(ctx, FLUX_TAG_F64_ARRAY, &v->data.array);
+        
+        default:
+            return CROUS_ERR_INVALID_TYPE;
+    }
+}
+
+/* One open list, tuple or dict: the item or entry to write next */
+typedef struct {
+    const crous_value *v;
+    size_t next;
+    int depth;
+} flux_encode_frame_t;
+
+/*
+ * v at depth, without recursion: containers write their head and are pushed
+ * onto a work stack, and each turn of the loop writes the next item of the
+ * innermost one. Tables are the exception, written through a nested call
+ * per table, so their nesting is bounded by FLUX_TABLE_MAX_NESTING. With
+ * shared values, a value may start with a SHARE, or be a REF instead.
+ */
+static crous_err_t serialize_value_binary(flux_binary_context_t *ctx, const crous_value *v, int depth) {
+    flux_encode_frame_t local[CROUS_STACK_INLINE];
+    flux_encode_frame_t *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+    crous_err_t err = CROUS_OK;
+    
+    for (;;) {
+        if (!v) {
+            err = CROUS_ERR_INVALID_TYPE;
+            break;
+        }
+        if (ctx->max_depth && depth >= ctx->max_depth) {
+            err = CROUS_ERR_DEPTH_EXCEEDED;
+            break;
         }
         
-        case CROUS_TYPE_DICT: {
-            tag = FLUX_TAG_DICT;
-            err = binary_write(ctx, &tag, 1);
-            if (err != CROUS_OK) return err;
-            return serialize_record_binary(ctx, v);
+        int ref = 0;
+        if (ctx->shares) {
+            err = binary_write_share(ctx, v, depth, &ref);
+            if (err != CROUS_OK) break;
         }
         
-        case CROUS_TYPE_TAGGED: {
-            tag = FLUX_TAG_TAGGED;
-            err = binary_write(ctx, &tag, 1);
-            if (err != CROUS_OK) return err;
+        if (!ref) {
+            crous_type_t type = crous_value_get_type(v);
+            if (type == CROUS_TYPE_TAGGED) {
+                uint8_t tag = FLUX_TAG_TAGGED;
+                err = binary_write(ctx, &tag, 1);
+                if (err == CROUS_OK) err = binary_write_varint(ctx, v->data.tagged.tag);
+                if (err != CROUS_OK) break;
             
-            /* Write the tag number */
-            err = binary_write_varint(ctx, v->data.tagged.tag);
-            if (err != CROUS_OK) return err;
+                /* The inner value takes the tagged value's place */
+                v = v->data.tagged.value;
+                depth++;
+                continue;
+            }
+            
+            if (type == CROUS_TYPE_DICT || type == CROUS_TYPE_TUPLE ||
+                (type == CROUS_TYPE_LIST && !(ctx->columnar && ctx->tables < FLUX_TABLE_MAX_NESTING && table_shape(v)))) {
+                uint8_t tag = type == CROUS_TYPE_DICT ? FLUX_TAG_DICT
+                            : type == CROUS_TYPE_TUPLE ? FLUX_TAG_TUPLE : FLUX_TAG_LIST;
+                size_t count = type == CROUS_TYPE_DICT ? v->data.dict.len : v->data.list.len;
+                err = binary_write(ctx, &tag, 1);
+                if (err == CROUS_OK) err = binary_write_varint(ctx, count);
+                if (err != CROUS_OK) break;
+            
+                if (count > 0) {
+                    if (top == cap) {
+                        flux_encode_frame_t *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+                        if (!grown) {
+                            err = CROUS_ERR_OOM;
+                            break;
+                        }
+                        stack = grown;
+                    }
+                    stack[top].v = v;
+                    stack[top].next = 0;
+                    stack[top].depth = depth;
+                    top++;
+                }
+            } else {
+                err = serialize_scalar_binary(ctx, v, depth);
+                if (err != CROUS_OK) break;
+            }
+        }
             
-            /* Write the inner value */
-            return serialize_value_binary(ctx, v->data.tagged.value);
+        /* Next: the first unwritten item of the innermost open container */
+        while (top > 0) {
+            flux_encode_frame_t *f = &stack[top - 1];
+            if (f->v->type == CROUS_TYPE_DICT) {
+                if (f->next < f->v->data.dict.len) {
+                    const crous_dict_entry *entry = &f->v->data.dict.entries[f->next++];
+                    err = binary_write_key(ctx, entry->key, entry->key_len);
+                    v = entry->value;
+                    break;
+                }
+            } else if (f->next < f->v->data.list.len) {
+                v = f->v->data.list.items[f->next++];
+                break;
+            }
+            top--;
+        }
+        if (top == 0 || err != CROUS_OK) break;
+        depth = stack[top - 1].depth + 1;
+    }
+    
+    crous_stack_release(stack, local);
+    return err;
+}
+
+/* ============================================================================
+   FLUX BINARY SIZE PASS
+   ============================================================================ */
+
+/* One open list, tuple or dict of the size pass */
+typedef struct {
+    const crous_value *v;
+    size_t next;
+} flux_size_frame_t;
+
+/* Bytes serialize_value_binary would emit for v starting at document
+ * offset at, or 0 if v can't be encoded. The offset only matters for the
+ * padding of packed arrays; *first_array, unless already set (not
+ * SIZE_MAX), gets the offset the first one's padding is computed from.
+ * Walks with a work stack like the serializer, carrying the offset. */
+static size_t value_encoded_size(const crous_value *v, size_t at, size_t *first_array) {
+    flux_size_frame_t local[CROUS_STACK_INLINE];
+    flux_size_frame_t *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+    size_t pos = at;
+    int ok = 1;
+    
+    for (;;) {
+        if (!v) {
+            ok = 0;
+            break;
         }
         
-        case CROUS_TYPE_TUPLE: {
-            tag = FLUX_TAG_TUPLE;
-            err = binary_write(ctx, &tag, 1);
-            if (err != CROUS_OK) return err;
-            return serialize_array_binary(ctx, v);
+        switch (v->type) {
+            case CROUS_TYPE_NULL:
+            case CROUS_TYPE_BOOL:
+                pos += 1;
+                break;
+            
+            case CROUS_TYPE_INT:
+                pos += 1 + crous_varint_size(crous_zigzag_encode(v->data.i));
+                break;
+            
+            case CROUS_TYPE_FLOAT:
+                pos += 1 + 8;
+                break;
+            
+            case CROUS_TYPE_STRING:
+                pos += 1 + crous_varint_size(v->data.s.len) + v->data.s.len;
+                break;
+            
+            case CROUS_TYPE_BYTES:
+                pos += 1 + crous_varint_size(v->data.bytes.len) + v->data.bytes.len;
+                break;
+            
+            case CROUS_TYPE_LIST:
+            case CROUS_TYPE_TUPLE:
+            case CROUS_TYPE_DICT: {
+                size_t count = v->type == CROUS_TYPE_DICT ? v->data.dict.len : v->data.list.len;
+                pos += 1 + crous_varint_size(count);
+                if (count == 0) break;
+                if (top == cap) {
+                    flux_size_frame_t *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+                    if (!grown) {
+                        ok = 0;
+                        break;
+                    }
+                    stack = grown;
+                }
+                stack[top].v = v;
+                stack[top].next = 0;
+                top++;
+                break;
+            }
+            
+            case CROUS_TYPE_TAGGED:
+                pos += 1 + crous_varint_size(v->data.tagged.tag);
+                v = v->data.tagged.value;
+                continue;
+            
+            case CROUS_TYPE_I64_ARRAY:
+            case CROUS_TYPE_F64_ARRAY: {
+                size_t len = v->data.array.len;
+                if (*first_array == SIZE_MAX) *first_array = pos + 1 + crous_varint_size(len) + 1;
+                pos += 1 + crous_varint_size(len) + 1 + array_pad(pos, len) + len * 8;
+                break;
+            }
+            
+            default:
+                ok = 0;
+                break;
         }
+        if (!ok) break;
         
-        default:
-            return CROUS_ERR_INVALID_TYPE;
+        while (top > 0) {
+            flux_size_frame_t *f = &stack[top - 1];
+            if (f->v->type == CROUS_TYPE_DICT) {
+                if (f->next < f->v->data.dict.len) {
+                    const crous_dict_entry *entry = &f->v->data.dict.entries[f->next++];
+                    pos += crous_varint_size(entry->key_len) + entry->key_len;
+                    v = entry->value;
+                    break;
+                }
+            } else if (f->next < f->v->data.list.len) {
+                v = f->v->data.list.items[f->next++];
+                break;
+            }
+            top--;
+        }
+        if (top == 0) break;
     }
+    
+    crous_stack_release(stack, local);
+    return ok ? pos - at : 0;
+}
+
+size_t flux_encoded_size(const crous_value *value) {
+    size_t first_array = SIZE_MAX;
+    size_t body = value_encoded_size(value, 6, &first_array);
+    return body ? 6 + body : 0;
 }
 
 /* ============================================================================
    PUBLIC API
    ============================================================================ */
 
-crous_err_t flux_serialize_text(const crous_value *value, crous_output_stream *out) {
+static crous_err_t serialize_text(const crous_value *value, crous_output_stream *out) {
     if (!value || !out) return CROUS_ERR_INVALID_TYPE;
     
     flux_text_context_t ctx = {
@@ -380,44 +1067,147 @@ crous_err_t flux_serialize_text(const crous_value *value, crous_output_stream *o
     return serialize_value_text(&ctx, value);
 }
 
-crous_err_t flux_serialize_binary(const crous_value *value, crous_output_stream *out) {
-    if (!value || !out) return CROUS_ERR_INVALID_TYPE;
-    
-    /* Build binary in memory first */
+crous_err_t flux_serialize_text(const crous_value *value, crous_output_stream *out) {
+    crous_span span;
+    crous_span_begin(&span, "flux_serialize_text", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX_TEXT, 0);
+    return crous_span_end(&span, serialize_text(value, crous_span_output(&span, out)), 0);
+}
+
+static const uint8_t flux_binary_header[6] = {
+    FLUX_MAGIC_0, FLUX_MAGIC_1, FLUX_MAGIC_2, FLUX_MAGIC_3,
+    FLUX_VERSION, 0x00
+};
+
+flux_binary_options_t flux_binary_options_default(void) {
+    flux_binary_options_t opts = { .key_refs = 0, .columnar = 0, .compression = CROUS_CODEC_NONE,
+                                   .dictionary = NULL, .checksum = 0, .max_depth = 0, .dedup = 0 };
+    return opts;
+}
+
+/* Whether opts wrap the document in an envelope */
+static int binary_opts_enveloped(const flux_binary_options_t *opts) {
+    return opts && (opts->compression != CROUS_CODEC_NONE || opts->dictionary || opts->checksum);
+}
+
+/* FLUX_ENVELOPE_* flags for opts */
+static unsigned binary_opts_envelope_flags(const flux_binary_options_t *opts) {
+    return opts && opts->checksum ? FLUX_ENVELOPE_CHECKSUM : 0;
+}
+
+/* Whether opts write wire v3 key references */
+static int binary_opts_key_refs(const flux_binary_options_t *opts) {
+    return opts && (opts->key_refs || opts->columnar || opts->dictionary || opts->dedup);
+}
+
+static size_t share_discard_write(void *user_data, const uint8_t *buf, size_t len) {
+    (void)user_data;
+    (void)buf;
+    return len;
+}
+
+/* Wire v5: decide what ctx->shares shares in value before it is written */
+static crous_err_t share_index_build(flux_binary_context_t *ctx, const crous_value *value) {
+    crous_err_t err = crous_value_hash_subtrees(value, share_visit, ctx->shares, NULL);
+    if (err != CROUS_OK) return err;
+    
+    /* The dry run takes the writer's own path through value, into a sink */
+    uint8_t scratch[256];
+    crous_output_stream sink = { NULL, share_discard_write };
+    flux_binary_context_t dry = *ctx;
+    dry.buf = scratch;
+    dry.pos = 0;
+    dry.cap = sizeof(scratch);
+    dry.flushed = 0;
+    dry.out = &sink;
+    dry.fixed = 0;
+    dry.keys = NULL;
+    
+    ctx->shares->counting = 1;
+    err = serialize_value_binary(&dry, value, 0);
+    ctx->shares->counting = 0;
+    return err;
+}
+
+/* Header, then value; the header version follows the options in ctx */
+static crous_err_t serialize_document_binary(flux_binary_context_t *ctx, const crous_value *value) {
+    crous_err_t err;
+    if (ctx->shares) {
+        err = share_index_build(ctx, value);
+        if (err != CROUS_OK) return err;
+    }
+    
+    err = binary_write(ctx, flux_binary_header, 4);
+    if (err != CROUS_OK) return err;
+    
+    uint8_t version = ctx->shares ? FLUX_VERSION_VALUE_REFS
+                    : ctx->columnar ? FLUX_VERSION_COLUMNAR
+                    : ctx->keys ? FLUX_VERSION_KEY_REFS : FLUX_VERSION;
+    uint8_t version_flags[2] = { version, 0x00 };
+    err = binary_write(ctx, version_flags, 2);
+    if (err != CROUS_OK) return err;
+    
+    return serialize_value_binary(ctx, value, 0);
+}
+
+/* The plain document, through one fixed block flushed as it fills */
+static crous_err_t serialize_binary_inner(const crous_value *value, const flux_binary_options_t *opts,
+                                          crous_output_stream *out) {
+    flux_key_index_t keys = { NULL, 0, 0, flux_dictionary_key_count(opts ? opts->dictionary : NULL) };
+    flux_share_index_t shares = { 0 };
+    
     flux_binary_context_t ctx = {
-        .buf = malloc(1024),
+        .buf = malloc(CROUS_STREAM_CHUNK_SIZE),
         .pos = 0,
-        .cap = 1024
+        .cap = CROUS_STREAM_CHUNK_SIZE,
+        .out = out,
+        .keys = binary_opts_key_refs(opts) ? &keys : NULL,
+        .dict = opts ? opts->dictionary : NULL,
+        .columnar = opts && opts->columnar,
+        .max_depth = opts ? opts->max_depth : 0,
+        .shares = opts && opts->dedup ? &shares : NULL
     };
     
     if (!ctx.buf) return CROUS_ERR_OOM;
     
-    /* Write header */
-    uint8_t header[6] = {
-        FLUX_MAGIC_0, FLUX_MAGIC_1, FLUX_MAGIC_2, FLUX_MAGIC_3,
-        FLUX_VERSION, 0x00
-    };
-    crous_err_t err = binary_write(&ctx, header, 6);
-    if (err != CROUS_OK) {
-        free(ctx.buf);
-        return err;
-    }
+    crous_err_t err = serialize_document_binary(&ctx, value);
+    if (err == CROUS_OK) err = binary_flush(&ctx);
+    
+    free(ctx.buf);
+    free(keys.slots);
+    share_index_free(&shares);
+    return err;
+}
+
+static crous_err_t serialize_binary_opts(const crous_value *value, const flux_binary_options_t *opts,
+                                         crous_output_stream *out) {
+    if (!value || !out) return CROUS_ERR_INVALID_TYPE;
+    if (!binary_opts_enveloped(opts)) return serialize_binary_inner(value, opts, out);
+    
+    /* Enveloped: serialize the plain document through a compressing stream */
+    flux_compress_stream_t *stream;
+    crous_err_t err = flux_compress_stream_new(out, (crous_codec_t)opts->compression, opts->dictionary,
+                                               binary_opts_envelope_flags(opts), &stream);
+    if (err != CROUS_OK) return err;
     
-    /* Serialize value */
-    err = serialize_value_binary(&ctx, value);
+    err = serialize_binary_inner(value, opts, flux_compress_stream_input(stream));
     if (err != CROUS_OK) {
-        free(ctx.buf);
+        flux_compress_stream_free(stream);
         return err;
     }
-    
-    /* Write to output stream */
-    if (out->write(out->user_data, ctx.buf, ctx.pos) != ctx.pos) {
-        free(ctx.buf);
-        return CROUS_ERR_STREAM;
-    }
-    
-    free(ctx.buf);
-    return CROUS_OK;
+    return flux_compress_stream_finish(stream);
+}
+
+crous_err_t flux_serialize_binary_opts(const crous_value *value, const flux_binary_options_t *opts,
+                                       crous_output_stream *out) {
+    crous_span span;
+    crous_span_begin(&span, "flux_serialize_binary", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    return crous_span_end(&span, serialize_binary_opts(value, opts, crous_span_output(&span, out)), 0);
+}
+
+crous_err_t flux_serialize_binary(const crous_value *value, crous_output_stream *out) {
+    return flux_serialize_binary_opts(value, NULL, out);
 }
 
 /* Helper for text encoding buffer output stream */
@@ -445,7 +1235,7 @@ static size_t flux_text_enc_write(void *user_data, const uint8_t *data, size_t l
     return len;
 }
 
-crous_err_t flux_encode_text(const crous_value *value, char **out_buf, size_t *out_size) {
+static crous_err_t encode_text(const crous_value *value, char **out_buf, size_t *out_size) {
     if (!value || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
     
     flux_text_enc_buf_t ctx = {
@@ -472,7 +1262,15 @@ crous_err_t flux_encode_text(const crous_value *value, char **out_buf, size_t *o
     return err;
 }
 
-crous_err_t flux_decode_text(const char *buf, size_t buf_size, crous_value **out_value) {
+crous_err_t flux_encode_text(const crous_value *value, char **out_buf, size_t *out_size) {
+    crous_span span;
+    crous_span_begin(&span, "flux_encode_text", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX_TEXT, 0);
+    crous_err_t err = encode_text(value, out_buf, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
+static crous_err_t decode_text(const char *buf, size_t buf_size, crous_value **out_value) {
     if (!buf || !out_value) return CROUS_ERR_INVALID_TYPE;
     
     flux_lexer_t *lexer = flux_lexer_new(buf, buf_size);
@@ -492,344 +1290,3088 @@ crous_err_t flux_decode_text(const char *buf, size_t buf_size, crous_value **out
     return err;
 }
 
-/* Helper for binary encoding buffer output stream */
-typedef struct {
-    uint8_t *data;
-    size_t pos;
-    size_t cap;
-} flux_encode_buf_t;
+crous_err_t flux_decode_text(const char *buf, size_t buf_size, crous_value **out_value) {
+    crous_span span;
+    crous_span_begin(&span, "flux_decode_text", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_FLUX_TEXT, CROUS_STATS_FMT_NONE, buf_size);
+    return crous_span_end(&span, decode_text(buf, buf_size, out_value), 0);
+}
 
-static size_t flux_encode_buf_write(void *user_data, const uint8_t *data, size_t len) {
-    flux_encode_buf_t *ctx = (flux_encode_buf_t *)user_data;
-    if (len == 0) return 0;
+static crous_err_t encode_binary_into(const crous_value *value, int max_depth, uint8_t *buf, size_t buf_size,
+                                      size_t *out_size) {
+    if (!value || !buf || !out_size) return CROUS_ERR_INVALID_TYPE;
     
-    if (ctx->pos + len > ctx->cap) {
-        size_t new_cap = ctx->cap * 2;
-        while (new_cap < ctx->pos + len) new_cap *= 2;
-        uint8_t *new_data = realloc(ctx->data, new_cap);
-        if (!new_data) return (size_t)-1;
-        ctx->data = new_data;
-        ctx->cap = new_cap;
+    flux_binary_context_t ctx = {
+        .buf = buf,
+        .pos = 0,
+        .cap = buf_size,
+        .out = NULL,
+        .fixed = 1,
+        .max_depth = max_depth
+    };
+    
+    crous_err_t err = serialize_document_binary(&ctx, value);
+    if (err == CROUS_OK) *out_size = ctx.pos;
+    else if (err == CROUS_ERR_OVERFLOW) *out_size = flux_encoded_size(value);
+    return err;
+}
+
+crous_err_t flux_encode_binary_into(const crous_value *value, uint8_t *buf, size_t buf_size, size_t *out_size) {
+    crous_span span;
+    crous_span_begin(&span, "flux_encode_binary_into", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    crous_err_t err = encode_binary_into(value, 0, buf, buf_size, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
+static crous_err_t encode_binary(const crous_value *value, int max_depth, uint8_t **out_buf, size_t *out_size) {
+    if (!value || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    
+    /* Size the output exactly so it is allocated once and never copied */
+    size_t size = flux_encoded_size(value);
+    if (size == 0) return CROUS_ERR_INVALID_TYPE;
+    
+    uint8_t *buf = malloc(size);
+    if (!buf) return CROUS_ERR_OOM;
+    
+    crous_err_t err = encode_binary_into(value, max_depth, buf, size, out_size);
+    if (err != CROUS_OK) {
+        free(buf);
+        return err;
     }
     
-    memcpy(ctx->data + ctx->pos, data, len);
-    ctx->pos += len;
-    return len;
+    *out_buf = buf;
+    return CROUS_OK;
 }
 
 crous_err_t flux_encode_binary(const crous_value *value, uint8_t **out_buf, size_t *out_size) {
+    crous_span span;
+    crous_span_begin(&span, "flux_encode_binary", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    crous_err_t err = encode_binary(value, 0, out_buf, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
+crous_err_t flux_value_append(const crous_value *value, int max_depth, uint8_t **buf, size_t *pos, size_t *cap) {
+    if (!value || !buf || !pos || !cap || *pos > *cap) return CROUS_ERR_INVALID_TYPE;
+    
+    flux_binary_context_t ctx = {
+        .buf = *buf,
+        .pos = *pos,
+        .cap = *cap,
+        .out = NULL,
+        .max_depth = max_depth
+    };
+    
+    /* The buffer may have moved even on failure */
+    crous_err_t err = serialize_value_binary(&ctx, value, 0);
+    *buf = ctx.buf;
+    *cap = ctx.cap;
+    if (err == CROUS_OK) *pos = ctx.pos;
+    return err;
+}
+
+static crous_err_t encode_binary_inner(const crous_value *value, const flux_binary_options_t *opts,
+                                       uint8_t **out_buf, size_t *out_size) {
+    if (!binary_opts_key_refs(opts)) return encode_binary(value, opts ? opts->max_depth : 0, out_buf, out_size);
     if (!value || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
     
-    flux_encode_buf_t ctx = {
-        .data = malloc(1024),
+    /* Reference sizes depend on first-seen order, so grow instead of sizing */
+    flux_key_index_t keys = { NULL, 0, 0, flux_dictionary_key_count(opts->dictionary) };
+    flux_share_index_t shares = { 0 };
+    flux_binary_context_t ctx = {
+        .buf = NULL,
         .pos = 0,
-        .cap = 1024
+        .cap = 0,
+        .out = NULL,
+        .keys = &keys,
+        .dict = opts->dictionary,
+        .columnar = opts->columnar,
+        .max_depth = opts->max_depth,
+        .shares = opts->dedup ? &shares : NULL
     };
     
-    if (!ctx.data) return CROUS_ERR_OOM;
+    crous_err_t err = serialize_document_binary(&ctx, value);
+    free(keys.slots);
+    share_index_free(&shares);
+    if (err != CROUS_OK) {
+        free(ctx.buf);
+        return err;
+    }
     
-    crous_output_stream out;
-    out.user_data = &ctx;
-    out.write = flux_encode_buf_write;
+    *out_buf = ctx.buf;
+    *out_size = ctx.pos;
+    return CROUS_OK;
+}
+
+crous_err_t flux_encode_binary_inner(const crous_value *value, const flux_binary_options_t *opts,
+                                     uint8_t **out_buf, size_t *out_size) {
+    crous_span span;
+    crous_span_begin(&span, "flux_encode_binary_inner", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    crous_err_t err = encode_binary_inner(value, opts, out_buf, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
+static crous_err_t encode_binary_inner_reuse(const crous_value *value, const flux_binary_options_t *opts,
+                                             uint8_t **buf, size_t *buf_cap, size_t *out_size) {
+    if (!value || !buf || !buf_cap || !out_size) return CROUS_ERR_INVALID_TYPE;
     
-    crous_err_t err = flux_serialize_binary(value, &out);
+    /* A buffer kept from earlier calls is usually big enough already, so
+     * grow on demand instead of paying for a sizing walk */
+    flux_key_index_t keys = { NULL, 0, 0, flux_dictionary_key_count(opts ? opts->dictionary : NULL) };
+    flux_share_index_t shares = { 0 };
+    flux_binary_context_t ctx = {
+        .buf = *buf,
+        .pos = 0,
+        .cap = *buf ? *buf_cap : 0,
+        .out = NULL,
+        .keys = binary_opts_key_refs(opts) ? &keys : NULL,
+        .dict = opts ? opts->dictionary : NULL,
+        .columnar = opts && opts->columnar,
+        .max_depth = opts ? opts->max_depth : 0,
+        .shares = opts && opts->dedup ? &shares : NULL
+    };
     
-    if (err == CROUS_OK) {
-        *out_buf = ctx.data;
-        *out_size = ctx.pos;
-    } else {
-        free(ctx.data);
-    }
+    crous_err_t err = serialize_document_binary(&ctx, value);
+    free(keys.slots);
+    share_index_free(&shares);
+    *buf = ctx.buf;
+    *buf_cap = ctx.cap;
+    if (err == CROUS_OK) *out_size = ctx.pos;
+    return err;
+}
+
+crous_err_t flux_encode_binary_inner_reuse(const crous_value *value, const flux_binary_options_t *opts,
+                                           uint8_t **buf, size_t *buf_cap, size_t *out_size) {
+    crous_span span;
+    crous_span_begin(&span, "flux_encode_binary_inner_reuse", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    crous_err_t err = encode_binary_inner_reuse(value, opts, buf, buf_cap, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
+static crous_err_t encode_binary_opts(const crous_value *value, const flux_binary_options_t *opts,
+                                      uint8_t **out_buf, size_t *out_size) {
+    if (!binary_opts_enveloped(opts)) return flux_encode_binary_inner(value, opts, out_buf, out_size);
+    if (!value || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    if (!crous_codec_available((crous_codec_t)opts->compression)) return CROUS_ERR_INVALID_TYPE;
+    
+    uint8_t *doc;
+    size_t doc_size;
+    crous_err_t err = flux_encode_binary_inner(value, opts, &doc, &doc_size);
+    if (err != CROUS_OK) return err;
     
+    err = flux_compress_binary(doc, doc_size, (crous_codec_t)opts->compression, opts->dictionary,
+                               binary_opts_envelope_flags(opts), out_buf, out_size);
+    free(doc);
     return err;
 }
 
+crous_err_t flux_encode_binary_opts(const crous_value *value, const flux_binary_options_t *opts,
+                                    uint8_t **out_buf, size_t *out_size) {
+    crous_span span;
+    crous_span_begin(&span, "flux_encode_binary_opts", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    crous_err_t err = encode_binary_opts(value, opts, out_buf, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
 /* ============================================================================
-   FLUX BINARY DESERIALIZATION
+   FLUX BINARY WRITER
    ============================================================================ */
 
+/* One open container: what it is, and the elements it still expects */
 typedef struct {
-    const uint8_t *buf;
-    size_t pos;
-    size_t len;
-} flux_decode_buf_t;
+    crous_type_t type;
+    size_t remaining;
+} flux_writer_frame_t;
 
-static crous_err_t binary_read(flux_decode_buf_t *ctx, uint8_t *out, size_t len) {
-    if (ctx->pos + len > ctx->len) return CROUS_ERR_TRUNCATED;
-    memcpy(out, ctx->buf + ctx->pos, len);
-    ctx->pos += len;
-    return CROUS_OK;
-}
+struct flux_writer {
+    flux_binary_context_t ctx;
+    flux_writer_frame_t frames[CROUS_MAX_DEPTH + 1];
+    int depth;
+    int have_key;           /* Innermost dict has its next key written */
+    int tagged;             /* A tag was written; its value has not started */
+    int root_started;
+};
 
-static crous_err_t binary_read_varint(flux_decode_buf_t *ctx, uint64_t *out) {
-    uint64_t result = 0;
-    int shift = 0;
+crous_err_t flux_writer_new(crous_output_stream *out, flux_writer_t **out_writer) {
+    if (!out_writer) return CROUS_ERR_INVALID_TYPE;
     
-    for (int i = 0; i < 10; i++) {
-        uint8_t byte;
-        crous_err_t err = binary_read(ctx, &byte, 1);
-        if (err != CROUS_OK) return err;
-        
-        result |= ((uint64_t)(byte & 0x7F)) << shift;
-        if ((byte & 0x80) == 0) {
-            *out = result;
-            return CROUS_OK;
+    flux_writer_t *w = calloc(1, sizeof(*w));
+    if (!w) return CROUS_ERR_OOM;
+    
+    if (out) {
+        w->ctx.buf = malloc(CROUS_STREAM_CHUNK_SIZE);
+        w->ctx.cap = CROUS_STREAM_CHUNK_SIZE;
+        w->ctx.out = out;
+        if (!w->ctx.buf) {
+            free(w);
+            return CROUS_ERR_OOM;
         }
-        shift += 7;
     }
     
-    return CROUS_ERR_DECODE;
+    static const uint8_t version_flags[2] = { FLUX_VERSION, 0x00 };
+    crous_err_t err = binary_write(&w->ctx, flux_binary_header, 4);
+    if (err == CROUS_OK) err = binary_write(&w->ctx, version_flags, 2);
+    if (err != CROUS_OK) {
+        flux_writer_free(w);
+        return err;
+    }
+    
+    *out_writer = w;
+    return CROUS_OK;
 }
 
-static crous_err_t deserialize_value_binary(flux_decode_buf_t *ctx, crous_value **out_value, int depth);
+void flux_writer_free(flux_writer_t *w) {
+    if (!w) return;
+    free(w->ctx.buf);
+    free(w);
+}
 
-static crous_err_t deserialize_array_binary(flux_decode_buf_t *ctx, crous_value **out_array, int depth) {
-    uint64_t count;
-    crous_err_t err = binary_read_varint(ctx, &count);
-    if (err != CROUS_OK) return err;
-    
-    if (count > CROUS_MAX_LIST_SIZE) return CROUS_ERR_DECODE;
-    
-    *out_array = crous_value_new_list(count);
-    if (!*out_array) return CROUS_ERR_OOM;
-    
-    for (uint64_t i = 0; i < count; i++) {
-        crous_value *elem = NULL;
-        err = deserialize_value_binary(ctx, &elem, depth + 1);
-        if (err != CROUS_OK) {
-            crous_value_free_tree(*out_array);
-            return err;
-        }
-        
-        err = crous_value_list_append(*out_array, elem);
-        if (err != CROUS_OK) {
-            crous_value_free_tree(*out_array);
-            crous_value_free_tree(elem);
-            return err;
-        }
+/* Account for the start of one element where the writer stands */
+static crous_err_t writer_element(flux_writer_t *w) {
+    if (w->tagged) {
+        /* The tag already took the slot; this is its value */
+        w->tagged = 0;
+        return CROUS_OK;
+    }
+    if (w->depth == 0) {
+        if (w->root_started) return CROUS_ERR_ENCODE;
+        w->root_started = 1;
+        return CROUS_OK;
     }
     
+    flux_writer_frame_t *top = &w->frames[w->depth - 1];
+    if (top->remaining == 0) return CROUS_ERR_ENCODE;
+    if (top->type == CROUS_TYPE_DICT) {
+        if (!w->have_key) return CROUS_ERR_ENCODE;
+        w->have_key = 0;
+    }
+    top->remaining--;
     return CROUS_OK;
 }
 
-static crous_err_t deserialize_dict_binary(flux_decode_buf_t *ctx, crous_value **out_dict, int depth) {
-    uint64_t count;
-    crous_err_t err = binary_read_varint(ctx, &count);
+crous_err_t flux_writer_value(flux_writer_t *w, const crous_value *value) {
+    if (!w || !value) return CROUS_ERR_INVALID_TYPE;
+    crous_err_t err = writer_element(w);
     if (err != CROUS_OK) return err;
+    return serialize_value_binary(&w->ctx, value, w->depth);
+}
+
+crous_err_t flux_writer_begin(flux_writer_t *w, crous_type_t type, size_t count) {
+    if (!w) return CROUS_ERR_INVALID_TYPE;
     
-    if (count > CROUS_MAX_DICT_SIZE) return CROUS_ERR_DECODE;
-    
-    *out_dict = crous_value_new_dict(count);
-    if (!*out_dict) return CROUS_ERR_OOM;
-    
-    for (uint64_t i = 0; i < count; i++) {
-        /* Read key */
-        uint64_t key_len;
-        err = binary_read_varint(ctx, &key_len);
-        if (err != CROUS_OK) {
-            crous_value_free_tree(*out_dict);
-            return err;
-        }
-        
-        if (key_len > CROUS_MAX_STRING_BYTES) {
-            crous_value_free_tree(*out_dict);
-            return CROUS_ERR_DECODE;
-        }
-        
-        uint8_t *key_data = malloc(key_len);
-        if (!key_data) {
-            crous_value_free_tree(*out_dict);
-            return CROUS_ERR_OOM;
-        }
-        
-        err = binary_read(ctx, key_data, key_len);
-        if (err != CROUS_OK) {
-            free(key_data);
-            crous_value_free_tree(*out_dict);
-            return err;
-        }
-        
-        /* Read value */
-        crous_value *val = NULL;
-        err = deserialize_value_binary(ctx, &val, depth + 1);
-        if (err != CROUS_OK) {
-            free(key_data);
-            crous_value_free_tree(*out_dict);
-            return err;
-        }
-        
-        /* Set in dictionary */
-        err = crous_value_dict_set_binary(*out_dict, (const char *)key_data, key_len, val);
-        free(key_data);
-        
-        if (err != CROUS_OK) {
-            crous_value_free_tree(*out_dict);
-            crous_value_free_tree(val);
-            return err;
-        }
+    uint8_t tag;
+    switch (type) {
+        case CROUS_TYPE_LIST: tag = FLUX_TAG_LIST; break;
+        case CROUS_TYPE_TUPLE: tag = FLUX_TAG_TUPLE; break;
+        case CROUS_TYPE_DICT: tag = FLUX_TAG_DICT; break;
+        default: return CROUS_ERR_INVALID_TYPE;
     }
+    if (w->depth > CROUS_MAX_DEPTH) return CROUS_ERR_DEPTH_EXCEEDED;
+    
+    crous_err_t err = writer_element(w);
+    if (err == CROUS_OK) err = binary_write(&w->ctx, &tag, 1);
+    if (err == CROUS_OK) err = binary_write_varint(&w->ctx, count);
+    if (err != CROUS_OK) return err;
     
+    w->frames[w->depth].type = type;
+    w->frames[w->depth].remaining = count;
+    w->depth++;
+    w->have_key = 0;
     return CROUS_OK;
 }
 
-static crous_err_t deserialize_value_binary(flux_decode_buf_t *ctx, crous_value **out_value, int depth) {
-    if (depth >= CROUS_MAX_DEPTH) return CROUS_ERR_DECODE;
+crous_err_t flux_writer_key(flux_writer_t *w, const char *key, size_t key_len) {
+    if (!w || (!key && key_len)) return CROUS_ERR_INVALID_TYPE;
+    if (w->depth == 0 || w->tagged || w->have_key) return CROUS_ERR_ENCODE;
     
-    uint8_t tag;
-    crous_err_t err = binary_read(ctx, &tag, 1);
+    const flux_writer_frame_t *top = &w->frames[w->depth - 1];
+    if (top->type != CROUS_TYPE_DICT || top->remaining == 0) return CROUS_ERR_ENCODE;
+    
+    crous_err_t err = binary_write_key(&w->ctx, key, key_len);
+    if (err == CROUS_OK) w->have_key = 1;
+    return err;
+}
+
+crous_err_t flux_writer_tag(flux_writer_t *w, uint32_t tag) {
+    if (!w) return CROUS_ERR_INVALID_TYPE;
+    crous_err_t err = writer_element(w);
     if (err != CROUS_OK) return err;
     
-    crous_value *v = NULL;
+    uint8_t head = FLUX_TAG_TAGGED;
+    err = binary_write(&w->ctx, &head, 1);
+    if (err == CROUS_OK) err = binary_write_varint(&w->ctx, tag);
+    if (err == CROUS_OK) w->tagged = 1;
+    return err;
+}
+
+crous_err_t flux_writer_end(flux_writer_t *w) {
+    if (!w) return CROUS_ERR_INVALID_TYPE;
+    if (w->depth == 0 || w->tagged || w->frames[w->depth - 1].remaining != 0) return CROUS_ERR_ENCODE;
+    w->depth--;
+    w->have_key = 0;
+    return CROUS_OK;
+}
+
+crous_err_t flux_writer_finish(flux_writer_t *w, uint8_t **out_buf, size_t *out_size) {
+    if (!w) return CROUS_ERR_INVALID_TYPE;
     
-    switch (tag) {
-        case FLUX_TAG_NULL:
-            v = crous_value_new_null();
-            if (!v) return CROUS_ERR_OOM;
-            break;
-        
-        case FLUX_TAG_FALSE:
-            v = crous_value_new_bool(0);
-            if (!v) return CROUS_ERR_OOM;
-            break;
-        
-        case FLUX_TAG_TRUE:
-            v = crous_value_new_bool(1);
-            if (!v) return CROUS_ERR_OOM;
-            break;
-        
-        case FLUX_TAG_INT: {
-            uint64_t encoded;
-            err = binary_read_varint(ctx, &encoded);
-            if (err != CROUS_OK) return err;
-            
-            /* Decode zigzag encoding */
-            int64_t val = (int64_t)((encoded >> 1) ^ (-(int64_t)(encoded & 1)));
-            v = crous_value_new_int(val);
-            if (!v) return CROUS_ERR_OOM;
-            break;
-        }
-        
-        case FLUX_TAG_FLOAT: {
-            uint8_t bytes[8];
-            err = binary_read(ctx, bytes, 8);
-            if (err != CROUS_OK) return err;
-            
-            double val;
-            memcpy(&val, bytes, 8);
-            v = crous_value_new_float(val);
-            if (!v) return CROUS_ERR_OOM;
-            break;
-        }
-        
-        case FLUX_TAG_STRING: {
-            uint64_t len;
-            err = binary_read_varint(ctx, &len);
-            if (err != CROUS_OK) return err;
-            
-            if (len > CROUS_MAX_STRING_BYTES) return CROUS_ERR_DECODE;
-            
-            uint8_t *str_data = malloc(len);
-            if (!str_data) return CROUS_ERR_OOM;
+    crous_err_t err = CROUS_OK;
+    if (w->depth != 0 || w->tagged || !w->root_started) {
+        err = CROUS_ERR_ENCODE;
+    } else if (w->ctx.out) {
+        err = binary_flush(&w->ctx);
+    } else if (!out_buf || !out_size) {
+        err = CROUS_ERR_INVALID_TYPE;
+    } else {
+        *out_buf = w->ctx.buf;
+        *out_size = w->ctx.pos;
+        w->ctx.buf = NULL;
+    }
+    
+    flux_writer_free(w);
+    return err;
+}
+
+/* ============================================================================
+   PARALLEL BINARY ENCODE
+   ============================================================================ */
+
+/*
+ * The document is cut into segments that follow each other on the wire:
+ * literals (a container's tag and count, a dict entry's key) and runs of
+ * consecutive list items or dict entries. Runs are sized on the worker
+ * threads, laid out by a prefix sum over the sizes, then serialized on the
+ * threads straight into one output buffer at their final offsets. Every
+ * byte lands where the sequential encoder would put it.
+ *
+ * Large containers are split into runs; the children of small ones are
+ * descended into, so a root such as {"rows": [...]} still splits its list.
+ */
+
+#define PAR_SPLIT_MIN 1024      /* Items before a container is split into runs */
+#define PAR_RUN_MIN 64          /* Fewest items per run */
+#define PAR_UNITS_PER_THREAD 8  /* Runs per thread, for balance */
+#define PAR_MAX_DEPTH 8         /* Containers descended into before giving up on splitting */
+
+typedef struct {
+    const crous_value *parent;  /* Container of the run; NULL for a literal */
+    size_t first;               /* Run: first item or entry */
+    size_t count;               /* Run: items or entries */
+    uint8_t head[1 + CROUS_VARINT_MAX];   /* Literal: bytes written first */
+    uint8_t head_len;
+    const char *tail;           /* Literal: key bytes after head, or NULL */
+    size_t tail_len;
+    size_t size;                /* Run: bytes when it starts at offset 0 */
+    size_t first_array;         /* Run: where its first packed array's padding is taken, or SIZE_MAX */
+    int depth;                  /* Run: depth of its items */
+    size_t offset;              /* Document offset */
+    crous_err_t err;
+} par_segment_t;
+
+typedef struct {
+    par_segment_t *segs;
+    size_t count;
+    size_t cap;
+    size_t units;               /* Runs to split a large container into */
+    int split;                  /* A container was split */
+    int max_depth;              /* As in flux_binary_options_t */
+    uint8_t *out;               /* The document, once sized */
+} par_plan_t;
+
+static par_segment_t *par_add(par_plan_t *plan) {
+    if (plan->count == plan->cap) {
+        size_t cap = plan->cap ? plan->cap * 2 : 64;
+        par_segment_t *grown = realloc(plan->segs, cap * sizeof(*grown));
+        if (!grown) return NULL;
+        plan->segs = grown;
+        plan->cap = cap;
+    }
+    par_segment_t *seg = &plan->segs[plan->count++];
+    memset(seg, 0, sizeof(*seg));
+    return seg;
+}
+
+static crous_err_t par_add_literal(par_plan_t *plan, uint8_t tag, int has_tag, uint64_t count,
+                                   const char *tail, size_t tail_len) {
+    par_segment_t *seg = par_add(plan);
+    if (!seg) return CROUS_ERR_OOM;
+    uint8_t *p = seg->head;
+    if (has_tag) *p++ = tag;
+    p = crous_varint_put(p, count);
+    seg->head_len = (uint8_t)(p - seg->head);
+    seg->tail = tail;
+    seg->tail_len = tail_len;
+    return CROUS_OK;
+}
+
+/* Extend the run for items first.. of parent, or start one */
+static crous_err_t par_add_run(par_plan_t *plan, const crous_value *parent, size_t first, size_t count,
+                               int depth) {
+    par_segment_t *last = plan->count ? &plan->segs[plan->count - 1] : NULL;
+    if (last && last->parent == parent && last->first + last->count == first) {
+        last->count += count;
+        return CROUS_OK;
+    }
+    par_segment_t *seg = par_add(plan);
+    if (!seg) return CROUS_ERR_OOM;
+    seg->parent = parent;
+    seg->first = first;
+    seg->count = count;
+    seg->depth = depth;
+    return CROUS_OK;
+}
+
+static int par_is_container(const crous_value *v) {
+    return v->type == CROUS_TYPE_LIST || v->type == CROUS_TYPE_TUPLE || v->type == CROUS_TYPE_DICT;
+}
+
+static size_t par_container_len(const crous_value *v) {
+    return v->type == CROUS_TYPE_DICT ? v->data.dict.len : v->data.list.len;
+}
+
+static const crous_value *par_item(const crous_value *parent, size_t i) {
+    return parent->type == CROUS_TYPE_DICT ? parent->data.dict.entries[i].value : parent->data.list.items[i];
+}
+
+/* Plan container v at depth: its head, then its items as runs or descended into */
+static crous_err_t par_plan_value(par_plan_t *plan, const crous_value *v, int depth) {
+    if (plan->max_depth && depth >= plan->max_depth) return CROUS_ERR_DEPTH_EXCEEDED;
+    size_t len = par_container_len(v);
+    uint8_t tag = v->type == CROUS_TYPE_DICT ? FLUX_TAG_DICT
+                : v->type == CROUS_TYPE_TUPLE ? FLUX_TAG_TUPLE : FLUX_TAG_LIST;
+    crous_err_t err = par_add_literal(plan, tag, 1, len, NULL, 0);
+    if (err != CROUS_OK) return err;
+
+    if (len >= PAR_SPLIT_MIN) {
+        size_t runs = len / PAR_RUN_MIN < plan->units ? len / PAR_RUN_MIN : plan->units;
+        for (size_t r = 0; r < runs; r++) {
+            size_t first = len * r / runs;
+            par_segment_t *seg = par_add(plan);
+            if (!seg) return CROUS_ERR_OOM;
+            seg->parent = v;
+            seg->first = first;
+            seg->count = len * (r + 1) / runs - first;
+            seg->depth = depth + 1;
+        }
+        plan->split = 1;
+        return CROUS_OK;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        const crous_value *item = par_item(v, i);
+        if (!item) return CROUS_ERR_INVALID_TYPE;
+        if (depth >= PAR_MAX_DEPTH || !par_is_container(item)) {
+            err = par_add_run(plan, v, i, 1, depth + 1);
+        } else {
+            if (v->type == CROUS_TYPE_DICT) {
+                const crous_dict_entry *entry = &v->data.dict.entries[i];
+                err = par_add_literal(plan, 0, 0, entry->key_len, entry->key, entry->key_len);
+                if (err != CROUS_OK) return err;
+            }
+            err = par_plan_value(plan, item, depth + 1);
+        }
+        if (err != CROUS_OK) return err;
+    }
+    return CROUS_OK;
+}
+
+/* Size of a run starting at document offset at; 0 if it can't be encoded */
+static size_t par_run_size(const par_segment_t *seg, size_t at, size_t *first_array) {
+    size_t total = 0;
+    for (size_t i = seg->first; i < seg->first + seg->count; i++) {
+        if (seg->parent->type == CROUS_TYPE_DICT) {
+            const crous_dict_entry *entry = &seg->parent->data.dict.entries[i];
+            total += crous_varint_size(entry->key_len) + entry->key_len;
+        }
+        size_t n = value_encoded_size(par_item(seg->parent, i), at + total, first_array);
+        if (n == 0) return 0;
+        total += n;
+    }
+    return total;
+}
+
+static void par_size_task(void *ctx, size_t index) {
+    par_segment_t *seg = &((par_plan_t *)ctx)->segs[index];
+    if (!seg->parent) return;
+
+    seg->first_array = SIZE_MAX;
+    seg->size = par_run_size(seg, 0, &seg->first_array);
+    if (seg->size == 0) seg->err = CROUS_ERR_INVALID_TYPE;
+}
+
+static size_t par_pad(size_t at) {
+    return (FLUX_ARRAY_ALIGN - at % FLUX_ARRAY_ALIGN) % FLUX_ARRAY_ALIGN;
+}
+
+/*
+ * Size of a segment starting at document offset at. Only a run's first
+ * packed array pads differently when the run moves: its data is aligned
+ * either way, and everything after it lies the same relative to the
+ * alignment.
+ */
+static size_t par_segment_size(const par_segment_t *seg, size_t at) {
+    if (!seg->parent) return seg->head_len + seg->tail_len;
+    if (seg->first_array == SIZE_MAX) return seg->size;
+    return seg->size - par_pad(seg->first_array) + par_pad(at + seg->first_array);
+}
+
+static void par_write_task(void *ctx, size_t index) {
+    par_plan_t *plan = (par_plan_t *)ctx;
+    par_segment_t *seg = &plan->segs[index];
+    uint8_t *dst = plan->out + seg->offset;
+
+    if (!seg->parent) {
+        memcpy(dst, seg->head, seg->head_len);
+        if (seg->tail_len) memcpy(dst + seg->head_len, seg->tail, seg->tail_len);
+        return;
+    }
+
+    /* A fixed window onto the document; flushed keeps padding absolute */
+    flux_binary_context_t wctx = {
+        .buf = dst,
+        .pos = 0,
+        .cap = par_segment_size(seg, seg->offset),
+        .flushed = seg->offset,
+        .out = NULL,
+        .fixed = 1,
+        .max_depth = plan->max_depth
+    };
+    crous_err_t err = CROUS_OK;
+    for (size_t i = seg->first; i < seg->first + seg->count && err == CROUS_OK; i++) {
+        if (seg->parent->type == CROUS_TYPE_DICT) {
+            const crous_dict_entry *entry = &seg->parent->data.dict.entries[i];
+            err = binary_write_key(&wctx, entry->key, entry->key_len);
+            if (err != CROUS_OK) break;
+        }
+        err = serialize_value_binary(&wctx, par_item(seg->parent, i), seg->depth);
+    }
+    if (err == CROUS_OK && wctx.pos != wctx.cap) err = CROUS_ERR_INTERNAL;
+    seg->err = err;
+}
+
+/* The plain document of value on nthreads threads; CROUS_ERR_NOT_FOUND
+ * if it has nothing worth splitting */
+static crous_err_t encode_binary_split(const crous_value *value, int max_depth, int nthreads,
+                                       uint8_t **out_buf, size_t *out_size) {
+    if (!par_is_container(value)) return CROUS_ERR_NOT_FOUND;
+
+    par_plan_t plan = { NULL, 0, 0, (size_t)nthreads * PAR_UNITS_PER_THREAD, 0, max_depth, NULL };
+    crous_err_t err = par_plan_value(&plan, value, 0);
+    if (err == CROUS_OK && !plan.split) err = CROUS_ERR_NOT_FOUND;
+
+    size_t size = 6;
+    if (err == CROUS_OK) {
+        crous_parallel_for(plan.count, nthreads, par_size_task, &plan);
+        for (size_t i = 0; i < plan.count && err == CROUS_OK; i++) {
+            err = plan.segs[i].err;
+            plan.segs[i].offset = size;
+            size += par_segment_size(&plan.segs[i], size);
+        }
+    }
+    if (err == CROUS_OK) {
+        plan.out = malloc(size);
+        if (!plan.out) err = CROUS_ERR_OOM;
+    }
+    if (err == CROUS_OK) {
+        memcpy(plan.out, flux_binary_header, 6);
+        crous_parallel_for(plan.count, nthreads, par_write_task, &plan);
+        for (size_t i = 0; i < plan.count && err == CROUS_OK; i++) err = plan.segs[i].err;
+    }
+
+    free(plan.segs);
+    if (err != CROUS_OK) {
+        free(plan.out);
+        return err;
+    }
+    *out_buf = plan.out;
+    *out_size = size;
+    return CROUS_OK;
+}
+
+static crous_err_t encode_binary_parallel(const crous_value *value, const flux_binary_options_t *opts, int nthreads,
+                                          uint8_t **out_buf, size_t *out_size) {
+    if (!value || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    int pool = crous_pool_threads();
+    if (nthreads <= 0 || nthreads > pool) nthreads = pool;
+    if (nthreads == 1) return flux_encode_binary_opts(value, opts, out_buf, out_size);
+    if (binary_opts_enveloped(opts) && !crous_codec_available((crous_codec_t)opts->compression))
+        return CROUS_ERR_INVALID_TYPE;
+
+    /* Key references depend on everything written before them */
+    uint8_t *doc;
+    size_t doc_size;
+    crous_err_t err = binary_opts_key_refs(opts) ? CROUS_ERR_NOT_FOUND
+                    : encode_binary_split(value, opts ? opts->max_depth : 0, nthreads, &doc, &doc_size);
+    if (err == CROUS_ERR_NOT_FOUND) err = flux_encode_binary_inner(value, opts, &doc, &doc_size);
+    if (err != CROUS_OK || !binary_opts_enveloped(opts)) {
+        if (err == CROUS_OK) {
+            *out_buf = doc;
+            *out_size = doc_size;
+        }
+        return err;
+    }
+
+    size_t cap = flux_compress_bound(doc_size);
+    uint8_t *packed = malloc(cap);
+    if (!packed) {
+        free(doc);
+        return CROUS_ERR_OOM;
+    }
+    err = flux_compress_binary_into_parallel(doc, doc_size, (crous_codec_t)opts->compression, opts->dictionary,
+                                             binary_opts_envelope_flags(opts), nthreads, packed, cap, out_size);
+    free(doc);
+    if (err != CROUS_OK) {
+        free(packed);
+        return err;
+    }
+
+    uint8_t *shrunk = realloc(packed, *out_size);
+    *out_buf = shrunk ? shrunk : packed;
+    return CROUS_OK;
+}
+
+crous_err_t flux_encode_binary_parallel(const crous_value *value, const flux_binary_options_t *opts, int nthreads,
+                                        uint8_t **out_buf, size_t *out_size) {
+    crous_span span;
+    crous_span_begin(&span, "flux_encode_binary_parallel", CROUS_PHASE_ENCODE,
+                     CROUS_STATS_FMT_NONE, CROUS_STATS_FMT_FLUX, 0);
+    crous_err_t err = encode_binary_parallel(value, opts, nthreads, out_buf, out_size);
+    return crous_span_end(&span, err, err == CROUS_OK ? *out_size : 0);
+}
+
+/* ============================================================================
+   FLUX BINARY DESERIALIZATION
+   ============================================================================ */
+
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+} flux_key_span_t;
+
+/* Wire v5 shared value: where its tag sits and where it ends */
+typedef struct {
+    size_t pos;
+    size_t end;             /* 0 until the value is complete */
+    crous_value *node;      /* Decoded node, when REFs reuse it */
+} flux_share_span_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t pos;
+    size_t len;
+    crous_arena *arena;     /* NULL = heap-allocated tree */
+    int borrow;             /* Point strings/bytes/keys into buf instead of copying */
+    int key_refs;           /* Wire v3 key prefixes */
+    int columnar;           /* Wire v4 tables */
+    flux_key_span_t *keys;  /* Wire v3 key table, pointing into buf */
+    size_t key_count;
+    size_t key_cap;
+    size_t key_frontier;    /* Literal keys before this offset are in keys */
+    const flux_dictionary_t *dict;  /* Its keys come first in the table, or NULL */
+    size_t dict_keys;
+    int max_depth;          /* Values must sit above this depth */
+    int tables;             /* Tables being decoded, each through a nested call */
+    int value_refs;         /* Wire v5 shared values */
+    flux_share_span_t *shares;  /* Wire v5 shared values, in document order */
+    size_t share_count;
+    size_t share_cap;
+    size_t share_frontier;  /* SHAREs before this offset are in shares */
+    int share_nodes;        /* A REF links the shared node (arena trees only) */
+    size_t ref_budget;      /* Bytes REFs may still decode again */
+} flux_decode_buf_t;
+
+static crous_err_t binary_read(flux_decode_buf_t *ctx, uint8_t *out, size_t len) {
+    if (ctx->pos + len > ctx->len) return CROUS_ERR_TRUNCATED;
+    memcpy(out, ctx->buf + ctx->pos, len);
+    ctx->pos += len;
+    return CROUS_OK;
+}
+
+/* Borrow len bytes straight out of the input buffer */
+static crous_err_t binary_read_span(flux_decode_buf_t *ctx, size_t len, const uint8_t **out) {
+    if (len > ctx->len - ctx->pos) return CROUS_ERR_TRUNCATED;
+    *out = ctx->buf + ctx->pos;
+    ctx->pos += len;
+    return CROUS_OK;
+}
+
+static inline crous_err_t binary_read_varint(flux_decode_buf_t *ctx, uint64_t *out) {
+    size_t used;
+    CROUS_STAT_ADD(varint_reads, 1);
+    crous_err_t err = crous_varint_get(ctx->buf + ctx->pos, ctx->len - ctx->pos, out, &used);
+    if (err == CROUS_OK) ctx->pos += used;
+    return err;
+}
+
+/* Append a literal key to the wire v3 key table */
+static crous_err_t key_table_add(flux_decode_buf_t *ctx, const uint8_t *data, size_t len) {
+    if (ctx->dict_keys + ctx->key_count >= FLUX_KEY_TABLE_MAX) return CROUS_OK;
+    
+    if (ctx->key_count == ctx->key_cap) {
+        size_t new_cap = ctx->key_cap ? ctx->key_cap * 2 : 64;
+        flux_key_span_t *keys = realloc(ctx->keys, new_cap * sizeof(*keys));
+        if (!keys) return CROUS_ERR_OOM;
+        ctx->keys = keys;
+        ctx->key_cap = new_cap;
+    }
+    
+    ctx->keys[ctx->key_count].data = data;
+    ctx->keys[ctx->key_count].len = len;
+    ctx->key_count++;
+    return CROUS_OK;
+}
+
+/* Read one dict key, literal or (wire v3) a key table reference */
+static crous_err_t binary_read_key(flux_decode_buf_t *ctx, const uint8_t **out, size_t *out_len) {
+    uint64_t prefix;
+    crous_err_t err = binary_read_varint(ctx, &prefix);
+    if (err != CROUS_OK) return err;
+    
+    if (ctx->key_refs) {
+        if (prefix & 1) {
+            uint64_t index = prefix >> 1;
+            if (index < ctx->dict_keys)
+                return flux_dictionary_key(ctx->dict, (size_t)index, (const char **)out, out_len);
+            index -= ctx->dict_keys;
+            if (index >= ctx->key_count) return CROUS_ERR_DECODE;
+            *out = ctx->keys[index].data;
+            *out_len = ctx->keys[index].len;
+            return CROUS_OK;
+        }
+        prefix >>= 1;
+    }
+    
+    if (prefix > CROUS_MAX_STRING_BYTES) return CROUS_ERR_DECODE;
+    
+    size_t key_pos = ctx->pos;
+    err = binary_read_span(ctx, prefix, out);
+    if (err != CROUS_OK) return err;
+    *out_len = prefix;
+    
+    /* Lazy views can walk a stretch again; its keys are already in the
+     * table. The frontier passes the key's start even when it is empty. */
+    if (ctx->key_refs && key_pos >= ctx->key_frontier) {
+        ctx->key_frontier = ctx->pos > key_pos ? ctx->pos : key_pos + 1;
+        return key_table_add(ctx, *out, *out_len);
+    }
+    return CROUS_OK;
+}
+
+/* The bytes REFs may decode again in a document of len bytes */
+static size_t binary_ref_budget(size_t len) {
+    if (len > (SIZE_MAX - FLUX_REF_EXPANSION_BASE) / FLUX_REF_EXPANSION) return SIZE_MAX;
+    return len * FLUX_REF_EXPANSION + FLUX_REF_EXPANSION_BASE;
+}
+
+/* Index of the shared value whose tag is at pos, registering it the first
+ * time; a view or a replay can walk a stretch again */
+static crous_err_t share_table_find(flux_decode_buf_t *ctx, size_t pos, size_t *out_index) {
+    if (pos >= ctx->share_frontier) {
+        if (ctx->share_count == ctx->share_cap) {
+            size_t new_cap = ctx->share_cap ? ctx->share_cap * 2 : 16;
+            flux_share_span_t *shares = realloc(ctx->shares, new_cap * sizeof(*shares));
+            if (!shares) return CROUS_ERR_OOM;
+            ctx->shares = shares;
+            ctx->share_cap = new_cap;
+        }
+        ctx->shares[ctx->share_count].pos = pos;
+        ctx->shares[ctx->share_count].end = 0;
+        ctx->shares[ctx->share_count].node = NULL;
+        ctx->share_frontier = pos + 1;
+        *out_index = ctx->share_count++;
+        return CROUS_OK;
+    }
+    
+    /* Registered in document order, so sorted by pos */
+    size_t lo = 0, hi = ctx->share_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ctx->shares[mid].pos < pos) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == ctx->share_count || ctx->shares[lo].pos != pos) return CROUS_ERR_DECODE;
+    *out_index = lo;
+    return CROUS_OK;
+}
+
+/*
+ * A wire v5 prefix, whose tag byte *tag was just read. SHARE registers the
+ * value after it and reads that value's own tag into *tag, setting *share
+ * to its index + 1. REF sets *ref to the index + 1 of a complete shared
+ * value. Both are errors before wire v5.
+ */
+static crous_err_t binary_read_share(flux_decode_buf_t *ctx, uint8_t *tag, size_t *share, size_t *ref) {
+    *share = 0;
+    *ref = 0;
+    if (!ctx->value_refs) return CROUS_ERR_DECODE;
+    
+    crous_err_t err;
+    if (*tag == FLUX_TAG_REF) {
+        uint64_t index;
+        err = binary_read_varint(ctx, &index);
+        if (err != CROUS_OK) return err;
+        /* Only finished values: a REF inside its own value would never end */
+        if (index >= ctx->share_count || ctx->shares[index].end == 0) return CROUS_ERR_DECODE;
+        *ref = (size_t)index + 1;
+        return CROUS_OK;
+    }
+    
+    size_t index;
+    err = share_table_find(ctx, ctx->pos, &index);
+    if (err == CROUS_OK) err = binary_read(ctx, tag, 1);
+    if (err != CROUS_OK) return err;
+    if (*tag == FLUX_TAG_SHARE || *tag == FLUX_TAG_REF) return CROUS_ERR_DECODE;
+    *share = index + 1;
+    return CROUS_OK;
+}
+
+/* Shared value share (index + 1), decoded as node, ends at ctx->pos */
+static void binary_share_complete(flux_decode_buf_t *ctx, size_t share, crous_value *node) {
+    flux_share_span_t *span = &ctx->shares[share - 1];
+    if (!span->end) span->end = ctx->pos;
+    if (ctx->share_nodes) span->node = node;
+}
+
+static crous_err_t deserialize_value_binary(flux_decode_buf_t *ctx, crous_value **out_value, int depth);
+
+/* One table cell of a typed column; ANY columns go through deserialize_value_binary.
+ * Int columns are bulk-decoded through run. */
+static crous_err_t deserialize_cell_binary(flux_decode_buf_t *ctx, uint8_t kind,
+                                           crous_varint_run_t *run, int64_t *prev,
+                                           crous_value **out) {
+    crous_err_t err;
+    uint64_t n;
+    
+    switch (kind) {
+        case FLUX_COLUMN_INT:
+        case FLUX_COLUMN_INT_DELTA: {
+            size_t used;
+            err = crous_varint_run_next(run, ctx->buf + ctx->pos, ctx->len - ctx->pos, &n, &used);
+            if (err != CROUS_OK) return err;
+            ctx->pos += used;
+            int64_t val = crous_zigzag_decode(n);
+            if (kind == FLUX_COLUMN_INT_DELTA) {
+                val = (int64_t)((uint64_t)*prev + (uint64_t)val);
+                *prev = val;
+            }
+            *out = crous_value_new_int_arena(ctx->arena, val);
+            break;
+        }
+        
+        case FLUX_COLUMN_FLOAT: {
+            uint8_t bytes[8];
+            err = binary_read(ctx, bytes, 8);
+            if (err != CROUS_OK) return err;
+            double val;
+            memcpy(&val, bytes, 8);
+            *out = crous_value_new_float_arena(ctx->arena, val);
+            break;
+        }
+        
+        case FLUX_COLUMN_STRING: {
+            err = binary_read_varint(ctx, &n);
+            if (err != CROUS_OK) return err;
+            if (n > CROUS_MAX_STRING_BYTES) return CROUS_ERR_DECODE;
+            const uint8_t *data;
+            err = binary_read_span(ctx, n, &data);
+            if (err != CROUS_OK) return err;
+            *out = ctx->borrow ? crous_value_new_string_borrowed(ctx->arena, (const char *)data, n)
+                               : crous_value_new_string_arena(ctx->arena, (const char *)data, n);
+            break;
+        }
+        
+        default:
+            return CROUS_ERR_DECODE;
+    }
+    
+    return *out ? CROUS_OK : CROUS_ERR_OOM;
+}
+
+/* Fill column col of every row dict from the column body */
+static crous_err_t deserialize_column_binary(flux_decode_buf_t *ctx, crous_value *list,
+                                             const flux_key_span_t *key, int depth) {
+    size_t rows = list->data.list.len;
+    uint8_t kind;
+    crous_err_t err = binary_read(ctx, &kind, 1);
+    if (err != CROUS_OK) return err;
+    
+    const uint8_t *bitmap = NULL;
+    if (kind == FLUX_COLUMN_BOOL) {
+        err = binary_read_span(ctx, (rows + 7) / 8, &bitmap);
+        if (err != CROUS_OK) return err;
+    }
+    
+    crous_varint_run_t run;
+    crous_varint_run_init(&run, rows);
+    int64_t prev = 0;
+    for (size_t r = 0; r < rows; r++) {
+        crous_value *cell = NULL;
+        
+        if (kind == FLUX_COLUMN_ANY) {
+            err = deserialize_value_binary(ctx, &cell, depth + 2);
+        } else if (kind == FLUX_COLUMN_BOOL) {
+            cell = crous_value_new_bool_arena(ctx->arena, (bitmap[r / 8] >> (r % 8)) & 1);
+            err = cell ? CROUS_OK : CROUS_ERR_OOM;
+        } else {
+            err = deserialize_cell_binary(ctx, kind, &run, &prev, &cell);
+        }
+        if (err != CROUS_OK) return err;
+        
+        crous_value *row = list->data.list.items[r];
+        if (ctx->borrow)
+            err = crous_value_dict_append_borrowed(ctx->arena, row, (const char *)key->data, key->len, cell);
+        else
+            err = crous_value_dict_append_arena(ctx->arena, row, (const char *)key->data, key->len, cell);
+        if (err != CROUS_OK) {
+            crous_value_free_tree(cell);
+            return err;
+        }
+    }
+    
+    return CROUS_OK;
+}
+
+/* Row and column counts of a table after its tag */
+static crous_err_t binary_read_table_shape(flux_decode_buf_t *ctx, int depth, uint64_t *rows, uint64_t *cols) {
+    crous_err_t err = binary_read_varint(ctx, rows);
+    if (err == CROUS_OK) err = binary_read_varint(ctx, cols);
+    if (err != CROUS_OK) return err;
+    
+    /* Cells sit two levels down, as in the equivalent list of dicts */
+    if (depth + 2 >= ctx->max_depth || ctx->tables >= FLUX_TABLE_MAX_NESTING) return CROUS_ERR_DECODE;
+    if (*rows == 0 || *rows > CROUS_MAX_LIST_SIZE) return CROUS_ERR_DECODE;
+    if (*cols == 0 || *cols > CROUS_MAX_DICT_SIZE) return CROUS_ERR_DECODE;
+    /* Each column takes a key byte, a kind byte and at least a bit per row */
+    if ((*rows + 7) / 8 + 2 > (ctx->len - ctx->pos) / *cols) return CROUS_ERR_TRUNCATED;
+    return CROUS_OK;
+}
+
+/* Wire v4 table: rebuilt as the list of dicts it was written from */
+static crous_err_t deserialize_table_binary(flux_decode_buf_t *ctx, crous_value **out_list, int depth) {
+    uint64_t rows, cols;
+    crous_err_t err = binary_read_table_shape(ctx, depth, &rows, &cols);
+    if (err != CROUS_OK) return err;
+    
+    flux_key_span_t *keys = malloc(cols * sizeof(*keys));
+    if (!keys) return CROUS_ERR_OOM;
+    
+    for (uint64_t c = 0; c < cols; c++) {
+        size_t klen;
+        err = binary_read_key(ctx, &keys[c].data, &klen);
+        if (err != CROUS_OK) {
+            free(keys);
+            return err;
+        }
+        keys[c].len = klen;
+    }
+    
+    crous_value *list = crous_value_new_list_arena(ctx->arena, rows);
+    if (!list) {
+        free(keys);
+        return CROUS_ERR_OOM;
+    }
+    
+    for (uint64_t r = 0; r < rows && err == CROUS_OK; r++) {
+        crous_value *row = crous_value_new_dict_arena(ctx->arena, cols);
+        if (!row) {
+            err = CROUS_ERR_OOM;
+            break;
+        }
+        err = crous_value_list_append(list, row);
+        if (err != CROUS_OK) crous_value_free_tree(row);
+    }
+    
+    ctx->tables++;
+    for (uint64_t c = 0; c < cols && err == CROUS_OK; c++) {
+        err = deserialize_column_binary(ctx, list, &keys[c], depth);
+    }
+    ctx->tables--;
+    
+    free(keys);
+    if (err != CROUS_OK) {
+        crous_value_free_tree(list);
+        return err;
+    }
+    
+    *out_list = list;
+    return CROUS_OK;
+}
+
+/* Count, padding and element span of a packed array after its tag */
+static crous_err_t binary_read_packed(flux_decode_buf_t *ctx, uint64_t *count, const uint8_t **data) {
+    uint8_t pad;
+    
+    crous_err_t err = binary_read_varint(ctx, count);
+    if (err != CROUS_OK) return err;
+    if (*count > CROUS_MAX_ARRAY_LEN) return CROUS_ERR_DECODE;
+    
+    err = binary_read(ctx, &pad, 1);
+    if (err != CROUS_OK) return err;
+    if (pad >= FLUX_ARRAY_ALIGN) return CROUS_ERR_DECODE;
+    err = binary_read_span(ctx, pad, data);
+    if (err != CROUS_OK) return err;
+    for (uint8_t i = 0; i < pad; i++) {
+        if ((*data)[i] != 0) return CROUS_ERR_DECODE;
+    }
+    
+    return binary_read_span(ctx, (size_t)*count * 8, data);
+}
+
+/* Packed array after its tag. Borrowed decodes point into buf when the
+ * elements landed on an aligned address; otherwise they are copied. */
+static crous_err_t deserialize_packed_binary(flux_decode_buf_t *ctx, crous_type_t type, crous_value **out_value) {
+    uint64_t count;
+    const uint8_t *data;
+    
+    crous_err_t err = binary_read_packed(ctx, &count, &data);
+    if (err != CROUS_OK) return err;
+    
+    crous_value *v;
+    if (ctx->borrow && ((uintptr_t)data % FLUX_ARRAY_ALIGN) == 0) {
+        v = type == CROUS_TYPE_I64_ARRAY ? crous_value_new_i64_array_borrowed(ctx->arena, data, count)
+                                         : crous_value_new_f64_array_borrowed(ctx->arena, data, count);
+    } else {
+        v = type == CROUS_TYPE_I64_ARRAY ? crous_value_new_i64_array_arena(ctx->arena, (const int64_t *)data, count)
+                                         : crous_value_new_f64_array_arena(ctx->arena, (const double *)data, count);
+    }
+    if (!v) return CROUS_ERR_OOM;
+    
+    *out_value = v;
+    return CROUS_OK;
+}
+
+/* One open container of the decoder: a list, tuple or dict still taking
+ * elements, or a tagged value waiting for its inner value */
+typedef struct {
+    crous_value *v;
+    uint64_t remaining;
+    const uint8_t *key;     /* Dict: key of the entry being decoded */
+    size_t key_len;
+    size_t share;           /* Wire v5: shared value index + 1 it completes, 0 = none */
+} flux_decode_frame_t;
+
+/* Where the decoder resumes once the value a REF decodes again is complete */
+typedef struct {
+    size_t pos;             /* Just past the REF */
+    size_t len;
+    size_t top;             /* Open containers when the REF was read */
+} flux_decode_replay_t;
+
+/* Count of a list or dict after its tag; min_size is the fewest bytes an
+ * element takes */
+static crous_err_t binary_read_count(flux_decode_buf_t *ctx, uint64_t max, size_t min_size, uint64_t *count) {
+    crous_err_t err = binary_read_varint(ctx, count);
+    if (err != CROUS_OK) return err;
+    
+    if (*count > max) return CROUS_ERR_DECODE;
+    /* Reject counts the input can't hold */
+    if (*count > (ctx->len - ctx->pos) / min_size) return CROUS_ERR_TRUNCATED;
+    return CROUS_OK;
+}
+
+/* Add v, just decoded, to the innermost open container f */
+static crous_err_t deserialize_attach(flux_decode_buf_t *ctx, flux_decode_frame_t *f, crous_value *v) {
+    f->remaining--;
+    switch (f->v->type) {
+        case CROUS_TYPE_TAGGED:
+            f->v->data.tagged.value = v;
+            return CROUS_OK;
+        case CROUS_TYPE_DICT:
+            /* FLUX encoders never emit a key twice, so skip the duplicate check */
+            if (ctx->borrow)
+                return crous_value_dict_append_borrowed(ctx->arena, f->v, (const char *)f->key, f->key_len, v);
+            return crous_value_dict_append_arena(ctx->arena, f->v, (const char *)f->key, f->key_len, v);
+        default:
+            return crous_value_list_append(f->v, v);
+    }
+}
+
+/*
+ * The value at ctx->pos, at depth, without recursion. A list, tuple, dict
+ * or tagged value is linked into its parent as soon as it is made and then
+ * pushed onto a work stack; each turn of the loop decodes one value into
+ * the innermost open container. On error the partial tree hangs off one
+ * root and is freed at once. Tables decode their cells through a nested
+ * call, so their nesting is bounded by FLUX_TABLE_MAX_NESTING.
+ *
+ * A wire v5 REF decodes its shared value's bytes again in place, from a
+ * second stack of resume points, or links the shared node in share_nodes
+ * mode.
+ */
+static crous_err_t deserialize_value_binary(flux_decode_buf_t *ctx, crous_value **out_value, int depth) {
+    flux_decode_frame_t local[CROUS_STACK_INLINE];
+    flux_decode_frame_t *stack = local;
+    size_t top = 0, cap = CROUS_STACK_INLINE;
+    flux_decode_replay_t replay_local[CROUS_STACK_INLINE];
+    flux_decode_replay_t *replays = replay_local;
+    size_t replay_top = 0, replay_cap = CROUS_STACK_INLINE;
+    crous_value *root = NULL;
+    crous_err_t err;
+    
+    for (;;) {
+        if (depth + (int)top >= ctx->max_depth) {
+            err = CROUS_ERR_DECODE;
+            break;
+        }
+        
+        uint8_t tag;
+        err = binary_read(ctx, &tag, 1);
+        if (err != CROUS_OK) break;
+        
+        crous_value *v = NULL;
+        uint64_t count = 0;     /* Elements an opened container takes */
+        size_t share = 0, ref = 0;
+        
+        if (tag == FLUX_TAG_SHARE || tag == FLUX_TAG_REF) {
+            err = binary_read_share(ctx, &tag, &share, &ref);
+            if (err != CROUS_OK) break;
+            
+            if (ref && !ctx->share_nodes) {
+                const flux_share_span_t *span = &ctx->shares[ref - 1];
+                size_t size = span->end - span->pos;
+                if (size > ctx->ref_budget) {
+                    err = CROUS_ERR_DECODE;
+                    break;
+                }
+                ctx->ref_budget -= size;
+                
+                if (replay_top == replay_cap) {
+                    flux_decode_replay_t *grown = crous_stack_grow(replays, &replay_cap, sizeof(*replays),
+                                                                   replay_local);
+                    if (!grown) {
+                        err = CROUS_ERR_OOM;
+                        break;
+                    }
+                    replays = grown;
+                }
+                replays[replay_top].pos = ctx->pos;
+                replays[replay_top].len = ctx->len;
+                replays[replay_top].top = top;
+                replay_top++;
+                ctx->pos = span->pos;
+                ctx->len = span->end;
+                continue;
+            }
+        }
+        
+        switch (tag) {
+            case FLUX_TAG_REF:
+                /* share_nodes: the tree links the one node wherever it recurs */
+                v = ctx->shares[ref - 1].node;
+                break;
+            
+            case FLUX_TAG_NULL:
+                v = crous_value_new_null_arena(ctx->arena);
+                break;
+            
+            case FLUX_TAG_FALSE:
+                v = crous_value_new_bool_arena(ctx->arena, 0);
+                break;
+            
+            case FLUX_TAG_TRUE:
+                v = crous_value_new_bool_arena(ctx->arena, 1);
+                break;
+            
+            case FLUX_TAG_INT: {
+                uint64_t encoded;
+                err = binary_read_varint(ctx, &encoded);
+                if (err != CROUS_OK) break;
+                v = crous_value_new_int_arena(ctx->arena, crous_zigzag_decode(encoded));
+                break;
+            }
+            
+            case FLUX_TAG_FLOAT: {
+                uint8_t bytes[8];
+                err = binary_read(ctx, bytes, 8);
+                if (err != CROUS_OK) break;
+                
+                double val;
+                memcpy(&val, bytes, 8);
+                v = crous_value_new_float_arena(ctx->arena, val);
+                break;
+            }
+            
+            case FLUX_TAG_STRING: {
+                uint64_t len;
+                err = binary_read_varint(ctx, &len);
+                if (err != CROUS_OK) break;
+                if (len > CROUS_MAX_STRING_BYTES) {
+                    err = CROUS_ERR_DECODE;
+                    break;
+                }
+                
+                const uint8_t *str_data;
+                err = binary_read_span(ctx, len, &str_data);
+                if (err != CROUS_OK) break;
+                
+                v = ctx->borrow ? crous_value_new_string_borrowed(ctx->arena, (const char *)str_data, len)
+                                : crous_value_new_string_arena(ctx->arena, (const char *)str_data, len);
+                break;
+            }
+            
+            case FLUX_TAG_BYTES: {
+                uint64_t len;
+                err = binary_read_varint(ctx, &len);
+                if (err != CROUS_OK) break;
+                if (len > CROUS_MAX_BYTES_SIZE) {
+                    err = CROUS_ERR_DECODE;
+                    break;
+                }
+                
+                const uint8_t *bytes_data;
+                err = binary_read_span(ctx, len, &bytes_data);
+                if (err != CROUS_OK) break;
+                
+                v = ctx->borrow ? crous_value_new_bytes_borrowed(ctx->arena, bytes_data, len)
+                                : crous_value_new_bytes_arena(ctx->arena, bytes_data, len);
+                break;
+            }
+            
+            case FLUX_TAG_LIST:
+            case FLUX_TAG_TUPLE:
+                /* Every element takes at least one byte */
+                err = binary_read_count(ctx, CROUS_MAX_LIST_SIZE, 1, &count);
+                if (err != CROUS_OK) break;
+                v = crous_value_new_list_arena(ctx->arena, count);
+                /* Tuples are stored like lists, just with a different type */
+                if (v && tag == FLUX_TAG_TUPLE) v->type = CROUS_TYPE_TUPLE;
+                break;
+            
+            case FLUX_TAG_DICT:
+                /* Every entry takes at least two bytes (key length + value tag) */
+                err = binary_read_count(ctx, CROUS_MAX_DICT_SIZE, 2, &count);
+                if (err != CROUS_OK) break;
+                v = crous_value_new_dict_arena(ctx->arena, count);
+                break;
+            
+            case FLUX_TAG_TAGGED: {
+                uint64_t tag_num;
+                err = binary_read_varint(ctx, &tag_num);
+                if (err != CROUS_OK) break;
+                /* The inner value is attached once decoded */
+                v = crous_value_new_tagged_arena(ctx->arena, (uint32_t)tag_num, NULL);
+                count = 1;
+                break;
+            }
+            
+            case FLUX_TAG_TABLE:
+                if (!ctx->columnar) {
+                    err = CROUS_ERR_DECODE;
+                    break;
+                }
+                err = deserialize_table_binary(ctx, &v, depth + (int)top);
+                break;
+            
+            case FLUX_TAG_I64_ARRAY:
+                err = deserialize_packed_binary(ctx, CROUS_TYPE_I64_ARRAY, &v);
+                break;
+            
+            case FLUX_TAG_F64_ARRAY:
+                err = deserialize_packed_binary(ctx, CROUS_TYPE_F64_ARRAY, &v);
+                break;
+            
+            default:
+                err = CROUS_ERR_DECODE;
+                break;
+        }
+        if (err == CROUS_OK && !v) err = CROUS_ERR_OOM;
+        if (err != CROUS_OK) break;
+        
+        if (top == 0) {
+            root = v;
+        } else {
+            err = deserialize_attach(ctx, &stack[top - 1], v);
+            if (err != CROUS_OK) {
+                crous_value_free_tree(v);
+                break;
+            }
+        }
+        
+        if (count > 0) {
+            if (top == cap) {
+                flux_decode_frame_t *grown = crous_stack_grow(stack, &cap, sizeof(*stack), local);
+                if (!grown) {
+                    err = CROUS_ERR_OOM;
+                    break;
+                }
+                stack = grown;
+            }
+            stack[top].v = v;
+            stack[top].remaining = count;
+            stack[top].share = share;
+            top++;
+        } else if (share) {
+            binary_share_complete(ctx, share, v);
+        }
+        
+        /* Close the containers this value completed, and resume after the
+         * REFs whose values are now complete */
+        for (;;) {
+            if (replay_top > 0 && replays[replay_top - 1].top == top) {
+                replay_top--;
+                ctx->pos = replays[replay_top].pos;
+                ctx->len = replays[replay_top].len;
+            } else if (top > 0 && stack[top - 1].remaining == 0) {
+                top--;
+                if (stack[top].share) binary_share_complete(ctx, stack[top].share, stack[top].v);
+            } else {
+                break;
+            }
+        }
+        if (top == 0) break;
+        
+        flux_decode_frame_t *f = &stack[top - 1];
+        if (f->v->type == CROUS_TYPE_DICT) {
+            err = binary_read_key(ctx, &f->key, &f->key_len);
+            if (err != CROUS_OK) break;
+        }
+    }
+    
+    /* An error inside a replayed value leaves ctx->len cut short */
+    if (replay_top > 0) ctx->len = replays[0].len;
+    crous_stack_release(stack, local);
+    crous_stack_release(replays, replay_local);
+    if (err != CROUS_OK) {
+        crous_value_free_tree(root);
+        return err;
+    }
+    *out_value = root;
+    return CROUS_OK;
+}
+
+/* Magic and a readable version in the 6-byte header */
+static crous_err_t binary_check_header(const uint8_t *buf, size_t buf_size) {
+    if (buf_size < 6) return CROUS_ERR_TRUNCATED;
+    
+    /* Check FLUX magic */
+    if (buf[0] != FLUX_MAGIC_0 || buf[1] != FLUX_MAGIC_1 ||
+        buf[2] != FLUX_MAGIC_2 || buf[3] != FLUX_MAGIC_3) {
+        return CROUS_ERR_INVALID_HEADER;
+    }
+    
+    /* Wire v2 added no binary layout of its own; v3 adds key references,
+       v4 tables and v5 shared values on top of them */
+    if (buf[4] < FLUX_VERSION || buf[4] > FLUX_VERSION_VALUE_REFS) {
+        return CROUS_ERR_INVALID_HEADER;
+    }
+    return CROUS_OK;
+}
+
+/* Unpack a compressed envelope into arena memory, or the heap without an
+   arena, and find the dictionary it names */
+static crous_err_t binary_unpack(const uint8_t *buf, size_t buf_size, crous_arena *arena,
+                                 uint8_t **out_raw, size_t *out_size, const flux_dictionary_t **out_dict) {
+    size_t size;
+    crous_err_t err = flux_envelope_dictionary(buf, buf_size, out_dict);
+    if (err == CROUS_OK) err = flux_decompressed_size(buf, buf_size, &size);
+    if (err != CROUS_OK) return err;
+    
+    uint8_t *raw = arena ? crous_arena_alloc(arena, size ? size : 1) : malloc(size ? size : 1);
+    if (!raw) return CROUS_ERR_OOM;
+    
+    err = flux_decompress_binary_into(buf, buf_size, raw, size);
+    if (err != CROUS_OK) {
+        if (!arena) free(raw);
+        return err;
+    }
+    
+    *out_raw = raw;
+    *out_size = size;
+    return CROUS_OK;
+}
+
+static crous_err_t flux_decode_binary_mode(const uint8_t *buf, size_t buf_size, crous_arena *arena, int borrow,
+                                           int share_nodes, int max_depth, const flux_dictionary_t *dict,
+                                           crous_value **out_value) {
+    if (!buf || !out_value) return CROUS_ERR_INVALID_TYPE;
+    
+    if (flux_binary_is_compressed(buf, buf_size)) {
+        uint8_t *raw;
+        size_t raw_size;
+        crous_err_t err = binary_unpack(buf, buf_size, arena, &raw, &raw_size, &dict);
+        if (err != CROUS_OK) return err;
+        
+        /* Only arena memory lives as long as the tree, so only it can be borrowed from */
+        err = flux_decode_binary_mode(raw, raw_size, arena, borrow && arena, share_nodes, max_depth,
+                                      dict, out_value);
+        if (!arena) free(raw);
+        return err;
+    }
+    
+    /* Schema documents are laid out by their registered schema */
+    uint32_t schema_id;
+    if (flux_binary_schema_id(buf, buf_size, &schema_id)) {
+        const flux_schema_t *schema = flux_schema_lookup(schema_id);
+        return schema ? flux_schema_decode(schema, buf, buf_size, arena, out_value) : CROUS_ERR_NOT_FOUND;
+    }
+    
+    crous_err_t err = binary_check_header(buf, buf_size);
+    if (err != CROUS_OK) return err;
+    
+    flux_decode_buf_t ctx = {
+        .buf = buf,
+        .pos = 6,  /* Skip header */
+        .len = buf_size,
+        .arena = arena,
+        .borrow = borrow,
+        .key_refs = buf[4] >= FLUX_VERSION_KEY_REFS,
+        .columnar = buf[4] >= FLUX_VERSION_COLUMNAR,
+        .dict = dict,
+        .dict_keys = flux_dictionary_key_count(dict),
+        .max_depth = max_depth > 0 ? max_depth : CROUS_MAX_DEPTH,
+        .value_refs = buf[4] >= FLUX_VERSION_VALUE_REFS,
+        /* Heap trees can't hold a node twice: freeing would reach it twice */
+        .share_nodes = share_nodes && arena,
+        .ref_budget = binary_ref_budget(buf_size)
+    };
+    
+    err = deserialize_value_binary(&ctx, out_value, 0);
+    free(ctx.keys);
+    free(ctx.shares);
+    return err;
+}
+
+crous_err_t flux_value_read(const uint8_t *buf, size_t buf_size, size_t *pos, crous_arena *arena, int max_depth,
+                            crous_value **out_value) {
+    if (!buf || !pos || !out_value || *pos > buf_size) return CROUS_ERR_INVALID_TYPE;
+    
+    flux_decode_buf_t ctx = {
+        .buf = buf,
+        .pos = *pos,
+        .len = buf_size,
+        .arena = arena,
+        .max_depth = max_depth > 0 ? max_depth : CROUS_MAX_DEPTH
+    };
+    
+    crous_err_t err = deserialize_value_binary(&ctx, out_value, 0);
+    if (err == CROUS_OK) *pos = ctx.pos;
+    return err;
+}
+
+crous_err_t flux_decode_binary_arena(const uint8_t *buf, size_t buf_size, crous_arena *arena, crous_value **out_value) {
+    crous_span span;
+    crous_span_begin(&span, "flux_decode_binary_arena", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, buf_size);
+    return crous_span_end(&span, flux_decode_binary_mode(buf, buf_size, arena, 0, 0, 0, NULL, out_value), 0);
+}
+
+crous_err_t flux_decode_binary_borrowed(const uint8_t *buf, size_t buf_size, crous_arena *arena, crous_value **out_value) {
+    crous_span span;
+    crous_span_begin(&span, "flux_decode_binary_borrowed", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, buf_size);
+    return crous_span_end(&span, flux_decode_binary_mode(buf, buf_size, arena, 1, 0, 0, NULL, out_value), 0);
+}
+
+crous_err_t flux_decode_binary(const uint8_t *buf, size_t buf_size, crous_value **out_value) {
+    crous_span span;
+    crous_span_begin(&span, "flux_decode_binary", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, buf_size);
+    return crous_span_end(&span, flux_decode_binary_mode(buf, buf_size, NULL, 0, 0, 0, NULL, out_value), 0);
+}
+
+flux_decode_options_t flux_decode_options_default(void) {
+    flux_decode_options_t opts = { .max_depth = CROUS_MAX_DEPTH, .borrow = 0, .share_refs = 0 };
+    return opts;
+}
+
+crous_err_t flux_decode_binary_opts(const uint8_t *buf, size_t buf_size, crous_arena *arena,
+                                    const flux_decode_options_t *opts, crous_value **out_value) {
+    crous_span span;
+    crous_span_begin(&span, "flux_decode_binary_opts", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, buf_size);
+    crous_err_t err = flux_decode_binary_mode(buf, buf_size, arena, opts && opts->borrow,
+                                              opts && opts->share_refs,
+                                              opts ? opts->max_depth : 0, NULL, out_value);
+    return crous_span_end(&span, err, 0);
+}
+
+/* ============================================================================
+   FLUX BINARY SKIPPING
+   ============================================================================ */
+
+/*
+ * Step over encoded values without building them, with the same limits and
+ * checks as the decoder. Dict and table keys still go through
+ * binary_read_key() so the wire v3 key table stays complete.
+ */
+
+static crous_err_t skip_value_binary(flux_decode_buf_t *ctx, int depth);
+
+/* Length varint followed by that many payload bytes */
+static crous_err_t skip_span_binary(flux_decode_buf_t *ctx, uint64_t max_len) {
+    uint64_t len;
+    const uint8_t *data;
+    crous_err_t err = binary_read_varint(ctx, &len);
+    if (err != CROUS_OK) return err;
+    if (len > max_len) return CROUS_ERR_DECODE;
+    return binary_read_span(ctx, len, &data);
+}
+
+/* One cell of a variable-width column (ANY, INT, INT_DELTA or STRING) */
+static crous_err_t skip_cell_binary(flux_decode_buf_t *ctx, uint8_t kind, int depth) {
+    uint64_t n;
+    
+    switch (kind) {
+        case FLUX_COLUMN_ANY:
+            return skip_value_binary(ctx, depth + 2);
+        case FLUX_COLUMN_INT:
+        case FLUX_COLUMN_INT_DELTA:
+            return binary_read_varint(ctx, &n);
+        case FLUX_COLUMN_STRING:
+            return skip_span_binary(ctx, CROUS_MAX_STRING_BYTES);
+        default:
+            return CROUS_ERR_DECODE;
+    }
+}
+
+/* Column body after its kind byte */
+static crous_err_t skip_column_binary(flux_decode_buf_t *ctx, uint8_t kind, uint64_t rows, int depth) {
+    const uint8_t *data;
+    
+    if (kind == FLUX_COLUMN_BOOL) return binary_read_span(ctx, (rows + 7) / 8, &data);
+    if (kind == FLUX_COLUMN_FLOAT) {
+        if (rows > (ctx->len - ctx->pos) / 8) return CROUS_ERR_TRUNCATED;
+        ctx->pos += (size_t)rows * 8;
+        return CROUS_OK;
+    }
+    
+    for (uint64_t r = 0; r < rows; r++) {
+        crous_err_t err = skip_cell_binary(ctx, kind, depth);
+        if (err != CROUS_OK) return err;
+    }
+    return CROUS_OK;
+}
+
+static crous_err_t skip_table_binary(flux_decode_buf_t *ctx, int depth) {
+    uint64_t rows, cols;
+    crous_err_t err = binary_read_table_shape(ctx, depth, &rows, &cols);
+    if (err != CROUS_OK) return err;
+    
+    for (uint64_t c = 0; c < cols; c++) {
+        const uint8_t *key;
+        size_t key_len;
+        err = binary_read_key(ctx, &key, &key_len);
+        if (err != CROUS_OK) return err;
+    }
+    
+    for (uint64_t c = 0; c < cols; c++) {
+        uint8_t kind;
+        err = binary_read(ctx, &kind, 1);
+        if (err == CROUS_OK) err = skip_column_binary(ctx, kind, rows, depth);
+        if (err != CROUS_OK) return err;
+    }
+    return CROUS_OK;
+}
+
+/* Payload of a value whose tag has been read */
+static crous_err_t skip_payload_binary(flux_decode_buf_t *ctx, uint8_t tag, int depth) {
+    uint64_t n;
+    const uint8_t *data;
+    crous_err_t err;
+    
+    switch (tag) {
+        case FLUX_TAG_NULL:
+        case FLUX_TAG_FALSE:
+        case FLUX_TAG_TRUE:
+            return CROUS_OK;
+        
+        case FLUX_TAG_INT:
+            return binary_read_varint(ctx, &n);
+        
+        case FLUX_TAG_FLOAT:
+            return binary_read_span(ctx, 8, &data);
+        
+        case FLUX_TAG_STRING:
+            return skip_span_binary(ctx, CROUS_MAX_STRING_BYTES);
+        
+        case FLUX_TAG_BYTES:
+            return skip_span_binary(ctx, CROUS_MAX_BYTES_SIZE);
+        
+        case FLUX_TAG_LIST:
+        case FLUX_TAG_TUPLE:
+            err = binary_read_varint(ctx, &n);
+            if (err != CROUS_OK) return err;
+            if (n > CROUS_MAX_LIST_SIZE) return CROUS_ERR_DECODE;
+            if (n > ctx->len - ctx->pos) return CROUS_ERR_TRUNCATED;
+            for (uint64_t i = 0; i < n; i++) {
+                err = skip_value_binary(ctx, depth + 1);
+                if (err != CROUS_OK) return err;
+            }
+            return CROUS_OK;
+        
+        case FLUX_TAG_DICT:
+            err = binary_read_varint(ctx, &n);
+            if (err != CROUS_OK) return err;
+            if (n > CROUS_MAX_DICT_SIZE) return CROUS_ERR_DECODE;
+            if (n > (ctx->len - ctx->pos) / 2) return CROUS_ERR_TRUNCATED;
+            for (uint64_t i = 0; i < n; i++) {
+                const uint8_t *key;
+                size_t key_len;
+                err = binary_read_key(ctx, &key, &key_len);
+                if (err == CROUS_OK) err = skip_value_binary(ctx, depth + 1);
+                if (err != CROUS_OK) return err;
+            }
+            return CROUS_OK;
+        
+        case FLUX_TAG_TAGGED:
+            err = binary_read_varint(ctx, &n);
+            if (err != CROUS_OK) return err;
+            return skip_value_binary(ctx, depth + 1);
+        
+        case FLUX_TAG_TABLE:
+            if (!ctx->columnar) return CROUS_ERR_DECODE;
+            return skip_table_binary(ctx, depth);
+        
+        case FLUX_TAG_I64_ARRAY:
+        case FLUX_TAG_F64_ARRAY:
+            return binary_read_packed(ctx, &n, &data);
+        
+        default:
+            return CROUS_ERR_DECODE;
+    }
+}
+
+static crous_err_t skip_value_binary(flux_decode_buf_t *ctx, int depth) {
+    if (depth >= CROUS_MAX_DEPTH) return CROUS_ERR_DECODE;
+    
+    uint8_t tag;
+    crous_err_t err = binary_read(ctx, &tag, 1);
+    if (err != CROUS_OK) return err;
+    
+    /* A REF is over once read; a shared value is complete once skipped */
+    size_t share = 0, ref = 0;
+    if (tag == FLUX_TAG_SHARE || tag == FLUX_TAG_REF) {
+        err = binary_read_share(ctx, &tag, &share, &ref);
+        if (err != CROUS_OK || ref) return err;
+    }
+    err = skip_payload_binary(ctx, tag, depth);
+    if (err == CROUS_OK && share) binary_share_complete(ctx, share, NULL);
+    return err;
+}
+
+/* ============================================================================
+   FLUX LAZY VIEWS
+   ============================================================================ */
+
+/* A column of the cached table. The cursor makes ascending row reads of
+ * variable-width columns linear overall. */
+typedef struct {
+    flux_key_span_t key;
+    size_t pos;             /* Offset of the column body, past its kind byte */
+    uint8_t kind;
+    size_t row;             /* Cursor: the row whose cell starts at at */
+    size_t at;
+    int64_t prev;           /* Delta columns: value of the row before row */
+} flux_view_column_t;
+
+struct flux_view_doc {
+    flux_decode_buf_t ctx;  /* Buffer, wire flags and the key table; pos is scratch */
+    
+    /* Resume point of the last ascending walk through a list */
+    size_t seq_list;        /* Payload offset of that list, 0 = none */
+    size_t seq_index;
+    size_t seq_pos;
+    
+    /* Columns of the last table whose rows were read */
+    size_t table_pos;       /* Payload offset of that table, 0 = none */
+    size_t table_rows;
+    size_t table_cols;
+    flux_view_column_t *columns;
+    size_t columns_cap;
+    
+    uint8_t *unpacked;      /* Decompressed copy of an enveloped document, or NULL */
+};
+
+static const crous_type_t view_tag_types[] = {
+    [FLUX_TAG_NULL] = CROUS_TYPE_NULL,
+    [FLUX_TAG_FALSE] = CROUS_TYPE_BOOL,
+    [FLUX_TAG_TRUE] = CROUS_TYPE_BOOL,
+    [FLUX_TAG_INT] = CROUS_TYPE_INT,
+    [FLUX_TAG_FLOAT] = CROUS_TYPE_FLOAT,
+    [FLUX_TAG_STRING] = CROUS_TYPE_STRING,
+    [FLUX_TAG_BYTES] = CROUS_TYPE_BYTES,
+    [FLUX_TAG_LIST] = CROUS_TYPE_LIST,
+    [FLUX_TAG_DICT] = CROUS_TYPE_DICT,
+    [FLUX_TAG_TAGGED] = CROUS_TYPE_TAGGED,
+    [FLUX_TAG_TUPLE] = CROUS_TYPE_TUPLE,
+    [FLUX_TAG_TABLE] = CROUS_TYPE_LIST,
+    [FLUX_TAG_I64_ARRAY] = CROUS_TYPE_I64_ARRAY,
+    [FLUX_TAG_F64_ARRAY] = CROUS_TYPE_F64_ARRAY,
+};
+
+static void view_set(flux_view_t *out, flux_view_doc_t *doc, uint8_t tag, uint8_t form,
+                     size_t pos, int64_t ival, int depth) {
+    out->doc = doc;
+    out->pos = pos;
+    out->row = 0;
+    out->ival = ival;
+    out->tag = tag;
+    out->form = form;
+    out->depth = depth;
+}
+
+/* View of the tagged value at pos */
+static crous_err_t view_at(flux_view_doc_t *doc, size_t pos, int depth, flux_view_t *out) {
+    flux_decode_buf_t *ctx = &doc->ctx;
+    
+    if (depth >= CROUS_MAX_DEPTH) return CROUS_ERR_DECODE;
+    if (pos >= ctx->len) return CROUS_ERR_TRUNCATED;
+    
+    uint8_t tag = ctx->buf[pos];
+    
+    /* Wire v5: a SHARE is stepped over, a REF views its shared value */
+    if (tag == FLUX_TAG_SHARE || tag == FLUX_TAG_REF) {
+        size_t share, ref;
+        ctx->pos = pos + 1;
+        crous_err_t err = binary_read_share(ctx, &tag, &share, &ref);
+        if (err != CROUS_OK) return err;
+        pos = ref ? ctx->shares[ref - 1].pos : ctx->pos - 1;
+        tag = ctx->buf[pos];
+    }
+    if (tag > FLUX_TAG_F64_ARRAY || (tag == FLUX_TAG_TABLE && !ctx->columnar)) return CROUS_ERR_DECODE;
+    
+    int64_t ival = 0;
+    if (tag == FLUX_TAG_INT) {
+        uint64_t encoded;
+        ctx->pos = pos + 1;
+        crous_err_t err = binary_read_varint(ctx, &encoded);
+        if (err != CROUS_OK) return err;
+        ival = crous_zigzag_decode(encoded);
+    }
+    
+    view_set(out, doc, tag, FLUX_VIEW_VALUE, pos + 1, ival, depth);
+    return CROUS_OK;
+}
+
+/* Element count at the start of a container, string or packed array payload,
+ * with the decoder's limits. Leaves ctx->pos just past the count. */
+static crous_err_t view_read_count(const flux_view_t *v, uint64_t *count) {
+    flux_decode_buf_t *ctx = &v->doc->ctx;
+    ctx->pos = v->pos;
+    
+    crous_err_t err = binary_read_varint(ctx, count);
+    if (err != CROUS_OK) return err;
+    
+    switch (v->tag) {
+        case FLUX_TAG_LIST:
+        case FLUX_TAG_TUPLE:
+            if (*count > CROUS_MAX_LIST_SIZE) return CROUS_ERR_DECODE;
+            if (*count > ctx->len - ctx->pos) return CROUS_ERR_TRUNCATED;
+            return CROUS_OK;
+        case FLUX_TAG_DICT:
+            if (*count > CROUS_MAX_DICT_SIZE) return CROUS_ERR_DECODE;
+            if (*count > (ctx->len - ctx->pos) / 2) return CROUS_ERR_TRUNCATED;
+            return CROUS_OK;
+        case FLUX_TAG_STRING:
+            return *count > CROUS_MAX_STRING_BYTES ? CROUS_ERR_DECODE : CROUS_OK;
+        case FLUX_TAG_BYTES:
+            return *count > CROUS_MAX_BYTES_SIZE ? CROUS_ERR_DECODE : CROUS_OK;
+        case FLUX_TAG_I64_ARRAY:
+        case FLUX_TAG_F64_ARRAY:
+            return *count > CROUS_MAX_ARRAY_LEN ? CROUS_ERR_DECODE : CROUS_OK;
+        default:
+            return CROUS_ERR_INVALID_TYPE;
+    }
+}
+
+/* Read the head of the table whose payload starts at pos and locate every
+ * column, unless it is the table already cached */
+static crous_err_t view_load_table(flux_view_doc_t *doc, size_t pos, int depth) {
+    flux_decode_buf_t *ctx = &doc->ctx;
+    if (doc->table_pos == pos) return CROUS_OK;
+    
+    doc->table_pos = 0;
+    ctx->pos = pos;
+    
+    uint64_t rows, cols;
+    crous_err_t err = binary_read_table_shape(ctx, depth, &rows, &cols);
+    if (err != CROUS_OK) return err;
+    
+    if (cols > doc->columns_cap) {
+        flux_view_column_t *columns = realloc(doc->columns, (size_t)cols * sizeof(*columns));
+        if (!columns) return CROUS_ERR_OOM;
+        doc->columns = columns;
+        doc->columns_cap = (size_t)cols;
+    }
+    
+    for (uint64_t c = 0; c < cols; c++) {
+        err = binary_read_key(ctx, &doc->columns[c].key.data, &doc->columns[c].key.len);
+        if (err != CROUS_OK) return err;
+    }
+    
+    for (uint64_t c = 0; c < cols; c++) {
+        flux_view_column_t *col = &doc->columns[c];
+        err = binary_read(ctx, &col->kind, 1);
+        if (err != CROUS_OK) return err;
+        if (col->kind > FLUX_COLUMN_STRING) return CROUS_ERR_DECODE;
+        
+        col->pos = col->at = ctx->pos;
+        col->row = 0;
+        col->prev = 0;
+        err = skip_column_binary(ctx, col->kind, rows, depth);
+        if (err != CROUS_OK) return err;
+    }
+    
+    doc->table_pos = pos;
+    doc->table_rows = (size_t)rows;
+    doc->table_cols = (size_t)cols;
+    return CROUS_OK;
+}
+
+/* Cell of column col in row row of the cached table, which sits at depth */
+static crous_err_t view_table_cell(flux_view_doc_t *doc, size_t row, size_t col, int depth,
+                                   flux_view_t *out) {
+    flux_decode_buf_t *ctx = &doc->ctx;
+    flux_view_column_t *c = &doc->columns[col];
+    uint64_t n;
+    crous_err_t err;
+    
+    if (c->kind == FLUX_COLUMN_BOOL) {
+        int bit = (ctx->buf[c->pos + row / 8] >> (row % 8)) & 1;
+        view_set(out, doc, bit ? FLUX_TAG_TRUE : FLUX_TAG_FALSE, FLUX_VIEW_CELL, c->pos, 0, depth + 2);
+        return CROUS_OK;
+    }
+    if (c->kind == FLUX_COLUMN_FLOAT) {
+        view_set(out, doc, FLUX_TAG_FLOAT, FLUX_VIEW_CELL, c->pos + row * 8, 0, depth + 2);
+        return CROUS_OK;
+    }
+    
+    /* Variable-width cells: walk forward from the cursor */
+    if (row < c->row) {
+        c->row = 0;
+        c->at = c->pos;
+        c->prev = 0;
+    }
+    ctx->pos = c->at;
+    while (c->row < row) {
+        if (c->kind == FLUX_COLUMN_INT_DELTA) {
+            err = binary_read_varint(ctx, &n);
+            if (err != CROUS_OK) return err;
+            c->prev = (int64_t)((uint64_t)c->prev + (uint64_t)crous_zigzag_decode(n));
+        } else {
+            err = skip_cell_binary(ctx, c->kind, depth);
+            if (err != CROUS_OK) return err;
+        }
+        c->row++;
+        c->at = ctx->pos;
+    }
+    
+    switch (c->kind) {
+        case FLUX_COLUMN_ANY:
+            return view_at(doc, c->at, depth + 2, out);
+        
+        case FLUX_COLUMN_INT:
+        case FLUX_COLUMN_INT_DELTA: {
+            err = binary_read_varint(ctx, &n);
+            if (err != CROUS_OK) return err;
+            int64_t val = crous_zigzag_decode(n);
+            if (c->kind == FLUX_COLUMN_INT_DELTA) val = (int64_t)((uint64_t)c->prev + (uint64_t)val);
+            view_set(out, doc, FLUX_TAG_INT, FLUX_VIEW_CELL, c->at, val, depth + 2);
+            return CROUS_OK;
+        }
+        
+        default:
+            view_set(out, doc, FLUX_TAG_STRING, FLUX_VIEW_CELL, c->at, 0, depth + 2);
+            return CROUS_OK;
+    }
+}
+
+/* Element i of a packed array whose elements start at data */
+static void view_array_element(flux_view_doc_t *doc, const flux_view_t *v, const uint8_t *data,
+                               size_t i, flux_view_t *out) {
+    size_t pos = (size_t)(data - doc->ctx.buf) + i * 8;
+    if (v->tag == FLUX_TAG_I64_ARRAY) {
+        int64_t val;
+        memcpy(&val, doc->ctx.buf + pos, 8);
+        view_set(out, doc, FLUX_TAG_INT, FLUX_VIEW_CELL, pos, val, v->depth + 1);
+    } else {
+        view_set(out, doc, FLUX_TAG_FLOAT, FLUX_VIEW_CELL, pos, 0, v->depth + 1);
+    }
+}
+
+crous_err_t flux_view_open(const uint8_t *buf, size_t buf_size, flux_view_doc_t **out_doc) {
+    if (!buf || !out_doc) return CROUS_ERR_INVALID_TYPE;
+    
+    /* A compressed document is unpacked once, and read from the copy */
+    uint8_t *raw = NULL;
+    const flux_dictionary_t *dict = NULL;
+    if (flux_binary_is_compressed(buf, buf_size)) {
+        crous_err_t err = binary_unpack(buf, buf_size, NULL, &raw, &buf_size, &dict);
+        if (err != CROUS_OK) return err;
+        buf = raw;
+    }
+    
+    crous_err_t err = binary_check_header(buf, buf_size);
+    if (err != CROUS_OK) {
+        free(raw);
+        return err;
+    }
+    
+    flux_view_doc_t *doc = calloc(1, sizeof(*doc));
+    if (!doc) {
+        free(raw);
+        return CROUS_ERR_OOM;
+    }
+    
+    doc->unpacked = raw;
+    doc->ctx.buf = buf;
+    doc->ctx.pos = 6;
+    doc->ctx.len = buf_size;
+    doc->ctx.key_refs = buf[4] >= FLUX_VERSION_KEY_REFS;
+    doc->ctx.columnar = buf[4] >= FLUX_VERSION_COLUMNAR;
+    doc->ctx.value_refs = buf[4] >= FLUX_VERSION_VALUE_REFS;
+    doc->ctx.dict = dict;
+    doc->ctx.dict_keys = flux_dictionary_key_count(dict);
+    doc->ctx.max_depth = CROUS_MAX_DEPTH;
+    
+    *out_doc = doc;
+    return CROUS_OK;
+}
+
+void flux_view_close(flux_view_doc_t *doc) {
+    if (!doc) return;
+    free(doc->ctx.keys);
+    free(doc->ctx.shares);
+    free(doc->columns);
+    free(doc->unpacked);
+    free(doc);
+}
+
+crous_err_t flux_view_root(flux_view_doc_t *doc, flux_view_t *out) {
+    if (!doc || !out) return CROUS_ERR_INVALID_TYPE;
+    return view_at(doc, 6, 0, out);
+}
+
+crous_type_t flux_view_type(const flux_view_t *view) {
+    return view_tag_types[view->tag];
+}
+
+crous_err_t flux_view_len(const flux_view_t *view, size_t *out_len) {
+    if (!view || !out_len) return CROUS_ERR_INVALID_TYPE;
+    flux_view_doc_t *doc = view->doc;
+    
+    if (view->form == FLUX_VIEW_ROW) {
+        crous_err_t err = view_load_table(doc, view->pos, view->depth - 1);
+        if (err != CROUS_OK) return err;
+        *out_len = doc->table_cols;
+        return CROUS_OK;
+    }
+    if (view->tag == FLUX_TAG_TABLE) {
+        crous_err_t err = view_load_table(doc, view->pos, view->depth);
+        if (err != CROUS_OK) return err;
+        *out_len = doc->table_rows;
+        return CROUS_OK;
+    }
+    uint64_t count;
+    crous_err_t err = view_read_count(view, &count);
+    if (err != CROUS_OK) return err;
+    *out_len = (size_t)count;
+    return CROUS_OK;
+}
+
+crous_err_t flux_view_index(const flux_view_t *view, size_t index, flux_view_t *out) {
+    if (!view || !out) return CROUS_ERR_INVALID_TYPE;
+    flux_view_doc_t *doc = view->doc;
+    flux_decode_buf_t *ctx = &doc->ctx;
+    uint64_t count;
+    const uint8_t *data;
+    crous_err_t err;
+    
+    if (view->form == FLUX_VIEW_ROW) return CROUS_ERR_INVALID_TYPE;
+    
+    switch (view->tag) {
+        case FLUX_TAG_LIST:
+        case FLUX_TAG_TUPLE: {
+            err = view_read_count(view, &count);
+            if (err != CROUS_OK) return err;
+            if (index >= count) return CROUS_ERR_NOT_FOUND;
             
-            err = binary_read(ctx, str_data, len);
-            if (err != CROUS_OK) {
-                free(str_data);
-                return err;
+            /* Resume the last walk through this list when it got no further */
+            size_t i = 0;
+            if (doc->seq_list == view->pos && doc->seq_index <= index) {
+                i = doc->seq_index;
+                ctx->pos = doc->seq_pos;
             }
-            
-            v = crous_value_new_string((const char *)str_data, len);
-            free(str_data);
-            if (!v) return CROUS_ERR_OOM;
+            for (; i < index; i++) {
+                err = skip_value_binary(ctx, view->depth + 1);
+                if (err != CROUS_OK) return err;
+            }
+            doc->seq_list = view->pos;
+            doc->seq_index = index;
+            doc->seq_pos = ctx->pos;
+            return view_at(doc, doc->seq_pos, view->depth + 1, out);
+        }
+        
+        case FLUX_TAG_TABLE:
+            err = view_load_table(doc, view->pos, view->depth);
+            if (err != CROUS_OK) return err;
+            if (index >= doc->table_rows) return CROUS_ERR_NOT_FOUND;
+            view_set(out, doc, FLUX_TAG_DICT, FLUX_VIEW_ROW, view->pos, 0, view->depth + 1);
+            out->row = index;
+            return CROUS_OK;
+        
+        case FLUX_TAG_I64_ARRAY:
+        case FLUX_TAG_F64_ARRAY:
+            ctx->pos = view->pos;
+            err = binary_read_packed(ctx, &count, &data);
+            if (err != CROUS_OK) return err;
+            if (index >= count) return CROUS_ERR_NOT_FOUND;
+            view_array_element(doc, view, data, index, out);
+            return CROUS_OK;
+        
+        default:
+            return CROUS_ERR_INVALID_TYPE;
+    }
+}
+
+crous_err_t flux_view_get_key(const flux_view_t *view, const char *key, size_t key_len, flux_view_t *out) {
+    if (!view || !out || (!key && key_len)) return CROUS_ERR_INVALID_TYPE;
+    if (view->tag != FLUX_TAG_DICT) return CROUS_ERR_INVALID_TYPE;
+    flux_view_doc_t *doc = view->doc;
+    flux_decode_buf_t *ctx = &doc->ctx;
+    crous_err_t err;
+    
+    if (view->form == FLUX_VIEW_ROW) {
+        err = view_load_table(doc, view->pos, view->depth - 1);
+        if (err != CROUS_OK) return err;
+        for (size_t c = 0; c < doc->table_cols; c++) {
+            const flux_key_span_t *k = &doc->columns[c].key;
+            if (k->len == key_len && (key_len == 0 || memcmp(k->data, key, key_len) == 0))
+                return view_table_cell(doc, view->row, c, view->depth - 1, out);
+        }
+        return CROUS_ERR_NOT_FOUND;
+    }
+    
+    uint64_t count;
+    err = view_read_count(view, &count);
+    if (err != CROUS_OK) return err;
+    
+    for (uint64_t i = 0; i < count; i++) {
+        const uint8_t *k;
+        size_t k_len;
+        err = binary_read_key(ctx, &k, &k_len);
+        if (err != CROUS_OK) return err;
+        if (k_len == key_len && (key_len == 0 || memcmp(k, key, key_len) == 0))
+            return view_at(doc, ctx->pos, view->depth + 1, out);
+        err = skip_value_binary(ctx, view->depth + 1);
+        if (err != CROUS_OK) return err;
+    }
+    return CROUS_ERR_NOT_FOUND;
+}
+
+crous_err_t flux_view_iter_init(const flux_view_t *view, flux_view_iter_t *it) {
+    if (!view || !it) return CROUS_ERR_INVALID_TYPE;
+    flux_view_doc_t *doc = view->doc;
+    uint64_t count;
+    const uint8_t *data;
+    crous_err_t err;
+    
+    it->parent = *view;
+    it->index = 0;
+    it->pos = 0;
+    
+    if (view->form == FLUX_VIEW_ROW || view->tag == FLUX_TAG_TABLE) {
+        int table_depth = view->form == FLUX_VIEW_ROW ? view->depth - 1 : view->depth;
+        err = view_load_table(doc, view->pos, table_depth);
+        if (err != CROUS_OK) return err;
+        it->count = view->form == FLUX_VIEW_ROW ? doc->table_cols : doc->table_rows;
+        return CROUS_OK;
+    }
+    
+    switch (view->tag) {
+        case FLUX_TAG_LIST:
+        case FLUX_TAG_TUPLE:
+        case FLUX_TAG_DICT:
+            err = view_read_count(view, &count);
+            if (err != CROUS_OK) return err;
+            it->count = (size_t)count;
+            it->pos = doc->ctx.pos;
+            return CROUS_OK;
+        
+        case FLUX_TAG_I64_ARRAY:
+        case FLUX_TAG_F64_ARRAY:
+            doc->ctx.pos = view->pos;
+            err = binary_read_packed(&doc->ctx, &count, &data);
+            if (err != CROUS_OK) return err;
+            it->count = (size_t)count;
+            it->pos = (size_t)(data - doc->ctx.buf);
+            return CROUS_OK;
+        
+        default:
+            return CROUS_ERR_INVALID_TYPE;
+    }
+}
+
+crous_err_t flux_view_next(flux_view_iter_t *it, const char **key, size_t *key_len, flux_view_t *out) {
+    if (!it || !out) return CROUS_ERR_INVALID_TYPE;
+    if (it->index >= it->count) return CROUS_ERR_NOT_FOUND;
+    
+    const flux_view_t *v = &it->parent;
+    flux_view_doc_t *doc = v->doc;
+    flux_decode_buf_t *ctx = &doc->ctx;
+    crous_err_t err;
+    
+    if (key) *key = NULL;
+    if (key_len) *key_len = 0;
+    
+    if (v->form == FLUX_VIEW_ROW) {
+        err = view_load_table(doc, v->pos, v->depth - 1);
+        if (err == CROUS_OK) err = view_table_cell(doc, v->row, it->index, v->depth - 1, out);
+        if (err != CROUS_OK) return err;
+        if (key) *key = (const char *)doc->columns[it->index].key.data;
+        if (key_len) *key_len = doc->columns[it->index].key.len;
+        it->index++;
+        return CROUS_OK;
+    }
+    
+    switch (v->tag) {
+        case FLUX_TAG_LIST:
+        case FLUX_TAG_TUPLE:
+            err = view_at(doc, it->pos, v->depth + 1, out);
+            if (err != CROUS_OK) return err;
+            ctx->pos = it->pos;
+            break;
+        
+        case FLUX_TAG_DICT: {
+            const uint8_t *k;
+            size_t k_len;
+            ctx->pos = it->pos;
+            err = binary_read_key(ctx, &k, &k_len);
+            if (err != CROUS_OK) return err;
+            size_t value_pos = ctx->pos;
+            err = view_at(doc, value_pos, v->depth + 1, out);
+            if (err != CROUS_OK) return err;
+            if (key) *key = (const char *)k;
+            if (key_len) *key_len = k_len;
+            ctx->pos = value_pos;
+            break;
+        }
+        
+        case FLUX_TAG_TABLE:
+            view_set(out, doc, FLUX_TAG_DICT, FLUX_VIEW_ROW, v->pos, 0, v->depth + 1);
+            out->row = it->index++;
+            return CROUS_OK;
+        
+        case FLUX_TAG_I64_ARRAY:
+        case FLUX_TAG_F64_ARRAY:
+            view_array_element(doc, v, ctx->buf + it->pos, it->index++, out);
+            return CROUS_OK;
+        
+        default:
+            return CROUS_ERR_INVALID_TYPE;
+    }
+    
+    /* Lists and dicts: step over the element to reach the next one */
+    err = skip_value_binary(ctx, v->depth + 1);
+    if (err != CROUS_OK) return err;
+    it->pos = ctx->pos;
+    it->index++;
+    return CROUS_OK;
+}
+
+crous_err_t flux_view_skip(const flux_view_t *view, size_t *out_end) {
+    if (!view || !out_end) return CROUS_ERR_INVALID_TYPE;
+    if (view->form != FLUX_VIEW_VALUE) return CROUS_ERR_INVALID_TYPE;
+    
+    flux_decode_buf_t *ctx = &view->doc->ctx;
+    ctx->pos = view->pos - 1;
+    crous_err_t err = skip_value_binary(ctx, view->depth);
+    if (err != CROUS_OK) return err;
+    *out_end = ctx->pos;
+    return CROUS_OK;
+}
+
+crous_err_t flux_view_get_bool(const flux_view_t *view, int *out) {
+    if (!view || !out) return CROUS_ERR_INVALID_TYPE;
+    if (view->tag != FLUX_TAG_TRUE && view->tag != FLUX_TAG_FALSE) return CROUS_ERR_INVALID_TYPE;
+    *out = view->tag == FLUX_TAG_TRUE;
+    return CROUS_OK;
+}
+
+crous_err_t flux_view_get_int(const flux_view_t *view, int64_t *out) {
+    if (!view || !out || view->tag != FLUX_TAG_INT) return CROUS_ERR_INVALID_TYPE;
+    *out = view->ival;
+    return CROUS_OK;
+}
+
+crous_err_t flux_view_get_float(const flux_view_t *view, double *out) {
+    if (!view || !out || view->tag != FLUX_TAG_FLOAT) return CROUS_ERR_INVALID_TYPE;
+    flux_decode_buf_t *ctx = &view->doc->ctx;
+    uint8_t bytes[8];
+    ctx->pos = view->pos;
+    crous_err_t err = binary_read(ctx, bytes, 8);
+    if (err != CROUS_OK) return err;
+    memcpy(out, bytes, 8);
+    return CROUS_OK;
+}
+
+/* Length-prefixed payload of a string or bytes view */
+static crous_err_t view_read_payload(const flux_view_t *view, const uint8_t **out, size_t *out_len) {
+    uint64_t len;
+    crous_err_t err = view_read_count(view, &len);
+    if (err != CROUS_OK) return err;
+    err = binary_read_span(&view->doc->ctx, (size_t)len, out);
+    if (err != CROUS_OK) return err;
+    *out_len = (size_t)len;
+    return CROUS_OK;
+}
+
+crous_err_t flux_view_get_string(const flux_view_t *view, const char **out, size_t *out_len) {
+    if (!view || !out || !out_len || view->tag != FLUX_TAG_STRING) return CROUS_ERR_INVALID_TYPE;
+    return view_read_payload(view, (const uint8_t **)out, out_len);
+}
+
+crous_err_t flux_view_get_bytes(const flux_view_t *view, const uint8_t **out, size_t *out_len) {
+    if (!view || !out || !out_len || view->tag != FLUX_TAG_BYTES) return CROUS_ERR_INVALID_TYPE;
+    return view_read_payload(view, out, out_len);
+}
+
+crous_err_t flux_view_get_tagged(const flux_view_t *view, uint32_t *out_tag, flux_view_t *out_inner) {
+    if (!view || !out_tag || !out_inner || view->tag != FLUX_TAG_TAGGED) return CROUS_ERR_INVALID_TYPE;
+    flux_decode_buf_t *ctx = &view->doc->ctx;
+    uint64_t tag_num;
+    ctx->pos = view->pos;
+    crous_err_t err = binary_read_varint(ctx, &tag_num);
+    if (err != CROUS_OK) return err;
+    *out_tag = (uint32_t)tag_num;
+    return view_at(view->doc, ctx->pos, view->depth + 1, out_inner);
+}
+
+crous_err_t flux_view_get_array(const flux_view_t *view, const uint8_t **out_data, size_t *out_count) {
+    if (!view || !out_data || !out_count) return CROUS_ERR_INVALID_TYPE;
+    if (view->tag != FLUX_TAG_I64_ARRAY && view->tag != FLUX_TAG_F64_ARRAY) return CROUS_ERR_INVALID_TYPE;
+    flux_decode_buf_t *ctx = &view->doc->ctx;
+    uint64_t count;
+    ctx->pos = view->pos;
+    crous_err_t err = binary_read_packed(ctx, &count, out_data);
+    if (err != CROUS_OK) return err;
+    *out_count = (size_t)count;
+    return CROUS_OK;
+}
+
+/* A table row, rebuilt as the dict it was written from */
+static crous_err_t view_decode_row(const flux_view_t *view, crous_arena *arena, crous_value **out_value) {
+    flux_view_iter_t it;
+    crous_err_t err = flux_view_iter_init(view, &it);
+    if (err != CROUS_OK) return err;
+    
+    crous_value *dict = crous_value_new_dict_arena(arena, it.count);
+    if (!dict) return CROUS_ERR_OOM;
+    
+    const char *key;
+    size_t key_len;
+    flux_view_t cell;
+    while ((err = flux_view_next(&it, &key, &key_len, &cell)) == CROUS_OK) {
+        crous_value *val = NULL;
+        err = flux_view_decode(&cell, arena, &val);
+        if (err == CROUS_OK) {
+            err = crous_value_dict_append_arena(arena, dict, key, key_len, val);
+            if (err != CROUS_OK) crous_value_free_tree(val);
+        }
+        if (err != CROUS_OK) break;
+    }
+    
+    if (err != CROUS_ERR_NOT_FOUND) {
+        crous_value_free_tree(dict);
+        return err;
+    }
+    *out_value = dict;
+    return CROUS_OK;
+}
+
+crous_err_t flux_view_decode(const flux_view_t *view, crous_arena *arena, crous_value **out_value) {
+    if (!view || !out_value) return CROUS_ERR_INVALID_TYPE;
+    flux_decode_buf_t *ctx = &view->doc->ctx;
+    crous_value *v = NULL;
+    crous_err_t err;
+    
+    if (view->form == FLUX_VIEW_ROW) return view_decode_row(view, arena, out_value);
+    
+    if (view->form == FLUX_VIEW_VALUE) {
+        /* binary_read_key() leaves keys already in the table alone, so the
+           decoder can run over a stretch a view has walked before */
+        ctx->pos = view->pos - 1;
+        ctx->arena = arena;
+        ctx->ref_budget = binary_ref_budget(ctx->len);
+        err = deserialize_value_binary(ctx, out_value, view->depth);
+        ctx->arena = NULL;
+        return err;
+    }
+    
+    switch (view->tag) {
+        case FLUX_TAG_FALSE:
+        case FLUX_TAG_TRUE:
+            v = crous_value_new_bool_arena(arena, view->tag == FLUX_TAG_TRUE);
+            break;
+        
+        case FLUX_TAG_INT:
+            v = crous_value_new_int_arena(arena, view->ival);
+            break;
+        
+        case FLUX_TAG_FLOAT: {
+            double d;
+            err = flux_view_get_float(view, &d);
+            if (err != CROUS_OK) return err;
+            v = crous_value_new_float_arena(arena, d);
+            break;
+        }
+        
+        case FLUX_TAG_STRING: {
+            const char *data = NULL;
+            size_t len = 0;
+            err = flux_view_get_string(view, &data, &len);
+            if (err != CROUS_OK) return err;
+            v = crous_value_new_string_arena(arena, data, len);
+            break;
+        }
+        
+        default:
+            return CROUS_ERR_INTERNAL;
+    }
+    
+    if (!v) return CROUS_ERR_OOM;
+    *out_value = v;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   FLUX BINARY VISITOR
+   ============================================================================ */
+
+/* Wire v5: cost bytes of visiting against the budget REFs share. Without
+ * REFs a visit costs at most the document's length. */
+static crous_err_t view_charge(const flux_view_t *view, size_t cost) {
+    flux_decode_buf_t *doc_ctx = &view->doc->ctx;
+    if (!doc_ctx->value_refs) return CROUS_OK;
+    if (cost > doc_ctx->ref_budget) return CROUS_ERR_DECODE;
+    doc_ctx->ref_budget -= cost;
+    return CROUS_OK;
+}
+
+static crous_err_t view_visit(const flux_view_t *view, const crous_visitor *vis, void *ctx, int depth) {
+    if (depth > CROUS_MAX_DEPTH) return CROUS_ERR_DEPTH_EXCEEDED;
+    
+    crous_err_t err = view_charge(view, 1);
+    if (err != CROUS_OK) return err;
+    
+    crous_value scalar;
+    scalar.flags = CROUS_VALUE_FLAG_BORROWED;
+    scalar.type = flux_view_type(view);
+    
+    switch (scalar.type) {
+        case CROUS_TYPE_NULL:
+            break;
+        
+        case CROUS_TYPE_BOOL:
+            err = flux_view_get_bool(view, &scalar.data.b);
             break;
-        }
         
-        case FLUX_TAG_BYTES: {
-            uint64_t len;
-            err = binary_read_varint(ctx, &len);
-            if (err != CROUS_OK) return err;
-            
-            if (len > CROUS_MAX_BYTES_SIZE) return CROUS_ERR_DECODE;
-            
-            uint8_t *bytes_data = malloc(len);
-            if (!bytes_data) return CROUS_ERR_OOM;
-            
-            err = binary_read(ctx, bytes_data, len);
-            if (err != CROUS_OK) {
-                free(bytes_data);
-                return err;
-            }
-            
-            v = crous_value_new_bytes(bytes_data, len);
-            free(bytes_data);
-            if (!v) return CROUS_ERR_OOM;
+        case CROUS_TYPE_INT:
+            err = flux_view_get_int(view, &scalar.data.i);
+            break;
+        
+        case CROUS_TYPE_FLOAT:
+            err = flux_view_get_float(view, &scalar.data.f);
+            break;
+        
+        case CROUS_TYPE_STRING: {
+            const char *data = NULL;
+            err = flux_view_get_string(view, &data, &scalar.data.s.len);
+            if (err == CROUS_OK) err = view_charge(view, scalar.data.s.len);
+            scalar.data.s.data = (uint8_t *)data;
             break;
         }
         
-        case FLUX_TAG_LIST:
-            err = deserialize_array_binary(ctx, &v, depth);
-            if (err != CROUS_OK) return err;
+        case CROUS_TYPE_BYTES: {
+            const uint8_t *data = NULL;
+            err = flux_view_get_bytes(view, &data, &scalar.data.bytes.len);
+            if (err == CROUS_OK) err = view_charge(view, scalar.data.bytes.len);
+            scalar.data.bytes.data = (uint8_t *)data;
             break;
+        }
         
-        case FLUX_TAG_DICT:
-            err = deserialize_dict_binary(ctx, &v, depth);
+        case CROUS_TYPE_TAGGED: {
+            uint32_t tag;
+            flux_view_t inner;
+            err = flux_view_get_tagged(view, &tag, &inner);
+            if (err == CROUS_OK) err = crous_visit_tag(vis, ctx, tag);
             if (err != CROUS_OK) return err;
-            break;
+            return view_visit(&inner, vis, ctx, depth + 1);
+        }
+        
+        case CROUS_TYPE_I64_ARRAY:
+        case CROUS_TYPE_F64_ARRAY: {
+            /* Elements come straight off the wire rather than through
+               cell views */
+            const uint8_t *data = NULL;
+            size_t count = 0;
+            err = flux_view_get_array(view, &data, &count);
+            if (err == CROUS_OK) err = view_charge(view, count * 8);
+            if (err == CROUS_OK) err = crous_visit_begin(vis, ctx, CROUS_TYPE_LIST, count);
+            scalar.type = scalar.type == CROUS_TYPE_I64_ARRAY ? CROUS_TYPE_INT : CROUS_TYPE_FLOAT;
+            for (size_t i = 0; i < count && err == CROUS_OK && vis->scalar; i++) {
+                uint64_t bits = 0;
+                for (int b = 7; b >= 0; b--) bits = (bits << 8) | data[i * 8 + (size_t)b];
+                memcpy(&scalar.data.i, &bits, 8);
+                err = vis->scalar(ctx, &scalar);
+            }
+            if (err == CROUS_OK) err = crous_visit_end(vis, ctx, CROUS_TYPE_LIST, count);
+            return err;
+        }
         
-        case FLUX_TAG_TAGGED: {
-            /* Read the tag number */
-            uint64_t tag_num;
-            err = binary_read_varint(ctx, &tag_num);
+        case CROUS_TYPE_LIST:
+        case CROUS_TYPE_TUPLE:
+        case CROUS_TYPE_DICT: {
+            flux_view_iter_t it;
+            err = flux_view_iter_init(view, &it);
+            if (err == CROUS_OK) err = crous_visit_begin(vis, ctx, scalar.type, it.count);
             if (err != CROUS_OK) return err;
             
-            /* Read the inner value */
-            crous_value *inner;
-            err = deserialize_value_binary(ctx, &inner, depth + 1);
+            const char *key;
+            size_t key_len;
+            flux_view_t child;
+            while ((err = flux_view_next(&it, &key, &key_len, &child)) == CROUS_OK) {
+                if (scalar.type == CROUS_TYPE_DICT) err = crous_visit_key(vis, ctx, key, key_len);
+                if (err == CROUS_OK) err = view_visit(&child, vis, ctx, depth + 1);
+                if (err != CROUS_OK) return err;
+            }
+            if (err != CROUS_ERR_NOT_FOUND) return err;
+            return crous_visit_end(vis, ctx, scalar.type, it.count);
+        }
+        
+        default:
+            return CROUS_ERR_DECODE;
+    }
+    
+    if (err != CROUS_OK) return err;
+    return crous_visit_scalar(vis, ctx, &scalar);
+}
+
+crous_err_t flux_view_visit(const flux_view_t *view, const crous_visitor *visitor, void *ctx) {
+    if (!view || !visitor) return CROUS_ERR_INVALID_TYPE;
+    view->doc->ctx.ref_budget = binary_ref_budget(view->doc->ctx.len);
+    return view_visit(view, visitor, ctx, view->depth);
+}
+
+crous_err_t flux_visit_binary(const uint8_t *buf, size_t buf_size,
+                              const crous_visitor *visitor, void *ctx) {
+    if (!buf || !visitor) return CROUS_ERR_INVALID_TYPE;
+    
+    flux_view_doc_t *doc = NULL;
+    crous_err_t err = flux_view_open(buf, buf_size, &doc);
+    if (err != CROUS_OK) return err;
+    
+    flux_view_t root;
+    err = flux_view_root(doc, &root);
+    doc->ctx.ref_budget = binary_ref_budget(doc->ctx.len);
+    if (err == CROUS_OK) err = view_visit(&root, visitor, ctx, 0);
+    flux_view_close(doc);
+    return err;
+}
+
+/* ============================================================================
+   FLUX FIELD PROJECTION
+   ============================================================================ */
+
+/*
+ * A projection is a trie of path steps. Every [N] child of a node also
+ * holds whatever the node's [*] child selects, so decoding an element only
+ * ever has to follow one node.
+ */
+
+typedef struct flux_proj_node flux_proj_node_t;
+
+typedef struct {
+    char *key;
+    size_t len;
+    flux_proj_node_t *node;
+} flux_proj_key_t;
+
+typedef struct {
+    size_t index;
+    flux_proj_node_t *node;
+} flux_proj_index_t;
+
+struct flux_proj_node {
+    int whole;                      /* A path ends here: keep the whole value */
+    flux_proj_key_t *keys;
+    size_t key_count;
+    size_t key_cap;
+    flux_proj_index_t *indexes;     /* Sorted by index */
+    size_t index_count;
+    size_t index_cap;
+    flux_proj_node_t *each;         /* [*] */
+};
+
+struct flux_projection {
+    flux_proj_node_t root;
+};
+
+static void proj_node_clear(flux_proj_node_t *node) {
+    for (size_t i = 0; i < node->key_count; i++) {
+        free(node->keys[i].key);
+        proj_node_clear(node->keys[i].node);
+        free(node->keys[i].node);
+    }
+    for (size_t i = 0; i < node->index_count; i++) {
+        proj_node_clear(node->indexes[i].node);
+        free(node->indexes[i].node);
+    }
+    if (node->each) {
+        proj_node_clear(node->each);
+        free(node->each);
+    }
+    free(node->keys);
+    free(node->indexes);
+    memset(node, 0, sizeof(*node));
+}
+
+static const flux_proj_node_t *proj_find_key(const flux_proj_node_t *node, const uint8_t *key, size_t len) {
+    for (size_t i = 0; i < node->key_count; i++) {
+        const flux_proj_key_t *k = &node->keys[i];
+        if (k->len == len && (len == 0 || memcmp(k->key, key, len) == 0)) return k->node;
+    }
+    return NULL;
+}
+
+static crous_err_t proj_merge(flux_proj_node_t *dst, const flux_proj_node_t *src);
+
+/* Child of node under key, created if missing */
+static crous_err_t proj_key_child(flux_proj_node_t *node, const char *key, size_t len,
+                                  flux_proj_node_t **out) {
+    flux_proj_node_t *found = (flux_proj_node_t *)proj_find_key(node, (const uint8_t *)key, len);
+    if (found) {
+        *out = found;
+        return CROUS_OK;
+    }
+    
+    if (node->key_count == node->key_cap) {
+        size_t new_cap = node->key_cap ? node->key_cap * 2 : 4;
+        flux_proj_key_t *keys = realloc(node->keys, new_cap * sizeof(*keys));
+        if (!keys) return CROUS_ERR_OOM;
+        node->keys = keys;
+        node->key_cap = new_cap;
+    }
+    
+    flux_proj_key_t *k = &node->keys[node->key_count];
+    k->node = calloc(1, sizeof(*k->node));
+    k->key = malloc(len ? len : 1);
+    if (!k->node || !k->key) {
+        free(k->node);
+        free(k->key);
+        return CROUS_ERR_OOM;
+    }
+    memcpy(k->key, key, len);
+    k->len = len;
+    node->key_count++;
+    *out = k->node;
+    return CROUS_OK;
+}
+
+/* Child of node at index, created if missing and seeded with node's [*] */
+static crous_err_t proj_index_child(flux_proj_node_t *node, size_t index, flux_proj_node_t **out) {
+    size_t at = 0;
+    while (at < node->index_count && node->indexes[at].index < index) at++;
+    if (at < node->index_count && node->indexes[at].index == index) {
+        *out = node->indexes[at].node;
+        return CROUS_OK;
+    }
+    
+    if (node->index_count == node->index_cap) {
+        size_t new_cap = node->index_cap ? node->index_cap * 2 : 4;
+        flux_proj_index_t *indexes = realloc(node->indexes, new_cap * sizeof(*indexes));
+        if (!indexes) return CROUS_ERR_OOM;
+        node->indexes = indexes;
+        node->index_cap = new_cap;
+    }
+    
+    flux_proj_node_t *child = calloc(1, sizeof(*child));
+    if (!child) return CROUS_ERR_OOM;
+    memmove(&node->indexes[at + 1], &node->indexes[at], (node->index_count - at) * sizeof(*node->indexes));
+    node->indexes[at].index = index;
+    node->indexes[at].node = child;
+    node->index_count++;
+    
+    *out = child;
+    return node->each ? proj_merge(child, node->each) : CROUS_OK;
+}
+
+/* Add everything src selects to dst */
+static crous_err_t proj_merge(flux_proj_node_t *dst, const flux_proj_node_t *src) {
+    flux_proj_node_t *child;
+    crous_err_t err;
+    
+    if (src->whole) dst->whole = 1;
+    
+    for (size_t i = 0; i < src->key_count; i++) {
+        err = proj_key_child(dst, src->keys[i].key, src->keys[i].len, &child);
+        if (err == CROUS_OK) err = proj_merge(child, src->keys[i].node);
+        if (err != CROUS_OK) return err;
+    }
+    for (size_t i = 0; i < src->index_count; i++) {
+        err = proj_index_child(dst, src->indexes[i].index, &child);
+        if (err == CROUS_OK) err = proj_merge(child, src->indexes[i].node);
+        if (err != CROUS_OK) return err;
+    }
+    
+    if (src->each) {
+        if (!dst->each) {
+            dst->each = calloc(1, sizeof(*dst->each));
+            if (!dst->each) return CROUS_ERR_OOM;
+        }
+        err = proj_merge(dst->each, src->each);
+        for (size_t i = 0; i < dst->index_count && err == CROUS_OK; i++) {
+            err = proj_merge(dst->indexes[i].node, src->each);
+        }
+        if (err != CROUS_OK) return err;
+    }
+    return CROUS_OK;
+}
+
+/* Parse path into a chain of nodes below chain */
+static crous_err_t proj_parse(flux_proj_node_t *chain, const char *path, size_t len) {
+    flux_proj_node_t *cur = chain;
+    size_t i = 0;
+    crous_err_t err;
+    
+    if (len == 0) return CROUS_ERR_SYNTAX;
+    
+    while (i < len) {
+        if (path[i] == '[') {
+            i++;
+            if (i < len && path[i] == '*') {
+                i++;
+                cur->each = calloc(1, sizeof(*cur->each));
+                if (!cur->each) return CROUS_ERR_OOM;
+                cur = cur->each;
+            } else {
+                size_t index = 0;
+                size_t start = i;
+                while (i < len && path[i] >= '0' && path[i] <= '9') {
+                    size_t digit = (size_t)(path[i] - '0');
+                    if (index > (SIZE_MAX - digit) / 10) return CROUS_ERR_SYNTAX;
+                    index = index * 10 + digit;
+                    i++;
+                }
+                if (i == start) return CROUS_ERR_SYNTAX;
+                err = proj_index_child(cur, index, &cur);
+                if (err != CROUS_OK) return err;
+            }
+            if (i >= len || path[i] != ']') return CROUS_ERR_SYNTAX;
+            i++;
+        } else {
+            /* Names start the path or follow a '.' */
+            if (i > 0) {
+                if (path[i] != '.') return CROUS_ERR_SYNTAX;
+                i++;
+            }
+            size_t start = i;
+            while (i < len && path[i] != '.' && path[i] != '[') i++;
+            if (i == start) return CROUS_ERR_SYNTAX;
+            err = proj_key_child(cur, path + start, i - start, &cur);
             if (err != CROUS_OK) return err;
-            
-            v = crous_value_new_tagged((uint32_t)tag_num, inner);
-            if (!v) {
-                crous_value_free_tree(inner);
-                return CROUS_ERR_OOM;
+        }
+    }
+    
+    cur->whole = 1;
+    return CROUS_OK;
+}
+
+crous_err_t flux_projection_new(flux_projection_t **out_proj) {
+    if (!out_proj) return CROUS_ERR_INVALID_TYPE;
+    *out_proj = calloc(1, sizeof(**out_proj));
+    return *out_proj ? CROUS_OK : CROUS_ERR_OOM;
+}
+
+crous_err_t flux_projection_add(flux_projection_t *proj, const char *path, size_t path_len) {
+    if (!proj || (!path && path_len)) return CROUS_ERR_INVALID_TYPE;
+    
+    /* Parse on the side so a bad path leaves proj as it was */
+    flux_proj_node_t chain = {0};
+    crous_err_t err = proj_parse(&chain, path, path_len);
+    if (err == CROUS_OK) err = proj_merge(&proj->root, &chain);
+    proj_node_clear(&chain);
+    return err;
+}
+
+void flux_projection_free(flux_projection_t *proj) {
+    if (!proj) return;
+    proj_node_clear(&proj->root);
+    free(proj);
+}
+
+static crous_err_t project_value_binary(flux_decode_buf_t *ctx, const flux_proj_node_t *node,
+                                        int depth, crous_value **out);
+
+static crous_err_t project_append_entry(flux_decode_buf_t *ctx, crous_value *dict,
+                                        const uint8_t *key, size_t key_len, crous_value *val) {
+    crous_err_t err = ctx->borrow
+        ? crous_value_dict_append_borrowed(ctx->arena, dict, (const char *)key, key_len, val)
+        : crous_value_dict_append_arena(ctx->arena, dict, (const char *)key, key_len, val);
+    if (err != CROUS_OK) crous_value_free_tree(val);
+    return err;
+}
+
+static crous_err_t project_dict_binary(flux_decode_buf_t *ctx, const flux_proj_node_t *node,
+                                       int depth, crous_value **out) {
+    uint64_t count;
+    crous_err_t err = binary_read_varint(ctx, &count);
+    if (err != CROUS_OK) return err;
+    if (count > CROUS_MAX_DICT_SIZE) return CROUS_ERR_DECODE;
+    if (count > (ctx->len - ctx->pos) / 2) return CROUS_ERR_TRUNCATED;
+    
+    crous_value *dict = crous_value_new_dict_arena(ctx->arena,
+                                                   count < node->key_count ? count : node->key_count);
+    if (!dict) return CROUS_ERR_OOM;
+    
+    for (uint64_t i = 0; i < count && err == CROUS_OK; i++) {
+        const uint8_t *key;
+        size_t key_len;
+        err = binary_read_key(ctx, &key, &key_len);
+        if (err != CROUS_OK) break;
+        
+        const flux_proj_node_t *child = proj_find_key(node, key, key_len);
+        if (!child) {
+            err = skip_value_binary(ctx, depth + 1);
+            continue;
+        }
+        crous_value *val;
+        err = project_value_binary(ctx, child, depth + 1, &val);
+        if (err == CROUS_OK && val) err = project_append_entry(ctx, dict, key, key_len, val);
+    }
+    
+    if (err != CROUS_OK) {
+        crous_value_free_tree(dict);
+        return err;
+    }
+    *out = dict;
+    return CROUS_OK;
+}
+
+static crous_err_t project_array_binary(flux_decode_buf_t *ctx, const flux_proj_node_t *node,
+                                        uint8_t tag, int depth, crous_value **out) {
+    uint64_t count;
+    crous_err_t err = binary_read_varint(ctx, &count);
+    if (err != CROUS_OK) return err;
+    if (count > CROUS_MAX_LIST_SIZE) return CROUS_ERR_DECODE;
+    if (count > ctx->len - ctx->pos) return CROUS_ERR_TRUNCATED;
+    
+    crous_value *list = crous_value_new_list_arena(ctx->arena, node->each ? count : node->index_count);
+    if (!list) return CROUS_ERR_OOM;
+    if (tag == FLUX_TAG_TUPLE) list->type = CROUS_TYPE_TUPLE;
+    
+    size_t next = 0;
+    for (uint64_t i = 0; i < count && err == CROUS_OK; i++) {
+        const flux_proj_node_t *child = node->each;
+        if (next < node->index_count && node->indexes[next].index == i) child = node->indexes[next++].node;
+        if (!child) {
+            err = skip_value_binary(ctx, depth + 1);
+            continue;
+        }
+        crous_value *elem;
+        err = project_value_binary(ctx, child, depth + 1, &elem);
+        if (err == CROUS_OK && elem) {
+            err = crous_value_list_append(list, elem);
+            if (err != CROUS_OK) crous_value_free_tree(elem);
+        }
+    }
+    
+    if (err != CROUS_OK) {
+        crous_value_free_tree(list);
+        return err;
+    }
+    *out = list;
+    return CROUS_OK;
+}
+
+/* Packed array after its tag: elements are scalars, so only whole
+ * selections keep anything */
+static crous_err_t project_packed_binary(flux_decode_buf_t *ctx, const flux_proj_node_t *node,
+                                         uint8_t tag, crous_value **out) {
+    crous_type_t type = tag == FLUX_TAG_I64_ARRAY ? CROUS_TYPE_I64_ARRAY : CROUS_TYPE_F64_ARRAY;
+    
+    if (node->each && node->each->whole) return deserialize_packed_binary(ctx, type, out);
+    
+    uint64_t count;
+    const uint8_t *data;
+    crous_err_t err = binary_read_packed(ctx, &count, &data);
+    if (err != CROUS_OK) return err;
+    
+    uint8_t *picked = malloc(node->index_count ? node->index_count * 8 : 1);
+    if (!picked) return CROUS_ERR_OOM;
+    size_t n = 0;
+    for (size_t i = 0; i < node->index_count; i++) {
+        const flux_proj_index_t *ix = &node->indexes[i];
+        if (ix->index < count && ix->node->whole) memcpy(picked + 8 * n++, data + 8 * ix->index, 8);
+    }
+    
+    *out = type == CROUS_TYPE_I64_ARRAY ? crous_value_new_i64_array_arena(ctx->arena, (const int64_t *)picked, n)
+                                        : crous_value_new_f64_array_arena(ctx->arena, (const double *)picked, n);
+    free(picked);
+    return *out ? CROUS_OK : CROUS_ERR_OOM;
+}
+
+/* A table row that is kept, and the node selecting from it */
+typedef struct {
+    const flux_proj_node_t *node;
+    crous_value *dict;              /* NULL for rows that are left out */
+} flux_proj_row_t;
+
+/* What node selects from a column named key: itself when it is whole */
+static const flux_proj_node_t *proj_cell_node(const flux_proj_node_t *node, const flux_key_span_t *key) {
+    if (!node) return NULL;
+    return node->whole ? node : proj_find_key(node, key->data, key->len);
+}
+
+/* Fill column col of the kept rows from the column body */
+static crous_err_t project_column_binary(flux_decode_buf_t *ctx, const flux_proj_node_t *node,
+                                         uint8_t kind, flux_proj_row_t *rows, size_t row_count,
+                                         const flux_key_span_t *key, int depth) {
+    const flux_proj_node_t *each_cell = proj_cell_node(node->each, key);
+    crous_err_t err;
+    
+    const uint8_t *bitmap = NULL;
+    if (kind == FLUX_COLUMN_BOOL) {
+        err = binary_read_span(ctx, (row_count + 7) / 8, &bitmap);
+        if (err != CROUS_OK) return err;
+    }
+    
+    crous_varint_run_t run;
+    crous_varint_run_init(&run, row_count);
+    int64_t prev = 0;
+    for (size_t r = 0; r < row_count; r++) {
+        const flux_proj_node_t *cell_node = NULL;
+        if (rows[r].dict) cell_node = rows[r].node == node->each ? each_cell : proj_cell_node(rows[r].node, key);
+        crous_value *cell = NULL;
+        
+        if (kind == FLUX_COLUMN_ANY) {
+            err = cell_node ? project_value_binary(ctx, cell_node, depth + 2, &cell)
+                            : skip_value_binary(ctx, depth + 2);
+        } else if (kind == FLUX_COLUMN_BOOL) {
+            err = CROUS_OK;
+            if (cell_node && cell_node->whole) {
+                cell = crous_value_new_bool_arena(ctx->arena, (bitmap[r / 8] >> (r % 8)) & 1);
+                if (!cell) err = CROUS_ERR_OOM;
             }
+        } else {
+            /* Int runs are decoded in batches, so every cell goes through the run */
+            err = deserialize_cell_binary(ctx, kind, &run, &prev, &cell);
+            if (err == CROUS_OK && !(cell_node && cell_node->whole)) {
+                crous_value_free_tree(cell);
+                cell = NULL;
+            }
+        }
+        if (err != CROUS_OK) return err;
+        
+        if (cell) {
+            err = project_append_entry(ctx, rows[r].dict, key->data, key->len, cell);
+            if (err != CROUS_OK) return err;
+        }
+    }
+    return CROUS_OK;
+}
+
+static crous_err_t project_table_binary(flux_decode_buf_t *ctx, const flux_proj_node_t *node,
+                                        int depth, crous_value **out) {
+    uint64_t row_count, cols;
+    crous_err_t err = binary_read_table_shape(ctx, depth, &row_count, &cols);
+    if (err != CROUS_OK) return err;
+    
+    flux_key_span_t *keys = malloc(cols * sizeof(*keys));
+    flux_proj_row_t *rows = calloc(row_count, sizeof(*rows));
+    crous_value *list = NULL;
+    if (!keys || !rows) {
+        err = CROUS_ERR_OOM;
+        goto done;
+    }
+    
+    for (uint64_t c = 0; c < cols && err == CROUS_OK; c++) {
+        err = binary_read_key(ctx, &keys[c].data, &keys[c].len);
+    }
+    if (err != CROUS_OK) goto done;
+    
+    list = crous_value_new_list_arena(ctx->arena, node->each ? row_count : node->index_count);
+    if (!list) {
+        err = CROUS_ERR_OOM;
+        goto done;
+    }
+    
+    /* Rows whose node selects keys (or the whole row) come out as dicts */
+    size_t next = 0;
+    for (uint64_t r = 0; r < row_count && err == CROUS_OK; r++) {
+        const flux_proj_node_t *row_node = node->each;
+        if (next < node->index_count && node->indexes[next].index == r) row_node = node->indexes[next++].node;
+        if (!row_node || (!row_node->whole && !row_node->key_count)) continue;
+        
+        rows[r].node = row_node;
+        rows[r].dict = crous_value_new_dict_arena(ctx->arena, row_node->whole ? cols : row_node->key_count);
+        if (!rows[r].dict) {
+            err = CROUS_ERR_OOM;
             break;
         }
+        err = crous_value_list_append(list, rows[r].dict);
+        if (err != CROUS_OK) crous_value_free_tree(rows[r].dict);
+    }
+    
+    for (uint64_t c = 0; c < cols && err == CROUS_OK; c++) {
+        uint8_t kind;
+        err = binary_read(ctx, &kind, 1);
+        if (err != CROUS_OK) break;
+        
+        /* Columns no kept row asks for are stepped over in one go */
+        int wanted = proj_cell_node(node->each, &keys[c]) != NULL;
+        for (size_t i = 0; i < node->index_count && !wanted; i++) {
+            wanted = proj_cell_node(node->indexes[i].node, &keys[c]) != NULL;
+        }
+        if (wanted) err = project_column_binary(ctx, node, kind, rows, (size_t)row_count, &keys[c], depth);
+        else err = skip_column_binary(ctx, kind, row_count, depth);
+    }
+    
+done:
+    free(keys);
+    free(rows);
+    if (err != CROUS_OK) {
+        crous_value_free_tree(list);
+        return err;
+    }
+    *out = list;
+    return CROUS_OK;
+}
+
+/* Decode what node selects from the value at ctx->pos and step past the
+ * rest of it. *out stays NULL when nothing in the value is selected. */
+/* The value after its tag, selecting what node asks for */
+static crous_err_t project_payload_binary(flux_decode_buf_t *ctx, const flux_proj_node_t *node,
+                                          uint8_t tag, int depth, crous_value **out) {
+    int by_index = node->index_count || node->each;
+    switch (tag) {
+        case FLUX_TAG_DICT:
+            if (node->key_count) return project_dict_binary(ctx, node, depth, out);
+            break;
         
+        case FLUX_TAG_LIST:
         case FLUX_TAG_TUPLE:
-            /* Tuples are stored like lists, just with different type */
-            err = deserialize_array_binary(ctx, &v, depth);
-            if (err != CROUS_OK) return err;
-            /* Convert list to tuple by changing type */
-            if (v) v->type = CROUS_TYPE_TUPLE;
+            if (by_index) return project_array_binary(ctx, node, tag, depth, out);
+            break;
+        
+        case FLUX_TAG_TABLE:
+            if (by_index && ctx->columnar) return project_table_binary(ctx, node, depth, out);
+            break;
+        
+        case FLUX_TAG_I64_ARRAY:
+        case FLUX_TAG_F64_ARRAY:
+            if (by_index) return project_packed_binary(ctx, node, tag, out);
             break;
         
         default:
-            return CROUS_ERR_DECODE;
+            break;
     }
     
-    *out_value = v;
-    return CROUS_OK;
+    /* Nothing selected inside this value */
+    return skip_payload_binary(ctx, tag, depth);
 }
 
-crous_err_t flux_decode_binary(const uint8_t *buf, size_t buf_size, crous_value **out_value) {
-    if (!buf || !out_value) return CROUS_ERR_INVALID_TYPE;
+static crous_err_t project_value_binary(flux_decode_buf_t *ctx, const flux_proj_node_t *node,
+                                        int depth, crous_value **out) {
+    *out = NULL;
+    if (node->whole) return deserialize_value_binary(ctx, out, depth);
+    if (depth >= CROUS_MAX_DEPTH) return CROUS_ERR_DECODE;
     
-    if (buf_size < 6) return CROUS_ERR_TRUNCATED;
+    uint8_t tag;
+    crous_err_t err = binary_read(ctx, &tag, 1);
+    if (err != CROUS_OK) return err;
     
-    /* Check FLUX magic */
-    if (buf[0] != FLUX_MAGIC_0 || buf[1] != FLUX_MAGIC_1 ||
-        buf[2] != FLUX_MAGIC_2 || buf[3] != FLUX_MAGIC_3) {
-        return CROUS_ERR_INVALID_HEADER;
+    size_t share = 0, ref = 0;
+    if (tag == FLUX_TAG_SHARE || tag == FLUX_TAG_REF) {
+        err = binary_read_share(ctx, &tag, &share, &ref);
+        if (err != CROUS_OK) return err;
     }
     
-    if (buf[4] != FLUX_VERSION) {
-        return CROUS_ERR_INVALID_HEADER;
+    if (ref) {
+        /* Project the shared value's bytes, then resume after the REF */
+        const flux_share_span_t *span = &ctx->shares[ref - 1];
+        size_t size = span->end - span->pos;
+        if (size > ctx->ref_budget) return CROUS_ERR_DECODE;
+        ctx->ref_budget -= size;
+        
+        size_t pos = ctx->pos, len = ctx->len;
+        ctx->pos = span->pos;
+        ctx->len = span->end;
+        err = project_value_binary(ctx, node, depth, out);
+        ctx->pos = pos;
+        ctx->len = len;
+        return err;
+    }
+    
+    err = project_payload_binary(ctx, node, tag, depth, out);
+    if (err == CROUS_OK && share) binary_share_complete(ctx, share, NULL);
+    return err;
+}
+
+static crous_err_t flux_decode_fields_mode(const uint8_t *buf, size_t buf_size, const flux_projection_t *proj,
+                                           crous_arena *arena, int borrow, const flux_dictionary_t *dict,
+                                           crous_value **out_value) {
+    if (!buf || !proj || !out_value) return CROUS_ERR_INVALID_TYPE;
+    
+    if (flux_binary_is_compressed(buf, buf_size)) {
+        uint8_t *raw;
+        size_t raw_size;
+        crous_err_t err = binary_unpack(buf, buf_size, arena, &raw, &raw_size, &dict);
+        if (err != CROUS_OK) return err;
+        
+        err = flux_decode_fields_mode(raw, raw_size, proj, arena, borrow && arena, dict, out_value);
+        if (!arena) free(raw);
+        return err;
     }
     
+    crous_err_t err = binary_check_header(buf, buf_size);
+    if (err != CROUS_OK) return err;
+    
     flux_decode_buf_t ctx = {
         .buf = buf,
         .pos = 6,  /* Skip header */
-        .len = buf_size
+        .len = buf_size,
+        .arena = arena,
+        .borrow = borrow,
+        .key_refs = buf[4] >= FLUX_VERSION_KEY_REFS,
+        .columnar = buf[4] >= FLUX_VERSION_COLUMNAR,
+        .dict = dict,
+        .dict_keys = flux_dictionary_key_count(dict),
+        .max_depth = CROUS_MAX_DEPTH,
+        .value_refs = buf[4] >= FLUX_VERSION_VALUE_REFS,
+        .ref_budget = binary_ref_budget(buf_size)
     };
     
-    return deserialize_value_binary(&ctx, out_value, 0);
+    crous_value *v = NULL;
+    err = project_value_binary(&ctx, &proj->root, 0, &v);
+    free(ctx.keys);
+    free(ctx.shares);
+    if (err != CROUS_OK) return err;
+    
+    if (!v) {
+        v = crous_value_new_null_arena(arena);
+        if (!v) return CROUS_ERR_OOM;
+    }
+    *out_value = v;
+    return CROUS_OK;
+}
+
+crous_err_t flux_decode_binary_fields(const uint8_t *buf, size_t buf_size, const flux_projection_t *proj,
+                                      crous_arena *arena, crous_value **out_value) {
+    crous_span span;
+    crous_span_begin(&span, "flux_decode_binary_fields", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, buf_size);
+    return crous_span_end(&span, flux_decode_fields_mode(buf, buf_size, proj, arena, 0, NULL, out_value), 0);
+}
+
+crous_err_t flux_decode_binary_fields_borrowed(const uint8_t *buf, size_t buf_size, const flux_projection_t *proj,
+                                               crous_arena *arena, crous_value **out_value) {
+    crous_span span;
+    crous_span_begin(&span, "flux_decode_binary_fields_borrowed", CROUS_PHASE_DECODE,
+                     CROUS_STATS_FMT_FLUX, CROUS_STATS_FMT_NONE, buf_size);
+    return crous_span_end(&span, flux_decode_fields_mode(buf, buf_size, proj, arena, 1, NULL, out_value), 0);
 }
@@ -0,0 +1,1213 @@
+#include "../include/crous_flux.h"
+#include "../include/crous_value.h"
+#include "../include/crous_varint.h"
+#include "../include/crous_checksum.h"
+#include "../include/crous_stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+   FLUX STREAMING DECODER
+   ============================================================================ */
+
+/*
+ * The decoder is a byte-driven state machine. Scalars that can straddle a
+ * chunk boundary (header, varints, floats, string/bytes/key/array payloads) are
+ * accumulated in place; containers live on an explicit frame stack until
+ * their last child arrives. Nothing is recursive, so a chunk boundary can
+ * fall anywhere.
+ *
+ * A compressed envelope adds a layer in front: its block headers are
+ * parsed the same way, and each block, once whole, is decompressed,
+ * checked against its CRC-32C if it has one, and fed to the state machine,
+ * so memory stays bounded by one block.
+ */
+
+#define FS_INITIAL_CONTAINER_CAP 1024   /* Cap on trusting wire counts up front */
+#define FS_INITIAL_PAYLOAD_CAP 65536    /* Cap on trusting wire lengths up front */
+
+typedef enum {
+    FS_HEADER,
+    FS_TAG,
+    FS_VARINT,
+    FS_FLOAT,
+    FS_PAYLOAD,
+    FS_COLUMN_KIND,
+    FS_BITMAP,
+    FS_ARRAY_PAD,
+    FS_ARRAY_SKIP,
+    FS_DONE,
+    FS_ERROR,
+} fs_state_t;
+
+/* What the varint being read is for */
+typedef enum {
+    FS_VARINT_INT,
+    FS_VARINT_STRING_LEN,
+    FS_VARINT_BYTES_LEN,
+    FS_VARINT_KEY_LEN,
+    FS_VARINT_LIST_COUNT,
+    FS_VARINT_TUPLE_COUNT,
+    FS_VARINT_DICT_COUNT,
+    FS_VARINT_TAG_NUM,
+    FS_VARINT_TABLE_ROWS,
+    FS_VARINT_TABLE_COLS,
+    FS_VARINT_CELL_DELTA,
+    FS_VARINT_I64_COUNT,
+    FS_VARINT_F64_COUNT,
+    FS_VARINT_REF,
+} fs_varint_t;
+
+typedef enum {
+    FS_PAYLOAD_STRING,
+    FS_PAYLOAD_BYTES,
+    FS_PAYLOAD_KEY,
+    FS_PAYLOAD_I64,
+    FS_PAYLOAD_F64,
+} fs_payload_t;
+
+typedef enum {
+    FS_FRAME_LIST,
+    FS_FRAME_DICT,
+    FS_FRAME_TAGGED,
+    FS_FRAME_TABLE,
+} fs_frame_kind_t;
+
+/* Column key of a table */
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    int owned;                  /* Ours to free, not a key table entry */
+} fs_column_key_t;
+
+/* Wire v4 table being filled column by column */
+typedef struct {
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t row;               /* Next cell of the current column */
+    uint64_t col;               /* Current column */
+    fs_column_key_t *keys;      /* Column keys read so far */
+    size_t key_count;
+    size_t key_cap;
+    int have_kind;              /* Current column's kind byte has been read */
+    uint8_t kind;
+    int64_t prev;               /* Last value of an INT_DELTA column */
+} fs_table_t;
+
+typedef struct {
+    fs_frame_kind_t kind;
+    crous_value *container;     /* List/tuple/dict being filled; NULL for tagged */
+    uint64_t remaining;         /* Children still to come */
+    uint32_t tag;               /* Tag number for tagged frames */
+    uint8_t *key;               /* Dict key waiting for its value */
+    size_t key_len;
+    int have_key;
+    int key_owned;              /* Key is ours to free, not a key table entry */
+    fs_table_t *table;          /* Table frames only */
+    size_t share;               /* Wire v5: shares slot + 1 when this value is shared */
+} fs_frame_t;
+
+/* Where a compressed envelope is */
+typedef enum {
+    FS_ENV_BLOCK_HEADER,
+    FS_ENV_BLOCK_DATA,
+    FS_ENV_END,
+} fs_env_state_t;
+
+typedef struct {
+    fs_env_state_t state;
+    crous_codec_t codec;
+    const flux_dictionary_t *dict;  /* Named in the header, or NULL */
+    int feeding;                /* Inside the state machine with a block's bytes */
+    size_t head_size;           /* Block header bytes: 8, or 12 with a checksum */
+
+    uint8_t head[12];           /* Block header: raw_len, stored_len, [crc] */
+    size_t head_len;
+    uint32_t raw_len;
+    uint32_t stored_len;
+    uint32_t crc;
+
+    uint8_t *stored;            /* Block bytes split across chunks */
+    size_t stored_fill;
+    size_t stored_cap;
+    uint8_t *raw;               /* Decompressed block */
+    size_t raw_cap;
+} fs_envelope_t;
+
+/* Wire v3 key table entry */
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} fs_key_t;
+
+/* Wire v5 shared value: a private copy for REFs to clone, NULL until the
+   value is complete */
+typedef struct {
+    crous_value *value;
+    size_t start;               /* expanded count when its SHARE was read */
+    size_t values;              /* Values a REF to it expands to */
+} fs_share_t;
+
+struct flux_stream_decoder {
+    fs_state_t state;
+    crous_err_t error;
+
+    /* Header and float bytes */
+    uint8_t scratch[FLUX_ENVELOPE_HEADER_SIZE];
+    size_t scratch_len;
+
+    /* Varint in progress */
+    fs_varint_t varint_kind;
+    uint64_t varint_value;
+    int varint_shift;
+
+    /* String/bytes/key payload in progress */
+    fs_payload_t payload_kind;
+    uint8_t *payload;
+    size_t payload_len;
+    size_t payload_fill;
+    size_t payload_cap;
+
+    /* Packed array between its count and its elements */
+    fs_payload_t array_kind;
+    uint64_t array_count;
+    size_t pad_left;
+
+    fs_frame_t stack[CROUS_MAX_DEPTH];
+    int depth;
+
+    /* Table header between its two varints */
+    uint64_t table_rows;
+    int tables_open;            /* Each table hides one level of row dicts */
+
+    /* Wire v3 key table; owns every literal key it holds. An envelope's
+       dictionary keys come first, read from the dictionary itself. */
+    int columnar;
+    int key_refs;
+    fs_key_t *keys;
+    size_t key_count;
+    size_t key_cap;
+    size_t dict_keys;
+
+    /* Wire v5 shared values, numbered in SHARE order. REFs may expand to at
+       most FLUX_REF_EXPANSION values per value read, plus
+       FLUX_REF_EXPANSION_BASE. */
+    int value_refs;
+    size_t value_share;         /* Slot + 1 of a SHARE waiting for its value */
+    fs_share_t *shares;
+    size_t share_count;
+    size_t share_cap;
+    size_t expanded;            /* values_decoded plus what REFs added */
+    size_t ref_values;
+
+    crous_value *root;
+    size_t bytes_consumed;
+    size_t values_decoded;
+
+    fs_envelope_t *env;         /* Set once a compressed envelope's header is read */
+
+    /* Items mode: finished values waiting for flux_stream_decoder_next_item() */
+    int items;
+    crous_value **queue;
+    size_t queue_head;
+    size_t queue_len;
+    size_t queue_cap;
+};
+
+flux_stream_decoder_t* flux_stream_decoder_new(void) {
+    flux_stream_decoder_t *dec = calloc(1, sizeof(*dec));
+    if (!dec) return NULL;
+    dec->state = FS_HEADER;
+    dec->error = CROUS_OK;
+    return dec;
+}
+
+static void fs_table_free(fs_table_t *t) {
+    if (!t) return;
+    for (size_t i = 0; i < t->key_count; i++) {
+        if (t->keys[i].owned) free(t->keys[i].data);
+    }
+    free(t->keys);
+    free(t);
+}
+
+/* Free everything the current document holds; the item queue is kept */
+static void fs_release(flux_stream_decoder_t *dec) {
+    /* Open containers are not yet linked to their parents: free each one */
+    for (int i = 0; i < dec->depth; i++) {
+        crous_value_free_tree(dec->stack[i].container);
+        if (dec->stack[i].key_owned) free(dec->stack[i].key);
+        fs_table_free(dec->stack[i].table);
+    }
+    for (size_t i = 0; i < dec->key_count; i++)
+        free(dec->keys[i].data);
+    free(dec->keys);
+    for (size_t i = 0; i < dec->share_count; i++)
+        crous_value_free_tree(dec->shares[i].value);
+    free(dec->shares);
+    free(dec->payload);
+    crous_value_free_tree(dec->root);
+    if (dec->env) {
+        free(dec->env->stored);
+        free(dec->env->raw);
+        free(dec->env);
+    }
+}
+
+void flux_stream_decoder_free(flux_stream_decoder_t *dec) {
+    if (!dec) return;
+    fs_release(dec);
+    for (size_t i = dec->queue_head; i < dec->queue_len; i++)
+        crous_value_free_tree(dec->queue[i]);
+    free(dec->queue);
+    free(dec);
+}
+
+void flux_stream_decoder_reset(flux_stream_decoder_t *dec) {
+    if (!dec) return;
+    fs_release(dec);
+
+    /* Keep the mode and the untaken items, start over on a header */
+    int items = dec->items;
+    crous_value **queue = dec->queue;
+    size_t head = dec->queue_head, len = dec->queue_len, cap = dec->queue_cap;
+    memset(dec, 0, sizeof(*dec));
+    dec->state = FS_HEADER;
+    dec->error = CROUS_OK;
+    dec->items = items;
+    dec->queue = queue;
+    dec->queue_head = head;
+    dec->queue_len = len;
+    dec->queue_cap = cap;
+}
+
+static crous_err_t fs_fail(flux_stream_decoder_t *dec, crous_err_t err) {
+    dec->state = FS_ERROR;
+    dec->error = err;
+    return err;
+}
+
+static void fs_start_varint(flux_stream_decoder_t *dec, fs_varint_t kind) {
+    dec->state = FS_VARINT;
+    dec->varint_kind = kind;
+    dec->varint_value = 0;
+    dec->varint_shift = 0;
+}
+
+/* Pick the state for whatever comes next inside the innermost container */
+static void fs_expect_next(flux_stream_decoder_t *dec) {
+    if (dec->depth > 0) {
+        fs_frame_t *f = &dec->stack[dec->depth - 1];
+        if (f->kind == FS_FRAME_DICT && !f->have_key) {
+            fs_start_varint(dec, FS_VARINT_KEY_LEN);
+            return;
+        }
+        if (f->kind == FS_FRAME_TABLE) {
+            fs_table_t *t = f->table;
+            if (t->key_count < t->cols) {
+                fs_start_varint(dec, FS_VARINT_KEY_LEN);
+            } else if (!t->have_kind) {
+                dec->state = FS_COLUMN_KIND;
+            } else {
+                switch (t->kind) {
+                    case FLUX_COLUMN_INT:
+                        fs_start_varint(dec, FS_VARINT_INT);
+                        break;
+                    case FLUX_COLUMN_INT_DELTA:
+                        fs_start_varint(dec, FS_VARINT_CELL_DELTA);
+                        break;
+                    case FLUX_COLUMN_FLOAT:
+                        dec->state = FS_FLOAT;
+                        dec->scratch_len = 0;
+                        break;
+                    case FLUX_COLUMN_BOOL:
+                        dec->state = FS_BITMAP;
+                        break;
+                    case FLUX_COLUMN_STRING:
+                        fs_start_varint(dec, FS_VARINT_STRING_LEN);
+                        break;
+                    default:
+                        dec->state = FS_TAG;
+                        break;
+                }
+            }
+            return;
+        }
+    }
+    dec->state = FS_TAG;
+}
+
+/* Put cell v into row t->row under the current column's key. Rows are
+ * created as the first column arrives, so a huge announced row count costs
+ * nothing until its cells show up. */
+static crous_err_t fs_table_add_cell(fs_frame_t *f, crous_value *v) {
+    fs_table_t *t = f->table;
+    crous_value *row;
+
+    if (t->col == 0) {
+        size_t initial = t->cols < FS_INITIAL_CONTAINER_CAP ? (size_t)t->cols : FS_INITIAL_CONTAINER_CAP;
+        row = crous_value_new_dict(initial);
+        if (!row) return CROUS_ERR_OOM;
+        crous_err_t err = crous_value_list_append(f->container, row);
+        if (err != CROUS_OK) {
+            crous_value_free_tree(row);
+            return err;
+        }
+    } else {
+        row = crous_value_list_get(f->container, (size_t)t->row);
+    }
+
+    const fs_column_key_t *key = &t->keys[t->col];
+    return crous_value_dict_append_unique(row, (const char *)key->data, key->len, v);
+}
+
+/* Queue a finished item; takes v either way */
+static crous_err_t fs_queue_item(flux_stream_decoder_t *dec, crous_value *v) {
+    if (dec->queue_head > 0 && dec->queue_head == dec->queue_len) {
+        dec->queue_head = dec->queue_len = 0;
+    }
+    if (dec->queue_len == dec->queue_cap) {
+        size_t new_cap = dec->queue_cap ? dec->queue_cap * 2 : 64;
+        crous_value **grown = realloc(dec->queue, new_cap * sizeof(*grown));
+        if (!grown) {
+            crous_value_free_tree(v);
+            return CROUS_ERR_OOM;
+        }
+        dec->queue = grown;
+        dec->queue_cap = new_cap;
+    }
+    dec->queue[dec->queue_len++] = v;
+    return CROUS_OK;
+}
+
+/* Items mode, top-level value done: queue it, or the elements of a list
+ * that arrived whole (a columnar table, or an empty list) */
+static crous_err_t fs_queue_root(flux_stream_decoder_t *dec, crous_value *v) {
+    crous_type_t type = crous_value_get_type(v);
+    if (type != CROUS_TYPE_LIST && type != CROUS_TYPE_TUPLE) return fs_queue_item(dec, v);
+
+    crous_err_t err = CROUS_OK;
+    size_t n = crous_value_list_size(v);
+    for (size_t i = 0; i < n && err == CROUS_OK; i++) {
+        crous_value *item = crous_value_list_get(v, i);
+        crous_value_list_set(v, i, NULL);
+        err = fs_queue_item(dec, item);
+    }
+    crous_value_free_tree(v);
+    return err;
+}
+
+/* A SHARE tag: reserve the next slot for the value that follows */
+static crous_err_t fs_on_share(flux_stream_decoder_t *dec) {
+    if (!dec->value_refs || dec->value_share) return fs_fail(dec, CROUS_ERR_DECODE);
+    if (dec->share_count == dec->share_cap) {
+        size_t new_cap = dec->share_cap ? dec->share_cap * 2 : 16;
+        fs_share_t *grown = realloc(dec->shares, new_cap * sizeof(*grown));
+        if (!grown) return fs_fail(dec, CROUS_ERR_OOM);
+        dec->shares = grown;
+        dec->share_cap = new_cap;
+    }
+    fs_share_t *share = &dec->shares[dec->share_count++];
+    share->value = NULL;
+    share->start = dec->expanded;
+    share->values = 0;
+    dec->value_share = dec->share_count;
+    return CROUS_OK;
+}
+
+/* Keep a copy of shared value v, now complete, for later REFs */
+static crous_err_t fs_share_done(flux_stream_decoder_t *dec, size_t slot, const crous_value *v) {
+    fs_share_t *share = &dec->shares[slot - 1];
+    share->value = crous_value_clone(v);
+    if (!share->value) return CROUS_ERR_OOM;
+    share->values = dec->expanded - share->start;
+    return CROUS_OK;
+}
+
+/* Attach a finished value to its parent, closing every container it completes */
+static crous_err_t fs_complete(flux_stream_decoder_t *dec, crous_value *v) {
+    /* A SHARE before a scalar is consumed here, before a container by fs_push() */
+    size_t share = dec->value_share;
+    dec->value_share = 0;
+
+    for (;;) {
+        dec->values_decoded++;
+        dec->expanded++;
+
+        if (share) {
+            crous_err_t err = fs_share_done(dec, share, v);
+            if (err != CROUS_OK) {
+                crous_value_free_tree(v);
+                return fs_fail(dec, err);
+            }
+            share = 0;
+        }
+
+        if (dec->depth == 0) {
+            dec->state = FS_DONE;
+            if (!dec->items) {
+                dec->root = v;
+                return CROUS_OK;
+            }
+            crous_err_t err = fs_queue_root(dec, v);
+            return err == CROUS_OK ? CROUS_OK : fs_fail(dec, err);
+        }
+
+        fs_frame_t *f = &dec->stack[dec->depth - 1];
+        crous_err_t err = CROUS_OK;
+
+        switch (f->kind) {
+            case FS_FRAME_LIST:
+                /* Elements of a top-level list go out as they finish */
+                if (dec->items && dec->depth == 1) {
+                    err = fs_queue_item(dec, v);
+                    if (err != CROUS_OK) return fs_fail(dec, err);
+                    break;
+                }
+                err = crous_value_list_append(f->container, v);
+                break;
+            case FS_FRAME_DICT:
+                /* FLUX encoders never emit a key twice, so skip the duplicate check */
+                err = crous_value_dict_append_unique(f->container, (const char *)f->key, f->key_len, v);
+                if (f->key_owned) free(f->key);
+                f->key = NULL;
+                f->have_key = 0;
+                break;
+            case FS_FRAME_TAGGED: {
+                crous_value *t = crous_value_new_tagged(f->tag, v);
+                if (!t) {
+                    crous_value_free_tree(v);
+                    return fs_fail(dec, CROUS_ERR_OOM);
+                }
+                share = f->share;
+                dec->depth--;
+                v = t;
+                continue;
+            }
+            case FS_FRAME_TABLE: {
+                fs_table_t *t = f->table;
+                err = fs_table_add_cell(f, v);
+                if (err != CROUS_OK) break;
+                if (++t->row < t->rows) {
+                    fs_expect_next(dec);
+                    return CROUS_OK;
+                }
+                t->row = 0;
+                t->have_kind = 0;
+                if (++t->col < t->cols) {
+                    fs_expect_next(dec);
+                    return CROUS_OK;
+                }
+                /* Last column done: the table is the finished list */
+                v = f->container;
+                fs_table_free(t);
+                f->table = NULL;
+                share = f->share;
+                dec->tables_open--;
+                dec->depth--;
+                continue;
+            }
+        }
+
+        if (err != CROUS_OK) {
+            crous_value_free_tree(v);
+            return fs_fail(dec, err);
+        }
+
+        if (--f->remaining == 0) {
+            v = f->container;
+            share = f->share;
+            dec->depth--;
+            continue;
+        }
+
+        fs_expect_next(dec);
+        return CROUS_OK;
+    }
+}
+
+/* A REF: a copy of a complete shared value, within the expansion budget */
+static crous_err_t fs_on_ref(flux_stream_decoder_t *dec, uint64_t index) {
+    if (index >= dec->share_count || !dec->shares[index].value) return fs_fail(dec, CROUS_ERR_DECODE);
+    const fs_share_t *share = &dec->shares[index];
+    size_t budget = dec->values_decoded < (SIZE_MAX - FLUX_REF_EXPANSION_BASE) / FLUX_REF_EXPANSION
+        ? dec->values_decoded * FLUX_REF_EXPANSION + FLUX_REF_EXPANSION_BASE : SIZE_MAX;
+    if (share->values > budget - dec->ref_values) return fs_fail(dec, CROUS_ERR_DECODE);
+    dec->ref_values += share->values;
+
+    crous_value *v = crous_value_clone(share->value);
+    if (!v) return fs_fail(dec, CROUS_ERR_OOM);
+    /* fs_complete() counts the copy's root */
+    dec->expanded += share->values - 1;
+    return fs_complete(dec, v);
+}
+
+static crous_err_t fs_push(flux_stream_decoder_t *dec, fs_frame_kind_t kind, crous_value *container,
+                           uint64_t remaining, uint32_t tag, fs_table_t *table) {
+    /* fs_on_tag already checked depth against CROUS_MAX_DEPTH */
+    fs_frame_t *f = &dec->stack[dec->depth++];
+    f->kind = kind;
+    f->container = container;
+    f->remaining = remaining;
+    f->tag = tag;
+    f->key = NULL;
+    f->key_len = 0;
+    f->have_key = 0;
+    f->key_owned = 0;
+    f->table = table;
+    f->share = dec->value_share;
+    dec->value_share = 0;
+    fs_expect_next(dec);
+    return CROUS_OK;
+}
+
+/* Hand a literal key to the wire v3 key table; 0 if the table is full */
+static int fs_key_table_add(flux_stream_decoder_t *dec, uint8_t *data, size_t len) {
+    if (dec->dict_keys + dec->key_count >= FLUX_KEY_TABLE_MAX) return 0;
+
+    if (dec->key_count == dec->key_cap) {
+        size_t new_cap = dec->key_cap ? dec->key_cap * 2 : 64;
+        fs_key_t *keys = realloc(dec->keys, new_cap * sizeof(*keys));
+        if (!keys) return -1;
+        dec->keys = keys;
+        dec->key_cap = new_cap;
+    }
+
+    dec->keys[dec->key_count].data = data;
+    dec->keys[dec->key_count].len = len;
+    dec->key_count++;
+    return 1;
+}
+
+static crous_err_t fs_set_key(flux_stream_decoder_t *dec, uint8_t *data, size_t len, int owned) {
+    fs_frame_t *f = &dec->stack[dec->depth - 1];
+
+    if (f->kind == FS_FRAME_TABLE) {
+        fs_table_t *t = f->table;
+        if (t->key_count == t->key_cap) {
+            size_t new_cap = t->key_cap ? t->key_cap * 2 : 16;
+            fs_column_key_t *keys = realloc(t->keys, new_cap * sizeof(*keys));
+            if (!keys) {
+                if (owned) free(data);
+                return fs_fail(dec, CROUS_ERR_OOM);
+            }
+            t->keys = keys;
+            t->key_cap = new_cap;
+        }
+        t->keys[t->key_count].data = data;
+        t->keys[t->key_count].len = len;
+        t->keys[t->key_count].owned = owned;
+        t->key_count++;
+        fs_expect_next(dec);
+        return CROUS_OK;
+    }
+
+    f->key = data;
+    f->key_len = len;
+    f->have_key = 1;
+    f->key_owned = owned;
+    dec->state = FS_TAG;
+    return CROUS_OK;
+}
+
+static crous_err_t fs_payload_done(flux_stream_decoder_t *dec) {
+    uint8_t *data = dec->payload;
+    size_t len = dec->payload_len;
+    crous_value *v;
+
+    dec->payload = NULL;
+    dec->payload_cap = 0;
+
+    switch (dec->payload_kind) {
+        case FS_PAYLOAD_KEY: {
+            if (!data) {
+                /* Empty key: dict setters still want a non-NULL pointer */
+                data = malloc(1);
+                if (!data) return fs_fail(dec, CROUS_ERR_OOM);
+            }
+            int added = dec->key_refs ? fs_key_table_add(dec, data, len) : 0;
+            if (added < 0) {
+                free(data);
+                return fs_fail(dec, CROUS_ERR_OOM);
+            }
+            return fs_set_key(dec, data, len, !added);
+        }
+        case FS_PAYLOAD_STRING:
+            v = crous_value_new_string_take(data, len);
+            break;
+        case FS_PAYLOAD_I64:
+            v = crous_value_new_i64_array_take((int64_t *)data, len / 8);
+            break;
+        case FS_PAYLOAD_F64:
+            v = crous_value_new_f64_array_take((double *)data, len / 8);
+            break;
+        default:
+            v = crous_value_new_bytes_take(data, len);
+            break;
+    }
+
+    if (!v) {
+        free(data);
+        return fs_fail(dec, CROUS_ERR_OOM);
+    }
+    return fs_complete(dec, v);
+}
+
+static crous_err_t fs_start_payload(flux_stream_decoder_t *dec, fs_payload_t kind, uint64_t len) {
+    /* Array lengths were checked against CROUS_MAX_ARRAY_LEN already */
+    if (kind != FS_PAYLOAD_I64 && kind != FS_PAYLOAD_F64 && len > CROUS_MAX_STRING_BYTES)
+        return fs_fail(dec, CROUS_ERR_DECODE);
+
+    dec->payload_kind = kind;
+    dec->payload_len = (size_t)len;
+    dec->payload_fill = 0;
+    dec->payload_cap = 0;
+    dec->payload = NULL;
+
+    if (len == 0) return fs_payload_done(dec);
+
+    /* Grow toward the announced length as bytes arrive rather than trusting it */
+    dec->payload_cap = len < FS_INITIAL_PAYLOAD_CAP ? (size_t)len : FS_INITIAL_PAYLOAD_CAP;
+    dec->payload = malloc(dec->payload_cap);
+    if (!dec->payload) return fs_fail(dec, CROUS_ERR_OOM);
+    dec->state = FS_PAYLOAD;
+    return CROUS_OK;
+}
+
+static crous_err_t fs_start_container(flux_stream_decoder_t *dec, fs_varint_t kind, uint64_t count) {
+    size_t initial = count < FS_INITIAL_CONTAINER_CAP ? (size_t)count : FS_INITIAL_CONTAINER_CAP;
+    crous_value *v;
+
+    if (kind == FS_VARINT_DICT_COUNT) {
+        if (count > CROUS_MAX_DICT_SIZE) return fs_fail(dec, CROUS_ERR_DECODE);
+        v = crous_value_new_dict(initial);
+    } else {
+        if (count > CROUS_MAX_LIST_SIZE) return fs_fail(dec, CROUS_ERR_DECODE);
+        v = kind == FS_VARINT_TUPLE_COUNT ? crous_value_new_tuple(initial) : crous_value_new_list(initial);
+    }
+    if (!v) return fs_fail(dec, CROUS_ERR_OOM);
+
+    if (count == 0) return fs_complete(dec, v);
+    return fs_push(dec, kind == FS_VARINT_DICT_COUNT ? FS_FRAME_DICT : FS_FRAME_LIST, v, count, 0, NULL);
+}
+
+static crous_err_t fs_start_table(flux_stream_decoder_t *dec, uint64_t rows, uint64_t cols) {
+    if (cols == 0 || cols > CROUS_MAX_DICT_SIZE) return fs_fail(dec, CROUS_ERR_DECODE);
+
+    size_t initial = rows < FS_INITIAL_CONTAINER_CAP ? (size_t)rows : FS_INITIAL_CONTAINER_CAP;
+    crous_value *list = crous_value_new_list(initial);
+    fs_table_t *t = calloc(1, sizeof(*t));
+    if (!list || !t) {
+        crous_value_free_tree(list);
+        free(t);
+        return fs_fail(dec, CROUS_ERR_OOM);
+    }
+    t->rows = rows;
+    t->cols = cols;
+
+    dec->tables_open++;
+    return fs_push(dec, FS_FRAME_TABLE, list, 0, 0, t);
+}
+
+/* Column kind byte: checks it and sets up the column */
+static crous_err_t fs_on_column_kind(flux_stream_decoder_t *dec, uint8_t kind) {
+    fs_table_t *t = dec->stack[dec->depth - 1].table;
+    if (kind > FLUX_COLUMN_STRING) return fs_fail(dec, CROUS_ERR_DECODE);
+    t->kind = kind;
+    t->have_kind = 1;
+    t->prev = 0;
+    fs_expect_next(dec);
+    return CROUS_OK;
+}
+
+/* Pad byte of a packed array: checks it, then skips the padding */
+static crous_err_t fs_on_array_pad(flux_stream_decoder_t *dec, uint8_t pad) {
+    if (pad >= FLUX_ARRAY_ALIGN) return fs_fail(dec, CROUS_ERR_DECODE);
+    dec->pad_left = pad;
+    if (pad > 0) {
+        dec->state = FS_ARRAY_SKIP;
+        return CROUS_OK;
+    }
+    return fs_start_payload(dec, dec->array_kind, dec->array_count * 8);
+}
+
+/* One padding byte, which must be zero */
+static crous_err_t fs_on_array_skip(flux_stream_decoder_t *dec, uint8_t byte) {
+    if (byte != 0) return fs_fail(dec, CROUS_ERR_DECODE);
+    if (--dec->pad_left > 0) return CROUS_OK;
+    return fs_start_payload(dec, dec->array_kind, dec->array_count * 8);
+}
+
+/* One bitmap byte: up to eight cells of a BOOL column */
+static crous_err_t fs_on_bitmap(flux_stream_decoder_t *dec, uint8_t bits) {
+    fs_table_t *t = dec->stack[dec->depth - 1].table;
+    uint64_t n = t->rows - t->row < 8 ? t->rows - t->row : 8;
+
+    for (uint64_t i = 0; i < n; i++) {
+        crous_value *v = crous_value_new_bool((bits >> i) & 1);
+        if (!v) return fs_fail(dec, CROUS_ERR_OOM);
+        crous_err_t err = fs_complete(dec, v);
+        if (err != CROUS_OK) return err;
+    }
+    return CROUS_OK;
+}
+
+static crous_err_t fs_varint_done(flux_stream_decoder_t *dec, uint64_t value) {
+    CROUS_STAT_ADD(varint_reads, 1);
+    switch (dec->varint_kind) {
+        case FS_VARINT_INT: {
+            /* Decode zigzag encoding */
+            int64_t val = crous_zigzag_decode(value);
+            crous_value *v = crous_value_new_int(val);
+            if (!v) return fs_fail(dec, CROUS_ERR_OOM);
+            return fs_complete(dec, v);
+        }
+        case FS_VARINT_STRING_LEN:
+            return fs_start_payload(dec, FS_PAYLOAD_STRING, value);
+        case FS_VARINT_BYTES_LEN:
+            if (value > CROUS_MAX_BYTES_SIZE) return fs_fail(dec, CROUS_ERR_DECODE);
+            return fs_start_payload(dec, FS_PAYLOAD_BYTES, value);
+        case FS_VARINT_KEY_LEN:
+            if (!dec->key_refs)
+                return fs_start_payload(dec, FS_PAYLOAD_KEY, value);
+            if (value & 1) {
+                uint64_t index = value >> 1;
+                if (index < dec->dict_keys) {
+                    const char *key;
+                    size_t key_len;
+                    if (flux_dictionary_key(dec->env->dict, (size_t)index, &key, &key_len) != CROUS_OK)
+                        return fs_fail(dec, CROUS_ERR_INTERNAL);
+                    return fs_set_key(dec, (uint8_t *)(uintptr_t)key, key_len, 0);
+                }
+                index -= dec->dict_keys;
+                if (index >= dec->key_count) return fs_fail(dec, CROUS_ERR_DECODE);
+                return fs_set_key(dec, dec->keys[index].data, dec->keys[index].len, 0);
+            }
+            return fs_start_payload(dec, FS_PAYLOAD_KEY, value >> 1);
+        case FS_VARINT_LIST_COUNT:
+        case FS_VARINT_TUPLE_COUNT:
+        case FS_VARINT_DICT_COUNT:
+            return fs_start_container(dec, dec->varint_kind, value);
+        case FS_VARINT_TAG_NUM:
+            return fs_push(dec, FS_FRAME_TAGGED, NULL, 1, (uint32_t)value, NULL);
+        case FS_VARINT_TABLE_ROWS:
+            if (value == 0 || value > CROUS_MAX_LIST_SIZE) return fs_fail(dec, CROUS_ERR_DECODE);
+            dec->table_rows = value;
+            fs_start_varint(dec, FS_VARINT_TABLE_COLS);
+            return CROUS_OK;
+        case FS_VARINT_TABLE_COLS:
+            return fs_start_table(dec, dec->table_rows, value);
+        case FS_VARINT_CELL_DELTA: {
+            fs_table_t *t = dec->stack[dec->depth - 1].table;
+            int64_t delta = crous_zigzag_decode(value);
+            t->prev = (int64_t)((uint64_t)t->prev + (uint64_t)delta);
+            crous_value *v = crous_value_new_int(t->prev);
+            if (!v) return fs_fail(dec, CROUS_ERR_OOM);
+            return fs_complete(dec, v);
+        }
+        case FS_VARINT_I64_COUNT:
+        case FS_VARINT_F64_COUNT:
+            if (value > CROUS_MAX_ARRAY_LEN) return fs_fail(dec, CROUS_ERR_DECODE);
+            dec->array_kind = dec->varint_kind == FS_VARINT_I64_COUNT ? FS_PAYLOAD_I64 : FS_PAYLOAD_F64;
+            dec->array_count = value;
+            dec->state = FS_ARRAY_PAD;
+            return CROUS_OK;
+        case FS_VARINT_REF:
+            return fs_on_ref(dec, value);
+    }
+    return fs_fail(dec, CROUS_ERR_INTERNAL);
+}
+
+static crous_err_t fs_on_tag(flux_stream_decoder_t *dec, uint8_t tag) {
+    if (dec->depth + dec->tables_open >= CROUS_MAX_DEPTH) return fs_fail(dec, CROUS_ERR_DECODE);
+
+    crous_value *v;
+    switch (tag) {
+        case FLUX_TAG_NULL:
+            v = crous_value_new_null();
+            break;
+        case FLUX_TAG_FALSE:
+            v = crous_value_new_bool(0);
+            break;
+        case FLUX_TAG_TRUE:
+            v = crous_value_new_bool(1);
+            break;
+        case FLUX_TAG_INT:
+            fs_start_varint(dec, FS_VARINT_INT);
+            return CROUS_OK;
+        case FLUX_TAG_FLOAT:
+            dec->state = FS_FLOAT;
+            dec->scratch_len = 0;
+            return CROUS_OK;
+        case FLUX_TAG_STRING:
+            fs_start_varint(dec, FS_VARINT_STRING_LEN);
+            return CROUS_OK;
+        case FLUX_TAG_BYTES:
+            fs_start_varint(dec, FS_VARINT_BYTES_LEN);
+            return CROUS_OK;
+        case FLUX_TAG_LIST:
+            fs_start_varint(dec, FS_VARINT_LIST_COUNT);
+            return CROUS_OK;
+        case FLUX_TAG_TUPLE:
+            fs_start_varint(dec, FS_VARINT_TUPLE_COUNT);
+            return CROUS_OK;
+        case FLUX_TAG_DICT:
+            fs_start_varint(dec, FS_VARINT_DICT_COUNT);
+            return CROUS_OK;
+        case FLUX_TAG_TAGGED:
+            fs_start_varint(dec, FS_VARINT_TAG_NUM);
+            return CROUS_OK;
+        case FLUX_TAG_TABLE:
+            /* Cells sit two levels down, as in the equivalent list of dicts */
+            if (!dec->columnar || dec->depth + dec->tables_open + 2 >= CROUS_MAX_DEPTH)
+                return fs_fail(dec, CROUS_ERR_DECODE);
+            fs_start_varint(dec, FS_VARINT_TABLE_ROWS);
+            return CROUS_OK;
+        case FLUX_TAG_I64_ARRAY:
+            fs_start_varint(dec, FS_VARINT_I64_COUNT);
+            return CROUS_OK;
+        case FLUX_TAG_F64_ARRAY:
+            fs_start_varint(dec, FS_VARINT_F64_COUNT);
+            return CROUS_OK;
+        case FLUX_TAG_SHARE:
+            return fs_on_share(dec);
+        case FLUX_TAG_REF:
+            if (!dec->value_refs || dec->value_share) return fs_fail(dec, CROUS_ERR_DECODE);
+            fs_start_varint(dec, FS_VARINT_REF);
+            return CROUS_OK;
+        default:
+            return fs_fail(dec, CROUS_ERR_DECODE);
+    }
+
+    if (!v) return fs_fail(dec, CROUS_ERR_OOM);
+    return fs_complete(dec, v);
+}
+
+/* The extended header just read opens an envelope around the document */
+static crous_err_t fs_open_envelope(flux_stream_decoder_t *dec) {
+    crous_codec_t codec;
+    const flux_dictionary_t *dict;
+    crous_err_t err = flux_envelope_codec(dec->scratch, FLUX_ENVELOPE_HEADER_SIZE, &codec);
+    if (err == CROUS_OK) err = flux_envelope_dictionary(dec->scratch, FLUX_ENVELOPE_HEADER_SIZE, &dict);
+    if (err != CROUS_OK) return fs_fail(dec, err);
+
+    dec->env = calloc(1, sizeof(*dec->env));
+    if (!dec->env) return fs_fail(dec, CROUS_ERR_OOM);
+    dec->env->state = FS_ENV_BLOCK_HEADER;
+    dec->env->codec = codec;
+    dec->env->dict = dict;
+    dec->env->head_size = flux_envelope_checksummed(dec->scratch, FLUX_ENVELOPE_HEADER_SIZE) ? 12 : 8;
+    dec->dict_keys = flux_dictionary_key_count(dict);
+
+    /* The document inside starts with a header of its own */
+    dec->scratch_len = 0;
+    return CROUS_OK;
+}
+
+/* Run the state machine over document bytes; *used gets how many it took */
+static crous_err_t fs_feed_document(flux_stream_decoder_t *dec, const uint8_t *data, size_t len, size_t *used) {
+    size_t pos = 0;
+    crous_err_t err = CROUS_OK;
+
+    /* A new envelope hands over to fs_feed_envelope() for the bytes after its header */
+    while (pos < len && dec->state != FS_DONE && err == CROUS_OK && (!dec->env || dec->env->feeding)) {
+        switch (dec->state) {
+            case FS_HEADER:
+                dec->scratch[dec->scratch_len++] = data[pos++];
+                if (dec->scratch_len == 6) {
+                    if (dec->scratch[0] != FLUX_MAGIC_0 || dec->scratch[1] != FLUX_MAGIC_1 ||
+                        dec->scratch[2] != FLUX_MAGIC_2 || dec->scratch[3] != FLUX_MAGIC_3 ||
+                        dec->scratch[4] < FLUX_VERSION || dec->scratch[4] > FLUX_VERSION_VALUE_REFS) {
+                        err = fs_fail(dec, CROUS_ERR_INVALID_HEADER);
+                        break;
+                    }
+                    dec->key_refs = dec->scratch[4] >= FLUX_VERSION_KEY_REFS;
+                    dec->columnar = dec->scratch[4] >= FLUX_VERSION_COLUMNAR;
+                    dec->value_refs = dec->scratch[4] >= FLUX_VERSION_VALUE_REFS;
+                    
+                    /* An extended header continues; envelopes do not nest */
+                    if (dec->scratch[5] & FLUX_FLAG_EXTENDED) {
+                        if (dec->env) err = fs_fail(dec, CROUS_ERR_DECODE);
+                        break;
+                    }
+                    dec->state = FS_TAG;
+                } else if (dec->scratch_len == FLUX_ENVELOPE_HEADER_SIZE) {
+                    err = fs_open_envelope(dec);
+                }
+                break;
+
+            case FS_TAG:
+                err = fs_on_tag(dec, data[pos++]);
+                break;
+
+            case FS_COLUMN_KIND:
+                err = fs_on_column_kind(dec, data[pos++]);
+                break;
+
+            case FS_BITMAP:
+                err = fs_on_bitmap(dec, data[pos++]);
+                break;
+
+            case FS_ARRAY_PAD:
+                err = fs_on_array_pad(dec, data[pos++]);
+                break;
+
+            case FS_ARRAY_SKIP:
+                err = fs_on_array_skip(dec, data[pos++]);
+                break;
+
+            case FS_VARINT: {
+                /* Whole varint in this chunk: decode it in one step */
+                if (dec->varint_shift == 0 && len - pos >= CROUS_VARINT_MAX) {
+                    uint64_t value;
+                    size_t n = crous_varint_get_fast(data + pos, &value);
+                    if (!n) {
+                        err = fs_fail(dec, CROUS_ERR_DECODE);
+                        break;
+                    }
+                    pos += n;
+                    err = fs_varint_done(dec, value);
+                    break;
+                }
+                uint8_t byte = data[pos++];
+                if (dec->varint_shift >= 70) {
+                    err = fs_fail(dec, CROUS_ERR_DECODE);
+                    break;
+                }
+                dec->varint_value |= ((uint64_t)(byte & 0x7F)) << dec->varint_shift;
+                dec->varint_shift += 7;
+                if ((byte & 0x80) == 0)
+                    err = fs_varint_done(dec, dec->varint_value);
+                break;
+            }
+
+            case FS_FLOAT: {
+                size_t take = 8 - dec->scratch_len;
+                if (take > len - pos) take = len - pos;
+                memcpy(dec->scratch + dec->scratch_len, data + pos, take);
+                dec->scratch_len += take;
+                pos += take;
+                if (dec->scratch_len == 8) {
+                    double d;
+                    memcpy(&d, dec->scratch, 8);
+                    crous_value *v = crous_value_new_float(d);
+                    err = v ? fs_complete(dec, v) : fs_fail(dec, CROUS_ERR_OOM);
+                }
+                break;
+            }
+
+            case FS_PAYLOAD: {
+                size_t take = dec->payload_len - dec->payload_fill;
+                if (take > len - pos) take = len - pos;
+                if (dec->payload_fill + take > dec->payload_cap) {
+                    size_t new_cap = dec->payload_cap * 2;
+                    while (new_cap < dec->payload_fill + take) new_cap *= 2;
+                    if (new_cap > dec->payload_len) new_cap = dec->payload_len;
+                    uint8_t *grown = realloc(dec->payload, new_cap);
+                    if (!grown) {
+                        err = fs_fail(dec, CROUS_ERR_OOM);
+                        break;
+                    }
+                    dec->payload = grown;
+                    dec->payload_cap = new_cap;
+                }
+                memcpy(dec->payload + dec->payload_fill, data + pos, take);
+                dec->payload_fill += take;
+                pos += take;
+                if (dec->payload_fill == dec->payload_len)
+                    err = fs_payload_done(dec);
+                break;
+            }
+
+            default:
+                err = fs_fail(dec, CROUS_ERR_INTERNAL);
+                break;
+        }
+    }
+
+    *used = pos;
+    return err;
+}
+
+/* Decompress a whole block and feed it to the state machine, which must take all of it */
+static crous_err_t fs_envelope_block(flux_stream_decoder_t *dec, const uint8_t *block) {
+    fs_envelope_t *env = dec->env;
+    const uint8_t *raw = block;
+
+    if (env->stored_len != env->raw_len) {
+        if (env->raw_cap < env->raw_len) {
+            uint8_t *grown = realloc(env->raw, env->raw_len);
+            if (!grown) return fs_fail(dec, CROUS_ERR_OOM);
+            env->raw = grown;
+            env->raw_cap = env->raw_len;
+        }
+        crous_err_t err = crous_decompress_block_dict(env->codec, flux_dictionary_content(env->dict), block,
+                                                      env->stored_len, env->raw, env->raw_len);
+        if (err != CROUS_OK) return fs_fail(dec, err);
+        raw = env->raw;
+    }
+    if (env->head_size == 12 && crous_crc32c(0, raw, env->raw_len) != env->crc) {
+        return fs_fail(dec, CROUS_ERR_CHECKSUM);
+    }
+
+    size_t used;
+    env->feeding = 1;
+    crous_err_t err = fs_feed_document(dec, raw, env->raw_len, &used);
+    env->feeding = 0;
+    if (err != CROUS_OK) return err;
+    if (used != env->raw_len) return fs_fail(dec, CROUS_ERR_DECODE);  /* Bytes after the document */
+
+    env->state = FS_ENV_BLOCK_HEADER;
+    env->head_len = 0;
+    env->stored_fill = 0;
+    return CROUS_OK;
+}
+
+/* Take envelope bytes: block headers, block data and the end marker */
+static crous_err_t fs_feed_envelope(flux_stream_decoder_t *dec, const uint8_t *data, size_t len, size_t *used) {
+    fs_envelope_t *env = dec->env;
+    size_t pos = 0;
+    crous_err_t err = CROUS_OK;
+
+    while (pos < len && env->state != FS_ENV_END && err == CROUS_OK) {
+        if (env->state == FS_ENV_BLOCK_HEADER) {
+            /* The end marker is the first half of a block header */
+            size_t want = env->head_len < 4 ? 4 : env->head_size;
+            size_t take = want - env->head_len;
+            if (take > len - pos) take = len - pos;
+            memcpy(env->head + env->head_len, data + pos, take);
+            env->head_len += take;
+            pos += take;
+            if (env->head_len < want) break;
+
+            if (want == 4) {
+                env->raw_len = (uint32_t)env->head[0] | ((uint32_t)env->head[1] << 8) |
+                               ((uint32_t)env->head[2] << 16) | ((uint32_t)env->head[3] << 24);
+                if (env->raw_len == 0) {
+                    if (dec->state != FS_DONE) err = fs_fail(dec, CROUS_ERR_DECODE);
+                    else env->state = FS_ENV_END;
+                } else if (env->raw_len > FLUX_COMPRESS_BLOCK_MAX || dec->state == FS_DONE) {
+                    err = fs_fail(dec, CROUS_ERR_DECODE);
+                }
+                continue;
+            }
+
+            env->stored_len = (uint32_t)env->head[4] | ((uint32_t)env->head[5] << 8) |
+                              ((uint32_t)env->head[6] << 16) | ((uint32_t)env->head[7] << 24);
+            if (env->stored_len == 0 || env->stored_len > env->raw_len) {
+                err = fs_fail(dec, CROUS_ERR_DECODE);
+                continue;
+            }
+            if (env->head_size == 12) {
+                env->crc = (uint32_t)env->head[8] | ((uint32_t)env->head[9] << 8) |
+                           ((uint32_t)env->head[10] << 16) | ((uint32_t)env->head[11] << 24);
+            }
+            env->state = FS_ENV_BLOCK_DATA;
+            continue;
+        }
+
+        /* Whole block in this chunk: read it in place */
+        if (env->stored_fill == 0 && len - pos >= env->stored_len) {
+            err = fs_envelope_block(dec, data + pos);
+            pos += env->stored_len;
+            continue;
+        }
+
+        if (env->stored_cap < env->stored_len) {
+            uint8_t *grown = realloc(env->stored, env->stored_len);
+            if (!grown) {
+                err = fs_fail(dec, CROUS_ERR_OOM);
+                continue;
+            }
+            env->stored = grown;
+            env->stored_cap = env->stored_len;
+        }
+        size_t take = env->stored_len - env->stored_fill;
+        if (take > len - pos) take = len - pos;
+        memcpy(env->stored + env->stored_fill, data + pos, take);
+        env->stored_fill += take;
+        pos += take;
+        if (env->stored_fill == env->stored_len)
+            err = fs_envelope_block(dec, env->stored);
+    }
+
+    *used = pos;
+    return err;
+}
+
+crous_err_t flux_stream_decoder_feed(
+    flux_stream_decoder_t *dec,
+    const uint8_t *data,
+    size_t len,
+    size_t *consumed) {
+
+    if (consumed) *consumed = 0;
+    if (!dec || (!data && len > 0)) return CROUS_ERR_INVALID_TYPE;
+    if (dec->state == FS_ERROR) return dec->error;
+
+    size_t pos = 0;
+    crous_err_t err = CROUS_OK;
+
+    while (pos < len && !flux_stream_decoder_done(dec) && err == CROUS_OK) {
+        size_t used;
+        err = dec->env ? fs_feed_envelope(dec, data + pos, len - pos, &used)
+                       : fs_feed_document(dec, data + pos, len - pos, &used);
+        pos += used;
+    }
+
+    dec->bytes_consumed += pos;
+    if (consumed) *consumed = pos;
+    return err;
+}
+
+crous_err_t flux_stream_decoder_set_items(flux_stream_decoder_t *dec, int enable) {
+    if (!dec) return CROUS_ERR_INVALID_TYPE;
+    if (dec->state != FS_HEADER || dec->scratch_len > 0) return CROUS_ERR_INVALID_TYPE;
+    dec->items = enable ? 1 : 0;
+    return CROUS_OK;
+}
+
+crous_err_t flux_stream_decoder_next_item(
+    flux_stream_decoder_t *dec,
+    crous_value **out_value) {
+
+    if (!dec || !out_value) return CROUS_ERR_INVALID_TYPE;
+    if (dec->queue_head == dec->queue_len) {
+        *out_value = NULL;
+        return CROUS_ERR_NOT_FOUND;
+    }
+    *out_value = dec->queue[dec->queue_head++];
+    return CROUS_OK;
+}
+
+int flux_stream_decoder_done(const flux_stream_decoder_t *dec) {
+    if (!dec || dec->state != FS_DONE) return 0;
+    return !dec->env || dec->env->state == FS_ENV_END;
+}
+
+crous_err_t flux_stream_decoder_finish(
+    flux_stream_decoder_t *dec,
+    crous_value **out_value) {
+
+    if (!dec || !out_value) return CROUS_ERR_INVALID_TYPE;
+    if (dec->state == FS_ERROR) return dec->error;
+    if (!flux_stream_decoder_done(dec)) return CROUS_ERR_TRUNCATED;
+    if (!dec->root) return dec->items ? CROUS_ERR_NOT_FOUND : CROUS_ERR_TRUNCATED;
+
+    *out_value = dec->root;
+    dec->root = NULL;
+    return CROUS_OK;
+}
+
+void flux_stream_decoder_progress(
+    const flux_stream_decoder_t *dec,
+    flux_stream_progress_t *out) {
+
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!dec) return;
+    out->bytes_consumed = dec->bytes_consumed;
+    out->values_decoded = dec->values_decoded;
+    out->depth = dec->depth;
+    out->done = flux_stream_decoder_done(dec);
+}
@@ -15,7 +15,8 @@ struct crous_lexer_s {
 };
 
 crous_lexer* crous_lexer_create(const char *input, size_t input_len, crous_arena *arena) {
-    crous_lexer *lexer = malloc(sizeof(*lexer));
+    crous_lexer *lexer = arena ? crous_arena_alloc(arena, sizeof(*lexer))
+                               : malloc(sizeof(*lexer));
     if (!lexer) return NULL;
     
     lexer->input = input;
@@ -29,6 +30,10 @@ crous_lexer* crous_lexer_create(const char *input, size_t input_len, crous_arena
     return lexer;
 }
 
+void crous_lexer_free(crous_lexer *lexer) {
+    if (lexer && !lexer->arena) free(lexer);
+}
+
 static void skip_whitespace(crous_lexer *lexer) {
     while (lexer->pos < lexer->input_len) {
         char c = lexer->input[lexer->pos];
@@ -1,5 +1,6 @@
 #include "../include/crous_parser.h"
 #include "../include/crous_value.h"
+#include "../include/crous_stdtypes.h"
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
@@ -12,14 +13,10 @@
 /**
  * Process escape sequences in a string.
  * Handles: \n, \t, \r, \\, \", \', \0, \xNN, \uXXXX
- * Returns: newly allocated string with escapes processed, or NULL on error.
- * Sets *out_len to the length of the processed string.
+ * Writes the result to result, which must hold src_len bytes (the
+ * unescaped string is never longer than its source), and returns its length.
  */
-static char* process_escapes(const char *src, size_t src_len, size_t *out_len) {
-    /* Allocate buffer (escaped string is at most as long as source) */
-    char *result = malloc(src_len + 1);
-    if (!result) return NULL;
-    
+static size_t process_escapes(const char *src, size_t src_len, char *result) {
     size_t j = 0;  /* Output index */
     
     for (size_t i = 0; i < src_len; i++) {
@@ -38,7 +35,7 @@ static char* process_escapes(const char *src, size_t src_len, size_t *out_len) {
                 case 'v':  result[j++] = '\v'; i++; break;
                 case 'x': {
                     /* Hex escape: \xNN */
-                    if (i + 3 < src_len && isxdigit(src[i + 2]) && isxdigit(src[i + 3])) {
+                    if (i + 3 < src_len && isxdigit((unsigned char)src[i + 2]) && isxdigit((unsigned char)src[i + 3])) {
                         char hex[3] = {src[i + 2], src[i + 3], '\0'};
                         result[j++] = (char)strtol(hex, NULL, 16);
                         i += 3;
@@ -50,8 +47,8 @@ static char* process_escapes(const char *src, size_t src_len, size_t *out_len) {
                 case 'u': {
                     /* Unicode escape: \uXXXX */
                     if (i + 5 < src_len && 
-                        isxdigit(src[i + 2]) && isxdigit(src[i + 3]) &&
-                        isxdigit(src[i + 4]) && isxdigit(src[i + 5])) {
+                        isxdigit((unsigned char)src[i + 2]) && isxdigit((unsigned char)src[i + 3]) &&
+                        isxdigit((unsigned char)src[i + 4]) && isxdigit((unsigned char)src[i + 5])) {
                         char hex[5] = {src[i + 2], src[i + 3], src[i + 4], src[i + 5], '\0'};
                         uint32_t codepoint = (uint32_t)strtol(hex, NULL, 16);
                         
@@ -82,9 +79,7 @@ static char* process_escapes(const char *src, size_t src_len, size_t *out_len) {
         }
     }
     
-    result[j] = '\0';
-    *out_len = j;
-    return result;
+    return j;
 }
 
 /**
@@ -117,357 +112,442 @@ static uint32_t parse_tag_number(const char *start, size_t len) {
     
     /* Named tags - return hash-based ID */
     /* Common named tags */
-    if (tag_len == 8 && strncmp(tag_str, "datetime", 8) == 0) return 80;
-    if (tag_len == 4 && strncmp(tag_str, "date", 4) == 0) return 81;
-    if (tag_len == 4 && strncmp(tag_str, "time", 4) == 0) return 82;
-    if (tag_len == 7 && strncmp(tag_str, "decimal", 7) == 0) return 83;
-    if (tag_len == 4 && strncmp(tag_str, "uuid", 4) == 0) return 84;
-    if (tag_len == 3 && strncmp(tag_str, "set", 3) == 0) return 90;
-    if (tag_len == 9 && strncmp(tag_str, "frozenset", 9) == 0) return 91;
-    if (tag_len == 4 && strncmp(tag_str, "path", 4) == 0) return 92;
+    if (tag_len == 8 && strncmp(tag_str, "datetime", 8) == 0) return CROUS_TAG_DATETIME;
+    if (tag_len == 4 && strncmp(tag_str, "date", 4) == 0) return CROUS_TAG_DATE;
+    if (tag_len == 4 && strncmp(tag_str, "time", 4) == 0) return CROUS_TAG_TIME;
+    if (tag_len == 7 && strncmp(tag_str, "decimal", 7) == 0) return CROUS_TAG_DECIMAL;
+    if (tag_len == 4 && strncmp(tag_str, "uuid", 4) == 0) return CROUS_TAG_UUID;
+    if (tag_len == 3 && strncmp(tag_str, "set", 3) == 0) return CROUS_TAG_SET;
+    if (tag_len == 9 && strncmp(tag_str, "frozenset", 9) == 0) return CROUS_TAG_FROZENSET;
+    if (tag_len == 4 && strncmp(tag_str, "path", 4) == 0) return CROUS_TAG_PATH;
     
     /* Default: use simple hash */
-    uint32_t hash = 100;
+    uint32_t hash = CROUS_TAG_CUSTOM;
     for (size_t i = 0; i < tag_len; i++) {
         hash = hash * 31 + (uint8_t)tag_str[i];
     }
     return hash;
 }
 
+/*
+ * Container elements are collected on one shared stack and moved into
+ * the container when it closes, so every container is created at its
+ * final size. That is what lets arena containers, which cannot grow, be
+ * used at all. Dict keys ride along in the stack entries.
+ */
 struct crous_parser_s {
     crous_lexer *lexer;
     crous_arena *arena;
     crous_err_t last_error;
     int error_line;
     int error_col;
+    crous_dict_entry *stack;    /* Pending elements of the open containers */
+    size_t stack_len;
+    size_t stack_cap;
+    uint32_t *seen;             /* Duplicate-key table for arena dicts */
+    size_t seen_cap;
 };
 
 crous_parser* crous_parser_create(crous_lexer *lexer, crous_arena *arena) {
-    crous_parser *parser = malloc(sizeof(*parser));
+    crous_parser *parser = arena ? crous_arena_alloc(arena, sizeof(*parser))
+                                 : malloc(sizeof(*parser));
     if (!parser) return NULL;
-    
+
     parser->lexer = lexer;
     parser->arena = arena;
     parser->last_error = CROUS_OK;
     parser->error_line = 0;
     parser->error_col = 0;
-    
+    parser->stack = NULL;
+    parser->stack_len = 0;
+    parser->stack_cap = 0;
+    parser->seen = NULL;
+    parser->seen_cap = 0;
+
     return parser;
 }
 
-static crous_err_t parse_value(crous_parser *parser, crous_value **out_value, int depth);
+void crous_parser_free(crous_parser *parser) {
+    if (!parser || parser->arena) return;
+    free(parser->stack);
+    free(parser->seen);
+    free(parser);
+}
 
-static crous_err_t parse_list(crous_parser *parser, crous_value **out_value, int depth) {
-    crous_value *list = crous_value_new_list(0);
-    if (!list) return CROUS_ERR_OOM;
-    
-    crous_lexer_next(parser->lexer); /* consume [ */
-    
-    crous_token_t tok = crous_lexer_peek(parser->lexer);
-    
-    /* Empty list */
-    if (tok.type == CROUS_TOK_RBRACKET) {
-        crous_lexer_next(parser->lexer);
-        *out_value = list;
-        return CROUS_OK;
+/* Scratch memory: the arena's when there is one, so an arena parse needs
+ * no cleanup beyond the arena itself */
+static void* scratch_alloc(crous_parser *parser, size_t size) {
+    return parser->arena ? crous_arena_alloc(parser->arena, size) : malloc(size);
+}
+
+static void scratch_free(crous_parser *parser, void *p) {
+    if (!parser->arena) free(p);
+}
+
+static crous_err_t stack_push(crous_parser *parser, const char *key, size_t key_len, crous_value *value) {
+    if (parser->stack_len == parser->stack_cap) {
+        size_t cap = parser->stack_cap ? parser->stack_cap * 2 : 64;
+        crous_dict_entry *grown = scratch_alloc(parser, cap * sizeof(*grown));
+        if (!grown) return CROUS_ERR_OOM;
+        if (parser->stack_len) memcpy(grown, parser->stack, parser->stack_len * sizeof(*grown));
+        scratch_free(parser, parser->stack);
+        parser->stack = grown;
+        parser->stack_cap = cap;
     }
-    
-    while (1) {
-        crous_value *item = NULL;
-        crous_err_t err = parse_value(parser, &item, depth + 1);
-        if (err != CROUS_OK) {
-            crous_value_free_tree(list);
-            return err;
-        }
-        
-        err = crous_value_list_append(list, item);
-        if (err != CROUS_OK) {
-            crous_value_free_tree(list);
-            crous_value_free_tree(item);
-            return err;
-        }
-        
-        tok = crous_lexer_peek(parser->lexer);
-        
-        if (tok.type == CROUS_TOK_RBRACKET) {
-            crous_lexer_next(parser->lexer);
-            break;
+    crous_dict_entry *e = &parser->stack[parser->stack_len++];
+    e->key = (char *)key;
+    e->key_len = key_len;
+    e->value = value;
+    return CROUS_OK;
+}
+
+/* Drop the elements above base, freeing heap values */
+static void stack_unwind(crous_parser *parser, size_t base) {
+    while (parser->stack_len > base)
+        crous_value_free_tree(parser->stack[--parser->stack_len].value);
+}
+
+static uint64_t key_hash(const char *key, size_t key_len) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < key_len; i++) {
+        h ^= (uint8_t)key[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* Fold repeated keys among the n entries at e, in place: each key keeps
+ * its first position and its last value, as crous_value_dict_set() does.
+ * Returns the new count, or (size_t)-1 on OOM. */
+static size_t dedupe_keys(crous_parser *parser, crous_dict_entry *e, size_t n) {
+    if (n < 2) return n;
+    if (n <= 8) {
+        size_t out = 0;
+        for (size_t i = 0; i < n; i++) {
+            size_t j = 0;
+            while (j < out && (e[j].key_len != e[i].key_len ||
+                               memcmp(e[j].key, e[i].key, e[i].key_len) != 0))
+                j++;
+            if (j < out) e[j].value = e[i].value;
+            else e[out++] = e[i];
         }
-        
-        if (tok.type == CROUS_TOK_COMMA) {
-            crous_lexer_next(parser->lexer);
-            tok = crous_lexer_peek(parser->lexer);
-            
-            /* Allow trailing comma */
-            if (tok.type == CROUS_TOK_RBRACKET) {
-                crous_lexer_next(parser->lexer);
+        return out;
+    }
+
+    size_t cap = 32;
+    while (cap < n * 2) cap *= 2;
+    if (cap > parser->seen_cap) {
+        uint32_t *grown = scratch_alloc(parser, cap * sizeof(uint32_t));
+        if (!grown) return (size_t)-1;
+        scratch_free(parser, parser->seen);
+        parser->seen = grown;
+        parser->seen_cap = cap;
+    }
+    memset(parser->seen, 0, cap * sizeof(uint32_t));
+
+    size_t mask = cap - 1, out = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t slot = (size_t)key_hash(e[i].key, e[i].key_len) & mask;
+        while (parser->seen[slot]) {
+            crous_dict_entry *prev = &e[parser->seen[slot] - 1];
+            if (prev->key_len == e[i].key_len && memcmp(prev->key, e[i].key, e[i].key_len) == 0)
                 break;
-            }
+            slot = (slot + 1) & mask;
+        }
+        if (parser->seen[slot]) {
+            e[parser->seen[slot] - 1].value = e[i].value;
         } else {
-            crous_value_free_tree(list);
-            parser->error_line = tok.line;
-            parser->error_col = tok.col;
-            return CROUS_ERR_SYNTAX;
+            e[out] = e[i];
+            parser->seen[slot] = (uint32_t)++out;
         }
     }
-    
-    *out_value = list;
+    return out;
+}
+
+/* Move the elements above base into a new list or tuple */
+static crous_err_t close_sequence(crous_parser *parser, crous_type_t type, size_t base, crous_value **out_value) {
+    size_t n = parser->stack_len - base;
+    crous_value *seq = type == CROUS_TYPE_TUPLE ? crous_value_new_tuple_arena(parser->arena, n)
+                                                : crous_value_new_list_arena(parser->arena, n);
+    if (!seq) {
+        stack_unwind(parser, base);
+        return CROUS_ERR_OOM;
+    }
+    for (size_t i = 0; i < n; i++)
+        seq->data.list.items[i] = parser->stack[base + i].value;
+    seq->data.list.len = n;
+    parser->stack_len = base;
+    *out_value = seq;
     return CROUS_OK;
 }
 
-static crous_err_t parse_tuple(crous_parser *parser, crous_value **out_value, int depth) {
-    crous_value *tuple = crous_value_new_tuple(0);
-    if (!tuple) return CROUS_ERR_OOM;
-    
-    crous_lexer_next(parser->lexer); /* consume ( */
-    
+/* Move the entries above base into a new dict. Arena dicts borrow their
+ * keys from the input; heap dicts copy them. */
+static crous_err_t close_dict(crous_parser *parser, size_t base, crous_value **out_value) {
+    crous_dict_entry *e = parser->stack + base;
+    size_t n = parser->stack_len - base;
+    crous_value *dict;
+    crous_err_t err = CROUS_OK;
+
+    if (parser->arena) {
+        n = dedupe_keys(parser, e, n);
+        if (n == (size_t)-1) return CROUS_ERR_OOM;
+        dict = crous_value_new_dict_arena(parser->arena, n);
+        if (!dict) return CROUS_ERR_OOM;
+        for (size_t i = 0; i < n && err == CROUS_OK; i++)
+            err = crous_value_dict_append_borrowed(parser->arena, dict, e[i].key, e[i].key_len, e[i].value);
+        parser->stack_len = base;
+    } else {
+        dict = crous_value_new_dict(n);
+        if (!dict) {
+            stack_unwind(parser, base);
+            return CROUS_ERR_OOM;
+        }
+        /* Entries move into the dict one at a time, so a failure part way
+         * leaves each value owned by exactly one of the two */
+        size_t i = 0;
+        for (; i < n && err == CROUS_OK; i++) {
+            err = crous_value_dict_set_binary(dict, e[i].key, e[i].key_len, e[i].value);
+            if (err == CROUS_OK) e[i].value = NULL;
+        }
+        if (err != CROUS_OK) {
+            crous_value_free_tree(dict);
+            stack_unwind(parser, base);
+            return err;
+        }
+        parser->stack_len = base;
+    }
+    *out_value = dict;
+    return err;
+}
+
+static crous_err_t parse_value(crous_parser *parser, crous_value **out_value, int depth);
+
+/* List or tuple body after its opening token, up to and including close */
+static crous_err_t parse_sequence(crous_parser *parser, crous_type_t type, crous_token_type_t close,
+                                  crous_value **out_value, int depth) {
+    size_t base = parser->stack_len;
     crous_token_t tok = crous_lexer_peek(parser->lexer);
-    
-    /* Empty tuple */
-    if (tok.type == CROUS_TOK_RPAREN) {
+
+    /* Empty list/tuple */
+    if (tok.type == close) {
         crous_lexer_next(parser->lexer);
-        *out_value = tuple;
-        return CROUS_OK;
+        return close_sequence(parser, type, base, out_value);
     }
-    
+
     while (1) {
         crous_value *item = NULL;
         crous_err_t err = parse_value(parser, &item, depth + 1);
-        if (err != CROUS_OK) {
-            crous_value_free_tree(tuple);
-            return err;
+        if (err == CROUS_OK) {
+            err = stack_push(parser, NULL, 0, item);
+            if (err != CROUS_OK) crous_value_free_tree(item);
         }
-        
-        err = crous_value_list_append(tuple, item);
         if (err != CROUS_OK) {
-            crous_value_free_tree(tuple);
-            crous_value_free_tree(item);
+            stack_unwind(parser, base);
             return err;
         }
-        
+
         tok = crous_lexer_peek(parser->lexer);
-        
-        if (tok.type == CROUS_TOK_RPAREN) {
+
+        if (tok.type == close) {
             crous_lexer_next(parser->lexer);
             break;
         }
-        
+
         if (tok.type == CROUS_TOK_COMMA) {
             crous_lexer_next(parser->lexer);
             tok = crous_lexer_peek(parser->lexer);
-            
-            if (tok.type == CROUS_TOK_RPAREN) {
+
+            /* Allow trailing comma */
+            if (tok.type == close) {
                 crous_lexer_next(parser->lexer);
                 break;
             }
         } else {
-            crous_value_free_tree(tuple);
+            stack_unwind(parser, base);
             parser->error_line = tok.line;
             parser->error_col = tok.col;
             return CROUS_ERR_SYNTAX;
         }
     }
-    
-    *out_value = tuple;
-    return CROUS_OK;
+
+    return close_sequence(parser, type, base, out_value);
 }
 
 static crous_err_t parse_dict(crous_parser *parser, crous_value **out_value, int depth) {
-    crous_value *dict = crous_value_new_dict(0);
-    if (!dict) return CROUS_ERR_OOM;
-    
-    crous_lexer_next(parser->lexer); /* consume { */
-    
+    size_t base = parser->stack_len;
     crous_token_t tok = crous_lexer_peek(parser->lexer);
-    
+
     /* Empty dict */
     if (tok.type == CROUS_TOK_RBRACE) {
         crous_lexer_next(parser->lexer);
-        *out_value = dict;
-        return CROUS_OK;
+        return close_dict(parser, base, out_value);
     }
-    
+
     while (1) {
         tok = crous_lexer_next(parser->lexer);
-        
+
         if (tok.type != CROUS_TOK_STRING) {
-            crous_value_free_tree(dict);
+            stack_unwind(parser, base);
             parser->error_line = tok.line;
             parser->error_col = tok.col;
             return CROUS_ERR_SYNTAX;
         }
-        
-        /* Extract key string, stripping surrounding quotes */
-        const char *key_src = tok.start;
+
+        /* Key span inside the input, stripping surrounding quotes */
+        const char *key = tok.start;
         size_t key_len = tok.len;
-        if (key_len >= 2 && (key_src[0] == '"' || key_src[0] == '\'') &&
-            key_src[key_len - 1] == key_src[0]) {
-            key_src++;
+        if (key_len >= 2 && (key[0] == '"' || key[0] == '\'') &&
+            key[key_len - 1] == key[0]) {
+            key++;
             key_len -= 2;
         }
-        char *key = malloc(key_len + 1);
-        if (!key) {
-            crous_value_free_tree(dict);
-            return CROUS_ERR_OOM;
-        }
-        memcpy(key, key_src, key_len);
-        key[key_len] = '\0';
-        
+
         tok = crous_lexer_next(parser->lexer);
         if (tok.type != CROUS_TOK_COLON) {
-            free(key);
-            crous_value_free_tree(dict);
+            stack_unwind(parser, base);
             parser->error_line = tok.line;
             parser->error_col = tok.col;
             return CROUS_ERR_SYNTAX;
         }
-        
+
         crous_value *value = NULL;
         crous_err_t err = parse_value(parser, &value, depth + 1);
-        if (err != CROUS_OK) {
-            free(key);
-            crous_value_free_tree(dict);
-            return err;
+        if (err == CROUS_OK) {
+            err = stack_push(parser, key, key_len, value);
+            if (err != CROUS_OK) crous_value_free_tree(value);
         }
-        
-        err = crous_value_dict_set(dict, key, value);
-        free(key);
         if (err != CROUS_OK) {
-            crous_value_free_tree(dict);
-            crous_value_free_tree(value);
+            stack_unwind(parser, base);
             return err;
         }
-        
+
         tok = crous_lexer_peek(parser->lexer);
-        
+
         if (tok.type == CROUS_TOK_RBRACE) {
             crous_lexer_next(parser->lexer);
             break;
         }
-        
+
         if (tok.type == CROUS_TOK_COMMA) {
             crous_lexer_next(parser->lexer);
             tok = crous_lexer_peek(parser->lexer);
-            
+
             if (tok.type == CROUS_TOK_RBRACE) {
                 crous_lexer_next(parser->lexer);
                 break;
             }
         } else {
-            crous_value_free_tree(dict);
+            stack_unwind(parser, base);
             parser->error_line = tok.line;
             parser->error_col = tok.col;
             return CROUS_ERR_SYNTAX;
         }
     }
-    
-    *out_value = dict;
-    return CROUS_OK;
+
+    return close_dict(parser, base, out_value);
+}
+
+/* String token body. Without backslashes an arena parse borrows the span
+ * from the input; otherwise it is unescaped straight into its final home. */
+static crous_value* parse_string(crous_parser *parser, const char *src, size_t src_len) {
+    crous_arena *arena = parser->arena;
+
+    if (!memchr(src, '\\', src_len)) {
+        return arena ? crous_value_new_string_borrowed(arena, src, src_len)
+                     : crous_value_new_string(src, src_len);
+    }
+
+    if (arena) {
+        char *buf = crous_arena_alloc(arena, src_len);
+        if (!buf) return NULL;
+        return crous_value_new_string_borrowed(arena, buf, process_escapes(src, src_len, buf));
+    }
+
+    char *buf = malloc(src_len);
+    if (!buf) return NULL;
+    crous_value *v = crous_value_new_string_take((uint8_t *)buf, process_escapes(src, src_len, buf));
+    if (!v) free(buf);
+    return v;
 }
 
 static crous_err_t parse_value(crous_parser *parser, crous_value **out_value, int depth) {
     if (depth > CROUS_MAX_DEPTH) {
         return CROUS_ERR_DEPTH_EXCEEDED;
     }
-    
+
+    crous_arena *arena = parser->arena;
     crous_token_t tok = crous_lexer_next(parser->lexer);
-    
+    crous_value *v;
+
     switch (tok.type) {
-        case CROUS_TOK_NULL: {
-            crous_value *v = crous_value_new_null();
-            if (!v) return CROUS_ERR_OOM;
-            *out_value = v;
-            return CROUS_OK;
-        }
-        
-        case CROUS_TOK_BOOL_TRUE: {
-            crous_value *v = crous_value_new_bool(1);
-            if (!v) return CROUS_ERR_OOM;
-            *out_value = v;
-            return CROUS_OK;
-        }
-        
-        case CROUS_TOK_BOOL_FALSE: {
-            crous_value *v = crous_value_new_bool(0);
-            if (!v) return CROUS_ERR_OOM;
-            *out_value = v;
-            return CROUS_OK;
-        }
-        
+        case CROUS_TOK_NULL:
+            v = crous_value_new_null_arena(arena);
+            break;
+
+        case CROUS_TOK_BOOL_TRUE:
+            v = crous_value_new_bool_arena(arena, 1);
+            break;
+
+        case CROUS_TOK_BOOL_FALSE:
+            v = crous_value_new_bool_arena(arena, 0);
+            break;
+
         case CROUS_TOK_INT: {
-            int64_t val = 0;
-            char *endptr = NULL;
             errno = 0;
-            val = strtoll(tok.start, &endptr, 10);
+            int64_t val = strtoll(tok.start, NULL, 10);
             if (errno == ERANGE) return CROUS_ERR_DECODE;
-            
-            crous_value *v = crous_value_new_int(val);
-            if (!v) return CROUS_ERR_OOM;
-            *out_value = v;
-            return CROUS_OK;
+            v = crous_value_new_int_arena(arena, val);
+            break;
         }
-        
+
         case CROUS_TOK_FLOAT: {
             errno = 0;
             double val = strtod(tok.start, NULL);
             if (errno == ERANGE) return CROUS_ERR_DECODE;
-            
-            crous_value *v = crous_value_new_float(val);
-            if (!v) return CROUS_ERR_OOM;
-            *out_value = v;
-            return CROUS_OK;
-        }
-        
-        case CROUS_TOK_STRING: {
-            /* Process escape sequences in the string */
-            const char *str_content = tok.start + 1;  /* Skip opening quote */
-            size_t str_len = tok.len - 2;             /* Exclude both quotes */
-            
-            size_t processed_len = 0;
-            char *processed = process_escapes(str_content, str_len, &processed_len);
-            if (!processed) return CROUS_ERR_OOM;
-            
-            crous_value *v = crous_value_new_string(processed, processed_len);
-            free(processed);
-            if (!v) return CROUS_ERR_OOM;
-            *out_value = v;
-            return CROUS_OK;
-        }
-        
-        case CROUS_TOK_LBRACKET: {
-            return parse_list(parser, out_value, depth);
-        }
-        
-        case CROUS_TOK_LPAREN: {
-            return parse_tuple(parser, out_value, depth);
+            v = crous_value_new_float_arena(arena, val);
+            break;
         }
-        
-        case CROUS_TOK_LBRACE: {
+
+        case CROUS_TOK_STRING:
+            /* Skip both quotes */
+            v = parse_string(parser, tok.start + 1, tok.len - 2);
+            break;
+
+        case CROUS_TOK_LBRACKET:
+            return parse_sequence(parser, CROUS_TYPE_LIST, CROUS_TOK_RBRACKET, out_value, depth);
+
+        case CROUS_TOK_LPAREN:
+            return parse_sequence(parser, CROUS_TYPE_TUPLE, CROUS_TOK_RPAREN, out_value, depth);
+
+        case CROUS_TOK_LBRACE:
             return parse_dict(parser, out_value, depth);
-        }
-        
+
         case CROUS_TOK_TAGGED: {
             /* Parse @tag value - extract tag number from token */
             uint32_t tag = parse_tag_number(tok.start, tok.len);
-            
+
             crous_value *inner = NULL;
             crous_err_t err = parse_value(parser, &inner, depth + 1);
             if (err != CROUS_OK) return err;
-            
-            crous_value *v = crous_value_new_tagged(tag, inner);
+
+            v = crous_value_new_tagged_arena(arena, tag, inner);
             if (!v) {
                 crous_value_free_tree(inner);
                 return CROUS_ERR_OOM;
             }
-            *out_value = v;
-            return CROUS_OK;
+            break;
         }
-        
+
         default:
             parser->error_line = tok.line;
             parser->error_col = tok.col;
             return CROUS_ERR_SYNTAX;
     }
+
+    if (!v) return CROUS_ERR_OOM;
+    *out_value = v;
+    return CROUS_OK;
 }
 
 crous_err_t crous_parser_parse(crous_parser *parser, crous_value **out_value) {
@@ -0,0 +1,359 @@
+#include "../include/crous_compress.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+   LZ4 BLOCK FORMAT
+   ============================================================================ */
+
+/*
+ * A block is a run of sequences: a token byte (literal count in the high
+ * nibble, match length - 4 in the low one, 15 meaning "more bytes follow,
+ * each adding up to 255"), the literals, then a 16-bit little-endian back
+ * offset and the rest of the match length. The last sequence is literals
+ * only; the format requires the final 5 bytes to be literals and the last
+ * match to start at least 12 bytes before the end.
+ */
+
+#define LZ4_MIN_MATCH     4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MF_LIMIT      12
+#define LZ4_MAX_OFFSET    65535
+#define LZ4_HASH_LOG      12
+#define LZ4_SKIP_TRIGGER  6     /* Probe step grows every 64 failed probes */
+
+static inline uint32_t lz4_read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t lz4_read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint32_t lz4_hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ4_HASH_LOG);
+}
+
+/* Bytes of a and b that agree, scanning no further than limit */
+static inline size_t lz4_common(const uint8_t *a, const uint8_t *b, const uint8_t *limit) {
+    const uint8_t *start = a;
+    while (a + 8 <= limit) {
+        uint64_t diff = lz4_read64(a) ^ lz4_read64(b);
+        if (diff) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__aarch64__) || defined(__i386__))
+            return (size_t)(a - start) + ((size_t)__builtin_ctzll(diff) >> 3);
+#else
+            while (*a == *b) {
+                a++;
+                b++;
+            }
+            return (size_t)(a - start);
+#endif
+        }
+        a += 8;
+        b += 8;
+    }
+    while (a < limit && *a == *b) {
+        a++;
+        b++;
+    }
+    return (size_t)(a - start);
+}
+
+/* A 15-continued length; NULL if it does not fit before end */
+static inline uint8_t *lz4_put_length(uint8_t *op, const uint8_t *end, size_t len) {
+    for (; len >= 255; len -= 255) {
+        if (op >= end) return NULL;
+        *op++ = 255;
+    }
+    if (op >= end) return NULL;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+/* One sequence: literals [anchor, ip) then, when match_len, a match */
+static uint8_t *lz4_put_sequence(uint8_t *op, const uint8_t *end, const uint8_t *anchor, size_t lit_len,
+                                 size_t offset, size_t match_len) {
+    if (op >= end) return NULL;
+    uint8_t *token = op++;
+    size_t ml = match_len ? match_len - LZ4_MIN_MATCH : 0;
+
+    *token = (uint8_t)(((lit_len < 15 ? lit_len : 15) << 4) | (ml < 15 ? ml : 15));
+    if (lit_len >= 15 && !(op = lz4_put_length(op, end, lit_len - 15))) return NULL;
+    if ((size_t)(end - op) < lit_len) return NULL;
+    memcpy(op, anchor, lit_len);
+    op += lit_len;
+    if (!match_len) return op;
+
+    if (end - op < 2) return NULL;
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    if (ml >= 15 && !(op = lz4_put_length(op, end, ml - 15))) return NULL;
+    return op;
+}
+
+/* Dictionary bytes and the match table over them, built once */
+struct crous_compress_dict {
+    uint8_t *data;
+    size_t len;
+    uint32_t table[1u << LZ4_HASH_LOG];
+};
+
+/*
+ * Greedy single-probe compressor; returns 0 if the output exceeds cap.
+ * Positions in the match table count from the start of the dictionary,
+ * with src following straight on, so one offset reaches either. Inlined
+ * into both callers so the one without a dictionary folds its checks away.
+ */
+static inline size_t lz4_compress(const crous_compress_dict *dict, const uint8_t *src, size_t len,
+                           uint8_t *dst, size_t cap) {
+    uint32_t table[1u << LZ4_HASH_LOG];
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *end = src + len;
+    uint8_t *op = dst;
+    uint8_t *op_end = dst + cap;
+    const uint8_t *dict_data = dict ? dict->data : NULL;
+    size_t dict_len = dict && dict->len >= LZ4_MIN_MATCH ? dict->len : 0;
+
+    if (len > LZ4_MF_LIMIT) {
+        const uint8_t *mf_limit = end - LZ4_MF_LIMIT;
+        const uint8_t *match_limit = end - LZ4_LAST_LITERALS;
+        if (dict_len) memcpy(table, dict->table, sizeof(table));
+        else memset(table, 0, sizeof(table));
+        table[lz4_hash(lz4_read32(ip))] = (uint32_t)dict_len;
+        ip++;
+
+        while (ip < mf_limit) {
+            /* Probe for a 4-byte match, stepping faster through incompressible runs */
+            const uint8_t *ref;
+            size_t seen, offset;
+            size_t attempts = 1u << LZ4_SKIP_TRIGGER;
+            for (;;) {
+                uint32_t h = lz4_hash(lz4_read32(ip));
+                size_t at = dict_len + (size_t)(ip - src);
+                seen = table[h];
+                table[h] = (uint32_t)at;
+                ref = seen < dict_len ? dict_data + seen : src + (seen - dict_len);
+                offset = at - seen;
+                if (seen < at && offset <= LZ4_MAX_OFFSET && lz4_read32(ref) == lz4_read32(ip)) break;
+                ip += attempts++ >> LZ4_SKIP_TRIGGER;
+                if (ip >= mf_limit) goto last_literals;
+            }
+
+            /* Extend backwards over literals, then forwards; a dictionary
+               match stops where the dictionary does */
+            int in_dict = seen < dict_len;
+            const uint8_t *low = in_dict ? dict_data : src;
+            while (ip > anchor && ref > low && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            const uint8_t *limit = match_limit;
+            if (in_dict && (size_t)(dict_data + dict_len - ref) < (size_t)(match_limit - ip)) {
+                limit = ip + (dict_data + dict_len - ref);
+            }
+            size_t match_len = LZ4_MIN_MATCH + lz4_common(ip + LZ4_MIN_MATCH, ref + LZ4_MIN_MATCH, limit);
+
+            op = lz4_put_sequence(op, op_end, anchor, (size_t)(ip - anchor), offset, match_len);
+            if (!op) return 0;
+            ip += match_len;
+            anchor = ip;
+            if (ip < mf_limit) table[lz4_hash(lz4_read32(ip - 2))] = (uint32_t)(dict_len + (size_t)(ip - 2 - src));
+        }
+    }
+
+last_literals:
+    op = lz4_put_sequence(op, op_end, anchor, (size_t)(end - anchor), 0, 0);
+    return op ? (size_t)(op - dst) : 0;
+}
+
+/* A 15-continued length at *ip; 0 on overrun */
+static inline int lz4_get_length(const uint8_t **ip, const uint8_t *end, size_t *len) {
+    uint8_t b;
+    do {
+        if (*ip >= end) return 0;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 1;
+}
+
+static crous_err_t lz4_decompress(const crous_compress_dict *dict, const uint8_t *src, size_t len,
+                                  uint8_t *dst, size_t raw_len) {
+    const uint8_t *ip = src;
+    const uint8_t *end = src + len;
+    uint8_t *op = dst;
+    uint8_t *op_end = dst + raw_len;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !lz4_get_length(&ip, end, &lit_len)) return CROUS_ERR_DECODE;
+        if ((size_t)(end - ip) < lit_len || (size_t)(op_end - op) < lit_len) return CROUS_ERR_DECODE;
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == end) break;  /* Last sequence: literals only */
+
+        if (end - ip < 2) return CROUS_ERR_DECODE;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t produced = (size_t)(op - dst);
+        if (offset == 0 || offset > produced + (dict ? dict->len : 0)) return CROUS_ERR_DECODE;
+
+        size_t match_len = token & 15;
+        if (match_len == 15 && !lz4_get_length(&ip, end, &match_len)) return CROUS_ERR_DECODE;
+        match_len += LZ4_MIN_MATCH;
+        if ((size_t)(op_end - op) < match_len) return CROUS_ERR_DECODE;
+
+        if (offset > produced) {
+            /* Starts in the dictionary and may run on into dst */
+            size_t back = offset - produced;
+            size_t n = back < match_len ? back : match_len;
+            memcpy(op, dict->data + dict->len - back, n);
+            for (size_t i = 0; i < match_len - n; i++) op[n + i] = dst[i];
+            op += match_len;
+            continue;
+        }
+
+        const uint8_t *ref = op - offset;
+        if (offset >= 8 && (size_t)(op_end - op) >= match_len + 8) {
+            /* Whole words; the overshoot stays inside dst and is overwritten later */
+            uint8_t *stop = op + match_len;
+            do {
+                memcpy(op, ref, 8);
+                op += 8;
+                ref += 8;
+            } while (op < stop);
+            op = stop;
+        } else {
+            /* Overlapping copy repeats the last offset bytes */
+            for (size_t i = 0; i < match_len; i++) op[i] = ref[i];
+            op += match_len;
+        }
+    }
+
+    return op == op_end ? CROUS_OK : CROUS_ERR_DECODE;
+}
+
+/* ============================================================================
+   CODEC DISPATCH
+   ============================================================================ */
+
+int crous_codec_available(crous_codec_t codec) {
+    return codec == CROUS_CODEC_NONE || codec == CROUS_CODEC_LZ4;
+}
+
+const char *crous_codec_name(crous_codec_t codec) {
+    switch (codec) {
+        case CROUS_CODEC_NONE: return "none";
+        case CROUS_CODEC_LZ4:  return "lz4";
+        case CROUS_CODEC_ZSTD: return "zstd";
+        default:               return NULL;
+    }
+}
+
+size_t crous_compress_bound(crous_codec_t codec, size_t len) {
+    if (codec == CROUS_CODEC_LZ4) return len + len / 255 + 16;
+    return len;
+}
+
+crous_err_t crous_compress_block(crous_codec_t codec, const uint8_t *src, size_t len,
+                                 uint8_t *dst, size_t cap, size_t *out_len) {
+    return crous_compress_block_dict(codec, NULL, src, len, dst, cap, out_len);
+}
+
+crous_err_t crous_compress_block_dict(crous_codec_t codec, const crous_compress_dict *dict,
+                                      const uint8_t *src, size_t len,
+                                      uint8_t *dst, size_t cap, size_t *out_len) {
+    if ((!src && len) || (!dst && cap) || !out_len) return CROUS_ERR_INVALID_TYPE;
+
+    switch (codec) {
+        case CROUS_CODEC_NONE:
+            *out_len = len <= cap ? len : 0;
+            if (*out_len) memcpy(dst, src, len);
+            return CROUS_OK;
+        case CROUS_CODEC_LZ4:
+            if (len > 0x7E000000u) return CROUS_ERR_OVERFLOW;  /* LZ4 block input limit */
+            *out_len = dict ? lz4_compress(dict, src, len, dst, cap) : lz4_compress(NULL, src, len, dst, cap);
+            return CROUS_OK;
+        default:
+            return CROUS_ERR_INVALID_TYPE;
+    }
+}
+
+crous_err_t crous_decompress_block(crous_codec_t codec, const uint8_t *src, size_t len,
+                                   uint8_t *dst, size_t raw_len) {
+    return crous_decompress_block_dict(codec, NULL, src, len, dst, raw_len);
+}
+
+crous_err_t crous_decompress_block_dict(crous_codec_t codec, const crous_compress_dict *dict,
+                                        const uint8_t *src, size_t len,
+                                        uint8_t *dst, size_t raw_len) {
+    if ((!src && len) || (!dst && raw_len)) return CROUS_ERR_INVALID_TYPE;
+
+    switch (codec) {
+        case CROUS_CODEC_NONE:
+            if (len != raw_len) return CROUS_ERR_DECODE;
+            if (len) memcpy(dst, src, len);
+            return CROUS_OK;
+        case CROUS_CODEC_LZ4:
+            return lz4_decompress(dict, src, len, dst, raw_len);
+        default:
+            return CROUS_ERR_DECODE;
+    }
+}
+
+/* ============================================================================
+   DICTIONARIES
+   ============================================================================ */
+
+crous_err_t crous_compress_dict_new(const uint8_t *content, size_t len, crous_compress_dict **out_dict) {
+    if ((!content && len) || !out_dict) return CROUS_ERR_INVALID_TYPE;
+
+    /* Older bytes would be out of reach of any offset */
+    if (len > CROUS_COMPRESS_DICT_MAX) {
+        content += len - CROUS_COMPRESS_DICT_MAX;
+        len = CROUS_COMPRESS_DICT_MAX;
+    }
+
+    crous_compress_dict *dict = malloc(sizeof(*dict));
+    if (!dict) return CROUS_ERR_OOM;
+    dict->data = malloc(len ? len : 1);
+    if (!dict->data) {
+        free(dict);
+        return CROUS_ERR_OOM;
+    }
+    if (len) memcpy(dict->data, content, len);
+    dict->len = len;
+
+    /* Later positions win, as they would had the compressor just passed them */
+    memset(dict->table, 0, sizeof(dict->table));
+    for (size_t i = 0; i + LZ4_MIN_MATCH <= len; i++) {
+        dict->table[lz4_hash(lz4_read32(dict->data + i))] = (uint32_t)i;
+    }
+
+    *out_dict = dict;
+    return CROUS_OK;
+}
+
+const uint8_t *crous_compress_dict_content(const crous_compress_dict *dict, size_t *out_len) {
+    if (!dict) {
+        if (out_len) *out_len = 0;
+        return NULL;
+    }
+    if (out_len) *out_len = dict->len;
+    return dict->data;
+}
+
+void crous_compress_dict_free(crous_compress_dict *dict) {
+    if (!dict) return;
+    free(dict->data);
+    free(dict);
+}
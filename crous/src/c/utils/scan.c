@@ -0,0 +1,402 @@
+#include "../include/crous_scan.h"
+
+/* ============================================================================
+   KERNEL SELECTION
+   ============================================================================ */
+
+#if !defined(CROUS_NO_SIMD)
+#  if defined(__SSE2__) || defined(_M_X64)
+#    define CROUS_SCAN_SSE2 1
+#    include <emmintrin.h>
+#  endif
+#  if defined(__GNUC__) && defined(CROUS_SCAN_SSE2) && \
+      (defined(__x86_64__) || defined(__i386__))
+#    define CROUS_SCAN_AVX2 1
+#    include <immintrin.h>
+#  endif
+#  if defined(__aarch64__) && defined(__ARM_NEON)
+#    define CROUS_SCAN_NEON 1
+#    include <arm_neon.h>
+#  endif
+#endif
+
+/* -1 until the first scan detects the CPU. Every thread that races here
+ * computes the same value, so a relaxed store is enough. */
+static int g_simd_level = -1;
+
+#if defined(__GNUC__)
+#  define LEVEL_LOAD()   __atomic_load_n(&g_simd_level, __ATOMIC_RELAXED)
+#  define LEVEL_STORE(v) __atomic_store_n(&g_simd_level, (v), __ATOMIC_RELAXED)
+#else
+#  define LEVEL_LOAD()   (g_simd_level)
+#  define LEVEL_STORE(v) (g_simd_level = (v))
+#endif
+
+static crous_simd_level_t detect_level(void) {
+#if defined(CROUS_SCAN_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return CROUS_SIMD_AVX2;
+#endif
+#if defined(CROUS_SCAN_SSE2)
+    return CROUS_SIMD_SSE2;
+#elif defined(CROUS_SCAN_NEON)
+    return CROUS_SIMD_NEON;
+#else
+    return CROUS_SIMD_SCALAR;
+#endif
+}
+
+crous_simd_level_t crous_simd_level(void) {
+    int level = LEVEL_LOAD();
+    if (level < 0) {
+        level = (int)detect_level();
+        LEVEL_STORE(level);
+    }
+    return (crous_simd_level_t)level;
+}
+
+const char* crous_simd_level_name(crous_simd_level_t level) {
+    switch (level) {
+        case CROUS_SIMD_SSE2: return "sse2";
+        case CROUS_SIMD_AVX2: return "avx2";
+        case CROUS_SIMD_NEON: return "neon";
+        default: return "scalar";
+    }
+}
+
+static inline unsigned ctz32(uint32_t x) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctz(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1u)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+/* ============================================================================
+   SCALAR KERNELS
+   ============================================================================ */
+
+static inline unsigned char_class(unsigned char c) {
+    unsigned k = 0;
+    unsigned char lower = (unsigned char)(c | 0x20);
+
+    if (c == ' ' || c == '\t') k |= CROUS_CHAR_BLANK;
+    if (c == '\r') k |= CROUS_CHAR_CR;
+    if (c == '\n') k |= CROUS_CHAR_LF;
+    if ((c >= '0' && c <= '9') || (lower >= 'a' && lower <= 'z') || c == '_')
+        k |= CROUS_CHAR_IDENT;
+    if ((c >= 0x09 && c <= 0x0D) || c == ' ' || c == '\0' || c == ':' || c == '@' ||
+        c == '[' || c == ']' || c == '#' || c == '"' || c == '\'')
+        k |= CROUS_CHAR_SPECIAL;
+    if (c == '"' || c == '\'' || c == '\\') k |= CROUS_CHAR_QUOTE;
+    return k;
+}
+
+/* Scan until a byte's membership in `classes` equals `stop` */
+static size_t scan_scalar(const uint8_t *p, size_t len, unsigned classes, int stop) {
+    size_t i = 0;
+    while (i < len && ((char_class(p[i]) & classes) != 0) != stop) i++;
+    return i;
+}
+
+static size_t ascii_scalar(const uint8_t *p, size_t len) {
+    size_t i = 0;
+    while (i < len && p[i] < 0x80) i++;
+    return i;
+}
+
+/* ============================================================================
+   SSE2 KERNELS
+   ============================================================================ */
+
+#if defined(CROUS_SCAN_SSE2)
+
+#define SSE2_EQ(v, c) _mm_cmpeq_epi8((v), _mm_set1_epi8((char)(c)))
+
+/* Unsigned (v - lo) <= span, lane-wise */
+static inline __m128i sse2_in_range(__m128i v, int lo, int span) {
+    __m128i x = _mm_sub_epi8(v, _mm_set1_epi8((char)lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8((char)span)), x);
+}
+
+static inline __m128i sse2_classify(__m128i v, unsigned classes) {
+    __m128i m = _mm_setzero_si128();
+
+    if (classes & CROUS_CHAR_BLANK)
+        m = _mm_or_si128(m, _mm_or_si128(SSE2_EQ(v, ' '), SSE2_EQ(v, '\t')));
+    if (classes & CROUS_CHAR_CR) m = _mm_or_si128(m, SSE2_EQ(v, '\r'));
+    if (classes & CROUS_CHAR_LF) m = _mm_or_si128(m, SSE2_EQ(v, '\n'));
+    if (classes & CROUS_CHAR_IDENT) {
+        __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        m = _mm_or_si128(m, sse2_in_range(v, '0', 9));
+        m = _mm_or_si128(m, sse2_in_range(lower, 'a', 25));
+        m = _mm_or_si128(m, SSE2_EQ(v, '_'));
+    }
+    if (classes & CROUS_CHAR_SPECIAL) {
+        m = _mm_or_si128(m, sse2_in_range(v, 0x09, 4));
+        m = _mm_or_si128(m, _mm_or_si128(SSE2_EQ(v, ' '), SSE2_EQ(v, '\0')));
+        m = _mm_or_si128(m, _mm_or_si128(SSE2_EQ(v, ':'), SSE2_EQ(v, '@')));
+        m = _mm_or_si128(m, _mm_or_si128(SSE2_EQ(v, '['), SSE2_EQ(v, ']')));
+        m = _mm_or_si128(m, _mm_or_si128(SSE2_EQ(v, '#'), SSE2_EQ(v, '"')));
+        m = _mm_or_si128(m, SSE2_EQ(v, '\''));
+    }
+    if (classes & CROUS_CHAR_QUOTE) {
+        m = _mm_or_si128(m, _mm_or_si128(SSE2_EQ(v, '"'), SSE2_EQ(v, '\'')));
+        m = _mm_or_si128(m, SSE2_EQ(v, '\\'));
+    }
+    return m;
+}
+
+static size_t scan_sse2(const uint8_t *p, size_t len, unsigned classes, int stop) {
+    size_t i = 0;
+    while (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(sse2_classify(v, classes));
+        if (!stop) mask = ~mask & 0xFFFFu;
+        if (mask) return i + ctz32(mask);
+        i += 16;
+    }
+    return i + scan_scalar(p + i, len - i, classes, stop);
+}
+
+static size_t ascii_sse2(const uint8_t *p, size_t len) {
+    size_t i = 0;
+    while (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(v);
+        if (mask) return i + ctz32(mask);
+        i += 16;
+    }
+    return i + ascii_scalar(p + i, len - i);
+}
+
+#endif /* CROUS_SCAN_SSE2 */
+
+/* ============================================================================
+   AVX2 KERNELS
+   ============================================================================ */
+
+#if defined(CROUS_SCAN_AVX2)
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX2_EQ(v, c) _mm256_cmpeq_epi8((v), _mm256_set1_epi8((char)(c)))
+
+static inline AVX2_TARGET __m256i avx2_in_range(__m256i v, int lo, int span) {
+    __m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8((char)lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8((char)span)), x);
+}
+
+static inline AVX2_TARGET __m256i avx2_classify(__m256i v, unsigned classes) {
+    __m256i m = _mm256_setzero_si256();
+
+    if (classes & CROUS_CHAR_BLANK)
+        m = _mm256_or_si256(m, _mm256_or_si256(AVX2_EQ(v, ' '), AVX2_EQ(v, '\t')));
+    if (classes & CROUS_CHAR_CR) m = _mm256_or_si256(m, AVX2_EQ(v, '\r'));
+    if (classes & CROUS_CHAR_LF) m = _mm256_or_si256(m, AVX2_EQ(v, '\n'));
+    if (classes & CROUS_CHAR_IDENT) {
+        __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        m = _mm256_or_si256(m, avx2_in_range(v, '0', 9));
+        m = _mm256_or_si256(m, avx2_in_range(lower, 'a', 25));
+        m = _mm256_or_si256(m, AVX2_EQ(v, '_'));
+    }
+    if (classes & CROUS_CHAR_SPECIAL) {
+        m = _mm256_or_si256(m, avx2_in_range(v, 0x09, 4));
+        m = _mm256_or_si256(m, _mm256_or_si256(AVX2_EQ(v, ' '), AVX2_EQ(v, '\0')));
+        m = _mm256_or_si256(m, _mm256_or_si256(AVX2_EQ(v, ':'), AVX2_EQ(v, '@')));
+        m = _mm256_or_si256(m, _mm256_or_si256(AVX2_EQ(v, '['), AVX2_EQ(v, ']')));
+        m = _mm256_or_si256(m, _mm256_or_si256(AVX2_EQ(v, '#'), AVX2_EQ(v, '"')));
+        m = _mm256_or_si256(m, AVX2_EQ(v, '\''));
+    }
+    if (classes & CROUS_CHAR_QUOTE) {
+        m = _mm256_or_si256(m, _mm256_or_si256(AVX2_EQ(v, '"'), AVX2_EQ(v, '\'')));
+        m = _mm256_or_si256(m, AVX2_EQ(v, '\\'));
+    }
+    return m;
+}
+
+static AVX2_TARGET size_t scan_avx2(const uint8_t *p, size_t len, unsigned classes, int stop) {
+    size_t i = 0;
+    while (i + 32 <= len) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(avx2_classify(v, classes));
+        if (!stop) mask = ~mask;
+        if (mask) return i + ctz32(mask);
+        i += 32;
+    }
+    return i + scan_sse2(p + i, len - i, classes, stop);
+}
+
+static AVX2_TARGET size_t ascii_avx2(const uint8_t *p, size_t len) {
+    size_t i = 0;
+    while (i + 32 <= len) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(v);
+        if (mask) return i + ctz32(mask);
+        i += 32;
+    }
+    return i + ascii_sse2(p + i, len - i);
+}
+
+#endif /* CROUS_SCAN_AVX2 */
+
+/* ============================================================================
+   NEON KERNELS
+   ============================================================================ */
+
+#if defined(CROUS_SCAN_NEON)
+
+#define NEON_EQ(v, c) vceqq_u8((v), vdupq_n_u8((uint8_t)(c)))
+
+static inline uint8x16_t neon_in_range(uint8x16_t v, int lo, int span) {
+    return vcleq_u8(vsubq_u8(v, vdupq_n_u8((uint8_t)lo)), vdupq_n_u8((uint8_t)span));
+}
+
+/* Narrow a lane mask to 4 bits per byte; the first set nibble is the first lane */
+static inline uint64_t neon_mask(uint8x16_t m) {
+    uint8x8_t nib = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nib), 0);
+}
+
+static inline unsigned neon_first(uint64_t mask) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(mask) >> 2;
+#else
+    unsigned n = 0;
+    while (!(mask & 1u)) { mask >>= 1; n++; }
+    return n >> 2;
+#endif
+}
+
+static inline uint8x16_t neon_classify(uint8x16_t v, unsigned classes) {
+    uint8x16_t m = vdupq_n_u8(0);
+
+    if (classes & CROUS_CHAR_BLANK)
+        m = vorrq_u8(m, vorrq_u8(NEON_EQ(v, ' '), NEON_EQ(v, '\t')));
+    if (classes & CROUS_CHAR_CR) m = vorrq_u8(m, NEON_EQ(v, '\r'));
+    if (classes & CROUS_CHAR_LF) m = vorrq_u8(m, NEON_EQ(v, '\n'));
+    if (classes & CROUS_CHAR_IDENT) {
+        uint8x16_t lower = vorrq_u8(v, vdupq_n_u8(0x20));
+        m = vorrq_u8(m, neon_in_range(v, '0', 9));
+        m = vorrq_u8(m, neon_in_range(lower, 'a', 25));
+        m = vorrq_u8(m, NEON_EQ(v, '_'));
+    }
+    if (classes & CROUS_CHAR_SPECIAL) {
+        m = vorrq_u8(m, neon_in_range(v, 0x09, 4));
+        m = vorrq_u8(m, vorrq_u8(NEON_EQ(v, ' '), NEON_EQ(v, '\0')));
+        m = vorrq_u8(m, vorrq_u8(NEON_EQ(v, ':'), NEON_EQ(v, '@')));
+        m = vorrq_u8(m, vorrq_u8(NEON_EQ(v, '['), NEON_EQ(v, ']')));
+        m = vorrq_u8(m, vorrq_u8(NEON_EQ(v, '#'), NEON_EQ(v, '"')));
+        m = vorrq_u8(m, NEON_EQ(v, '\''));
+    }
+    if (classes & CROUS_CHAR_QUOTE) {
+        m = vorrq_u8(m, vorrq_u8(NEON_EQ(v, '"'), NEON_EQ(v, '\'')));
+        m = vorrq_u8(m, NEON_EQ(v, '\\'));
+    }
+    return m;
+}
+
+static size_t scan_neon(const uint8_t *p, size_t len, unsigned classes, int stop) {
+    size_t i = 0;
+    while (i + 16 <= len) {
+        uint64_t mask = neon_mask(neon_classify(vld1q_u8(p + i), classes));
+        if (!stop) mask = ~mask;
+        if (mask) return i + neon_first(mask);
+        i += 16;
+    }
+    return i + scan_scalar(p + i, len - i, classes, stop);
+}
+
+static size_t ascii_neon(const uint8_t *p, size_t len) {
+    size_t i = 0;
+    while (i + 16 <= len) {
+        uint64_t mask = neon_mask(vcgeq_u8(vld1q_u8(p + i), vdupq_n_u8(0x80)));
+        if (mask) return i + neon_first(mask);
+        i += 16;
+    }
+    return i + ascii_scalar(p + i, len - i);
+}
+
+#endif /* CROUS_SCAN_NEON */
+
+/* ============================================================================
+   DISPATCH
+   ============================================================================ */
+
+static size_t scan(const uint8_t *p, size_t len, unsigned classes, int stop) {
+    switch (crous_simd_level()) {
+#if defined(CROUS_SCAN_AVX2)
+        case CROUS_SIMD_AVX2: return scan_avx2(p, len, classes, stop);
+#endif
+#if defined(CROUS_SCAN_SSE2)
+        case CROUS_SIMD_SSE2: return scan_sse2(p, len, classes, stop);
+#endif
+#if defined(CROUS_SCAN_NEON)
+        case CROUS_SIMD_NEON: return scan_neon(p, len, classes, stop);
+#endif
+        default: return scan_scalar(p, len, classes, stop);
+    }
+}
+
+/* Length of the leading run of ASCII bytes */
+static size_t ascii_prefix(const uint8_t *p, size_t len) {
+    switch (crous_simd_level()) {
+#if defined(CROUS_SCAN_AVX2)
+        case CROUS_SIMD_AVX2: return ascii_avx2(p, len);
+#endif
+#if defined(CROUS_SCAN_SSE2)
+        case CROUS_SIMD_SSE2: return ascii_sse2(p, len);
+#endif
+#if defined(CROUS_SCAN_NEON)
+        case CROUS_SIMD_NEON: return ascii_neon(p, len);
+#endif
+        default: return ascii_scalar(p, len);
+    }
+}
+
+size_t crous_scan_span(const char *data, size_t len, unsigned classes) {
+    if (!data) return 0;
+    return scan((const uint8_t *)data, len, classes, 0);
+}
+
+size_t crous_scan_cspan(const char *data, size_t len, unsigned classes) {
+    if (!data) return 0;
+    return scan((const uint8_t *)data, len, classes, 1);
+}
+
+/* ============================================================================
+   UTF-8 VALIDATION
+   ============================================================================ */
+
+int crous_utf8_valid(const uint8_t *data, size_t len) {
+    size_t i = 0;
+
+    while (i < len) {
+        /* ASCII runs go through the vector kernel; multi-byte sequences are
+         * checked one at a time until the next ASCII byte. */
+        i += ascii_prefix(data + i, len - i);
+
+        while (i < len && data[i] >= 0x80) {
+            uint8_t byte = data[i];
+            int cont_bytes;
+
+            if ((byte & 0xE0) == 0xC0) {
+                cont_bytes = 1;
+            } else if ((byte & 0xF0) == 0xE0) {
+                cont_bytes = 2;
+            } else if ((byte & 0xF8) == 0xF0) {
+                cont_bytes = 3;
+            } else {
+                return 0;
+            }
+
+            i++;
+            for (int j = 0; j < cont_bytes; j++) {
+                if (i >= len) return 0;
+                if ((data[i++] & 0xC0) != 0x80) return 0;
+            }
+        }
+    }
+    return 1;
+}
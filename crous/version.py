@@ -33,6 +33,7 @@ from functools import total_ordering
 from typing import (
     TYPE_CHECKING,
     Any,
+    BinaryIO,
     Callable,
     Dict,
     List,
@@ -75,11 +76,14 @@ else:
 # Wire format versions
 WIRE_VERSION_CURRENT = 2
 WIRE_VERSION_MIN_READ = 1
-WIRE_VERSION_MAX_READ = 2
+WIRE_VERSION_MAX_READ = 5
 
 # Wire version history
 WIRE_V1 = 1  # Initial format: basic types
 WIRE_V2 = 2  # Added: tagged values, tuples, set/frozenset
+WIRE_V3 = 3  # Added: dict key back-references (opt-in)
+WIRE_V4 = 4  # Added: columnar tables (opt-in)
+WIRE_V5 = 5  # Added: shared-value back-references (opt-in)
 
 
 # ============================================================================
@@ -100,7 +104,7 @@ class Feature(IntFlag):
     # Encoding features
     COMPRESSION = 0x0010   # LZ4/ZSTD compression
     STREAMING = 0x0020     # Streaming mode
-    SCHEMA = 0x0040        # Schema validation
+    SCHEMA = 0x0040        # Schema-compiled positional layout (id in the extended header)
     ENCRYPTION = 0x0080    # Encrypted payload
     
     # Extended types
@@ -113,11 +117,20 @@ class Feature(IntFlag):
     COMMENTS = 0x1000      # Embedded comments
     METADATA = 0x2000      # Header metadata
     CHECKSUMS = 0x4000     # Integrity checksums
+    
+    # Layout features, signalled by wire version rather than header flags
+    KEY_TABLE = 0x10000    # Dict key back-references (wire v3)
+    COLUMNAR = 0x20000     # Columnar tables (wire v4)
+    PACKED_ARRAYS = 0x40000  # Packed int64/float64 arrays (type tags, any wire version)
+    DICTIONARY = 0x80000   # Shared dictionaries (named in compressed envelopes)
+    VALUE_REFS = 0x100000  # Shared-value back-references (wire v5)
 
 # Features supported by this version
 FEATURES_SUPPORTED = (
     Feature.TAGGED | Feature.TUPLE | Feature.SET | Feature.FROZENSET |
-    Feature.DATETIME | Feature.DECIMAL | Feature.UUID
+    Feature.DATETIME | Feature.DECIMAL | Feature.UUID | Feature.KEY_TABLE |
+    Feature.COLUMNAR | Feature.PACKED_ARRAYS | Feature.COMPRESSION |
+    Feature.CHECKSUMS | Feature.DICTIONARY | Feature.SCHEMA | Feature.VALUE_REFS
 )
 
 
@@ -591,11 +604,11 @@ def check_compatibility(data: bytes) -> CompatibilityResult:
         return CompatibilityResult(Compatibility.ERR_TOO_NEW, header)
     
     # Check features
-    unsupported = header.features & ~info.features
+    required_mask = Feature(0x8000)
+    unsupported = header.features & ~required_mask & ~info.features
     if unsupported:
         # Check if unsupported features are required
-        required_mask = Feature(0x8000)
-        if unsupported & required_mask:
+        if header.features & required_mask:
             return CompatibilityResult(
                 Compatibility.ERR_FEATURES, header, unsupported
             )
@@ -721,17 +734,25 @@ MigrationFunc = Callable[[bytes], bytes]
 
 @dataclass
 class Migration:
-    """Migration definition."""
+    """Migration definition. A migration without func only rewrites the version byte."""
     
     from_version: int
     to_version: int
-    func: MigrationFunc
+    func: Optional[MigrationFunc]
     description: str = ""
+    
+    @property
+    def header_only(self) -> bool:
+        """Whether the migration leaves everything but the version byte alone."""
+        return self.func is None
 
 
 # Registry of migrations
 _migrations: List[Migration] = []
 
+# Bytes migrate_stream() copies at a time on header-only paths
+_MIGRATE_CHUNK_SIZE = 65536
+
 
 def register_migration(
     from_version: int,
@@ -743,6 +764,20 @@ def register_migration(
     _migrations.append(Migration(from_version, to_version, func, description))
 
 
+def register_header_migration(
+    from_version: int,
+    to_version: int,
+    description: str = "",
+) -> None:
+    """
+    Register a migration whose only change is the version byte.
+    
+    Paths made only of these are applied by migrate_in_place() and
+    streamed by migrate_stream() without reading the whole document.
+    """
+    _migrations.append(Migration(from_version, to_version, None, description))
+
+
 def get_migration_path(from_version: int, to_version: int) -> List[Migration]:
     """Find migration path between versions."""
     if from_version == to_version:
@@ -782,6 +817,17 @@ def get_migration_path(from_version: int, to_version: int) -> List[Migration]:
     return path
 
 
+def _plan_migration(version: int, target_version: int) -> List[Migration]:
+    if version == target_version:
+        return []
+    path = get_migration_path(version, target_version)
+    if not path:
+        raise ValueError(
+            f"No migration path from version {version} to {target_version}"
+        )
+    return path
+
+
 def migrate(
     data: bytes,
     target_version: Optional[int] = None
@@ -789,6 +835,9 @@ def migrate(
     """
     Migrate binary data to target version.
     
+    Header-only hops rewrite the version byte of one shared copy instead
+    of copying the data each.
+    
     Args:
         data: Binary CROUS data
         target_version: Target wire version (default: current)
@@ -810,29 +859,99 @@ def migrate(
     if current_version == target_version:
         return data
     
-    path = get_migration_path(current_version, target_version)
-    if not path:
-        raise ValueError(
-            f"No migration path from version {current_version} to {target_version}"
-        )
+    path = _plan_migration(current_version, target_version)
     
     result = data
+    patched = None
     for migration in path:
+        if migration.header_only:
+            if patched is None:
+                patched = bytearray(result)
+            patched[4] = migration.to_version
+            continue
+        if patched is not None:
+            result, patched = bytes(patched), None
         result = migration.func(result)
     
-    return result
+    return bytes(patched) if patched is not None else result
+
+
+def migrate_in_place(
+    data: bytearray,
+    target_version: Optional[int] = None
+) -> bool:
+    """
+    Rewrite the version byte of data in place when every hop to
+    target_version is header-only.
+    
+    Args:
+        data: Writable buffer (bytearray, memoryview, mmap) holding one document
+        target_version: Target wire version (default: current)
+        
+    Returns:
+        True if data is now at target_version, False if some hop has to
+        rewrite the body (use migrate()); data is then left untouched.
+        
+    Raises:
+        ValueError: If data is too short or there is no migration path
+    """
+    if len(data) < 6:
+        raise ValueError("Data too short")
+    
+    if target_version is None:
+        target_version = WIRE_VERSION_CURRENT
+    
+    path = _plan_migration(data[4], target_version)
+    if not all(m.header_only for m in path):
+        return False
+    
+    data[4] = target_version
+    return True
 
 
-# Built-in migration: v1 -> v2
-def _migrate_v1_to_v2(data: bytes) -> bytes:
-    """Migrate from wire v1 to v2."""
-    result = bytearray(data)
-    result[4] = 2  # Update version byte
-    return bytes(result)
+def migrate_stream(
+    src: BinaryIO,
+    dst: BinaryIO,
+    target_version: Optional[int] = None
+) -> None:
+    """
+    Migrate the one document read from src, writing it to dst.
+    
+    Header-only paths copy the document through in fixed-size chunks, so
+    memory stays bounded however large it is. Other paths read the whole
+    document and migrate() it.
+    
+    Args:
+        src: Binary file object to read
+        dst: Binary file object to write
+        target_version: Target wire version (default: current)
+        
+    Raises:
+        ValueError: If the document is too short or there is no migration path
+    """
+    if target_version is None:
+        target_version = WIRE_VERSION_CURRENT
+    
+    chunk = bytearray(src.read(_MIGRATE_CHUNK_SIZE))
+    while 0 < len(chunk) < 6:
+        more = src.read(_MIGRATE_CHUNK_SIZE)
+        if not more:
+            break
+        chunk += more
+    if len(chunk) < 6:
+        raise ValueError("Data too short")
+    
+    if not migrate_in_place(chunk, target_version):
+        dst.write(migrate(bytes(chunk) + src.read(), target_version))
+        return
+    
+    while chunk:
+        dst.write(chunk)
+        chunk = src.read(_MIGRATE_CHUNK_SIZE)
 
 
 # Register built-in migrations
-register_migration(1, 2, _migrate_v1_to_v2, "Update version byte")
+register_header_migration(1, 2, "Update version byte")
 
 
 # ============================================================================
@@ -869,6 +988,9 @@ __all__ = [
     'warn_deprecated',
     'deprecated',
     'register_migration',
+    'register_header_migration',
     'get_migration_path',
     'migrate',
+    'migrate_in_place',
+    'migrate_stream',
 ]
@@ -177,9 +177,24 @@ result = crous.loads(crous.dumps(data))
 
 assert type(result) is frozenset  # ✓`} />
 
+      <h3>Dates, Decimals and UUIDs</h3>
+      <p>
+        <code>datetime</code>, <code>date</code>, <code>time</code>, <code>Decimal</code> and{' '}
+        <code>UUID</code> are encoded natively in C with tags 80–84, without a custom
+        serializer. Aware datetimes and times keep their UTC offset and come back with a
+        fixed-offset <code>timezone</code>. Only the exact types are native; subclasses go
+        through <code>register_serializer</code> or <code>default</code>, and a registered
+        serializer or decoder still takes precedence.
+      </p>
+      <CodeBlock code={`from datetime import datetime, timezone
+from decimal import Decimal
+
+data = [datetime(2024, 1, 2, 3, 4, 5, tzinfo=timezone.utc), Decimal('19.99')]
+assert crous.loads(crous.dumps(data)) == data  # ✓`} />
+
       <h3>Tagged Values</h3>
       <p>
-        Tagged values wrap any value with a numeric tag. Tags 90 and 91 are reserved for
+        Tagged values wrap any value with a numeric tag. Tags 80–84 carry the standard types above, 90 and 91 are reserved for
         set/frozenset. Tags 100+ are used by the custom serializer registry.
       </p>
 
@@ -193,14 +208,14 @@ assert type(result) is frozenset  # ✓`} />
           </tr>
         </thead>
         <tbody>
-          <tr><td>80</td><td><code>datetime</code></td><td>Named tag (parser only)</td></tr>
-          <tr><td>81</td><td><code>date</code></td><td>Named tag (parser only)</td></tr>
-          <tr><td>82</td><td><code>time</code></td><td>Named tag (parser only)</td></tr>
-          <tr><td>83</td><td><code>timedelta</code></td><td>Named tag (parser only)</td></tr>
-          <tr><td>84</td><td><code>decimal</code></td><td>Named tag (parser only)</td></tr>
+          <tr><td>80</td><td><code>datetime</code></td><td>Native: microseconds since the epoch, with the UTC offset when aware</td></tr>
+          <tr><td>81</td><td><code>date</code></td><td>Native: days since 1970-01-01</td></tr>
+          <tr><td>82</td><td><code>time</code></td><td>Native: microseconds since midnight, with the UTC offset when aware</td></tr>
+          <tr><td>83</td><td><code>Decimal</code></td><td>Native: packed sign, exponent and digits</td></tr>
+          <tr><td>84</td><td><code>UUID</code></td><td>Native: 16 bytes</td></tr>
           <tr><td>90</td><td><code>set</code></td><td>Built-in set encoding</td></tr>
           <tr><td>91</td><td><code>frozenset</code></td><td>Built-in frozenset encoding</td></tr>
-          <tr><td>92</td><td><code>complex</code></td><td>Named tag (parser only)</td></tr>
+          <tr><td>92</td><td><code>path</code></td><td>Named tag (parser only)</td></tr>
           <tr><td>100+</td><td>Custom</td><td>Auto-assigned by <code>register_serializer</code></td></tr>
         </tbody>
       </table>
@@ -9,9 +9,11 @@
         "crous_core/src/core/value.c",
         "crous_core/src/core/version.c",
         "crous_core/src/utils/token.c",
+        "crous_core/src/utils/parallel.c",
         "crous_core/src/lexer/lexer.c",
         "crous_core/src/parser/parser.c",
         "crous_core/src/binary/binary.c",
+        "crous_core/src/binary/session.c",
         "crous_core/src/flux/flux_lexer.c",
         "crous_core/src/flux/flux_parser.c",
         "crous_core/src/flux/flux_serializer.c"
@@ -10,5 +10,7 @@
 #include "crous_parser.h"
 #include "crous_value.h"
 #include "crous_binary.h"
+#include "crous_parallel.h"
+#include "crous_session.h"
 
 #endif /* CROUS_H */
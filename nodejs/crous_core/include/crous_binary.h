@@ -51,6 +51,16 @@ crous_err_t crous_decode(
     size_t buf_size,
     crous_value **out_value);
 
+/**
+ * Convenience: decode from buffer, borrowing string/bytes payloads from
+ * buf where the format allows it (FLUX). buf must outlive the tree.
+ * Legacy CROUS input is copied as usual.
+ */
+crous_err_t crous_decode_borrowed(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_value **out_value);
+
 /**
  * Convenience: encode to file
  */
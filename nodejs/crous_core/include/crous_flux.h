@@ -146,6 +146,17 @@ crous_err_t flux_encode_binary(
     uint8_t **out_buf,
     size_t *out_size);
 
+/**
+ * flux_encode_binary() into a buffer the caller keeps: *buf, of capacity
+ * *buf_cap (NULL and 0 to start), grows with realloc as needed and stays
+ * the caller's to pass again or free(). On error *buf remains valid.
+ */
+crous_err_t flux_encode_binary_reuse(
+    const crous_value *value,
+    uint8_t **buf,
+    size_t *buf_cap,
+    size_t *out_size);
+
 /**
  * Decode from FLUX binary format (buffer)
  */
@@ -154,6 +165,17 @@ crous_err_t flux_decode_binary(
     size_t buf_size,
     crous_value **out_value);
 
+/**
+ * Decode from FLUX binary format (buffer) without copying payloads.
+ * String/bytes data point into buf and are flagged
+ * CROUS_VALUE_FLAG_BORROWED, so buf must outlive the tree and stay
+ * unchanged. Dict keys are still copied.
+ */
+crous_err_t flux_decode_binary_borrowed(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_value **out_value);
+
 /* ============================================================================
    FLUX BINARY FORMAT MAGIC
    ============================================================================ */
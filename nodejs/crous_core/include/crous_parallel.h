@@ -0,0 +1,54 @@
+#ifndef CROUS_PARALLEL_H
+#define CROUS_PARALLEL_H
+
+#include "crous_types.h"
+
+/* ============================================================================
+   PARALLEL LOOPS
+   ============================================================================ */
+
+/**
+ * Fork-join loops behind the parallel encoders and decoders.
+ *
+ * crous_parallel_for() runs fn once for every index in [0, count) on up
+ * to nthreads threads, the calling thread among them, and returns once
+ * all calls have. Threads claim indices one at a time, so tasks of uneven
+ * cost balance out.
+ *
+ * Loops run on one process-wide pool of persistent workers, started on
+ * first use and shared by every subsystem and binding. Each worker keeps
+ * a work-stealing deque, so loops started from inside a task (nested
+ * parallelism) spread out as well. A thread waiting for its loop runs
+ * pool tasks meanwhile. Builds without thread support (CROUS_NO_THREADS,
+ * or no pthreads / Win32 threads) run loops on the calling thread.
+ */
+
+/* One task; index is in [0, count) */
+typedef void (*crous_task_fn)(void *ctx, size_t index);
+
+/**
+ * Run fn(ctx, i) for every i in [0, count). nthreads <= 0 means the pool
+ * size, which also caps larger values; 1 runs the loop on the calling
+ * thread. Workers that fail to start leave their share to the others; the
+ * loop always completes.
+ */
+void crous_parallel_for(size_t count, int nthreads, crous_task_fn fn, void *ctx);
+
+/**
+ * Set the pool size: the threads one loop may use, the caller included
+ * (<= 0 for crous_cpu_count()). Workers start as loops need them; when
+ * the pool shrinks, the extra ones park. Safe to call at any time.
+ */
+void crous_pool_set_threads(int nthreads);
+
+/**
+ * Pool size, crous_cpu_count() until set; 1 without thread support
+ */
+int crous_pool_threads(void);
+
+/**
+ * Online CPUs, at least 1
+ */
+int crous_cpu_count(void);
+
+#endif /* CROUS_PARALLEL_H */
@@ -0,0 +1,54 @@
+#ifndef CROUS_SESSION_H
+#define CROUS_SESSION_H
+
+#include "crous_types.h"
+
+/* ============================================================================
+   ENCODE/DECODE SESSIONS
+   ============================================================================ */
+
+/**
+ * Reusable state for encoding or decoding many documents in a row. A
+ * session keeps its output buffer between calls, growing it to fit the
+ * largest document seen, so steady-state encodes do not allocate. This
+ * core builds decoded trees on the heap; the session owns the tree of its
+ * last decode.
+ *
+ * Results belong to the session and last until the next call of the same
+ * kind. A session is not thread-safe; use one per thread.
+ */
+typedef struct crous_session crous_session;
+
+/**
+ * Create an empty session; buffers are allocated on first use
+ */
+crous_err_t crous_session_new(crous_session **out_session);
+
+/**
+ * Free a session, its buffer and the tree of its last decode
+ */
+void crous_session_free(crous_session *session);
+
+/**
+ * Encode value as crous_encode() would, into the session's buffer.
+ * *out_buf stays valid until the next crous_session_encode() or
+ * crous_session_free().
+ */
+crous_err_t crous_session_encode(
+    crous_session *session,
+    const crous_value *value,
+    const uint8_t **out_buf,
+    size_t *out_size);
+
+/**
+ * Decode as crous_decode() does, releasing the previous decode's tree
+ * first. *out_value lives until the next decode; never pass it to
+ * crous_value_free_tree().
+ */
+crous_err_t crous_session_decode(
+    crous_session *session,
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_value **out_value);
+
+#endif /* CROUS_SESSION_H */
@@ -117,9 +117,13 @@ typedef union {
 /* Main value structure */
 struct crous_value {
     crous_type_t type;
+    uint8_t flags;              /* CROUS_VALUE_FLAG_* */
     crous_value_data_t data;
 };
 
+/* Value flags */
+#define CROUS_VALUE_FLAG_BORROWED 0x02 /* String/bytes data points into a caller buffer */
+
 /* ============================================================================
    CONSTANTS
    ============================================================================ */
@@ -18,6 +18,14 @@ crous_value* crous_value_new_tuple(size_t capacity);
 crous_value* crous_value_new_dict(size_t capacity);
 crous_value* crous_value_new_tagged(uint32_t tag, crous_value *inner);
 
+/**
+ * String/bytes values whose payload points at data instead of a copy.
+ * The value is flagged CROUS_VALUE_FLAG_BORROWED and never frees data;
+ * the caller must keep data alive and unchanged for the value's lifetime.
+ */
+crous_value* crous_value_new_string_borrowed(const char *data, size_t len);
+crous_value* crous_value_new_bytes_borrowed(const uint8_t *data, size_t len);
+
 /* ============================================================================
    VALUE GETTERS
    ============================================================================ */
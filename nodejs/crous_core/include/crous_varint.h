@@ -0,0 +1,193 @@
+#ifndef CROUS_VARINT_H
+#define CROUS_VARINT_H
+
+#include "crous_types.h"
+#include <string.h>
+
+/* ============================================================================
+   VARINT CODEC
+   ============================================================================ */
+
+/**
+ * LEB128 varints and the zigzag mapping used for FLUX ints, lengths and
+ * counts. Header-only so the per-value encode/decode paths inline.
+ *
+ * Decoding takes an unchecked fast path whenever CROUS_VARINT_MAX bytes are
+ * readable: one-byte values are a single test, values of up to 8 bytes are
+ * gathered from one 64-bit load without a per-byte loop.
+ */
+
+/* Longest 64-bit varint */
+#define CROUS_VARINT_MAX 10
+
+static inline uint64_t crous_zigzag_encode(int64_t val) {
+    uint64_t u = (uint64_t)val;
+    return (u << 1) ^ (0 - (u >> 63));
+}
+
+static inline int64_t crous_zigzag_decode(uint64_t n) {
+    return (int64_t)((n >> 1) ^ (0 - (n & 1)));
+}
+
+/**
+ * Encoded size of val, 1 to CROUS_VARINT_MAX bytes
+ */
+static inline size_t crous_varint_size(uint64_t val) {
+#if defined(__GNUC__)
+    return (size_t)(70 - __builtin_clzll(val | 1)) / 7;
+#else
+    size_t n = 1;
+    while (val >= 0x80) {
+        val >>= 7;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/**
+ * Write val at p, which needs crous_varint_size(val) writable bytes.
+ * Returns the end of the written bytes.
+ */
+static inline uint8_t *crous_varint_put(uint8_t *p, uint64_t val) {
+    while (val >= 0x80) {
+        *p++ = (uint8_t)(val | 0x80);
+        val >>= 7;
+    }
+    *p++ = (uint8_t)val;
+    return p;
+}
+
+/* Byte-at-a-time decode of at most avail bytes */
+static inline crous_err_t crous_varint_get_checked(const uint8_t *p, size_t avail,
+                                                   uint64_t *out, size_t *used) {
+    uint64_t result = 0;
+    int shift = 0;
+
+    for (size_t i = 0; i < CROUS_VARINT_MAX; i++) {
+        if (i >= avail) return CROUS_ERR_TRUNCATED;
+        uint8_t byte = p[i];
+        result |= ((uint64_t)(byte & 0x7F)) << shift;
+        if ((byte & 0x80) == 0) {
+            *out = result;
+            *used = i + 1;
+            return CROUS_OK;
+        }
+        shift += 7;
+    }
+    return CROUS_ERR_DECODE;
+}
+
+/**
+ * Unchecked decode: p must have CROUS_VARINT_MAX readable bytes.
+ * Returns the bytes consumed, or 0 if no byte within the limit ends the varint.
+ */
+static inline size_t crous_varint_get_fast(const uint8_t *p, uint64_t *out) {
+    if (!(p[0] & 0x80)) {
+        *out = p[0];
+        return 1;
+    }
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word;
+    memcpy(&word, p, 8);
+    uint64_t stops = ~word & 0x8080808080808080ULL;
+    if (stops) {
+        /* Keep the n bytes of this varint, then pack their 7-bit groups */
+        unsigned n = ((unsigned)__builtin_ctzll(stops) >> 3) + 1;
+        word &= (~0ULL >> (64 - 8 * n)) & 0x7F7F7F7F7F7F7F7FULL;
+        word = (word & 0x007F007F007F007FULL) | ((word & 0x7F007F007F007F00ULL) >> 1);
+        word = (word & 0x00003FFF00003FFFULL) | ((word & 0x3FFF00003FFF0000ULL) >> 2);
+        word = (word & 0x000000000FFFFFFFULL) | ((word & 0x0FFFFFFF00000000ULL) >> 4);
+        *out = word;
+        return n;
+    }
+#endif
+    size_t used;
+    return crous_varint_get_checked(p, CROUS_VARINT_MAX, out, &used) == CROUS_OK ? used : 0;
+}
+
+/**
+ * Decode one varint from at most avail bytes; *used gets the bytes consumed.
+ * CROUS_ERR_TRUNCATED if the input ends first, CROUS_ERR_DECODE if it
+ * runs past CROUS_VARINT_MAX bytes.
+ */
+static inline crous_err_t crous_varint_get(const uint8_t *p, size_t avail,
+                                           uint64_t *out, size_t *used) {
+    if (avail >= CROUS_VARINT_MAX) {
+        size_t n = crous_varint_get_fast(p, out);
+        if (!n) return CROUS_ERR_DECODE;
+        *used = n;
+        return CROUS_OK;
+    }
+    return crous_varint_get_checked(p, avail, out, used);
+}
+
+/**
+ * Decode count consecutive varints (a run of table ints, for instance) into
+ * out. Eight one-byte values at a time are copied out of a single load.
+ */
+static inline crous_err_t crous_varint_get_run(const uint8_t *p, size_t avail,
+                                               uint64_t *out, size_t count, size_t *used) {
+    size_t pos = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        if (count - i >= 8 && avail - pos >= 8) {
+            uint64_t word;
+            memcpy(&word, p + pos, 8);
+            if (!(word & 0x8080808080808080ULL)) {
+                for (int k = 0; k < 8; k++) out[i + k] = p[pos + k];
+                i += 8;
+                pos += 8;
+                continue;
+            }
+        }
+        size_t n;
+        crous_err_t err = crous_varint_get(p + pos, avail - pos, &out[i], &n);
+        if (err != CROUS_OK) return err;
+        pos += n;
+        i++;
+    }
+    *used = pos;
+    return CROUS_OK;
+}
+
+/* Values decoded per batch by crous_varint_run_next() */
+#define CROUS_VARINT_RUN 64
+
+/**
+ * Reader for a known number of consecutive varints, decoded in batches
+ */
+typedef struct {
+    uint64_t vals[CROUS_VARINT_RUN];
+    size_t len;             /* Values in vals */
+    size_t at;              /* Next value to hand out */
+    size_t left;            /* Values not yet decoded from the input */
+} crous_varint_run_t;
+
+static inline void crous_varint_run_init(crous_varint_run_t *run, size_t count) {
+    run->len = run->at = 0;
+    run->left = count;
+}
+
+/**
+ * Next value of the run. When the batch is used up, the next one is decoded
+ * from p (avail bytes) and *used gets the bytes consumed; otherwise *used is 0.
+ * Must not be called more than the count given to crous_varint_run_init().
+ */
+static inline crous_err_t crous_varint_run_next(crous_varint_run_t *run, const uint8_t *p,
+                                                size_t avail, uint64_t *out, size_t *used) {
+    *used = 0;
+    if (run->at == run->len) {
+        size_t batch = run->left < CROUS_VARINT_RUN ? run->left : CROUS_VARINT_RUN;
+        crous_err_t err = crous_varint_get_run(p, avail, run->vals, batch, used);
+        if (err != CROUS_OK) return err;
+        run->len = batch;
+        run->at = 0;
+        run->left -= batch;
+    }
+    *out = run->vals[run->at++];
+    return CROUS_OK;
+}
+
+#endif /* CROUS_VARINT_H */
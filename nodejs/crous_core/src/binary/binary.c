@@ -648,6 +648,18 @@ crous_err_t crous_decode(
     return CROUS_ERR_INVALID_HEADER;
 }
 
+crous_err_t crous_decode_borrowed(
+    const uint8_t *buf,
+    size_t buf_size,
+    crous_value **out_value) {
+    
+    if (buf && out_value && buf_size >= 6 &&
+        buf[0] == 'F' && buf[1] == 'L' && buf[2] == 'U' && buf[3] == 'X') {
+        return flux_decode_binary_borrowed(buf, buf_size, out_value);
+    }
+    return crous_decode(buf, buf_size, out_value);
+}
+
 /* ============================================================================
    FILE API
    ============================================================================ */
@@ -0,0 +1,65 @@
+#include "../include/crous_session.h"
+#include "../include/crous_binary.h"
+#include "../include/crous_flux.h"
+#include "../include/crous_value.h"
+#include <stdlib.h>
+
+/* ============================================================================
+   SESSION STATE
+   ============================================================================ */
+
+struct crous_session {
+    uint8_t *buf;               /* Encode output, kept between calls */
+    size_t cap;
+    crous_value *tree;          /* Last decode */
+};
+
+crous_err_t crous_session_new(crous_session **out_session) {
+    if (!out_session) return CROUS_ERR_INVALID_TYPE;
+    crous_session *session = calloc(1, sizeof(*session));
+    if (!session) return CROUS_ERR_OOM;
+    *out_session = session;
+    return CROUS_OK;
+}
+
+void crous_session_free(crous_session *session) {
+    if (!session) return;
+    free(session->buf);
+    crous_value_free_tree(session->tree);
+    free(session);
+}
+
+/* ============================================================================
+   ENCODE
+   ============================================================================ */
+
+crous_err_t crous_session_encode(crous_session *session, const crous_value *value,
+                                 const uint8_t **out_buf, size_t *out_size) {
+    if (!session || !value || !out_buf || !out_size) return CROUS_ERR_INVALID_TYPE;
+    
+    crous_err_t err = flux_encode_binary_reuse(value, &session->buf, &session->cap, out_size);
+    if (err != CROUS_OK) return err;
+    *out_buf = session->buf;
+    return CROUS_OK;
+}
+
+/* ============================================================================
+   DECODE
+   ============================================================================ */
+
+crous_err_t crous_session_decode(crous_session *session, const uint8_t *buf, size_t buf_size,
+                                 crous_value **out_value) {
+    if (!session || !out_value) return CROUS_ERR_INVALID_TYPE;
+    
+    crous_value_free_tree(session->tree);
+    session->tree = NULL;
+    
+    crous_err_t err = crous_decode(buf, buf_size, &session->tree);
+    if (err != CROUS_OK) {
+        crous_value_free_tree(session->tree);
+        session->tree = NULL;
+        return err;
+    }
+    *out_value = session->tree;
+    return CROUS_OK;
+}
@@ -10,6 +10,7 @@ crous_value* crous_value_new_null(void) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_NULL;
+    v->flags = 0;
     return v;
 }
 
@@ -17,6 +18,7 @@ crous_value* crous_value_new_bool(int b) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_BOOL;
+    v->flags = 0;
     v->data.b = b ? 1 : 0;
     return v;
 }
@@ -25,6 +27,7 @@ crous_value* crous_value_new_int(int64_t v_val) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_INT;
+    v->flags = 0;
     v->data.i = v_val;
     return v;
 }
@@ -33,6 +36,7 @@ crous_value* crous_value_new_float(double d) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_FLOAT;
+    v->flags = 0;
     v->data.f = d;
     return v;
 }
@@ -41,6 +45,7 @@ crous_value* crous_value_new_string(const char *data, size_t len) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_STRING;
+    v->flags = 0;
     v->data.s.data = malloc(len);
     if (!v->data.s.data) {
         free(v);
@@ -55,6 +60,7 @@ crous_value* crous_value_new_bytes(const uint8_t *data, size_t len) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_BYTES;
+    v->flags = 0;
     v->data.bytes.data = malloc(len);
     if (!v->data.bytes.data) {
         free(v);
@@ -65,10 +71,31 @@ crous_value* crous_value_new_bytes(const uint8_t *data, size_t len) {
     return v;
 }
 
+crous_value* crous_value_new_string_borrowed(const char *data, size_t len) {
+    crous_value *v = malloc(sizeof(*v));
+    if (!v) return NULL;
+    v->type = CROUS_TYPE_STRING;
+    v->flags = CROUS_VALUE_FLAG_BORROWED;
+    v->data.s.data = (uint8_t *)data;
+    v->data.s.len = len;
+    return v;
+}
+
+crous_value* crous_value_new_bytes_borrowed(const uint8_t *data, size_t len) {
+    crous_value *v = malloc(sizeof(*v));
+    if (!v) return NULL;
+    v->type = CROUS_TYPE_BYTES;
+    v->flags = CROUS_VALUE_FLAG_BORROWED;
+    v->data.bytes.data = (uint8_t *)data;
+    v->data.bytes.len = len;
+    return v;
+}
+
 crous_value* crous_value_new_list(size_t capacity) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_LIST;
+    v->flags = 0;
     v->data.list.items = capacity > 0 ? malloc(capacity * sizeof(crous_value *)) : NULL;
     if (capacity > 0 && !v->data.list.items) {
         free(v);
@@ -83,6 +110,7 @@ crous_value* crous_value_new_tuple(size_t capacity) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_TUPLE;
+    v->flags = 0;
     v->data.list.items = capacity > 0 ? malloc(capacity * sizeof(crous_value *)) : NULL;
     if (capacity > 0 && !v->data.list.items) {
         free(v);
@@ -97,6 +125,7 @@ crous_value* crous_value_new_dict(size_t capacity) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_DICT;
+    v->flags = 0;
     v->data.dict.entries = capacity > 0 ? malloc(capacity * sizeof(crous_dict_entry)) : NULL;
     if (capacity > 0 && !v->data.dict.entries) {
         free(v);
@@ -111,6 +140,7 @@ crous_value* crous_value_new_tagged(uint32_t tag, crous_value *inner) {
     crous_value *v = malloc(sizeof(*v));
     if (!v) return NULL;
     v->type = CROUS_TYPE_TAGGED;
+    v->flags = 0;
     v->data.tagged.tag = tag;
     v->data.tagged.value = inner;
     return v;
@@ -291,10 +321,10 @@ void crous_value_free_tree(crous_value *v) {
     
     switch (v->type) {
         case CROUS_TYPE_STRING:
-            free(v->data.s.data);
+            if (!(v->flags & CROUS_VALUE_FLAG_BORROWED)) free(v->data.s.data);
             break;
         case CROUS_TYPE_BYTES:
-            free(v->data.bytes.data);
+            if (!(v->flags & CROUS_VALUE_FLAG_BORROWED)) free(v->data.bytes.data);
             break;
         case CROUS_TYPE_LIST:
         case CROUS_TYPE_TUPLE:
@@ -420,6 +420,33 @@ crous_err_t flux_serialize_binary(const crous_value *value, crous_output_stream
     return CROUS_OK;
 }
 
+crous_err_t flux_encode_binary_reuse(const crous_value *value, uint8_t **buf, size_t *buf_cap, size_t *out_size) {
+    if (!value || !buf || !buf_cap || !out_size) return CROUS_ERR_INVALID_TYPE;
+    
+    flux_binary_context_t ctx = {
+        .buf = *buf,
+        .pos = 0,
+        .cap = *buf ? *buf_cap : 0
+    };
+    if (!ctx.buf) {
+        ctx.buf = malloc(1024);
+        if (!ctx.buf) return CROUS_ERR_OOM;
+        ctx.cap = 1024;
+    }
+    
+    uint8_t header[6] = {
+        FLUX_MAGIC_0, FLUX_MAGIC_1, FLUX_MAGIC_2, FLUX_MAGIC_3,
+        FLUX_VERSION, 0x00
+    };
+    crous_err_t err = binary_write(&ctx, header, 6);
+    if (err == CROUS_OK) err = serialize_value_binary(&ctx, value);
+    
+    *buf = ctx.buf;
+    *buf_cap = ctx.cap;
+    if (err == CROUS_OK) *out_size = ctx.pos;
+    return err;
+}
+
 /* Helper for text encoding buffer output stream */
 typedef struct {
     char *data;
@@ -552,6 +579,7 @@ typedef struct {
     const uint8_t *buf;
     size_t pos;
     size_t len;
+    int borrow;                 /* point string/bytes values into buf */
 } flux_decode_buf_t;
 
 static crous_err_t binary_read(flux_decode_buf_t *ctx, uint8_t *out, size_t len) {
@@ -728,18 +756,13 @@ static crous_err_t deserialize_value_binary(flux_decode_buf_t *ctx, crous_value
             
             if (len > CROUS_MAX_STRING_BYTES) return CROUS_ERR_DECODE;
             
-            uint8_t *str_data = malloc(len);
-            if (!str_data) return CROUS_ERR_OOM;
-            
-            err = binary_read(ctx, str_data, len);
-            if (err != CROUS_OK) {
-                free(str_data);
-                return err;
-            }
+            if (len > ctx->len - ctx->pos) return CROUS_ERR_TRUNCATED;
             
-            v = crous_value_new_string((const char *)str_data, len);
-            free(str_data);
+            const char *str_data = (const char *)ctx->buf + ctx->pos;
+            v = ctx->borrow ? crous_value_new_string_borrowed(str_data, len)
+                            : crous_value_new_string(str_data, len);
             if (!v) return CROUS_ERR_OOM;
+            ctx->pos += len;
             break;
         }
         
@@ -750,18 +773,13 @@ static crous_err_t deserialize_value_binary(flux_decode_buf_t *ctx, crous_value
             
             if (len > CROUS_MAX_BYTES_SIZE) return CROUS_ERR_DECODE;
             
-            uint8_t *bytes_data = malloc(len);
-            if (!bytes_data) return CROUS_ERR_OOM;
-            
-            err = binary_read(ctx, bytes_data, len);
-            if (err != CROUS_OK) {
-                free(bytes_data);
-                return err;
-            }
+            if (len > ctx->len - ctx->pos) return CROUS_ERR_TRUNCATED;
             
-            v = crous_value_new_bytes(bytes_data, len);
-            free(bytes_data);
+            const uint8_t *bytes_data = ctx->buf + ctx->pos;
+            v = ctx->borrow ? crous_value_new_bytes_borrowed(bytes_data, len)
+                            : crous_value_new_bytes(bytes_data, len);
             if (!v) return CROUS_ERR_OOM;
+            ctx->pos += len;
             break;
         }
         
@@ -810,7 +828,8 @@ static crous_err_t deserialize_value_binary(flux_decode_buf_t *ctx, crous_value
     return CROUS_OK;
 }
 
-crous_err_t flux_decode_binary(const uint8_t *buf, size_t buf_size, crous_value **out_value) {
+static crous_err_t flux_decode_binary_mode(const uint8_t *buf, size_t buf_size,
+                                           int borrow, crous_value **out_value) {
     if (!buf || !out_value) return CROUS_ERR_INVALID_TYPE;
     
     if (buf_size < 6) return CROUS_ERR_TRUNCATED;
@@ -828,8 +847,17 @@ crous_err_t flux_decode_binary(const uint8_t *buf, size_t buf_size, crous_value
     flux_decode_buf_t ctx = {
         .buf = buf,
         .pos = 6,  /* Skip header */
-        .len = buf_size
+        .len = buf_size,
+        .borrow = borrow
     };
     
     return deserialize_value_binary(&ctx, out_value, 0);
 }
+
+crous_err_t flux_decode_binary(const uint8_t *buf, size_t buf_size, crous_value **out_value) {
+    return flux_decode_binary_mode(buf, buf_size, 0, out_value);
+}
+
+crous_err_t flux_decode_binary_borrowed(const uint8_t *buf, size_t buf_size, crous_value **out_value) {
+    return flux_decode_binary_mode(buf, buf_size, 1, out_value);
+}
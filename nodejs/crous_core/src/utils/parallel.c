@@ -0,0 +1,413 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "../include/crous_parallel.h"
+#include <stdlib.h>
+
+#if defined(CROUS_NO_THREADS)
+#elif defined(_WIN32)
+#  define CROUS_THREADS_WIN32 1
+#  include <windows.h>
+#elif defined(__GNUC__) && (defined(__unix__) || defined(__APPLE__))
+#  define CROUS_THREADS_PTHREAD 1
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
+
+#define PARALLEL_MAX_THREADS 256
+#define POOL_DEQUE_SIZE 64      /* Tasks a worker can have pushed at once; a power of two */
+
+/* ============================================================================
+   ATOMICS
+   ============================================================================ */
+
+typedef struct pool_task pool_task;
+
+#if defined(CROUS_THREADS_WIN32)
+typedef volatile LONG64 pool_index_t;
+
+static int64_t idx_load(pool_index_t *p) { return InterlockedCompareExchange64(p, 0, 0); }
+static void idx_store(pool_index_t *p, int64_t v) { InterlockedExchange64(p, v); }
+static int64_t idx_add(pool_index_t *p, int64_t v) { return InterlockedAdd64(p, v); }
+static int idx_cas(pool_index_t *p, int64_t expect, int64_t v) {
+    return InterlockedCompareExchange64(p, v, expect) == expect;
+}
+static pool_task *task_load(pool_task *volatile *p) {
+    return (pool_task *)InterlockedCompareExchangePointer((PVOID volatile *)p, NULL, NULL);
+}
+static void task_store(pool_task *volatile *p, pool_task *t) {
+    InterlockedExchangePointer((PVOID volatile *)p, t);
+}
+#  define POOL_FENCE() MemoryBarrier()
+#elif defined(CROUS_THREADS_PTHREAD)
+typedef int64_t pool_index_t;
+
+static int64_t idx_load(pool_index_t *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static void idx_store(pool_index_t *p, int64_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static int64_t idx_add(pool_index_t *p, int64_t v) { return __atomic_add_fetch(p, v, __ATOMIC_ACQ_REL); }
+static int idx_cas(pool_index_t *p, int64_t expect, int64_t v) {
+    return __atomic_compare_exchange_n(p, &expect, v, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+static pool_task *task_load(pool_task *volatile *p) { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+static void task_store(pool_task *volatile *p, pool_task *t) { __atomic_store_n(p, t, __ATOMIC_RELAXED); }
+#  define POOL_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+typedef int64_t pool_index_t;
+
+static int64_t idx_load(pool_index_t *p) { return *p; }
+static int64_t idx_add(pool_index_t *p, int64_t v) { return *p += v; }
+#endif
+
+/* ============================================================================
+   LOOP STATE
+   ============================================================================ */
+
+/* A unit of pool work; embedded first in whatever it runs */
+struct pool_task {
+    void (*run)(pool_task *task);
+    pool_task *next;            /* Injector queue link */
+};
+
+typedef struct parallel_loop parallel_loop_t;
+
+typedef struct {
+    pool_task task;
+    parallel_loop_t *loop;
+} loop_runner_t;
+
+struct parallel_loop {
+    crous_task_fn fn;
+    void *ctx;
+    size_t count;
+    pool_index_t next;          /* Next unclaimed index */
+    pool_index_t pending;       /* Runners handed to the pool and not finished */
+    loop_runner_t runners[PARALLEL_MAX_THREADS - 1];
+};
+
+/* Run claimed indices until the loop is used up. Indices are claimed one
+ * at a time, so tasks of uneven cost balance out across runners. */
+static void loop_run(parallel_loop_t *loop) {
+    for (;;) {
+        size_t i = (size_t)(idx_add(&loop->next, 1) - 1);
+        if (i >= loop->count) return;
+        loop->fn(loop->ctx, i);
+    }
+}
+
+/* ============================================================================
+   POOL
+   ============================================================================ */
+
+/*
+ * Workers live for the life of the process and serve every parallel loop,
+ * whoever starts it. Each owns a Chase-Lev deque: it pushes and pops at
+ * the bottom without locks, and idle threads steal from the top. Threads
+ * outside the pool hand work over through a locked injector queue. A
+ * thread waiting on a loop runs pool tasks until the loop is done, so a
+ * loop completes even when no worker picks it up.
+ */
+
+#if defined(CROUS_THREADS_WIN32) || defined(CROUS_THREADS_PTHREAD)
+
+typedef struct {
+    pool_index_t top;           /* Next to steal */
+    pool_index_t bottom;        /* Next free slot */
+    pool_task *volatile slots[POOL_DEQUE_SIZE];
+} pool_deque_t;
+
+#  if defined(CROUS_THREADS_WIN32)
+#    define POOL_TLS __declspec(thread)
+static SRWLOCK g_lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE g_wake = CONDITION_VARIABLE_INIT;
+#    define POOL_LOCK()   AcquireSRWLockExclusive(&g_lock)
+#    define POOL_UNLOCK() ReleaseSRWLockExclusive(&g_lock)
+#    define POOL_WAIT()   SleepConditionVariableSRW(&g_wake, &g_lock, INFINITE, 0)
+#    define POOL_WAKE()   WakeAllConditionVariable(&g_wake)
+#  else
+#    define POOL_TLS __thread
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_wake = PTHREAD_COND_INITIALIZER;
+#    define POOL_LOCK()   pthread_mutex_lock(&g_lock)
+#    define POOL_UNLOCK() pthread_mutex_unlock(&g_lock)
+#    define POOL_WAIT()   pthread_cond_wait(&g_wake, &g_lock)
+#    define POOL_WAKE()   pthread_cond_broadcast(&g_wake)
+#  endif
+
+static pool_deque_t *g_deques[PARALLEL_MAX_THREADS];
+static pool_index_t g_started;  /* Workers running; g_deques[0..g_started) are theirs */
+static pool_index_t g_target;   /* 0 until set: threads a loop may use, the caller included */
+static pool_index_t g_queued;   /* Tasks pushed and not yet taken */
+static pool_index_t g_injected; /* Of those, tasks in the injector */
+static pool_task *g_inject_head, *g_inject_tail;  /* Under g_lock */
+
+/* 1 + the worker index on pool threads, 0 elsewhere */
+static POOL_TLS int g_self;
+
+/* --- deque --- */
+
+static int deque_push(pool_deque_t *d, pool_task *t) {
+    int64_t b = idx_load(&d->bottom);
+    if (b - idx_load(&d->top) >= POOL_DEQUE_SIZE) return 0;
+    task_store(&d->slots[b & (POOL_DEQUE_SIZE - 1)], t);
+    idx_store(&d->bottom, b + 1);
+    return 1;
+}
+
+static pool_task *deque_pop(pool_deque_t *d) {
+    int64_t b = idx_load(&d->bottom) - 1;
+    idx_store(&d->bottom, b);
+    POOL_FENCE();
+    int64_t t = idx_load(&d->top);
+    if (t > b) {
+        idx_store(&d->bottom, b + 1);
+        return NULL;
+    }
+    pool_task *task = task_load(&d->slots[b & (POOL_DEQUE_SIZE - 1)]);
+    if (t == b) {
+        /* Last task: race the thieves for it */
+        if (!idx_cas(&d->top, t, t + 1)) task = NULL;
+        idx_store(&d->bottom, b + 1);
+    }
+    return task;
+}
+
+static pool_task *deque_steal(pool_deque_t *d) {
+    int64_t t = idx_load(&d->top);
+    POOL_FENCE();
+    int64_t b = idx_load(&d->bottom);
+    if (t >= b) return NULL;
+    pool_task *task = task_load(&d->slots[t & (POOL_DEQUE_SIZE - 1)]);
+    return idx_cas(&d->top, t, t + 1) ? task : NULL;
+}
+
+/* --- scheduling --- */
+
+static void pool_push(pool_task *t) {
+    idx_add(&g_queued, 1);
+    if (!g_self || !deque_push(g_deques[g_self - 1], t)) {
+        POOL_LOCK();
+        t->next = NULL;
+        if (g_inject_tail) g_inject_tail->next = t;
+        else g_inject_head = t;
+        g_inject_tail = t;
+        idx_add(&g_injected, 1);
+        POOL_UNLOCK();
+    }
+    POOL_LOCK();
+    POOL_WAKE();
+    POOL_UNLOCK();
+}
+
+/* A task for self (a worker index, or -1 outside the pool): its own newest
+ * first, then the oldest of another worker's, then the injector's */
+static pool_task *pool_take(int self) {
+    pool_task *t = NULL;
+    if (idx_load(&g_queued) == 0) return NULL;
+    if (self >= 0) t = deque_pop(g_deques[self]);
+
+    int started = (int)idx_load(&g_started);
+    for (int i = 1; !t && i <= started; i++) {
+        int victim = (self + i) % started;
+        if (victim != self) t = deque_steal(g_deques[victim]);
+    }
+    if (!t && idx_load(&g_injected) != 0) {
+        POOL_LOCK();
+        t = g_inject_head;
+        if (t) {
+            g_inject_head = t->next;
+            if (!g_inject_head) g_inject_tail = NULL;
+            idx_add(&g_injected, -1);
+        }
+        POOL_UNLOCK();
+    }
+    if (t) idx_add(&g_queued, -1);
+    return t;
+}
+
+static void worker_main(int self) {
+    g_self = self + 1;
+    for (;;) {
+        pool_task *t = self < idx_load(&g_target) - 1 ? pool_take(self) : NULL;
+        if (t) {
+            t->run(t);
+            continue;
+        }
+        /* Workers past the pool size park here until it grows again */
+        POOL_LOCK();
+        while (idx_load(&g_queued) == 0 || self >= idx_load(&g_target) - 1) POOL_WAIT();
+        POOL_UNLOCK();
+    }
+}
+
+#  if defined(CROUS_THREADS_WIN32)
+static DWORD WINAPI worker_thread(LPVOID arg) {
+    worker_main((int)(intptr_t)arg);
+    return 0;
+}
+#  else
+static void *worker_thread(void *arg) {
+    worker_main((int)(intptr_t)arg);
+    return NULL;
+}
+
+/* A forked child has none of the parent's workers; start over */
+static void pool_after_fork(void) {
+    pthread_mutex_init(&g_lock, NULL);
+    pthread_cond_init(&g_wake, NULL);
+    for (int i = 0; i < (int)g_started; i++) {
+        g_deques[i]->top = 0;
+        g_deques[i]->bottom = 0;
+    }
+    g_started = 0;
+    g_queued = 0;
+    g_injected = 0;
+    g_inject_head = g_inject_tail = NULL;
+    g_self = 0;
+}
+
+static pthread_once_t g_atfork_once = PTHREAD_ONCE_INIT;
+
+static void pool_register_atfork(void) {
+    pthread_atfork(NULL, NULL, pool_after_fork);
+}
+#  endif
+
+/* Start workers up to the pool size, fewer if threads can't be had */
+static void pool_start_workers(void) {
+    int want = (int)idx_load(&g_target) - 1;
+    if ((int)idx_load(&g_started) >= want) return;
+
+#  if defined(CROUS_THREADS_PTHREAD)
+    pthread_once(&g_atfork_once, pool_register_atfork);
+#  endif
+    POOL_LOCK();
+    for (int i = (int)idx_load(&g_started); i < want; i++) {
+        if (!g_deques[i]) {
+            g_deques[i] = calloc(1, sizeof(pool_deque_t));
+            if (!g_deques[i]) break;
+        }
+#  if defined(CROUS_THREADS_WIN32)
+        HANDLE thread = CreateThread(NULL, 0, worker_thread, (LPVOID)(intptr_t)i, 0, NULL);
+        if (!thread) break;
+        CloseHandle(thread);
+#  else
+        pthread_t thread;
+        pthread_attr_t attr;
+        if (pthread_attr_init(&attr) != 0) break;
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        int rc = pthread_create(&thread, &attr, worker_thread, (void *)(intptr_t)i);
+        pthread_attr_destroy(&attr);
+        if (rc != 0) break;
+#  endif
+        idx_store(&g_started, i + 1);
+    }
+    POOL_UNLOCK();
+}
+
+static void runner_task(pool_task *task) {
+    parallel_loop_t *loop = ((loop_runner_t *)task)->loop;
+    loop_run(loop);
+    /* The loop may be gone once pending drops to 0 */
+    if (idx_add(&loop->pending, -1) == 0) {
+        POOL_LOCK();
+        POOL_WAKE();
+        POOL_UNLOCK();
+    }
+}
+
+/* Hand runners - 1 runners to the pool, work on the loop, and help out
+ * with pool tasks until every runner is done */
+static void pool_run_loop(parallel_loop_t *loop, int runners) {
+    pool_start_workers();
+    idx_store(&loop->pending, runners - 1);
+    for (int i = 0; i < runners - 1; i++) {
+        loop->runners[i].task.run = runner_task;
+        loop->runners[i].loop = loop;
+        pool_push(&loop->runners[i].task);
+    }
+
+    loop_run(loop);
+
+    int self = g_self - 1;
+    while (idx_load(&loop->pending) != 0) {
+        pool_task *t = pool_take(self);
+        if (t) {
+            t->run(t);
+            continue;
+        }
+        POOL_LOCK();
+        if (idx_load(&loop->pending) != 0 && idx_load(&g_queued) == 0) POOL_WAIT();
+        POOL_UNLOCK();
+    }
+}
+
+#endif
+
+/* ============================================================================
+   PUBLIC API
+   ============================================================================ */
+
+int crous_cpu_count(void) {
+#if defined(CROUS_THREADS_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#elif defined(CROUS_THREADS_PTHREAD)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (n > PARALLEL_MAX_THREADS ? PARALLEL_MAX_THREADS : (int)n) : 1;
+#else
+    return 1;
+#endif
+}
+
+void crous_pool_set_threads(int nthreads) {
+#if defined(CROUS_THREADS_WIN32) || defined(CROUS_THREADS_PTHREAD)
+    if (nthreads <= 0) nthreads = crous_cpu_count();
+    if (nthreads > PARALLEL_MAX_THREADS) nthreads = PARALLEL_MAX_THREADS;
+    idx_store(&g_target, nthreads);
+    /* Parked workers recheck the size */
+    POOL_LOCK();
+    POOL_WAKE();
+    POOL_UNLOCK();
+#else
+    (void)nthreads;
+#endif
+}
+
+int crous_pool_threads(void) {
+#if defined(CROUS_THREADS_WIN32) || defined(CROUS_THREADS_PTHREAD)
+    int64_t n = idx_load(&g_target);
+    if (n == 0) {
+        /* First use; a racing crous_pool_set_threads() wins */
+        idx_cas(&g_target, 0, crous_cpu_count());
+        n = idx_load(&g_target);
+    }
+    return (int)n;
+#else
+    return 1;
+#endif
+}
+
+void crous_parallel_for(size_t count, int nthreads, crous_task_fn fn, void *ctx) {
+    if (!fn || count == 0) return;
+
+    int pool = crous_pool_threads();
+    if (nthreads <= 0 || nthreads > pool) nthreads = pool;
+    if ((size_t)nthreads > count) nthreads = (int)count;
+
+    parallel_loop_t loop;
+    loop.fn = fn;
+    loop.ctx = ctx;
+    loop.count = count;
+    loop.next = 0;
+    loop.pending = 0;
+
+#if defined(CROUS_THREADS_WIN32) || defined(CROUS_THREADS_PTHREAD)
+    if (nthreads > 1) {
+        pool_run_loop(&loop, nthreads);
+        return;
+    }
+#endif
+    loop_run(&loop);
+}
@@ -72,6 +72,12 @@ export interface LoadsOptions {
      * Optional function to post-process dictionary objects during deserialization
      */
     objectHook?: ObjectHook;
+    
+    /**
+     * Return Buffer values as views of the input instead of copies. The
+     * views share memory with the input, so changes to one show in the other
+     */
+    zeroCopy?: boolean;
 }
 
 /**
@@ -86,6 +92,16 @@ export interface DumpOptions extends DumpsOptions {
 export interface LoadOptions extends LoadsOptions {
 }
 
+/**
+ * Options for loadsAsync() function
+ */
+export interface LoadsAsyncOptions extends LoadsOptions {
+    /**
+     * Top-level array or object entries built per event-loop turn (default 1024)
+     */
+    sliceSize?: number;
+}
+
 /**
  * Encoder class for custom serialization control
  */
@@ -177,6 +193,31 @@ export function dumps(obj: any, options?: DumpsOptions): Buffer;
  */
 export function loads(data: Buffer, options?: LoadsOptions): any;
 
+/**
+ * Serialize a JavaScript value without blocking the event loop
+ * 
+ * The value is converted on the calling thread; encoding runs on the
+ * libuv threadpool.
+ * 
+ * @param obj - The object to serialize
+ * @param options - Serialization options
+ * @returns Promise of the binary encoded data; rejects with CrousEncodeError
+ */
+export function dumpsAsync(obj: any, options?: DumpsOptions): Promise<Buffer>;
+
+/**
+ * Deserialize binary data without blocking the event loop
+ * 
+ * Decoding runs on the libuv threadpool; a large top-level array or object
+ * is then built in slices, yielding between them. Do not modify the buffer
+ * until the promise settles.
+ * 
+ * @param data - Binary data to deserialize
+ * @param options - Deserialization options
+ * @returns Promise of the deserialized value; rejects with CrousDecodeError
+ */
+export function loadsAsync(data: Buffer, options?: LoadsAsyncOptions): Promise<any>;
+
 /**
  * Serialize a JavaScript value and write to a file
  * 
@@ -310,6 +351,24 @@ export function registerDecoder<T = any>(
  */
 export function unregisterDecoder(tag: number): void;
 
+/**
+ * Set the size of the worker pool that parallel encoding, decoding,
+ * compression and checksums share. The pool belongs to the process, so
+ * worker_threads see the same size.
+ * 
+ * @param n - Threads one operation may use, the calling thread included;
+ *     0 or less for one per CPU
+ * @throws {TypeError} If n is not an integer
+ */
+export function setThreads(n: number): void;
+
+/**
+ * Get the size of the worker pool
+ * 
+ * @returns Pool size, one per CPU until setThreads() is called
+ */
+export function getThreads(): number;
+
 /**
  * Get version information about the Crous library
  * 
@@ -341,10 +400,14 @@ declare const crous: {
     loads: typeof loads;
     dump: typeof dump;
     load: typeof load;
+    dumpsAsync: typeof dumpsAsync;
+    loadsAsync: typeof loadsAsync;
     registerSerializer: typeof registerSerializer;
     unregisterSerializer: typeof unregisterSerializer;
     registerDecoder: typeof registerDecoder;
     unregisterDecoder: typeof unregisterDecoder;
+    setThreads: typeof setThreads;
+    getThreads: typeof getThreads;
     versionInfo: typeof versionInfo;
     CrousEncoder: typeof CrousEncoder;
     CrousDecoder: typeof CrousDecoder;
@@ -71,10 +71,12 @@ class CrousEncoder {
     constructor(options = {}) {
         this.default = options.default || null;
         this.allowCustom = options.allowCustom !== false;
+        // Output buffer kept across encode() calls
+        this._session = native.createSession();
     }
     
     encode(obj) {
-        return native.dumps(obj, this.default);
+        return native.sessionEncode(this._session, obj, this.default);
     }
 }
 
@@ -84,10 +86,15 @@ class CrousEncoder {
 class CrousDecoder {
     constructor(options = {}) {
         this.objectHook = options.objectHook || null;
+        // Decode state kept across decode() calls
+        this._session = native.createSession();
     }
     
     decode(data) {
-        return native.loads(data, this.objectHook);
+        if (!Buffer.isBuffer(data)) {
+            data = Buffer.from(data);
+        }
+        return native.sessionDecode(this._session, data, this.objectHook);
     }
 }
 
@@ -115,6 +122,7 @@ function dumps(obj, options = {}) {
  * @param {Buffer} data - Binary data to deserialize
  * @param {Object} options - Deserialization options
  * @param {Function} options.objectHook - Optional function for post-processing objects
+ * @param {boolean} options.zeroCopy - Return Buffer values as views of data instead of copies
  * @returns {*} Deserialized JavaScript value
  * @throws {CrousDecodeError} If decoding fails
  */
@@ -123,7 +131,54 @@ function loads(data, options = {}) {
         if (!Buffer.isBuffer(data)) {
             data = Buffer.from(data);
         }
-        return native.loads(data, options.objectHook || null);
+        return native.loads(data, options.objectHook || null, options.zeroCopy === true);
+    } catch (error) {
+        throw new CrousDecodeError(error.message);
+    }
+}
+
+/**
+ * Serialize a JavaScript value without blocking the event loop
+ * 
+ * The value is converted on the calling thread; encoding runs on the
+ * libuv threadpool.
+ * 
+ * @param {*} obj - The object to serialize
+ * @param {Object} options - Serialization options
+ * @param {Function} options.default - Optional function for custom types
+ * @returns {Promise<Buffer>} Binary encoded data
+ * @throws {CrousEncodeError} If encoding fails (as a rejection)
+ */
+async function dumpsAsync(obj, options = {}) {
+    try {
+        return await native.dumpsAsync(obj, options.default || null);
+    } catch (error) {
+        throw new CrousEncodeError(error.message);
+    }
+}
+
+/**
+ * Deserialize binary data without blocking the event loop
+ * 
+ * Decoding runs on the libuv threadpool. A large top-level array or object
+ * is then built on the main thread in slices, yielding between them. Do
+ * not modify the buffer until the promise settles.
+ * 
+ * @param {Buffer} data - Binary data to deserialize
+ * @param {Object} options - Deserialization options
+ * @param {Function} options.objectHook - Optional function for post-processing objects
+ * @param {number} options.sliceSize - Top-level entries built per slice (default 1024)
+ * @param {boolean} options.zeroCopy - Return Buffer values as views of data instead of copies
+ * @returns {Promise<*>} Deserialized JavaScript value
+ * @throws {CrousDecodeError} If decoding fails (as a rejection)
+ */
+async function loadsAsync(data, options = {}) {
+    try {
+        if (!Buffer.isBuffer(data)) {
+            data = Buffer.from(data);
+        }
+        return await native.loadsAsync(data, options.objectHook || null, options.sliceSize || 0,
+                                      options.zeroCopy === true);
     } catch (error) {
         throw new CrousDecodeError(error.message);
     }
@@ -185,7 +240,7 @@ function load(filepath, options = {}) {
             throw new Error('filepath must be a string or readable stream');
         }
         
-        return native.loads(binary, options.objectHook || null);
+        return native.loads(binary, options.objectHook || null, options.zeroCopy === true);
     } catch (error) {
         if (error instanceof CrousDecodeError) {
             throw error;
@@ -240,6 +295,30 @@ function unregisterDecoder(tag) {
     native.unregisterDecoder(tag);
 }
 
+/**
+ * Set the size of the worker pool that parallel encoding, decoding,
+ * compression and checksums share. The pool belongs to the process, so
+ * worker_threads see the same size.
+ * 
+ * @param {number} n - Threads one operation may use, the calling thread
+ *     included; 0 or less for one per CPU
+ */
+function setThreads(n) {
+    if (typeof n !== 'number' || !Number.isInteger(n)) {
+        throw new TypeError('Thread count must be an integer');
+    }
+    native.setThreads(n);
+}
+
+/**
+ * Get the size of the worker pool
+ * 
+ * @returns {number} Pool size, one per CPU until setThreads() is called
+ */
+function getThreads() {
+    return native.getThreads();
+}
+
 /**
  * Get version information about the Crous library
  * 
@@ -264,12 +343,20 @@ module.exports = {
     dump,
     load,
     
+    // Async variants
+    dumpsAsync,
+    loadsAsync,
+    
     // Custom serializers/decoders
     registerSerializer,
     unregisterSerializer,
     registerDecoder,
     unregisterDecoder,
     
+    // Thread pool
+    setThreads,
+    getThreads,
+    
     // Classes
     CrousEncoder,
     CrousDecoder,
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "crous.h"
+#include "crous_stdtypes.h"
 
 /* ============================================================================
    ERROR HANDLING
@@ -133,6 +134,40 @@ static crous_value* try_custom_serializer(napi_env env, napi_value obj, napi_val
     return tagged;
 }
 
+/* A Date is an instant, so it travels as an aware UTC datetime */
+static crous_value* date_to_crous(napi_env env, napi_value value, crous_err_t *err) {
+    double ms;
+    if (napi_get_date_value(env, value, &ms) != napi_ok || ms != ms) {
+        *err = CROUS_ERR_ENCODE;
+        return NULL;
+    }
+    
+    crous_value *pair = crous_value_new_list(2);
+    crous_value *us = crous_value_new_int((int64_t)ms * 1000);
+    crous_value *offset = crous_value_new_int(0);
+    if (!pair || !us || !offset ||
+        crous_value_list_append(pair, us) != CROUS_OK) {
+        crous_value_free_tree(pair);
+        crous_value_free_tree(us);
+        crous_value_free_tree(offset);
+        *err = CROUS_ERR_OOM;
+        return NULL;
+    }
+    if (crous_value_list_append(pair, offset) != CROUS_OK) {
+        crous_value_free_tree(pair);
+        crous_value_free_tree(offset);
+        *err = CROUS_ERR_OOM;
+        return NULL;
+    }
+    
+    crous_value *tagged = crous_value_new_tagged(CROUS_TAG_DATETIME, pair);
+    if (!tagged) {
+        crous_value_free_tree(pair);
+        *err = CROUS_ERR_OOM;
+    }
+    return tagged;
+}
+
 static crous_value* napi_to_crous(napi_env env, napi_value value, napi_value default_func, crous_err_t *err) {
     *err = CROUS_OK;
     napi_status status;
@@ -260,6 +295,16 @@ static crous_value* napi_to_crous(napi_env env, napi_value value, napi_value def
                 return list;
             }
             
+            // Dates are encoded natively unless a serializer is registered
+            bool is_date = false;
+            napi_is_date(env, value, &is_date);
+            if (is_date) {
+                int handled = 0;
+                crous_value *result = try_custom_serializer(env, value, NULL, err, &handled);
+                if (handled) return result;
+                return date_to_crous(env, value, err);
+            }
+            
             // Check if it's a Set
             napi_value set_constructor;
             napi_value global;
@@ -395,7 +440,162 @@ static crous_value* napi_to_crous(napi_env env, napi_value value, napi_value def
    CONVERSION: CROUS VALUE -> NODE.JS VALUE
    ============================================================================ */
 
-static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value object_hook) {
+/* Pass a decoded object through object_hook, if it is a function */
+static napi_value apply_object_hook(napi_env env, napi_value obj, napi_value object_hook) {
+    if (object_hook == NULL) return obj;
+    
+    napi_valuetype hook_type;
+    napi_typeof(env, object_hook, &hook_type);
+    if (hook_type != napi_function) return obj;
+    
+    napi_value global;
+    napi_get_global(env, &global);
+    napi_value hooked_result;
+    if (napi_call_function(env, global, object_hook, 1, &obj, &hooked_result) == napi_ok) {
+        return hooked_result;
+    }
+    return obj;
+}
+
+/* Input of a zero-copy loads(): Bytes values that lie inside it become
+ * Buffer views of it instead of copies */
+typedef struct {
+    napi_value buffer;
+    napi_value subarray;        /* Buffer.prototype.subarray of buffer */
+    const uint8_t *base;
+    size_t length;
+} borrow_source;
+
+static napi_status borrow_source_init(napi_env env, napi_value buffer, borrow_source *src) {
+    void *data;
+    src->buffer = buffer;
+    napi_status status = napi_get_buffer_info(env, buffer, &data, &src->length);
+    if (status != napi_ok) return status;
+    src->base = (const uint8_t *)data;
+    return napi_get_named_property(env, buffer, "subarray", &src->subarray);
+}
+
+/* A view of [data, data + len) if it lies in src's buffer, else NULL */
+static napi_value borrow_view(napi_env env, const borrow_source *src, const uint8_t *data, size_t len) {
+    if (!src || !data || data < src->base || len > src->length ||
+        (size_t)(data - src->base) > src->length - len) {
+        return NULL;
+    }
+    
+    napi_value range[2], view;
+    size_t start = (size_t)(data - src->base);
+    napi_create_double(env, (double)start, &range[0]);
+    napi_create_double(env, (double)(start + len), &range[1]);
+    if (napi_call_function(env, src->buffer, src->subarray, 2, range, &view) != napi_ok) {
+        return NULL;
+    }
+    return view;
+}
+
+/* Python's to-sci-string form of a packed decimal; NULL on malformed input */
+static char* format_decimal(const uint8_t *data, size_t len, size_t *out_len) {
+    int negative, special;
+    int64_t exponent;
+    const uint8_t *digits;
+    size_t n;
+    if (crous_decimal_unpack(data, len, &negative, &special, &exponent, &digits, &n) != CROUS_OK) {
+        return NULL;
+    }
+    if (special == CROUS_DECIMAL_FINITE && (n == 0 || exponent < -(INT64_C(1) << 40) ||
+                                            exponent > (INT64_C(1) << 40))) {
+        return NULL;
+    }
+    
+    /* Digits, sign, "sNaN", point, leading zeros up to 6, "E+" and exponent */
+    char *buf = malloc(n + 40);
+    if (!buf) return NULL;
+    char *p = buf;
+    if (negative) *p++ = '-';
+    
+    if (special == CROUS_DECIMAL_INF) {
+        memcpy(p, "Infinity", 8);
+        p += 8;
+    } else if (special != CROUS_DECIMAL_FINITE) {
+        if (special == CROUS_DECIMAL_SNAN) *p++ = 's';
+        memcpy(p, "NaN", 3);
+        p += 3;
+        for (size_t i = 0; i < n; i++) *p++ = (char)('0' + crous_decimal_digit(digits, i));
+    } else {
+        int64_t adjusted = exponent + (int64_t)n - 1;
+        if (exponent <= 0 && adjusted >= -6) {
+            /* Plain notation; point sits n + exponent digits in */
+            int64_t point = (int64_t)n + exponent;
+            if (point <= 0) {
+                *p++ = '0';
+                *p++ = '.';
+                for (int64_t i = point; i < 0; i++) *p++ = '0';
+            }
+            for (size_t i = 0; i < n; i++) {
+                if (exponent < 0 && point > 0 && (int64_t)i == point) *p++ = '.';
+                *p++ = (char)('0' + crous_decimal_digit(digits, i));
+            }
+        } else {
+            *p++ = (char)('0' + crous_decimal_digit(digits, 0));
+            if (n > 1) *p++ = '.';
+            for (size_t i = 1; i < n; i++) *p++ = (char)('0' + crous_decimal_digit(digits, i));
+            p += sprintf(p, "E%s%lld", adjusted >= 0 ? "+" : "", (long long)adjusted);
+        }
+    }
+    
+    *out_len = (size_t)(p - buf);
+    return buf;
+}
+
+/*
+ * Decode a built-in standard-type tag. Datetimes and dates become Date
+ * objects (naive datetimes are read as UTC), decimals and UUIDs their
+ * canonical strings. Returns NULL when the inner value has another shape,
+ * so the caller falls back to the inner value.
+ */
+static napi_value stdtype_to_napi(napi_env env, uint32_t tag, const crous_value *inner) {
+    napi_value result;
+    crous_type_t type = crous_value_get_type(inner);
+    
+    if (tag == CROUS_TAG_DATETIME || tag == CROUS_TAG_DATE) {
+        const crous_value *us = inner;
+        if (tag == CROUS_TAG_DATETIME && (type == CROUS_TYPE_LIST || type == CROUS_TYPE_TUPLE) &&
+            crous_value_list_size(inner) == 2) {
+            us = crous_value_list_get(inner, 0);
+        }
+        if (!us || crous_value_get_type(us) != CROUS_TYPE_INT) return NULL;
+        int64_t n = crous_value_get_int(us);
+        double ms;
+        if (tag == CROUS_TAG_DATE) {
+            if (n < CROUS_DAYS_MIN || n > CROUS_DAYS_MAX) return NULL;
+            ms = (double)(n * 86400000LL);
+        } else {
+            ms = (double)(n / 1000 - (n % 1000 < 0));
+        }
+        return napi_create_date(env, ms, &result) == napi_ok ? result : NULL;
+    }
+    
+    if ((tag == CROUS_TAG_DECIMAL || tag == CROUS_TAG_UUID) && type == CROUS_TYPE_BYTES) {
+        size_t len;
+        const uint8_t *data = crous_value_get_bytes(inner, &len);
+        if (tag == CROUS_TAG_UUID) {
+            if (len != 16) return NULL;
+            char text[37];
+            crous_uuid_format(data, text);
+            return napi_create_string_utf8(env, text, 36, &result) == napi_ok ? result : NULL;
+        }
+        size_t text_len;
+        char *text = format_decimal(data, len, &text_len);
+        if (!text) return NULL;
+        napi_status status = napi_create_string_utf8(env, text, text_len, &result);
+        free(text);
+        return status == napi_ok ? result : NULL;
+    }
+    
+    return NULL;
+}
+
+static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value object_hook,
+                                const borrow_source *src) {
     if (!v) {
         napi_value result;
         napi_get_null(env, &result);
@@ -432,6 +632,9 @@ static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value o
         case CROUS_TYPE_BYTES: {
             size_t len;
             const uint8_t *data = crous_value_get_bytes(v, &len);
+            result = borrow_view(env, src, data, len);
+            if (result) return result;
+            
             void *buffer_data;
             status = napi_create_buffer_copy(env, len, data, &buffer_data, &result);
             if (status != napi_ok) {
@@ -445,7 +648,7 @@ static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value o
             napi_create_array_with_length(env, size, &result);
             
             for (size_t i = 0; i < size; i++) {
-                napi_value element = crous_to_napi(env, crous_value_list_get(v, i), object_hook);
+                napi_value element = crous_to_napi(env, crous_value_list_get(v, i), object_hook, src);
                 napi_set_element(env, result, (uint32_t)i, element);
             }
             
@@ -458,7 +661,7 @@ static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value o
             napi_create_array_with_length(env, size, &result);
             
             for (size_t i = 0; i < size; i++) {
-                napi_value element = crous_to_napi(env, crous_value_list_get(v, i), object_hook);
+                napi_value element = crous_to_napi(env, crous_value_list_get(v, i), object_hook, src);
                 napi_set_element(env, result, (uint32_t)i, element);
             }
             
@@ -476,26 +679,11 @@ static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value o
                 napi_value key;
                 napi_create_string_utf8(env, entry->key, entry->key_len, &key);
                 
-                napi_value val = crous_to_napi(env, entry->value, object_hook);
+                napi_value val = crous_to_napi(env, entry->value, object_hook, src);
                 napi_set_property(env, result, key, val);
             }
             
-            // Apply object_hook if provided
-            if (object_hook != NULL) {
-                napi_valuetype hook_type;
-                napi_typeof(env, object_hook, &hook_type);
-                if (hook_type == napi_function) {
-                    napi_value global;
-                    napi_get_global(env, &global);
-                    napi_value hooked_result;
-                    status = napi_call_function(env, global, object_hook, 1, &result, &hooked_result);
-                    if (status == napi_ok) {
-                        return hooked_result;
-                    }
-                }
-            }
-            
-            return result;
+            return apply_object_hook(env, result, object_hook);
         }
         
         case CROUS_TYPE_TAGGED: {
@@ -505,7 +693,7 @@ static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value o
             // Check for built-in tags
             if (tag == 90) {
                 // Set
-                napi_value array = crous_to_napi(env, inner, object_hook);
+                napi_value array = crous_to_napi(env, inner, object_hook, src);
                 napi_value global;
                 napi_get_global(env, &global);
                 napi_value set_constructor;
@@ -528,7 +716,7 @@ static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value o
                         napi_value decoder;
                         status = napi_get_property(env, decoders, tag_key, &decoder);
                         if (status == napi_ok) {
-                            napi_value inner_js = crous_to_napi(env, inner, object_hook);
+                            napi_value inner_js = crous_to_napi(env, inner, object_hook, src);
                             napi_value global;
                             napi_get_global(env, &global);
                             status = napi_call_function(env, global, decoder, 1, &inner_js, &result);
@@ -540,8 +728,10 @@ static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value o
                 }
             }
             
-            // No decoder found, return inner value
-            return crous_to_napi(env, inner, object_hook);
+            // Standard types, else the inner value
+            result = inner ? stdtype_to_napi(env, tag, inner) : NULL;
+            if (result) return result;
+            return crous_to_napi(env, inner, object_hook, src);
         }
         
         default:
@@ -554,6 +744,25 @@ static napi_value crous_to_napi(napi_env env, const crous_value *v, napi_value o
    EXPORTED FUNCTIONS
    ============================================================================ */
 
+static void free_encoded(napi_env env, void *data, void *hint) {
+    (void)env;
+    (void)hint;
+    free(data);
+}
+
+/* Hand an encoded buffer to JS without copying it; the Buffer frees it.
+ * Runtimes that forbid external buffers (V8 sandbox) get a copy. Takes
+ * ownership of buf either way. */
+static napi_status create_encoded_buffer(napi_env env, uint8_t *buf, size_t size, napi_value *result) {
+    napi_status status = napi_create_external_buffer(env, size, buf, free_encoded, NULL, result);
+    if (status == napi_ok) return status;
+    
+    void *result_data;
+    status = napi_create_buffer_copy(env, size, buf, &result_data, result);
+    free(buf);
+    return status;
+}
+
 static napi_value dumps(napi_env env, napi_callback_info info) {
     size_t argc = 2;
     napi_value args[2];
@@ -583,11 +792,7 @@ static napi_value dumps(napi_env env, napi_callback_info info) {
     }
     
     napi_value result;
-    void *result_data;
-    status = napi_create_buffer_copy(env, size, buf, &result_data, &result);
-    free(buf);
-    
-    if (status != napi_ok) {
+    if (create_encoded_buffer(env, buf, size, &result) != napi_ok) {
         return throw_encode_error(env, "Failed to create buffer");
     }
     
@@ -595,8 +800,8 @@ static napi_value dumps(napi_env env, napi_callback_info info) {
 }
 
 static napi_value loads(napi_env env, napi_callback_info info) {
-    size_t argc = 2;
-    napi_value args[2];
+    size_t argc = 3;
+    napi_value args[3];
     napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
     
     if (status != napi_ok || argc < 1) {
@@ -620,15 +825,24 @@ static napi_value loads(napi_env env, napi_callback_info info) {
     
     napi_value object_hook = (argc > 1) ? args[1] : NULL;
     
+    /* zeroCopy: Bytes values become views of the input */
+    bool zero_copy = false;
+    if (argc > 2) napi_get_value_bool(env, args[2], &zero_copy);
+    
+    borrow_source source;
+    borrow_source *src = NULL;
+    if (zero_copy && borrow_source_init(env, args[0], &source) == napi_ok) src = &source;
+    
     crous_value *value = NULL;
-    crous_err_t err = crous_decode((const uint8_t*)data, length, &value);
+    crous_err_t err = src ? crous_decode_borrowed((const uint8_t*)data, length, &value)
+                          : crous_decode((const uint8_t*)data, length, &value);
     
     if (err != CROUS_OK) {
         if (value) crous_value_free_tree(value);
         return throw_decode_error(env, crous_err_str(err));
     }
     
-    napi_value result = crous_to_napi(env, value, object_hook);
+    napi_value result = crous_to_napi(env, value, object_hook, src);
     crous_value_free_tree(value);
     
     return result;
@@ -765,6 +979,479 @@ static napi_value unregister_decoder(napi_env env, napi_callback_info info) {
     return result;
 }
 
+/* ============================================================================
+   SESSIONS
+   ============================================================================ */
+
+/* A crous_session behind a JS external, freed with it. CrousEncoder and
+ * CrousDecoder each hold one, so their output buffer survives between
+ * calls. busy marks a decode in progress: an objectHook that decodes on
+ * the same session again takes the one-shot path, leaving the tree being
+ * converted alone. */
+typedef struct {
+    crous_session *session;
+    int busy;
+} node_session;
+
+static void session_finalize(napi_env env, void *data, void *hint) {
+    (void)env;
+    (void)hint;
+    node_session *ns = (node_session *)data;
+    crous_session_free(ns->session);
+    free(ns);
+}
+
+static node_session* get_session(napi_env env, napi_value value) {
+    void *data = NULL;
+    if (napi_get_value_external(env, value, &data) != napi_ok || !data) {
+        napi_throw_type_error(env, NULL, "Expected a session");
+        return NULL;
+    }
+    return (node_session *)data;
+}
+
+static napi_value create_session(napi_env env, napi_callback_info info) {
+    (void)info;
+    node_session *ns = (node_session *)calloc(1, sizeof(node_session));
+    if (!ns || crous_session_new(&ns->session) != CROUS_OK) {
+        free(ns);
+        return throw_crous_error(env, crous_err_str(CROUS_ERR_OOM));
+    }
+    
+    napi_value result;
+    if (napi_create_external(env, ns, session_finalize, NULL, &result) != napi_ok) {
+        crous_session_free(ns->session);
+        free(ns);
+        return throw_crous_error(env, "Failed to create session");
+    }
+    return result;
+}
+
+static napi_value session_encode(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    
+    if (status != napi_ok || argc < 2) {
+        napi_throw_type_error(env, NULL, "Wrong number of arguments");
+        return NULL;
+    }
+    node_session *ns = get_session(env, args[0]);
+    if (!ns) return NULL;
+    
+    napi_value default_func = (argc > 2) ? args[2] : NULL;
+    
+    crous_err_t err;
+    crous_value *value = napi_to_crous(env, args[1], default_func, &err);
+    if (!value || err != CROUS_OK) {
+        return throw_encode_error(env, crous_err_str(err));
+    }
+    
+    /* The payload is copied out of the session buffer: cheaper than a
+     * fresh external allocation for the small messages sessions are for */
+    const uint8_t *buf;
+    size_t size;
+    err = crous_session_encode(ns->session, value, &buf, &size);
+    crous_value_free_tree(value);
+    if (err != CROUS_OK) {
+        return throw_encode_error(env, crous_err_str(err));
+    }
+    
+    napi_value result;
+    void *result_data;
+    if (napi_create_buffer_copy(env, size, buf, &result_data, &result) != napi_ok) {
+        return throw_encode_error(env, "Failed to create buffer");
+    }
+    return result;
+}
+
+static napi_value session_decode(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    
+    if (status != napi_ok || argc < 2) {
+        napi_throw_type_error(env, NULL, "Wrong number of arguments");
+        return NULL;
+    }
+    node_session *ns = get_session(env, args[0]);
+    if (!ns) return NULL;
+    
+    bool is_buffer;
+    status = napi_is_buffer(env, args[1], &is_buffer);
+    if (status != napi_ok || !is_buffer) {
+        napi_throw_type_error(env, NULL, "First argument must be a Buffer");
+        return NULL;
+    }
+    
+    void *data;
+    size_t length;
+    if (napi_get_buffer_info(env, args[1], &data, &length) != napi_ok) {
+        return throw_decode_error(env, "Failed to get buffer data");
+    }
+    
+    napi_value object_hook = (argc > 2) ? args[2] : NULL;
+    
+    crous_value *value = NULL;
+    crous_err_t err;
+    if (ns->busy) {
+        err = crous_decode((const uint8_t *)data, length, &value);
+        if (err != CROUS_OK) {
+            if (value) crous_value_free_tree(value);
+            return throw_decode_error(env, crous_err_str(err));
+        }
+        napi_value result = crous_to_napi(env, value, object_hook, NULL);
+        crous_value_free_tree(value);
+        return result;
+    }
+    
+    err = crous_session_decode(ns->session, (const uint8_t *)data, length, &value);
+    if (err != CROUS_OK) {
+        return throw_decode_error(env, crous_err_str(err));
+    }
+    ns->busy = 1;
+    napi_value result = crous_to_napi(env, value, object_hook, NULL);
+    ns->busy = 0;
+    return result;
+}
+
+/* ============================================================================
+   ASYNC DUMPS / LOADS
+   ============================================================================ */
+
+/* dumpsAsync() converts the JS value to a crous tree on the main thread,
+ * since that reads JS objects, then encodes it on the libuv threadpool.
+ * loadsAsync() decodes on the threadpool and builds the JS result back on
+ * the main thread; a large top-level array or object is filled in slices
+ * of top-level entries, yielding to the event loop between slices. */
+
+#define ASYNC_DEFAULT_SLICE 1024
+
+static napi_value make_error(napi_env env, const char *code, const char *msg) {
+    napi_value code_val, msg_val, error;
+    napi_create_string_utf8(env, code, NAPI_AUTO_LENGTH, &code_val);
+    napi_create_string_utf8(env, msg, NAPI_AUTO_LENGTH, &msg_val);
+    napi_create_error(env, code_val, msg_val, &error);
+    return error;
+}
+
+typedef struct {
+    napi_async_work work;
+    napi_deferred deferred;
+    crous_value *value;
+    uint8_t *buf;
+    size_t size;
+    crous_err_t err;
+} dumps_job;
+
+static void dumps_execute(napi_env env, void *data) {
+    (void)env;
+    dumps_job *job = (dumps_job *)data;
+    job->err = crous_encode(job->value, &job->buf, &job->size);
+}
+
+static void dumps_complete(napi_env env, napi_status status, void *data) {
+    dumps_job *job = (dumps_job *)data;
+    napi_value result;
+    
+    if (status != napi_ok) {
+        napi_reject_deferred(env, job->deferred,
+                             make_error(env, "CrousEncodeError", "Encoding was cancelled"));
+    } else if (job->err != CROUS_OK) {
+        napi_reject_deferred(env, job->deferred,
+                             make_error(env, "CrousEncodeError", crous_err_str(job->err)));
+    } else {
+        status = create_encoded_buffer(env, job->buf, job->size, &result);
+        job->buf = NULL;
+        if (status != napi_ok) {
+            napi_reject_deferred(env, job->deferred,
+                                 make_error(env, "CrousEncodeError", "Failed to create buffer"));
+        } else {
+            napi_resolve_deferred(env, job->deferred, result);
+        }
+    }
+    
+    free(job->buf);
+    crous_value_free_tree(job->value);
+    napi_delete_async_work(env, job->work);
+    free(job);
+}
+
+static napi_value dumps_async(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    
+    if (status != napi_ok || argc < 1) {
+        napi_throw_type_error(env, NULL, "Wrong number of arguments");
+        return NULL;
+    }
+    
+    napi_value default_func = (argc > 1) ? args[1] : NULL;
+    
+    crous_err_t err;
+    crous_value *value = napi_to_crous(env, args[0], default_func, &err);
+    if (!value || err != CROUS_OK) {
+        if (value) crous_value_free_tree(value);
+        return throw_encode_error(env, crous_err_str(err));
+    }
+    
+    dumps_job *job = (dumps_job *)calloc(1, sizeof(dumps_job));
+    if (!job) {
+        crous_value_free_tree(value);
+        return throw_encode_error(env, crous_err_str(CROUS_ERR_OOM));
+    }
+    job->value = value;
+    
+    napi_value promise, name;
+    napi_create_promise(env, &job->deferred, &promise);
+    napi_create_string_utf8(env, "crous.dumpsAsync", NAPI_AUTO_LENGTH, &name);
+    status = napi_create_async_work(env, NULL, name, dumps_execute, dumps_complete, job, &job->work);
+    if (status == napi_ok) status = napi_queue_async_work(env, job->work);
+    if (status != napi_ok) {
+        if (job->work) napi_delete_async_work(env, job->work);
+        napi_reject_deferred(env, job->deferred,
+                             make_error(env, "CrousEncodeError", "Failed to queue encoding"));
+        crous_value_free_tree(value);
+        free(job);
+    }
+    
+    return promise;
+}
+
+typedef struct {
+    napi_async_work work;
+    napi_deferred deferred;
+    napi_ref buffer_ref;        /* keeps the input alive while decoding */
+    napi_ref hook_ref;          /* object_hook, or NULL */
+    napi_ref result_ref;        /* container being filled in slices */
+    const uint8_t *data;
+    size_t length;
+    crous_value *value;
+    crous_err_t err;
+    size_t next;                /* next top-level entry to convert */
+    size_t slice;               /* top-level entries per slice */
+    bool zero_copy;             /* Bytes values become views of the input */
+} loads_job;
+
+static void loads_job_free(napi_env env, loads_job *job) {
+    if (job->value) crous_value_free_tree(job->value);
+    if (job->buffer_ref) napi_delete_reference(env, job->buffer_ref);
+    if (job->hook_ref) napi_delete_reference(env, job->hook_ref);
+    if (job->result_ref) napi_delete_reference(env, job->result_ref);
+    free(job);
+}
+
+static napi_value loads_hook(napi_env env, loads_job *job) {
+    napi_value hook = NULL;
+    if (job->hook_ref) napi_get_reference_value(env, job->hook_ref, &hook);
+    return hook;
+}
+
+/* The borrow source for this job's input, or NULL when copying */
+static borrow_source* loads_source(napi_env env, loads_job *job, borrow_source *src) {
+    napi_value buffer;
+    if (!job->zero_copy || napi_get_reference_value(env, job->buffer_ref, &buffer) != napi_ok ||
+        borrow_source_init(env, buffer, src) != napi_ok) {
+        return NULL;
+    }
+    return src;
+}
+
+/* Settle the promise with result, or with the pending exception if a hook
+ * or decoder threw, and release the job */
+static void loads_finish(napi_env env, loads_job *job, napi_value result) {
+    bool pending = false;
+    napi_is_exception_pending(env, &pending);
+    if (pending) {
+        napi_value exception;
+        napi_get_and_clear_last_exception(env, &exception);
+        napi_reject_deferred(env, job->deferred, exception);
+    } else {
+        napi_resolve_deferred(env, job->deferred, result);
+    }
+    loads_job_free(env, job);
+}
+
+static napi_value loads_slice(napi_env env, napi_callback_info info);
+
+/* Convert the next slice of top-level entries; schedule the rest */
+static void loads_step(napi_env env, loads_job *job) {
+    const crous_value *v = job->value;
+    napi_value hook = loads_hook(env, job);
+    borrow_source source;
+    borrow_source *src = loads_source(env, job, &source);
+    napi_value result;
+    napi_get_reference_value(env, job->result_ref, &result);
+    
+    crous_type_t type = crous_value_get_type(v);
+    size_t size = (type == CROUS_TYPE_DICT) ? crous_value_dict_size(v) : crous_value_list_size(v);
+    size_t end = job->next + job->slice;
+    if (end > size) end = size;
+    
+    bool pending = false;
+    for (size_t i = job->next; i < end && !pending; i++) {
+        if (type == CROUS_TYPE_DICT) {
+            const crous_dict_entry *entry = crous_value_dict_get_entry(v, i);
+            if (entry) {
+                napi_value key;
+                napi_create_string_utf8(env, entry->key, entry->key_len, &key);
+                napi_set_property(env, result, key, crous_to_napi(env, entry->value, hook, src));
+            }
+        } else {
+            napi_set_element(env, result, (uint32_t)i, crous_to_napi(env, crous_value_list_get(v, i), hook, src));
+        }
+        napi_is_exception_pending(env, &pending);
+    }
+    job->next = end;
+    
+    if (pending || end == size) {
+        if (!pending && type == CROUS_TYPE_DICT) result = apply_object_hook(env, result, hook);
+        loads_finish(env, job, result);
+        return;
+    }
+    
+    napi_value global, set_immediate, fn, timer;
+    napi_get_global(env, &global);
+    napi_get_named_property(env, global, "setImmediate", &set_immediate);
+    napi_create_function(env, "loadsSlice", NAPI_AUTO_LENGTH, loads_slice, job, &fn);
+    if (napi_call_function(env, global, set_immediate, 1, &fn, &timer) != napi_ok) {
+        loads_finish(env, job, result);
+    }
+}
+
+static napi_value loads_slice(napi_env env, napi_callback_info info) {
+    void *data;
+    napi_get_cb_info(env, info, NULL, NULL, NULL, &data);
+    loads_step(env, (loads_job *)data);
+    return NULL;
+}
+
+static void loads_execute(napi_env env, void *data) {
+    (void)env;
+    loads_job *job = (loads_job *)data;
+    job->err = job->zero_copy ? crous_decode_borrowed(job->data, job->length, &job->value)
+                              : crous_decode(job->data, job->length, &job->value);
+}
+
+static void loads_complete(napi_env env, napi_status status, void *data) {
+    loads_job *job = (loads_job *)data;
+    napi_delete_async_work(env, job->work);
+    job->work = NULL;
+    
+    if (status != napi_ok || job->err != CROUS_OK) {
+        const char *msg = (status != napi_ok) ? "Decoding was cancelled" : crous_err_str(job->err);
+        napi_reject_deferred(env, job->deferred, make_error(env, "CrousDecodeError", msg));
+        loads_job_free(env, job);
+        return;
+    }
+    
+    /* Sliced containers are filled in place; anything else goes in one go */
+    crous_type_t type = crous_value_get_type(job->value);
+    size_t size = 0;
+    if (type == CROUS_TYPE_LIST || type == CROUS_TYPE_TUPLE) size = crous_value_list_size(job->value);
+    else if (type == CROUS_TYPE_DICT) size = crous_value_dict_size(job->value);
+    
+    if (size <= job->slice) {
+        borrow_source source;
+        loads_finish(env, job, crous_to_napi(env, job->value, loads_hook(env, job),
+                                             loads_source(env, job, &source)));
+        return;
+    }
+    
+    napi_value container;
+    if (type == CROUS_TYPE_DICT) napi_create_object(env, &container);
+    else napi_create_array_with_length(env, size, &container);
+    napi_create_reference(env, container, 1, &job->result_ref);
+    loads_step(env, job);
+}
+
+static napi_value loads_async(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    
+    if (status != napi_ok || argc < 1) {
+        napi_throw_type_error(env, NULL, "Wrong number of arguments");
+        return NULL;
+    }
+    
+    bool is_buffer;
+    status = napi_is_buffer(env, args[0], &is_buffer);
+    if (status != napi_ok || !is_buffer) {
+        napi_throw_type_error(env, NULL, "First argument must be a Buffer");
+        return NULL;
+    }
+    
+    int32_t slice = 0;
+    if (argc > 2) napi_get_value_int32(env, args[2], &slice);
+    
+    loads_job *job = (loads_job *)calloc(1, sizeof(loads_job));
+    if (!job) {
+        return throw_decode_error(env, crous_err_str(CROUS_ERR_OOM));
+    }
+    job->slice = (slice > 0) ? (size_t)slice : ASYNC_DEFAULT_SLICE;
+    if (argc > 3) napi_get_value_bool(env, args[3], &job->zero_copy);
+    
+    void *data;
+    if (napi_get_buffer_info(env, args[0], &data, &job->length) != napi_ok) {
+        free(job);
+        return throw_decode_error(env, "Failed to get buffer data");
+    }
+    job->data = (const uint8_t *)data;
+    napi_create_reference(env, args[0], 1, &job->buffer_ref);
+    
+    if (argc > 1) {
+        napi_valuetype hook_type;
+        napi_typeof(env, args[1], &hook_type);
+        if (hook_type == napi_function) napi_create_reference(env, args[1], 1, &job->hook_ref);
+    }
+    
+    napi_value promise, name;
+    napi_create_promise(env, &job->deferred, &promise);
+    napi_create_string_utf8(env, "crous.loadsAsync", NAPI_AUTO_LENGTH, &name);
+    status = napi_create_async_work(env, NULL, name, loads_execute, loads_complete, job, &job->work);
+    if (status == napi_ok) status = napi_queue_async_work(env, job->work);
+    if (status != napi_ok) {
+        if (job->work) napi_delete_async_work(env, job->work);
+        napi_reject_deferred(env, job->deferred,
+                             make_error(env, "CrousDecodeError", "Failed to queue decoding"));
+        loads_job_free(env, job);
+    }
+    
+    return promise;
+}
+
+/* ============================================================================
+   THREAD POOL
+   ============================================================================ */
+
+/* The worker pool is process-wide: every addon instance and worker_thread
+ * shares it. Calls on libuv threadpool threads join its loops as callers. */
+static napi_value set_threads(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    
+    int32_t n;
+    if (status != napi_ok || argc < 1 || napi_get_value_int32(env, args[0], &n) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Expected a number of threads");
+        return NULL;
+    }
+    crous_pool_set_threads(n);
+    
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value get_threads(napi_env env, napi_callback_info info) {
+    (void)info;
+    napi_value result;
+    napi_create_int32(env, crous_pool_threads(), &result);
+    return result;
+}
+
 /* ============================================================================
    MODULE INITIALIZATION
    ============================================================================ */
@@ -785,6 +1472,33 @@ static napi_value Init(napi_env env, napi_value exports) {
     status = napi_set_named_property(env, exports, "loads", fn);
     if (status != napi_ok) return NULL;
     
+    // Create async dumps/loads functions
+    status = napi_create_function(env, "dumps_async", NAPI_AUTO_LENGTH, dumps_async, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "dumpsAsync", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, "loads_async", NAPI_AUTO_LENGTH, loads_async, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "loadsAsync", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Create session functions
+    status = napi_create_function(env, "create_session", NAPI_AUTO_LENGTH, create_session, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "createSession", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, "session_encode", NAPI_AUTO_LENGTH, session_encode, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "sessionEncode", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, "session_decode", NAPI_AUTO_LENGTH, session_decode, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "sessionDecode", fn);
+    if (status != napi_ok) return NULL;
+    
     // Create register_serializer function
     status = napi_create_function(env, "register_serializer", NAPI_AUTO_LENGTH, 
                                    register_serializer, NULL, &fn);
@@ -813,6 +1527,17 @@ static napi_value Init(napi_env env, napi_value exports) {
     status = napi_set_named_property(env, exports, "unregisterDecoder", fn);
     if (status != napi_ok) return NULL;
     
+    // Create thread pool functions
+    status = napi_create_function(env, "set_threads", NAPI_AUTO_LENGTH, set_threads, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "setThreads", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, "get_threads", NAPI_AUTO_LENGTH, get_threads, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getThreads", fn);
+    if (status != napi_ok) return NULL;
+    
     return exports;
 }
 
@@ -154,6 +154,20 @@ test('buffer (bytes) simple', () => {
     assert(data.equals(result), 'Result should equal original buffer');
 });
 
+test('buffer (bytes) zero-copy views', () => {
+    const payload = Buffer.from([9, 8, 7, 6]);
+    const binary = crous.dumps({ blob: payload, name: 'x', list: [payload] });
+    const result = crous.loads(binary, { zeroCopy: true });
+    assert(payload.equals(result.blob), 'View should hold the payload');
+    assert.strictEqual(result.blob.buffer, binary.buffer, 'View should share the input memory');
+    assert.strictEqual(result.name, 'x');
+    binary[result.blob.byteOffset - binary.byteOffset] = 0;
+    assert.strictEqual(result.blob[0], 0, 'View should see input changes');
+    
+    const copied = crous.loads(binary);
+    assert.notStrictEqual(copied.blob.buffer, binary.buffer, 'Default should copy');
+});
+
 // ============================================================================
 // Collection Type Tests
 // ============================================================================
@@ -290,6 +304,73 @@ test('Set serialization', () => {
     }
 });
 
+// ============================================================================
+// Standard Type Tests
+// ============================================================================
+
+test('Date round-trip', () => {
+    const data = { when: new Date('2024-05-06T07:08:09.123Z'), before: new Date(-1) };
+    const result = crous.loads(crous.dumps(data));
+    
+    assert(result.when instanceof Date, 'Result should be a Date');
+    assert.strictEqual(result.when.getTime(), data.when.getTime());
+    assert.strictEqual(result.before.getTime(), -1);
+});
+
+test('registered Date serializer wins', () => {
+    crous.registerSerializer(Date, (d) => d.toISOString());
+    try {
+        const result = crous.loads(crous.dumps(new Date(0)));
+        assert.strictEqual(result, '1970-01-01T00:00:00.000Z');
+    } finally {
+        crous.unregisterSerializer(Date);
+    }
+});
+
+test('Python standard types decode', () => {
+    // [datetime(2024, 1, 2, 3, 4, 5), date(2020, 1, 1), Decimal('-1.50E+3'),
+    //  UUID('12345678-1234-5678-1234-567812345678')] as written by Python
+    const binary = Buffer.from(
+        '464c55580100070409500380cdee84b8fb8606095103ac9d02095306040102150f' +
+        '0954061012345678123456781234567812345678', 'hex');
+    const [when, day, price, id] = crous.loads(binary);
+    
+    assert.strictEqual(when.toISOString(), '2024-01-02T03:04:05.000Z');
+    assert.strictEqual(day.toISOString(), '2020-01-01T00:00:00.000Z');
+    assert.strictEqual(price, '-1.50E+3');
+    assert.strictEqual(id, '12345678-1234-5678-1234-567812345678');
+});
+
+// ============================================================================
+// Encoder/Decoder Session Tests
+// ============================================================================
+
+test('CrousEncoder/CrousDecoder reuse', () => {
+    const encoder = new crous.CrousEncoder();
+    const decoder = new crous.CrousDecoder();
+    for (const n of [3, 5000, 10, 20000, 1]) {
+        const data = Array.from({ length: n }, (_, i) => ({ id: i, name: `item${i}` }));
+        const binary = encoder.encode(data);
+        assert(binary.equals(crous.dumps(data)), 'Should match dumps() output');
+        assert.deepStrictEqual(decoder.decode(binary), data);
+    }
+    const first = encoder.encode({ a: 1 });
+    encoder.encode({ b: 2 });
+    assert.deepStrictEqual(crous.loads(first), { a: 1 }, 'Results should not share the session buffer');
+});
+
+test('CrousDecoder re-entrant objectHook', () => {
+    const inner = crous.dumps({ leaf: true });
+    const decoder = new crous.CrousDecoder({
+        objectHook: (obj) => ('wrap' in obj ? { wrap: obj.wrap, nested: decoder.decode(inner) } : obj),
+    });
+    const result = decoder.decode(crous.dumps([{ wrap: 1 }, { wrap: 2 }]));
+    assert.deepStrictEqual(result, [
+        { wrap: 1, nested: { leaf: true } },
+        { wrap: 2, nested: { leaf: true } },
+    ]);
+});
+
 // ============================================================================
 // Error Handling Tests
 // ============================================================================
@@ -319,15 +400,108 @@ test('version info', () => {
 });
 
 // ============================================================================
-// Summary
+// Thread Pool Test
+// ============================================================================
+
+test('thread pool size', () => {
+    const initial = crous.getThreads();
+    assert(initial >= 1, 'Pool should have at least one thread');
+    crous.setThreads(3);
+    assert.strictEqual(crous.getThreads(), 3);
+    crous.setThreads(0);
+    assert.strictEqual(crous.getThreads(), initial, 'Zero should restore one per CPU');
+    assert.throws(() => crous.setThreads('4'), TypeError);
+});
+
+// ============================================================================
+// Async Tests
 // ============================================================================
 
-console.log('\n' + '='.repeat(60));
-console.log(`Test Results: ${passCount}/${testCount} passed`);
-if (failCount > 0) {
-    console.log(`${failCount} test(s) failed`);
-    process.exit(1);
-} else {
-    console.log('All tests passed! ✓');
-    process.exit(0);
+const asyncTests = [];
+
+function asyncTest(name, fn) {
+    asyncTests.push({ name, fn });
 }
+
+asyncTest('dumpsAsync/loadsAsync roundtrip', async () => {
+    const data = { name: 'Alice', tags: ['a', 'b'], nested: { n: 42, f: 1.5 } };
+    const binary = await crous.dumpsAsync(data);
+    assert(Buffer.isBuffer(binary), 'Should resolve to a Buffer');
+    assert(binary.equals(crous.dumps(data)), 'Should match dumps() output');
+    assert.deepStrictEqual(await crous.loadsAsync(binary), data);
+});
+
+asyncTest('loadsAsync builds large containers in slices', async () => {
+    const list = Array.from({ length: 5000 }, (_, i) => ({ id: i, label: `item${i}` }));
+    const obj = {};
+    for (let i = 0; i < 3000; i++) obj[`k${i}`] = i;
+    
+    let turns = 0;
+    const ticker = setInterval(() => turns++, 0);
+    const decodedList = await crous.loadsAsync(crous.dumps(list), { sliceSize: 100 });
+    const decodedObj = await crous.loadsAsync(crous.dumps(obj), { sliceSize: 100 });
+    clearInterval(ticker);
+    
+    assert.deepStrictEqual(decodedList, list);
+    assert.deepStrictEqual(decodedObj, obj);
+    assert(turns > 0, 'Event loop should run between slices');
+});
+
+asyncTest('loadsAsync applies objectHook', async () => {
+    const obj = {};
+    for (let i = 0; i < 50; i++) obj[`k${i}`] = { v: i };
+    const hooked = await crous.loadsAsync(crous.dumps(obj), {
+        sliceSize: 8,
+        objectHook: (o) => ('v' in o ? o.v : Object.keys(o).length),
+    });
+    assert.strictEqual(hooked, 50);
+});
+
+asyncTest('loadsAsync zero-copy views', async () => {
+    const list = Array.from({ length: 40 }, (_, i) => Buffer.from([i, i + 1]));
+    const binary = crous.dumps(list);
+    const result = await crous.loadsAsync(binary, { zeroCopy: true, sliceSize: 8 });
+    assert.deepStrictEqual(result, list);
+    assert(result.every((b) => b.buffer === binary.buffer), 'Views should share the input memory');
+});
+
+asyncTest('async errors reject', async () => {
+    await assert.rejects(crous.loadsAsync(Buffer.from([1, 2, 3])), crous.CrousDecodeError);
+    await assert.rejects(crous.dumpsAsync({ fn: () => 1 }), crous.CrousEncodeError);
+    await assert.rejects(
+        crous.loadsAsync(crous.dumps(Array.from({ length: 20 }, () => ({}))), {
+            sliceSize: 4,
+            objectHook: () => { throw new Error('hook failed'); },
+        }),
+        /hook failed/
+    );
+});
+
+// ============================================================================
+// Summary
+// ============================================================================
+
+(async () => {
+    for (const { name, fn } of asyncTests) {
+        testCount++;
+        try {
+            await fn();
+            passCount++;
+            console.log(`✓ ${name}`);
+        } catch (error) {
+            failCount++;
+            console.error(`✗ ${name}`);
+            console.error(`  Error: ${error.message}`);
+        }
+    }
+    
+    console.log('\n' + '='.repeat(60));
+    console.log(`Test Results: ${passCount}/${testCount} passed`);
+    if (failCount > 0) {
+        console.log(`${failCount} test(s) failed`);
+        process.exit(1);
+    } else {
+        console.log('All tests passed! ✓');
+        process.exit(0);
+    }
+})();
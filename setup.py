@@ -1,4 +1,4 @@
-from setuptools import setup, Extension, find_packages
+from setuptools import setup, Extension, find_packages, Command
 from setuptools.command.build_ext import build_ext as _build_ext
 import os
 import sys
@@ -29,6 +29,91 @@ class build_ext(_build_ext):
     def copy_extensions_to_source(self):
         pass
 
+
+# The C library proper; the extension adds its Python bindings on top
+CORE_SOURCES = [
+    'crous/src/c/core/errors.c',
+    'crous/src/c/core/arena.c',
+    'crous/src/c/core/value.c',
+    'crous/src/c/core/visitor.c',
+    'crous/src/c/core/version.c',
+    'crous/src/c/core/stats.c',
+    'crous/src/c/utils/token.c',
+    'crous/src/c/utils/scan.c',
+    'crous/src/c/utils/checksum.c',
+    'crous/src/c/utils/compress.c',
+    'crous/src/c/utils/parallel.c',
+    'crous/src/c/lexer/lexer.c',
+    'crous/src/c/parser/parser.c',
+    'crous/src/c/binary/binary.c',
+    'crous/src/c/binary/file_view.c',
+    'crous/src/c/binary/frame.c',
+    'crous/src/c/binary/session.c',
+    'crous/src/c/flux/flux_lexer.c',
+    'crous/src/c/flux/flux_parser.c',
+    'crous/src/c/flux/flux_serializer.c',
+    'crous/src/c/flux/flux_stream.c',
+    'crous/src/c/flux/flux_compress.c',
+    'crous/src/c/flux/flux_dictionary.c',
+    'crous/src/c/flux/flux_schema.c',
+    'crous/src/c/crout/crout.c',
+]
+
+COMPILE_ARGS = [
+    '-O3',                
+    '-Wall',              
+    '-Wextra',            
+    '-std=c99',           
+]
+
+
+class build_bench(Command):
+    """Build the native benchmark harness (bench/crous_bench.c) against the C library."""
+    
+    description = "build the C benchmark harness into build/bench/crous_bench"
+    user_options = [
+        ('build-dir=', 'b', "directory for the binary and objects (default build/bench)"),
+    ]
+    
+    def initialize_options(self):
+        self.build_dir = None
+    
+    def finalize_options(self):
+        if self.build_dir is None:
+            self.build_dir = os.path.join('build', 'bench')
+    
+    def run(self):
+        from distutils.ccompiler import new_compiler
+        from distutils.sysconfig import customize_compiler
+        
+        compiler = new_compiler()
+        customize_compiler(compiler)
+        macros = []
+        link_args = []
+        libraries = []
+        if platform.system() == 'Linux':
+            # Count the library's allocations: GNU ld and lld route its
+            # malloc/calloc/realloc calls through the harness
+            macros.append(('CROUS_BENCH_WRAP_MALLOC', '1'))
+            link_args.append('-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc')
+        if os.name == 'posix':
+            libraries += ['pthread', 'm']
+        
+        objects = compiler.compile(
+            CORE_SOURCES + ['bench/crous_bench.c'],
+            output_dir=os.path.join(self.build_dir, 'obj'),
+            macros=macros,
+            include_dirs=['crous/include'],
+            extra_postargs=COMPILE_ARGS,
+        )
+        compiler.link_executable(
+            objects, 'crous_bench',
+            output_dir=self.build_dir,
+            libraries=libraries,
+            extra_postargs=link_args,
+        )
+        print(f"Built {os.path.join(self.build_dir, 'crous_bench')}")
+
 long_description = ""
 readme_path = os.path.join(here, "README.md")
 if os.path.exists(readme_path):
@@ -37,28 +122,9 @@ if os.path.exists(readme_path):
 
 crous_extension = Extension(
     'crous.crous',                  
-    sources=[
-        'crous/pycrous.c',
-        'crous/src/c/core/errors.c',
-        'crous/src/c/core/arena.c',
-        'crous/src/c/core/value.c',
-        'crous/src/c/core/version.c',
-        'crous/src/c/utils/token.c',
-        'crous/src/c/lexer/lexer.c',
-        'crous/src/c/parser/parser.c',
-        'crous/src/c/binary/binary.c',
-        'crous/src/c/flux/flux_lexer.c',
-        'crous/src/c/flux/flux_parser.c',
-        'crous/src/c/flux/flux_serializer.c',
-        'crous/src/c/crout/crout.c',
-    ],
+    sources=['crous/pycrous.c'] + CORE_SOURCES,
     include_dirs=['crous/include'],
-    extra_compile_args=[
-        '-O3',                
-        '-Wall',              
-        '-Wextra',            
-        '-std=c99',           
-    ],
+    extra_compile_args=COMPILE_ARGS,
     extra_link_args=[],
 )
 
@@ -77,7 +143,7 @@ setup(
     
     ext_modules=[crous_extension],
     
-    cmdclass={'build_ext': build_ext},
+    cmdclass={'build_ext': build_ext, 'build_bench': build_bench},
     
     python_requires=">=3.6",
     
@@ -193,6 +193,15 @@ class TestBasicDumpsLoads:
         assert result == value
         assert len(result) == len(value)
 
+    def test_decoded_values_outlive_input(self):
+        """Test decoded strings, bytes and keys don't depend on the input buffer."""
+        value = {f'blob_{i}': (bytes([i]) * 4096, f'name_{i}') for i in range(64)}
+        binary = bytearray(crous.dumps(value))
+        result = crous.loads(bytes(binary))
+        binary[:] = b'\x00' * len(binary)
+        del binary
+        assert result == value
+
 
 class TestBasicDumpLoad:
     """Test dump() and load() with file paths and file objects."""
@@ -398,6 +407,19 @@ class TestEdgeCases:
         result = crous.loads(binary)
         assert result == data
 
+    def test_varint_width_boundaries(self):
+        """Test dumps sizes its output exactly across varint width boundaries."""
+        data = {
+            'ints': [63, 64, -64, -65, 8191, 8192, 2**63 - 1, -2**63],
+            'strs': ['a' * 127, 'b' * 128, 'c' * 16383, 'd' * 16384],
+            'k' * 128: b'\x01' * 128,
+        }
+        binary = crous.dumps(data)
+        buf = io.BytesIO()
+        crous.dumps_stream(data, buf)
+        assert binary == buf.getvalue()
+        assert crous.loads(binary) == data
+
 
 class TestDataPreservation:
     """Test that data types and values are preserved accurately."""
@@ -449,3 +471,222 @@ class TestDataPreservation:
         result = crous.loads(binary)
         
         assert list(result.keys()) == list(data.keys())
+
+
+class TestDumpsInto:
+    """Test dumps_into() writing into caller buffers."""
+
+    DATA = {'id': 7, 'name': 'x' * 200, 'tags': ['a', 'b'], 'score': 1.5}
+
+    def test_matches_dumps(self):
+        """dumps_into() writes the same bytes as dumps()."""
+        buf = bytearray(1024)
+        n = crous.dumps_into(self.DATA, buf)
+        assert bytes(buf[:n]) == crous.dumps(self.DATA)
+
+    def test_offset(self):
+        """Bytes land at offset and nothing before it is touched."""
+        buf = bytearray(b'\xaa' * 1024)
+        n = crous.dumps_into(self.DATA, buf, 100)
+        assert buf[:100] == b'\xaa' * 100
+        assert crous.loads(bytes(buf[100:100 + n])) == self.DATA
+
+    @pytest.mark.parametrize("options", [
+        {'key_refs': True},
+        {'columnar': True},
+        {'compression': 'lz4'},
+        {'checksum': True},
+    ])
+    def test_options(self, options):
+        """Encoder options give the same output as dumps()."""
+        data = [self.DATA] * 50
+        expected = crous.dumps(data, **options)
+        buf = bytearray(len(expected))
+        assert crous.dumps_into(data, buf, **options) == len(expected)
+        assert bytes(buf) == expected
+
+    @pytest.mark.parametrize("value", [1, [1, 2], list(range(100)), DATA])
+    def test_exact_size(self, value):
+        """A buffer of exactly the encoded size is enough."""
+        expected = crous.dumps(value)
+        buf = bytearray(len(expected))
+        assert crous.dumps_into(value, buf) == len(expected)
+        assert bytes(buf) == expected
+
+    @pytest.mark.parametrize("value", [1, [1, 2], list(range(100)), DATA])
+    def test_exact_size_at_offset(self, value):
+        """So are exactly that many bytes past offset."""
+        expected = crous.dumps(value)
+        buf = bytearray(b'\xaa' * (5 + len(expected)))
+        assert crous.dumps_into(value, buf, 5) == len(expected)
+        assert buf[:5] == b'\xaa' * 5
+        assert bytes(buf[5:]) == expected
+
+    @pytest.mark.parametrize("options", [{}, {'compression': 'lz4'}])
+    def test_too_small_reports_needed(self, options):
+        """A short buffer raises CrousEncodeError with the size needed."""
+        data = [self.DATA] * 50
+        expected = crous.dumps(data, **options)
+        with pytest.raises(crous.CrousEncodeError) as info:
+            crous.dumps_into(data, bytearray(len(expected) - 1), **options)
+        assert info.value.needed == len(expected)
+
+    def test_default_called_once_on_overflow(self):
+        """Finding the needed size does not encode obj a second time."""
+        calls = []
+
+        class Point:
+            pass
+
+        def default(obj):
+            calls.append(obj)
+            return 'point'
+
+        with pytest.raises(crous.CrousEncodeError):
+            crous.dumps_into([Point(), 'y' * 500], bytearray(16), default=default)
+        assert len(calls) == 1
+
+    def test_memoryview_and_mmap(self):
+        """Any writable contiguous buffer works."""
+        import mmap
+        expected = crous.dumps(self.DATA)
+        view = memoryview(bytearray(2048))[512:]
+        n = crous.dumps_into(self.DATA, view, 8)
+        assert bytes(view[8:8 + n]) == expected
+        m = mmap.mmap(-1, 4096)
+        try:
+            n = crous.dumps_into(self.DATA, m)
+            assert m[:n] == expected
+        finally:
+            m.close()
+
+    def test_invalid_buffer_or_offset(self):
+        """Read-only buffers and offsets outside the buffer are rejected."""
+        with pytest.raises(BufferError):
+            crous.dumps_into(self.DATA, b'\x00' * 1024)
+        with pytest.raises(ValueError):
+            crous.dumps_into(self.DATA, bytearray(8), 9)
+        with pytest.raises(ValueError):
+            crous.dumps_into(self.DATA, bytearray(8), -1)
+
+
+class Rebuild:
+    """Visitor that rebuilds the document from its events."""
+
+    def __init__(self):
+        self.stack = [[]]
+        self.keys = []
+        self.tags = 0
+        self.counts = []
+
+    def _add(self, value):
+        top = self.stack[-1]
+        if isinstance(top, dict):
+            top[self.keys.pop()] = value
+        else:
+            top.append(value)
+
+    def scalar(self, value):
+        self._add(value)
+
+    def tag(self, tag):
+        self.tags += 1
+
+    def key(self, name):
+        self.keys.append(name)
+
+    def begin(self, kind, count):
+        self.counts.append(count)
+        self.stack.append({} if kind == 'dict' else [])
+
+    def end(self, kind, count):
+        value = self.stack.pop()
+        assert len(value) == count
+        self._add(tuple(value) if kind == 'tuple' else value)
+
+    @property
+    def result(self):
+        return self.stack[0][0]
+
+
+class TestVisit:
+    """Test visit() event walks over FLUX binary and CROUT text."""
+
+    DATA = {
+        'id': 7,
+        'name': 'crous',
+        'tags': ['a', 'b'],
+        'point': (1.5, -2.0),
+        'raw': b'\x00\xff',
+        'none': None,
+        'ok': True,
+        'nested': {'list': [1, [2, [3]]], 'empty': {}},
+    }
+
+    @pytest.mark.parametrize('options', [
+        {}, {'key_refs': True}, {'compression': 'lz4'}, {'checksum': True}, {'dedup': True},
+    ])
+    def test_binary_events_rebuild_document(self, options):
+        """Rebuilding from the events gives back what loads() returns."""
+        v = Rebuild()
+        crous.visit(crous.dumps(self.DATA, **options), v)
+        assert v.result == crous.loads(crous.dumps(self.DATA))
+        assert None not in v.counts
+
+    def test_text_events_rebuild_document(self):
+        """CROUT text reports the same values; counts come only at the end."""
+        v = Rebuild()
+        crous.visit(crous.dumps_text(self.DATA), v)
+        assert v.result == crous.loads(crous.dumps(self.DATA))
+        assert set(v.counts) == {None}
+
+    def test_tables_and_packed_arrays_read_as_lists(self):
+        import array
+        rows = [{'a': i, 'b': str(i)} for i in range(20)]
+        v = Rebuild()
+        crous.visit(crous.dumps(rows, columnar=True), v)
+        assert v.result == rows
+        v = Rebuild()
+        crous.visit(crous.dumps({'q': array.array('q', [1, -2, 3]), 'd': array.array('d', [0.5])}), v)
+        assert v.result == {'q': [1, -2, 3], 'd': [0.5]}
+
+    def test_tags_and_partial_visitors(self):
+        """Tagged values report their tag; visitors may define any subset."""
+        v = Rebuild()
+        crous.visit('CROUT1\n[#1:i5 , #2:#3:s1:x]', v)
+        assert v.result == [5, 'x']
+        assert v.tags == 3
+
+        class Sum:
+            total = 0
+
+            def scalar(self, value):
+                if isinstance(value, int):
+                    self.total += value
+
+        s = Sum()
+        crous.visit(crous.dumps(list(range(100))), s)
+        assert s.total == 4950
+        crous.visit(crous.dumps(self.DATA), object())
+
+    def test_visitor_exception_stops_walk(self):
+        class Stop:
+            seen = 0
+
+            def scalar(self, value):
+                self.seen += 1
+                if self.seen == 3:
+                    raise KeyError('enough')
+
+        s = Stop()
+        with pytest.raises(KeyError):
+            crous.visit(crous.dumps(list(range(10))), s)
+        assert s.seen == 3
+
+    def test_malformed_input(self):
+        with pytest.raises(crous.CrousDecodeError):
+            crous.visit(crous.dumps(self.DATA)[:-3], Rebuild())
+        with pytest.raises(crous.CrousDecodeError):
+            crous.visit('CROUT1\n[i1 , ', Rebuild())
+        with pytest.raises(crous.CrousDecodeError):
+            crous.visit(b'nope', Rebuild())
@@ -6,6 +6,7 @@ Tests lists, tuples, dicts with various content, nesting, and edge cases.
 
 import pytest
 import crous
+import io
 
 
 class TestLists:
@@ -251,6 +252,120 @@ class TestDicts:
         assert isinstance(result['str'], str)
         assert isinstance(result['bytes'], bytes)
 
+    def test_wide_dict_preserves_order(self):
+        """Test that dicts past the hash-index threshold keep insertion order."""
+        data = {f'k{i:05d}'[::-1]: i for i in range(20000)}
+        result = crous.loads(crous.dumps(data))
+
+        assert result == data
+        assert list(result.keys()) == list(data.keys())
+
+    def test_wide_dict_text_roundtrip(self):
+        """Test that wide dicts survive the CROUT path, which looks keys up."""
+        data = {f'field_{i}': [i, str(i)] for i in range(500)}
+        result = crous.loads_text(crous.dumps_text(data))
+
+        assert result == data
+
+    def test_duplicate_keys_last_wins(self):
+        """Test that a repeated key in FLUX input resolves to the last value."""
+        # FLUX header, dict of 2 entries, both keyed 'a' (ints 1 then 2)
+        binary = b'FLUX\x01\x00' + b'\x08\x02' + b'\x01a\x03\x02' + b'\x01a\x03\x04'
+        assert crous.loads(binary) == {'a': 2}
+
+    def test_repeated_keys_share_objects(self):
+        """Test that keys repeated across records decode to one str object."""
+        rows = [{'identifier': i, 'name': f'row{i}'} for i in range(200)]
+        result = crous.loads(crous.dumps(rows))
+
+        assert result == rows
+        first = list(result[0])
+        assert all(list(row)[0] is first[0] for row in result)
+
+    def test_many_distinct_keys_with_cache(self):
+        """Test that key-cache collisions and non-ASCII keys decode correctly."""
+        rows = [{f'k{i}': i, f'ключ{i}': -i, 'x' * 100: i} for i in range(2000)]
+        assert crous.loads(crous.dumps(rows)) == rows
+
+        decoder = crous.CrousDecoder()
+        for chunk in (rows[:10], rows[10:20], rows):
+            assert decoder.decode(crous.dumps(chunk)) == chunk
+
+    def test_key_refs_roundtrip(self):
+        """Test that wire v3 key back-references decode on every read path."""
+        import io
+        rows = [{'identifier': i, 'name': f'row{i}', '': None, 'nested': {'name': i}}
+                for i in range(300)]
+        plain = crous.dumps(rows)
+        binary = crous.dumps(rows, key_refs=True)
+
+        assert binary[4] == 3
+        assert len(binary) < len(plain)
+        assert crous.loads(binary) == rows
+        assert crous.loads_stream(io.BytesIO(binary)) == rows
+        assert crous.loads_text(crous.flux_to_text(binary)) == rows
+        assert crous.CrousEncoder(key_refs=True).encode(rows) == binary
+
+    def test_key_refs_past_table_limit(self):
+        """Test that keys beyond the key table limit are written literally."""
+        import io
+        data = [{f'k{i}': i for i in range(70000)}] * 2
+        binary = crous.dumps(data, key_refs=True)
+        assert crous.loads(binary) == data
+        assert crous.loads_stream(io.BytesIO(binary)) == data
+
+    def test_key_ref_out_of_range(self):
+        """Test that a back-reference to an unseen key is rejected."""
+        # Wire v3 header, dict of 1 entry keyed by reference to index 0
+        binary = b'FLUX\x03\x00' + b'\x08\x01' + b'\x01' + b'\x00'
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(binary)
+
+    def test_columnar_roundtrip(self):
+        """Test that record lists written as tables decode on all read paths."""
+        data = {
+            'rows': [
+                {'id': i, 'ts': 1700000000 + i * 60, 'score': i / 4,
+                 'ok': i % 3 == 0, 'name': f'user{i}', 'extra': [i] if i % 2 else None}
+                for i in range(100)
+            ],
+            'mixed': [{'a': 1}, {'a': 'x'}, {'a': 2.5}, {'a': True}],
+            'extremes': [{'v': -2**63}, {'v': 2**63 - 1}, {'v': 0}, {'v': -1}],
+        }
+        binary = crous.dumps(data, columnar=True)
+        assert binary[4] == 4
+        assert len(binary) < len(crous.dumps(data, key_refs=True))
+        assert crous.loads(binary) == data
+        assert crous.loads_stream(io.BytesIO(binary)) == data
+        assert crous.loads_text(crous.flux_to_text(binary)) == data
+
+    def test_columnar_int_runs(self):
+        """Test int columns longer than one decode batch, with mixed widths."""
+        rows = [{'n': (i * 7919) % 300 - 150, 'big': (1 << (i % 62)) + i, 'd': i * 3}
+                for i in range(333)]
+        binary = crous.dumps(rows, columnar=True)
+        assert crous.loads(binary) == rows
+        assert crous.loads_stream(io.BytesIO(binary)) == rows
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(binary[:len(binary) // 2])
+
+    def test_columnar_keeps_row_types_and_order(self):
+        """Test that lists not of same-shaped dicts keep their list layout."""
+        data = [{'a': 1, 'b': 2}, {'b': 3, 'a': 4}] * 3
+        result = crous.loads(crous.dumps(data, columnar=True))
+        assert [list(row) for row in result] == [list(row) for row in data]
+        hooked = crous.loads(crous.dumps([{'n': i} for i in range(5)], columnar=True),
+                             object_hook=lambda d: d['n'])
+        assert hooked == [0, 1, 2, 3, 4]
+
+    def test_table_without_columnar_header(self):
+        """Test that a table in a pre-v4 document is rejected."""
+        table = crous.dumps([{'a': i} for i in range(4)], columnar=True)[6:]
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(b'FLUX\x03\x00' + table)
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(b'FLUX\x04\x00' + table[:-1])
+
 
 class TestTuples:
     """Test tuple handling - tuples are natively supported by Crous."""
@@ -396,3 +511,218 @@ class TestContainerProperties:
         # (Crous encodes values, not references)
         assert result[0] == [1, 2]
         assert result[1] == [1, 2]
+
+
+class TestPackedArrays:
+    """Test buffer-protocol objects encoded as packed numeric arrays."""
+
+    def test_float64_array_roundtrip(self):
+        """Test array('d') decodes to an array of the same typecode."""
+        import array
+        data = array.array('d', [1.5, -2.25, 3.0, float('inf')])
+        result = crous.loads(crous.dumps(data))
+        assert isinstance(result, array.array)
+        assert result.typecode == 'd'
+        assert result == data
+
+    def test_int64_array_roundtrip(self):
+        """Test array('q') keeps the full 64-bit range."""
+        import array
+        data = array.array('q', [0, -1, 2**63 - 1, -2**63])
+        result = crous.loads(crous.dumps(data))
+        assert result.typecode == 'q'
+        assert result == data
+
+    def test_narrow_arrays_widen(self):
+        """Test narrower element types widen to int64/float64."""
+        import array
+        ints = crous.loads(crous.dumps(array.array('i', [1, -2, 3])))
+        assert ints.typecode == 'q'
+        assert list(ints) == [1, -2, 3]
+        floats = crous.loads(crous.dumps(array.array('f', [0.5, 1.5])))
+        assert floats.typecode == 'd'
+        assert list(floats) == [0.5, 1.5]
+
+    def test_packed_smaller_than_list(self):
+        """Test a packed array costs 8 bytes per element."""
+        import array
+        data = array.array('d', [0.1] * 1000)
+        assert len(crous.dumps(data)) < len(crous.dumps(list(data)))
+        assert len(crous.dumps(data)) <= 6 + 1 + 2 + 8 + 8 * 1000
+
+    def test_array_data_is_aligned(self):
+        """Test element data starts on an 8-byte boundary."""
+        import array
+        data = array.array('q', [7, 8, 9])
+        for prefix in ('', 'a', 'abc', 'abcdefg'):
+            binary = crous.dumps([prefix, data])
+            offset = binary.index((7).to_bytes(8, 'little'))
+            assert offset % 8 == 0
+            assert crous.loads(binary) == [prefix, data]
+
+    def test_byte_buffers_stay_bytes(self):
+        """Test a memoryview over bytes still encodes as bytes."""
+        assert crous.loads(crous.dumps(memoryview(b'abc'))) == b'abc'
+
+    def test_arrays_nested_and_streamed(self):
+        """Test arrays inside containers over loads and loads_stream."""
+        import array
+        data = {'x': array.array('d', [1.0, 2.0]), 'ids': [array.array('q')]}
+        binary = crous.dumps(data)
+        assert crous.loads(binary) == data
+        assert crous.loads_stream(io.BytesIO(binary)) == data
+
+    def test_unsupported_buffer_format(self):
+        """Test uint64 buffers are not silently reinterpreted."""
+        import array
+        with pytest.raises(crous.CrousEncodeError):
+            crous.dumps(array.array('Q', [1, 2]))
+
+    def test_malformed_array_rejected(self):
+        """Test bad padding and truncated element data are rejected."""
+        import array
+        binary = crous.dumps(array.array('d', [1.0, 2.0, 3.0]))
+        bad_pad = binary[:8] + b'\x08' + binary[9:]
+        dirty_pad = binary[:9] + b'\x01' + binary[10:]
+        for bad in (bad_pad, dirty_pad, binary[:-1]):
+            with pytest.raises(crous.CrousDecodeError):
+                crous.loads(bad)
+
+
+class TestLazyLoads:
+    """Test on-demand access through crous.loads_lazy."""
+
+    RECORDS = {
+        'items': [{'id': i, 'sku': 'S%03d' % i, 'price': i * 0.5, 'ok': i % 2 == 0}
+                  for i in range(50)],
+        'meta': {'user': {'id': 42, 'name': 'ada'}, 'tags': {1, 2}},
+        'blob': b'\x00' * 100,
+    }
+
+    @pytest.mark.parametrize('options', [{}, {'key_refs': True}, {'columnar': True}])
+    def test_matches_loads(self, options):
+        """Test lazy access agrees with a full decode in every wire mode."""
+        binary = crous.dumps(self.RECORDS, **options)
+        doc = crous.loads_lazy(binary)
+        assert doc['meta']['user']['id'] == 42
+        assert doc['items'][-1]['sku'] == 'S049'
+        assert [row['id'] for row in doc['items']] == list(range(50))
+        assert doc == crous.loads(binary)
+        assert doc.to_python() == crous.loads(binary)
+
+    def test_proxies(self):
+        """Test containers come back as read-only mapping and sequence views."""
+        from collections.abc import Mapping, Sequence
+        doc = crous.loads_lazy(crous.dumps(self.RECORDS))
+        assert isinstance(doc, crous.LazyDict)
+        assert isinstance(doc, Mapping)
+        assert isinstance(doc['items'], crous.LazyList)
+        assert isinstance(doc['items'], Sequence)
+        assert len(doc) == 3
+        assert len(doc['items']) == 50
+        assert doc['meta']['tags'] == {1, 2}
+        assert doc['blob'] == b'\x00' * 100
+
+    def test_lookup_errors(self):
+        """Test missing keys and indexes raise the usual exceptions."""
+        doc = crous.loads_lazy(crous.dumps(self.RECORDS))
+        assert 'meta' in doc
+        assert 'missing' not in doc
+        assert doc.get('missing', 7) == 7
+        with pytest.raises(KeyError):
+            doc['missing']
+        with pytest.raises(IndexError):
+            doc['items'][50]
+
+    def test_slices_and_keys(self):
+        """Test slicing a list and listing dict keys."""
+        doc = crous.loads_lazy(crous.dumps({'a': [0, 1, 2, 3, 4], 'b': None}))
+        assert doc['a'][1:4] == [1, 2, 3]
+        assert doc['a'][::-2] == [4, 2, 0]
+        assert list(doc) == ['a', 'b']
+        assert doc.keys() == ['a', 'b']
+        assert doc.items()[1] == ('b', None)
+
+    def test_packed_array_and_scalar_root(self):
+        """Test packed arrays decode to array.array and scalars come back as is."""
+        import array
+        data = array.array('d', [1.0, 2.0])
+        assert crous.loads_lazy(crous.dumps({'x': data}))['x'] == data
+        assert crous.loads_lazy(crous.dumps(5)) == 5
+        assert crous.loads_lazy(crous.dumps('text')) == 'text'
+
+    def test_truncated_input(self):
+        """Test damage past the accessed fields surfaces when it is reached."""
+        binary = crous.dumps({'a': 1, 'b': 'x' * 50})
+        doc = crous.loads_lazy(binary[:-10])
+        assert doc['a'] == 1
+        with pytest.raises(crous.CrousDecodeError):
+            doc['b']
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads_lazy(b'FLUX\x7f\x00')
+
+    def test_rewalk_with_empty_key(self):
+        """Test walking a stretch again does not register an empty key twice."""
+        data = [{'a': 1, '': 2}, {'q': 3}, {'q': 4}]
+        doc = crous.loads_lazy(crous.dumps(data, key_refs=True))
+        assert doc[0].items() == [('a', 1), ('', 2)]
+        assert doc[0].items() == [('a', 1), ('', 2)]
+        assert doc[1]['q'] == 3
+        assert doc[2].keys() == ['q']
+
+
+class TestFieldProjection:
+    """Test loads(data, fields=...) decoding only selected paths."""
+
+    RECORDS = [{'id': i, 'sku': 'S%d' % i, 'price': i * 0.5, 'ok': i % 2 == 0,
+                'user': {'id': 100 + i, 'name': 'n%d' % i}, 'extra': list(range(i))}
+               for i in range(6)]
+
+    @pytest.mark.parametrize('options', [{}, {'key_refs': True}, {'columnar': True}])
+    def test_selects_paths(self, options):
+        """Test only the selected fields come back, in every wire mode."""
+        binary = crous.dumps({'items': self.RECORDS, 'count': 6}, **options)
+        result = crous.loads(binary, fields=['items[*].sku', 'items[*].user.id', 'count'])
+        assert result == {
+            'items': [{'sku': r['sku'], 'user': {'id': r['user']['id']}} for r in self.RECORDS],
+            'count': 6,
+        }
+
+    def test_index_and_star_merge(self):
+        """Test an indexed path adds to what [*] selects for that element."""
+        binary = crous.dumps(self.RECORDS, columnar=True)
+        result = crous.loads(binary, fields=['[*].id', '[2].price'])
+        assert result[2] == {'id': 2, 'price': 1.0}
+        assert result[3] == {'id': 3}
+        assert crous.loads(binary, fields=['[4]']) == [self.RECORDS[4]]
+
+    def test_missing_paths_left_out(self):
+        """Test absent keys, out-of-range indices and steps into scalars."""
+        binary = crous.dumps({'a': 1, 'b': [1, 2], 't': (1, 2, 3)})
+        assert crous.loads(binary, fields=['zzz', 'b[5]', 'a.x', 't[1]']) == {'b': [], 't': (2,)}
+        assert crous.loads(binary, fields=['[0]']) is None
+
+    def test_tagged_and_packed_values(self):
+        """Test whole tagged values and packed array elements."""
+        import array
+        binary = crous.dumps({'s': {1, 2}, 'x': array.array('d', [1.0, 2.0, 3.0])})
+        assert crous.loads(binary, fields=['s']) == {'s': {1, 2}}
+        result = crous.loads(binary, fields=['x[2]', 'x[0]'])
+        assert result['x'] == array.array('d', [1.0, 3.0])
+
+    def test_invalid_paths(self):
+        """Test malformed paths and argument types are rejected."""
+        binary = crous.dumps({'a': 1})
+        for bad in ('', 'a.', '.a', 'a[', 'a[x]', 'a..b', 'a[-1]'):
+            with pytest.raises(ValueError):
+                crous.loads(binary, fields=[bad])
+        with pytest.raises(TypeError):
+            crous.loads(binary, fields='a')
+        with pytest.raises(TypeError):
+            crous.loads(binary, fields=[1])
+
+    def test_truncated_input(self):
+        """Test skipped parts are still checked."""
+        binary = crous.dumps({'a': 'x' * 50, 'b': 1})
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(binary[:-5], fields=['b'])
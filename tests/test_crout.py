@@ -301,6 +301,77 @@ class TestCroutTokenTable:
         assert not any("=rare2" in l for l in token_lines)
         assert crous.loads_text(text) == data
 
+    def test_wide_schema_gets_multichar_tokens(self):
+        """Once the 1-char tokens run out, tokens grow to 2 characters."""
+        keys = [f"column_{i:03d}" for i in range(300)]
+        data = [{k: i for i, k in enumerate(keys)} for _ in range(4)]
+        text = crous.dumps_text(data)
+        token_lines = [l for l in text.split("\n") if l.startswith("@ ")]
+        assert len(token_lines) == 300
+        toks = [l[2:].split("=", 1)[0] for l in token_lines]
+        assert len(set(toks)) == 300
+        assert sum(len(t) == 1 for t in toks) == 54
+        assert all(len(t) == 2 for t in toks[54:])
+        assert crous.loads_text(text) == data
+        assert len(text) < len(crous.dumps_text(data, use_tokens=False))
+
+    def test_most_frequent_keys_get_short_tokens(self):
+        """A frequent key first seen late still gets a 1-char token."""
+        data = [{f"once_{i}": i, f"twice_{i}": i} for i in range(100)]
+        data += [{f"twice_{i}": i} for i in range(100)]
+        data += [{"hot": i} for i in range(50)]
+        text = crous.dumps_text(data)
+        token_lines = [l for l in text.split("\n") if l.startswith("@ ")]
+        assert token_lines[0][2:].split("=", 1) == [token_lines[0][2], "hot"]
+        assert not any("=once_" in l for l in token_lines)
+        assert crous.loads_text(text) == data
+
+    def test_flux_to_text_matches_wide_token_table(self):
+        """FLUX -> text builds the same wide table as dumps_text."""
+        keys = [f"k{i}" for i in range(120)]
+        data = [{k: None for k in keys}, {k: True for k in keys}]
+        text = crous.dumps_text(data)
+        assert crous.flux_to_text(crous.text_to_flux(text)) == text
+
+    def test_token_sample_counts_leading_dicts_only(self):
+        """token_sample=N builds the table from the first N dicts."""
+        data = [{"head": 1, "both": 2}] * 3 + [{"tail": 3, "both": 4}] * 10
+        text = crous.dumps_text(data, token_sample=3)
+        token_lines = [l for l in text.split("\n") if l.startswith("@ ")]
+        assert any("=head" in l for l in token_lines)
+        assert not any("=tail" in l for l in token_lines)
+        assert crous.loads_text(text) == data
+        assert "=tail" in crous.dumps_text(data)
+
+    def test_token_sample_matches_flux_to_text(self):
+        """The FLUX -> text path samples the same dicts."""
+        data = [{"a": {"b": 1, "c": [{"d": 2}]}, "e": 3}] * 4 + [{"z": 1}] * 4
+        for n in (1, 2, 3, 5, 9, 100):
+            text = crous.dumps_text(data, token_sample=n)
+            assert crous.flux_to_text(crous.dumps(data), token_sample=n) == text
+            assert crous.loads_text(text) == data
+
+    def test_fixed_tokens(self):
+        """tokens= uses the caller's table as given, in order."""
+        data = [{"name": "a", "other": 1}, {"name": "b", "other": 2}]
+        text = crous.dumps_text(data, tokens=["name", "unused"])
+        assert text.startswith("CROUT1\n@ a=name\n@ c=unused\n")
+        assert "=other" not in text
+        assert crous.loads_text(text) == data
+
+    def test_fixed_tokens_reused_across_documents(self):
+        """One key list serves many documents, single keys included."""
+        keys = [f"k{i}" for i in range(80)]
+        for i in range(5):
+            doc = {keys[i]: i, keys[79 - i]: -i}
+            text = crous.dumps_text(doc, tokens=keys)
+            assert crous.loads_text(text) == doc
+            assert "s2:" not in text and "s3:" not in text
+
+    def test_fixed_tokens_rejects_non_str(self):
+        with pytest.raises(TypeError):
+            crous.dumps_text({"a": 1}, tokens=["a", 1])
+
 
 # =============================================================================
 # Pretty mode
@@ -421,6 +492,77 @@ class TestCroutFluxConversion:
         assert result["coords"] == (1, 2, 3)
         assert isinstance(result["coords"], tuple)
 
+    @pytest.mark.parametrize("data", [
+        {"key": [1, 2, 3], "nested": {"a": True, "b": None}},
+        [{"name": "a", "id": i, "raw": b"\x00\xff"} for i in range(20)],
+        (1, -2.5, float("inf"), "s", ()),
+        {"s1": {}, "": [], "with space": [[], {}]},
+    ])
+    def test_text_to_flux_matches_tree(self, data):
+        text = crous.dumps_text(data, pretty=True)
+        assert crous.text_to_flux(text) == crous.dumps(crous.loads_text(text))
+
+    @pytest.mark.parametrize("use_tokens,pretty", [
+        (False, False), (False, True), (True, False), (True, True),
+    ])
+    def test_flux_to_text_matches_dumps_text(self, use_tokens, pretty):
+        data = {"rows": [{"name": "n%d" % i, "v": i * 0.5} for i in range(10)],
+                "t": (1, [2, (3,)]), "e": {}}
+        text = crous.flux_to_text(crous.dumps(data), use_tokens=use_tokens, pretty=pretty)
+        assert text == crous.dumps_text(data, use_tokens=use_tokens, pretty=pretty)
+
+    def test_flux_to_text_tables_and_packed_arrays(self):
+        rows = [{"a": i, "b": str(i)} for i in range(40)]
+        assert crous.flux_to_text(crous.dumps(rows, columnar=True)) == crous.dumps_text(rows)
+        nums = {"i": list(range(64)), "f": [0.25] * 64}
+        assert crous.flux_to_text(crous.dumps(nums)) == crous.dumps_text(nums)
+
+    def test_flux_to_text_compressed(self):
+        data = [{"k": i} for i in range(2000)]
+        assert crous.flux_to_text(crous.dumps(data, compression="lz4")) == crous.dumps_text(data)
+
+    def test_tagged_round_trip_text(self):
+        text = "CROUT1\n[#0:s5:hello , #1:#2:(i1 , N) , #7:{s1:a:[i1]}]"
+        assert crous.flux_to_text(crous.text_to_flux(text), use_tokens=False) == text
+
+    def test_stream_to_file(self):
+        import io
+        data = [{"name": "x" * 50, "id": i} for i in range(3000)]
+        text = crous.dumps_text(data)
+        out = io.BytesIO()
+        assert crous.text_to_flux(text, fp=out) is None
+        assert out.getvalue() == crous.text_to_flux(text)
+        out = io.BytesIO()
+        assert crous.flux_to_text(crous.dumps(data), fp=out) is None
+        assert out.getvalue().decode() == text
+
+    def test_stream_write_error_propagates(self):
+        class Broken:
+            def write(self, b):
+                raise OSError("disk full")
+        with pytest.raises(OSError):
+            crous.text_to_flux(crous.dumps_text([1, 2]), fp=Broken())
+        with pytest.raises(OSError):
+            crous.flux_to_text(crous.dumps([1, 2]), fp=Broken())
+
+    @pytest.mark.parametrize("text", [
+        "CROUT1\n[i1 , ",
+        "CROUT1\n{a i1}",
+        "CROUT1\n[i1 , x]",
+        "CROUT1\n" + "[" * 300 + "]" * 300,
+        "nope",
+    ])
+    def test_text_to_flux_malformed(self, text):
+        with pytest.raises(crous.CrousError):
+            crous.text_to_flux(text)
+
+    def test_flux_to_text_malformed(self):
+        good = crous.dumps({"a": [1, 2, 3]})
+        with pytest.raises(crous.CrousError):
+            crous.flux_to_text(good[:-2])
+        with pytest.raises(crous.CrousError):
+            crous.flux_to_text(b"junk")
+
 
 # =============================================================================
 # Tagged values
@@ -566,6 +708,19 @@ class TestCroutEdgeCases:
         result = crous.loads_text(text)
         assert result == [1, 2, 3]
 
+    def test_long_whitespace_runs(self):
+        """Whitespace runs of any length, across block boundaries, are skipped."""
+        for n in (1, 15, 16, 17, 31, 32, 33, 100):
+            gap = (" \t\r\n" * n)[:n]
+            text = "CROUT1\n" + gap + "[" + gap + "i1" + gap + "," + gap + "i2" + gap + "]" + gap
+            assert crous.loads_text(text) == [1, 2]
+
+    def test_long_literal_token_key(self):
+        """Unresolved token keys of any length are read as literal keys."""
+        for n in (1, 16, 31, 32, 33, 70):
+            key = ("abc_XYZ_0123456789" * 5)[:n]
+            assert crous.loads_text("CROUT1\n{" + key + ":i1 , z:i2}") == {key: 1, "z": 2}
+
 
 # =============================================================================
 # Cross-format consistency
@@ -74,16 +74,18 @@ class TestCustomSerializerRegistration:
 
     def test_unregister_serializer(self):
         """Test unregistering a custom serializer."""
+        class Point:
+            pass
+
         def serializer(obj):
             return 'serialized'
         
-        crous.register_serializer(datetime, serializer)
-        crous.unregister_serializer(datetime)
+        crous.register_serializer(Point, serializer)
+        crous.unregister_serializer(Point)
         
-        # After unregistering, datetime should fail
-        data = datetime.now()
+        # After unregistering, Point should fail
         with pytest.raises(crous.CrousEncodeError):
-            crous.dumps(data)
+            crous.dumps(Point())
 
 
 class TestCustomDecoderRegistration:
@@ -264,3 +266,54 @@ class TestSerializerRoundTrip:
             assert result['age'] == 30
         finally:
             crous.unregister_serializer(Person)
+
+
+class TestSerializerResolution:
+    """Test that cached type resolution follows the registry."""
+
+    def test_encoder_sees_later_registrations(self):
+        """A CrousEncoder picks up serializers registered after its first call."""
+        class Token:
+            pass
+
+        encoder = crous.CrousEncoder()
+        crous.register_serializer(Token, lambda obj: 'first')
+        try:
+            assert crous.loads(encoder.encode([Token(), Token()])) == ['first', 'first']
+            crous.register_serializer(Token, lambda obj: 'second')
+            assert crous.loads(encoder.encode([Token()])) == ['second']
+        finally:
+            crous.unregister_serializer(Token)
+        with pytest.raises(crous.CrousEncodeError):
+            encoder.encode([Token()])
+
+    def test_many_types_in_one_call(self):
+        """More distinct types than the resolution cache holds."""
+        classes = [type('T%d' % i, (), {}) for i in range(80)]
+        for cls in classes:
+            crous.register_serializer(cls, lambda obj: type(obj).__name__)
+        try:
+            objs = [cls() for cls in classes] * 3
+            expected = [type(obj).__name__ for obj in objs]
+            assert crous.loads(crous.dumps(objs)) == expected
+            assert crous.loads(crous.CrousEncoder().encode(objs)) == expected
+        finally:
+            for cls in classes:
+                crous.unregister_serializer(cls)
+
+    def test_subclass_resolves_to_base_serializer(self):
+        """Subclasses use the nearest registered base until registered themselves."""
+        class Base:
+            pass
+
+        class Child(Base):
+            pass
+
+        crous.register_serializer(Base, lambda obj: 'base')
+        try:
+            assert crous.loads(crous.dumps([Child(), Base()])) == ['base', 'base']
+            crous.register_serializer(Child, lambda obj: 'child')
+            assert crous.loads(crous.dumps([Child(), Base()])) == ['child', 'base']
+        finally:
+            crous.unregister_serializer(Child)
+            crous.unregister_serializer(Base)
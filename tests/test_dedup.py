@@ -0,0 +1,132 @@
+"""
+test_dedup.py - Shared-value back-references (wire v5)
+
+Tests dumps(dedup=True): round trips through every reader, the size saved
+on repeated subtrees, independent objects per occurrence, and that
+malformed or exponentially expanding SHARE/REF documents are rejected.
+"""
+
+import io
+
+import pytest
+import crous
+
+
+SHARE, REF, LIST, STRING = 0x0E, 0x0F, 0x07, 0x05
+V5 = b'FLUX\x05\x00'
+
+
+def record(i):
+    return {
+        'name': 'a fairly long string value',
+        'tags': [i % 3, 'tag-x'],
+        'meta': {'owner': 'ops', 'limits': [1, 2, 3]},
+    }
+
+
+RECORDS = [record(i) for i in range(50)]
+
+
+def laughs(levels):
+    """A list whose item k is two REFs to item k - 1: 2**levels leaves."""
+    out = bytes([LIST, levels + 1, SHARE, STRING, 4]) + b'abcd'
+    for k in range(1, levels + 1):
+        out += bytes([SHARE, LIST, 2, REF, k - 1, REF, k - 1])
+    return V5 + out
+
+
+class TestDedupRoundTrip:
+    """dumps(dedup=True) read back by each decoder."""
+
+    def test_round_trip_and_size(self):
+        plain = crous.dumps(RECORDS)
+        deduped = crous.dumps(RECORDS, dedup=True)
+        assert deduped[4] == crous.version.WIRE_V5
+        assert len(deduped) < len(plain) / 5
+        assert crous.loads(deduped) == RECORDS
+
+    @pytest.mark.parametrize('value', [
+        None, 7, 'abc', ['abcd', 'abcd'], [b'\x00' * 8] * 5,
+        [(1, 2), [1, 2], (1, 2)], {'a': {1, 2}, 'b': {1, 2}},
+        [[[1], [1]], [[1], [1]]], list(range(10)) * 3, [1.0, 1, True, 1.0],
+    ])
+    def test_values(self, value):
+        assert crous.loads(crous.dumps(value, dedup=True)) == value
+
+    def test_occurrences_are_separate_objects(self):
+        result = crous.loads(crous.dumps(RECORDS, dedup=True))
+        result[0]['meta']['limits'].append(4)
+        assert result[1]['meta']['limits'] == [1, 2, 3]
+
+    def test_object_hook_sees_every_occurrence(self):
+        seen = []
+        crous.loads(crous.dumps([{'k': 'v'}] * 4, dedup=True), object_hook=lambda d: seen.append(d) or d)
+        assert len(seen) == 4
+
+    def test_with_columnar_tables(self):
+        data = {'rows': RECORDS, 'copy': RECORDS[:3]}
+        assert crous.loads(crous.dumps(data, dedup=True, columnar=True)) == data
+
+    def test_other_readers(self):
+        data = crous.dumps(RECORDS, dedup=True)
+        assert list(crous.iter_loads(io.BytesIO(data))) == [RECORDS]
+        assert crous.loads_lazy(data)[7]['meta']['limits'][2] == 3
+        assert crous.loads(data, fields=['[*].tags']) == [{'tags': r['tags']} for r in RECORDS]
+
+    def test_in_envelopes(self):
+        data = crous.dumps(RECORDS, dedup=True)
+        envelope = crous.dumps(RECORDS, dedup=True, compression='lz4', checksum=True)
+        assert crous.loads(envelope) == crous.loads(data)
+
+    @pytest.mark.parametrize('options', [{}, {'key_refs': True}])
+    def test_reread_with_empty_key(self, options):
+        """A REF read again does not register its empty key twice."""
+        row = {'é': True, 'b': True, '': 0.79}
+        data = [[[row], [dict(row)]], [{'value2': {'wide': {}}, 'id2': [{'dup': {'wide': {'k7': 7}}}]}]]
+        binary = crous.dumps(data, dedup=True, **options)
+        assert crous.loads(binary, fields=['[*]']) == data
+        assert crous.loads_text(crous.flux_to_text(binary)) == data
+
+    def test_self_reference_raises(self):
+        a = []
+        a.append(a)
+        with pytest.raises(crous.CrousEncodeError, match='nesting depth'):
+            crous.dumps(a, dedup=True)
+
+    def test_too_deep_raises(self):
+        data = []
+        for _ in range(50000):
+            data = [data]
+        with pytest.raises(crous.CrousEncodeError, match='nesting depth'):
+            crous.dumps(data, dedup=True)
+        with pytest.raises(crous.CrousEncodeError, match='nesting depth of 10 '):
+            crous.dumps(data, dedup=True, max_depth=10)
+
+
+class TestDedupMalformed:
+    """SHARE/REF misuse and expansion limits."""
+
+    @pytest.mark.parametrize('data', [
+        V5 + bytes([LIST, 1, REF, 0]),
+        V5 + bytes([SHARE, LIST, 1, REF, 0]),
+        V5 + bytes([SHARE, SHARE, STRING, 4]) + b'abcd',
+        V5 + bytes([LIST, 2, SHARE, STRING, 4]) + b'abcd' + bytes([SHARE, REF, 0]),
+        b'FLUX\x04\x00' + bytes([SHARE, STRING, 4]) + b'abcd',
+    ])
+    def test_rejected(self, data):
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(data)
+        with pytest.raises(crous.CrousDecodeError):
+            list(crous.iter_loads(io.BytesIO(data)))
+
+    def test_small_expansion_allowed(self):
+        assert crous.loads(laughs(4))[4] == [[[['abcd'] * 2] * 2] * 2] * 2
+
+    def test_exponential_expansion_rejected(self):
+        data = laughs(60)
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(data)
+        with pytest.raises(crous.CrousDecodeError):
+            list(crous.iter_loads(io.BytesIO(data)))
+        with pytest.raises(crous.CrousDecodeError):
+            crous.visit(data, object())
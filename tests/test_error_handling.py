@@ -68,6 +68,24 @@ class TestDecodeErrors:
         with pytest.raises(crous.CrousDecodeError):
             crous.loads(b'\x03\x00')  # Int type but incomplete
 
+    def test_oversized_container_count(self):
+        """Test container counts larger than the remaining input are rejected."""
+        header = b'FLUX\x01\x00'
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(header + b'\x07\xff\xff\xff\x1f')  # List of ~64M
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(header + b'\x08\xff\xff\xff\x1f')  # Dict of ~64M
+
+    def test_malformed_varint(self):
+        """Test varints that run past 10 bytes or past the input are rejected."""
+        header = b'FLUX\x01\x00'
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(header + b'\x03' + b'\xff' * 11)
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(header + b'\x03' + b'\xff' * 10 + b'\x01' * 8)
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(header + b'\x03\x80')
+
 
 class TestEncodeErrors:
     """Test encoding error conditions."""
@@ -108,19 +126,27 @@ class TestEncodeErrors:
         assert decoded == data
         assert isinstance(decoded, frozenset)
 
-    def test_unsupported_type_datetime(self):
-        """Test that datetime cannot be encoded without custom serializer."""
+    def test_native_type_datetime(self):
+        """Test that datetime is encoded natively without a custom serializer."""
         from datetime import datetime
         data = datetime.now()
-        with pytest.raises(crous.CrousEncodeError):
-            crous.dumps(data)
+        assert crous.loads(crous.dumps(data)) == data
 
-    def test_unsupported_type_decimal(self):
-        """Test that Decimal cannot be encoded without custom serializer."""
+    def test_native_type_decimal(self):
+        """Test that Decimal is encoded natively without a custom serializer."""
         from decimal import Decimal
         data = Decimal('3.14')
+        assert crous.loads(crous.dumps(data)) == data
+
+    def test_unsupported_type_datetime_subclass(self):
+        """Test that datetime subclasses still need a custom serializer."""
+        from datetime import datetime
+
+        class MyDatetime(datetime):
+            pass
+
         with pytest.raises(crous.CrousEncodeError):
-            crous.dumps(data)
+            crous.dumps(MyDatetime(2024, 1, 1))
 
     def test_unsupported_type_custom_class(self):
         """Test that custom classes raise error."""
@@ -131,6 +157,28 @@ class TestEncodeErrors:
         with pytest.raises(crous.CrousEncodeError):
             crous.dumps(data)
 
+    def test_dict_mutated_by_default_func(self):
+        """Test that a dict resized by default() mid-encode raises cleanly."""
+        data = {'a': object(), 'b': 1}
+
+        def default(obj):
+            data['c'] = 2
+            return 'x'
+
+        with pytest.raises(RuntimeError):
+            crous.dumps(data, default=default)
+
+    def test_list_shrunk_by_default_func(self):
+        """Test that a list shrunk by default() mid-encode raises cleanly."""
+        data = [object(), 1, 2]
+
+        def default(obj):
+            del data[1:]
+            return 'x'
+
+        with pytest.raises(IndexError):
+            crous.dumps(data, default=default)
+
 
 class TestFileErrors:
     """Test file I/O error conditions."""
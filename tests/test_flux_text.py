@@ -0,0 +1,338 @@
+"""
+test_flux_text.py - FLUX text lexer and parser (crous_flux.h)
+
+The FLUX text reader has no Python binding, so these tests drive it
+through ctypes on the built extension. The parser consumes tokens in
+struct-of-arrays batches from flux_lexer_next_batch(); the tests check
+that the batches carry exactly the stream flux_lexer_next() returns one
+token at a time, on valid and on fuzzed text, across batch boundaries,
+and that documents parsed from batches match the data they were written
+from.
+"""
+
+import ctypes
+import random
+import sys
+
+import pytest
+import crous
+
+
+CROUS_OK = 0
+TOK_EOF, TOK_ERROR = 0, 16
+BATCH_SIZE = 1024
+(T_NULL, T_BOOL, T_INT, T_FLOAT, T_STRING, T_BYTES,
+ T_LIST, T_TUPLE, T_DICT) = range(9)
+
+
+class Token(ctypes.Structure):
+    _fields_ = [('type', ctypes.c_int),
+                ('value', ctypes.c_void_p),
+                ('value_len', ctypes.c_size_t),
+                ('line', ctypes.c_int),
+                ('column', ctypes.c_int)]
+
+
+class TokenBatch(ctypes.Structure):
+    _fields_ = [('base', ctypes.c_void_p),
+                ('base_pos', ctypes.c_size_t),
+                ('count', ctypes.c_size_t),
+                ('type', ctypes.c_uint8 * BATCH_SIZE),
+                ('offset', ctypes.c_uint32 * BATCH_SIZE),
+                ('length', ctypes.c_uint32 * BATCH_SIZE),
+                ('line', ctypes.c_uint32 * BATCH_SIZE)]
+
+
+class DictEntry(ctypes.Structure):
+    _fields_ = [('key', ctypes.c_void_p),
+                ('key_len', ctypes.c_size_t),
+                ('value', ctypes.c_void_p)]
+
+
+def load_api():
+    lib = ctypes.CDLL(sys.modules['crous.crous'].__file__)
+    vp, size_t = ctypes.c_void_p, ctypes.c_size_t
+    sigs = {
+        'flux_lexer_new': (vp, [ctypes.c_char_p, size_t]),
+        'flux_lexer_free': (None, [vp]),
+        'flux_lexer_next': (ctypes.POINTER(Token), [vp]),
+        'flux_lexer_next_batch': (size_t, [vp, ctypes.POINTER(TokenBatch)]),
+        'flux_decode_text': (ctypes.c_int, [ctypes.c_char_p, size_t, ctypes.POINTER(vp)]),
+        'flux_encode_text': (ctypes.c_int, [vp, ctypes.POINTER(vp), ctypes.POINTER(size_t)]),
+        'flux_decode_binary': (ctypes.c_int, [ctypes.c_char_p, size_t, ctypes.POINTER(vp)]),
+        'crous_value_equal': (ctypes.c_int, [vp, vp]),
+        'crous_value_free_tree': (None, [vp]),
+        'crous_value_get_type': (ctypes.c_int, [vp]),
+        'crous_value_get_bool': (ctypes.c_int, [vp]),
+        'crous_value_get_int': (ctypes.c_int64, [vp]),
+        'crous_value_get_float': (ctypes.c_double, [vp]),
+        'crous_value_get_string': (vp, [vp, ctypes.POINTER(size_t)]),
+        'crous_value_dict_size': (size_t, [vp]),
+        'crous_value_dict_get_entry': (ctypes.POINTER(DictEntry), [vp, size_t]),
+    }
+    for name, (res, args) in sigs.items():
+        fn = getattr(lib, name)
+        fn.restype, fn.argtypes = res, args
+    return lib
+
+
+API = load_api()
+LIBC = ctypes.CDLL(None)
+LIBC.free.argtypes = [ctypes.c_void_p]
+
+
+def token_limit(src):
+    # Every token but EOF consumes input, so a longer stream is a hang
+    return 2 * len(src) + 16
+
+
+def tokens_one_by_one(src):
+    lexer = API.flux_lexer_new(src, len(src))
+    out = []
+    try:
+        while True:
+            tok = API.flux_lexer_next(lexer).contents
+            # Error tokens carry a message, not a span of the text
+            value = (ctypes.string_at(tok.value, tok.value_len)
+                     if tok.value and tok.value_len and tok.type != TOK_ERROR else b'')
+            out.append((tok.type, value, tok.line))
+            if tok.type == TOK_EOF:
+                return out
+            assert len(out) < token_limit(src)
+    finally:
+        API.flux_lexer_free(lexer)
+
+
+def tokens_batched(src):
+    """Returns the token list and the number of batches it came in."""
+    lexer = API.flux_lexer_new(src, len(src))
+    batch = TokenBatch()
+    out, batches = [], 0
+    try:
+        while True:
+            n = API.flux_lexer_next_batch(lexer, ctypes.byref(batch))
+            assert 1 <= n == batch.count <= BATCH_SIZE
+            batches += 1
+            for i in range(n):
+                length = batch.length[i]
+                value = ctypes.string_at(batch.base + batch.offset[i], length) if length else b''
+                out.append((batch.type[i], value, batch.line[i]))
+            if out[-1][0] == TOK_EOF:
+                assert TOK_EOF not in [t for t, _, _ in out[:-1]]
+                return out, batches
+            assert n == BATCH_SIZE
+            assert len(out) < token_limit(src)
+    finally:
+        API.flux_lexer_free(lexer)
+
+
+def to_py(v):
+    t = API.crous_value_get_type(v)
+    if t == T_NULL:
+        return None
+    if t == T_BOOL:
+        return bool(API.crous_value_get_bool(v))
+    if t == T_INT:
+        return API.crous_value_get_int(v)
+    if t == T_FLOAT:
+        return API.crous_value_get_float(v)
+    if t == T_STRING:
+        n = ctypes.c_size_t()
+        p = API.crous_value_get_string(v, ctypes.byref(n))
+        return ctypes.string_at(p, n.value).decode() if n.value else ''
+    if t == T_DICT:
+        out = {}
+        for i in range(API.crous_value_dict_size(v)):
+            e = API.crous_value_dict_get_entry(v, i).contents
+            out[ctypes.string_at(e.key, e.key_len).decode()] = to_py(e.value)
+        return out
+    raise AssertionError('unexpected type %d' % t)
+
+
+def decode_text(src):
+    root = ctypes.c_void_p()
+    err = API.flux_decode_text(src, len(src), ctypes.byref(root))
+    if err != CROUS_OK:
+        return err, None
+    try:
+        return err, to_py(root)
+    finally:
+        API.crous_value_free_tree(root)
+
+
+# Lengths around the 16/32-byte widths of the quote and blank scans
+STRING_LENGTHS = list(range(0, 70)) + [127, 128, 129, 1000]
+ALPHABET = 'abcXYZ019 _-.,;:#@[]{}\t' + '\u00e9\u2603'
+
+
+def random_scalar(rng):
+    kind = rng.randrange(6)
+    if kind == 0:
+        return rng.randrange(-2 ** 63, 2 ** 63)
+    if kind == 1:
+        return rng.choice([0.5, -2.25, 1e-05, 1.5e+300]) * rng.randrange(1, 1000)
+    if kind == 2:
+        return rng.choice([True, False])
+    if kind == 3:
+        return None
+    n = rng.choice(STRING_LENGTHS)
+    return ''.join(rng.choice(ALPHABET) for _ in range(n))
+
+
+def scalar_text(value):
+    if value is None:
+        return 'null'
+    if value is True or value is False:
+        return 'true' if value else 'false'
+    if isinstance(value, str):
+        return '"%s"' % value
+    return repr(value)
+
+
+def record_text(record, rng):
+    """FLUX text for a flat record, with varied blanks, blank lines and
+    comments between entries."""
+    lines = []
+    for key, value in record.items():
+        if rng.random() < 0.1:
+            lines.append('# %s' % key)
+        if rng.random() < 0.1:
+            lines.append('')
+        pad = rng.choice(['', ' ', '\t', '   ', ' ' * 40])
+        lines.append('%s%s:%s%s%s' % (key, rng.choice(['', ' ']), rng.choice([' ', '\t', '  ']),
+                                       scalar_text(value), pad))
+    return ('\n'.join(lines) + rng.choice(['', '\n', '\n\n'])).encode()
+
+
+def random_record(rng, n):
+    return {'k%d_%s' % (i, rng.choice(['a', 'Bc', 'x_9'])): random_scalar(rng) for i in range(n)}
+
+
+class TestTokenBatches:
+    """flux_lexer_next_batch() against flux_lexer_next()."""
+
+    @pytest.mark.parametrize('src', [
+        b'',
+        b'\n\n\n',
+        b'a: 1',
+        b'a: 1\nb: "x y"\nc: [int]\n  1\n  2\nd: -2.5\ne: null\n# c\nf: true\n',
+        b'a: "unterminated\nb: 1\n',
+        b'"' + b'x' * 70,
+        b'a: @sym\nb: $\n\x00\xff: 1\n',
+        b'    \t  a:\n\t\t\tb: 1\n  c: 2\n',
+        b'[[[[[[]]]]]]',
+        b':::' * 700,
+    ])
+    def test_fixed_inputs(self, src):
+        batched, _ = tokens_batched(src)
+        assert batched == tokens_one_by_one(src)
+
+    @pytest.mark.parametrize('seed', range(8))
+    def test_valid_documents(self, seed):
+        rng = random.Random(seed)
+        src = record_text(random_record(rng, rng.randrange(1, 900)), rng)
+        batched, _ = tokens_batched(src)
+        assert batched == tokens_one_by_one(src)
+
+    @pytest.mark.parametrize('seed', range(40))
+    def test_fuzzed_documents(self, seed):
+        rng = random.Random(1000 + seed)
+        src = bytearray(record_text(random_record(rng, rng.randrange(1, 500)), rng))
+        noise = b'"\\\n\r\t :#@[]{}-.e0123456789aZ_\x00\x7f\xff'
+        for _ in range(rng.randrange(1, 40)):
+            pos = rng.randrange(len(src) + 1)
+            op = rng.randrange(3)
+            if op == 0:
+                src[pos:pos] = bytes(rng.choice(noise) for _ in range(rng.randrange(1, 4)))
+            elif op == 1:
+                del src[pos:pos + rng.randrange(1, 8)]
+            elif pos < len(src):
+                src[pos] = rng.choice(noise)
+        src = bytes(src)
+        batched, _ = tokens_batched(src)
+        assert batched == tokens_one_by_one(src)
+
+    @pytest.mark.parametrize('entries', [341, 342, 682, 683, 2000])
+    def test_batch_boundaries(self, entries):
+        """Three tokens an entry plus EOF: 341 entries fill one batch
+        exactly, 342 spill EOF into a second"""
+        src = ''.join('k%d: %d\n' % (i, i) for i in range(entries)).encode()
+        batched, batches = tokens_batched(src)
+        assert len(batched) == entries * 3 + 1
+        assert batches == -(-len(batched) // BATCH_SIZE)
+        assert batched == tokens_one_by_one(src)
+
+    @pytest.mark.parametrize('n', STRING_LENGTHS)
+    def test_string_lengths(self, n):
+        body = ''.join(chr(ord('a') + i % 26) for i in range(n))
+        src = ('s: "%s"\nt: "%s\\"x"\n' % (body, body)).encode()
+        batched, _ = tokens_batched(src)
+        assert batched == tokens_one_by_one(src)
+        assert batched[2][1] == body.encode()
+
+
+class TestTextDocuments:
+    """Documents parsed from batches match the data they came from."""
+
+    @pytest.mark.parametrize('seed', range(12))
+    def test_random_records(self, seed):
+        rng = random.Random(seed)
+        record = random_record(rng, rng.randrange(1, 1200))
+        err, value = decode_text(record_text(record, rng))
+        assert err == CROUS_OK
+        assert value == record
+
+    @pytest.mark.parametrize('entries', [341, 342, 1500])
+    def test_records_across_batches(self, entries):
+        record = {'k%d' % i: i * 3 for i in range(entries)}
+        src = ''.join('k%d: %d\n' % (i, i * 3) for i in range(entries)).encode()
+        err, value = decode_text(src)
+        assert err == CROUS_OK
+        assert value == record
+
+    @pytest.mark.parametrize('value', [
+        None, True, -7, 2.5, '', 'root string', 'x' * 129,
+    ])
+    def test_root_scalars(self, value):
+        err, got = decode_text(scalar_text(value).encode())
+        assert err == CROUS_OK
+        assert got == value
+
+    def test_text_round_trip(self):
+        """flux_encode_text output reads back to an equal tree. The
+        encoder leaves a string bare unless it holds a blank or another
+        special byte, so strings here always carry one."""
+        rng = random.Random(7)
+        record = {}
+        for i in range(800):
+            value = random_scalar(rng)
+            if isinstance(value, str):
+                value = ' ' + value
+            elif isinstance(value, float):
+                value = i + 0.5
+            record['k%d' % i] = value
+        raw = crous.dumps(record)
+        tree = ctypes.c_void_p()
+        assert API.flux_decode_binary(raw, len(raw), ctypes.byref(tree)) == CROUS_OK
+        text, size = ctypes.c_void_p(), ctypes.c_size_t()
+        back = ctypes.c_void_p()
+        try:
+            assert API.flux_encode_text(tree, ctypes.byref(text), ctypes.byref(size)) == CROUS_OK
+            src = ctypes.string_at(text, size.value)
+            assert API.flux_decode_text(src, len(src), ctypes.byref(back)) == CROUS_OK
+            assert API.crous_value_equal(tree, back) == 1
+            assert to_py(back) == record
+        finally:
+            LIBC.free(text)
+            API.crous_value_free_tree(back)
+            API.crous_value_free_tree(tree)
+
+    @pytest.mark.parametrize('src', [
+        b'a 1\n',
+        b'a: :\n',
+        b'k0: 0\n' * 400 + b'x\n',
+        b'1 2\n',
+    ])
+    def test_malformed(self, src):
+        err, _ = decode_text(src)
+        assert err != CROUS_OK
@@ -98,3 +98,68 @@ class TestMemoryEfficiency:
             binary = crous.dumps(data)
             result = crous.loads(binary)
             assert result == data
+
+
+class TestMappedLoad:
+    """Test load() decoding regular files through a memory mapping."""
+
+    def test_load_file_object_at_offset(self, tmp_path):
+        """Test loading from a file object positioned past a prefix."""
+        data = {'items': list(range(50000)), 'name': 'x' * 100000}
+        file_path = tmp_path / "prefixed.crous"
+        with open(file_path, 'wb') as f:
+            f.write(b'HEADER--')
+            crous.dump(data, f)
+
+        with open(file_path, 'rb') as f:
+            f.seek(8)
+            assert crous.load(f) == data
+            # The file is consumed, as with a read() of the rest
+            assert f.tell() == os.path.getsize(file_path)
+            assert f.read() == b''
+
+    def test_load_after_buffered_read(self, tmp_path):
+        """Test the mapping starts at the logical, not the OS, file position."""
+        file_path = tmp_path / "buffered.crous"
+        with open(file_path, 'wb') as f:
+            f.write(b'\x00' * 3)
+            crous.dump([1, 2, 3], f)
+
+        with open(file_path, 'rb') as f:
+            assert f.read(3) == b'\x00' * 3
+            assert crous.load(f) == [1, 2, 3]
+
+    def test_load_unflushed_read_write_file(self, tmp_path):
+        """Test pending writes of an r+b file are seen by load()."""
+        file_path = tmp_path / "rw.crous"
+        file_path.write_bytes(b'')
+        with open(file_path, 'r+b') as f:
+            crous.dump({'a': 1}, f)
+            f.seek(0)
+            assert crous.load(f) == {'a': 1}
+
+    def test_load_empty_file_raises(self, tmp_path):
+        """Test empty files fail to decode through both entry points."""
+        file_path = tmp_path / "empty.crous"
+        file_path.write_bytes(b'')
+        with pytest.raises(crous.CrousDecodeError):
+            crous.load(str(file_path))
+        with open(file_path, 'rb') as f:
+            with pytest.raises(crous.CrousDecodeError):
+                crous.load(f)
+
+    def test_load_truncated_file_raises(self, tmp_path):
+        """Test a truncated mapped file reports a decode error."""
+        file_path = tmp_path / "truncated.crous"
+        file_path.write_bytes(crous.dumps(list(range(1000)))[:-10])
+        with pytest.raises(crous.CrousDecodeError):
+            crous.load(str(file_path))
+
+    def test_load_pipe_falls_back_to_read(self):
+        """Test unmappable file objects are still read normally."""
+        binary = crous.dumps({'k': [1, 2]})
+        r, w = os.pipe()
+        os.write(w, binary)
+        os.close(w)
+        with os.fdopen(r, 'rb') as f:
+            assert crous.load(f) == {'k': [1, 2]}
@@ -44,6 +44,26 @@ class TestDeepNesting:
         result = crous.loads(binary)
         assert result == data
 
+    def test_nesting_beyond_decode_limit(self):
+        """Test that input nested past the decode depth limit is rejected."""
+        data = 'bottom'
+        for _ in range(300):
+            data = [data]
+        binary = crous.dumps(data)
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(binary)
+
+    def test_nested_hooks_apply_inside_out(self):
+        """Test object_hook sees inner dicts before the dicts that hold them."""
+        seen = []
+
+        def hook(d):
+            seen.append(sorted(d))
+            return d
+
+        crous.loads(crous.dumps({'outer': {'inner': {'x': 1}}}), object_hook=hook)
+        assert seen == [['x'], ['inner'], ['outer']]
+
     def test_nested_lists(self):
         """Test deeply nested lists."""
         data = [[[[[['value']]]]]]
@@ -69,6 +89,84 @@ class TestDeepNesting:
         assert result == data
 
 
+class TestDepthLimits:
+    """Test max_depth and documents nested past the C stack."""
+
+    def _chain(self, depth):
+        data = 'bottom'
+        for i in range(depth):
+            data = [data] if i % 2 else {'next': data}
+        return data
+
+    def test_deep_round_trip_with_max_depth(self):
+        """Test 10000 levels decode once max_depth allows them."""
+        binary = crous.dumps(self._chain(10000))
+        result = crous.loads(binary, max_depth=10001)
+        # Compared re-encoded: == on the objects would recurse
+        assert crous.dumps(result) == binary
+
+    def test_very_deep_dumps(self):
+        """Test 200000 levels encode without exhausting the stack."""
+        with pytest.raises(crous.CrousEncodeError):
+            crous.dumps(self._chain(200000))
+        binary = crous.dumps(self._chain(200000), max_depth=200001)
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(binary)
+
+    def test_cycle_raises(self):
+        """Test a list that contains itself raises rather than crashing."""
+        data = [1]
+        data.append(data)
+        with pytest.raises(crous.CrousEncodeError):
+            crous.dumps(data)
+
+        cyclic = {'a': [{}]}
+        cyclic['a'][0]['back'] = cyclic
+        with pytest.raises(crous.CrousEncodeError):
+            crous.dumps(cyclic)
+
+    def test_dumps_max_depth(self):
+        """Test dumps rejects values at max_depth and accepts shallower ones."""
+        data = [[[1]]]
+        with pytest.raises(crous.CrousEncodeError):
+            crous.dumps(data, max_depth=3)
+        assert crous.dumps(data, max_depth=4) == crous.dumps(data)
+        with pytest.raises(ValueError):
+            crous.dumps(data, max_depth=0)
+
+    def test_loads_max_depth(self):
+        """Test loads rejects documents nested at max_depth."""
+        binary = crous.dumps({'a': [{'b': 1}]})
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(binary, max_depth=3)
+        assert crous.loads(binary, max_depth=4) == {'a': [{'b': 1}]}
+
+    def test_load_max_depth(self, tmp_path):
+        """Test dump and load take max_depth too."""
+        path = str(tmp_path / 'deep.crous')
+        crous.dump(self._chain(1000), path, max_depth=1001)
+        with pytest.raises(crous.CrousDecodeError):
+            crous.load(path)
+        assert crous.dumps(crous.load(path, max_depth=1001)) == crous.dumps(self._chain(1000))
+
+    def test_deep_tables(self):
+        """Test tables nested in tables encode, and decode again."""
+        data = {'v': 1}
+        for _ in range(200):
+            data = [{'k': data}, {'k': 0}, {'k': 1}, {'k': 2}]
+        binary = crous.dumps(data, columnar=True, max_depth=1000)
+        result = crous.loads(binary, max_depth=1000)
+        assert crous.dumps(result, columnar=True) == binary
+
+    def test_deep_tagged_values(self):
+        """Test nested sets and custom types walk the same stack."""
+        data = frozenset([1])
+        for _ in range(500):
+            data = frozenset([data])
+        binary = crous.dumps(data)
+        assert crous.dumps(crous.loads(binary, max_depth=2000)) == binary
+
+
 class TestBreadthStress:
     """Test structures with large breadth (many items at same level)."""
 
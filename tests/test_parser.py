@@ -0,0 +1,284 @@
+"""
+test_parser.py - The C text parser (crous_parser.h)
+
+The parser has no Python binding, so these tests drive it through ctypes
+on the built extension, which exports the C API. Every input is parsed
+twice, once into heap values and once into an arena, and both trees must
+match: repeated keys folded the same way on the linear (<= 8 entries) and
+hashed paths, syntax errors reported from inside open containers, and
+trailing commas accepted in lists, tuples and dicts.
+"""
+
+import ctypes
+import sys
+
+import pytest
+import crous
+
+
+CROUS_OK, CROUS_ERR_SYNTAX = 0, 11
+(T_NULL, T_BOOL, T_INT, T_FLOAT, T_STRING, T_BYTES,
+ T_LIST, T_TUPLE, T_DICT) = range(9)
+
+
+class DictEntry(ctypes.Structure):
+    _fields_ = [('key', ctypes.c_void_p),
+                ('key_len', ctypes.c_size_t),
+                ('value', ctypes.c_void_p)]
+
+
+def load_api():
+    lib = ctypes.CDLL(sys.modules['crous.crous'].__file__)
+    vp, size_t = ctypes.c_void_p, ctypes.c_size_t
+    sigs = {
+        'crous_arena_create': (vp, [size_t]),
+        'crous_arena_free': (None, [vp]),
+        'crous_lexer_create': (vp, [ctypes.c_char_p, size_t, vp]),
+        'crous_lexer_free': (None, [vp]),
+        'crous_parser_create': (vp, [vp, vp]),
+        'crous_parser_free': (None, [vp]),
+        'crous_parser_parse': (ctypes.c_int, [vp, ctypes.POINTER(vp)]),
+        'crous_parser_error': (ctypes.c_int, [vp]),
+        'crous_parser_error_location': (None, [vp, ctypes.POINTER(ctypes.c_int),
+                                               ctypes.POINTER(ctypes.c_int)]),
+        'crous_value_free_tree': (None, [vp]),
+        'crous_value_get_type': (ctypes.c_int, [vp]),
+        'crous_value_get_bool': (ctypes.c_int, [vp]),
+        'crous_value_get_int': (ctypes.c_int64, [vp]),
+        'crous_value_get_float': (ctypes.c_double, [vp]),
+        'crous_value_get_string': (vp, [vp, ctypes.POINTER(size_t)]),
+        'crous_value_list_size': (size_t, [vp]),
+        'crous_value_list_get': (vp, [vp, size_t]),
+        'crous_value_dict_size': (size_t, [vp]),
+        'crous_value_dict_get_entry': (ctypes.POINTER(DictEntry), [vp, size_t]),
+        'crous_value_dict_get_binary': (vp, [vp, ctypes.c_char_p, size_t]),
+    }
+    for name, (res, args) in sigs.items():
+        fn = getattr(lib, name)
+        fn.restype, fn.argtypes = res, args
+    return lib
+
+
+API = load_api()
+
+
+def to_py(v):
+    """Convert a parsed tree to Python; dicts become lists of pairs so
+    that entry order and surviving duplicates are visible."""
+    t = API.crous_value_get_type(v)
+    if t == T_NULL:
+        return None
+    if t == T_BOOL:
+        return bool(API.crous_value_get_bool(v))
+    if t == T_INT:
+        return API.crous_value_get_int(v)
+    if t == T_FLOAT:
+        return API.crous_value_get_float(v)
+    if t == T_STRING:
+        n = ctypes.c_size_t()
+        p = API.crous_value_get_string(v, ctypes.byref(n))
+        return ctypes.string_at(p, n.value).decode() if n.value else ''
+    if t in (T_LIST, T_TUPLE):
+        items = [to_py(API.crous_value_list_get(v, i))
+                 for i in range(API.crous_value_list_size(v))]
+        return items if t == T_LIST else tuple(items)
+    if t == T_DICT:
+        pairs = []
+        for i in range(API.crous_value_dict_size(v)):
+            e = API.crous_value_dict_get_entry(v, i).contents
+            key = ctypes.string_at(e.key, e.key_len).decode() if e.key_len else ''
+            pairs.append((key, to_py(e.value)))
+        return pairs
+    raise AssertionError('unexpected type %d' % t)
+
+
+def lookup(v, key):
+    raw = key.encode()
+    found = API.crous_value_dict_get_binary(v, raw, len(raw))
+    return to_py(found) if found else KeyError
+
+
+def parse(text, arena, probe=None):
+    """Parse text in heap or arena mode. Returns (err, value, (line, col));
+    probe(root) runs on the live tree before it is released."""
+    src = text.encode()
+    a = API.crous_arena_create(4096) if arena else None
+    if arena:
+        assert a
+    lexer = API.crous_lexer_create(src, len(src), a)
+    parser = API.crous_parser_create(lexer, a)
+    assert lexer and parser
+    root = ctypes.c_void_p()
+    err = None
+    try:
+        err = API.crous_parser_parse(parser, ctypes.byref(root))
+        line, col = ctypes.c_int(), ctypes.c_int()
+        API.crous_parser_error_location(parser, ctypes.byref(line), ctypes.byref(col))
+        value = probed = None
+        if err == CROUS_OK:
+            value = to_py(root)
+            if probe:
+                probed = probe(root)
+        else:
+            assert API.crous_parser_error(parser) == err
+        return err, value, (line.value, col.value), probed
+    finally:
+        if err == CROUS_OK and not arena:
+            API.crous_value_free_tree(root)
+        API.crous_parser_free(parser)
+        API.crous_lexer_free(lexer)
+        if arena:
+            API.crous_arena_free(a)
+
+
+def parse_both(text, probe=None):
+    heap = parse(text, arena=False, probe=probe)
+    in_arena = parse(text, arena=True, probe=probe)
+    assert heap == in_arena
+    return heap
+
+
+def dict_text(keys):
+    return '{' + ', '.join('"%s": %d' % (k, i) for i, k in enumerate(keys)) + '}'
+
+
+def expected_pairs(keys):
+    """First position, last value, as crous_value_dict_set() keeps them."""
+    out = {}
+    for i, k in enumerate(keys):
+        out[k] = i
+    return list(out.items())
+
+
+class TestHeapAndArena:
+    """The same document builds the same tree in both modes."""
+
+    @pytest.mark.parametrize('text,expected', [
+        ('null', None),
+        ('true', True),
+        ('-42', -42),
+        ('2.5', 2.5),
+        ('"plain"', 'plain'),
+        (r'"a\"b\\c"', 'a"b\\c'),
+        ('[]', []),
+        ('()', ()),
+        ('{}', []),
+        ('[1, [2, [3, []]]]', [1, [2, [3, []]]]),
+        ('{"a": {"b": [true, null]}, "c": (1, "x")}',
+         [('a', [('b', [True, None])]), ('c', (1, 'x'))]),
+    ])
+    def test_values(self, text, expected):
+        err, value, _, _ = parse_both(text)
+        assert err == CROUS_OK
+        assert value == expected
+
+    def test_wide_containers(self):
+        """Enough elements to grow the shared element stack several times"""
+        items = list(range(1000))
+        text = '[' + ', '.join(
+            '{"k%d": [%d, (%d,)]}' % (i, i, i) for i in items) + ']'
+        err, value, _, _ = parse_both(text)
+        assert err == CROUS_OK
+        assert value == [[('k%d' % i, [i, (i,)])] for i in items]
+
+    def test_lookup_large_dict(self):
+        """Arena dicts past the index threshold are reachable by key"""
+        keys = ['key%d' % i for i in range(100)]
+        err, _, _, found = parse_both(
+            dict_text(keys), probe=lambda root: [lookup(root, k) for k in keys + ['absent']])
+        assert err == CROUS_OK
+        assert found == list(range(100)) + [KeyError]
+
+
+class TestRepeatedKeys:
+    """Repeated keys keep their first position and their last value."""
+
+    @pytest.mark.parametrize('keys', [
+        ['a', 'a'],
+        ['a', 'b', 'a'],
+        ['x', 'y', 'x', 'y', 'x', 'y', 'x', 'z'],             # 8: linear path
+        ['a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'a'],        # 9: hashed path
+        ['k%d' % (i % 5) for i in range(40)],
+        ['k%d' % i for i in range(30)] + ['k0', 'k29', 'k15'],
+        ['', 'a', '', 'b', '', 'c', 'd', 'e', 'f', ''],
+    ])
+    def test_duplicates_fold(self, keys):
+        err, value, _, found = parse_both(
+            dict_text(keys), probe=lambda root: [lookup(root, k) for k in keys])
+        assert err == CROUS_OK
+        pairs = expected_pairs(keys)
+        assert value == pairs
+        assert found == [dict(pairs)[k] for k in keys]
+
+    @pytest.mark.parametrize('n', [8, 9])
+    def test_nested_dicts_fold_independently(self, n):
+        """Inner dicts dedupe against their own keys only"""
+        keys = ['k%d' % (i % (n - 1)) for i in range(n)]
+        text = '{"outer": %s, "k0": %s, "outer": 1}' % (dict_text(keys), dict_text(keys))
+        err, value, _, _ = parse_both(text)
+        assert err == CROUS_OK
+        assert value == [('outer', 1), ('k0', expected_pairs(keys))]
+
+    def test_same_text_different_quotes(self):
+        err, value, _, _ = parse_both('{"a": 1, \'a\': 2}')
+        assert err == CROUS_OK
+        assert value == [('a', 2)]
+
+
+class TestSyntaxErrors:
+    """Errors inside open containers unwind cleanly and report a location."""
+
+    @pytest.mark.parametrize('text,line,col', [
+        ('[1, 2 3]', 1, 7),
+        ('(1, 2 3)', 1, 7),
+        ('{"a": 1 "b": 2}', 1, 9),
+        ('{"a" 1}', 1, 6),
+        ('{"a": 1, 2: 3}', 1, 10),
+        ('[1, {"a": [2, {"b": ]}]}]', 1, 21),
+        ('{"a": [1, 2,\n "x" "y"]}', 2, 6),
+        ('[[[1, 2], [3, 4], [5 6]]]', 1, 22),
+    ])
+    def test_error_location(self, text, line, col):
+        err, value, loc, _ = parse_both(text)
+        assert err == CROUS_ERR_SYNTAX
+        assert value is None
+        assert loc == (line, col)
+
+    @pytest.mark.parametrize('text', [
+        '[1, 2',
+        '{"a": [1, {"b": 2}',
+        '(1, (2, (3,)',
+        '{"k0": 0, "k1": 1, "k2": 2, "k3": 3, "k4": 4, "k5": 5, "k6": 6, "k7": 7, "k8": 8',
+    ])
+    def test_unterminated(self, text):
+        err, value, _, _ = parse_both(text)
+        assert err == CROUS_ERR_SYNTAX
+        assert value is None
+
+    def test_error_after_large_sibling(self):
+        """Entries already on the stack for an outer dict are released"""
+        keys = ['k%d' % i for i in range(20)]
+        text = '{"big": %s, "bad": [1, 2 3]}' % dict_text(keys)
+        err, _, loc, _ = parse_both(text)
+        assert err == CROUS_ERR_SYNTAX
+        assert loc[0] == 1
+
+
+class TestTrailingCommas:
+    @pytest.mark.parametrize('text,expected', [
+        ('(1,)', (1,)),
+        ('(1, 2,)', (1, 2)),
+        ('((1,), (2, 3,),)', ((1,), (2, 3))),
+        ('[1, 2,]', [1, 2]),
+        ('{"t": ("a", "b",),}', [('t', ('a', 'b'))]),
+        ('[(1,), {"a": (),},]', [(1,), [('a', ())]]),
+    ])
+    def test_accepted(self, text, expected):
+        err, value, _, _ = parse_both(text)
+        assert err == CROUS_OK
+        assert value == expected
+
+    @pytest.mark.parametrize('text', ['(,)', '(1,,)', '[,]', '{,}'])
+    def test_lone_comma_rejected(self, text):
+        err, _, _, _ = parse_both(text)
+        assert err == CROUS_ERR_SYNTAX
@@ -64,6 +64,17 @@ class TestIntegerTypes:
         assert result is not True
         assert isinstance(result, int)
 
+    def test_varint_length_boundaries(self):
+        """Test ints at every varint length boundary, alone and mid-list."""
+        values = [0, -1, 2**63 - 1, -2**63]
+        for bits in range(1, 63):
+            values += [2**bits - 1, 2**bits, -2**bits, -2**bits - 1]
+        for value in values:
+            assert crous.loads(crous.dumps(value)) == value
+        # Values near the end of the input take the bounds-checked path
+        assert crous.loads(crous.dumps(values)) == values
+        assert crous.loads(crous.dumps(values[::-1])) == values[::-1]
+
 
 class TestFloatTypes:
     """Test floating point scalar values."""
@@ -0,0 +1,160 @@
+"""
+test_schema.py - Schema-compiled positional codecs
+
+Tests crous.Schema and crous.register_schema: round trips, the size saved
+by dropping keys and tags, validation messages, nullable and any fields,
+and decoding through crous.loads() once a schema is registered.
+"""
+
+from typing import Optional
+
+import pytest
+import crous
+
+
+REQUEST = {
+    'id': int,
+    'method': str,
+    'params': {'user': str, 'limit': int, 'tags': [str], 'score': float},
+    'trace': Optional[str],
+}
+
+MESSAGE = {
+    'id': 12345,
+    'method': 'users.list',
+    'params': {'user': 'alice', 'limit': 50, 'tags': ['a', 'bb'], 'score': 0.5},
+    'trace': None,
+}
+
+
+class TestSchemaRoundTrip:
+    """Schema.dumps / Schema.loads."""
+
+    def test_round_trip(self):
+        schema = crous.Schema(REQUEST, id=100)
+        assert schema.loads(schema.dumps(MESSAGE)) == MESSAGE
+
+    def test_smaller_than_self_describing(self):
+        schema = crous.Schema(REQUEST, id=101)
+        assert len(schema.dumps(MESSAGE)) < len(crous.dumps(MESSAGE)) * 0.6
+
+    def test_spec_and_id(self):
+        schema = crous.Schema({'x y': int, 'l': list[Optional[bool]]}, id=102)
+        assert schema.id == 102
+        assert schema.spec == '{"x y": int, l: [bool?]}'
+        assert not schema.registered
+        assert crous.Schema(schema.spec, id=103).spec == schema.spec
+
+    def test_nested_schema_and_list_of_records(self):
+        point = crous.Schema({'x': float, 'y': float}, id=104)
+        path = crous.Schema({'name': str, 'points': [point], 'raw': bytes}, id=105)
+        value = {'name': 'p', 'points': [{'x': 1.0, 'y': 2.0}, {'x': -3.5, 'y': 0.0}],
+                 'raw': b'\x00\xff'}
+        assert path.loads(path.dumps(value)) == value
+
+    def test_nullable_fields(self):
+        inner = crous.Schema({'c': str}, id=113)
+        schema = crous.Schema({'a': Optional[int], 'b': Optional[inner]}, id=106)
+        assert schema.spec == '{a: int?, b: {c: str}?}'
+        for value in ({'a': None, 'b': None}, {'a': 7, 'b': {'c': 'x'}}):
+            assert schema.loads(schema.dumps(value)) == value
+
+    def test_any_field_keeps_its_type(self):
+        schema = crous.Schema({'meta': object}, id=107)
+        for meta in (None, 1, 'x', [1, 'two', {'k': 3.0}], (1, 2), {1, 2}):
+            assert schema.loads(schema.dumps({'meta': meta})) == {'meta': meta}
+
+    def test_packed_lists(self):
+        schema = crous.Schema({'ints': [int], 'floats': [float]}, id=108)
+        value = {'ints': list(range(-500, 500)), 'floats': [i / 4 for i in range(100)]}
+        assert schema.loads(schema.dumps(value)) == value
+
+    def test_object_hook(self):
+        schema = crous.Schema({'a': int, 'b': {'c': int}}, id=109)
+        data = schema.dumps({'a': 1, 'b': {'c': 2}})
+        assert schema.loads(data, object_hook=sorted) == ['a', 'b']
+
+    def test_truncated_and_trailing_bytes(self):
+        schema = crous.Schema(REQUEST, id=110)
+        data = schema.dumps(MESSAGE)
+        with pytest.raises(crous.CrousDecodeError):
+            schema.loads(data[:-1])
+        with pytest.raises(crous.CrousDecodeError):
+            schema.loads(data + b'x')
+
+    def test_wrong_schema(self):
+        data = crous.Schema({'a': int}, id=111).dumps({'a': 1})
+        with pytest.raises(crous.CrousDecodeError, match='schema 111, not 112'):
+            crous.Schema({'a': int}, id=112).loads(data)
+
+
+class TestSchemaValidation:
+    """Values that do not match the schema."""
+
+    def setup_method(self, method):
+        self.schema = crous.Schema(REQUEST, id=120)
+
+    def message(self, **params):
+        return dict(MESSAGE, params=dict(MESSAGE['params'], **params))
+
+    def fails(self, value, match):
+        with pytest.raises(crous.CrousEncodeError, match=match):
+            self.schema.dumps(value)
+
+    def test_wrong_type(self):
+        self.fails(dict(MESSAGE, id='1'), r"'id' expects int, not str")
+        self.fails(dict(MESSAGE, id=True), r"'id' expects int, not bool")
+
+    def test_path_into_lists(self):
+        self.fails(self.message(tags=['a', 2]), r"'params.tags\[1\]' expects str, not int")
+
+    def test_missing_and_extra_fields(self):
+        params = dict(MESSAGE['params'])
+        del params['limit']
+        self.fails(dict(MESSAGE, params=params), r"'params.limit' is missing")
+        self.fails(self.message(extra=1), r"'params.extra' is not in the schema")
+
+    def test_null_in_required_field(self):
+        self.fails(dict(MESSAGE, method=None), r"'method' expects str, not NoneType")
+
+    def test_top_level_type(self):
+        self.fails([1, 2], r"schema value expects dict, not list")
+
+    def test_int_out_of_range(self):
+        self.fails(dict(MESSAGE, id=2 ** 70), r"'id' holds an int too large")
+
+    @pytest.mark.parametrize('spec', ['{a:', '{a:int,a:int}', '[foo]', '{a:int}}', ''])
+    def test_invalid_spec(self, spec):
+        with pytest.raises(ValueError):
+            crous.Schema(spec, id=121)
+
+    def test_invalid_id(self):
+        for schema_id in (0, 1 << 24):
+            with pytest.raises(ValueError):
+                crous.Schema({'a': int}, id=schema_id)
+
+    def test_unsupported_python_type(self):
+        with pytest.raises((TypeError, ValueError)):
+            crous.Schema({'a': complex}, id=122)
+
+
+class TestSchemaRegistry:
+    """register_schema and decoding through crous.loads()."""
+
+    def test_loads_needs_registration(self):
+        schema = crous.Schema(REQUEST, id=130)
+        data = schema.dumps(MESSAGE)
+        with pytest.raises(crous.CrousDecodeError, match='not registered'):
+            crous.loads(data)
+        crous.register_schema(schema)
+        assert schema.registered
+        assert crous.loads(data) == MESSAGE
+
+    def test_id_registered_once(self):
+        crous.register_schema(crous.Schema({'a': int}, id=131))
+        with pytest.raises(ValueError, match='already registered'):
+            crous.register_schema(crous.Schema({'b': str}, id=131))
+
+    def test_compatible_with_this_version(self):
+        data = crous.Schema({'a': int}, id=132).dumps({'a': 1})
+        assert crous.check_compatibility(data).status == 0
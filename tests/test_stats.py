@@ -0,0 +1,132 @@
+"""
+test_stats.py - Built-in instrumentation counters
+
+Tests enable_stats / get_stats / reset_stats: what each path counts, the
+per-thread view, and that nothing is counted while disabled.
+"""
+
+import threading
+
+import pytest
+import crous
+
+
+class TestStats:
+    """Counters surfaced through crous.get_stats()."""
+
+    def setup_method(self, method):
+        crous.enable_stats()
+        crous.reset_stats()
+
+    def teardown_method(self, method):
+        crous.enable_stats(False)
+        crous.reset_stats()
+
+    def test_disabled_counts_nothing(self):
+        crous.enable_stats(False)
+        crous.loads(crous.dumps({'a': [1, 2, 3]}))
+        stats = crous.get_stats()
+        assert stats['enabled'] is False
+        assert sum(stats['calls'].values()) == 0
+        assert stats['bytes_encoded']['flux'] == 0
+        assert stats['varint_reads'] == 0
+
+    def test_dumps_loads_bytes_and_values(self):
+        data = {'name': 'x', 'items': [1, 2, 3], 'ok': True}
+        encoded = crous.dumps(data)
+        assert crous.loads(encoded) == data
+
+        stats = crous.get_stats()
+        assert stats['enabled'] is True
+        assert stats['bytes_encoded']['flux'] == len(encoded)
+        assert stats['bytes_decoded']['flux'] == len(encoded)
+        assert stats['calls']['convert'] == 2
+        assert stats['values_created']['dict'] == 1
+        assert stats['values_created']['list'] == 1
+        assert stats['values_created']['int'] == 3
+        assert stats['values_created']['string'] == 1
+        assert stats['values_created']['bool'] == 1
+        assert stats['varint_reads'] > 0
+
+    def test_reset_zeroes(self):
+        crous.loads(crous.dumps([1, 2]))
+        assert crous.get_stats()['calls']['convert'] > 0
+        crous.reset_stats()
+        stats = crous.get_stats()
+        assert sum(stats['calls'].values()) == 0
+        assert sum(stats['values_created'].values()) == 0
+
+    def test_crout_decode_builds_a_tree(self):
+        text = crous.dumps_text({'a': [1, 2, 3]})
+        crous.reset_stats()
+        assert crous.loads_text(text) == {'a': [1, 2, 3]}
+
+        stats = crous.get_stats()
+        assert stats['calls']['decode'] == 1
+        assert stats['bytes_decoded']['crout'] == len(text.encode())
+        assert stats['values_created']['int'] == 3
+        assert stats['mallocs'] > 0
+        assert stats['calls']['convert'] == 1
+
+    def test_short_strings_share_their_node_allocation(self):
+        counts = {}
+        for s in ('x' * 15, 'x' * 16):
+            text = crous.dumps_text([s] * 100)
+            crous.reset_stats()
+            assert crous.loads_text(text) == [s] * 100
+            counts[len(s)] = crous.get_stats()['mallocs']
+
+        # One allocation per string up to 15 bytes, two past that
+        assert counts[16] - counts[15] == 100
+
+    def test_freed_nodes_are_pooled(self):
+        text = crous.dumps_text([[i, 'x'] for i in range(200)])
+        crous.loads_text(text)
+        crous.reset_stats()
+        crous.loads_text(text)
+        stats = crous.get_stats()
+
+        # The first decode's tree is freed into this thread's pools
+        assert 0 < stats['pool_hits'] <= stats['mallocs']
+
+    def test_transcode_phase(self):
+        text = crous.dumps_text([1, 'two', 3.0])
+        crous.reset_stats()
+        flux = crous.text_to_flux(text)
+
+        stats = crous.get_stats()
+        assert stats['calls']['transcode'] == 1
+        assert stats['bytes_decoded']['crout'] == len(text.encode())
+        assert stats['bytes_encoded']['flux'] == len(flux)
+
+    def test_callbacks_counted(self):
+        class Point:
+            def __init__(self, x):
+                self.x = x
+
+        crous.register_serializer(Point, lambda p: p.x)
+        try:
+            crous.dumps([Point(1), Point(2)])
+        finally:
+            crous.unregister_serializer(Point)
+        crous.loads(crous.dumps([{'a': 1}, {'b': 2}]), object_hook=dict)
+        assert crous.get_stats()['callbacks'] == 4
+
+    def test_thread_view(self):
+        def work():
+            for _ in range(5):
+                crous.loads(crous.dumps({'k': 1}))
+
+        t = threading.Thread(target=work)
+        t.start()
+        t.join()
+
+        assert crous.get_stats(thread=True)['calls']['convert'] == 0
+        assert crous.get_stats()['calls']['convert'] == 10
+        work()
+        assert crous.get_stats(thread=True)['calls']['convert'] == 10
+        assert crous.get_stats()['calls']['convert'] == 20
+
+    def test_time_recorded(self):
+        crous.loads(crous.dumps(list(range(10000))))
+        assert crous.get_stats()['time_ns']['convert'] > 0
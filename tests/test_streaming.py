@@ -8,6 +8,7 @@ Validates that parsed arguments are used directly (fix for C-1 audit issue).
 import pytest
 import crous
 import io
+import random
 
 
 class TestDumpsStreamBasic:
@@ -207,6 +208,294 @@ class TestDumpsStreamErrorHandling:
         assert actual == expected
 
 
+class TestIncrementalStreamDecode:
+    """Test that loads_stream decodes chunk by chunk."""
+
+    class TrickleReader:
+        """File-like object that returns at most `step` bytes per read()."""
+
+        def __init__(self, data, step):
+            self.buf = io.BytesIO(data)
+            self.step = step
+            self.sizes = []
+
+        def read(self, n=-1):
+            self.sizes.append(n)
+            return self.buf.read(min(n, self.step) if n >= 0 else self.step)
+
+    def test_loads_stream_short_reads(self):
+        """Test decoding when every read returns only a few bytes."""
+        data = {'name': 'trickle', 'values': list(range(50)), 'blob': b'\x01' * 300}
+        reader = self.TrickleReader(crous.dumps(data), 3)
+        assert crous.loads_stream(reader) == data
+
+    def test_loads_stream_reads_bounded_chunks(self):
+        """Test that input is requested in bounded chunks, not read() all at once."""
+        data = [{'id': i, 'payload': 'x' * 100} for i in range(5000)]
+        reader = self.TrickleReader(crous.dumps(data), 1 << 30)
+        assert crous.loads_stream(reader) == data
+        assert len(reader.sizes) > 1
+        assert all(0 < n <= 65536 for n in reader.sizes)
+
+    def test_loads_stream_truncated(self):
+        """Test that a stream ending mid-value raises a decode error."""
+        binary = crous.dumps({'key': 'value' * 100})
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads_stream(io.BytesIO(binary[:-10]))
+
+    def test_loads_stream_read_error_propagates(self):
+        """Test that exceptions raised by read() reach the caller."""
+        class Broken:
+            def read(self, n=-1):
+                raise OSError("boom")
+
+        with pytest.raises(OSError):
+            crous.loads_stream(Broken())
+
+
+class TestBufferInput:
+    """Test decoding from bytes-like objects and readinto() without copies."""
+
+    DATA = {'rows': [{'id': i, 'name': 'n%d' % i} for i in range(2000)]}
+
+    class IntoReader(io.RawIOBase):
+        """Raw stream that only implements readinto() and keeps every view."""
+
+        def __init__(self, data):
+            self.data = data
+            self.pos = 0
+            self.views = []
+
+        def readable(self):
+            return True
+
+        def readinto(self, view):
+            self.views.append(view)
+            n = min(len(view), len(self.data) - self.pos, 4096)
+            view[:n] = self.data[self.pos:self.pos + n]
+            self.pos += n
+            return n
+
+    def test_loads_bytes_like(self, tmp_path):
+        """Test loads accepts bytearray, memoryview slices, array and mmap."""
+        import array
+        import mmap
+        binary = crous.dumps(self.DATA)
+        assert crous.loads(bytearray(binary)) == self.DATA
+        assert crous.loads(memoryview(b'pad' + binary)[3:]) == self.DATA
+        assert crous.loads(array.array('B', binary)) == self.DATA
+        assert crous.CrousDecoder().decode(bytearray(binary)) == self.DATA
+
+        path = tmp_path / 'doc.crous'
+        path.write_bytes(binary)
+        with open(path, 'rb') as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as m:
+            assert crous.loads(m) == self.DATA
+
+    def test_bytearray_changed_during_decode(self):
+        """Test a bytearray written or resized by object_hook can't change the result."""
+        binary = crous.dumps({'a': {'x': 1}, 'b': 'hello'})
+        data = bytearray(binary)
+
+        def scribble(obj):
+            data[binary.index(b'hello')] = ord('J')
+            return obj
+
+        assert crous.loads(data, fields=['a', 'b'], object_hook=scribble)['b'] == 'hello'
+        assert crous.loads(bytearray(b'CROU\x02\x00')) == crous.loads(b'CROU\x02\x00')
+        with pytest.raises(BufferError):
+            crous.loads(data, object_hook=lambda obj: data.extend(b'x') or obj)
+
+    def test_read_returning_bytes_like(self):
+        """Test read() may return memoryview or bytearray chunks."""
+        binary = crous.dumps(self.DATA)
+
+        class ViewReader:
+            def __init__(self, data, kind):
+                self.buf = io.BytesIO(data)
+                self.kind = kind
+
+            def read(self, n=-1):
+                return self.kind(self.buf.read(n))
+
+        for kind in (memoryview, bytearray):
+            assert crous.load(ViewReader(binary, kind)) == self.DATA
+            assert crous.loads_stream(ViewReader(binary, kind)) == self.DATA
+
+    def test_loads_stream_uses_readinto(self):
+        """Test loads_stream fills its chunks through readinto() and releases the views."""
+        reader = self.IntoReader(crous.dumps(self.DATA))
+        assert crous.loads_stream(reader) == self.DATA
+        assert len(reader.views) > 1
+        with pytest.raises(ValueError):
+            reader.views[0][0]
+
+    def test_load_bytesio_in_place(self):
+        """Test load decodes a BytesIO from its position and leaves it at EOF."""
+        binary = crous.dumps(self.DATA)
+        buf = io.BytesIO(b'header' + binary)
+        buf.seek(6)
+        assert crous.load(buf) == self.DATA
+        assert buf.tell() == len(binary) + 6
+        buf.write(b'more')  # No export left behind
+
+    def test_read_returning_str_raises(self):
+        """Test a text chunk from read() is a TypeError."""
+        class TextReader:
+            def read(self, n=-1):
+                return 'text'
+
+        with pytest.raises(TypeError):
+            crous.loads_stream(TextReader())
+        with pytest.raises(TypeError):
+            crous.load(TextReader())
+
+
+class TestIterLoads:
+    """Test Unpacker and iter_loads over streams of concatenated documents."""
+
+    DOCS = [{'a': 1}, [1, 2, 3], 'x', None, {'nested': {'k': [1.5, b'raw']}}]
+
+    def stream(self, docs=None, **opts):
+        return b''.join(crous.dumps(d, **opts) for d in (self.DOCS if docs is None else docs))
+
+    def test_feed_one_byte_at_a_time(self):
+        """Test each document is yielded the moment its last byte is fed."""
+        u = crous.Unpacker()
+        out = []
+        for doc in self.DOCS:
+            data = crous.dumps(doc)
+            for i in range(len(data)):
+                u.feed(data[i:i + 1])
+                got = list(u)
+                assert got == ([doc] if i == len(data) - 1 else [])
+                out += got
+        u.close()
+        assert out == self.DOCS
+
+    def test_feed_many_documents_at_once(self):
+        """Test one feed() spanning several documents yields them all."""
+        u = crous.Unpacker()
+        u.feed(self.stream())
+        assert list(u) == self.DOCS
+        assert list(u) == []
+
+    def test_items_yields_before_document_ends(self):
+        """Test items=True yields list elements while the list is still open."""
+        rows = [{'id': i, 'name': 'n%d' % i} for i in range(100)]
+        data = crous.dumps(rows)
+        u = crous.Unpacker(items=True)
+        u.feed(data[:len(data) // 2])
+        first = list(u)
+        assert 0 < len(first) < len(rows)
+        u.feed(data[len(data) // 2:])
+        assert first + list(u) == rows
+
+    @pytest.mark.parametrize('doc, expected', [
+        ({'a': [1, 2]}, [{'a': [1, 2]}]),
+        ((1, 'two', 3.0), [1, 'two', 3.0]),
+        ([], []),
+        ([[1], [2, [3]]], [[1], [2, [3]]]),
+        (7, [7]),
+    ])
+    def test_items_shapes(self, doc, expected):
+        """Test items=True on non-list, tuple, empty and nested top levels."""
+        u = crous.Unpacker(items=True)
+        u.feed(crous.dumps(doc) + crous.dumps('end'))
+        assert list(u) == expected + ['end']
+
+    def test_items_columnar_and_compressed(self):
+        """Test items=True through column tables and lz4 envelopes."""
+        rows = [{'id': i, 'name': 'user%d' % i} for i in range(5000)]
+        for opts in ({'columnar': True}, {'compression': 'lz4'}):
+            assert list(crous.iter_loads(io.BytesIO(crous.dumps(rows, **opts)), items=True)) == rows
+        assert list(crous.iter_loads(io.BytesIO(crous.dumps(rows, compression='lz4')))) == [rows]
+
+    def test_fp_uses_readinto(self):
+        """Test fp mode reads through readinto() in read_size chunks."""
+        data = self.stream() * 50
+        reader = TestBufferInput.IntoReader(data)
+        assert list(crous.Unpacker(reader, read_size=1000)) == self.DOCS * 50
+        assert len(reader.views) >= len(data) // 4096
+
+    def test_iter_loads_path_and_hook(self, tmp_path):
+        """Test iter_loads opens a path and applies object_hook."""
+        path = tmp_path / 'docs.flux'
+        path.write_bytes(self.stream())
+        out = list(crous.iter_loads(str(path), object_hook=lambda d: sorted(d)))
+        assert out == [['a'], [1, 2, 3], 'x', None, ['nested']]
+
+    def test_truncated_stream_raises(self):
+        """Test a stream cut inside a document raises after the whole ones."""
+        data = self.stream()
+        it = crous.iter_loads(io.BytesIO(data[:-3]))
+        for doc in self.DOCS[:-1]:
+            assert next(it) == doc
+        with pytest.raises(crous.CrousDecodeError):
+            next(it)
+
+        u = crous.Unpacker()
+        u.feed(data[:-3])
+        assert list(u) == self.DOCS[:-1]
+        with pytest.raises(crous.CrousDecodeError):
+            u.close()
+
+    def test_errors(self):
+        """Test malformed input, feed() with fp and use after close."""
+        u = crous.Unpacker()
+        with pytest.raises(crous.CrousDecodeError):
+            u.feed(b'\x00\x01\x02\x03garbage')
+        with pytest.raises(TypeError):
+            crous.Unpacker(io.BytesIO(b'')).feed(b'x')
+        with pytest.raises(TypeError):
+            crous.iter_loads(42)
+        u = crous.Unpacker()
+        u.close()
+        with pytest.raises(ValueError):
+            u.feed(crous.dumps(1))
+
+
+class TestBlockedStreamEncode:
+    """Test that dumps_stream writes output in bounded blocks."""
+
+    class RecordingWriter:
+        """File-like object that records the size of every write()."""
+
+        def __init__(self):
+            self.parts = []
+
+        def write(self, b):
+            self.parts.append(bytes(b))
+            return len(b)
+
+    def test_dumps_stream_writes_blocks(self):
+        """Test that large payloads are flushed as they are serialized."""
+        data = [{'id': i, 'payload': 'y' * 100} for i in range(5000)]
+        writer = self.RecordingWriter()
+        crous.dumps_stream(data, writer)
+
+        assert len(writer.parts) > 1
+        assert all(len(p) <= 65536 for p in writer.parts)
+        assert b''.join(writer.parts) == crous.dumps(data)
+
+    def test_dumps_stream_large_blob_passthrough(self):
+        """Test that a blob bigger than a block is still written intact."""
+        data = {'before': 1, 'blob': b'\xab' * 300000, 'after': 2}
+        writer = self.RecordingWriter()
+        crous.dump(data, writer)
+
+        assert b''.join(writer.parts) == crous.dumps(data)
+        assert crous.loads(b''.join(writer.parts)) == data
+
+    def test_dumps_stream_write_error_propagates(self):
+        """Test that exceptions raised by write() reach the caller."""
+        class Broken:
+            def write(self, b):
+                raise OSError("disk full")
+
+        with pytest.raises(OSError):
+            crous.dumps_stream({'a': 1}, Broken())
+
+
 class TestStreamingMultipleRecords:
     """Test encoding and decoding multiple records in sequence."""
 
@@ -246,3 +535,619 @@ class TestStreamingMultipleRecords:
         
         assert result == data
 
+
+
+class TestFramedLog:
+    """Test FrameWriter / iter_load record-framed logs."""
+
+    def test_roundtrip(self):
+        """Records come back in order, one per write."""
+        records = [{'id': i, 'name': f'user{i}'} for i in range(100)]
+        buf = io.BytesIO()
+        with crous.FrameWriter(buf) as w:
+            for r in records:
+                w.write(r)
+        buf.seek(0)
+        assert list(crous.iter_load(buf)) == records
+
+    def test_append_across_writers(self):
+        """A writer on a non-empty stream continues the log without a new header."""
+        buf = io.BytesIO()
+        with crous.FrameWriter(buf) as w:
+            w.write(1)
+        size = len(buf.getvalue())
+        with crous.FrameWriter(buf, checksum=True) as w:
+            w.write(2)
+        assert buf.getvalue()[size:size + 4] != b'FLXR'
+        buf.seek(0)
+        assert list(crous.iter_load(buf)) == [1, 2]
+
+    def test_path_roundtrip(self, tmp_path):
+        """iter_load accepts a path; 'ab' mode appends."""
+        path = str(tmp_path / 'events.log')
+        for i in range(3):
+            with open(path, 'ab') as f, crous.FrameWriter(f) as w:
+                w.write({'event': i})
+        assert list(crous.iter_load(path)) == [{'event': 0}, {'event': 1}, {'event': 2}]
+
+    def test_checksum_mismatch(self):
+        """A corrupted body in a checksummed record raises."""
+        buf = io.BytesIO()
+        with crous.FrameWriter(buf, checksum=True) as w:
+            w.write('first')
+            w.write('second')
+        data = bytearray(buf.getvalue())
+        data[-2] ^= 0xFF
+        it = crous.iter_load(io.BytesIO(bytes(data)))
+        assert next(it) == 'first'
+        with pytest.raises(crous.CrousDecodeError):
+            next(it)
+
+    def test_truncated_tail(self):
+        """An interrupted append raises after the complete records are yielded."""
+        buf = io.BytesIO()
+        with crous.FrameWriter(buf) as w:
+            w.write([1, 2, 3])
+            w.write({'partial': 'record'})
+        got = []
+        with pytest.raises(crous.CrousDecodeError):
+            for record in crous.iter_load(io.BytesIO(buf.getvalue()[:-3])):
+                got.append(record)
+        assert got == [[1, 2, 3]]
+
+    def test_empty_and_bad_header(self):
+        """An empty input is an empty log; anything else must start with the header."""
+        assert list(crous.iter_load(io.BytesIO(b''))) == []
+        with pytest.raises(crous.CrousDecodeError):
+            list(crous.iter_load(io.BytesIO(crous.dumps({'a': 1}))))
+
+    def test_large_record(self):
+        """Records larger than the 64 KiB buffer are written and read whole."""
+        big = {'blob': b'x' * 200000, 'text': 'y' * 100000}
+        buf = io.BytesIO()
+        with crous.FrameWriter(buf, checksum=True) as w:
+            w.write('before')
+            w.write(big)
+            w.write('after')
+        buf.seek(0)
+        assert list(crous.iter_load(buf)) == ['before', big, 'after']
+
+    def test_write_after_close(self):
+        """Writing to a closed writer raises ValueError."""
+        w = crous.FrameWriter(io.BytesIO())
+        w.close()
+        assert w.closed
+        with pytest.raises(ValueError):
+            w.write(1)
+
+    def test_object_hook(self):
+        """object_hook is applied to every decoded dict."""
+        buf = io.BytesIO()
+        with crous.FrameWriter(buf) as w:
+            w.write({'a': {'b': 1}})
+        buf.seek(0)
+        result = list(crous.iter_load(buf, object_hook=lambda d: ('hooked', d)))
+        assert result == [('hooked', {'a': ('hooked', {'b': 1})})]
+
+
+class TestFrameFileIndex:
+    """Test indexed random access to framed logs via FrameFile."""
+
+    def _write(self, path, start, stop, **kwargs):
+        with open(path, 'ab') as f, crous.FrameWriter(f, **kwargs) as w:
+            for i in range(start, stop):
+                w.write({'id': i}, key=i)
+
+    def test_random_access(self, tmp_path):
+        """len() and f[i] reach every record, including negative indices."""
+        path = str(tmp_path / 'log')
+        self._write(path, 0, 1000, index=True, index_interval=64)
+        with crous.FrameFile(path) as ff:
+            assert len(ff) == 1000
+            assert [ff[i]['id'] for i in range(1000)] == list(range(1000))
+            assert ff[-1] == {'id': 999}
+            with pytest.raises(IndexError):
+                ff[1000]
+
+    def test_appended_segments(self, tmp_path):
+        """Indexed, unindexed and checksummed appends number records across the whole log."""
+        path = str(tmp_path / 'log')
+        self._write(path, 0, 300, index=True, index_interval=10)
+        self._write(path, 300, 350)
+        self._write(path, 350, 500, index=True, checksum=True, index_interval=7)
+        with crous.FrameFile(path) as ff:
+            assert len(ff) == 500
+            assert [r['id'] for r in ff] == list(range(500))
+            assert [r['id'] for r in ff.records(295, 355)] == list(range(295, 355))
+        assert [r['id'] for r in crous.iter_load(path)] == list(range(500))
+
+    def test_find_by_key(self, tmp_path):
+        """find() returns the last indexed record at or before the key."""
+        path = str(tmp_path / 'log')
+        self._write(path, 0, 100, index=True, index_interval=10)
+        with crous.FrameFile(path) as ff:
+            assert ff.find(55) == 50
+            assert ff.find(60) == 60
+            assert ff.find(-1) == 0
+            assert ff.find(10 ** 9) == 90
+            start = ff.find(73)
+            assert next(r for r in ff.records(start) if r['id'] >= 73) == {'id': 73}
+
+    def test_split_covers_log(self, tmp_path):
+        """split() ranges are contiguous and cover every record."""
+        path = str(tmp_path / 'log')
+        self._write(path, 0, 5000, index=True, index_interval=100)
+        with crous.FrameFile(path) as ff:
+            ranges = ff.split(4)
+            assert len(ranges) == 4
+            assert ranges[0][0] == 0 and ranges[-1][1] == 5000
+            assert all(a[1] == b[0] for a, b in zip(ranges, ranges[1:]))
+            got = [r['id'] for start, stop in ranges for r in ff.records(start, stop)]
+            assert got == list(range(5000))
+
+    def test_unindexed_and_truncated(self, tmp_path):
+        """Logs without a footer are indexed on open; a cut-off tail raises on read."""
+        path = str(tmp_path / 'log')
+        self._write(path, 0, 20)
+        with open(path, 'rb') as f:
+            data = f.read()
+        with open(path, 'wb') as f:
+            f.write(data[:-2])
+        with crous.FrameFile(path) as ff:
+            assert len(ff) == 19
+            assert ff[18] == {'id': 18}
+            with pytest.raises(crous.CrousDecodeError):
+                list(ff)
+
+    def test_closed_and_errors(self, tmp_path):
+        """Closed files raise ValueError; non-logs raise CrousDecodeError."""
+        path = str(tmp_path / 'log')
+        self._write(path, 0, 3, index=True)
+        ff = crous.FrameFile(path)
+        ff.close()
+        assert ff.closed
+        with pytest.raises(ValueError):
+            len(ff)
+        bad = tmp_path / 'bad'
+        bad.write_bytes(crous.dumps([1, 2, 3]))
+        with pytest.raises(crous.CrousDecodeError):
+            crous.FrameFile(str(bad))
+        with pytest.raises(TypeError):
+            crous.FrameWriter(io.BytesIO()).write(1, key=1.5)
+
+
+class TestLoadParallel:
+    """Test load_parallel() over framed logs."""
+
+    RECORDS = [{'id': i, 'name': 'user%d' % i, 'tags': ['a'] * (i % 5)} for i in range(3000)]
+
+    @staticmethod
+    def _raw_log(bodies):
+        """A log of the given record bodies, framed by hand."""
+        out = bytearray(b'FLXR\x01\x00\x00\x00')
+        for body in bodies:
+            out += (len(body) << 2).to_bytes(4, 'little') + body
+        return bytes(out)
+
+    def test_matches_iter_load(self, tmp_path):
+        """Every worker count returns the records of iter_load(), in order."""
+        path = str(tmp_path / 'log')
+        with open(path, 'ab') as f, crous.FrameWriter(f, index=True, index_interval=16) as w:
+            for r in self.RECORDS[:2000]:
+                w.write(r)
+        with open(path, 'ab') as f, crous.FrameWriter(f, checksum=True) as w:
+            for r in self.RECORDS[2000:]:
+                w.write(r)
+        for workers in (0, 1, 3, 16):
+            assert crous.load_parallel(path, workers=workers) == self.RECORDS
+        assert crous.load_parallel(path, object_hook=lambda d: d['id'])[:3] == [0, 1, 2]
+
+    def test_compressed_records(self, tmp_path):
+        """Enveloped records are unpacked, checksummed or not."""
+        bodies = [crous.dumps(r, compression='lz4', checksum=bool(i % 2))
+                  for i, r in enumerate(self.RECORDS[:500])]
+        path = tmp_path / 'log'
+        path.write_bytes(self._raw_log(bodies))
+        assert crous.load_parallel(str(path), workers=4) == self.RECORDS[:500]
+
+    def test_errors_follow_log_order(self, tmp_path):
+        """A bad record raises; so do cut-off appends and files that are not logs."""
+        path = tmp_path / 'log'
+        bodies = [crous.dumps(r) for r in self.RECORDS[:200]]
+        bodies[150] = b'FLUX\x01\x00\x7f'
+        path.write_bytes(self._raw_log(bodies))
+        with pytest.raises(crous.CrousDecodeError):
+            crous.load_parallel(str(path), workers=4)
+
+        with open(path, 'wb') as f, crous.FrameWriter(f, checksum=True) as w:
+            for r in self.RECORDS[:200]:
+                w.write(r)
+        data = bytearray(path.read_bytes())
+        data[len(data) // 2] ^= 0x20
+        path.write_bytes(bytes(data))
+        with pytest.raises(crous.CrousDecodeError):
+            crous.load_parallel(str(path), workers=4)
+
+        path.write_bytes(self._raw_log([crous.dumps(1), crous.dumps(2)])[:-1])
+        with pytest.raises(crous.CrousDecodeError):
+            crous.load_parallel(str(path))
+        path.write_bytes(b'')
+        assert crous.load_parallel(str(path)) == []
+        path.write_bytes(crous.dumps([1, 2]))
+        with pytest.raises(crous.CrousDecodeError):
+            crous.load_parallel(str(path))
+        with pytest.raises(OSError):
+            crous.load_parallel(str(tmp_path / 'missing'))
+
+
+class TestCompressedEnvelope:
+    """Test compression='lz4' envelopes on every encode and decode path."""
+
+    DATA = {'rows': [{'id': i, 'name': 'user%d' % i, 'tags': ['a', 'b']} for i in range(20000)]}
+
+    class ShortReader:
+        """File-like object whose read() returns a few bytes at a time."""
+
+        def __init__(self, data, step=7):
+            self.data = data
+            self.pos = 0
+            self.step = step
+
+        def read(self, n=-1):
+            chunk = self.data[self.pos:self.pos + (self.step if n < 0 else min(n, self.step))]
+            self.pos += len(chunk)
+            return chunk
+
+    @pytest.mark.parametrize('opts', [{}, {'key_refs': True}, {'columnar': True}])
+    def test_roundtrip_all_paths(self, opts):
+        """Compressed output reads back through loads, load, loads_stream and loads_lazy."""
+        packed = crous.dumps(self.DATA, compression='lz4', **opts)
+        assert len(packed) < len(crous.dumps(self.DATA, **opts)) // 2
+        assert crous.loads(packed) == self.DATA
+
+        buf = io.BytesIO()
+        crous.dump(self.DATA, buf, compression='lz4', **opts)
+        assert buf.getvalue() == packed
+        buf.seek(0)
+        assert crous.load(buf) == self.DATA
+        assert crous.loads_stream(self.ShortReader(packed)) == self.DATA
+
+        lazy = crous.loads_lazy(packed)
+        assert lazy['rows'][123]['name'] == 'user123'
+        assert crous.loads(packed, fields=['rows[*].id'])['rows'][5] == {'id': 5}
+
+    def test_stream_writes_bounded_blocks(self):
+        """dumps_stream compresses block by block instead of staging the document."""
+        writer = TestBlockedStreamEncode.RecordingWriter()
+        crous.dumps_stream(self.DATA, writer, compression='lz4')
+        assert len(writer.parts) > 1
+        assert all(len(p) <= 65536 + 32 for p in writer.parts)
+        assert b''.join(writer.parts) == crous.dumps(self.DATA, compression='lz4')
+
+    def test_incompressible_blocks_stored(self):
+        """Random bytes are stored as is, for a few bytes of framing."""
+        blob = bytes(random.Random(7).getrandbits(8) for _ in range(200000))
+        packed = crous.dumps(blob, compression='lz4')
+        assert len(packed) <= len(crous.dumps(blob)) + 64
+        assert crous.loads(packed) == blob
+
+    def test_small_values(self):
+        """Documents smaller than a block round-trip, None means uncompressed."""
+        for value in [None, 0, '', 'x', [], {}, 1.5]:
+            assert crous.loads(crous.dumps(value, compression='lz4')) == value
+        assert crous.dumps([1, 2], compression=None) == crous.dumps([1, 2])
+        assert crous.dumps([1, 2], compression='none') == crous.dumps([1, 2])
+
+    def test_header_signals_codec(self):
+        """The extended header carries the compression feature and the codec."""
+        packed = crous.dumps(self.DATA, compression='lz4')
+        result = crous.check_compatibility(packed)
+        assert result.is_compatible
+        assert result.header.features & crous.Feature.COMPRESSION
+        assert packed[8] == 1
+
+    def test_truncated_and_corrupt(self):
+        """Cut-off envelopes, bad block headers and unknown codecs raise CrousDecodeError."""
+        packed = crous.dumps(self.DATA, compression='lz4')
+        for cut in (8, 12, 20, len(packed) // 2, len(packed) - 1):
+            with pytest.raises(crous.CrousDecodeError):
+                crous.loads(packed[:cut])
+            with pytest.raises(crous.CrousDecodeError):
+                crous.loads_stream(io.BytesIO(packed[:cut]))
+
+        bad = bytearray(packed)
+        bad[16:20] = (1 << 30).to_bytes(4, 'little')
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(bytes(bad))
+        bad = bytearray(packed)
+        bad[8] = 2
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads(bytes(bad))
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads_stream(io.BytesIO(bytes(bad)))
+
+    def test_unknown_codec_rejected(self):
+        """Codecs this build lacks are a ValueError, non-strings a TypeError."""
+        with pytest.raises(ValueError):
+            crous.dumps(1, compression='zstd')
+        with pytest.raises(ValueError):
+            crous.dumps(1, compression='gzip')
+        with pytest.raises(TypeError):
+            crous.dumps(1, compression=1)
+
+
+class TestSharedDictionary:
+    """Test register_dictionary() and dictionary= on every encode and decode path."""
+
+    SAMPLES = [{'event': 'click', 'user_id': i, 'session': 'sess-%04d' % (i % 13),
+                'page': '/products/%d' % (i % 40), 'timestamp': 1700000000 + i,
+                'attributes': {'browser': 'firefox', 'platform': 'linux'}}
+               for i in range(200)]
+    MESSAGE = {'event': 'click', 'user_id': 9001, 'session': 'sess-0007',
+               'page': '/products/12', 'timestamp': 1700009001,
+               'attributes': {'browser': 'firefox', 'platform': 'linux'}}
+
+    DICT_ID = 0x5101
+    _registered = False
+
+    def setup_method(self, method=None):
+        # Registration is process-wide and permanent, so do it once.
+        if not TestSharedDictionary._registered:
+            crous.register_dictionary(self.DICT_ID, self.SAMPLES)
+            TestSharedDictionary._registered = True
+
+    @pytest.mark.parametrize('opts', [{}, {'compression': 'lz4'}, {'columnar': True}])
+    def test_roundtrip_all_paths(self, opts):
+        """Dictionary-encoded output reads back through every decoder."""
+        packed = crous.dumps(self.MESSAGE, dictionary=self.DICT_ID, **opts)
+        assert crous.loads(packed) == self.MESSAGE
+
+        buf = io.BytesIO()
+        crous.dump(self.MESSAGE, buf, dictionary=self.DICT_ID, **opts)
+        assert buf.getvalue() == packed
+        buf.seek(0)
+        assert crous.load(buf) == self.MESSAGE
+        assert crous.loads_stream(TestCompressedEnvelope.ShortReader(packed, step=3)) == self.MESSAGE
+
+        writer = TestBlockedStreamEncode.RecordingWriter()
+        crous.dumps_stream(self.MESSAGE, writer, dictionary=self.DICT_ID, **opts)
+        assert b''.join(writer.parts) == packed
+
+        assert crous.loads_lazy(packed)['attributes']['browser'] == 'firefox'
+        assert crous.loads(packed, fields=['user_id', 'page']) == {'user_id': 9001, 'page': '/products/12'}
+
+    def test_smaller_than_plain(self):
+        """Small messages shrink well below both plain and lz4-only output."""
+        plain = crous.dumps(self.MESSAGE)
+        packed = crous.dumps(self.MESSAGE, dictionary=self.DICT_ID, compression='lz4')
+        assert len(packed) < len(plain) // 2
+        assert len(packed) < len(crous.dumps(self.MESSAGE, compression='lz4'))
+        assert len(crous.dumps(self.MESSAGE, dictionary=self.DICT_ID)) < len(plain)
+
+    def test_header_names_dictionary(self):
+        """The envelope header carries the dictionary id as a u24."""
+        packed = crous.dumps(self.MESSAGE, dictionary=self.DICT_ID)
+        assert packed[:4] == b'FLUX'
+        assert int.from_bytes(packed[9:12], 'little') == self.DICT_ID
+        assert crous.check_compatibility(packed).is_compatible
+
+    def test_encoder_and_unknown_keys(self):
+        """CrousEncoder accepts a dictionary; keys outside it still round-trip."""
+        value = [self.MESSAGE, {'fresh_key': 1, 'event': 'view', 'other': {'user_id': 2}}]
+        packed = crous.CrousEncoder(dictionary=self.DICT_ID).encode(value)
+        assert packed == crous.dumps(value, dictionary=self.DICT_ID)
+        assert crous.loads(packed) == value
+        assert crous.dumps([1, 2], dictionary=None) == crous.dumps([1, 2])
+
+    def test_unregistered_on_decode(self):
+        """A document naming a dictionary this process lacks is a CrousDecodeError."""
+        bad = bytearray(crous.dumps(self.MESSAGE, dictionary=self.DICT_ID))
+        bad[9:12] = (0xABCDEF).to_bytes(3, 'little')
+        with pytest.raises(crous.CrousDecodeError, match='not registered'):
+            crous.loads(bytes(bad))
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads_stream(io.BytesIO(bytes(bad)))
+
+    def test_invalid_arguments(self):
+        """Unknown, duplicate and out-of-range ids are ValueErrors, non-ints TypeErrors."""
+        with pytest.raises(ValueError):
+            crous.dumps(1, dictionary=0x5FFFFF)
+        with pytest.raises(ValueError):
+            crous.register_dictionary(self.DICT_ID, self.SAMPLES)
+        for bad_id in (0, 1 << 24, -1):
+            with pytest.raises(ValueError):
+                crous.register_dictionary(bad_id, self.SAMPLES)
+        with pytest.raises(TypeError):
+            crous.dumps(1, dictionary='events')
+        with pytest.raises(TypeError):
+            crous.dumps(1, dictionary=True)
+
+    def test_feature_flag(self):
+        """This build advertises dictionary support."""
+        from crous.version import FEATURES_SUPPORTED
+        assert FEATURES_SUPPORTED & crous.Feature.DICTIONARY
+
+
+class TestEnvelopeChecksums:
+    """Test checksum=True envelopes and crous.crc32c()."""
+
+    DATA = {'rows': [{'id': i, 'name': 'user%d' % i} for i in range(20000)]}
+
+    @pytest.mark.parametrize('opts', [{}, {'compression': 'lz4'}, {'key_refs': True, 'compression': 'lz4'}])
+    def test_roundtrip_all_paths(self, opts):
+        """Checksummed output reads back through every decoder and costs 4 bytes a block."""
+        packed = crous.dumps(self.DATA, checksum=True, **opts)
+        plain = crous.dumps(self.DATA, **opts)
+        blocks = -(-len(crous.dumps(self.DATA, key_refs=opts.get('key_refs', False))) // 65536)
+        if opts:
+            assert len(packed) == len(plain) + 4 * blocks
+        assert crous.loads(packed) == self.DATA
+
+        buf = io.BytesIO()
+        crous.dump(self.DATA, buf, checksum=True, **opts)
+        assert buf.getvalue() == packed
+        buf.seek(0)
+        assert crous.load(buf) == self.DATA
+        assert crous.loads_stream(TestCompressedEnvelope.ShortReader(packed, step=5)) == self.DATA
+        assert crous.CrousEncoder(checksum=True, **opts).encode(self.DATA) == packed
+        assert crous.loads_lazy(packed)['rows'][77]['name'] == 'user77'
+        assert crous.loads(packed, fields=['rows[*].id'])['rows'][9] == {'id': 9}
+
+    def test_header_signals_checksums(self):
+        """The features word carries the checksum bit, the codec stays as given."""
+        packed = crous.dumps(self.DATA, checksum=True)
+        features = int.from_bytes(packed[6:8], 'big')
+        assert features & crous.Feature.CHECKSUMS
+        assert features & crous.Feature.COMPRESSION
+        assert packed[8] == 0
+        assert crous.check_compatibility(packed).is_compatible
+        assert not int.from_bytes(crous.dumps(self.DATA, compression='lz4')[6:8], 'big') & crous.Feature.CHECKSUMS
+
+    def test_damage_detected(self):
+        """A flipped bit in a stored block fails the checksum in every decoder."""
+        packed = bytearray(crous.dumps(self.DATA, checksum=True))
+        packed[len(packed) // 2] ^= 0x10
+        with pytest.raises(crous.CrousDecodeError, match='Checksum'):
+            crous.loads(bytes(packed))
+        with pytest.raises(crous.CrousDecodeError, match='Checksum'):
+            crous.loads_stream(io.BytesIO(bytes(packed)))
+        with pytest.raises(crous.CrousDecodeError):
+            crous.loads_lazy(bytes(packed))
+
+        packed = bytearray(crous.dumps(self.DATA, checksum=True, compression='lz4'))
+        packed[20] ^= 0xFF      # First block's CRC
+        with pytest.raises(crous.CrousDecodeError, match='Checksum'):
+            crous.loads(bytes(packed))
+
+    def test_crc32c(self):
+        """crc32c() matches the standard check value and continues across pieces."""
+        assert crous.crc32c(b'123456789') == 0xE3069283
+        assert crous.crc32c(b'') == 0
+        blob = bytes(random.Random(3).getrandbits(8) for _ in range(100003))
+        whole = crous.crc32c(blob)
+        assert crous.crc32c(memoryview(blob)[5000:], crous.crc32c(bytearray(blob[:5000]))) == whole
+        with pytest.raises(TypeError):
+            crous.crc32c('text')
+
+
+class TestThreadedDumps:
+    """Test dumps(threads=N), which spreads envelope blocks over threads."""
+
+    DATA = {'rows': [{'id': i, 'name': 'user%d' % i, 'score': i * 0.5} for i in range(30000)]}
+
+    @pytest.mark.parametrize('opts', [{'threads': 0}, {'threads': 2, 'compression': 'lz4'},
+                                      {'threads': 7, 'checksum': True},
+                                      {'threads': 0, 'compression': 'lz4', 'checksum': True, 'key_refs': True}])
+    def test_output_matches_single_thread(self, opts):
+        """Any thread count writes the same bytes as threads=1."""
+        packed = crous.dumps(self.DATA, **opts)
+        opts = {k: v for k, v in opts.items() if k != 'threads'}
+        assert packed == crous.dumps(self.DATA, **opts)
+        assert crous.loads(packed) == self.DATA
+
+    def test_small_documents(self):
+        """Documents of one block or none still encode with threads."""
+        for obj in (None, [], {'a': 1}, list(range(100))):
+            assert crous.dumps(obj, threads=4, compression='lz4') == crous.dumps(obj, compression='lz4')
+
+    def test_threads_must_be_int(self):
+        with pytest.raises(TypeError):
+            crous.dumps([1], threads='many')
+
+    def test_pool_size(self, tmp_path):
+        """set_threads() sizes the shared pool; every parallel path runs on it."""
+        initial = crous.get_threads()
+        assert initial >= 1
+        try:
+            crous.set_threads(6)
+            assert crous.get_threads() == 6
+            packed = crous.dumps(self.DATA, compression='lz4', checksum=True, threads=0)
+            assert packed == crous.dumps(self.DATA, compression='lz4', checksum=True)
+            path = str(tmp_path / 'log')
+            with open(path, 'wb') as f, crous.FrameWriter(f, index=True, index_interval=8) as w:
+                for row in self.DATA['rows'][:500]:
+                    w.write(row)
+            assert crous.load_parallel(path) == self.DATA['rows'][:500]
+        finally:
+            crous.set_threads(0)
+        assert crous.get_threads() == initial
+        with pytest.raises(TypeError):
+            crous.set_threads('4')
+
+
+class TestSessions:
+    """CrousEncoder, CrousDecoder and FrameWriter reuse their buffers."""
+
+    SIZES = [3, 500, 20000, 10, 120000, 1]
+
+    @staticmethod
+    def _doc(n):
+        return [{'id': i, 'name': f'item{i}', 'tags': ['x'] * (i % 4)} for i in range(n)]
+
+    @pytest.mark.parametrize('opts', [
+        {},
+        {'key_refs': True},
+        {'columnar': True},
+        {'compression': 'lz4'},
+        {'checksum': True},
+    ])
+    def test_encoder_matches_dumps(self, opts):
+        """Growing and shrinking documents encode as dumps() does."""
+        enc = crous.CrousEncoder(**opts)
+        dec = crous.CrousDecoder()
+        for n in self.SIZES * 2:
+            doc = self._doc(n)
+            binary = enc.encode(doc)
+            assert binary == crous.dumps(doc, **opts)
+            assert dec.decode(binary) == doc
+
+    def test_results_are_independent(self):
+        """Each result is its own bytes object, not a view of the buffers."""
+        enc = crous.CrousEncoder()
+        first = enc.encode({'a': 1})
+        second = enc.encode({'b': 2})
+        assert crous.loads(first) == {'a': 1}
+        assert crous.loads(second) == {'b': 2}
+
+    def test_reentrant_encode(self):
+        """default may call the same encoder while it is busy."""
+        class Point:
+            def __init__(self, x):
+                self.x = x
+
+        enc = crous.CrousEncoder(default=lambda p: {'inner': enc.encode([p.x] * 50)})
+        doc = [Point(i) for i in range(20)]
+        result = crous.loads(enc.encode(doc))
+        assert [crous.loads(r['inner']) for r in result] == [[i] * 50 for i in range(20)]
+
+    def test_decoder_envelopes(self):
+        """Compressed envelopes of every size unpack into the kept buffer."""
+        dec = crous.CrousDecoder()
+        for n in self.SIZES + [300000, 5]:
+            doc = self._doc(n)
+            assert dec.decode(crous.dumps(doc, compression='lz4', checksum=True)) == doc
+
+    def test_frame_writer(self):
+        """Records written through the session read back in order."""
+        buf = io.BytesIO()
+        docs = [self._doc(n) for n in self.SIZES]
+        with crous.FrameWriter(buf, checksum=True) as w:
+            for doc in docs:
+                w.write(doc)
+        buf.seek(0)
+        assert list(crous.iter_load(buf)) == docs
+
+    def test_frame_writer_reentrant(self):
+        """default may write a record while another is being encoded."""
+        buf = io.BytesIO()
+
+        def default(obj):
+            w.write('nested')
+            return str(obj)
+
+        with crous.FrameWriter(buf, default=default) as w:
+            w.write({'value': object.__new__(object)})
+        buf.seek(0)
+        records = list(crous.iter_load(buf))
+        assert records[0] == 'nested'
+        assert records[1]['value'].startswith('<object')
@@ -133,40 +133,111 @@ class TestTaggedTypeSupport:
 
 
 class TestBuiltInTaggedTypes:
-    """Test built-in tagged type support if implemented."""
+    """Test native encoding of datetime, date, time, Decimal and UUID."""
 
-    def test_datetime_roundtrip_builtin(self):
-        """Test datetime round-trip if built-in support exists."""
-        # This might not be implemented yet
-        try:
-            data = datetime(2023, 12, 25, 10, 30, 45)
-            binary = crous.dumps(data)
+    def roundtrip(self, value):
+        for binary in (crous.dumps(value), crous.CrousEncoder().encode(value)):
             result = crous.loads(binary)
-            # If it works, verify result
-            if isinstance(result, datetime):
-                assert result == data
-        except crous.CrousEncodeError:
-            # Expected if not implemented
-            pass
-
-    def test_decimal_roundtrip_builtin(self):
-        """Test Decimal round-trip if built-in support exists."""
+            assert type(result) is type(value)
+            assert str(result) == str(value)
+        return result
+
+    @pytest.mark.parametrize("value", [
+        datetime(2023, 12, 25, 10, 30, 45, 123456),
+        datetime(1969, 12, 31, 23, 59, 59, 1),
+        datetime(1, 1, 1),
+        datetime(9999, 12, 31, 23, 59, 59, 999999),
+    ])
+    def test_naive_datetime_roundtrip(self, value):
+        """Test naive datetimes keep every field and stay naive."""
+        result = self.roundtrip(value)
+        assert result == value
+        assert result.tzinfo is None
+
+    def test_aware_datetime_roundtrip(self):
+        """Test aware datetimes come back with the same UTC offset."""
+        from datetime import timezone, timedelta
+        utc = datetime(2024, 3, 1, 12, tzinfo=timezone.utc)
+        assert self.roundtrip(utc).tzinfo is timezone.utc
+
+        ist = timezone(timedelta(hours=5, minutes=30))
+        data = datetime(2024, 3, 1, 12, 15, tzinfo=ist)
+        result = self.roundtrip(data)
+        assert result == data
+        assert result.utcoffset() == timedelta(hours=5, minutes=30)
+
+    def test_date_and_time_roundtrip(self):
+        """Test date, naive time and aware time."""
+        from datetime import timezone, timedelta
+        assert self.roundtrip(date(2024, 2, 29)) == date(2024, 2, 29)
+        assert self.roundtrip(date(1, 1, 1)) == date(1, 1, 1)
+        assert self.roundtrip(time(23, 59, 59, 999999)) == time(23, 59, 59, 999999)
+        aware = time(8, 30, tzinfo=timezone(timedelta(hours=-2)))
+        assert self.roundtrip(aware).utcoffset() == timedelta(hours=-2)
+
+    @pytest.mark.parametrize("text", [
+        '3.14159', '-0.00', '0', '1E+10', '-1.5E-300', 'Infinity', '-Infinity',
+        'NaN', 'sNaN', 'NaN123', '1' * 200,
+    ])
+    def test_decimal_roundtrip(self, text):
+        """Test Decimal keeps its sign, exponent, digits and specials."""
+        self.roundtrip(Decimal(text))
+
+    @pytest.mark.parametrize("value", [
+        uuid.UUID('12345678-1234-5678-1234-567812345678'),
+        uuid.UUID(int=0),
+        uuid.UUID(int=2 ** 128 - 1),
+    ])
+    def test_uuid_roundtrip(self, value):
+        """Test UUID round-trip."""
+        result = self.roundtrip(value)
+        assert result == value
+        assert hash(result) == hash(value)
+
+    def test_nested_and_columnar(self):
+        """Test native types inside containers and columnar lists."""
+        data = {
+            'when': [datetime(2024, 1, 2, 3, 4, 5)] * 3,
+            'price': Decimal('19.99'),
+            'id': uuid.UUID(int=42),
+            'day': date(2020, 1, 1),
+        }
+        assert crous.loads(crous.dumps(data)) == data
+        assert crous.loads(crous.dumps(data, columnar=True)) == data
+        assert crous.loads_text(crous.dumps_text(data)) == data
+
+    def test_smaller_than_isoformat(self):
+        """Test the native encoding beats the string a serializer would emit."""
+        data = datetime(2023, 12, 25, 10, 30, 45, 123456)
+        assert len(crous.dumps(data)) < len(crous.dumps(data.isoformat()))
+        value = uuid.UUID('12345678-1234-5678-1234-567812345678')
+        assert len(crous.dumps(value)) < len(crous.dumps(str(value)))
+
+    def test_registered_serializer_wins(self):
+        """Test a registered serializer still overrides the native encoding."""
+        crous.register_serializer(datetime, lambda obj: obj.isoformat())
         try:
-            data = Decimal('3.14159')
-            binary = crous.dumps(data)
-            result = crous.loads(binary)
-            if isinstance(result, Decimal):
-                assert result == data
-        except crous.CrousEncodeError:
-            pass
+            result = crous.loads(crous.dumps(datetime(2023, 1, 1)))
+            assert result == '2023-01-01T00:00:00'
+        finally:
+            crous.unregister_serializer(datetime)
 
-    def test_uuid_roundtrip_builtin(self):
-        """Test UUID round-trip if built-in support exists."""
+    def test_registered_decoder_wins(self):
+        """Test a registered decoder for a built-in tag overrides native decoding."""
+        binary = crous.dumps(date(1970, 1, 11))
+        crous.register_decoder(81, lambda value: ('days', value))
         try:
-            data = uuid.UUID('12345678-1234-5678-1234-567812345678')
-            binary = crous.dumps(data)
-            result = crous.loads(binary)
-            if isinstance(result, uuid.UUID):
-                assert result == data
-        except crous.CrousEncodeError:
+            assert crous.loads(binary) == ('days', 10)
+        finally:
+            crous.unregister_decoder(81)
+        assert crous.loads(binary) == date(1970, 1, 11)
+
+    def test_subclass_not_native(self):
+        """Test subclasses are left to serializers and default."""
+        class Money(Decimal):
             pass
+
+        with pytest.raises(crous.CrousEncodeError):
+            crous.dumps(Money('1.00'))
+        result = crous.loads(crous.dumps(Money('1.00'), default=str))
+        assert result == '1.00'
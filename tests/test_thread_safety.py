@@ -65,6 +65,30 @@ class TestConcurrentDumpsLoads:
 
         assert errors == [], f"Thread errors: {errors}"
 
+    def test_concurrent_text_conversions(self):
+        """Text codecs run without the GIL; results must stay per-thread."""
+        errors = []
+
+        def worker(tid):
+            try:
+                for i in range(100):
+                    data = {"thread": tid, "rows": [{"id": i, "name": f"n{i}"}] * 20}
+                    text = crous.dumps_text(data)
+                    assert crous.loads_text(text) == data
+                    flux = crous.text_to_flux(text)
+                    assert crous.loads(flux) == data
+                    assert crous.loads_text(crous.flux_to_text(flux)) == data
+            except Exception as e:
+                errors.append((tid, e))
+
+        threads = [threading.Thread(target=worker, args=(t,)) for t in range(8)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        assert errors == [], f"Thread errors: {errors}"
+
 
 class TestConcurrentRegistration:
     """Verify register/unregister don't crash under concurrent access."""
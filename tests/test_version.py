@@ -10,6 +10,7 @@ Tests:
     - Migration support
 """
 
+import io
 import pytest
 import warnings
 from typing import Optional
@@ -42,8 +43,11 @@ from crous.version import (
     warn_deprecated,
     deprecated,
     register_migration,
+    register_header_migration,
     get_migration_path,
     migrate,
+    migrate_in_place,
+    migrate_stream,
 )
 
 import crous
@@ -421,6 +425,23 @@ class TestFeatureFlags:
         """Should have FROZENSET feature."""
         from crous.version import FEATURES_SUPPORTED
         assert FEATURES_SUPPORTED & Feature.FROZENSET
+    
+    def test_feature_has_key_table(self):
+        """Should have KEY_TABLE feature, readable at wire v3."""
+        from crous.version import FEATURES_SUPPORTED, WIRE_V3
+        assert FEATURES_SUPPORTED & Feature.KEY_TABLE
+        assert WIRE_V3 <= WIRE_VERSION_MAX_READ
+
+    def test_feature_has_columnar(self):
+        """Should have COLUMNAR feature, readable at wire v4."""
+        from crous.version import FEATURES_SUPPORTED, WIRE_V4
+        assert FEATURES_SUPPORTED & Feature.COLUMNAR
+        assert WIRE_V4 <= WIRE_VERSION_MAX_READ
+
+    def test_feature_has_packed_arrays(self):
+        """Should have PACKED_ARRAYS feature."""
+        from crous.version import FEATURES_SUPPORTED
+        assert FEATURES_SUPPORTED & Feature.PACKED_ARRAYS
 
 
 # ============================================================================
@@ -663,6 +684,64 @@ class TestMigration:
         assert len(path) == 1
         assert path[0].from_version == 99
         assert path[0].to_version == 100
+    
+    def test_builtin_migration_is_header_only(self):
+        """The v1 -> v2 migration only rewrites the version byte."""
+        path = get_migration_path(1, 2)
+        assert [m.header_only for m in path] == [True]
+    
+    def test_migrate_chains_header_and_body_hops(self):
+        """A header-only hop followed by a body hop applies both."""
+        register_header_migration(90, 91)
+        register_migration(91, 92, lambda data: data[:4] + bytes([92]) + data[5:] + b'!')
+        result = migrate(b'FLUX\x5a\x00test', 92)
+        assert result == b'FLUX\x5c\x00test!'
+    
+    def test_migrate_in_place(self):
+        """Header-only paths rewrite the version byte of the buffer itself."""
+        data = bytearray(b'FLUX\x01\x00test')
+        assert migrate_in_place(data, 2) is True
+        assert data == bytearray(b'FLUX\x02\x00test')
+        
+        view = memoryview(bytearray(b'FLUX\x01\x00test'))
+        assert migrate_in_place(view, 2) is True
+        assert view[4] == 2
+    
+    def test_migrate_in_place_refuses_body_hops(self):
+        """A path that rewrites the body leaves the buffer untouched."""
+        register_migration(80, 81, lambda data: data + b'!')
+        data = bytearray(b'FLUX\x50\x00test')
+        assert migrate_in_place(data, 81) is False
+        assert data == bytearray(b'FLUX\x50\x00test')
+    
+    def test_migrate_in_place_errors(self):
+        """Short data and missing paths raise ValueError."""
+        with pytest.raises(ValueError):
+            migrate_in_place(bytearray(b'FLU'), 2)
+        with pytest.raises(ValueError):
+            migrate_in_place(bytearray(b'FLUX\x02\x00test'), 200)
+    
+    def test_migrate_stream_header_only(self):
+        """Header-only paths stream a document larger than one chunk."""
+        body = bytes(range(256)) * 1000
+        src = io.BytesIO(b'FLUX\x01\x00' + body)
+        dst = io.BytesIO()
+        migrate_stream(src, dst, 2)
+        assert dst.getvalue() == b'FLUX\x02\x00' + body
+    
+    def test_migrate_stream_body_hop(self):
+        """Paths through a body migration write the migrated document."""
+        register_migration(70, 71, lambda data: data[:4] + bytes([71]) + data[5:] + b'!')
+        dst = io.BytesIO()
+        migrate_stream(io.BytesIO(b'FLUX\x46\x00test'), dst, 71)
+        assert dst.getvalue() == b'FLUX\x47\x00test!'
+    
+    def test_migrate_stream_real_document(self):
+        """A migrated crous document still decodes."""
+        data = crous.dumps({'a': [1, 2, 3]})
+        dst = io.BytesIO()
+        migrate_stream(io.BytesIO(data), dst, data[4])
+        assert crous.loads(dst.getvalue()) == {'a': [1, 2, 3]}
 
 
 # ============================================================================